@@ -1067,7 +1067,8 @@ int advanced_firmware_update_install(
 #ifdef ANJAY_WITH_SEND
         bool use_lwm2m_send,
 #endif // ANJAY_WITH_SEND
-        bool auto_suspend) {
+        bool auto_suspend,
+        size_t max_concurrent_downloads) {
     advanced_fw_update_logic_t *fw_logic_app = NULL;
     int result = -1;
 
@@ -1075,7 +1076,8 @@ int advanced_firmware_update_install(
 #ifdef ANJAY_WITH_SEND
         .use_lwm2m_send = use_lwm2m_send,
 #endif // ANJAY_WITH_SEND
-        .prefer_same_socket_downloads = prefer_same_socket_downloads
+        .prefer_same_socket_downloads = prefer_same_socket_downloads,
+        .max_concurrent_downloads = max_concurrent_downloads
     };
     result = anjay_advanced_fw_update_install(anjay, &config);
     if (!result && !original_img_file_path) {
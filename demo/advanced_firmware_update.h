@@ -125,7 +125,8 @@ int advanced_firmware_update_install(
 #ifdef ANJAY_WITH_SEND
         bool use_lwm2m_send,
 #endif // ANJAY_WITH_SEND
-        bool auto_suspend);
+        bool auto_suspend,
+        size_t max_concurrent_downloads);
 
 void advanced_firmware_update_uninstall(advanced_fw_update_logic_t *fw_table);
 int fw_update_common_open(anjay_iid_t iid, void *fw_);
@@ -267,6 +267,17 @@ static void demo_delete(anjay_demo_t *demo) {
         }
         avs_stream_cleanup(&data);
     }
+
+    if (demo->anjay && demo->session_state_file) {
+        avs_stream_t *data = avs_stream_file_create(demo->session_state_file,
+                                                    AVS_STREAM_FILE_WRITE);
+        if (!data
+                || avs_is_err(anjay_session_state_persist(demo->anjay, data))) {
+            demo_log(ERROR, "Cannot persist session state to file %s",
+                     demo->session_state_file);
+        }
+        avs_stream_cleanup(&data);
+    }
 #endif // defined(AVS_COMMONS_WITH_AVS_PERSISTENCE) &&
        // defined(AVS_COMMONS_STREAM_WITH_FILE)
 
@@ -624,6 +635,7 @@ static int demo_init(anjay_demo_t *demo, cmdline_args_t *cmdline_args) {
 #    endif // ANJAY_WITH_ATTR_STORAGE
 #    ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
     demo->dm_persistence_file = cmdline_args->dm_persistence_file;
+    demo->session_state_file = cmdline_args->session_state_file;
 #    endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
            // defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
 #endif     // AVS_COMMONS_STREAM_WITH_FILE
@@ -738,6 +750,17 @@ static int demo_init(anjay_demo_t *demo, cmdline_args_t *cmdline_args) {
         }
         avs_stream_cleanup(&data);
     }
+    if (cmdline_args->session_state_file) {
+        avs_stream_t *data =
+                avs_stream_file_create(cmdline_args->session_state_file,
+                                       AVS_STREAM_FILE_READ);
+        if (!data
+                || avs_is_err(anjay_session_state_restore(demo->anjay, data))) {
+            demo_log(WARNING, "Cannot restore session state from file %s",
+                     cmdline_args->session_state_file);
+        }
+        avs_stream_cleanup(&data);
+    }
 #endif // defined(AVS_COMMONS_WITH_AVS_PERSISTENCE) &&
        // defined(AVS_COMMONS_STREAM_WITH_FILE)
 
@@ -804,7 +827,8 @@ static int demo_init(anjay_demo_t *demo, cmdline_args_t *cmdline_args) {
 #    ifdef ANJAY_WITH_SEND
                 cmdline_args->advanced_fw_update_use_send,
 #    endif // ANJAY_WITH_SEND
-                cmdline_args->advanced_fw_update_auto_suspend)) {
+                cmdline_args->advanced_fw_update_auto_suspend,
+                cmdline_args->advanced_fw_update_max_downloads)) {
         return -1;
     }
 #endif // ANJAY_WITH_MODULE_ADVANCED_FW_UPDATE
@@ -59,6 +59,7 @@ struct anjay_demo_struct {
 #    endif // ANJAY_WITH_ATTR_STORAGE
 #    ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
     const char *dm_persistence_file;
+    const char *session_state_file;
 #    endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
 #endif     // AVS_COMMONS_STREAM_WITH_FILE
 
@@ -95,6 +95,7 @@ static const cmdline_args_t DEFAULT_CMDLINE_ARGS = {
 #    endif // ANJAY_WITH_ATTR_STORAGE
 #    ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
     .dm_persistence_file = NULL,
+    .session_state_file = NULL,
 #    endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
 #endif     // AVS_COMMONS_STREAM_WITH_FILE
     .disable_legacy_server_initiated_bootstrap = false,
@@ -446,6 +447,10 @@ static void print_help(const struct option *options) {
         { 289, "PERSISTENCE_FILE", NULL,
           "File to load Server, Security and Access Control object contents at "
           "startup, and store it at shutdown" },
+        { 349, "PERSISTENCE_FILE", NULL,
+          "File to load the server connection session state (DTLS session "
+          "resumption data, last bound local ports) from at startup, and store "
+          "it at shutdown" },
 #endif // defined(AVS_COMMONS_WITH_AVS_PERSISTENCE) &&
        // defined(AVS_COMMONS_STREAM_WITH_FILE)
 #ifdef ANJAY_WITH_SECURITY_STRUCTURED
@@ -540,6 +545,9 @@ static void print_help(const struct option *options) {
         { 334, "TIMEOUT", NULL,
           "Request timeout (in seconds) to use for Advanced Firmware Update "
           "downloads performed over CoAP+TCP and HTTP" },
+        { 350, "COUNT", "1",
+          "Maximum number of Advanced Firmware Update packages downloaded in "
+          "parallel" },
 #endif // ANJAY_WITH_MODULE_ADVANCED_FW_UPDATE
 #ifdef ANJAY_WITH_MODULE_SW_MGMT
         { 335, "RESULT", NULL,
@@ -936,6 +944,7 @@ int demo_parse_argv(cmdline_args_t *parsed_args, int argc, char *argv[]) {
 #endif // ANJAY_WITH_LWM2M11
 #if defined(AVS_COMMONS_WITH_AVS_PERSISTENCE) && defined(AVS_COMMONS_STREAM_WITH_FILE)
         { "dm-persistence-file",           required_argument, 0, 289 },
+        { "session-state-persistence-file", required_argument, 0, 349 },
 #endif // defined(AVS_COMMONS_WITH_AVS_PERSISTENCE) && defined(AVS_COMMONS_STREAM_WITH_FILE)
 #ifdef ANJAY_WITH_SECURITY_STRUCTURED
         { "use-external-security-info",    no_argument,       0, 298 },
@@ -978,6 +987,7 @@ int demo_parse_argv(cmdline_args_t *parsed_args, int argc, char *argv[]) {
 #endif // ANJAY_WITH_MODULE_FW_UPDATE
 #ifdef ANJAY_WITH_MODULE_ADVANCED_FW_UPDATE
         { "afu-tcp-request-timeout",       required_argument, 0, 334 },
+        { "afu-max-concurrent-downloads",  required_argument, 0, 350 },
 #endif // ANJAY_WITH_MODULE_ADVANCED_FW_UPDATE
 #ifdef ANJAY_WITH_MODULE_SW_MGMT
         { "delayed-sw-mgmt-result",        required_argument, 0, 335 },
@@ -1599,6 +1609,9 @@ int demo_parse_argv(cmdline_args_t *parsed_args, int argc, char *argv[]) {
         case 289:
             parsed_args->dm_persistence_file = optarg;
             break;
+        case 349:
+            parsed_args->session_state_file = optarg;
+            break;
 #endif // defined(AVS_COMMONS_WITH_AVS_PERSISTENCE) &&
        // defined(AVS_COMMONS_STREAM_WITH_FILE)
 #ifdef ANJAY_WITH_SECURITY_STRUCTURED
@@ -1836,6 +1849,12 @@ int demo_parse_argv(cmdline_args_t *parsed_args, int argc, char *argv[]) {
                     avs_time_duration_from_fscalar(timeout_s, AVS_TIME_S);
             break;
         }
+        case 350:
+            if (parse_size(optarg,
+                           &parsed_args->advanced_fw_update_max_downloads)) {
+                goto finish;
+            }
+            break;
 #endif // ANJAY_WITH_MODULE_ADVANCED_FW_UPDATE
 #ifdef ANJAY_WITH_MODULE_SW_MGMT
         case 335: {
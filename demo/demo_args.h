@@ -83,6 +83,7 @@ typedef struct cmdline_args {
     bool advanced_fw_update_use_send;
 #    endif // ANJAY_WITH_SEND
     bool advanced_fw_update_auto_suspend;
+    size_t advanced_fw_update_max_downloads;
     /**
      * This is a file path to file with original image. After additional
      * image is downloaded, update can be performed. Updating additional
@@ -115,6 +116,7 @@ typedef struct cmdline_args {
 #    endif // ANJAY_WITH_ATTR_STORAGE
 #    ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
     const char *dm_persistence_file;
+    const char *session_state_file;
 #    endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
 #endif     // AVS_COMMONS_STREAM_WITH_FILE
 
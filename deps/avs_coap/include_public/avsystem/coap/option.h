@@ -147,6 +147,34 @@ typedef struct avs_coap_option_block {
 
 /** @} */
 
+/**
+ * Maximum number of distinct option numbers remembered by
+ * @ref avs_coap_options_index_t .
+ */
+#define AVS_COAP_OPTIONS_INDEX_SIZE 8
+
+/**
+ * Private. Offsets of the first occurrence of each distinct option number
+ * present in a parsed options object, used to speed up option lookups.
+ *
+ * The index is built when parsing an incoming message and invalidated by any
+ * modification of the options object. It MUST NOT be accessed directly.
+ */
+typedef struct {
+    struct {
+        uint16_t number;
+        uint16_t offset;
+    } entries[AVS_COAP_OPTIONS_INDEX_SIZE];
+    uint8_t count;
+
+    /**
+     * True if @ref avs_coap_options_index_t#entries cover all distinct option
+     * numbers present in the options object.
+     */
+    bool complete;
+    bool valid;
+} avs_coap_options_index_t;
+
 /**
  * Note: this struct MUST be initialized with either
  * @ref avs_coap_options_create_empty or @ref avs_coap_options_dynamic_init
@@ -165,6 +193,9 @@ typedef struct avs_coap_options {
      * memory.
      */
     bool allocated;
+
+    /** Private. See @ref avs_coap_options_index_t . */
+    avs_coap_options_index_t index;
 } avs_coap_options_t;
 
 /**
@@ -215,6 +246,9 @@ avs_coap_options_create_empty(void *buffer, size_t capacity) {
     opts.size = 0;
     opts.capacity = capacity;
     opts.allocated = false;
+    opts.index.count = 0;
+    opts.index.complete = false;
+    opts.index.valid = false;
     return opts;
 }
 
@@ -235,6 +269,7 @@ static inline void avs_coap_options_cleanup(avs_coap_options_t *opts) {
     opts->size = 0;
     opts->capacity = 0;
     opts->allocated = false;
+    opts->index.valid = false;
 }
 
 /**
@@ -260,6 +295,9 @@ avs_coap_options_dynamic_init_with_size(avs_coap_options_t *opts,
     opts->size = 0;
     opts->capacity = initial_capacity;
     opts->allocated = true;
+    opts->index.count = 0;
+    opts->index.complete = false;
+    opts->index.valid = false;
 
     if (initial_capacity && !opts->begin) {
         avs_coap_options_cleanup(opts);
@@ -30,6 +30,7 @@ extern "C" {
  * avs_coap_streaming_handle_incoming_packet
  * '-> handle_request (avs_coap_streaming_request_handler_t)
  *     '-> avs_coap_streaming_setup_response
+ *         or avs_coap_streaming_setup_async_response
  */
 typedef struct avs_coap_streaming_request_ctx avs_coap_streaming_request_ctx_t;
 
@@ -139,6 +140,90 @@ avs_stream_t *
 avs_coap_streaming_setup_response(avs_coap_streaming_request_ctx_t *ctx,
                                   const avs_coap_response_header_t *response);
 
+/**
+ * Function called when the exchange set up by
+ * @ref avs_coap_streaming_setup_async_response is finished for any reason, to
+ * release resources associated with the payload writer.
+ *
+ * @param arg Payload writer argument, as passed to
+ *            @ref avs_coap_streaming_setup_async_response .
+ */
+typedef void avs_coap_streaming_payload_cleanup_t(void *arg);
+
+/**
+ * Sets up a response that should be sent in response to a previously received
+ * request, and hands the exchange over to the asynchronous server.
+ *
+ * Unlike with @ref avs_coap_streaming_setup_response , the response payload is
+ * not written into a stream. Instead, @p response_writer is called whenever a
+ * chunk of payload needs to be sent. It may be called with any offset,
+ * including one that was already requested before, so the whole payload needs
+ * to be available (e.g. prepared in memory in advance) for the whole lifetime
+ * of the exchange.
+ *
+ * The first chunk is sent after the request handler returns. Requests for any
+ * further BLOCK2 chunks are handled from within subsequent calls to
+ * @ref avs_coap_streaming_handle_incoming_packet , so the request handler does
+ * not block waiting for them.
+ *
+ * The request payload, if any, MUST be fully read before calling this function.
+ * The request handler MUST NOT use the request context for anything other
+ * than returning after a successful call.
+ *
+ * @param ctx                 Context of a request to respond to.
+ *
+ * @param response            Response object to set up.
+ *
+ * @param response_writer     Function to call when the library is ready to
+ *                            send a chunk of payload data. See
+ *                            @ref avs_coap_payload_writer_t for details.
+ *
+ * @param response_writer_arg An opaque argument passed to @p response_writer
+ *                            and @p cleanup .
+ *
+ * @param cleanup             Function to call after the exchange is finished.
+ *                            May be NULL.
+ *
+ * @returns <c>AVS_OK</c> for success, or an error condition for which the
+ *          operation failed. On success, @p cleanup is guaranteed to be called
+ *          exactly once. On failure, it is not called at all, and the caller
+ *          may still respond using @ref avs_coap_streaming_setup_response .
+ */
+avs_error_t avs_coap_streaming_setup_async_response(
+        avs_coap_streaming_request_ctx_t *ctx,
+        const avs_coap_response_header_t *response,
+        avs_coap_payload_writer_t *response_writer,
+        void *response_writer_arg,
+        avs_coap_streaming_payload_cleanup_t *cleanup);
+
+/**
+ * Provides direct access to the unread part of the request payload, without
+ * copying it. This is only possible if the whole request has already been
+ * received, i.e. it was either not a BLOCK1 transfer, or its last chunk has
+ * already been received.
+ *
+ * The payload is NOT consumed from @p payload_stream. The returned pointer
+ * remains valid until the stream is read from, or the request handler returns,
+ * whichever happens first.
+ *
+ * @param payload_stream Stream passed to the request handler as
+ *                       <c>payload_stream</c>.
+ *
+ * @param out_data       Pointer to a variable that will be set to the
+ *                       beginning of the unread payload.
+ *
+ * @param out_size       Pointer to a variable that will be set to the number
+ *                       of unread payload bytes.
+ *
+ * @returns <c>AVS_OK</c> for success, or an error condition if
+ *          @p payload_stream is not a request payload stream, or the payload is
+ *          not available as a whole. In the latter case, the payload needs to
+ *          be read from @p payload_stream as usual.
+ */
+avs_error_t avs_coap_streaming_get_request_payload(avs_stream_t *payload_stream,
+                                                   const void **out_data,
+                                                   size_t *out_size);
+
 /**
  * Receives a CoAP messages from the socket associated with @p ctx and handles
  * them as appropriate.
@@ -715,8 +715,10 @@ client_exchange_send_all(avs_coap_ctx_t *ctx,
 
     if (*exchange_ptr_ptr) {
         if (avs_is_err(err)) {
-            cleanup_exchange(ctx, AVS_LIST_DETACH(*exchange_ptr_ptr), NULL,
-                             failure_state(err));
+            cleanup_exchange(ctx,
+                             _avs_coap_client_exchange_detach(
+                                     ctx, *exchange_ptr_ptr),
+                             NULL, failure_state(err));
         } else {
             avs_coap_exchange_cancel(ctx, (**exchange_ptr_ptr)->id);
         }
@@ -749,9 +751,9 @@ client_exchange_start(avs_coap_ctx_t *ctx,
            && !_avs_coap_client_exchange_request_sent(*insert_ptr)) {
         AVS_LIST_ADVANCE_PTR(&insert_ptr);
     }
-    AVS_LIST_INSERT(insert_ptr, *exchange_ptr);
-    assert(*insert_ptr == *exchange_ptr);
     (*exchange_ptr)->id = _avs_coap_generate_exchange_id(ctx);
+    _avs_coap_client_exchange_insert(ctx, insert_ptr, *exchange_ptr);
+    assert(*insert_ptr == *exchange_ptr);
 
     avs_error_t err = AVS_OK;
     if ((*exchange_ptr)->by_type.client.handle_response) {
@@ -929,8 +931,9 @@ on_request_delivery_finished(avs_coap_ctx_t *ctx,
 
     assert(!exchange_ptr || *exchange_ptr);
     if (exchange_ptr) {
-        cleanup_exchange(ctx, AVS_LIST_DETACH(exchange_ptr), response,
-                         request_state);
+        cleanup_exchange(ctx,
+                         _avs_coap_client_exchange_detach(ctx, exchange_ptr),
+                         response, request_state);
     }
 
     return AVS_COAP_RESPONSE_ACCEPTED;
@@ -1061,7 +1064,9 @@ avs_error_t avs_coap_client_send_async_request(
                 // Not using _avs_coap_client_exchange_cleanup() or
                 // cleanup_exchange(), because this function's docs say that
                 // response_handler is not called on error.
-                AVS_LIST_DELETE(exchange_ptr);
+                AVS_LIST(avs_coap_exchange_t) exchange =
+                        _avs_coap_client_exchange_detach(ctx, exchange_ptr);
+                AVS_LIST_DELETE(&exchange);
             }
         }
         return err;
@@ -346,8 +346,8 @@ send_result_handler(avs_coap_ctx_t *ctx,
 
     // make sure we won't call the handler again during exchange cleanup
     (*exchange_ptr)->by_type.server.delivery_handler = NULL;
-    _avs_coap_server_exchange_cleanup(ctx, AVS_LIST_DETACH(exchange_ptr),
-                                      fail_err);
+    _avs_coap_server_exchange_cleanup(
+            ctx, _avs_coap_server_exchange_detach(ctx, exchange_ptr), fail_err);
 
     return AVS_COAP_RESPONSE_ACCEPTED;
 }
@@ -408,8 +408,9 @@ static avs_error_t server_exchange_send_next_chunk(
     exchange_ptr = _avs_coap_find_server_exchange_ptr_by_id(ctx, id);
 
     if (exchange_ptr && is_exchange_done(*exchange_ptr)) {
-        _avs_coap_server_exchange_cleanup(ctx, AVS_LIST_DETACH(exchange_ptr),
-                                          AVS_OK);
+        _avs_coap_server_exchange_cleanup(
+                ctx, _avs_coap_server_exchange_detach(ctx, exchange_ptr),
+                AVS_OK);
     }
     return err;
 }
@@ -427,7 +428,9 @@ _avs_coap_async_server_abort_timedout_exchanges(avs_coap_ctx_t *ctx) {
             AVS_UINT64_AS_STRING(coap_base->server_exchanges->id.value));
 
         _avs_coap_server_exchange_cleanup(
-                ctx, AVS_LIST_DETACH(&coap_base->server_exchanges),
+                ctx,
+                _avs_coap_server_exchange_detach(ctx,
+                                                 &coap_base->server_exchanges),
                 _avs_coap_err(AVS_COAP_ERR_TIMEOUT));
     }
 
@@ -450,7 +453,7 @@ insert_server_exchange(avs_coap_ctx_t *ctx, avs_coap_exchange_t *new_exchange) {
         }
     }
 
-    AVS_LIST_INSERT(insert_ptr, new_exchange);
+    _avs_coap_server_exchange_insert(ctx, insert_ptr, new_exchange);
     _avs_coap_reschedule_retry_or_request_expired_job(
             ctx, coap_base->server_exchanges->by_type.server.exchange_deadline);
 
@@ -462,7 +465,8 @@ refresh_exchange(avs_coap_ctx_t *ctx,
                  AVS_LIST(avs_coap_exchange_t) *exchange_ptr) {
     (*exchange_ptr)->by_type.server.exchange_deadline =
             get_exchange_deadline(ctx);
-    return insert_server_exchange(ctx, AVS_LIST_DETACH(exchange_ptr));
+    return insert_server_exchange(
+            ctx, _avs_coap_server_exchange_detach(ctx, exchange_ptr));
 }
 
 avs_coap_exchange_id_t avs_coap_server_accept_async_request(
@@ -608,7 +612,9 @@ avs_coap_server_setup_async_response(avs_coap_request_ctx_t *ctx,
     //
     // Deleting the old exchange only if we're sure we have a new copy seems
     // the most robust solution.
-    AVS_LIST_DELETE(response_exchange_ptr);
+    AVS_LIST(avs_coap_exchange_t) old_exchange =
+            _avs_coap_server_exchange_detach(coap_ctx, response_exchange_ptr);
+    AVS_LIST_DELETE(&old_exchange);
     insert_server_exchange(coap_ctx, new_exchange);
 
     ctx->response_setup = true;
@@ -837,17 +843,28 @@ static bool request_matches_exchange(const avs_coap_borrowed_msg_t *request,
 #endif // WITH_AVS_COAP_BLOCK
 }
 
+static bool response_exchange_matches(const void *exchange,
+                                      const void *request) {
+    return avs_coap_code_is_response(
+                   ((const avs_coap_exchange_t *) exchange)->code)
+           && request_matches_exchange(
+                      (const avs_coap_borrowed_msg_t *) request,
+                      (const avs_coap_exchange_t *) exchange);
+}
+
 static AVS_LIST(avs_coap_exchange_t) *
 find_existing_response_exchange_ptr(avs_coap_ctx_t *ctx,
                                     const avs_coap_borrowed_msg_t *request) {
-    AVS_LIST(avs_coap_exchange_t) *it;
-    AVS_LIST_FOREACH_PTR(it, &_avs_coap_get_base(ctx)->server_exchanges) {
-        if (avs_coap_code_is_response((*it)->code)
-                && request_matches_exchange(request, *it)) {
-            return it;
-        }
-    }
-    return NULL;
+    avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
+    // Both ways of matching a request in request_matches_exchange() require
+    // equal code and equal options hashed here
+    return (AVS_LIST(avs_coap_exchange_t) *)
+            _avs_coap_list_index_find_secondary(
+                    &coap_base->server_exchanges_index,
+                    &coap_base->server_exchanges_request_index,
+                    _avs_coap_options_hash_request_key(&request->options,
+                                                       request->code),
+                    response_exchange_matches, request);
 }
 
 #ifdef WITH_AVS_COAP_BLOCK
@@ -958,8 +975,8 @@ static void cleanup_exchange_by_id(avs_coap_ctx_t *ctx,
     AVS_LIST(avs_coap_exchange_t) *exchange_ptr =
             _avs_coap_find_server_exchange_ptr_by_id(ctx, exchange_id);
     if (exchange_ptr) {
-        _avs_coap_server_exchange_cleanup(ctx, AVS_LIST_DETACH(exchange_ptr),
-                                          err);
+        _avs_coap_server_exchange_cleanup(
+                ctx, _avs_coap_server_exchange_detach(ctx, exchange_ptr), err);
     }
 }
 
@@ -1396,7 +1413,8 @@ avs_coap_notify_async(avs_coap_ctx_t *ctx,
 
     avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
 
-    AVS_LIST_INSERT(&coap_base->server_exchanges, exchange);
+    _avs_coap_server_exchange_insert(ctx, &coap_base->server_exchanges,
+                                     exchange);
 
     if (reliability_hint == AVS_COAP_NOTIFY_PREFER_NON_CONFIRMABLE) {
         cancel_notification_on_error(ctx, observe_id, response_header->code);
@@ -1415,7 +1433,9 @@ avs_coap_notify_async(avs_coap_ctx_t *ctx,
         if (exchange_ptr) {
             // Not using _avs_coap_server_exchange_cleanup(), because this
             // function's docs say that delivery_handler is not called on error.
-            AVS_LIST_DELETE(exchange_ptr);
+            AVS_LIST(avs_coap_exchange_t) detached =
+                    _avs_coap_server_exchange_detach(ctx, exchange_ptr);
+            AVS_LIST_DELETE(&detached);
         }
         return err;
     }
@@ -17,6 +17,7 @@
 
 #include "avs_coap_async_client.h"
 #include "avs_coap_async_server.h"
+#include "avs_coap_list_index.h"
 #include "options/avs_coap_option.h"
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
@@ -34,6 +35,19 @@ typedef struct avs_coap_exchange {
     /** Unique ID used to identify an exchange in user code. */
     avs_coap_exchange_id_t id;
 
+    /**
+     * Entry in the by-ID index of the exchange list this exchange belongs to,
+     * see @ref avs_coap_base_t#client_exchanges_index and
+     * @ref avs_coap_base_t#server_exchanges_index .
+     */
+    avs_coap_list_index_entry_t index_entry;
+
+    /**
+     * Entry in @ref avs_coap_base_t#server_exchanges_request_index . Unused
+     * for client exchanges.
+     */
+    avs_coap_list_index_entry_t request_index_entry;
+
     /** User-defined handler used to provide payload for sent message. */
     avs_coap_payload_writer_t *write_payload;
     void *write_payload_arg;
@@ -9,6 +9,8 @@
 
 #include <avs_coap_init.h>
 
+#include <stddef.h>
+
 #include <avsystem/commons/avs_utils.h>
 
 #include <avsystem/coap/code.h>
@@ -65,6 +67,10 @@ void avs_coap_ctx_cleanup(avs_coap_ctx_t **ctx) {
 #ifdef WITH_AVS_COAP_STREAMING_API
         _avs_coap_stream_cleanup(&coap_base->coap_stream);
 #endif // WITH_AVS_COAP_STREAMING_API
+        _avs_coap_list_index_cleanup(&coap_base->client_exchanges_index);
+        _avs_coap_list_index_cleanup(&coap_base->server_exchanges_index);
+        _avs_coap_list_index_cleanup(
+                &coap_base->server_exchanges_request_index);
 
         avs_sched_del(&coap_base->retry_or_request_expired_job);
 
@@ -95,16 +101,69 @@ avs_error_t _avs_coap_ctx_generate_token(avs_crypto_prng_ctx_t *prng_ctx,
     return AVS_OK;
 }
 
+void _avs_coap_base_init_exchange_indices(avs_coap_base_t *base) {
+    _avs_coap_list_index_init(&base->client_exchanges_index,
+                              offsetof(avs_coap_exchange_t, index_entry));
+    _avs_coap_list_index_init(&base->server_exchanges_index,
+                              offsetof(avs_coap_exchange_t, index_entry));
+    _avs_coap_list_index_init(&base->server_exchanges_request_index,
+                              offsetof(avs_coap_exchange_t,
+                                       request_index_entry));
+}
+
+static bool exchange_id_matches(const void *exchange, const void *id) {
+    return avs_coap_exchange_id_equal(
+            ((const avs_coap_exchange_t *) exchange)->id,
+            *(const avs_coap_exchange_id_t *) id);
+}
+
 AVS_LIST(avs_coap_exchange_t) *
-_avs_coap_find_exchange_ptr_by_id(AVS_LIST(avs_coap_exchange_t) *list_ptr,
+_avs_coap_find_exchange_ptr_by_id(const avs_coap_list_index_t *index,
                                   avs_coap_exchange_id_t id) {
-    AVS_LIST(avs_coap_exchange_t) *it;
-    AVS_LIST_FOREACH_PTR(it, list_ptr) {
-        if (avs_coap_exchange_id_equal(id, (*it)->id)) {
-            return it;
-        }
-    }
-    return NULL;
+    return (AVS_LIST(avs_coap_exchange_t) *) _avs_coap_list_index_find(
+            index, _avs_coap_list_index_hash_exchange_id(id),
+            exchange_id_matches, &id);
+}
+
+void _avs_coap_exchange_list_insert(avs_coap_list_index_t *index,
+                                    AVS_LIST(avs_coap_exchange_t) *insert_ptr,
+                                    AVS_LIST(avs_coap_exchange_t) exchange) {
+    assert(avs_coap_exchange_id_valid(exchange->id));
+    AVS_ASSERT(!_avs_coap_find_exchange_ptr_by_id(index, exchange->id),
+               "duplicate exchange ID");
+    _avs_coap_list_index_insert(index, insert_ptr, exchange,
+                                _avs_coap_list_index_hash_exchange_id(
+                                        exchange->id));
+}
+
+AVS_LIST(avs_coap_exchange_t)
+_avs_coap_exchange_list_detach(avs_coap_list_index_t *index,
+                               AVS_LIST(avs_coap_exchange_t) *exchange_ptr) {
+    return (AVS_LIST(avs_coap_exchange_t)) _avs_coap_list_index_detach(
+            index, exchange_ptr);
+}
+
+void _avs_coap_server_exchange_insert(avs_coap_ctx_t *ctx,
+                                      AVS_LIST(avs_coap_exchange_t) *insert_ptr,
+                                      AVS_LIST(avs_coap_exchange_t) exchange) {
+    avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
+    _avs_coap_exchange_list_insert(&coap_base->server_exchanges_index,
+                                   insert_ptr, exchange);
+    _avs_coap_list_index_add(
+            &coap_base->server_exchanges_request_index, exchange,
+            _avs_coap_options_hash_request_key(
+                    &exchange->by_type.server.request_key_options,
+                    exchange->by_type.server.request_code));
+}
+
+AVS_LIST(avs_coap_exchange_t)
+_avs_coap_server_exchange_detach(avs_coap_ctx_t *ctx,
+                                 AVS_LIST(avs_coap_exchange_t) *exchange_ptr) {
+    avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
+    _avs_coap_list_index_remove(&coap_base->server_exchanges_request_index,
+                                *exchange_ptr);
+    return _avs_coap_exchange_list_detach(&coap_base->server_exchanges_index,
+                                          exchange_ptr);
 }
 
 void avs_coap_exchange_cancel(avs_coap_ctx_t *ctx, avs_coap_exchange_id_t id) {
@@ -116,15 +175,16 @@ void avs_coap_exchange_cancel(avs_coap_ctx_t *ctx, avs_coap_exchange_id_t id) {
 
     exchange_ptr = _avs_coap_find_client_exchange_ptr_by_id(ctx, id);
     if (exchange_ptr) {
-        _avs_coap_client_exchange_cleanup(ctx, AVS_LIST_DETACH(exchange_ptr),
-                                          AVS_OK);
+        _avs_coap_client_exchange_cleanup(
+                ctx, _avs_coap_client_exchange_detach(ctx, exchange_ptr),
+                AVS_OK);
         return;
     }
 
     exchange_ptr = _avs_coap_find_server_exchange_ptr_by_id(ctx, id);
     if (exchange_ptr) {
         _avs_coap_server_exchange_cleanup(
-                ctx, AVS_LIST_DETACH(exchange_ptr),
+                ctx, _avs_coap_server_exchange_detach(ctx, exchange_ptr),
                 _avs_coap_err(AVS_COAP_ERR_EXCHANGE_CANCELED));
     }
 }
@@ -256,7 +316,9 @@ _avs_coap_retry_or_request_expired_job(avs_coap_ctx_t *ctx) {
                                                            &exchange_ptr_copy);
         if (avs_is_err(err) && exchange_ptr_copy) {
             _avs_coap_client_exchange_cleanup(
-                    ctx, AVS_LIST_DETACH(exchange_ptr_copy), err);
+                    ctx, _avs_coap_client_exchange_detach(ctx,
+                                                          exchange_ptr_copy),
+                    err);
             exchange_ptr_copy = NULL;
         }
         if (exchange_ptr_copy) {
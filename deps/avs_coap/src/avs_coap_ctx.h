@@ -27,6 +27,7 @@
 #endif // WITH_COAP_STREAMING_API
 
 #include "async/avs_coap_async_server.h"
+#include "avs_coap_list_index.h"
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
@@ -61,15 +62,39 @@ struct avs_coap_base {
      *
      * NOTE: Exchanges for which the initial request packet has not yet been
      * sent are always kept at the beginning of this list.
+     *
+     * NOTE: The list MUST only be modified using
+     * @ref _avs_coap_client_exchange_insert and
+     * @ref _avs_coap_client_exchange_detach , so that
+     * @ref avs_coap_base_t#client_exchanges_index is kept up to date.
      */
     AVS_LIST(struct avs_coap_exchange) client_exchanges;
 
+    /** Index of @ref avs_coap_base_t#client_exchanges by exchange ID. */
+    avs_coap_list_index_t client_exchanges_index;
+
     /**
      * All unfinished asynchronous request exchanges initiated by remote CoAP
      * client (incoming requests/outgoing responses).
+     *
+     * NOTE: The list MUST only be modified using
+     * @ref _avs_coap_server_exchange_insert and
+     * @ref _avs_coap_server_exchange_detach , so that
+     * @ref avs_coap_base_t#server_exchanges_index and
+     * @ref avs_coap_base_t#server_exchanges_request_index are kept up to date.
      */
     AVS_LIST(struct avs_coap_exchange) server_exchanges;
 
+    /** Index of @ref avs_coap_base_t#server_exchanges by exchange ID. */
+    avs_coap_list_index_t server_exchanges_index;
+
+    /**
+     * Secondary index of @ref avs_coap_base_t#server_exchanges by request
+     * code and options that must not change during a BLOCK transfer. Used to
+     * match incoming request blocks to existing exchanges.
+     */
+    avs_coap_list_index_t server_exchanges_request_index;
+
 #ifdef WITH_AVS_COAP_OBSERVE
     /** Active observations. */
     AVS_LIST(avs_coap_observe_t) observes;
@@ -134,6 +159,8 @@ static inline void _avs_coap_in_buffer_release(avs_coap_ctx_t *ctx) {
  * @{
  */
 
+void _avs_coap_base_init_exchange_indices(avs_coap_base_t *base);
+
 static inline void _avs_coap_base_init(avs_coap_base_t *base,
                                        avs_coap_ctx_t *coap_ctx,
                                        avs_shared_buffer_t *in_buffer,
@@ -143,6 +170,7 @@ static inline void _avs_coap_base_init(avs_coap_base_t *base,
     base->last_exchange_id = AVS_COAP_EXCHANGE_ID_INVALID;
     base->client_exchanges = NULL;
     base->server_exchanges = NULL;
+    _avs_coap_base_init_exchange_indices(base);
     base->prng_ctx = prng_ctx;
     base->socket = NULL;
     base->in_buffer = in_buffer;
@@ -182,7 +210,7 @@ _avs_coap_generate_exchange_id(avs_coap_ctx_t *ctx) {
 }
 
 AVS_LIST(struct avs_coap_exchange) *
-_avs_coap_find_exchange_ptr_by_id(AVS_LIST(struct avs_coap_exchange) *list_ptr,
+_avs_coap_find_exchange_ptr_by_id(const avs_coap_list_index_t *index,
                                   avs_coap_exchange_id_t id);
 
 AVS_LIST(struct avs_coap_exchange) *_avs_coap_find_exchange_ptr_by_token(
@@ -193,16 +221,58 @@ static inline AVS_LIST(struct avs_coap_exchange) *
 _avs_coap_find_client_exchange_ptr_by_id(avs_coap_ctx_t *ctx,
                                          avs_coap_exchange_id_t id) {
     return _avs_coap_find_exchange_ptr_by_id(
-            &_avs_coap_get_base(ctx)->client_exchanges, id);
+            &_avs_coap_get_base(ctx)->client_exchanges_index, id);
 }
 
 static inline AVS_LIST(struct avs_coap_exchange) *
 _avs_coap_find_server_exchange_ptr_by_id(avs_coap_ctx_t *ctx,
                                          avs_coap_exchange_id_t id) {
     return _avs_coap_find_exchange_ptr_by_id(
-            &_avs_coap_get_base(ctx)->server_exchanges, id);
+            &_avs_coap_get_base(ctx)->server_exchanges_index, id);
 }
 
+/**
+ * Equivalent of AVS_LIST_INSERT(insert_ptr, exchange) for an exchange list
+ * guarded by @p index . @p exchange MUST have its ID already assigned.
+ */
+void _avs_coap_exchange_list_insert(
+        avs_coap_list_index_t *index,
+        AVS_LIST(struct avs_coap_exchange) *insert_ptr,
+        AVS_LIST(struct avs_coap_exchange) exchange);
+
+/**
+ * Equivalent of AVS_LIST_DETACH(exchange_ptr) for an exchange list guarded by
+ * @p index .
+ */
+AVS_LIST(struct avs_coap_exchange)
+_avs_coap_exchange_list_detach(avs_coap_list_index_t *index,
+                               AVS_LIST(struct avs_coap_exchange) *exchange_ptr);
+
+static inline void
+_avs_coap_client_exchange_insert(avs_coap_ctx_t *ctx,
+                                 AVS_LIST(struct avs_coap_exchange) *insert_ptr,
+                                 AVS_LIST(struct avs_coap_exchange) exchange) {
+    _avs_coap_exchange_list_insert(
+            &_avs_coap_get_base(ctx)->client_exchanges_index, insert_ptr,
+            exchange);
+}
+
+static inline AVS_LIST(struct avs_coap_exchange)
+_avs_coap_client_exchange_detach(
+        avs_coap_ctx_t *ctx, AVS_LIST(struct avs_coap_exchange) *exchange_ptr) {
+    return _avs_coap_exchange_list_detach(
+            &_avs_coap_get_base(ctx)->client_exchanges_index, exchange_ptr);
+}
+
+void _avs_coap_server_exchange_insert(
+        avs_coap_ctx_t *ctx,
+        AVS_LIST(struct avs_coap_exchange) *insert_ptr,
+        AVS_LIST(struct avs_coap_exchange) exchange);
+
+AVS_LIST(struct avs_coap_exchange)
+_avs_coap_server_exchange_detach(
+        avs_coap_ctx_t *ctx, AVS_LIST(struct avs_coap_exchange) *exchange_ptr);
+
 static inline AVS_LIST(struct avs_coap_exchange)
 _avs_coap_find_client_exchange_by_id(avs_coap_ctx_t *ctx,
                                      avs_coap_exchange_id_t id) {
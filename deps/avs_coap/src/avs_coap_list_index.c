@@ -0,0 +1,254 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem CoAP library
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avs_coap_init.h>
+
+#include <assert.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_list.h>
+#include <avsystem/commons/avs_memory.h>
+
+#define MODULE_NAME coap
+#include <avs_coap_x_log_config.h>
+
+#include "avs_coap_list_index.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+static inline avs_coap_list_index_entry_t **
+get_buckets(avs_coap_list_index_t *index) {
+    return index->buckets ? index->buckets : index->initial_buckets;
+}
+
+static inline avs_coap_list_index_entry_t *
+get_entry(const avs_coap_list_index_t *index, void *element) {
+    return (avs_coap_list_index_entry_t *) ((char *) element
+                                            + index->entry_offset);
+}
+
+static inline void **get_next_slot(AVS_LIST(char) element) {
+    return (void **) AVS_LIST_NEXT_PTR(element);
+}
+
+void _avs_coap_list_index_init(avs_coap_list_index_t *index,
+                               size_t entry_offset) {
+    memset(index, 0, sizeof(*index));
+    index->bucket_count = AVS_COAP_LIST_INDEX_INITIAL_BUCKETS;
+    index->entry_offset = entry_offset;
+}
+
+void _avs_coap_list_index_cleanup(avs_coap_list_index_t *index) {
+    AVS_ASSERT(!index->size, "indexed list must be emptied before cleanup");
+    avs_free(index->buckets);
+    _avs_coap_list_index_init(index, index->entry_offset);
+}
+
+static void bucket_add(avs_coap_list_index_entry_t **buckets,
+                       size_t bucket_count,
+                       avs_coap_list_index_entry_t *entry) {
+    avs_coap_list_index_entry_t **bucket =
+            &buckets[entry->hash & (bucket_count - 1)];
+    entry->bucket_next = *bucket;
+    *bucket = entry;
+}
+
+static void bucket_remove(avs_coap_list_index_t *index,
+                          avs_coap_list_index_entry_t *entry) {
+    avs_coap_list_index_entry_t **it =
+            &get_buckets(index)[entry->hash & (index->bucket_count - 1)];
+    while (*it != entry) {
+        assert(*it);
+        it = &(*it)->bucket_next;
+    }
+    *it = entry->bucket_next;
+    entry->bucket_next = NULL;
+}
+
+static void try_grow(avs_coap_list_index_t *index) {
+    const size_t new_bucket_count = 2 * index->bucket_count;
+    avs_coap_list_index_entry_t **new_buckets =
+            (avs_coap_list_index_entry_t **) avs_calloc(
+                    new_bucket_count, sizeof(*new_buckets));
+    if (!new_buckets) {
+        // Not a fatal condition; lookups just become slower
+        LOG(DEBUG, _("could not grow list index to ") "%u" _(" buckets"),
+            (unsigned) new_bucket_count);
+        return;
+    }
+
+    avs_coap_list_index_entry_t **old_buckets = get_buckets(index);
+    for (size_t i = 0; i < index->bucket_count; ++i) {
+        while (old_buckets[i]) {
+            avs_coap_list_index_entry_t *entry = old_buckets[i];
+            old_buckets[i] = entry->bucket_next;
+            bucket_add(new_buckets, new_bucket_count, entry);
+        }
+    }
+
+    avs_free(index->buckets);
+    index->buckets = new_buckets;
+    index->bucket_count = new_bucket_count;
+}
+
+static void add_entry(avs_coap_list_index_t *index,
+                      avs_coap_list_index_entry_t *entry,
+                      uint32_t hash) {
+    entry->hash = hash;
+    if (index->size >= index->bucket_count) {
+        try_grow(index);
+    }
+    bucket_add(get_buckets(index), index->bucket_count, entry);
+    ++index->size;
+}
+
+static void remove_entry(avs_coap_list_index_t *index,
+                         avs_coap_list_index_entry_t *entry) {
+    bucket_remove(index, entry);
+    assert(index->size > 0);
+    --index->size;
+}
+
+void _avs_coap_list_index_insert(avs_coap_list_index_t *index,
+                                 void *list_slot,
+                                 void *element,
+                                 uint32_t hash) {
+    assert(list_slot);
+    assert(element);
+
+    AVS_LIST(char) *slot = (AVS_LIST(char) *) list_slot;
+    AVS_LIST(char) new_element = (AVS_LIST(char)) element;
+    assert(!AVS_LIST_NEXT(new_element));
+    AVS_LIST_INSERT(slot, new_element);
+
+    avs_coap_list_index_entry_t *entry = get_entry(index, element);
+    entry->list_slot = (void **) slot;
+
+    AVS_LIST(char) next = AVS_LIST_NEXT(new_element);
+    if (next) {
+        get_entry(index, next)->list_slot = get_next_slot(new_element);
+    }
+
+    add_entry(index, entry, hash);
+}
+
+void *_avs_coap_list_index_detach(avs_coap_list_index_t *index,
+                                  void *element_slot) {
+    assert(element_slot);
+    AVS_LIST(char) *slot = (AVS_LIST(char) *) element_slot;
+    assert(*slot);
+
+    avs_coap_list_index_entry_t *entry = get_entry(index, *slot);
+    assert(entry->list_slot == (void **) slot);
+    remove_entry(index, entry);
+    entry->list_slot = NULL;
+
+    AVS_LIST(char) detached = AVS_LIST_DETACH(slot);
+    if (*slot) {
+        get_entry(index, *slot)->list_slot = (void **) slot;
+    }
+    return detached;
+}
+
+void _avs_coap_list_index_add(avs_coap_list_index_t *index,
+                              void *element,
+                              uint32_t hash) {
+    assert(element);
+    avs_coap_list_index_entry_t *entry = get_entry(index, element);
+    entry->list_slot = NULL;
+    add_entry(index, entry, hash);
+}
+
+void _avs_coap_list_index_remove(avs_coap_list_index_t *index, void *element) {
+    assert(element);
+    remove_entry(index, get_entry(index, element));
+}
+
+static bool element_precedes(AVS_LIST(const char) first,
+                             AVS_LIST(const char) second) {
+    AVS_LIST(const char) it = first;
+    AVS_LIST_ADVANCE(&it);
+    AVS_LIST_ITERATE(it) {
+        if (it == second) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void *find_element(const avs_coap_list_index_t *index,
+                          uint32_t hash,
+                          avs_coap_list_index_matcher_t *matcher,
+                          const void *key) {
+    void *result = NULL;
+    avs_coap_list_index_entry_t *it =
+            (index->buckets ? index->buckets : index->initial_buckets)
+                    [hash & (index->bucket_count - 1)];
+    for (; it; it = it->bucket_next) {
+        if (it->hash == hash) {
+            void *element = (char *) it - index->entry_offset;
+            // Bucket order is unrelated to list order; in the rare case of
+            // multiple matches, return the same element as a linear search
+            if (matcher(element, key)
+                    && (!result
+                        || element_precedes((AVS_LIST(const char)) element,
+                                            (AVS_LIST(const char)) result))) {
+                result = element;
+            }
+        }
+    }
+    return result;
+}
+
+void *_avs_coap_list_index_find(const avs_coap_list_index_t *index,
+                                uint32_t hash,
+                                avs_coap_list_index_matcher_t *matcher,
+                                const void *key) {
+    return _avs_coap_list_index_find_secondary(index, index, hash, matcher,
+                                               key);
+}
+
+void *_avs_coap_list_index_find_secondary(
+        const avs_coap_list_index_t *primary,
+        const avs_coap_list_index_t *secondary,
+        uint32_t hash,
+        avs_coap_list_index_matcher_t *matcher,
+        const void *key) {
+    void *element = find_element(secondary, hash, matcher, key);
+    if (!element) {
+        return NULL;
+    }
+    avs_coap_list_index_entry_t *entry = get_entry(primary, element);
+    assert(*entry->list_slot == element);
+    return entry->list_slot;
+}
+
+uint32_t _avs_coap_list_index_hash_finish(uint32_t hash) {
+    // finalizer of MurmurHash3
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bU;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35U;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+uint32_t _avs_coap_list_index_hash_exchange_id(avs_coap_exchange_id_t id) {
+    return _avs_coap_list_index_hash_finish((uint32_t) id.value
+                                            ^ (uint32_t) (id.value >> 32));
+}
+
+uint32_t _avs_coap_list_index_hash_token(const avs_coap_token_t *token) {
+    return _avs_coap_list_index_hash_finish(_avs_coap_list_index_hash_update(
+            AVS_COAP_LIST_INDEX_HASH_INIT, token->bytes, token->size));
+}
+
+uint32_t _avs_coap_list_index_hash_msg_id(uint16_t msg_id) {
+    return _avs_coap_list_index_hash_finish(msg_id);
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem CoAP library
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef AVS_COAP_SRC_LIST_INDEX_H
+#define AVS_COAP_SRC_LIST_INDEX_H
+
+#include <avsystem/commons/avs_defs.h>
+
+#include <avsystem/coap/async_exchange.h>
+#include <avsystem/coap/token.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Number of hash buckets available before any dynamic allocation happens. The
+ * bucket array is grown (doubled) whenever the number of indexed elements
+ * exceeds the number of buckets. If that allocation fails, the index keeps
+ * working with longer chains.
+ */
+#define AVS_COAP_LIST_INDEX_INITIAL_BUCKETS 8
+
+/**
+ * Intrusive entry that needs to be embedded in every element of an AVS_LIST
+ * that is managed through @ref avs_coap_list_index_t .
+ */
+typedef struct avs_coap_list_index_entry {
+    /** Next entry in the same hash bucket. */
+    struct avs_coap_list_index_entry *bucket_next;
+    /**
+     * AVS_LIST slot (either the list head, or "next" pointer of the previous
+     * element) that currently points to the element containing this entry.
+     * Always NULL for entries of a secondary index.
+     */
+    void **list_slot;
+    /** Cached hash of the element key. */
+    uint32_t hash;
+} avs_coap_list_index_entry_t;
+
+/**
+ * Hash index over elements of a single AVS_LIST.
+ *
+ * Lookups return the list slot pointing to the matching element, i.e. the
+ * same thing as a linear search with AVS_LIST_FOREACH_PTR would, so the result
+ * may be passed directly to AVS_LIST_DETACH()-like operations - as long as
+ * all modifications of the list are performed through
+ * @ref _avs_coap_list_index_insert and @ref _avs_coap_list_index_detach .
+ *
+ * Iterating over the list and modifying elements in-place (as long as the
+ * indexed key does not change) is still allowed without involving the index.
+ *
+ * The same list may additionally be indexed by a different key using a
+ * secondary index, i.e. another instance of this structure, whose elements
+ * are only added with @ref _avs_coap_list_index_add and removed with
+ * @ref _avs_coap_list_index_remove - the list itself is then only modified
+ * through the primary index. Each index requires a separate
+ * @ref avs_coap_list_index_entry_t in every element.
+ *
+ * Keys do not need to be unique. If multiple elements match, the one that
+ * comes first in the list is found.
+ */
+typedef struct {
+    /**
+     * Dynamically allocated bucket array, or NULL if
+     * @ref avs_coap_list_index_t#initial_buckets are in use.
+     */
+    avs_coap_list_index_entry_t **buckets;
+    /** Number of buckets; always a power of two. */
+    size_t bucket_count;
+    /** Number of indexed elements. */
+    size_t size;
+    /**
+     * Offset of @ref avs_coap_list_index_entry_t within the list element.
+     */
+    size_t entry_offset;
+    avs_coap_list_index_entry_t
+            *initial_buckets[AVS_COAP_LIST_INDEX_INITIAL_BUCKETS];
+} avs_coap_list_index_t;
+
+/**
+ * Predicate used to compare a list element against a lookup key.
+ */
+typedef bool avs_coap_list_index_matcher_t(const void *element,
+                                           const void *key);
+
+void _avs_coap_list_index_init(avs_coap_list_index_t *index,
+                               size_t entry_offset);
+
+/**
+ * Frees any dynamically allocated resources of @p index . The indexed list is
+ * NOT freed - it is expected to be empty already.
+ */
+void _avs_coap_list_index_cleanup(avs_coap_list_index_t *index);
+
+/**
+ * Equivalent of AVS_LIST_INSERT(list_slot, element) that also adds
+ * @p element to @p index under the given @p hash .
+ *
+ * @param index     Index associated with the list.
+ * @param list_slot Pointer to AVS_LIST(T) slot at which to insert the element.
+ * @param element   Detached AVS_LIST(T) element to insert.
+ * @param hash      Hash of the key of @p element .
+ */
+void _avs_coap_list_index_insert(avs_coap_list_index_t *index,
+                                 void *list_slot,
+                                 void *element,
+                                 uint32_t hash);
+
+/**
+ * Equivalent of AVS_LIST_DETACH(element_slot) that also removes the detached
+ * element from @p index .
+ *
+ * @returns The detached element.
+ */
+void *_avs_coap_list_index_detach(avs_coap_list_index_t *index,
+                                  void *element_slot);
+
+/**
+ * Adds @p element, already inserted into the list through the primary index,
+ * to a secondary @p index under the given @p hash .
+ */
+void _avs_coap_list_index_add(avs_coap_list_index_t *index,
+                              void *element,
+                              uint32_t hash);
+
+/**
+ * Removes @p element from a secondary @p index . MUST be called before the
+ * element is detached from the list through the primary index.
+ */
+void _avs_coap_list_index_remove(avs_coap_list_index_t *index, void *element);
+
+/**
+ * Finds a list element with a given key.
+ *
+ * @returns AVS_LIST(T) slot pointing to the first element in the list with
+ *          matching @p hash for which @p matcher returned true, or NULL if
+ *          there is no such element.
+ */
+void *_avs_coap_list_index_find(const avs_coap_list_index_t *index,
+                                uint32_t hash,
+                                avs_coap_list_index_matcher_t *matcher,
+                                const void *key);
+
+/**
+ * Equivalent of @ref _avs_coap_list_index_find that looks the element up in
+ * a @p secondary index, and returns the list slot tracked by the @p primary
+ * one.
+ */
+void *_avs_coap_list_index_find_secondary(
+        const avs_coap_list_index_t *primary,
+        const avs_coap_list_index_t *secondary,
+        uint32_t hash,
+        avs_coap_list_index_matcher_t *matcher,
+        const void *key);
+
+#define AVS_COAP_LIST_INDEX_HASH_INIT 2166136261U
+
+/**
+ * Feeds @p size bytes of @p data into a hash calculation started with
+ * @ref AVS_COAP_LIST_INDEX_HASH_INIT . The result needs to be passed through
+ * @ref _avs_coap_list_index_hash_finish before use.
+ */
+static inline uint32_t _avs_coap_list_index_hash_update(uint32_t hash,
+                                                        const void *data,
+                                                        size_t size) {
+    // FNV-1a
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= ((const uint8_t *) data)[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+uint32_t _avs_coap_list_index_hash_finish(uint32_t hash);
+
+uint32_t _avs_coap_list_index_hash_exchange_id(avs_coap_exchange_id_t id);
+
+uint32_t _avs_coap_list_index_hash_token(const avs_coap_token_t *token);
+
+uint32_t _avs_coap_list_index_hash_msg_id(uint16_t msg_id);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif // AVS_COAP_SRC_LIST_INDEX_H
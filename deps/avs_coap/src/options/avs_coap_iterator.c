@@ -15,6 +15,7 @@
 
 #include "options/avs_coap_iterator.h"
 #include "options/avs_coap_option.h"
+#include "options/avs_coap_options.h"
 
 #define MODULE_NAME coap
 #include <avs_coap_x_log_config.h>
@@ -101,6 +102,8 @@ _avs_coap_optit_erase(avs_coap_option_iterator_t *optit) {
     assert(optit);
     assert(!_avs_coap_optit_end(optit));
 
+    _avs_coap_options_invalidate_index(optit->opts);
+
     /*
      *                                                 rest_begin
      *                                                      |
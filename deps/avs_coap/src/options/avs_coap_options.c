@@ -24,6 +24,8 @@
 
 #include "options/avs_coap_options.h"
 
+#include "avs_coap_list_index.h"
+
 #define MAX_OBSERVE_OPTION_VALUE (0xFFFFFF)
 
 VISIBILITY_SOURCE_BEGIN
@@ -501,6 +503,8 @@ avs_error_t avs_coap_options_add_opaque(avs_coap_options_t *opts,
         return err;
     }
 
+    _avs_coap_options_invalidate_index(opts);
+
     avs_coap_option_iterator_t insert_it = _avs_coap_optit_begin(opts);
     while (!_avs_coap_optit_end(&insert_it)
            && _avs_coap_optit_number(&insert_it) <= opt_number) {
@@ -672,9 +676,86 @@ avs_error_t avs_coap_options_add_uint(avs_coap_options_t *opts,
                                        (uint16_t) (value_size - start));
 }
 
+void _avs_coap_options_build_index(avs_coap_options_t *opts) {
+    avs_coap_options_index_t *index = &opts->index;
+    index->count = 0;
+    index->complete = true;
+    index->valid = true;
+
+    for (avs_coap_option_iterator_t it = _avs_coap_optit_begin(opts);
+         !_avs_coap_optit_end(&it);
+         _avs_coap_optit_next(&it)) {
+        const uint32_t opt_number = _avs_coap_optit_number(&it);
+        if (index->count > 0
+                && index->entries[index->count - 1].number == opt_number) {
+            // only the first occurrence of repeated options is remembered
+            continue;
+        }
+
+        const size_t offset = (size_t) ((const uint8_t *) it.curr_opt
+                                        - (const uint8_t *) opts->begin);
+        if (index->count >= AVS_COAP_OPTIONS_INDEX_SIZE
+                || opt_number > UINT16_MAX || offset > UINT16_MAX) {
+            // entries still cover a prefix of option numbers; anything past
+            // the last one is looked up by walking the options
+            index->complete = false;
+            return;
+        }
+
+        index->entries[index->count].number = (uint16_t) opt_number;
+        index->entries[index->count].offset = (uint16_t) offset;
+        ++index->count;
+    }
+}
+
+/**
+ * Looks up the first option with @p opt_number using the option offset index
+ * of @p opts .
+ *
+ * @returns True if the index was able to answer the query; @p *out_opt is then
+ *          set to the found option, or NULL if there is no such option. False
+ *          if the options need to be searched linearly.
+ */
+static bool find_first_opt_indexed(const avs_coap_options_t *opts,
+                                   uint16_t opt_number,
+                                   const avs_coap_option_t **out_opt) {
+    const avs_coap_options_index_t *index = &opts->index;
+    if (!index->valid) {
+        return false;
+    }
+
+    // entries are sorted by option number, just like the options themselves
+    size_t lo = 0;
+    size_t hi = index->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (index->entries[mid].number < opt_number) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo < index->count && index->entries[lo].number == opt_number) {
+        *out_opt = (const avs_coap_option_t *) ((const uint8_t *) opts->begin
+                                                + index->entries[lo].offset);
+        return true;
+    }
+    if (lo < index->count || index->complete) {
+        *out_opt = NULL;
+        return true;
+    }
+    return false;
+}
+
 const avs_coap_option_t *
 _avs_coap_options_find_first_opt(const avs_coap_options_t *opts,
                                  uint16_t opt_number) {
+    const avs_coap_option_t *indexed_opt;
+    if (find_first_opt_indexed(opts, opt_number, &indexed_opt)) {
+        return indexed_opt;
+    }
+
     // TODO: const_cast; maybe const_iterator could be nice?
     for (avs_coap_option_iterator_t it =
                  _avs_coap_optit_begin((avs_coap_options_t *) (intptr_t) opts);
@@ -750,6 +831,10 @@ int avs_coap_options_get_u32(const avs_coap_options_t *opts,
     return _avs_coap_option_u32_value(opt, out_value);
 }
 
+static void optit_seek_end(avs_coap_option_iterator_t *it) {
+    it->curr_opt = (uint8_t *) it->opts->begin + it->opts->size;
+}
+
 static int get_option_it(const avs_coap_options_t *opts,
                          uint16_t option_number,
                          avs_coap_option_iterator_t *it,
@@ -763,16 +848,32 @@ static int get_option_it(const avs_coap_options_t *opts,
     if (!it->opts) {
         // TODO: const_cast; maybe const_iterator could be nice?
         *it = _avs_coap_optit_begin((avs_coap_options_t *) (intptr_t) opts);
+
+        const avs_coap_option_t *first_opt;
+        if (find_first_opt_indexed(opts, option_number, &first_opt)) {
+            if (!first_opt) {
+                optit_seek_end(it);
+                return AVS_COAP_OPTION_MISSING;
+            }
+            it->curr_opt = (void *) (intptr_t) first_opt;
+            it->prev_opt_number =
+                    option_number - _avs_coap_option_delta(first_opt);
+        }
     } else {
         assert(it->opts == opts);
     }
 
     int retval = AVS_COAP_OPTION_MISSING;
     for (; !_avs_coap_optit_end(it); _avs_coap_optit_next(it)) {
-        if (_avs_coap_optit_number(it) == option_number) {
+        const uint32_t curr_opt_number = _avs_coap_optit_number(it);
+        if (curr_opt_number == option_number) {
             retval = fetch_value(_avs_coap_optit_current(it), out_opt_size,
                                  buffer, buffer_size);
             break;
+        } else if (curr_opt_number > option_number) {
+            // options are sorted, there is no point in looking further
+            optit_seek_end(it);
+            break;
         }
     }
 
@@ -1186,6 +1287,7 @@ avs_error_t _avs_coap_options_parse(avs_coap_options_t *out_opts,
 
     // TODO: maybe capacity == 0 could indicate "read-only" options?
     out_opts->capacity = out_opts->size;
+    _avs_coap_options_build_index(out_opts);
 
 #ifdef WITH_AVS_COAP_BLOCK
     /**
@@ -1256,3 +1358,29 @@ avs_coap_options_t _avs_coap_options_copy_request_key(
 
     return copy;
 }
+
+uint32_t _avs_coap_options_hash_request_key(const avs_coap_options_t *opts,
+                                            uint8_t code) {
+    uint32_t hash = _avs_coap_list_index_hash_update(
+            AVS_COAP_LIST_INDEX_HASH_INIT, &code, sizeof(code));
+    avs_coap_option_iterator_t it =
+            _avs_coap_optit_begin((avs_coap_options_t *) (intptr_t) opts);
+
+    for (; !_avs_coap_optit_end(&it); _avs_coap_optit_next(&it)) {
+        const uint32_t opt_num = _avs_coap_optit_number(&it);
+        assert(opt_num <= UINT16_MAX);
+
+        if (option_must_not_change_during_transfer((uint16_t) opt_num)) {
+            const avs_coap_option_t *opt = _avs_coap_optit_current(&it);
+            const uint16_t num16 = (uint16_t) opt_num;
+            const uint32_t size = _avs_coap_option_content_length(opt);
+            hash = _avs_coap_list_index_hash_update(hash, &num16,
+                                                    sizeof(num16));
+            hash = _avs_coap_list_index_hash_update(hash, &size, sizeof(size));
+            hash = _avs_coap_list_index_hash_update(
+                    hash, _avs_coap_option_value(opt), size);
+        }
+    }
+
+    return _avs_coap_list_index_hash_finish(hash);
+}
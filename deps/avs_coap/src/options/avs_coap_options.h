@@ -22,6 +22,21 @@
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
+/**
+ * Marks the option offset index of @p opts as stale. MUST be called by every
+ * function that modifies the serialized options.
+ */
+static inline void
+_avs_coap_options_invalidate_index(avs_coap_options_t *opts) {
+    opts->index.valid = false;
+}
+
+/**
+ * Builds the option offset index used by @ref _avs_coap_options_find_first_opt
+ * and avs_coap_options_get_*_it functions. @p opts MUST be valid.
+ */
+void _avs_coap_options_build_index(avs_coap_options_t *opts);
+
 static inline avs_error_t
 _avs_coap_options_copy_into(avs_coap_options_t *out_dest,
                             const avs_coap_options_t *src) {
@@ -32,6 +47,8 @@ _avs_coap_options_copy_into(avs_coap_options_t *out_dest,
         memcpy(out_dest->begin, src->begin, src->size);
     }
     out_dest->size = src->size;
+    // the index only holds offsets, so it stays valid for the copy
+    out_dest->index = src->index;
     return AVS_OK;
 }
 
@@ -194,6 +211,17 @@ size_t _avs_coap_options_request_key_size(const avs_coap_options_t *opts);
 avs_coap_options_t _avs_coap_options_copy_request_key(
         const avs_coap_options_t *opts, void *buffer, size_t buffer_size);
 
+/**
+ * Calculates a hash of the options in @p opts that need to be equal in all
+ * messages of a single logical exchange (i.e. the ones compared by
+ * @ref _avs_coap_options_is_sequential_block_request ), mixed with @p code .
+ *
+ * Two option sets considered equal by either of the checks used to match
+ * incoming requests to server exchanges always yield the same hash.
+ */
+uint32_t _avs_coap_options_hash_request_key(const avs_coap_options_t *opts,
+                                            uint8_t code);
+
 /**
  * Finds first option with given @p opt_number .
  *
@@ -12,6 +12,7 @@
 #ifdef WITH_AVS_COAP_STREAMING_API
 
 #    include <avsystem/commons/avs_errno.h>
+#    include <avsystem/commons/avs_memory.h>
 #    include <avsystem/commons/avs_utils.h>
 
 #    include <avsystem/coap/code.h>
@@ -108,6 +109,100 @@ avs_coap_streaming_setup_response(avs_coap_streaming_request_ctx_t *ctx,
     return (avs_stream_t *) ctx;
 }
 
+typedef struct {
+    avs_coap_streaming_payload_cleanup_t *cleanup;
+    void *arg;
+} async_response_data_t;
+
+static int async_response_request_handler(
+        avs_coap_request_ctx_t *request_ctx,
+        avs_coap_exchange_id_t request_id,
+        avs_coap_server_request_state_t state,
+        const avs_coap_server_async_request_t *request,
+        const avs_coap_observe_id_t *observe_id,
+        void *data_) {
+    (void) request_ctx;
+    (void) request_id;
+    (void) request;
+    (void) observe_id;
+
+    async_response_data_t *data = (async_response_data_t *) data_;
+    if (state == AVS_COAP_SERVER_REQUEST_CLEANUP) {
+        if (data->cleanup) {
+            data->cleanup(data->arg);
+        }
+        avs_free(data);
+        return 0;
+    }
+    // the whole request has been received before setting up the response,
+    // so this is not supposed to happen
+    return AVS_COAP_CODE_INTERNAL_SERVER_ERROR;
+}
+
+avs_error_t avs_coap_streaming_setup_async_response(
+        avs_coap_streaming_request_ctx_t *ctx,
+        const avs_coap_response_header_t *response,
+        avs_coap_payload_writer_t *response_writer,
+        void *response_writer_arg,
+        avs_coap_streaming_payload_cleanup_t *cleanup) {
+    if (!ctx) {
+        LOG(ERROR, _("no request to respond to"));
+        return avs_errno(AVS_EINVAL);
+    }
+    if (!response) {
+        LOG(ERROR, _("response must be provided"));
+        return avs_errno(AVS_EINVAL);
+    }
+    if (ctx->server_ctx.state
+            != AVS_COAP_STREAMING_SERVER_RECEIVED_LAST_REQUEST_CHUNK) {
+        LOG(ERROR,
+            _("Attempted to call avs_coap_streaming_setup_async_response() "
+              "in an invalid state"));
+        return avs_errno(AVS_EINVAL);
+    }
+
+    async_response_data_t *data =
+            (async_response_data_t *) avs_malloc(sizeof(*data));
+    if (!data) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    data->cleanup = cleanup;
+    data->arg = response_writer_arg;
+
+    avs_error_t err = avs_coap_server_setup_async_response(
+            &_avs_coap_get_base(ctx->server_ctx.coap_ctx)->request_ctx,
+            response, response_writer, response_writer_arg);
+    if (avs_is_err(err)) {
+        avs_free(data);
+        return err;
+    }
+
+    // From now on, the exchange is no longer tied to the streaming request
+    // context, which only lives until the request handler returns.
+    AVS_LIST(avs_coap_exchange_t) *exchange_ptr =
+            _avs_coap_find_server_exchange_ptr_by_id(
+                    ctx->server_ctx.coap_ctx, ctx->server_ctx.exchange_id);
+    assert(exchange_ptr);
+    (*exchange_ptr)->by_type.server.request_handler =
+            async_response_request_handler;
+    (*exchange_ptr)->by_type.server.request_handler_arg = data;
+
+    ctx->server_ctx.state = AVS_COAP_STREAMING_SERVER_SENDING_ASYNC_RESPONSE;
+    return AVS_OK;
+}
+
+static void finish_async_response(avs_coap_streaming_request_ctx_t *ctx) {
+    assert(ctx->server_ctx.state
+           == AVS_COAP_STREAMING_SERVER_SENDING_ASYNC_RESPONSE);
+    // request_handler() will not be called with CLEANUP for this exchange, so
+    // do the equivalent here
+    avs_buffer_free(&ctx->server_ctx.chunk_buffer);
+    avs_coap_options_cleanup(&ctx->request_header.options);
+    avs_coap_options_cleanup(&ctx->response_header.options);
+    ctx->server_ctx.exchange_id = AVS_COAP_EXCHANGE_ID_INVALID;
+    ctx->server_ctx.state = AVS_COAP_STREAMING_SERVER_FINISHED;
+}
+
 static avs_error_t
 try_enter_sending_state(avs_coap_streaming_request_ctx_t *ctx) {
     if (!has_received_request_chunk(&ctx->server_ctx)) {
@@ -442,6 +537,15 @@ static avs_error_t flush_response_chunk(avs_coap_streaming_request_ctx_t *ctx) {
             // differently.
             return try_wait_for_next_chunk_request(&ctx->server_ctx, NULL);
 
+        case AVS_COAP_STREAMING_SERVER_SENDING_ASYNC_RESPONSE: {
+            // Only the first chunk is sent here; requests for the further ones
+            // will be handled by the async server when they arrive.
+            avs_error_t err = _avs_coap_async_incoming_packet_send_response(
+                    ctx->server_ctx.coap_ctx, ctx->error_response_code);
+            finish_async_response(ctx);
+            return err;
+        }
+
         default:;
         }
     }
@@ -450,6 +554,10 @@ static avs_error_t flush_response_chunk(avs_coap_streaming_request_ctx_t *ctx) {
     LOG(ERROR, _("invalid state for flush_request_chunk(), aborting exchange"));
     avs_coap_exchange_cancel(ctx->server_ctx.coap_ctx,
                              ctx->server_ctx.exchange_id);
+    if (ctx->server_ctx.state
+            == AVS_COAP_STREAMING_SERVER_SENDING_ASYNC_RESPONSE) {
+        finish_async_response(ctx);
+    }
     return avs_is_err(ctx->err) ? ctx->err
                                 : _avs_coap_err(AVS_COAP_ERR_ASSERT_FAILED);
 }
@@ -692,6 +800,31 @@ static const avs_stream_v_table_t _AVS_COAP_STREAMING_REQUEST_CTX_VTABLE = {
     .extension_list = AVS_STREAM_V_TABLE_NO_EXTENSIONS
 };
 
+avs_error_t avs_coap_streaming_get_request_payload(avs_stream_t *payload_stream,
+                                                   const void **out_data,
+                                                   size_t *out_size) {
+    avs_coap_streaming_request_ctx_t *streaming_req_ctx =
+            (avs_coap_streaming_request_ctx_t *) payload_stream;
+    if (!streaming_req_ctx || !out_data || !out_size
+            || streaming_req_ctx->vtable
+                           != &_AVS_COAP_STREAMING_REQUEST_CTX_VTABLE) {
+        return avs_errno(AVS_EINVAL);
+    }
+    if (avs_is_err(streaming_req_ctx->err)) {
+        return streaming_req_ctx->err;
+    }
+    // In the RECEIVED_REQUEST_CHUNK state, further chunks would need to be
+    // received into the same buffer, invalidating the pointer.
+    if (streaming_req_ctx->server_ctx.state
+            != AVS_COAP_STREAMING_SERVER_RECEIVED_LAST_REQUEST_CHUNK) {
+        return avs_errno(AVS_EBADF);
+    }
+    *out_data = avs_buffer_data(streaming_req_ctx->server_ctx.chunk_buffer);
+    *out_size =
+            avs_buffer_data_size(streaming_req_ctx->server_ctx.chunk_buffer);
+    return AVS_OK;
+}
+
 static avs_error_t handle_incoming_packet_with_acquired_in_buffer(
         avs_coap_ctx_t *coap_ctx,
         uint8_t *acquired_in_buffer,
@@ -28,6 +28,12 @@ typedef enum {
     AVS_COAP_STREAMING_SERVER_SENDING_FIRST_RESPONSE_CHUNK,
     AVS_COAP_STREAMING_SERVER_SENDING_RESPONSE_CHUNK,
     AVS_COAP_STREAMING_SERVER_SENT_LAST_RESPONSE_CHUNK,
+    /**
+     * Response has been set up using avs_coap_streaming_setup_async_response()
+     * and its first chunk is yet to be sent; after that, the exchange is
+     * handled by the async server alone.
+     */
+    AVS_COAP_STREAMING_SERVER_SENDING_ASYNC_RESPONSE,
     AVS_COAP_STREAMING_SERVER_FINISHED
 } avs_coap_streaming_server_state_t;
 
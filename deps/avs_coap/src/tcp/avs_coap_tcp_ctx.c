@@ -277,6 +277,7 @@ static void coap_tcp_cleanup(avs_coap_ctx_t *ctx_) {
     //  the connection until it has responded to all requests received by it
     //  before the Release message."
     _avs_coap_tcp_cancel_all_pending_requests(ctx);
+    _avs_coap_list_index_cleanup(&ctx->pending_requests_index);
     avs_buffer_free(&ctx->opt_cache.buffer);
     avs_free(ctx);
 }
@@ -374,7 +375,7 @@ coap_tcp_send_message(avs_coap_ctx_t *ctx_,
         }
     } else {
         if (req) {
-            _avs_coap_tcp_remove_pending_request(req);
+            _avs_coap_tcp_remove_pending_request(ctx, req);
         }
         send_abort(ctx);
     }
@@ -953,6 +954,8 @@ avs_coap_ctx_t *avs_coap_tcp_ctx_create(avs_sched_t *sched,
     _avs_coap_base_init(&ctx->base, (avs_coap_ctx_t *) ctx, in_buffer,
                         out_buffer, sched, prng_ctx);
 
+    _avs_coap_tcp_init_pending_requests(ctx);
+
     ctx->vtable = &COAP_TCP_VTABLE;
     ctx->peer_csm.recv_deadline = avs_time_monotonic_now();
     ctx->peer_csm.max_message_size = CSM_MAX_MESSAGE_SIZE_BASE_VALUE;
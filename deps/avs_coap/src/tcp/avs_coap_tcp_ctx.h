@@ -40,6 +40,8 @@ typedef struct avs_coap_tcp_ctx_struct {
     avs_coap_tcp_csm_t peer_csm;
     // Sorted by @ref avs_coap_tcp_pending_request_t#expire_time
     AVS_LIST(avs_coap_tcp_pending_request_t) pending_requests;
+    // Index of pending_requests by token
+    avs_coap_list_index_t pending_requests_index;
     // Timeout defined during creation of CoAP TCP context.
     avs_time_duration_t request_timeout;
 
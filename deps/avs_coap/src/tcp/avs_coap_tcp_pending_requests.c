@@ -16,6 +16,8 @@
 #    include <avsystem/commons/avs_list.h>
 #    include <avsystem/commons/avs_sched.h>
 
+#    include <stddef.h>
+
 #    define MODULE_NAME coap_tcp
 #    include <avs_coap_x_log_config.h>
 
@@ -24,6 +26,7 @@
 VISIBILITY_SOURCE_BEGIN
 
 struct avs_coap_tcp_pending_request_struct {
+    avs_coap_list_index_entry_t index_entry;
     avs_coap_tcp_response_handler_t handler;
     avs_coap_token_t token;
     avs_time_monotonic_t expire_time;
@@ -60,28 +63,40 @@ is_list_ordered_by_expire_time(AVS_LIST(avs_coap_tcp_pending_request_t) list) {
     return true;
 }
 
+void _avs_coap_tcp_init_pending_requests(avs_coap_tcp_ctx_t *ctx) {
+    ctx->pending_requests = NULL;
+    _avs_coap_list_index_init(&ctx->pending_requests_index,
+                              offsetof(avs_coap_tcp_pending_request_t,
+                                       index_entry));
+}
+
 static AVS_LIST(avs_coap_tcp_pending_request_t) *
-insert_pending_request(AVS_LIST(avs_coap_tcp_pending_request_t) *list_ptr,
+insert_pending_request(avs_coap_tcp_ctx_t *ctx,
                        AVS_LIST(avs_coap_tcp_pending_request_t) req) {
+    AVS_LIST(avs_coap_tcp_pending_request_t) *list_ptr =
+            &ctx->pending_requests;
     AVS_LIST_ITERATE_PTR(list_ptr) {
         if (avs_time_monotonic_before(req->expire_time,
                                       (*list_ptr)->expire_time)) {
             break;
         }
     }
-    AVS_LIST_INSERT(list_ptr, req);
+    _avs_coap_list_index_insert(&ctx->pending_requests_index, list_ptr, req,
+                                _avs_coap_list_index_hash_token(&req->token));
 
     assert(*list_ptr == req);
-    AVS_ASSERT(is_list_ordered_by_expire_time(*list_ptr),
+    AVS_ASSERT(is_list_ordered_by_expire_time(ctx->pending_requests),
                "pending request list must be ordered by expire_time");
     return list_ptr;
 }
 
 static avs_coap_tcp_pending_request_t *detach_pending_request(
+        avs_coap_tcp_ctx_t *ctx,
         AVS_LIST(avs_coap_tcp_pending_request_t) *pending_request_ptr) {
     assert(pending_request_ptr);
     assert(*pending_request_ptr);
-    return AVS_LIST_DETACH(pending_request_ptr);
+    return (avs_coap_tcp_pending_request_t *) _avs_coap_list_index_detach(
+            &ctx->pending_requests_index, pending_request_ptr);
 }
 
 static void finish_pending_request_with_error(
@@ -95,7 +110,7 @@ static void finish_pending_request_with_error(
     // Element must be detached to avoid finishing the timed-out request twice
     // when sched_run() is called in response handler.
     avs_coap_tcp_pending_request_t *detached_request =
-            detach_pending_request(pending_request_ptr);
+            detach_pending_request(ctx, pending_request_ptr);
     LOG(TRACE, _("finishing pending request, token ") "%s",
         AVS_COAP_TOKEN_HEX(&detached_request->token));
     (void) call_pending_request_response_handler(ctx, detached_request, NULL,
@@ -112,7 +127,7 @@ static void try_finish_pending_request(
     // Element must be detached to avoid finishing the timed-out request twice
     // when sched_run() is called in response handler.
     avs_coap_tcp_pending_request_t *detached_request =
-            detach_pending_request(pending_request_ptr);
+            detach_pending_request(ctx, pending_request_ptr);
     LOG(TRACE, _("finishing pending request, token ") "%s",
         AVS_COAP_TOKEN_HEX(&detached_request->token));
     avs_coap_send_result_handler_result_t handler_result =
@@ -120,22 +135,26 @@ static void try_finish_pending_request(
                                                   result, err);
     if (msg && result == AVS_COAP_SEND_RESULT_OK
             && handler_result != AVS_COAP_RESPONSE_ACCEPTED) {
-        insert_pending_request(&ctx->pending_requests, detached_request);
+        insert_pending_request(ctx, detached_request);
     } else {
         AVS_LIST_DELETE(&detached_request);
     }
 }
 
+static bool pending_request_token_matches(const void *request,
+                                          const void *token) {
+    return avs_coap_token_equal(
+            &((const avs_coap_tcp_pending_request_t *) request)->token,
+            (const avs_coap_token_t *) token);
+}
+
 static AVS_LIST(avs_coap_tcp_pending_request_t) *
-find_pending_request_ptr_by_token(
-        AVS_LIST(avs_coap_tcp_pending_request_t) *pending_requests,
-        const avs_coap_token_t *token) {
-    AVS_LIST_ITERATE_PTR(pending_requests) {
-        if (avs_coap_token_equal(&(*pending_requests)->token, token)) {
-            return pending_requests;
-        }
-    }
-    return NULL;
+find_pending_request_ptr_by_token(avs_coap_tcp_ctx_t *ctx,
+                                  const avs_coap_token_t *token) {
+    return (AVS_LIST(avs_coap_tcp_pending_request_t) *)
+            _avs_coap_list_index_find(&ctx->pending_requests_index,
+                                      _avs_coap_list_index_hash_token(token),
+                                      pending_request_token_matches, token);
 }
 
 avs_time_monotonic_t
@@ -169,8 +188,7 @@ refresh_timeout(avs_coap_tcp_ctx_t *ctx,
                                           AVS_COAP_SEND_RESULT_FAIL,
                                           avs_errno(AVS_UNKNOWN_ERROR));
     } else {
-        insert_pending_request(&ctx->pending_requests,
-                               AVS_LIST_DETACH(req_ptr));
+        insert_pending_request(ctx, detach_pending_request(ctx, req_ptr));
         _avs_coap_reschedule_retry_or_request_expired_job(
                 (avs_coap_ctx_t *) ctx, (*req_ptr)->expire_time);
     }
@@ -182,8 +200,7 @@ void _avs_coap_tcp_handle_pending_request(
         avs_coap_tcp_pending_request_status_t status,
         avs_error_t err) {
     AVS_LIST(avs_coap_tcp_pending_request_t) *pending_req_ptr =
-            find_pending_request_ptr_by_token(&ctx->pending_requests,
-                                              &msg->token);
+            find_pending_request_ptr_by_token(ctx, &msg->token);
     if (!pending_req_ptr) {
         LOG(DEBUG,
             _("received response does not match any known request, ignoring"));
@@ -202,9 +219,7 @@ void _avs_coap_tcp_handle_pending_request(
                 AVS_COAP_SEND_RESULT_PARTIAL_CONTENT, AVS_OK);
         // Request may be canceled in call above - not directly, but by
         // calling avs_sched_run() in user's handler for example.
-        pending_req_ptr =
-                find_pending_request_ptr_by_token(&ctx->pending_requests,
-                                                  &msg->token);
+        pending_req_ptr = find_pending_request_ptr_by_token(ctx, &msg->token);
         if (pending_req_ptr) {
             refresh_timeout(ctx, pending_req_ptr);
         }
@@ -253,7 +268,7 @@ avs_error_t _avs_coap_tcp_create_pending_request(
         return avs_errno(AVS_UNKNOWN_ERROR);
     }
 
-    *out_request = insert_pending_request(&ctx->pending_requests, req);
+    *out_request = insert_pending_request(ctx, req);
     _avs_coap_reschedule_retry_or_request_expired_job((avs_coap_ctx_t *) ctx,
                                                       req->expire_time);
 
@@ -261,12 +276,15 @@ avs_error_t _avs_coap_tcp_create_pending_request(
 }
 
 void _avs_coap_tcp_remove_pending_request(
+        avs_coap_tcp_ctx_t *ctx,
         AVS_LIST(avs_coap_tcp_pending_request_t) *pending_request_ptr) {
     assert(pending_request_ptr);
     assert(*pending_request_ptr);
     LOG(TRACE, _("removing request with token ") "%s",
         AVS_COAP_TOKEN_HEX(&(*pending_request_ptr)->token));
-    AVS_LIST_DELETE(pending_request_ptr);
+    AVS_LIST(avs_coap_tcp_pending_request_t) detached_request =
+            detach_pending_request(ctx, pending_request_ptr);
+    AVS_LIST_DELETE(&detached_request);
 }
 
 void _avs_coap_tcp_abort_pending_request_by_token(avs_coap_tcp_ctx_t *ctx,
@@ -277,7 +295,7 @@ void _avs_coap_tcp_abort_pending_request_by_token(avs_coap_tcp_ctx_t *ctx,
                        || result == AVS_COAP_SEND_RESULT_FAIL,
                "abort called with success result");
     AVS_LIST(avs_coap_tcp_pending_request_t) *pending_request_ptr =
-            find_pending_request_ptr_by_token(&ctx->pending_requests, token);
+            find_pending_request_ptr_by_token(ctx, token);
     if (pending_request_ptr) {
         LOG(TRACE, _("aborting request with token ") "%s",
             AVS_COAP_TOKEN_HEX(&(*pending_request_ptr)->token));
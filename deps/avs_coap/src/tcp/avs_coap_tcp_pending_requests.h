@@ -33,6 +33,8 @@ typedef struct {
     void *handle_result_arg;
 } avs_coap_tcp_response_handler_t;
 
+void _avs_coap_tcp_init_pending_requests(struct avs_coap_tcp_ctx_struct *ctx);
+
 avs_error_t _avs_coap_tcp_create_pending_request(
         struct avs_coap_tcp_ctx_struct *ctx,
         AVS_LIST(avs_coap_tcp_pending_request_t) **out_request,
@@ -50,6 +52,7 @@ void _avs_coap_tcp_handle_pending_request(
  * Cancels pending request without calling user's handler.
  */
 void _avs_coap_tcp_remove_pending_request(
+        struct avs_coap_tcp_ctx_struct *ctx,
         AVS_LIST(avs_coap_tcp_pending_request_t) *pending_request_ptr);
 
 void _avs_coap_tcp_abort_pending_request_by_token(
@@ -330,6 +330,28 @@ find_unconfirmed_insert_ptr(avs_coap_udp_ctx_t *ctx,
     return list_ptr;
 }
 
+static void
+insert_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                   AVS_LIST(avs_coap_udp_unconfirmed_msg_t) unconfirmed) {
+    _avs_coap_list_index_insert(
+            &ctx->unconfirmed_by_token,
+            find_unconfirmed_insert_ptr(ctx, unconfirmed), unconfirmed,
+            _avs_coap_list_index_hash_token(&unconfirmed->msg.token));
+    _avs_coap_list_index_add(&ctx->unconfirmed_by_msg_id, unconfirmed,
+                             _avs_coap_list_index_hash_msg_id(
+                                     _avs_coap_udp_header_get_id(
+                                             &unconfirmed->msg.header)));
+}
+
+static AVS_LIST(avs_coap_udp_unconfirmed_msg_t)
+detach_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                   AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *unconfirmed_ptr) {
+    _avs_coap_list_index_remove(&ctx->unconfirmed_by_msg_id, *unconfirmed_ptr);
+    return (AVS_LIST(avs_coap_udp_unconfirmed_msg_t))
+            _avs_coap_list_index_detach(&ctx->unconfirmed_by_token,
+                                        unconfirmed_ptr);
+}
+
 static AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *
 find_first_held_unconfirmed_ptr(avs_coap_udp_ctx_t *ctx) {
     AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *unconfirmed_ptr;
@@ -437,9 +459,13 @@ static void resume_next_unconfirmed(avs_coap_udp_ctx_t *ctx) {
 
         // Detach held messages so that they can't get unheld in the send result
         // handler
-        AVS_LIST(avs_coap_udp_unconfirmed_msg_t) held_messages =
-                *unconfirmed_ptr;
-        *unconfirmed_ptr = NULL;
+        AVS_LIST(avs_coap_udp_unconfirmed_msg_t) held_messages = NULL;
+        AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *held_tail = &held_messages;
+        while (*unconfirmed_ptr) {
+            AVS_LIST_INSERT(held_tail,
+                            detach_unconfirmed(ctx, unconfirmed_ptr));
+            held_tail = AVS_LIST_NEXT_PTR(*held_tail);
+        }
 
         while (held_messages) {
             // Do not use fail_unconfirmed - it indirectly calls this function
@@ -462,7 +488,7 @@ static void resume_next_unconfirmed(avs_coap_udp_ctx_t *ctx) {
     }
 
     AVS_LIST(avs_coap_udp_unconfirmed_msg_t) unconfirmed =
-            AVS_LIST_DETACH(unconfirmed_ptr);
+            detach_unconfirmed(ctx, unconfirmed_ptr);
     unconfirmed->hold = false;
     unconfirmed->next_retransmit = next_retransmit;
 
@@ -479,8 +505,7 @@ static void resume_next_unconfirmed(avs_coap_udp_ctx_t *ctx) {
         AVS_LIST_DELETE(&unconfirmed);
     } else {
         // the msg may need to be retransmitted before other started ones
-        AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed),
-                        unconfirmed);
+        insert_unconfirmed(ctx, unconfirmed);
     }
 }
 
@@ -538,8 +563,7 @@ static void try_cleanup_unconfirmed(avs_coap_udp_ctx_t *ctx,
 
     if (response && result == AVS_COAP_SEND_RESULT_OK
             && handler_result != AVS_COAP_RESPONSE_ACCEPTED) {
-        AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed),
-                        unconfirmed);
+        insert_unconfirmed(ctx, unconfirmed);
     } else {
         reschedule_retransmission_job(ctx);
         AVS_LIST_DELETE(&unconfirmed);
@@ -558,25 +582,46 @@ static avs_coap_udp_exchange_direction_t direction_from_code(uint8_t code) {
                    : AVS_COAP_UDP_EXCHANGE_SERVER_NOTIFICATION;
 }
 
+typedef struct {
+    avs_coap_udp_exchange_direction_t direction;
+    const avs_coap_token_t *token;
+    const uint16_t *id;
+} unconfirmed_key_t;
+
+static bool unconfirmed_matches(const void *unconfirmed, const void *key_) {
+    const avs_coap_udp_msg_t *msg =
+            &((const avs_coap_udp_unconfirmed_msg_t *) unconfirmed)->msg;
+    const unconfirmed_key_t *key = (const unconfirmed_key_t *) key_;
+    return (key->direction == AVS_COAP_UDP_EXCHANGE_ANY
+            || key->direction == direction_from_code(msg->header.code))
+           && (!key->token || avs_coap_token_equal(&msg->token, key->token))
+           && (!key->id
+               || _avs_coap_udp_header_get_id(&msg->header) == *key->id);
+}
+
 static AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *
 find_unconfirmed_ptr(avs_coap_udp_ctx_t *ctx,
                      avs_coap_udp_exchange_direction_t direction,
                      const avs_coap_token_t *token,
                      const uint16_t *id) {
-    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *list_ptr =
-            &ctx->unconfirmed_messages;
-
-    AVS_LIST_ITERATE_PTR(list_ptr) {
-        const avs_coap_udp_msg_t *msg = &(*list_ptr)->msg;
-        if ((direction == AVS_COAP_UDP_EXCHANGE_ANY
-             || direction == direction_from_code(msg->header.code))
-                && (!token || avs_coap_token_equal(&msg->token, token))
-                && (!id || _avs_coap_udp_header_get_id(&msg->header) == *id)) {
-            return list_ptr;
-        }
+    assert(token || id);
+    const unconfirmed_key_t key = {
+        .direction = direction,
+        .token = token,
+        .id = id
+    };
+    if (id) {
+        // message IDs are practically unique, so prefer them if available
+        return (AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *)
+                _avs_coap_list_index_find_secondary(
+                        &ctx->unconfirmed_by_token, &ctx->unconfirmed_by_msg_id,
+                        _avs_coap_list_index_hash_msg_id(*id),
+                        unconfirmed_matches, &key);
     }
-
-    return NULL;
+    return (AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *)
+            _avs_coap_list_index_find(&ctx->unconfirmed_by_token,
+                                      _avs_coap_list_index_hash_token(token),
+                                      unconfirmed_matches, &key);
 }
 
 static inline AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *
@@ -622,7 +667,7 @@ detach_unconfirmed_by_token(avs_coap_udp_ctx_t *ctx,
             find_unconfirmed_ptr_by_token(ctx, direction, token);
 
     if (msg_ptr) {
-        return AVS_LIST_DETACH(msg_ptr);
+        return detach_unconfirmed(ctx, msg_ptr);
     }
     return NULL;
 }
@@ -637,7 +682,7 @@ confirm_unconfirmed(avs_coap_udp_ctx_t *ctx,
     AVS_ASSERT(AVS_LIST_FIND_PTR(&ctx->unconfirmed_messages, *msg_ptr),
                "unconfirmed_msg must be enqueued");
 
-    avs_coap_udp_unconfirmed_msg_t *msg = AVS_LIST_DETACH(msg_ptr);
+    avs_coap_udp_unconfirmed_msg_t *msg = detach_unconfirmed(ctx, msg_ptr);
     try_cleanup_unconfirmed(ctx, msg, response, AVS_COAP_SEND_RESULT_OK,
                             AVS_OK);
 }
@@ -652,7 +697,7 @@ static void fail_unconfirmed(avs_coap_udp_ctx_t *ctx,
     AVS_ASSERT(AVS_LIST_FIND_PTR(&ctx->unconfirmed_messages, *msg_ptr),
                "unconfirmed_msg must be enqueued");
 
-    avs_coap_udp_unconfirmed_msg_t *msg = AVS_LIST_DETACH(msg_ptr);
+    avs_coap_udp_unconfirmed_msg_t *msg = detach_unconfirmed(ctx, msg_ptr);
     try_cleanup_unconfirmed(ctx, msg, truncated_msg, AVS_COAP_SEND_RESULT_FAIL,
                             err);
 }
@@ -748,8 +793,8 @@ retransmit_next_message_without_reschedule(avs_coap_udp_ctx_t *ctx) {
     }
 
     unconfirmed->next_retransmit = next_retransmit;
-    unconfirmed = AVS_LIST_DETACH(&ctx->unconfirmed_messages);
-    AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed), unconfirmed);
+    unconfirmed = detach_unconfirmed(ctx, &ctx->unconfirmed_messages);
+    insert_unconfirmed(ctx, unconfirmed);
 }
 
 static avs_time_monotonic_t coap_udp_on_timeout(avs_coap_ctx_t *ctx_) {
@@ -814,7 +859,7 @@ enqueue_unconfirmed(avs_coap_udp_ctx_t *ctx,
         }
     }
 
-    AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed), unconfirmed);
+    insert_unconfirmed(ctx, unconfirmed);
     reschedule_retransmission_job(ctx);
     return AVS_OK;
 }
@@ -1185,12 +1230,12 @@ ack_request(avs_coap_udp_ctx_t *ctx,
     }
 
     avs_coap_udp_unconfirmed_msg_t *unconfirmed =
-            AVS_LIST_DETACH(unconfirmed_ptr);
+            detach_unconfirmed(ctx, unconfirmed_ptr);
     // disable further retransmissions
     unconfirmed->retry_state.retries_left = 0;
     unconfirmed->next_retransmit = next_retransmit;
 
-    AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed), unconfirmed);
+    insert_unconfirmed(ctx, unconfirmed);
     reschedule_retransmission_job(ctx);
 }
 
@@ -1442,10 +1487,12 @@ static void coap_udp_cleanup(avs_coap_ctx_t *ctx_) {
 
     while (ctx->unconfirmed_messages) {
         avs_coap_udp_unconfirmed_msg_t *unconfirmed =
-                AVS_LIST_DETACH(&ctx->unconfirmed_messages);
+                detach_unconfirmed(ctx, &ctx->unconfirmed_messages);
         try_cleanup_unconfirmed(ctx, unconfirmed, NULL,
                                 AVS_COAP_SEND_RESULT_CANCEL, AVS_OK);
     }
+    _avs_coap_list_index_cleanup(&ctx->unconfirmed_by_msg_id);
+    _avs_coap_list_index_cleanup(&ctx->unconfirmed_by_token);
     avs_free(ctx);
 }
 
@@ -1536,6 +1583,12 @@ avs_coap_udp_ctx_create(avs_sched_t *sched,
                         out_buffer, sched, prng_ctx);
 
     ctx->vtable = &COAP_UDP_VTABLE;
+    _avs_coap_list_index_init(&ctx->unconfirmed_by_token,
+                              offsetof(avs_coap_udp_unconfirmed_msg_t,
+                                       token_index_entry));
+    _avs_coap_list_index_init(&ctx->unconfirmed_by_msg_id,
+                              offsetof(avs_coap_udp_unconfirmed_msg_t,
+                                       msg_id_index_entry));
     ctx->last_mtu = SIZE_MAX;
     ctx->tx_params =
             udp_tx_params ? *udp_tx_params : AVS_COAP_DEFAULT_UDP_TX_PARAMS;
@@ -61,6 +61,12 @@ typedef struct {
     /** Time at which this packet has to be retransmitted next time. */
     avs_time_monotonic_t next_retransmit;
 
+    /** Entry of @ref avs_coap_udp_ctx_t#unconfirmed_by_token . */
+    avs_coap_list_index_entry_t token_index_entry;
+
+    /** Entry of @ref avs_coap_udp_ctx_t#unconfirmed_by_msg_id . */
+    avs_coap_list_index_entry_t msg_id_index_entry;
+
     /** CoAP message view. Points to @ref avs_coap_udp_exchange_t#packet . */
     avs_coap_udp_msg_t msg;
 
@@ -106,7 +112,16 @@ typedef struct {
 
     avs_coap_base_t base;
 
+    /**
+     * All modifications of this list MUST be performed through
+     * insert_unconfirmed() and detach_unconfirmed(), so that
+     * @ref avs_coap_udp_ctx_t#unconfirmed_by_token (primary) and
+     * @ref avs_coap_udp_ctx_t#unconfirmed_by_msg_id (secondary) are kept up
+     * to date.
+     */
     AVS_LIST(avs_coap_udp_unconfirmed_msg_t) unconfirmed_messages;
+    avs_coap_list_index_t unconfirmed_by_token;
+    avs_coap_list_index_t unconfirmed_by_msg_id;
 
     avs_net_socket_t *socket;
     size_t last_mtu;
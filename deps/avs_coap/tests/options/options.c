@@ -1102,4 +1102,129 @@ AVS_UNIT_TEST(coap_options, critical_option_validator) {
 
 #    endif // WITH_AVS_COAP_OBSERVE
 
+static avs_coap_options_t parse_options(const avs_coap_options_t *src) {
+    bytes_dispenser_t dispenser = {
+        .read_ptr = (const uint8_t *) src->begin,
+        .bytes_left = src->size
+    };
+    avs_coap_options_t opts;
+    bool truncated;
+    bool payload_marker_reached;
+    ASSERT_OK(_avs_coap_options_parse(&opts, &dispenser, &truncated,
+                                      &payload_marker_reached));
+    ASSERT_EQ(opts.size, src->size);
+    return opts;
+}
+
+AVS_UNIT_TEST(coap_options_index, lookups_on_parsed_request) {
+    uint8_t buf[64];
+    avs_coap_options_t built = avs_coap_options_create_empty(buf, sizeof(buf));
+    ASSERT_OK(avs_coap_options_add_string(&built, AVS_COAP_OPTION_URI_PATH,
+                                          "3"));
+    ASSERT_OK(avs_coap_options_add_string(&built, AVS_COAP_OPTION_URI_PATH,
+                                          "0"));
+    ASSERT_OK(avs_coap_options_add_string(&built, AVS_COAP_OPTION_URI_QUERY,
+                                          "pmin=10"));
+    ASSERT_OK(avs_coap_options_add_u16(&built, AVS_COAP_OPTION_ACCEPT, 112));
+    ASSERT_OK(avs_coap_options_set_content_format(&built, 11542));
+
+    avs_coap_options_t opts = parse_options(&built);
+    ASSERT_TRUE(opts.index.valid);
+    ASSERT_TRUE(opts.index.complete);
+    ASSERT_EQ(opts.index.count, 4);
+
+    uint16_t value;
+    ASSERT_OK(avs_coap_options_get_content_format(&opts, &value));
+    ASSERT_EQ(value, 11542);
+    ASSERT_OK(avs_coap_options_get_u16(&opts, AVS_COAP_OPTION_ACCEPT, &value));
+    ASSERT_EQ(value, 112);
+    ASSERT_EQ(avs_coap_options_get_u16(&opts, AVS_COAP_OPTION_URI_PORT,
+                                       &value),
+              AVS_COAP_OPTION_MISSING);
+    ASSERT_EQ(avs_coap_options_get_u16(&opts, AVS_COAP_OPTION_SIZE1, &value),
+              AVS_COAP_OPTION_MISSING);
+
+    char str[16];
+    size_t str_size;
+    avs_coap_option_iterator_t it = AVS_COAP_OPTION_ITERATOR_EMPTY;
+    ASSERT_OK(avs_coap_options_get_string_it(&opts, AVS_COAP_OPTION_URI_PATH,
+                                             &it, &str_size, str,
+                                             sizeof(str)));
+    ASSERT_EQ_STR(str, "3");
+    ASSERT_OK(avs_coap_options_get_string_it(&opts, AVS_COAP_OPTION_URI_PATH,
+                                             &it, &str_size, str,
+                                             sizeof(str)));
+    ASSERT_EQ_STR(str, "0");
+    ASSERT_EQ(avs_coap_options_get_string_it(&opts, AVS_COAP_OPTION_URI_PATH,
+                                             &it, &str_size, str, sizeof(str)),
+              AVS_COAP_OPTION_MISSING);
+    ASSERT_FAIL(avs_coap_options_skip_it(&it));
+
+    it = AVS_COAP_OPTION_ITERATOR_EMPTY;
+    ASSERT_OK(avs_coap_options_get_string_it(&opts, AVS_COAP_OPTION_URI_QUERY,
+                                             &it, &str_size, str,
+                                             sizeof(str)));
+    ASSERT_EQ_STR(str, "pmin=10");
+
+    it = AVS_COAP_OPTION_ITERATOR_EMPTY;
+    ASSERT_EQ(avs_coap_options_get_string_it(&opts, AVS_COAP_OPTION_URI_HOST,
+                                             &it, &str_size, str, sizeof(str)),
+              AVS_COAP_OPTION_MISSING);
+    ASSERT_FAIL(avs_coap_options_skip_it(&it));
+}
+
+AVS_UNIT_TEST(coap_options_index, invalidated_on_modification) {
+    uint8_t buf[64];
+    avs_coap_options_t built = avs_coap_options_create_empty(buf, sizeof(buf));
+    ASSERT_OK(avs_coap_options_add_string(&built, AVS_COAP_OPTION_URI_PATH,
+                                          "5"));
+    ASSERT_OK(avs_coap_options_add_u16(&built, AVS_COAP_OPTION_ACCEPT, 112));
+
+    uint8_t copy_buf[64];
+    avs_coap_options_t parsed = parse_options(&built);
+    avs_coap_options_t opts =
+            _avs_coap_options_copy(&parsed, copy_buf, sizeof(copy_buf));
+    ASSERT_TRUE(opts.index.valid);
+
+    ASSERT_OK(avs_coap_options_set_content_format(&opts, 60));
+    ASSERT_FALSE(opts.index.valid);
+
+    uint16_t value;
+    ASSERT_OK(avs_coap_options_get_content_format(&opts, &value));
+    ASSERT_EQ(value, 60);
+    ASSERT_OK(avs_coap_options_get_u16(&opts, AVS_COAP_OPTION_ACCEPT, &value));
+    ASSERT_EQ(value, 112);
+
+    _avs_coap_options_build_index(&opts);
+    avs_coap_options_remove_by_number(&opts, AVS_COAP_OPTION_URI_PATH);
+    ASSERT_FALSE(opts.index.valid);
+    ASSERT_OK(avs_coap_options_get_u16(&opts, AVS_COAP_OPTION_ACCEPT, &value));
+    ASSERT_EQ(value, 112);
+    ASSERT_FALSE(_avs_coap_option_exists(&opts, AVS_COAP_OPTION_URI_PATH));
+}
+
+AVS_UNIT_TEST(coap_options_index, more_distinct_options_than_entries) {
+    uint8_t buf[128];
+    avs_coap_options_t built = avs_coap_options_create_empty(buf, sizeof(buf));
+    for (uint16_t i = 0; i < 2 * AVS_COAP_OPTIONS_INDEX_SIZE; ++i) {
+        ASSERT_OK(avs_coap_options_add_u16(&built, (uint16_t) (2 * i + 2),
+                                           i));
+    }
+
+    avs_coap_options_t opts = parse_options(&built);
+    ASSERT_TRUE(opts.index.valid);
+    ASSERT_FALSE(opts.index.complete);
+    ASSERT_EQ(opts.index.count, AVS_COAP_OPTIONS_INDEX_SIZE);
+
+    for (uint16_t i = 0; i < 2 * AVS_COAP_OPTIONS_INDEX_SIZE; ++i) {
+        uint16_t value;
+        ASSERT_OK(avs_coap_options_get_u16(&opts, (uint16_t) (2 * i + 2),
+                                           &value));
+        ASSERT_EQ(value, i);
+        ASSERT_EQ(avs_coap_options_get_u16(&opts, (uint16_t) (2 * i + 1),
+                                           &value),
+                  AVS_COAP_OPTION_MISSING);
+    }
+}
+
 #endif // AVS_UNIT_TESTING
@@ -18,6 +18,8 @@
 
 #    include "./helper_functions.h"
 
+#    include "tcp/avs_coap_tcp_ctx.h"
+
 #    define REQ_HEADER_FROM_REQ(Req)           \
         &(avs_coap_request_header_t) {         \
             .code = (Req)->request_header.code \
@@ -212,6 +214,50 @@ AVS_UNIT_TEST(tcp_async_client, repeated_non_repeatable_critical_option) {
     ASSERT_OK(handle_incoming_packet(env.coap_ctx, NULL, NULL));
 }
 
+AVS_UNIT_TEST(tcp_async_client, many_concurrent_requests_out_of_order) {
+#    define NUM_REQUESTS 256
+#    define RESPONSE_PAYLOAD "raz dwa trzy"
+    test_env_t env __attribute__((cleanup(test_teardown))) = test_setup();
+    response_handler_args_t args
+            __attribute__((cleanup(cleanup_response_handler_args))) =
+                    setup_response_handler_args();
+
+    avs_coap_exchange_id_t ids[NUM_REQUESTS];
+    for (size_t i = 0; i < NUM_REQUESTS; ++i) {
+        const test_msg_t *req = COAP_MSG(GET, TOKEN(nth_token(i + 1)));
+        ASSERT_OK(avs_coap_client_send_async_request(
+                env.coap_ctx, &ids[i], REQ_HEADER_FROM_REQ(req), NULL, NULL,
+                handle_response, &args));
+        expect_send(&env, req);
+        avs_sched_run(env.sched);
+    }
+
+    // Respond in reverse order, and also cancel every third exchange in the
+    // meantime, so that the exchanges are removed from the middle of the list
+    for (size_t i = NUM_REQUESTS; i-- > 0;) {
+        if (i % 3 == 1) {
+            args.next_offset = 0;
+            expect_cancel(&args, ids[i]);
+            avs_coap_exchange_cancel(env.coap_ctx, ids[i]);
+            continue;
+        }
+        const test_msg_t *res = COAP_MSG(CONTENT, TOKEN(nth_token(i + 1)),
+                                         PAYLOAD(RESPONSE_PAYLOAD));
+        expect_recv(&env, res);
+
+        args.next_offset = 0;
+        expect_finished_response(&args, ids[i], res->msg.content.payload,
+                                 res->msg.content.payload_size);
+        expect_has_buffered_data_check(&env, false);
+        ASSERT_OK(handle_incoming_packet(env.coap_ctx, NULL, NULL));
+    }
+
+    ASSERT_NULL(_avs_coap_get_base(env.coap_ctx)->client_exchanges);
+    ASSERT_NULL(((avs_coap_tcp_ctx_t *) env.coap_ctx)->pending_requests);
+#    undef RESPONSE_PAYLOAD
+#    undef NUM_REQUESTS
+}
+
 #    ifdef WITH_AVS_COAP_BLOCK
 
 #        define INVALID_BLOCK2(Seq, Size, Payload) \
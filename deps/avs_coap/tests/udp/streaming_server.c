@@ -26,6 +26,8 @@ typedef struct {
     bool ignore_overlong_request;
     bool expect_failure;
     bool use_peek;
+    bool check_payload_view;
+    bool payload_view_available;
 
     avs_coap_response_header_t response_header;
     const char *response_data;
@@ -53,6 +55,21 @@ static int streaming_handle_request(avs_coap_streaming_request_ctx_t *ctx,
                           args->expected_request_header.options.begin,
                           request->options.size);
 
+    if (args->check_payload_view) {
+        const void *view;
+        size_t view_size;
+        avs_error_t err = avs_coap_streaming_get_request_payload(
+                payload_stream, &view, &view_size);
+        if (args->payload_view_available) {
+            ASSERT_OK(err);
+            ASSERT_EQ(view_size, args->expected_request_data_size);
+            ASSERT_EQ_BYTES_SIZED(view, args->expected_request_data,
+                                  view_size);
+        } else {
+            ASSERT_FAIL(err);
+        }
+    }
+
     size_t offset = 0;
     bool finished = false;
     while (!finished) {
@@ -156,6 +173,8 @@ AVS_UNIT_TEST(udp_streaming_server, small_payload) {
         .expected_request_header = request->request_header,
         .expected_request_data = REQUEST_PAYLOAD,
         .expected_request_data_size = sizeof(REQUEST_PAYLOAD) - 1,
+        .check_payload_view = true,
+        .payload_view_available = true,
         .response_header = {
             .code = response->response_header.code
         },
@@ -205,6 +224,8 @@ AVS_UNIT_TEST(udp_streaming_server, large_payload) {
         .expected_request_header = requests[0]->request_header,
         .expected_request_data = REQUEST_PAYLOAD,
         .expected_request_data_size = sizeof(REQUEST_PAYLOAD) - 1,
+        // first BLOCK1 chunk is not the whole payload
+        .check_payload_view = true,
         .response_header = {
             .code = responses[1]->response_header.code
         },
@@ -885,6 +906,97 @@ AVS_UNIT_TEST(udp_streaming_server, block2_receive_timed_out) {
 #        undef RESPONSE_PAYLOAD
 }
 
+typedef struct {
+    const char *data;
+    size_t size;
+    size_t cleanup_calls;
+} async_response_payload_t;
+
+static int async_response_writer(size_t payload_offset,
+                                 void *payload_buf,
+                                 size_t payload_buf_size,
+                                 size_t *out_payload_chunk_size,
+                                 void *payload_) {
+    async_response_payload_t *payload = (async_response_payload_t *) payload_;
+    ASSERT_TRUE(payload_offset <= payload->size);
+    *out_payload_chunk_size =
+            AVS_MIN(payload_buf_size, payload->size - payload_offset);
+    memcpy(payload_buf, payload->data + payload_offset,
+           *out_payload_chunk_size);
+    return 0;
+}
+
+static void async_response_cleanup(void *payload) {
+    ++((async_response_payload_t *) payload)->cleanup_calls;
+}
+
+static int
+async_response_handle_request(avs_coap_streaming_request_ctx_t *ctx,
+                              const avs_coap_request_header_t *request,
+                              avs_stream_t *payload_stream,
+                              const avs_coap_observe_id_t *observe_id,
+                              void *payload) {
+    (void) request;
+    (void) payload_stream;
+    (void) observe_id;
+
+    ASSERT_OK(avs_coap_streaming_setup_async_response(
+            ctx,
+            &(const avs_coap_response_header_t) {
+                .code = AVS_COAP_CODE_CONTENT
+            },
+            async_response_writer, payload, async_response_cleanup));
+    // the stream is not usable after handing the response over
+    ASSERT_NULL(avs_coap_streaming_setup_response(
+            ctx,
+            &(const avs_coap_response_header_t) {
+                .code = AVS_COAP_CODE_CONTENT
+            }));
+    return 0;
+}
+
+AVS_UNIT_TEST(udp_streaming_server, async_response) {
+#        define RESPONSE_PAYLOAD DATA_1KB "?"
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(CON, GET, ID(1), TOKEN(nth_token(1)), BLOCK2_REQ(1, 1024)),
+    };
+    const test_msg_t *responses[] = {
+        COAP_MSG(ACK, CONTENT, ID(0), TOKEN(nth_token(0)),
+                 BLOCK2_RES(0, 1024, RESPONSE_PAYLOAD)),
+        COAP_MSG(ACK, CONTENT, ID(1), TOKEN(nth_token(1)),
+                 BLOCK2_RES(1, 1024, RESPONSE_PAYLOAD)),
+    };
+
+    async_response_payload_t payload = {
+        .data = RESPONSE_PAYLOAD,
+        .size = sizeof(RESPONSE_PAYLOAD) - 1
+    };
+
+    avs_unit_mocksock_enable_recv_timeout_getsetopt(
+            env.mocksock, avs_time_duration_from_scalar(1, AVS_TIME_S));
+
+    // only the first block is sent from within the request handling
+    expect_recv(&env, requests[0]);
+    expect_send(&env, responses[0]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_streaming_handle_incoming_packet(
+            env.coap_ctx, async_response_handle_request, &payload));
+    ASSERT_EQ(payload.cleanup_calls, 0);
+
+    // the next one is handled without calling the request handler again
+    expect_recv(&env, requests[1]);
+    expect_send(&env, responses[1]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_streaming_handle_incoming_packet(
+            env.coap_ctx, async_response_handle_request, &payload));
+    ASSERT_EQ(payload.cleanup_calls, 1);
+#        undef RESPONSE_PAYLOAD
+}
+
 AVS_UNIT_TEST(udp_streaming_server, connection_closed) {
 #        define REQUEST_PAYLOAD DATA_1KB
     test_env_t env __attribute__((cleanup(test_teardown))) =
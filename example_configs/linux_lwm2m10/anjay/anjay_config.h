@@ -76,6 +76,26 @@
  */
 #define ANJAY_WITH_TRACE_LOGS
 
+/**
+ * Enable deferred formatting of Anjay logs.
+ *
+ * If enabled, log messages generated by Anjay are stored in a lock-free ring
+ * buffer as a format string and raw argument values, and are only formatted
+ * and passed to avs_log when <c>anjay_deferred_log_flush()</c> is called.
+ *
+ * Requires C11 <c>stdatomic.h</c>. Only meaningful if <c>ANJAY_WITH_LOGS</c>
+ * is enabled.
+ */
+/* #undef ANJAY_WITH_DEFERRED_LOGS */
+
+/**
+ * Number of log messages that can be stored in the deferred log buffer. Must be
+ * a power of two.
+ *
+ * Only meaningful if <c>ANJAY_WITH_DEFERRED_LOGS</c> is enabled.
+ */
+#define ANJAY_DEFERRED_LOG_BUFFER_ENTRIES 128
+
 /**
  * Enable core support for Access Control mechanisms.
  *
@@ -125,6 +145,35 @@
  */
 #define ANJAY_WITH_DISCOVER
 
+/**
+ * Cache payloads of Discover and Bootstrap-Discover responses, so that
+ * repeated requests for the same path are served without walking the data
+ * model again.
+ *
+ * Cached payloads are dropped whenever a change is reported through
+ * @ref anjay_notify_changed or @ref anjay_notify_instances_changed, when
+ * Objects are registered or unregistered, and when attributes are modified.
+ * Applications enabling this option MUST report all changes to the set of
+ * present Instances and Resources through these functions.
+ *
+ * Requires <c>ANJAY_WITH_DISCOVER</c> to be enabled.
+ */
+/* #undef ANJAY_WITH_DISCOVER_CACHE */
+
+/**
+ * Generate the whole payload of Read, Discover and Read-Composite responses
+ * into memory before sending it, and serve the subsequent BLOCK2 chunks from
+ * the event loop.
+ *
+ * Without this option, a request handler that generates a response longer than
+ * a single block waits for the requests for subsequent blocks, and all other
+ * activity (other servers, notifications, scheduled jobs, downloads) is put on
+ * hold until the transfer finishes. With it, the handler returns immediately
+ * after sending the first block, at the cost of keeping the whole response
+ * payload in memory until the transfer is finished.
+ */
+/* #undef ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES */
+
 /**
  * Enable support for the LwM2M Information Reporting interface (Observe and
  * Notify operations).
@@ -136,6 +185,24 @@
  */
 #define ANJAY_WITH_OBSERVE
 
+/**
+ * Cache the effective attributes of each observed path along with the
+ * observation, instead of resolving them through the data model on every
+ * notification trigger and pmax rescheduling.
+ *
+ * Cached attributes of all paths are dropped when Attribute Storage is
+ * modified, and when the Default Minimum or Maximum Period Resources or the
+ * set of Instances of the Server object change. Performing Write-Attributes,
+ * or a change to the set of Instances of any other Object, only drops
+ * attributes cached for paths within that Object. Applications enabling this
+ * option MUST report changes to the set of present Instances through
+ * @ref anjay_notify_instances_changed, and MUST NOT change attributes returned
+ * by their own attribute handlers without a Write-Attributes request.
+ *
+ * Requires <c>ANJAY_WITH_OBSERVE</c> to be enabled.
+ */
+/* #undef ANJAY_WITH_OBSERVE_ATTRS_CACHE */
+
 /**
  * Enable support for measuring amount of LwM2M traffic
  * (<c>anjay_get_tx_bytes()</c>, <c>anjay_get_rx_bytes()</c>,
@@ -144,6 +211,13 @@
  */
 #define ANJAY_WITH_NET_STATS
 
+/**
+ * Enable collecting latency histograms of LwM2M operations, data model handler
+ * calls, access control checks and notification flushes, as well as queue
+ * depth statistics, available through the <c>anjay_instr_*()</c> APIs.
+ */
+/* #undef ANJAY_WITH_INSTRUMENTATION */
+
 /**
  * Enable support for communication timestamp
  * (<c>anjay_get_server_last_registration_time()</c>
@@ -170,6 +244,27 @@
  */
 #define ANJAY_WITH_THREAD_SAFETY
 
+/**
+ * Enable answering read-only queries without locking the Anjay mutex.
+ *
+ * If enabled, values returned by <c>anjay_get_tx_bytes()</c>,
+ * <c>anjay_get_rx_bytes()</c>, <c>anjay_get_num_incoming_retransmissions()</c>,
+ * <c>anjay_get_num_outgoing_retransmissions()</c>,
+ * <c>anjay_next_planned_notify_trigger()</c>,
+ * <c>anjay_next_planned_pmax_notify_trigger()</c> and
+ * <c>anjay_has_unsent_notifications()</c> (the latter three only when called
+ * with <c>ANJAY_SSID_ANY</c>) are published into atomic variables, and the
+ * functions read them without waiting for any operation in progress in another
+ * thread. The values are gathered again when the Anjay mutex is released after
+ * an operation that may have changed them (network traffic, server connection
+ * state changes or changes to the observation state); releasing the mutex after
+ * other operations does not incur any additional cost.
+ *
+ * Requires <c>ANJAY_WITH_THREAD_SAFETY</c> to be enabled and C11
+ * <c>stdatomic.h</c> header to be available.
+ */
+/* #undef ANJAY_WITH_LOCK_FREE_QUERIES */
+
 /**
  * Enable standard implementation of an event loop.
  *
@@ -285,6 +380,21 @@
  */
 /* #undef ANJAY_WITHOUT_TLV */
 
+/**
+ * Measure the lengths of nested TLV entities (Object Instances and Multiple
+ * Resources) of Read responses in a separate pass over the data model, so that
+ * the response can be generated without buffering each of them in memory.
+ *
+ * IMPORTANT: All read handlers are called twice for each such Read, so they
+ * MUST be idempotent, i.e. return the same data and have no side effects. If
+ * the data changes between the passes, the Read is performed for the third
+ * time, using the buffering encoder.
+ *
+ * Requires <c>ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES</c>, so that nothing is sent
+ * before the whole response is known to be consistent.
+ */
+/* #undef ANJAY_WITH_TLV_TWO_PASS_READ */
+
 /**
  * Disable support for Plain Text format as specified in LwM2M TS 1.0 and 1.1.
  *
@@ -521,6 +631,14 @@
  */
 /* #undef ANJAY_WITHOUT_MODULE_FW_UPDATE_PUSH_MODE */
 
+/**
+ * Enable support for delta (binary patch) packages in the fw_update module.
+ *
+ * Only meaningful if <c>ANJAY_WITH_MODULE_FW_UPDATE</c> is enabled. Delta
+ * packages are only handled if the <c>read_current</c> handler is implemented.
+ */
+/* #undef ANJAY_WITH_MODULE_FW_UPDATE_DELTA */
+
 /**
  * Enable sw_mgmt module (implementation of the Software Management object).
  */
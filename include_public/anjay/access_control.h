@@ -62,10 +62,58 @@ avs_error_t anjay_access_control_persist(anjay_t *anjay,
 avs_error_t anjay_access_control_restore(anjay_t *anjay,
                                          avs_stream_t *in_stream);
 
+/**
+ * Appends a single record, containing the Access Control Object Instances added
+ * or modified, and the IDs of those removed, since the last successful call to
+ * @ref anjay_access_control_persist, @ref anjay_access_control_restore,
+ * @ref anjay_access_control_journal_append or
+ * @ref anjay_access_control_journal_restore, to the @p journal_stream. Nothing
+ * is written if there are no such changes.
+ *
+ * The journal is only meaningful together with the data most recently written
+ * by @ref anjay_access_control_persist. When compacting it, append the pending
+ * changes with this function before persisting, and truncate the journal only
+ * after the new snapshot has atomically replaced the old one.
+ *
+ * @param anjay          ANJAY object with the Access Control module installed
+ * @param journal_stream stream to append the record to
+ * @returns AVS_OK in case of success, or an error code.
+ */
+avs_error_t anjay_access_control_journal_append(anjay_t *anjay,
+                                                avs_stream_t *journal_stream);
+
+/**
+ * Tries to restore Access Control Object Instances from data written by
+ * @ref anjay_access_control_persist to @p in_stream, followed by the records
+ * written by @ref anjay_access_control_journal_append to @p journal_stream.
+ *
+ * A record that is incomplete or does not match its checksum (e.g. because the
+ * device lost power while appending it) ends the journal - it and all data
+ * after it are ignored.
+ *
+ * Once the journal has been replayed, Instances targeting Objects that are not
+ * registered in @p anjay are dropped. The Access Control Object is modified
+ * only if the whole operation succeeds, in which case its previous contents
+ * are replaced.
+ *
+ * @param anjay          ANJAY object with the Access Control module installed
+ * @param in_stream      stream used for reading Access Control Object
+ *                       Instances; may be NULL if
+ *                       @ref anjay_access_control_persist has never been
+ *                       called, in which case the journal is replayed onto an
+ *                       empty Object
+ * @param journal_stream stream used for reading the journal records
+ * @returns AVS_OK in case of success, or an error code.
+ */
+avs_error_t anjay_access_control_journal_restore(anjay_t *anjay,
+                                                 avs_stream_t *in_stream,
+                                                 avs_stream_t *journal_stream);
+
 /**
  * Checks whether the Access Control Object from Anjay instance has been
- * modified since last successful call to @ref anjay_access_control_persist or
- * @ref anjay_access_control_restore.
+ * modified since last successful call to @ref anjay_access_control_persist,
+ * @ref anjay_access_control_restore, @ref anjay_access_control_journal_append
+ * or @ref anjay_access_control_journal_restore.
  */
 bool anjay_access_control_is_modified(anjay_t *anjay);
 
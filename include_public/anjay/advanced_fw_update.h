@@ -105,6 +105,34 @@ typedef struct {
      * Servers.
      */
     bool prefer_same_socket_downloads;
+
+    /**
+     * If nonzero, downloaded blocks are not passed to
+     * @ref anjay_advanced_fw_update_stream_write_t directly from the download
+     * callback, but copied into a queue of at most this many bytes and written
+     * from a scheduler job. This lets the next block be requested while the
+     * previous one is still being written. If the queue is full, the oldest
+     * blocks are written synchronously, throttling the download down to the
+     * speed of the storage.
+     *
+     * Defaults to 0, i.e. every block is written before requesting the next
+     * one.
+     */
+    size_t deferred_write_queue_size;
+
+    /**
+     * Maximum number of packages downloaded in parallel by different instances.
+     * Downloads requested while the limit is reached are queued, and queued
+     * instances linked (see @ref anjay_advanced_fw_update_set_linked_instances)
+     * with one that is currently being downloaded are started first.
+     *
+     * Each download uses its own CoAP context or HTTP connection, so this is
+     * also the limit of additional sockets and buffers used by the module.
+     *
+     * Defaults to 0, which is equivalent to 1, i.e. packages are downloaded one
+     * after another.
+     */
+    size_t max_concurrent_downloads;
 #ifdef ANJAY_WITH_SEND
     /**
      * Enables using LwM2M Send to report State, Update Result and Firmware
@@ -49,7 +49,9 @@ extern "C" {
 
 /**
  * Checks whether the attribute storage has been modified since last successful
- * call to @ref anjay_attr_storage_persist or @ref anjay_attr_storage_restore.
+ * call to @ref anjay_attr_storage_persist, @ref anjay_attr_storage_restore,
+ * @ref anjay_attr_storage_journal_append or
+ * @ref anjay_attr_storage_journal_restore.
  */
 bool anjay_attr_storage_is_modified(anjay_t *anjay);
 
@@ -87,6 +89,62 @@ avs_error_t anjay_attr_storage_persist(anjay_t *anjay,
  */
 avs_error_t anjay_attr_storage_restore(anjay_t *anjay, avs_stream_t *in_stream);
 
+/**
+ * Appends records describing the entries modified since the last successful
+ * call to @ref anjay_attr_storage_persist, @ref anjay_attr_storage_restore,
+ * @ref anjay_attr_storage_journal_append or
+ * @ref anjay_attr_storage_journal_restore to the @p journal_stream.
+ *
+ * Each record contains the complete state of a single modified Object Instance
+ * entry (or a whole Object entry, in case of Object-level attributes), so the
+ * amount of data written is proportional to the number of modified entries
+ * rather than to the size of the whole Attribute Storage. This makes it
+ * suitable for frequent calls, e.g. after each handled Write-Attributes
+ * request.
+ *
+ * The journal is only meaningful together with the data most recently written
+ * by @ref anjay_attr_storage_persist. Calling that function is equivalent to
+ * compacting the journal, so the journal stream shall be truncated after each
+ * successful call to it. It is recommended to do so periodically, e.g. when
+ * the journal grows beyond some threshold size - see the "Persistence" chapter
+ * of the documentation for an order of operations that is safe against power
+ * failures.
+ *
+ * NOTE: If this function fails, a partially written record may be left in the
+ * stream, and all records appended after it would be ignored during restore.
+ * The journal shall be compacted in such case.
+ *
+ * @param anjay          Anjay instance.
+ * @param journal_stream Stream to append the records to.
+ * @returns AVS_OK in case of success, or an error code.
+ */
+avs_error_t anjay_attr_storage_journal_append(anjay_t *anjay,
+                                              avs_stream_t *journal_stream);
+
+/**
+ * Attempts to restore attribute storage from data written by
+ * @ref anjay_attr_storage_persist to @p in_stream, followed by the records
+ * written by @ref anjay_attr_storage_journal_append to @p journal_stream.
+ *
+ * Records are replayed in order. A record that is incomplete or does not match
+ * its checksum (e.g. because the device lost power while appending it) ends the
+ * journal - it and all data after it are ignored, and the state is restored as
+ * of the last complete record.
+ *
+ * @param anjay          Anjay instance.
+ * @param in_stream      Stream to read the persisted data from. May be NULL if
+ *                       @ref anjay_attr_storage_persist has never been called,
+ *                       in which case the journal is replayed onto an empty
+ *                       Attribute Storage.
+ * @param journal_stream Stream to read the journal records from.
+ * @returns AVS_OK in case of success, or an error code.
+ *
+ * NOTE: if restoration fails, then the Attribute Storage will be untouched.
+ */
+avs_error_t anjay_attr_storage_journal_restore(anjay_t *anjay,
+                                               avs_stream_t *in_stream,
+                                               avs_stream_t *journal_stream);
+
 /**
  * Sets Object level attributes for the specified @p ssid.
  *
@@ -574,6 +574,32 @@ typedef struct anjay_configuration {
     bool rebuild_client_cert_chain;
 #endif // ANJAY_WITH_LWM2M11
 
+#ifdef ANJAY_WITH_SEND
+    /**
+     * Time for which LwM2M Send requests are held before being sent. All
+     * requests to the same LwM2M Server issued within that time are merged
+     * into a single CoAP exchange, carrying a single payload. The finished
+     * handler of each request is called with the result of that exchange.
+     *
+     * Requests deferred using @ref anjay_send_deferrable are also merged when
+     * the connection becomes available again.
+     *
+     * If zero-initialized or set to @c AVS_TIME_DURATION_ZERO, each request is
+     * sent immediately in a separate exchange.
+     */
+    avs_time_duration_t send_coalescing_delay;
+
+    /**
+     * Maximum number of SenML records in a single merged Send payload. A
+     * request is not merged with the preceding ones if that would make the
+     * payload exceed this limit. Ignored if <c>send_coalescing_delay</c> is
+     * not set.
+     *
+     * If set to 0, the number of records is not limited.
+     */
+    size_t send_coalescing_max_records;
+#endif // ANJAY_WITH_SEND
+
 #ifdef ANJAY_WITH_CONN_STATUS_API
     /**
      * @experimental This is experimental server connection status API. This API
@@ -1955,6 +1981,61 @@ avs_error_t anjay_update_dtls_handshake_timeouts(
         anjay_t *anjay,
         avs_net_dtls_handshake_timeouts_t dtls_handshake_timeouts);
 
+/**
+ * Dumps the session state of connections to all known LwM2M Servers
+ * (including the Bootstrap Server) to the @p out_stream, so that it can be
+ * restored using @ref anjay_session_state_restore after a process restart.
+ *
+ * The persisted state includes, for each server connection:
+ *
+ * - the (D)TLS session resumption data, which also carries the negotiated DTLS
+ *   Connection ID if @ref anjay_configuration_t::use_connection_id is enabled
+ *   and the DTLS backend supports it,
+ * - the local port the connection was last bound to,
+ * - the preferred server address used during the last connection (unless
+ *   <c>ANJAY_WITHOUT_IP_STICKINESS</c> is defined).
+ *
+ * <strong>WARNING:</strong> The (D)TLS session resumption data contains the
+ * session's master secret. The stream shall be stored in a location that is
+ * at least as secure as the one used for the Security Object.
+ *
+ * This function is intended to be called just before @ref anjay_delete, while
+ * the connections are still established.
+ *
+ * @param anjay      Anjay object to operate on.
+ * @param out_stream Stream to write to.
+ * @returns AVS_OK in case of success, or an error code.
+ */
+avs_error_t anjay_session_state_persist(anjay_t *anjay,
+                                        avs_stream_t *out_stream);
+
+/**
+ * Attempts to restore the session state of server connections, previously
+ * stored using @ref anjay_session_state_persist, from the @p in_stream.
+ *
+ * The restored state is matched with servers by their Short Server IDs. It is
+ * applied to servers that are already known but not yet connected, and kept
+ * until the matching server is created otherwise - so this function is
+ * intended to be called after restoring the Security and Server Objects, but
+ * before calling @ref anjay_event_loop_run or @ref anjay_sched_run for the
+ * first time.
+ *
+ * This allows the first connection to each server to resume the previous
+ * (D)TLS session using an abbreviated handshake, or to skip the handshake
+ * altogether if the DTLS Connection ID has been resumed. If the server no
+ * longer accepts the session, a full handshake is performed as usual.
+ *
+ * Any state restored by a previous call to this function that has not yet been
+ * applied is discarded.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param in_stream Stream to read from.
+ * @returns AVS_OK in case of success, or an error code. If an error is
+ *          returned, no state is restored.
+ */
+avs_error_t anjay_session_state_restore(anjay_t *anjay,
+                                        avs_stream_t *in_stream);
+
 #ifdef ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
 /**
  * Gets the time at which the client has registered successfully to a given
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+#ifndef ANJAY_INCLUDE_ANJAY_DEFERRED_LOG_H
+#define ANJAY_INCLUDE_ANJAY_DEFERRED_LOG_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Formats log messages stored by Anjay since the last call to this function,
+ * and passes them to avs_log, in the order in which they were logged.
+ *
+ * If Anjay is compiled with <c>ANJAY_WITH_DEFERRED_LOGS</c>, log messages
+ * generated by the library itself are not formatted at the call site. Instead,
+ * the format string and raw values of its arguments are stored in a fixed-size
+ * ring buffer of <c>ANJAY_DEFERRED_LOG_BUFFER_ENTRIES</c> entries, and the log
+ * handler set using <c>avs_log_set_handler()</c> is only called from this
+ * function. Level filters configured with <c>avs_log_set_level()</c> are
+ * applied both at the moment of logging and during the flush.
+ *
+ * It is safe to call this function from any thread, concurrently with any
+ * other Anjay calls - in particular, from a low-priority background thread
+ * dedicated to logging. If the buffer becomes full, new messages are dropped,
+ * and a warning with the number of dropped messages is logged during the next
+ * flush.
+ *
+ * Messages logged by avs_commons and avs_coap are not affected by this
+ * mechanism, and are passed to avs_log immediately.
+ *
+ * @returns Number of log messages passed to avs_log. If
+ *          <c>ANJAY_WITH_DEFERRED_LOGS</c> is disabled, this function does
+ *          nothing and returns 0.
+ */
+size_t anjay_deferred_log_flush(void);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* ANJAY_INCLUDE_ANJAY_DEFERRED_LOG_H */
@@ -815,7 +815,8 @@ typedef struct {
      *
      * Required for every LwM2M operation.
      *
-     * **Must not be NULL.**
+     * **Must not be NULL**, unless @ref anjay_dm_object_def_t::resources is
+     * set, in which case this handler is never called.
      */
     anjay_dm_list_resources_t *list_resources;
 
@@ -961,6 +962,22 @@ typedef struct {
     anjay_dm_resource_instance_write_attrs_t *resource_instance_write_attrs;
 } anjay_dm_handlers_t;
 
+/**
+ * Static description of a single Resource, used as an element of
+ * @ref anjay_dm_object_def_t::resources.
+ */
+typedef struct {
+    /** Resource ID; MUST NOT be <c>ANJAY_ID_INVALID</c> (65535) */
+    anjay_rid_t rid;
+    /** Kind of the Resource, as it would be passed to @ref anjay_dm_emit_res */
+    anjay_dm_resource_kind_t kind;
+    /**
+     * Presence of the Resource, as it would be passed to
+     * @ref anjay_dm_emit_res
+     */
+    anjay_dm_resource_presence_t presence;
+} anjay_dm_resource_def_t;
+
 /** A struct defining a LwM2M Object. */
 struct anjay_dm_object_def_struct {
     /** Object ID; MUST not be <c>ANJAY_ID_INVALID</c> (65535) */
@@ -979,6 +996,24 @@ struct anjay_dm_object_def_struct {
 
     /** Handler callbacks for this object. */
     anjay_dm_handlers_t handlers;
+
+    /**
+     * Optional static table of Resources, sorted by Resource ID in strictly
+     * ascending order. It may be used by Objects in which the set of Resources
+     * and their kind and presence are the same for every Object Instance.
+     *
+     * If set, the library looks up Resources in this table instead of calling
+     * the <c>list_resources</c> handler, which may then be left NULL. This
+     * makes checking the presence of a Resource a binary search instead of
+     * a call to user code, and is what objects generated by
+     * <c>anjay_codegen.py</c> use by default.
+     *
+     * The table is validated when the Object is registered.
+     */
+    const anjay_dm_resource_def_t *resources;
+
+    /** Number of elements in @ref anjay_dm_object_def_t::resources. */
+    size_t resources_count;
 };
 
 /**
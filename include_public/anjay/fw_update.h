@@ -179,6 +179,20 @@ typedef struct {
      */
     bool prefer_same_socket_downloads;
 
+    /**
+     * If nonzero, blocks downloaded in PULL mode are not passed to
+     * @ref anjay_fw_update_stream_write_t directly from the download callback,
+     * but copied into a queue of at most this many bytes and written from a
+     * scheduler job. This lets the next block be requested while the previous
+     * one is still being written. If the queue is full, the oldest blocks are
+     * written synchronously, throttling the download down to the speed of the
+     * storage.
+     *
+     * Defaults to 0, i.e. every block is written before requesting the next
+     * one.
+     */
+    size_t deferred_write_queue_size;
+
 #ifdef ANJAY_WITH_SEND
     /**
      * Enables using LwM2M Send to report State, Update Result and Firmware
@@ -503,6 +517,56 @@ typedef avs_time_duration_t
 anjay_fw_update_get_tcp_request_timeout_t(void *user_ptr,
                                           const char *download_uri);
 
+#ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+/**
+ * Reads a fragment of the currently installed firmware image.
+ *
+ * Implementing this handler enables support for delta packages, i.e. binary
+ * patches against the currently installed image, as generated by the
+ * <c>tools/fw_delta.py</c> script. Such packages are detected automatically;
+ * the patch is applied on the fly and only the reconstructed image is passed to
+ * @ref anjay_fw_update_stream_write_t, so the rest of the update process is the
+ * same as for full images. Apart from a fixed buffer of
+ * <c>ANJAY_FW_UPDATE_DELTA_BUFFER_SIZE</c> bytes, no additional memory is used.
+ *
+ * Before anything is written, the whole source image is read to verify that
+ * its size and checksum match the ones the package was generated against; if
+ * they do not, the update fails with
+ * <c>ANJAY_FW_UPDATE_RESULT_UNSUPPORTED_PACKAGE_TYPE</c>. The checksum of the
+ * reconstructed image is verified before
+ * @ref anjay_fw_update_stream_finish_t is called; if it does not match, the
+ * update fails with <c>ANJAY_FW_UPDATE_RESULT_INTEGRITY_FAILURE</c>.
+ *
+ * Download resumption after a reboot (see
+ * <c>ANJAY_FW_UPDATE_INITIAL_DOWNLOADING</c>) is not possible for delta
+ * packages, as the offset within the package does not correspond to the amount
+ * of data passed to @ref anjay_fw_update_stream_write_t. If this handler is
+ * implemented, the first block of the package is downloaded again to determine
+ * its type. Full images are then resumed as usual, while delta packages are
+ * downloaded from the beginning, after calling @ref anjay_fw_update_reset_t.
+ *
+ * @param user_ptr Opaque pointer to user data, as passed to
+ *                 @ref anjay_fw_update_install
+ *
+ * @param offset   Offset within the currently installed image.
+ *
+ * @param buffer   Buffer to read the data into.
+ *
+ * @param length   Number of bytes to read. The delta package format guarantees
+ *                 that <c>offset + length</c> does not exceed the source image
+ *                 size declared in the package.
+ *
+ * @returns The callback shall return 0 if exactly <c>length</c> bytes have been
+ *          read, or a negative value in case of error. If one of the
+ *          <c>ANJAY_FW_UPDATE_ERR_*</c> value is returned, an equivalent value
+ *          will be set in the Update Result Resource.
+ */
+typedef int anjay_fw_update_read_current_t(void *user_ptr,
+                                           size_t offset,
+                                           void *buffer,
+                                           size_t length);
+#endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+
 /**
  * Handler callbacks that shall implement the platform-specific part of firmware
  * update process.
@@ -584,6 +648,12 @@ typedef struct {
     /** Queries request timeout to be used during firmware update over CoAP+TCP
      * or HTTP; @ref anjay_fw_update_get_tcp_request_timeout_t */
     anjay_fw_update_get_tcp_request_timeout_t *get_tcp_request_timeout;
+
+#ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+    /** Reads the currently installed firmware image, enabling support for
+     * delta packages; @ref anjay_fw_update_read_current_t */
+    anjay_fw_update_read_current_t *read_current;
+#endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
 } anjay_fw_update_handlers_t;
 
 /**
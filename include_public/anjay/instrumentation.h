@@ -0,0 +1,156 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+#ifndef ANJAY_INCLUDE_ANJAY_INSTRUMENTATION_H
+#define ANJAY_INCLUDE_ANJAY_INSTRUMENTATION_H
+
+#include <anjay/core.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Number of buckets in @ref anjay_instr_histogram_t.
+ */
+#define ANJAY_INSTR_HISTOGRAM_BUCKETS 24
+
+/**
+ * Points in the library code whose execution time is measured.
+ */
+typedef enum {
+    /** Read (including Observe) request, including serialization */
+    ANJAY_INSTR_PROBE_READ,
+    /** Read-Composite (including Observe-Composite) request */
+    ANJAY_INSTR_PROBE_READ_COMPOSITE,
+    /** Discover request */
+    ANJAY_INSTR_PROBE_DISCOVER,
+    /** Write request (both replace and partial update) */
+    ANJAY_INSTR_PROBE_WRITE,
+    /** Write-Composite request */
+    ANJAY_INSTR_PROBE_WRITE_COMPOSITE,
+    /** Write-Attributes request */
+    ANJAY_INSTR_PROBE_WRITE_ATTRIBUTES,
+    /** Execute request */
+    ANJAY_INSTR_PROBE_EXECUTE,
+    /** Create request */
+    ANJAY_INSTR_PROBE_CREATE,
+    /** Delete request */
+    ANJAY_INSTR_PROBE_DELETE,
+    /** Access Control check of a single operation on an Object Instance */
+    ANJAY_INSTR_PROBE_ACCESS_CONTROL,
+    /**
+     * Processing of a batch of data model changes: notifying the Observe
+     * subsystem, Access Control and Attribute Storage modules etc.
+     */
+    ANJAY_INSTR_PROBE_NOTIFY_FLUSH,
+    /** Serialization and sending of a single notification */
+    ANJAY_INSTR_PROBE_NOTIFICATION,
+    /**
+     * Serialization of a single Read (including Observe) response or
+     * notification payload: creation, use and destruction of the output
+     * context. For Read responses, this includes the data model handlers
+     * called to obtain the values. For notifications, which are serialized
+     * from previously read values, this is the total time spent serializing
+     * all blocks of the payload, excluding the time spent waiting for the
+     * network.
+     */
+    ANJAY_INSTR_PROBE_SERIALIZATION,
+
+    ANJAY_INSTR_PROBE_LIMIT_
+} anjay_instr_probe_t;
+
+/**
+ * Histogram of execution times, in microseconds.
+ */
+typedef struct {
+    /** Number of measurements */
+    uint64_t count;
+    /** Sum of all measured times */
+    uint64_t total_us;
+    /** Longest measured time */
+    uint64_t max_us;
+    /**
+     * <c>buckets[0]</c> is the number of measurements shorter than 1 us.
+     * <c>buckets[i]</c> for 0 < i < ANJAY_INSTR_HISTOGRAM_BUCKETS - 1 is the
+     * number of measurements in the [2^(i-1), 2^i) us range. The last bucket
+     * counts all longer measurements.
+     */
+    uint32_t buckets[ANJAY_INSTR_HISTOGRAM_BUCKETS];
+} anjay_instr_histogram_t;
+
+/**
+ * Current lengths of queues maintained by the library.
+ */
+typedef struct {
+    /** Notifications waiting to be sent, summed for all servers */
+    size_t unsent_notifications;
+    /** LwM2M Send requests deferred until the server is online */
+    size_t deferred_sends;
+    /** Notification and LwM2M Send exchanges currently in progress */
+    size_t pending_exchanges;
+} anjay_instr_queue_depths_t;
+
+/**
+ * Retrieves the histogram of execution times collected for @p probe since the
+ * Anjay object creation or last call to @ref anjay_instr_reset.
+ *
+ * @param anjay         Anjay object to operate on.
+ * @param probe         Probe to query.
+ * @param out_histogram Pointer to a variable that will be filled with the data.
+ *
+ * @returns 0 on success, a negative value if @p probe is invalid or
+ *          <c>ANJAY_WITH_INSTRUMENTATION</c> is disabled.
+ */
+int anjay_instr_get_histogram(anjay_t *anjay,
+                              anjay_instr_probe_t probe,
+                              anjay_instr_histogram_t *out_histogram);
+
+/**
+ * Retrieves the histogram of execution times of all data model handlers of
+ * Object @p oid called by the library. Time spent in handlers called by the
+ * application code itself (e.g. from within other handlers) is not included.
+ *
+ * @param anjay         Anjay object to operate on.
+ * @param oid           Object ID to query.
+ * @param out_histogram Pointer to a variable that will be filled with the data.
+ *                      If no handlers of the Object have been called, it is
+ *                      filled with zeros.
+ *
+ * @returns 0 on success, a negative value if
+ *          <c>ANJAY_WITH_INSTRUMENTATION</c> is disabled.
+ */
+int anjay_instr_get_object_histogram(anjay_t *anjay,
+                                     anjay_oid_t oid,
+                                     anjay_instr_histogram_t *out_histogram);
+
+/**
+ * Retrieves the current lengths of queues maintained by the library.
+ *
+ * @param anjay          Anjay object to operate on.
+ * @param out_depths     Pointer to a variable that will be filled with the
+ *                       data.
+ *
+ * @returns 0 on success, a negative value if
+ *          <c>ANJAY_WITH_INSTRUMENTATION</c> is disabled.
+ */
+int anjay_instr_get_queue_depths(anjay_t *anjay,
+                                 anjay_instr_queue_depths_t *out_depths);
+
+/**
+ * Clears all collected histograms.
+ *
+ * @param anjay Anjay object to operate on.
+ */
+void anjay_instr_reset(anjay_t *anjay);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* ANJAY_INCLUDE_ANJAY_INSTRUMENTATION_H */
@@ -199,6 +199,51 @@ int anjay_ret_bytes_append(anjay_ret_bytes_ctx_t *ctx,
  */
 int anjay_ret_bytes(anjay_output_ctx_t *ctx, const void *data, size_t length);
 
+/**
+ * Type of a function used to release a buffer passed to
+ * @ref anjay_ret_bytes_borrowed.
+ *
+ * @param arg Opaque argument, as passed to @ref anjay_ret_bytes_borrowed.
+ */
+typedef void anjay_ret_bytes_release_t(void *arg);
+
+/**
+ * Returns a blob of data from the data model handler, without copying it.
+ *
+ * Unlike @ref anjay_ret_bytes, this function does not require the data to be
+ * consumed before it returns. Whenever the value needs to be stored before it
+ * is serialized - which is the case e.g. for notifications and LwM2M Send
+ * messages - Anjay keeps a reference to @p data instead of duplicating it. The
+ * buffer is then passed as-is to the payload serializer.
+ *
+ * @p release is called with @p release_arg exactly once, as soon as the buffer
+ * is no longer used by Anjay. This may happen either before this function
+ * returns or at an arbitrary later point, including when this function fails.
+ * The buffer MUST NOT be modified or freed before that. If the buffer is shared
+ * between multiple calls to this function (e.g. to serve the same data for
+ * multiple LwM2M Servers), the application SHALL implement reference counting
+ * on its own, treating each call as acquiring one reference.
+ *
+ * The @p release function may be called from within any Anjay function, with
+ * the Anjay mutex held if thread safety is enabled. It MUST NOT call any Anjay
+ * functions.
+ *
+ * @param ctx         Context to operate on.
+ * @param data        Data buffer.
+ * @param length      Number of bytes available in the @p data buffer.
+ * @param release     Function called when @p data is no longer used by Anjay.
+ *                    May be NULL if the buffer is never freed nor modified
+ *                    (e.g. for constant data).
+ * @param release_arg Opaque argument passed to @p release.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_ret_bytes_borrowed(anjay_output_ctx_t *ctx,
+                             const void *data,
+                             size_t length,
+                             anjay_ret_bytes_release_t *release,
+                             void *release_arg);
+
 /**
  * Returns a null-terminated string from the data model handler.
  *
@@ -10,6 +10,7 @@
 #define ANJAY_IPSO_OBJECTS_V2_H
 
 #include <anjay/dm.h>
+#include <anjay/lwm2m_send.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -54,6 +55,20 @@ typedef struct anjay_ipso_v2_basic_sensor_meta_struct {
      * this value is set to NaN.
      */
     double max_range_value;
+
+    /**
+     * Number of samples kept in the history buffer of the instance, see
+     * @ref anjay_ipso_v2_basic_sensor_history_drain .
+     *
+     * This value is optional; no history will be recorded if it is set to 0.
+     */
+    size_t history_depth;
+
+    /**
+     * If set to N greater than 1, only every N-th sensor value update is
+     * recorded in the history buffer. Ignored if <c>history_depth</c> is 0.
+     */
+    size_t history_decimation;
 } anjay_ipso_v2_basic_sensor_meta_t;
 
 /**
@@ -108,6 +123,20 @@ typedef struct anjay_ipso_v2_3d_sensor_meta_struct {
      * If the value is NaN the resource won't be created.
      */
     double max_range_value;
+
+    /**
+     * Number of samples kept in the history buffer of the instance, see
+     * @ref anjay_ipso_v2_3d_sensor_history_drain .
+     *
+     * This value is optional; no history will be recorded if it is set to 0.
+     */
+    size_t history_depth;
+
+    /**
+     * If set to N greater than 1, only every N-th sensor value update is
+     * recorded in the history buffer. Ignored if <c>history_depth</c> is 0.
+     */
+    size_t history_decimation;
 } anjay_ipso_v2_3d_sensor_meta_t;
 
 /**
@@ -133,6 +162,42 @@ typedef struct anjay_ipso_v2_3d_sensor_value_struct {
     double z;
 } anjay_ipso_v2_3d_sensor_value_t;
 
+/**
+ * @experimental This is experimental IPSO object v2 API. This API can change
+ *               in future versions without any notice.
+ *
+ * Single entry passed to @ref anjay_ipso_v2_basic_sensor_values_update .
+ */
+typedef struct anjay_ipso_v2_basic_sensor_value_entry_struct {
+    /**
+     * Instance ID of object instance of which the sensor value is updated.
+     */
+    anjay_iid_t iid;
+
+    /**
+     * New sensor value.
+     */
+    double value;
+} anjay_ipso_v2_basic_sensor_value_entry_t;
+
+/**
+ * @experimental This is experimental IPSO object v2 API. This API can change
+ *               in future versions without any notice.
+ *
+ * Single entry passed to @ref anjay_ipso_v2_3d_sensor_values_update .
+ */
+typedef struct anjay_ipso_v2_3d_sensor_value_entry_struct {
+    /**
+     * Instance ID of object instance of which the sensor value is updated.
+     */
+    anjay_iid_t iid;
+
+    /**
+     * New sensor value.
+     */
+    anjay_ipso_v2_3d_sensor_value_t value;
+} anjay_ipso_v2_3d_sensor_value_entry_t;
+
 /**
  * @experimental This is experimental IPSO object v2 API. This API can change
  *               in future versions without any notice.
@@ -205,6 +270,37 @@ int anjay_ipso_v2_basic_sensor_value_update(anjay_t *anjay,
                                             anjay_iid_t iid,
                                             double value);
 
+/**
+ * @experimental This is experimental IPSO object v2 API. This API can change
+ *               in future versions without any notice.
+ *
+ * Updates sensor values of multiple instances of basic IPSO object at once.
+ *
+ * The result is the same as calling
+ * @ref anjay_ipso_v2_basic_sensor_value_update for each entry in order, but
+ * the Anjay mutex is acquired and the object is looked up only once. If any of
+ * the entries refers to a nonexistent instance or contains an invalid value,
+ * none of the values are updated.
+ *
+ * All resulting LwM2M notifications are sent together, after the next call to
+ * @ref anjay_sched_run .
+ *
+ * CAUTION: Do not call this method from interrupts.
+ *
+ * @param anjay       Anjay object with an installed basic IPSO object.
+ * @param oid         Object ID of updated object.
+ * @param entries     Array of Instance IDs and new sensor values. May be
+ *                    <c>NULL</c> if @p entry_count is 0.
+ * @param entry_count Number of elements in @p entries.
+ *
+ * @returns 0 on success, or a negative value in case of error.
+ */
+int anjay_ipso_v2_basic_sensor_values_update(
+        anjay_t *anjay,
+        anjay_oid_t oid,
+        const anjay_ipso_v2_basic_sensor_value_entry_t *entries,
+        size_t entry_count);
+
 /**
  * @experimental This is experimental IPSO object v2 API. This API can change
  *               in future versions without any notice.
@@ -221,6 +317,45 @@ int anjay_ipso_v2_basic_sensor_instance_remove(anjay_t *anjay,
                                                anjay_oid_t oid,
                                                anjay_iid_t iid);
 
+#ifdef ANJAY_WITH_SEND
+/**
+ * @experimental This is experimental IPSO object v2 API. This API can change
+ *               in future versions without any notice.
+ *
+ * Moves all samples recorded in history buffers of basic IPSO object
+ * instances (see <c>history_depth</c> in
+ * @ref anjay_ipso_v2_basic_sensor_meta_t ) into @p builder, oldest first.
+ * Each sample is added with the time at which it has been recorded as the
+ * SenML timestamp, so that a single LwM2M Send operation can carry data
+ * collected over a long period of time.
+ *
+ * Example:
+ *
+ * @code
+ * anjay_send_batch_builder_t *builder = anjay_send_batch_builder_new();
+ * if (builder
+ *         && !anjay_ipso_v2_basic_sensor_history_drain(anjay, oid,
+ *                                                     builder)) {
+ *     anjay_send_batch_t *batch = anjay_send_batch_builder_compile(&builder);
+ *     if (batch) {
+ *         anjay_send(anjay, ssid, batch, NULL, NULL);
+ *         anjay_send_batch_release(&batch);
+ *     }
+ * }
+ * anjay_send_batch_builder_cleanup(&builder);
+ * @endcode
+ *
+ * @param anjay   Anjay object with an installed basic IPSO object.
+ * @param oid     Object ID of object to drain history buffers of.
+ * @param builder Batch builder to add the samples to.
+ *
+ * @returns 0 on success, or a negative value in case of error. On error, both
+ *          @p builder and the history buffers are left unchanged.
+ */
+int anjay_ipso_v2_basic_sensor_history_drain(
+        anjay_t *anjay, anjay_oid_t oid, anjay_send_batch_builder_t *builder);
+#endif // ANJAY_WITH_SEND
+
 /**
  * @experimental This is experimental IPSO object v2 API. This API can change
  *               in future versions without any notice.
@@ -293,6 +428,37 @@ int anjay_ipso_v2_3d_sensor_value_update(
         anjay_iid_t iid,
         const anjay_ipso_v2_3d_sensor_value_t *value);
 
+/**
+ * @experimental This is experimental IPSO object v2 API. This API can change
+ *               in future versions without any notice.
+ *
+ * Updates sensor values of multiple instances of three-axis IPSO object at
+ * once.
+ *
+ * The result is the same as calling @ref anjay_ipso_v2_3d_sensor_value_update
+ * for each entry in order, but the Anjay mutex is acquired and the object is
+ * looked up only once. If any of the entries refers to a nonexistent instance
+ * or contains an invalid value, none of the values are updated.
+ *
+ * All resulting LwM2M notifications are sent together, after the next call to
+ * @ref anjay_sched_run .
+ *
+ * CAUTION: Do not call this method from interrupts.
+ *
+ * @param anjay       Anjay object with an installed three-axis IPSO object.
+ * @param oid         Object ID of updated object.
+ * @param entries     Array of Instance IDs and new sensor values. May be
+ *                    <c>NULL</c> if @p entry_count is 0.
+ * @param entry_count Number of elements in @p entries.
+ *
+ * @returns 0 on success, or a negative value in case of error.
+ */
+int anjay_ipso_v2_3d_sensor_values_update(
+        anjay_t *anjay,
+        anjay_oid_t oid,
+        const anjay_ipso_v2_3d_sensor_value_entry_t *entries,
+        size_t entry_count);
+
 /**
  * @experimental This is experimental IPSO object v2 API. This API can change
  *               in future versions without any notice.
@@ -309,6 +475,45 @@ int anjay_ipso_v2_3d_sensor_instance_remove(anjay_t *anjay,
                                             anjay_oid_t oid,
                                             anjay_iid_t iid);
 
+#ifdef ANJAY_WITH_SEND
+/**
+ * @experimental This is experimental IPSO object v2 API. This API can change
+ *               in future versions without any notice.
+ *
+ * Moves all samples recorded in history buffers of three-axis IPSO object
+ * instances (see <c>history_depth</c> in
+ * @ref anjay_ipso_v2_3d_sensor_meta_t ) into @p builder, oldest first.
+ * Each sample is added with the time at which it has been recorded as the
+ * SenML timestamp, so that a single LwM2M Send operation can carry data
+ * collected over a long period of time.
+ *
+ * Example:
+ *
+ * @code
+ * anjay_send_batch_builder_t *builder = anjay_send_batch_builder_new();
+ * if (builder
+ *         && !anjay_ipso_v2_3d_sensor_history_drain(anjay, oid,
+ *                                                  builder)) {
+ *     anjay_send_batch_t *batch = anjay_send_batch_builder_compile(&builder);
+ *     if (batch) {
+ *         anjay_send(anjay, ssid, batch, NULL, NULL);
+ *         anjay_send_batch_release(&batch);
+ *     }
+ * }
+ * anjay_send_batch_builder_cleanup(&builder);
+ * @endcode
+ *
+ * @param anjay   Anjay object with an installed three-axis IPSO object.
+ * @param oid     Object ID of object to drain history buffers of.
+ * @param builder Batch builder to add the samples to.
+ *
+ * @returns 0 on success, or a negative value in case of error. On error, both
+ *          @p builder and the history buffers are left unchanged.
+ */
+int anjay_ipso_v2_3d_sensor_history_drain(
+        anjay_t *anjay, anjay_oid_t oid, anjay_send_batch_builder_t *builder);
+#endif // ANJAY_WITH_SEND
+
 #ifdef __cplusplus
 }
 #endif
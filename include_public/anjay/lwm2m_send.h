@@ -546,6 +546,62 @@ anjay_send_deferrable(anjay_t *anjay,
                       anjay_send_finished_handler_t *finished_handler,
                       void *finished_handler_data);
 
+/**
+ * Stores the Send requests queued using @ref anjay_send_deferrable, so that
+ * they can be recovered with @ref anjay_send_queue_restore after a restart.
+ *
+ * Each stored request consists of the target SSID and the complete compiled
+ * batch. Requests that are currently being sent are stored as well, so a
+ * request may be delivered twice if the device restarts before its delivery
+ * is confirmed. Requests made with @ref anjay_send are not stored. Finished
+ * handlers cannot be stored; restored requests do not have any.
+ *
+ * If @p max_size is nonzero, the total amount of data written to
+ * @p out_stream will not exceed @p max_size bytes. If the queue does not fit,
+ * the requests with the oldest batches (according to the time of
+ * @ref anjay_send_batch_builder_compile) are omitted, and a warning is logged.
+ * This makes it possible to keep the queue in a storage segment of a fixed
+ * size. Requests are only omitted from the stored data - they are still
+ * present in the queue in memory.
+ *
+ * This function serializes each request into memory before writing anything,
+ * so it temporarily needs roughly as much additional memory as the size of
+ * the data written.
+ *
+ * @param anjay      Anjay object to operate on.
+ * @param out_stream Stream to write the queued requests to.
+ * @param max_size   Maximum number of bytes to write, or 0 for no limit.
+ *
+ * @returns AVS_OK in case of success, or an error code. In particular,
+ *          <c>avs_errno(AVS_EINVAL)</c> is returned if @p max_size is too
+ *          small to store even an empty queue.
+ */
+avs_error_t anjay_send_queue_persist(anjay_t *anjay,
+                                     avs_stream_t *out_stream,
+                                     size_t max_size);
+
+/**
+ * Restores Send requests stored using @ref anjay_send_queue_persist, and
+ * queues them as if they were passed to @ref anjay_send_deferrable, without a
+ * finished handler.
+ *
+ * Restored requests are queued before any requests to the same server that are
+ * already queued, and are sent in the order in which they were originally
+ * made, as soon as the respective server connection is online. If
+ * <c>send_coalescing_delay</c> is set in @ref anjay_configuration_t, several of
+ * them may be sent within a single exchange.
+ *
+ * This function is intended to be called right after creating the Anjay
+ * object. Restoring the same data twice results in duplicate requests.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param in_stream Stream to read the persisted requests from.
+ *
+ * @returns AVS_OK in case of success, or an error code. If restoration fails,
+ *          the queue is left untouched.
+ */
+avs_error_t anjay_send_queue_restore(anjay_t *anjay, avs_stream_t *in_stream);
+
 #endif // ANJAY_WITH_SEND
 
 #ifdef __cplusplus
@@ -139,10 +139,61 @@ avs_error_t anjay_security_object_persist(anjay_t *anjay,
 avs_error_t anjay_security_object_restore(anjay_t *anjay,
                                           avs_stream_t *in_stream);
 
+/**
+ * Appends a single record, containing the Security Object Instances added or
+ * modified, and the IDs of those removed, since the last successful call to
+ * @ref anjay_security_object_persist, @ref anjay_security_object_restore,
+ * @ref anjay_security_object_journal_append or
+ * @ref anjay_security_object_journal_restore, to the @p journal_stream.
+ * Nothing is written if there are no such changes.
+ *
+ * The journal is only meaningful together with the data most recently written
+ * by @ref anjay_security_object_persist. To compact it without risking the
+ * loss of changes on a power failure, call this function first, then persist
+ * into a new stream, atomically replace the previous snapshot with it, and
+ * only then truncate the journal. See the "Persistence" chapter of the
+ * documentation for details.
+ *
+ * @param anjay          Anjay instance with Security Object installed.
+ * @param journal_stream Stream to append the record to.
+ * @returns AVS_OK in case of success, or an error code.
+ */
+avs_error_t anjay_security_object_journal_append(anjay_t *anjay,
+                                                 avs_stream_t *journal_stream);
+
+/**
+ * Attempts to restore Security Object Instances from data written by
+ * @ref anjay_security_object_persist to @p in_stream, followed by the records
+ * written by @ref anjay_security_object_journal_append to @p journal_stream.
+ *
+ * A record that is incomplete or does not match its checksum (e.g. because the
+ * device lost power while appending it) ends the journal - it and all data
+ * after it are ignored.
+ *
+ * The resulting Instances are validated, and their keys processed, in the same
+ * way as by @ref anjay_security_object_restore. If reading the snapshot or any
+ * complete journal record, or that validation fails, the Security Object is
+ * left untouched. Otherwise, the restored Instances replace all Instances
+ * currently present in the Object.
+ *
+ * @param anjay          Anjay instance with Security Object installed.
+ * @param in_stream      Stream to read the persisted data from. May be NULL if
+ *                       @ref anjay_security_object_persist has never been
+ *                       called, in which case the journal is replayed onto an
+ *                       empty Object.
+ * @param journal_stream Stream to read the journal records from.
+ * @returns AVS_OK in case of success, or an error code.
+ */
+avs_error_t anjay_security_object_journal_restore(anjay_t *anjay,
+                                                  avs_stream_t *in_stream,
+                                                  avs_stream_t *journal_stream);
+
 /**
  * Checks whether the Security Object in Anjay instance has been modified since
- * last successful call to @ref anjay_security_object_persist or @ref
- * anjay_security_object_restore.
+ * last successful call to @ref anjay_security_object_persist,
+ * @ref anjay_security_object_restore,
+ * @ref anjay_security_object_journal_append or
+ * @ref anjay_security_object_journal_restore.
  */
 bool anjay_security_object_is_modified(anjay_t *anjay);
 
@@ -137,10 +137,60 @@ avs_error_t anjay_server_object_persist(anjay_t *anjay,
 avs_error_t anjay_server_object_restore(anjay_t *anjay,
                                         avs_stream_t *in_stream);
 
+/**
+ * Appends a single record, containing the Server Object Instances added or
+ * modified, and the IDs of those removed, since the last successful call to
+ * @ref anjay_server_object_persist, @ref anjay_server_object_restore,
+ * @ref anjay_server_object_journal_append or
+ * @ref anjay_server_object_journal_restore, to the @p journal_stream. Nothing
+ * is written if there are no such changes.
+ *
+ * The journal is only meaningful together with the data most recently written
+ * by @ref anjay_server_object_persist. Before persisting the Object in order to
+ * compact the journal, call this function, so that the journal can still be
+ * replayed onto the old snapshot if the device loses power before the new one
+ * atomically replaces it - see the "Persistence" chapter of the documentation.
+ *
+ * @param anjay          Anjay instance with Server Object installed.
+ * @param journal_stream Stream to append the record to.
+ * @return AVS_OK in case of success, or an error code.
+ */
+avs_error_t anjay_server_object_journal_append(anjay_t *anjay,
+                                               avs_stream_t *journal_stream);
+
+/**
+ * Attempts to restore Server Object Instances from data written by
+ * @ref anjay_server_object_persist to @p in_stream, followed by the records
+ * written by @ref anjay_server_object_journal_append to @p journal_stream.
+ *
+ * A record that is incomplete or does not match its checksum (e.g. because the
+ * device lost power while appending it) ends the journal - it and all data
+ * after it are ignored.
+ *
+ * The state obtained after replaying the journal must pass the same
+ * consistency checks as the one read by @ref anjay_server_object_restore (e.g.
+ * Short Server IDs must be unique). If it does not, or if reading any complete
+ * record fails, the Server Object is left untouched and an error is returned.
+ * On success, the current Instances are discarded and replaced by the restored
+ * ones.
+ *
+ * @param anjay          Anjay instance with Server Object installed.
+ * @param in_stream      Stream to read the persisted data from. May be NULL if
+ *                       @ref anjay_server_object_persist has never been
+ *                       called, in which case the journal is replayed onto an
+ *                       empty Object.
+ * @param journal_stream Stream to read the journal records from.
+ * @return AVS_OK in case of success, or an error code.
+ */
+avs_error_t anjay_server_object_journal_restore(anjay_t *anjay,
+                                                avs_stream_t *in_stream,
+                                                avs_stream_t *journal_stream);
+
 /**
  * Checks whether the Server Object from Anjay instance has been modified since
- * last successful call to @ref anjay_server_object_persist or @ref
- * anjay_server_object_restore.
+ * last successful call to @ref anjay_server_object_persist,
+ * @ref anjay_server_object_restore, @ref anjay_server_object_journal_append or
+ * @ref anjay_server_object_journal_restore.
  */
 bool anjay_server_object_is_modified(anjay_t *anjay);
 
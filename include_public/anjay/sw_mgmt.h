@@ -266,6 +266,9 @@ anjay_sw_mgmt_stream_finish_t(void *obj_ctx, anjay_iid_t iid, void *inst_ctx);
  * State resource upon finished download will change the state directly from
  * <em>Download started</em> to <em>Delivered</em>.
  *
+ * If the package has already been verified while being downloaded, using
+ * @ref anjay_sw_mgmt_integrity_update_t , this handler is not called.
+ *
  * @param obj_ctx  Opaque pointer to object-wide user data, as passed to
  *                 @ref anjay_sw_mgmt_settings_t .
  *
@@ -284,6 +287,123 @@ anjay_sw_mgmt_stream_finish_t(void *obj_ctx, anjay_iid_t iid, void *inst_ctx);
 typedef int
 anjay_sw_mgmt_check_integrity_t(void *obj_ctx, anjay_iid_t iid, void *inst_ctx);
 
+/**
+ * @experimental This is experimental Software Management object API. This API
+ * can change in future versions without any notice.
+ *
+ * Starts incremental integrity verification of a package that is about to be
+ * downloaded, e.g. by allocating and initializing a hash context.
+ *
+ * Will be called just before @ref anjay_sw_mgmt_stream_open_t. The context
+ * returned through <c>out_integrity_ctx</c> is then passed to
+ * @ref anjay_sw_mgmt_integrity_update_t for each chunk of the package, and
+ * finally to @ref anjay_sw_mgmt_integrity_finish_t, which is guaranteed to be
+ * called exactly once after a successful call to this handler.
+ *
+ * @param obj_ctx           Opaque pointer to object-wide user data, as passed
+ *                          to @ref anjay_sw_mgmt_settings_t .
+ *
+ * @param iid               ID of Software Management object instance.
+ *
+ * @param inst_ctx          Opaque pointer to instance-specific user data, as
+ *                          passed to @ref anjay_sw_mgmt_instance_initializer_t
+ *                          or <c>out_inst_ctx</c> parameter of
+ *                          @ref anjay_sw_mgmt_add_handler_t .
+ *
+ * @param out_integrity_ctx Pointer to a variable, initially set to
+ *                          <c>NULL</c>, that may be set to the verification
+ *                          context.
+ *
+ * @returns The callback shall return 0 if successful or a negative value in
+ *          case of error, which is handled in the same way as a failure of
+ *          @ref anjay_sw_mgmt_stream_open_t .
+ */
+typedef int anjay_sw_mgmt_integrity_init_t(void *obj_ctx,
+                                           anjay_iid_t iid,
+                                           void *inst_ctx,
+                                           void **out_integrity_ctx);
+
+/**
+ * @experimental This is experimental Software Management object API. This API
+ * can change in future versions without any notice.
+ *
+ * Feeds a chunk of the package being downloaded to the incremental integrity
+ * verification.
+ *
+ * Called with the same chunks, in the same order, as passed to
+ * @ref anjay_sw_mgmt_stream_write_t. Note that if
+ * <c>deferred_write_queue_size</c> is set in @ref anjay_sw_mgmt_settings_t,
+ * a chunk may be passed to this handler before it is written to the stream.
+ *
+ * @param obj_ctx       Opaque pointer to object-wide user data, as passed to
+ *                      @ref anjay_sw_mgmt_settings_t .
+ *
+ * @param iid           ID of Software Management object instance.
+ *
+ * @param inst_ctx      Opaque pointer to instance-specific user data, as passed
+ *                      to @ref anjay_sw_mgmt_instance_initializer_t or
+ *                      <c>out_inst_ctx</c> parameter of
+ *                      @ref anjay_sw_mgmt_add_handler_t .
+ *
+ * @param integrity_ctx Context returned by
+ *                      @ref anjay_sw_mgmt_integrity_init_t .
+ *
+ * @param data          Pointer to a chunk of the software package being
+ *                      downloaded. Guaranteed to be non-<c>NULL</c>.
+ *
+ * @param length        Number of bytes in the chunk pointed to by <c>data</c>.
+ *                      Guaranteed to be greater than zero.
+ *
+ * @returns The callback shall return 0 if successful or a negative value in
+ *          case of error, which aborts the download. If one of the
+ *          <c>ANJAY_SW_MGMT_ERR_*</c> value is returned, an equivalent value
+ *          will be set in the Update Result Resource.
+ */
+typedef int anjay_sw_mgmt_integrity_update_t(void *obj_ctx,
+                                             anjay_iid_t iid,
+                                             void *inst_ctx,
+                                             void *integrity_ctx,
+                                             const void *data,
+                                             size_t length);
+
+/**
+ * @experimental This is experimental Software Management object API. This API
+ * can change in future versions without any notice.
+ *
+ * Completes the incremental integrity verification and releases the context.
+ *
+ * If <c>aborted</c> is false, it is called right after a successful call to
+ * @ref anjay_sw_mgmt_stream_finish_t, and its result is used instead of calling
+ * @ref anjay_sw_mgmt_check_integrity_t . Otherwise, the download has failed or
+ * been cancelled, the handler shall only release the context, and the return
+ * value is ignored.
+ *
+ * @param obj_ctx       Opaque pointer to object-wide user data, as passed to
+ *                      @ref anjay_sw_mgmt_settings_t .
+ *
+ * @param iid           ID of Software Management object instance.
+ *
+ * @param inst_ctx      Opaque pointer to instance-specific user data, as passed
+ *                      to @ref anjay_sw_mgmt_instance_initializer_t or
+ *                      <c>out_inst_ctx</c> parameter of
+ *                      @ref anjay_sw_mgmt_add_handler_t .
+ *
+ * @param integrity_ctx Context returned by
+ *                      @ref anjay_sw_mgmt_integrity_init_t .
+ *
+ * @param aborted       True if the package has not been downloaded completely.
+ *
+ * @returns The callback shall return 0 if the package is valid or a negative
+ *          value otherwise. If one of the <c>ANJAY_SW_MGMT_ERR_*</c> value is
+ *          returned, an equivalent value will be set in the Update Result
+ *          Resource.
+ */
+typedef int anjay_sw_mgmt_integrity_finish_t(void *obj_ctx,
+                                             anjay_iid_t iid,
+                                             void *inst_ctx,
+                                             void *integrity_ctx,
+                                             bool aborted);
+
 /**
  * @experimental This is experimental Software Management object API. This API
  * can change in future versions without any notice.
@@ -856,6 +976,21 @@ typedef struct {
      * its integrity; @ref anjay_sw_mgmt_check_integrity_t */
     anjay_sw_mgmt_check_integrity_t *check_integrity;
 
+    /** Starts incremental integrity verification of a package being
+     * downloaded; @ref anjay_sw_mgmt_integrity_init_t . Shall be set together
+     * with <c>integrity_update</c> and <c>integrity_finish</c>. If set,
+     * <c>check_integrity</c> is only used for packages that were not verified
+     * this way, e.g. ones downloaded before a reboot. */
+    anjay_sw_mgmt_integrity_init_t *integrity_init;
+
+    /** Feeds a chunk of the package to the incremental integrity
+     * verification; @ref anjay_sw_mgmt_integrity_update_t */
+    anjay_sw_mgmt_integrity_update_t *integrity_update;
+
+    /** Completes the incremental integrity verification;
+     * @ref anjay_sw_mgmt_integrity_finish_t */
+    anjay_sw_mgmt_integrity_finish_t *integrity_finish;
+
     /** Resets the software installation state and performs any applicable
      * cleanup of temporary storage if necessary; @ref anjay_sw_mgmt_reset_t */
     anjay_sw_mgmt_reset_t *reset;
@@ -939,6 +1074,20 @@ typedef struct {
      * LwM2M Servers.
      */
     bool prefer_same_socket_downloads;
+
+    /**
+     * If nonzero, blocks downloaded in PULL mode are not passed to
+     * @ref anjay_sw_mgmt_stream_write_t directly from the download callback,
+     * but copied into a per-instance queue of at most this many bytes and
+     * written from a scheduler job. This lets the next block be requested
+     * while the previous one is still being written. If the queue is full, the
+     * oldest blocks are written synchronously, throttling the download down to
+     * the speed of the storage.
+     *
+     * Defaults to 0, i.e. every block is written before requesting the next
+     * one.
+     */
+    size_t deferred_write_queue_size;
 #endif // defined(ANJAY_WITH_DOWNLOADER)
 } anjay_sw_mgmt_settings_t;
 
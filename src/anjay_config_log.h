@@ -17,6 +17,7 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
 // clang-format off
 static inline void _anjay_log_feature_list(void) {
     _anjay_log(anjay, TRACE, "ANJAY_DEFAULT_SEND_FORMAT = " AVS_QUOTE_MACRO(ANJAY_DEFAULT_SEND_FORMAT));
+    _anjay_log(anjay, TRACE, "ANJAY_DEFERRED_LOG_BUFFER_ENTRIES = " AVS_QUOTE_MACRO(ANJAY_DEFERRED_LOG_BUFFER_ENTRIES));
     _anjay_log(anjay, TRACE, "ANJAY_DTLS_SESSION_BUFFER_SIZE = " AVS_QUOTE_MACRO(ANJAY_DTLS_SESSION_BUFFER_SIZE));
     _anjay_log(anjay, TRACE, "ANJAY_MAX_DOUBLE_STRING_SIZE = " AVS_QUOTE_MACRO(ANJAY_MAX_DOUBLE_STRING_SIZE));
     _anjay_log(anjay, TRACE, "ANJAY_MAX_OBSERVATION_SERVERS_REPORTED_NUMBER = " AVS_QUOTE_MACRO(ANJAY_MAX_OBSERVATION_SERVERS_REPORTED_NUMBER));
@@ -74,6 +75,11 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_ACCESS_CONTROL
     _anjay_log(anjay, TRACE, "ANJAY_WITH_ACCESS_CONTROL = OFF");
 #endif // ANJAY_WITH_ACCESS_CONTROL
+#ifdef ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES = ON");
+#else // ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES = OFF");
+#endif // ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES
 #ifdef ANJAY_WITH_ATTR_STORAGE
     _anjay_log(anjay, TRACE, "ANJAY_WITH_ATTR_STORAGE = ON");
 #else // ANJAY_WITH_ATTR_STORAGE
@@ -119,11 +125,21 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_CORE_PERSISTENCE
     _anjay_log(anjay, TRACE, "ANJAY_WITH_CORE_PERSISTENCE = OFF");
 #endif // ANJAY_WITH_CORE_PERSISTENCE
+#ifdef ANJAY_WITH_DEFERRED_LOGS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_DEFERRED_LOGS = ON");
+#else // ANJAY_WITH_DEFERRED_LOGS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_DEFERRED_LOGS = OFF");
+#endif // ANJAY_WITH_DEFERRED_LOGS
 #ifdef ANJAY_WITH_DISCOVER
     _anjay_log(anjay, TRACE, "ANJAY_WITH_DISCOVER = ON");
 #else // ANJAY_WITH_DISCOVER
     _anjay_log(anjay, TRACE, "ANJAY_WITH_DISCOVER = OFF");
 #endif // ANJAY_WITH_DISCOVER
+#ifdef ANJAY_WITH_DISCOVER_CACHE
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_DISCOVER_CACHE = ON");
+#else // ANJAY_WITH_DISCOVER_CACHE
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_DISCOVER_CACHE = OFF");
+#endif // ANJAY_WITH_DISCOVER_CACHE
 #ifdef ANJAY_WITH_DOWNLOADER
     _anjay_log(anjay, TRACE, "ANJAY_WITH_DOWNLOADER = ON");
 #else // ANJAY_WITH_DOWNLOADER
@@ -149,11 +165,21 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_HTTP_DOWNLOAD
     _anjay_log(anjay, TRACE, "ANJAY_WITH_HTTP_DOWNLOAD = OFF");
 #endif // ANJAY_WITH_HTTP_DOWNLOAD
+#ifdef ANJAY_WITH_INSTRUMENTATION
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_INSTRUMENTATION = ON");
+#else // ANJAY_WITH_INSTRUMENTATION
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_INSTRUMENTATION = OFF");
+#endif // ANJAY_WITH_INSTRUMENTATION
 #ifdef ANJAY_WITH_LEGACY_CONTENT_FORMAT_SUPPORT
     _anjay_log(anjay, TRACE, "ANJAY_WITH_LEGACY_CONTENT_FORMAT_SUPPORT = ON");
 #else // ANJAY_WITH_LEGACY_CONTENT_FORMAT_SUPPORT
     _anjay_log(anjay, TRACE, "ANJAY_WITH_LEGACY_CONTENT_FORMAT_SUPPORT = OFF");
 #endif // ANJAY_WITH_LEGACY_CONTENT_FORMAT_SUPPORT
+#ifdef ANJAY_WITH_LOCK_FREE_QUERIES
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_LOCK_FREE_QUERIES = ON");
+#else // ANJAY_WITH_LOCK_FREE_QUERIES
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_LOCK_FREE_QUERIES = OFF");
+#endif // ANJAY_WITH_LOCK_FREE_QUERIES
 #ifdef ANJAY_WITH_LOGS
     _anjay_log(anjay, TRACE, "ANJAY_WITH_LOGS = ON");
 #else // ANJAY_WITH_LOGS
@@ -204,6 +230,11 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_MODULE_FW_UPDATE
     _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_FW_UPDATE = OFF");
 #endif // ANJAY_WITH_MODULE_FW_UPDATE
+#ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_FW_UPDATE_DELTA = ON");
+#else // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_FW_UPDATE_DELTA = OFF");
+#endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
 #ifdef ANJAY_WITH_MODULE_IPSO_OBJECTS
     _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_IPSO_OBJECTS = ON");
 #else // ANJAY_WITH_MODULE_IPSO_OBJECTS
@@ -264,6 +295,11 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_OBSERVE
     _anjay_log(anjay, TRACE, "ANJAY_WITH_OBSERVE = OFF");
 #endif // ANJAY_WITH_OBSERVE
+#ifdef ANJAY_WITH_OBSERVE_ATTRS_CACHE
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_OBSERVE_ATTRS_CACHE = ON");
+#else // ANJAY_WITH_OBSERVE_ATTRS_CACHE
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_OBSERVE_ATTRS_CACHE = OFF");
+#endif // ANJAY_WITH_OBSERVE_ATTRS_CACHE
 #ifdef ANJAY_WITH_SECURITY_STRUCTURED
     _anjay_log(anjay, TRACE, "ANJAY_WITH_SECURITY_STRUCTURED = ON");
 #else // ANJAY_WITH_SECURITY_STRUCTURED
@@ -294,6 +330,11 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_THREAD_SAFETY
     _anjay_log(anjay, TRACE, "ANJAY_WITH_THREAD_SAFETY = OFF");
 #endif // ANJAY_WITH_THREAD_SAFETY
+#ifdef ANJAY_WITH_TLV_TWO_PASS_READ
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_TLV_TWO_PASS_READ = ON");
+#else // ANJAY_WITH_TLV_TWO_PASS_READ
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_TLV_TWO_PASS_READ = OFF");
+#endif // ANJAY_WITH_TLV_TWO_PASS_READ
 #ifdef ANJAY_WITH_TRACE_LOGS
     _anjay_log(anjay, TRACE, "ANJAY_WITH_TRACE_LOGS = ON");
 #else // ANJAY_WITH_TRACE_LOGS
@@ -16,6 +16,12 @@
 #    error "ANJAY_WITH_MODULE_ATTR_STORAGE has been removed since Anjay 3.0. Please update your anjay_config.h to use ANJAY_WITH_ATTR_STORAGE instead."
 #endif // ANJAY_WITH_MODULE_ATTR_STORAGE
 
+#if defined(ANJAY_WITH_TLV_TWO_PASS_READ)                  \
+        && (!defined(ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES) \
+            || defined(ANJAY_WITHOUT_TLV))
+#    error "ANJAY_WITH_TLV_TWO_PASS_READ requires TLV support and ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES"
+#endif
+
 #if defined(AVS_COMMONS_HAVE_VISIBILITY) && !defined(ANJAY_TEST)
 /* set default visibility for external symbols */
 #    pragma GCC visibility push(default)
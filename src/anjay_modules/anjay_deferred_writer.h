@@ -0,0 +1,92 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_INCLUDE_ANJAY_MODULES_DEFERRED_WRITER_H
+#define ANJAY_INCLUDE_ANJAY_MODULES_DEFERRED_WRITER_H
+
+#include <anjay_init.h>
+
+#include <anjay_modules/anjay_utils_core.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#ifdef ANJAY_WITH_DOWNLOADER
+
+/**
+ * Function that actually writes a block of data, e.g. by calling the
+ * stream_write handler of a firmware update module. Called with the Anjay mutex
+ * locked. Shall return 0 on success or a negative value in case of error.
+ *
+ * The function may release the Anjay mutex for the time of a user callback.
+ * Functions of the writer called from other threads in the meantime wait until
+ * it returns. It must not cause the same writer to be used from the calling
+ * thread, as that would deadlock.
+ */
+typedef int anjay_deferred_writer_write_t(anjay_unlocked_t *anjay,
+                                          const void *data,
+                                          size_t length,
+                                          void *arg);
+
+/**
+ * Called from a scheduler job if writing a queued block failed. @p result is
+ * the value returned by @ref anjay_deferred_writer_write_t. The writer object
+ * may be deleted from within this function.
+ */
+typedef void anjay_deferred_writer_failed_t(anjay_unlocked_t *anjay,
+                                            int result,
+                                            void *arg);
+
+/**
+ * Bounded queue of downloaded blocks that are written from a scheduler job
+ * instead of directly from the download callback. This allows the next block
+ * to be requested while the previous one is still being written.
+ */
+typedef struct anjay_deferred_writer_struct anjay_deferred_writer_t;
+
+/**
+ * Creates a deferred writer that will queue at most @p max_queued_bytes bytes.
+ *
+ * @returns Created writer, or NULL in case of an out-of-memory condition.
+ */
+anjay_deferred_writer_t *
+_anjay_deferred_writer_new(anjay_unlocked_t *anjay,
+                           size_t max_queued_bytes,
+                           anjay_deferred_writer_write_t *write,
+                           anjay_deferred_writer_failed_t *on_failure,
+                           void *arg);
+
+/**
+ * Queues a copy of @p data to be written. If there is not enough space in the
+ * queue, the oldest queued blocks are written synchronously first, which
+ * throttles the caller down to the speed of the underlying storage.
+ *
+ * @returns 0 on success, or the error code returned by a failed write - either
+ *          a synchronous one, or a deferred one that happened earlier.
+ */
+int _anjay_deferred_writer_write(anjay_deferred_writer_t *writer,
+                                 const void *data,
+                                 size_t length);
+
+/**
+ * Synchronously writes all queued blocks.
+ *
+ * @returns 0 on success, or the error code returned by a failed write.
+ */
+int _anjay_deferred_writer_flush(anjay_deferred_writer_t *writer);
+
+/**
+ * Discards all queued blocks without writing them and frees the writer.
+ */
+void _anjay_deferred_writer_delete(anjay_deferred_writer_t **writer_ptr);
+
+#endif // ANJAY_WITH_DOWNLOADER
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_INCLUDE_ANJAY_MODULES_DEFERRED_WRITER_H */
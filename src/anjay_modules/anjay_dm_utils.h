@@ -231,6 +231,8 @@ struct anjay_unlocked_dm_object_def_struct {
     anjay_oid_t oid;
     const char *version;
     anjay_unlocked_dm_handlers_t handlers;
+    const anjay_dm_resource_def_t *resources;
+    size_t resources_count;
 };
 
 #endif // ANJAY_WITH_THREAD_SAFETY
@@ -416,8 +418,10 @@ int _anjay_dm_foreach_resource(anjay_unlocked_t *anjay,
 
 /**
  * Checks if the specific resource is supported and present, and what is its
- * kind. This function internally calls @ref _anjay_dm_foreach_resource, so it
- * is not optimal to use for multiple resources within the same Object Instance.
+ * kind. For Objects that provide a static Resource table, this is a binary
+ * search over that table. Otherwise, this function internally calls
+ * @ref _anjay_dm_foreach_resource, so it is not optimal to use for multiple
+ * resources within the same Object Instance.
  *
  * NOTE: It is REQUIRED that the presence of the Object and Object Instance is
  * checked beforehand, this function does not perform such checks.
@@ -843,6 +847,10 @@ _anjay_dm_installed_object_oid(const anjay_dm_installed_object_t *obj);
 const char *
 _anjay_dm_installed_object_version(const anjay_dm_installed_object_t *obj);
 
+const anjay_dm_resource_def_t *
+_anjay_dm_installed_object_resources(const anjay_dm_installed_object_t *obj,
+                                     size_t *out_count);
+
 #else // ANJAY_WITH_THREAD_SAFETY
 
 static inline anjay_oid_t
@@ -861,6 +869,16 @@ _anjay_dm_installed_object_version(const anjay_dm_installed_object_t *obj) {
     return (**obj)->version;
 }
 
+static inline const anjay_dm_resource_def_t *
+_anjay_dm_installed_object_resources(const anjay_dm_installed_object_t *obj,
+                                     size_t *out_count) {
+    assert(obj);
+    assert(*obj);
+    assert(**obj);
+    *out_count = (**obj)->resources_count;
+    return (**obj)->resources;
+}
+
 #endif // ANJAY_WITH_THREAD_SAFETY
 
 AVS_LIST(anjay_dm_installed_object_t) *
@@ -898,6 +916,25 @@ int _anjay_send_batch_data_add_current_multiple_unlocked(
         size_t paths_length,
         bool ignore_not_found);
 
+/**
+ * Position at the end of a batch builder, as returned by
+ * @ref _anjay_send_batch_builder_mark .
+ */
+typedef void *anjay_send_batch_builder_mark_t;
+
+/**
+ * Returns the current end of @p builder. Entries added afterwards can be
+ * discarded using @ref _anjay_send_batch_builder_rollback .
+ */
+anjay_send_batch_builder_mark_t
+_anjay_send_batch_builder_mark(anjay_send_batch_builder_t *builder);
+
+/**
+ * Removes all entries added to @p builder since @p mark was taken.
+ */
+void _anjay_send_batch_builder_rollback(anjay_send_batch_builder_t *builder,
+                                        anjay_send_batch_builder_mark_t mark);
+
 anjay_send_result_t
 _anjay_send_deferrable_unlocked(anjay_unlocked_t *anjay,
                                 anjay_ssid_t ssid,
@@ -925,6 +962,12 @@ int _anjay_ret_bytes_unlocked(anjay_unlocked_output_ctx_t *ctx,
                               const void *data,
                               size_t length);
 
+int _anjay_ret_bytes_borrowed_unlocked(anjay_unlocked_output_ctx_t *ctx,
+                                       const void *data,
+                                       size_t length,
+                                       anjay_ret_bytes_release_t *release,
+                                       void *release_arg);
+
 int _anjay_ret_string_unlocked(anjay_unlocked_output_ctx_t *ctx,
                                const char *value);
 
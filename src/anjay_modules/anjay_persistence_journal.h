@@ -0,0 +1,142 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_INCLUDE_ANJAY_MODULES_PERSISTENCE_JOURNAL_H
+#define ANJAY_INCLUDE_ANJAY_MODULES_PERSISTENCE_JOURNAL_H
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_list.h>
+#include <avsystem/commons/avs_stream.h>
+
+#ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
+#    include <avsystem/commons/avs_persistence.h>
+#endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
+
+#include <anjay/core.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
+
+/**
+ * A journal is a sequence of records, each of which is framed as follows:
+ *
+ * - payload size: 32-bit big-endian unsigned integer,
+ * - payload,
+ * - CRC-32 (the same as used by Ethernet and zlib) of the payload: 32-bit
+ *   big-endian unsigned integer.
+ *
+ * There is no header, so that records can be appended to a stream at any time.
+ * A record that is incomplete or does not match its checksum is assumed to be
+ * a remnant of an interrupted append, and ends the journal - so that each
+ * record is either replayed as a whole, or not at all.
+ */
+typedef enum {
+    ANJAY_JOURNAL_READ_OK,
+    ANJAY_JOURNAL_READ_END,
+    ANJAY_JOURNAL_READ_INVALID
+} anjay_journal_read_result_t;
+
+/**
+ * Writes the contents of @p payload, which MUST be a membuf stream, as a single
+ * record. @p payload is left empty.
+ */
+avs_error_t _anjay_journal_write_record(avs_stream_t *out,
+                                        avs_stream_t *payload);
+
+/**
+ * Reads a single record from @p in and appends its payload to @p payload.
+ * Errors are only returned if the streams themselves fail; a missing or
+ * damaged record is reported through @p out_result instead.
+ */
+avs_error_t _anjay_journal_read_record(avs_stream_t *in,
+                                       avs_stream_t *payload,
+                                       anjay_journal_read_result_t *out_result);
+
+/**
+ * Describes a list of Object Instances kept by a module, sorted by IID, that
+ * can be journaled using the functions below.
+ */
+typedef struct {
+    /** Size of a single list element. */
+    size_t element_size;
+    /** Offset of the anjay_iid_t field within a list element. */
+    size_t iid_offset;
+    /**
+     * Offset of a bool field within a list element, that the module sets
+     * whenever it modifies the Instance. It is cleared whenever the journal
+     * state is updated.
+     */
+    size_t modified_offset;
+    /** Version of the format used when storing the Instances. */
+    uint8_t version;
+    /**
+     * Persists or restores a single Instance, including its IID, in the
+     * format identified by @p version.
+     */
+    avs_error_t (*handle_instance)(avs_persistence_context_t *ctx,
+                                   void *element,
+                                   uint8_t version);
+    /** Frees a single list element, including all the resources it owns. */
+    void (*destroy_instance)(AVS_LIST(void) *element_ptr);
+} anjay_journal_instances_def_t;
+
+/**
+ * IIDs of Instances present as of the last persist, restore or journal append.
+ * Together with the modified flags of the Instances, they are used to find the
+ * Instances that need to be written to the journal, so that unchanged Instances
+ * are not serialized at all.
+ */
+typedef struct {
+    AVS_LIST(anjay_iid_t) iids;
+    /**
+     * Set if the IIDs could not be stored. The next journal append will then
+     * rewrite all Instances.
+     */
+    bool reset_needed;
+} anjay_journal_state_t;
+
+void _anjay_journal_state_cleanup(anjay_journal_state_t *state);
+
+/**
+ * Makes @p instances the state that following calls to
+ * _anjay_journal_append_instances() will be compared against, and clears their
+ * modified flags. To be called after each successful persist or restore.
+ */
+void _anjay_journal_state_update(anjay_journal_state_t *state,
+                                 const anjay_journal_instances_def_t *def,
+                                 AVS_LIST(void) instances);
+
+/**
+ * Appends a single record to @p out, containing all Instances added or flagged
+ * as modified, and IIDs of all Instances removed since the last update of
+ * @p state. Nothing is written if there are no changes. @p state is updated
+ * on success.
+ */
+avs_error_t
+_anjay_journal_append_instances(anjay_journal_state_t *state,
+                                const anjay_journal_instances_def_t *def,
+                                AVS_LIST(void) instances,
+                                avs_stream_t *out);
+
+/**
+ * Applies all records read from @p journal onto @p instances_ptr. If an error
+ * is returned, @p instances_ptr may be left partially updated.
+ */
+avs_error_t
+_anjay_journal_replay_instances(const anjay_journal_instances_def_t *def,
+                                AVS_LIST(void) *instances_ptr,
+                                avs_stream_t *journal);
+
+#endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_INCLUDE_ANJAY_MODULES_PERSISTENCE_JOURNAL_H */
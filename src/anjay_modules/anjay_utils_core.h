@@ -10,9 +10,10 @@
 #ifndef ANJAY_INCLUDE_ANJAY_MODULES_UTILS_CORE_H
 #define ANJAY_INCLUDE_ANJAY_MODULES_UTILS_CORE_H
 
-#ifdef ANJAY_WITH_EVENT_LOOP
+#if defined(ANJAY_WITH_EVENT_LOOP) || defined(ANJAY_WITH_LOCK_FREE_QUERIES)
 #    include <stdatomic.h>
-#endif // ANJAY_WITH_EVENT_LOOP
+#endif // defined(ANJAY_WITH_EVENT_LOOP) ||
+       // defined(ANJAY_WITH_LOCK_FREE_QUERIES)
 
 #include <avsystem/commons/avs_list.h>
 #include <avsystem/commons/avs_url.h>
@@ -42,7 +43,66 @@
 #        undef ERROR
 #    endif
 #    include <avsystem/commons/avs_log.h>
-#    define _anjay_log(...) avs_log(__VA_ARGS__)
+#    ifdef ANJAY_WITH_DEFERRED_LOGS
+#        include <stdio.h>
+
+#        include <avsystem/commons/avs_defs.h>
+
+/**
+ * Stores the message in the deferred log buffer, to be formatted and passed to
+ * avs_log by anjay_deferred_log_flush(). See <anjay/deferred_log.h>.
+ */
+void _anjay_deferred_log(avs_log_level_t level,
+                         const char *module,
+                         const char *file,
+                         unsigned line,
+                         const char *format,
+                         ...) AVS_F_PRINTF(5, 6);
+
+/**
+ * Same as _ANJAY_DEFERRED_LOG_##Level, but the arguments are only evaluated if
+ * the message is not going to be filtered out, as with the LAZY_* levels of
+ * avs_log().
+ */
+#        define _ANJAY_DEFERRED_LOG_LAZY(Level, Module, ...)            \
+            (avs_log_should_log__(AVS_LOG_##Level, (Module))            \
+                     ? _ANJAY_DEFERRED_LOG_##Level(Module, __VA_ARGS__) \
+                     : (void) 0)
+
+#        ifdef ANJAY_WITH_TRACE_LOGS
+#            define _ANJAY_DEFERRED_LOG_TRACE(...) \
+                _anjay_deferred_log(AVS_LOG_TRACE, __VA_ARGS__)
+#            define _ANJAY_DEFERRED_LOG_LAZY_TRACE(...) \
+                _ANJAY_DEFERRED_LOG_LAZY(TRACE, __VA_ARGS__)
+#        else // ANJAY_WITH_TRACE_LOGS
+#            define _ANJAY_DEFERRED_LOG_TRACE(Module, File, Line, ...) \
+                ((void) sizeof(printf(__VA_ARGS__)))
+#            define _ANJAY_DEFERRED_LOG_LAZY_TRACE(...) \
+                _ANJAY_DEFERRED_LOG_TRACE(__VA_ARGS__)
+#        endif // ANJAY_WITH_TRACE_LOGS
+#        define _ANJAY_DEFERRED_LOG_DEBUG(...) \
+            _anjay_deferred_log(AVS_LOG_DEBUG, __VA_ARGS__)
+#        define _ANJAY_DEFERRED_LOG_INFO(...) \
+            _anjay_deferred_log(AVS_LOG_INFO, __VA_ARGS__)
+#        define _ANJAY_DEFERRED_LOG_WARNING(...) \
+            _anjay_deferred_log(AVS_LOG_WARNING, __VA_ARGS__)
+#        define _ANJAY_DEFERRED_LOG_ERROR(...) \
+            _anjay_deferred_log(AVS_LOG_ERROR, __VA_ARGS__)
+#        define _ANJAY_DEFERRED_LOG_LAZY_DEBUG(...) \
+            _ANJAY_DEFERRED_LOG_LAZY(DEBUG, __VA_ARGS__)
+#        define _ANJAY_DEFERRED_LOG_LAZY_INFO(...) \
+            _ANJAY_DEFERRED_LOG_LAZY(INFO, __VA_ARGS__)
+#        define _ANJAY_DEFERRED_LOG_LAZY_WARNING(...) \
+            _ANJAY_DEFERRED_LOG_LAZY(WARNING, __VA_ARGS__)
+#        define _ANJAY_DEFERRED_LOG_LAZY_ERROR(...) \
+            _ANJAY_DEFERRED_LOG_LAZY(ERROR, __VA_ARGS__)
+
+#        define _anjay_log(Module, Level, ...)                         \
+            _ANJAY_DEFERRED_LOG_##Level(AVS_QUOTE(Module), __FILE__,   \
+                                        __LINE__, __VA_ARGS__)
+#    else // ANJAY_WITH_DEFERRED_LOGS
+#        define _anjay_log(...) avs_log(__VA_ARGS__)
+#    endif // ANJAY_WITH_DEFERRED_LOGS
 #else
 #    include <stdio.h>
 #    define _anjay_log(Module, Level, ...) ((void) sizeof(printf(__VA_ARGS__)))
@@ -65,16 +125,50 @@ typedef enum {
 } anjay_event_loop_status_t;
 #endif // ANJAY_WITH_EVENT_LOOP
 
+#if defined(ANJAY_WITH_LOCK_FREE_QUERIES) && !defined(ANJAY_WITH_THREAD_SAFETY)
+#    error "ANJAY_WITH_LOCK_FREE_QUERIES requires ANJAY_WITH_THREAD_SAFETY"
+#endif // defined(ANJAY_WITH_LOCK_FREE_QUERIES) &&
+       // !defined(ANJAY_WITH_THREAD_SAFETY)
+
+#if defined(ANJAY_WITH_LOCK_FREE_QUERIES) \
+        && (defined(ANJAY_WITH_NET_STATS) || defined(ANJAY_WITH_OBSERVE))
+#    define ANJAY_QUERY_SNAPSHOT_DEFINED
+#endif // defined(ANJAY_WITH_LOCK_FREE_QUERIES) &&
+       // (defined(ANJAY_WITH_NET_STATS) || defined(ANJAY_WITH_OBSERVE))
+
 // Please update this condition if anjay_atomic_fields_t ever gets more fields
-#if defined(ANJAY_WITH_EVENT_LOOP)
+#if defined(ANJAY_WITH_EVENT_LOOP) || defined(ANJAY_QUERY_SNAPSHOT_DEFINED)
 #    define ANJAY_ATOMIC_FIELDS_DEFINED
-#endif // defined(ANJAY_WITH_EVENT_LOOP)
+#endif // defined(ANJAY_WITH_EVENT_LOOP) ||
+       // defined(ANJAY_QUERY_SNAPSHOT_DEFINED)
 
 #ifdef ANJAY_ATOMIC_FIELDS_DEFINED
 typedef struct {
 #    ifdef ANJAY_WITH_EVENT_LOOP
     volatile atomic_int event_loop_status;
 #    endif // ANJAY_WITH_EVENT_LOOP
+#    ifdef ANJAY_QUERY_SNAPSHOT_DEFINED
+    /**
+     * Results of read-only queries, published by
+     * _anjay_publish_query_snapshot() whenever the Anjay mutex is released, so
+     * that they can be read without locking it.
+     */
+#        ifdef ANJAY_WITH_NET_STATS
+    volatile atomic_uint_least64_t tx_bytes;
+    volatile atomic_uint_least64_t rx_bytes;
+    volatile atomic_uint_least64_t incoming_retransmissions;
+    volatile atomic_uint_least64_t outgoing_retransmissions;
+#        endif // ANJAY_WITH_NET_STATS
+#        ifdef ANJAY_WITH_OBSERVE
+    /**
+     * Values for ANJAY_SSID_ANY, in nanoseconds since the Unix epoch, or
+     * INT64_MIN if invalid.
+     */
+    volatile atomic_int_least64_t next_notify_trigger_ns;
+    volatile atomic_int_least64_t next_pmax_notify_trigger_ns;
+    volatile atomic_bool has_unsent_notifications;
+#        endif // ANJAY_WITH_OBSERVE
+#    endif // ANJAY_QUERY_SNAPSHOT_DEFINED
 } anjay_atomic_fields_t;
 #endif // ANJAY_ATOMIC_FIELDS_DEFINED
 
@@ -92,6 +186,12 @@ struct anjay_struct {
 
 void _anjay_reschedule_coap_sched_job(anjay_unlocked_t *anjay);
 
+#    ifdef ANJAY_QUERY_SNAPSHOT_DEFINED
+void _anjay_publish_query_snapshot(anjay_unlocked_t *anjay);
+#    else // ANJAY_QUERY_SNAPSHOT_DEFINED
+#        define _anjay_publish_query_snapshot(Anjay) ((void) (Anjay))
+#    endif // ANJAY_QUERY_SNAPSHOT_DEFINED
+
 #    ifdef ANJAY_WITH_NESTED_FUNCTION_MUTEX_LOCKS
 
 // We are compiling on a reasonably recent version of GCC in Debug mode.
@@ -135,6 +235,9 @@ typedef struct {
                 _anjay_reschedule_coap_sched_job(                       \
                         (anjay_unlocked_t *) &(AnjayLockedVar)          \
                                 ->anjay_unlocked_placeholder);          \
+                _anjay_publish_query_snapshot(                          \
+                        (anjay_unlocked_t *) &(AnjayLockedVar)          \
+                                ->anjay_unlocked_placeholder);          \
                 avs_mutex_unlock((AnjayLockedVar)->mutex);              \
             }                                                           \
             }                                                           \
@@ -190,6 +293,9 @@ typedef struct {
             _anjay_reschedule_coap_sched_job(              \
                     (anjay_unlocked_t *) &(AnjayLockedVar) \
                             ->anjay_unlocked_placeholder); \
+            _anjay_publish_query_snapshot(                 \
+                    (anjay_unlocked_t *) &(AnjayLockedVar) \
+                            ->anjay_unlocked_placeholder); \
             avs_mutex_unlock((AnjayLockedVar)->mutex);     \
             }                                              \
             (void) 0
@@ -426,6 +532,12 @@ avs_sched_t *_anjay_get_scheduler_unlocked(anjay_unlocked_t *anjay);
 
 void _anjay_log_oom(void);
 
+/**
+ * Updates @p crc with @p size bytes of @p data. The checksum is the CRC-32
+ * variant used by Ethernet and zlib; use 0 as the initial value.
+ */
+uint32_t _anjay_crc32(uint32_t crc, const void *data, size_t size);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* ANJAY_INCLUDE_ANJAY_MODULES_UTILS_CORE_H */
@@ -16,6 +16,7 @@
 
 #include "anjay_access_utils_private.h"
 #include "anjay_dm_core.h"
+#include "anjay_instrumentation.h"
 #include "anjay_io_core.h"
 #include "anjay_servers_utils.h"
 
@@ -370,8 +371,8 @@ _anjay_instance_action_allowed_stateless(anjay_unlocked_t *anjay,
 }
 
 #ifdef ANJAY_WITH_ACCESS_CONTROL
-bool _anjay_instance_action_allowed_by_acl(anjay_unlocked_t *anjay,
-                                           const anjay_action_info_t *info) {
+static bool action_allowed_by_acl(anjay_unlocked_t *anjay,
+                                  const anjay_action_info_t *info) {
     assert(info->oid != ANJAY_DM_OID_SECURITY);
     assert(info->iid != ANJAY_ID_INVALID
            || info->action == ANJAY_ACTION_CREATE);
@@ -416,6 +417,14 @@ bool _anjay_instance_action_allowed_by_acl(anjay_unlocked_t *anjay,
         return false;
     }
 }
+
+bool _anjay_instance_action_allowed_by_acl(anjay_unlocked_t *anjay,
+                                           const anjay_action_info_t *info) {
+    ANJAY_INSTR_START(start);
+    bool result = action_allowed_by_acl(anjay, info);
+    _anjay_instr_record(anjay, ANJAY_INSTR_PROBE_ACCESS_CONTROL, start);
+    return result;
+}
 #endif // ANJAY_WITH_ACCESS_CONTROL
 
 bool _anjay_instance_action_allowed(anjay_unlocked_t *anjay,
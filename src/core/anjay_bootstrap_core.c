@@ -1207,6 +1207,7 @@ static void send_request_bootstrap(anjay_unlocked_t *anjay,
         avs_coap_client_async_response_handler_t *response_handler =
                 bootstrap_request_response_handler;
 
+        _anjay_query_snapshot_mark_dirty(anjay);
         if (avs_is_err(
                     (err = avs_coap_client_send_async_request(
                              coap,
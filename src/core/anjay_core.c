@@ -244,6 +244,14 @@ static int init_anjay(anjay_unlocked_t *anjay,
     anjay->connection_error_is_registration_failure =
             config->connection_error_is_registration_failure;
     anjay->enable_self_notify = config->enable_self_notify;
+    // Make sure that the initial values are published on the first unlock
+    _anjay_query_snapshot_mark_dirty(anjay);
+#ifdef ANJAY_WITH_SEND
+    if (avs_time_duration_valid(config->send_coalescing_delay)) {
+        anjay->sender.coalescing_delay = config->send_coalescing_delay;
+    }
+    anjay->sender.coalescing_max_records = config->send_coalescing_max_records;
+#endif // ANJAY_WITH_SEND
     anjay->use_connection_id = config->use_connection_id;
     anjay->additional_tls_config_clb = config->additional_tls_config_clb;
 
@@ -273,6 +281,8 @@ static void coap_sched_job(avs_sched_t *sched, const void *dummy) {
     anjay_t *anjay_locked = _anjay_get_from_sched(sched);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     if (anjay->coap_sched) {
+        // CoAP jobs may retransmit messages or time out exchanges
+        _anjay_query_snapshot_mark_dirty(anjay);
         avs_sched_run(anjay->coap_sched);
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
@@ -298,6 +308,29 @@ void _anjay_reschedule_coap_sched_job(anjay_unlocked_t *anjay) {
         }
     }
 }
+
+#    ifdef ANJAY_QUERY_SNAPSHOT_DEFINED
+void _anjay_publish_query_snapshot(anjay_unlocked_t *anjay) {
+    // NOTE: This function is implicitly called at every ANJAY_MUTEX_UNLOCK()
+    // All state changes happen with the Anjay mutex locked, and each of them
+    // calls _anjay_query_snapshot_mark_dirty(), so the values published here
+    // stay accurate until the mutex is locked again. Unlocks that follow
+    // read-only operations do not walk the servers and observations at all.
+    if (!anjay->query_snapshot_dirty) {
+        return;
+    }
+    anjay_atomic_fields_t *fields =
+            &AVS_CONTAINER_OF(anjay, anjay_t, anjay_unlocked_placeholder)
+                     ->atomic_fields;
+#        ifdef ANJAY_WITH_NET_STATS
+    _anjay_net_stats_publish(anjay, fields);
+#        endif // ANJAY_WITH_NET_STATS
+#        ifdef ANJAY_WITH_OBSERVE
+    _anjay_observe_publish_planned_triggers(anjay, fields);
+#        endif // ANJAY_WITH_OBSERVE
+    anjay->query_snapshot_dirty = false;
+}
+#    endif // ANJAY_QUERY_SNAPSHOT_DEFINED
 #endif // ANJAY_WITH_THREAD_SAFETY
 
 const char *anjay_get_version(void) {
@@ -372,10 +405,16 @@ static void anjay_cleanup_impl(anjay_unlocked_t *anjay, bool deregister) {
 #endif // ANJAY_WITH_ATTR_STORAGE
     _anjay_dm_cleanup(&anjay->dm);
     _anjay_notify_clear_queue(&anjay->scheduled_notify.queue);
+#ifdef ANJAY_WITH_DISCOVER_CACHE
+    _anjay_discover_cache_cleanup(&anjay->discover_cache);
+#endif // ANJAY_WITH_DISCOVER_CACHE
 
 #ifdef ANJAY_WITH_SEND
     _anjay_send_cleanup(&anjay->sender);
 #endif // ANJAY_WITH_SEND
+#ifdef ANJAY_WITH_INSTRUMENTATION
+    _anjay_instr_cleanup(&anjay->instr);
+#endif // ANJAY_WITH_INSTRUMENTATION
 
     avs_free(anjay->default_tls_ciphersuites.ids);
     avs_free(anjay->endpoint_name);
@@ -997,6 +1036,7 @@ static int serve_connection(anjay_connection_ref_t connection) {
     avs_coap_ctx_t *coap = _anjay_connection_get_coap(connection);
     assert(coap);
 
+    _anjay_query_snapshot_mark_dirty(_anjay_from_server(connection.server));
     handle_incoming_message_args_t args = {
         .connection = connection,
         .serve_result = 0
@@ -20,10 +20,12 @@
 #include <avsystem/coap/udp.h>
 
 #include "anjay_dm_core.h"
+#include "dm/anjay_discover.h"
 #include "observe/anjay_observe_core.h"
 
 #include "anjay_bootstrap_core.h"
 #include "anjay_downloader.h"
+#include "anjay_instrumentation.h"
 #include "anjay_servers_private.h"
 #include "anjay_stats.h"
 #include "anjay_utils_private.h"
@@ -95,6 +97,14 @@ struct
      */
     AVS_LIST(anjay_server_info_t) servers;
 
+    /**
+     * Session state restored by anjay_session_state_restore() that has not
+     * yet been applied to any server, because a server with a matching SSID
+     * did not exist at the time. Entries are consumed when such server is
+     * created.
+     */
+    AVS_LIST(anjay_server_session_state_t) pending_session_states;
+
     /**
      * Cache of anjay_socket_entry_t objects, returned by
      * anjay_get_socket_entries(). These entries are never used for anything
@@ -153,6 +163,9 @@ struct
 #ifdef ANJAY_WITH_NET_STATS
     closed_connections_stats_t closed_connections_stats;
 #endif // ANJAY_WITH_NET_STATS
+#ifdef ANJAY_WITH_INSTRUMENTATION
+    anjay_instr_t instr;
+#endif // ANJAY_WITH_INSTRUMENTATION
     bool use_connection_id;
     avs_ssl_additional_configuration_clb_t *additional_tls_config_clb;
 
@@ -160,7 +173,18 @@ struct
     anjay_attr_storage_t attr_storage;
 #endif // ANJAY_WITH_ATTR_STORAGE
 
+#ifdef ANJAY_WITH_DISCOVER_CACHE
+    anjay_discover_cache_t discover_cache;
+#endif // ANJAY_WITH_DISCOVER_CACHE
+
     anjay_prng_ctx_t prng_ctx;
+#ifdef ANJAY_QUERY_SNAPSHOT_DEFINED
+    /**
+     * Set whenever any state published by _anjay_publish_query_snapshot() may
+     * have changed; cleared when the snapshot is published.
+     */
+    bool query_snapshot_dirty;
+#endif // ANJAY_QUERY_SNAPSHOT_DEFINED
 #if !defined(ANJAY_WITH_THREAD_SAFETY) && defined(ANJAY_ATOMIC_FIELDS_DEFINED)
     anjay_atomic_fields_t atomic_fields;
 #endif // !defined(ANJAY_WITH_THREAD_SAFETY) &&
@@ -190,6 +214,19 @@ static inline avs_sched_t *_anjay_get_coap_sched(anjay_unlocked_t *anjay) {
 #endif // ANJAY_WITH_THREAD_SAFETY
 }
 
+#ifdef ANJAY_QUERY_SNAPSHOT_DEFINED
+/**
+ * Makes the next ANJAY_MUTEX_UNLOCK() refresh the values returned by lock-free
+ * queries. Needs to be called after each change to network traffic counters,
+ * the set of active server connections or the observation state.
+ */
+static inline void _anjay_query_snapshot_mark_dirty(anjay_unlocked_t *anjay) {
+    anjay->query_snapshot_dirty = true;
+}
+#else // ANJAY_QUERY_SNAPSHOT_DEFINED
+#    define _anjay_query_snapshot_mark_dirty(Anjay) ((void) (Anjay))
+#endif // ANJAY_QUERY_SNAPSHOT_DEFINED
+
 #if defined(ANJAY_WITH_ATTR_STORAGE)
 
 // clang-format off
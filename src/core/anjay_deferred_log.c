@@ -0,0 +1,622 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <anjay/deferred_log.h>
+
+#ifdef ANJAY_WITH_DEFERRED_LOGS
+
+#    include <assert.h>
+#    include <stdarg.h>
+#    include <stdatomic.h>
+#    include <stdbool.h>
+#    include <stdint.h>
+#    include <stdio.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_defs.h>
+#    include <avsystem/commons/avs_log.h>
+
+#    include <anjay_modules/anjay_utils_core.h>
+
+#endif // ANJAY_WITH_DEFERRED_LOGS
+
+VISIBILITY_SOURCE_BEGIN
+
+#ifdef ANJAY_WITH_DEFERRED_LOGS
+
+AVS_STATIC_ASSERT(ANJAY_DEFERRED_LOG_BUFFER_ENTRIES > 0
+                          && !(ANJAY_DEFERRED_LOG_BUFFER_ENTRIES
+                               & (ANJAY_DEFERRED_LOG_BUFFER_ENTRIES - 1)),
+                  deferred_log_buffer_entries_is_power_of_two);
+
+/**
+ * Size of the space for serialized arguments of a single message. Messages
+ * whose arguments do not fit are formatted at the call site instead, and the
+ * result is truncated to this size.
+ */
+#    define DEFERRED_LOG_ARGS_SIZE 256
+
+typedef enum {
+    ARG_PERCENT,
+    ARG_SIGNED,
+    ARG_UNSIGNED,
+    ARG_CHAR,
+    ARG_DOUBLE,
+    ARG_LONG_DOUBLE,
+    ARG_STRING,
+    ARG_POINTER
+} arg_type_t;
+
+typedef enum {
+    LENGTH_DEFAULT,
+    LENGTH_HH,
+    LENGTH_H,
+    LENGTH_L,
+    LENGTH_LL,
+    LENGTH_Z,
+    LENGTH_J,
+    LENGTH_T,
+    LENGTH_BIG_L
+} arg_length_t;
+
+typedef struct {
+    arg_type_t type;
+    arg_length_t length;
+    bool width_star;
+    bool precision_star;
+    /** Precision given as digits; -1 if not present or given as '*' */
+    int precision;
+    /**
+     * Conversion specification to be passed to snprintf(). Length modifiers of
+     * integer conversions are replaced with 'j', as all integer arguments are
+     * stored as intmax_t or uintmax_t.
+     */
+    char spec[32];
+} conversion_t;
+
+typedef struct {
+    /**
+     * Turn of the entry in the ring buffer, biased by its index so that the
+     * zero-initialized buffer is valid. See reserve_entry() for details.
+     */
+    atomic_size_t sequence;
+    avs_log_level_t level;
+    bool preformatted;
+    const char *module;
+    const char *file;
+    unsigned line;
+    const char *format;
+    size_t args_size;
+    /**
+     * Serialized arguments, as described by @ref format; or the whole message
+     * if @ref preformatted is true.
+     */
+    char args[DEFERRED_LOG_ARGS_SIZE];
+} deferred_log_entry_t;
+
+static struct {
+    deferred_log_entry_t entries[ANJAY_DEFERRED_LOG_BUFFER_ENTRIES];
+    atomic_size_t enqueue_pos;
+    atomic_size_t dequeue_pos;
+    atomic_size_t dropped;
+} g_deferred_log;
+
+static const char *parse_conversion(const char *format, conversion_t *out) {
+    assert(*format == '%');
+    const char *ptr = format + 1;
+    memset(out, 0, sizeof(*out));
+    out->precision = -1;
+
+    ptr += strspn(ptr, "-+ #0");
+    if (*ptr == '*') {
+        out->width_star = true;
+        ++ptr;
+    } else {
+        ptr += strspn(ptr, "0123456789");
+    }
+    if (*ptr == '.') {
+        ++ptr;
+        if (*ptr == '*') {
+            out->precision_star = true;
+            ++ptr;
+        } else {
+            out->precision = 0;
+            for (; *ptr >= '0' && *ptr <= '9'; ++ptr) {
+                out->precision = 10 * out->precision + (*ptr - '0');
+            }
+        }
+    }
+
+    const char *length_start = ptr;
+    switch (*ptr) {
+    case 'h':
+        if (*++ptr == 'h') {
+            ++ptr;
+            out->length = LENGTH_HH;
+        } else {
+            out->length = LENGTH_H;
+        }
+        break;
+    case 'l':
+        if (*++ptr == 'l') {
+            ++ptr;
+            out->length = LENGTH_LL;
+        } else {
+            out->length = LENGTH_L;
+        }
+        break;
+    case 'z':
+        ++ptr;
+        out->length = LENGTH_Z;
+        break;
+    case 'j':
+        ++ptr;
+        out->length = LENGTH_J;
+        break;
+    case 't':
+        ++ptr;
+        out->length = LENGTH_T;
+        break;
+    case 'L':
+        ++ptr;
+        out->length = LENGTH_BIG_L;
+        break;
+    default:
+        break;
+    }
+
+    switch (*ptr) {
+    case '%':
+        out->type = ARG_PERCENT;
+        break;
+    case 'd':
+    case 'i':
+        out->type = ARG_SIGNED;
+        break;
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+        out->type = ARG_UNSIGNED;
+        break;
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        out->type = out->length == LENGTH_BIG_L ? ARG_LONG_DOUBLE : ARG_DOUBLE;
+        break;
+    case 'c':
+        out->type = ARG_CHAR;
+        break;
+    case 's':
+        out->type = ARG_STRING;
+        break;
+    case 'p':
+        out->type = ARG_POINTER;
+        break;
+    default:
+        // %n, wide characters and strings, or a malformed specification
+        return NULL;
+    }
+    if ((out->type == ARG_CHAR || out->type == ARG_STRING)
+            && out->length != LENGTH_DEFAULT) {
+        return NULL;
+    }
+
+    size_t prefix_size = (size_t) (length_start - format);
+    if (prefix_size + 3 > sizeof(out->spec)) {
+        return NULL;
+    }
+    memcpy(out->spec, format, prefix_size);
+    char *spec_ptr = out->spec + prefix_size;
+    if (out->type == ARG_SIGNED || out->type == ARG_UNSIGNED) {
+        *spec_ptr++ = 'j';
+    } else if (out->type == ARG_LONG_DOUBLE) {
+        *spec_ptr++ = 'L';
+    }
+    *spec_ptr++ = *ptr;
+    *spec_ptr = '\0';
+    return ptr + 1;
+}
+
+static intmax_t signed_arg(arg_length_t length, va_list *ap) {
+    switch (length) {
+    case LENGTH_HH:
+        return (signed char) va_arg(*ap, int);
+    case LENGTH_H:
+        return (short) va_arg(*ap, int);
+    case LENGTH_L:
+        return va_arg(*ap, long);
+    case LENGTH_LL:
+        return va_arg(*ap, long long);
+    case LENGTH_Z:
+        return (intmax_t) va_arg(*ap, size_t);
+    case LENGTH_J:
+        return va_arg(*ap, intmax_t);
+    case LENGTH_T:
+        return va_arg(*ap, ptrdiff_t);
+    default:
+        return va_arg(*ap, int);
+    }
+}
+
+static uintmax_t unsigned_arg(arg_length_t length, va_list *ap) {
+    switch (length) {
+    case LENGTH_HH:
+        return (unsigned char) va_arg(*ap, unsigned);
+    case LENGTH_H:
+        return (unsigned short) va_arg(*ap, unsigned);
+    case LENGTH_L:
+        return va_arg(*ap, unsigned long);
+    case LENGTH_LL:
+        return va_arg(*ap, unsigned long long);
+    case LENGTH_Z:
+        return va_arg(*ap, size_t);
+    case LENGTH_J:
+        return va_arg(*ap, uintmax_t);
+    case LENGTH_T:
+        return (uintmax_t) va_arg(*ap, ptrdiff_t);
+    default:
+        return va_arg(*ap, unsigned);
+    }
+}
+
+static int store_value(deferred_log_entry_t *entry,
+                       const void *value,
+                       size_t size) {
+    if (size > sizeof(entry->args) - entry->args_size) {
+        return -1;
+    }
+    memcpy(entry->args + entry->args_size, value, size);
+    entry->args_size += size;
+    return 0;
+}
+
+static int store_string(deferred_log_entry_t *entry,
+                        const char *value,
+                        int precision) {
+    if (!value) {
+        value = "(null)";
+    }
+    size_t length;
+    if (precision >= 0) {
+        const char *end =
+                (const char *) memchr(value, '\0', (size_t) precision);
+        length = end ? (size_t) (end - value) : (size_t) precision;
+    } else {
+        length = strlen(value);
+    }
+    const char terminator = '\0';
+    if (length + 1 > sizeof(entry->args) - entry->args_size) {
+        return -1;
+    }
+    store_value(entry, value, length);
+    store_value(entry, &terminator, 1);
+    return 0;
+}
+
+static int store_args(deferred_log_entry_t *entry,
+                      const char *format,
+                      va_list *ap) {
+    entry->args_size = 0;
+    while ((format = strchr(format, '%'))) {
+        conversion_t conv;
+        if (!(format = parse_conversion(format, &conv))) {
+            return -1;
+        }
+        int star;
+        if (conv.width_star) {
+            star = va_arg(*ap, int);
+            if (store_value(entry, &star, sizeof(star))) {
+                return -1;
+            }
+        }
+        if (conv.precision_star) {
+            star = va_arg(*ap, int);
+            if (store_value(entry, &star, sizeof(star))) {
+                return -1;
+            }
+            conv.precision = star;
+        }
+
+        int result = 0;
+        switch (conv.type) {
+        case ARG_PERCENT:
+            break;
+        case ARG_SIGNED: {
+            intmax_t value = signed_arg(conv.length, ap);
+            result = store_value(entry, &value, sizeof(value));
+            break;
+        }
+        case ARG_UNSIGNED: {
+            uintmax_t value = unsigned_arg(conv.length, ap);
+            result = store_value(entry, &value, sizeof(value));
+            break;
+        }
+        case ARG_CHAR: {
+            int value = va_arg(*ap, int);
+            result = store_value(entry, &value, sizeof(value));
+            break;
+        }
+        case ARG_DOUBLE: {
+            double value = va_arg(*ap, double);
+            result = store_value(entry, &value, sizeof(value));
+            break;
+        }
+        case ARG_LONG_DOUBLE: {
+            long double value = va_arg(*ap, long double);
+            result = store_value(entry, &value, sizeof(value));
+            break;
+        }
+        case ARG_STRING:
+            result = store_string(entry, va_arg(*ap, const char *),
+                                  conv.precision);
+            break;
+        case ARG_POINTER: {
+            void *value = va_arg(*ap, void *);
+            result = store_value(entry, &value, sizeof(value));
+            break;
+        }
+        }
+        if (result) {
+            return result;
+        }
+    }
+    return 0;
+}
+
+static void load_value(const deferred_log_entry_t *entry,
+                       size_t *offset_ptr,
+                       void *out_value,
+                       size_t size) {
+    assert(*offset_ptr + size <= entry->args_size);
+    memcpy(out_value, entry->args + *offset_ptr, size);
+    *offset_ptr += size;
+}
+
+#    define FORMAT_CONVERSION(Out, Size, Conv, Stars, Value)                 \
+        ((Conv)->width_star && (Conv)->precision_star                        \
+                 ? snprintf((Out), (Size), (Conv)->spec, (Stars)[0],         \
+                            (Stars)[1], (Value))                             \
+                 : ((Conv)->width_star || (Conv)->precision_star)            \
+                           ? snprintf((Out), (Size), (Conv)->spec,           \
+                                      (Stars)[0], (Value))                   \
+                           : snprintf((Out), (Size), (Conv)->spec, (Value)))
+
+static void
+format_entry(const deferred_log_entry_t *entry, char *out, size_t out_size) {
+    assert(out_size > 0);
+    if (entry->preformatted) {
+        snprintf(out, out_size, "%s", entry->args);
+        return;
+    }
+
+    const char *format = entry->format;
+    size_t out_length = 0;
+    size_t args_offset = 0;
+    out[0] = '\0';
+    while (*format && out_length + 1 < out_size) {
+        const char *percent = strchr(format, '%');
+        size_t literal_length =
+                percent ? (size_t) (percent - format) : strlen(format);
+        size_t to_copy =
+                AVS_MIN(literal_length, out_size - out_length - 1);
+        memcpy(out + out_length, format, to_copy);
+        out_length += to_copy;
+        out[out_length] = '\0';
+        if (!percent || out_length + 1 >= out_size) {
+            break;
+        }
+
+        conversion_t conv;
+        format = parse_conversion(percent, &conv);
+        // the format string has already been validated in store_args()
+        assert(format);
+        int stars[2] = { 0, 0 };
+        size_t star_count = 0;
+        if (conv.width_star) {
+            load_value(entry, &args_offset, &stars[star_count++],
+                       sizeof(int));
+        }
+        if (conv.precision_star) {
+            load_value(entry, &args_offset, &stars[star_count++],
+                       sizeof(int));
+        }
+
+        char *conv_out = out + out_length;
+        size_t conv_out_size = out_size - out_length;
+        int result = 0;
+        switch (conv.type) {
+        case ARG_PERCENT:
+            conv_out[0] = '%';
+            conv_out[1] = '\0';
+            result = 1;
+            break;
+        case ARG_SIGNED: {
+            intmax_t value;
+            load_value(entry, &args_offset, &value, sizeof(value));
+            result = FORMAT_CONVERSION(conv_out, conv_out_size, &conv, stars,
+                                       value);
+            break;
+        }
+        case ARG_UNSIGNED: {
+            uintmax_t value;
+            load_value(entry, &args_offset, &value, sizeof(value));
+            result = FORMAT_CONVERSION(conv_out, conv_out_size, &conv, stars,
+                                       value);
+            break;
+        }
+        case ARG_CHAR: {
+            int value;
+            load_value(entry, &args_offset, &value, sizeof(value));
+            result = FORMAT_CONVERSION(conv_out, conv_out_size, &conv, stars,
+                                       value);
+            break;
+        }
+        case ARG_DOUBLE: {
+            double value;
+            load_value(entry, &args_offset, &value, sizeof(value));
+            result = FORMAT_CONVERSION(conv_out, conv_out_size, &conv, stars,
+                                       value);
+            break;
+        }
+        case ARG_LONG_DOUBLE: {
+            long double value;
+            load_value(entry, &args_offset, &value, sizeof(value));
+            result = FORMAT_CONVERSION(conv_out, conv_out_size, &conv, stars,
+                                       value);
+            break;
+        }
+        case ARG_STRING: {
+            const char *value = entry->args + args_offset;
+            args_offset += strlen(value) + 1;
+            result = FORMAT_CONVERSION(conv_out, conv_out_size, &conv, stars,
+                                       value);
+            break;
+        }
+        case ARG_POINTER: {
+            void *value;
+            load_value(entry, &args_offset, &value, sizeof(value));
+            result = FORMAT_CONVERSION(conv_out, conv_out_size, &conv, stars,
+                                       value);
+            break;
+        }
+        }
+        if (result < 0) {
+            conv_out[0] = '\0';
+        } else {
+            out_length += AVS_MIN((size_t) result, conv_out_size - 1);
+        }
+    }
+}
+
+/*
+ * The ring buffer is a bounded multi-producer, multi-consumer queue, in which
+ * every entry has a sequence number: an entry at index i may be filled by the
+ * producer that reserved position pos (where pos % ENTRIES == i) if its
+ * sequence is equal to pos, and read by the consumer at position pos if it is
+ * equal to pos + 1. The sequence numbers are stored minus i, so that a
+ * zero-initialized buffer does not require any further initialization.
+ */
+static deferred_log_entry_t *reserve_entry(atomic_size_t *pos_ptr,
+                                           size_t sequence_offset,
+                                           size_t *out_pos) {
+    size_t pos = atomic_load_explicit(pos_ptr, memory_order_relaxed);
+    while (true) {
+        size_t index = pos % ANJAY_DEFERRED_LOG_BUFFER_ENTRIES;
+        deferred_log_entry_t *entry = &g_deferred_log.entries[index];
+        size_t sequence =
+                atomic_load_explicit(&entry->sequence, memory_order_acquire);
+        ptrdiff_t diff =
+                (ptrdiff_t) (sequence - (pos - index + sequence_offset));
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(pos_ptr, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                *out_pos = pos;
+                return entry;
+            }
+        } else if (diff < 0) {
+            // buffer full (for producers) or empty (for consumers)
+            return NULL;
+        } else {
+            pos = atomic_load_explicit(pos_ptr, memory_order_relaxed);
+        }
+    }
+}
+
+static void release_entry(deferred_log_entry_t *entry,
+                          size_t pos,
+                          size_t sequence_offset) {
+    atomic_store_explicit(&entry->sequence,
+                          pos - pos % ANJAY_DEFERRED_LOG_BUFFER_ENTRIES
+                                  + sequence_offset,
+                          memory_order_release);
+}
+
+void _anjay_deferred_log(avs_log_level_t level,
+                         const char *module,
+                         const char *file,
+                         unsigned line,
+                         const char *format,
+                         ...) {
+    if (!avs_log_should_log__(level, module)) {
+        return;
+    }
+    size_t pos;
+    deferred_log_entry_t *entry =
+            reserve_entry(&g_deferred_log.enqueue_pos, 0, &pos);
+    if (!entry) {
+        atomic_fetch_add_explicit(&g_deferred_log.dropped, 1,
+                                  memory_order_relaxed);
+        return;
+    }
+    entry->level = level;
+    entry->module = module;
+    entry->file = file;
+    entry->line = line;
+    entry->format = format;
+
+    va_list ap;
+    va_list ap_copy;
+    va_start(ap, format);
+    va_copy(ap_copy, ap);
+    entry->preformatted = !!store_args(entry, format, &ap);
+    if (entry->preformatted) {
+        vsnprintf(entry->args, sizeof(entry->args), format, ap_copy);
+    }
+    va_end(ap_copy);
+    va_end(ap);
+
+    release_entry(entry, pos, 1);
+}
+
+size_t anjay_deferred_log_flush(void) {
+    size_t flushed = 0;
+    size_t pos;
+    deferred_log_entry_t *entry;
+    while ((entry = reserve_entry(&g_deferred_log.dequeue_pos, 1, &pos))) {
+        char message[AVS_COMMONS_LOG_MAX_LINE_LENGTH];
+        format_entry(entry, message, sizeof(message));
+        avs_log_level_t level = entry->level;
+        const char *module = entry->module;
+        const char *file = entry->file;
+        unsigned line = entry->line;
+        release_entry(entry, pos, ANJAY_DEFERRED_LOG_BUFFER_ENTRIES);
+
+        avs_log_internal_l__(level, module, file, line, "%s", message);
+        ++flushed;
+    }
+
+    size_t dropped = atomic_exchange_explicit(&g_deferred_log.dropped, 0,
+                                              memory_order_relaxed);
+    if (dropped) {
+        avs_log(anjay, WARNING, _("dropped ") "%lu" _(" log messages"),
+                (unsigned long) dropped);
+    }
+    return flushed;
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/core/deferred_log.c"
+#    endif // ANJAY_TEST
+
+#else // ANJAY_WITH_DEFERRED_LOGS
+
+size_t anjay_deferred_log_flush(void) {
+    return 0;
+}
+
+#endif // ANJAY_WITH_DEFERRED_LOGS
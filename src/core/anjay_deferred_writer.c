@@ -0,0 +1,248 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#ifdef ANJAY_WITH_DOWNLOADER
+
+#    include <assert.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_list.h>
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_sched.h>
+
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+#        include <avsystem/commons/avs_condvar.h>
+#    endif // ANJAY_WITH_THREAD_SAFETY
+
+#    include <anjay_modules/anjay_deferred_writer.h>
+#    include <anjay_modules/anjay_sched.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+typedef struct {
+    size_t length;
+    uint8_t data[];
+} queued_block_t;
+
+struct anjay_deferred_writer_struct {
+    anjay_unlocked_t *anjay;
+    anjay_deferred_writer_write_t *write;
+    anjay_deferred_writer_failed_t *on_failure;
+    void *arg;
+
+    size_t max_queued_bytes;
+    size_t queued_bytes;
+    AVS_LIST(queued_block_t) queue;
+    avs_sched_handle_t write_job_handle;
+    /* Result of the first failed write; nothing is written after that. */
+    int result;
+    /*
+     * Set while the write function is running. It may release the Anjay mutex,
+     * so other threads may call the functions below in the meantime - they
+     * need to wait until it returns, so that blocks are not written out of
+     * order and the writer is not deleted while still in use.
+     */
+    bool write_in_progress;
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    /* Number of threads blocked in wait_for_write(). */
+    size_t waiting_threads;
+    /* Signalled whenever write_in_progress or waiting_threads decrease. */
+    avs_condvar_t *write_finished;
+#    endif // ANJAY_WITH_THREAD_SAFETY
+};
+
+anjay_deferred_writer_t *
+_anjay_deferred_writer_new(anjay_unlocked_t *anjay,
+                           size_t max_queued_bytes,
+                           anjay_deferred_writer_write_t *write,
+                           anjay_deferred_writer_failed_t *on_failure,
+                           void *arg) {
+    assert(write);
+    assert(on_failure);
+    anjay_deferred_writer_t *writer =
+            (anjay_deferred_writer_t *) avs_calloc(1, sizeof(*writer));
+    if (!writer) {
+        _anjay_log_oom();
+        return NULL;
+    }
+    writer->anjay = anjay;
+    writer->write = write;
+    writer->on_failure = on_failure;
+    writer->arg = arg;
+    writer->max_queued_bytes = max_queued_bytes;
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    if (avs_condvar_create(&writer->write_finished)) {
+        _anjay_log_oom();
+        avs_free(writer);
+        return NULL;
+    }
+#    endif // ANJAY_WITH_THREAD_SAFETY
+    return writer;
+}
+
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+static void wait_for_write_finished(anjay_deferred_writer_t *writer) {
+    avs_condvar_wait(writer->write_finished,
+                     AVS_CONTAINER_OF(writer->anjay, anjay_t,
+                                      anjay_unlocked_placeholder)
+                             ->mutex,
+                     AVS_TIME_MONOTONIC_INVALID);
+}
+
+/**
+ * Waits until the write function called from another thread, if any, returns.
+ * The Anjay mutex is released while waiting.
+ */
+static void wait_for_write(anjay_deferred_writer_t *writer) {
+    if (writer->write_in_progress) {
+        ++writer->waiting_threads;
+        do {
+            wait_for_write_finished(writer);
+        } while (writer->write_in_progress);
+        --writer->waiting_threads;
+        // _anjay_deferred_writer_delete() may be waiting for this thread
+        avs_condvar_notify_all(writer->write_finished);
+    }
+}
+#    else // ANJAY_WITH_THREAD_SAFETY
+// without thread safety, a write may only be in progress if the writer is used
+// from within its own write function, which is not supported
+#        define wait_for_write(Writer) assert(!(Writer)->write_in_progress)
+#    endif // ANJAY_WITH_THREAD_SAFETY
+
+static int call_write(anjay_deferred_writer_t *writer,
+                      const void *data,
+                      size_t length) {
+    assert(!writer->write_in_progress);
+    writer->write_in_progress = true;
+    int result = writer->write(writer->anjay, data, length, writer->arg);
+    writer->write_in_progress = false;
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    avs_condvar_notify_all(writer->write_finished);
+#    endif // ANJAY_WITH_THREAD_SAFETY
+    return result;
+}
+
+static void discard_queue(anjay_deferred_writer_t *writer) {
+    AVS_LIST_CLEAR(&writer->queue);
+    writer->queued_bytes = 0;
+}
+
+static int write_queued_block(anjay_deferred_writer_t *writer) {
+    assert(writer->queue);
+    assert(!writer->result);
+    AVS_LIST(queued_block_t) block = AVS_LIST_DETACH(&writer->queue);
+    writer->queued_bytes -= block->length;
+    writer->result = call_write(writer, block->data, block->length);
+    AVS_LIST_DELETE(&block);
+    if (writer->result) {
+        discard_queue(writer);
+    }
+    return writer->result;
+}
+
+static void write_job(avs_sched_t *sched, const void *writer_ptr) {
+    anjay_deferred_writer_t *writer =
+            *(anjay_deferred_writer_t *const *) writer_ptr;
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    // If another thread is writing right now, it will either write the whole
+    // queue, or schedule this job again after queuing its block. Waiting for
+    // it here would not be safe, as the writer may be deleted in the meantime.
+    if (writer->queue && !writer->write_in_progress) {
+        int result = write_queued_block(writer);
+        if (result) {
+            // NOTE: writer may be deleted from within on_failure
+            writer->on_failure(writer->anjay, result, writer->arg);
+        } else if (writer->queue
+                   && AVS_SCHED_NOW(sched, &writer->write_job_handle,
+                                    write_job, &writer, sizeof(writer))) {
+            // the next write_job() would have been run from this very
+            // scheduler run anyway, so just write everything synchronously
+            if ((result = _anjay_deferred_writer_flush(writer))) {
+                writer->on_failure(writer->anjay, result, writer->arg);
+            }
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+int _anjay_deferred_writer_flush(anjay_deferred_writer_t *writer) {
+    wait_for_write(writer);
+    avs_sched_del(&writer->write_job_handle);
+    while (!writer->result && writer->queue) {
+        write_queued_block(writer);
+    }
+    return writer->result;
+}
+
+int _anjay_deferred_writer_write(anjay_deferred_writer_t *writer,
+                                 const void *data,
+                                 size_t length) {
+    wait_for_write(writer);
+    if (writer->result || !length) {
+        return writer->result;
+    }
+    while (writer->queue
+           && writer->queued_bytes + length > writer->max_queued_bytes) {
+        if (write_queued_block(writer)) {
+            return writer->result;
+        }
+    }
+
+    AVS_LIST(queued_block_t) block = NULL;
+    if (length <= writer->max_queued_bytes) {
+        block = (AVS_LIST(queued_block_t)) AVS_LIST_NEW_BUFFER(
+                sizeof(queued_block_t) + length);
+    }
+    if (!block
+            || (!writer->write_job_handle
+                && AVS_SCHED_NOW(_anjay_get_scheduler_unlocked(writer->anjay),
+                                 &writer->write_job_handle, write_job, &writer,
+                                 sizeof(writer)))) {
+        // block too large to be queued, or out of memory - write it
+        // synchronously, after everything that is already queued
+        AVS_LIST_CLEAR(&block);
+        if (!_anjay_deferred_writer_flush(writer)) {
+            writer->result = call_write(writer, data, length);
+        }
+        return writer->result;
+    }
+    block->length = length;
+    memcpy(block->data, data, length);
+    AVS_LIST_APPEND(&writer->queue, block);
+    writer->queued_bytes += length;
+    return 0;
+}
+
+void _anjay_deferred_writer_delete(anjay_deferred_writer_t **writer_ptr) {
+    if (*writer_ptr) {
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+        while ((*writer_ptr)->write_in_progress
+               || (*writer_ptr)->waiting_threads) {
+            wait_for_write_finished(*writer_ptr);
+        }
+        avs_condvar_cleanup(&(*writer_ptr)->write_finished);
+#    else  // ANJAY_WITH_THREAD_SAFETY
+        wait_for_write(*writer_ptr);
+#    endif // ANJAY_WITH_THREAD_SAFETY
+        avs_sched_del(&(*writer_ptr)->write_job_handle);
+        discard_queue(*writer_ptr);
+        avs_free(*writer_ptr);
+        *writer_ptr = NULL;
+    }
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/core/deferred_writer.c"
+#    endif // ANJAY_TEST
+
+#endif // ANJAY_WITH_DOWNLOADER
@@ -25,11 +25,13 @@
 
 #include <avsystem/coap/code.h>
 
+#include "coap/anjay_buffered_response.h"
 #include "coap/anjay_content_format.h"
 
 #include "anjay_access_utils_private.h"
 #include "anjay_core.h"
 #include "anjay_dm_core.h"
+#include "anjay_instrumentation.h"
 #include "anjay_io_core.h"
 #include "anjay_utils_private.h"
 #include "dm/anjay_discover.h"
@@ -82,6 +84,28 @@ _anjay_dm_installed_object_version(const anjay_dm_installed_object_t *obj) {
     return NULL;
 }
 
+const anjay_dm_resource_def_t *
+_anjay_dm_installed_object_resources(const anjay_dm_installed_object_t *obj,
+                                     size_t *out_count) {
+    assert(obj);
+    switch (obj->type) {
+    case ANJAY_DM_OBJECT_USER_PROVIDED:
+        assert(obj->impl.user_provided);
+        assert(*obj->impl.user_provided);
+        *out_count = (*obj->impl.user_provided)->resources_count;
+        return (*obj->impl.user_provided)->resources;
+
+    case ANJAY_DM_OBJECT_UNLOCKED:
+        assert(obj->impl.unlocked);
+        assert(*obj->impl.unlocked);
+        *out_count = (*obj->impl.unlocked)->resources_count;
+        return (*obj->impl.unlocked)->resources;
+    }
+    AVS_UNREACHABLE("Invalid installed object type");
+    *out_count = 0;
+    return NULL;
+}
+
 #endif // ANJAY_WITH_THREAD_SAFETY
 
 static int validate_version(const anjay_dm_installed_object_t *obj) {
@@ -105,6 +129,36 @@ static int validate_version(const anjay_dm_installed_object_t *obj) {
     return 0;
 }
 
+static bool presence_valid(anjay_dm_resource_presence_t presence) {
+    return presence == ANJAY_DM_RES_ABSENT || presence == ANJAY_DM_RES_PRESENT;
+}
+
+static int validate_resources(const anjay_dm_installed_object_t *obj) {
+    size_t count;
+    const anjay_dm_resource_def_t *resources =
+            _anjay_dm_installed_object_resources(obj, &count);
+    if (!resources) {
+        return 0;
+    }
+
+    int32_t last_rid = -1;
+    for (size_t i = 0; i < count; ++i) {
+        if (resources[i].rid == ANJAY_ID_INVALID
+                || (int32_t) resources[i].rid <= last_rid
+                || !_anjay_dm_res_kind_valid(resources[i].kind)
+                || !presence_valid(resources[i].presence)) {
+            dm_log(ERROR,
+                   _("invalid Resource table of Object ") "/%u" _(
+                           ": entry ") "%u" _(" is invalid or out of order"),
+                   (unsigned) _anjay_dm_installed_object_oid(obj),
+                   (unsigned) i);
+            return -1;
+        }
+        last_rid = resources[i].rid;
+    }
+    return 0;
+}
+
 int _anjay_dm_register_object(
         anjay_dm_t *dm, AVS_LIST(anjay_dm_installed_object_t) *elem_ptr_move) {
     assert(elem_ptr_move);
@@ -112,7 +166,8 @@ int _anjay_dm_register_object(
     assert(_anjay_dm_installed_object_oid(*elem_ptr_move) != ANJAY_ID_INVALID);
     assert(!AVS_LIST_NEXT(*elem_ptr_move));
 
-    if (validate_version(*elem_ptr_move)) {
+    if (validate_version(*elem_ptr_move)
+            || validate_resources(*elem_ptr_move)) {
         return -1;
     }
 
@@ -531,13 +586,12 @@ static int dm_discover(anjay_connection_ref_t connection,
     if (_anjay_uri_path_has(&request->uri, ANJAY_ID_RIID)) {
         return ANJAY_ERR_METHOD_NOT_ALLOWED;
     }
-    avs_stream_t *response_stream = _anjay_coap_setup_response_stream(
-            request->ctx,
-            &(anjay_msg_details_t) {
-                .msg_code = _anjay_dm_make_success_response_code(
-                        ANJAY_ACTION_DISCOVER),
-                .format = AVS_COAP_FORMAT_LINK_FORMAT
-            });
+    const anjay_msg_details_t details = {
+        .msg_code = _anjay_dm_make_success_response_code(ANJAY_ACTION_DISCOVER),
+        .format = AVS_COAP_FORMAT_LINK_FORMAT
+    };
+    avs_stream_t *response_stream =
+            _anjay_coap_setup_buffered_response(request->ctx, &details);
 
     if (!response_stream) {
         dm_log(ERROR, _("could not setup message"));
@@ -558,7 +612,8 @@ static int dm_discover(anjay_connection_ref_t connection,
         dm_log(WARNING, _("Discover ") "%s" _(" failed!"),
                ANJAY_DEBUG_MAKE_PATH(&request->uri));
     }
-    return result;
+    return _anjay_coap_finish_buffered_response(request->ctx, &details,
+                                                &response_stream, result);
 #else  // ANJAY_WITH_DISCOVER
     (void) connection;
     (void) obj;
@@ -733,6 +788,9 @@ static int invoke_action(anjay_connection_ref_t connection,
                 anjay, obj, request, _anjay_server_ssid(connection.server),
                 in_ctx);
     case ANJAY_ACTION_WRITE_ATTRIBUTES:
+#ifdef ANJAY_WITH_DISCOVER_CACHE
+        _anjay_discover_cache_invalidate(anjay, request->uri.ids[ANJAY_ID_OID]);
+#endif // ANJAY_WITH_DISCOVER_CACHE
         return _anjay_dm_write_attributes(
                 anjay, obj, request, _anjay_server_ssid(connection.server));
     case ANJAY_ACTION_EXECUTE:
@@ -745,8 +803,8 @@ static int invoke_action(anjay_connection_ref_t connection,
     }
 }
 
-int _anjay_dm_perform_action(anjay_connection_ref_t connection,
-                             const anjay_request_t *request) {
+static int perform_action(anjay_connection_ref_t connection,
+                          const anjay_request_t *request) {
     const anjay_dm_installed_object_t *obj = NULL;
 
     if (_anjay_uri_path_has(&request->uri, ANJAY_ID_OID)) {
@@ -811,6 +869,60 @@ int _anjay_dm_perform_action(anjay_connection_ref_t connection,
     return result ? result : destroy_result;
 }
 
+#ifdef ANJAY_WITH_INSTRUMENTATION
+static bool action_probe(anjay_request_action_t action,
+                         anjay_instr_probe_t *out_probe) {
+    switch (action) {
+    case ANJAY_ACTION_READ:
+        *out_probe = ANJAY_INSTR_PROBE_READ;
+        return true;
+#    ifdef ANJAY_WITH_LWM2M11
+    case ANJAY_ACTION_READ_COMPOSITE:
+        *out_probe = ANJAY_INSTR_PROBE_READ_COMPOSITE;
+        return true;
+    case ANJAY_ACTION_WRITE_COMPOSITE:
+        *out_probe = ANJAY_INSTR_PROBE_WRITE_COMPOSITE;
+        return true;
+#    endif // ANJAY_WITH_LWM2M11
+    case ANJAY_ACTION_DISCOVER:
+        *out_probe = ANJAY_INSTR_PROBE_DISCOVER;
+        return true;
+    case ANJAY_ACTION_WRITE:
+    case ANJAY_ACTION_WRITE_UPDATE:
+        *out_probe = ANJAY_INSTR_PROBE_WRITE;
+        return true;
+    case ANJAY_ACTION_WRITE_ATTRIBUTES:
+        *out_probe = ANJAY_INSTR_PROBE_WRITE_ATTRIBUTES;
+        return true;
+    case ANJAY_ACTION_EXECUTE:
+        *out_probe = ANJAY_INSTR_PROBE_EXECUTE;
+        return true;
+    case ANJAY_ACTION_CREATE:
+        *out_probe = ANJAY_INSTR_PROBE_CREATE;
+        return true;
+    case ANJAY_ACTION_DELETE:
+        *out_probe = ANJAY_INSTR_PROBE_DELETE;
+        return true;
+    default:
+        return false;
+    }
+}
+#endif // ANJAY_WITH_INSTRUMENTATION
+
+int _anjay_dm_perform_action(anjay_connection_ref_t connection,
+                             const anjay_request_t *request) {
+    ANJAY_INSTR_START(start);
+    int result = perform_action(connection, request);
+#ifdef ANJAY_WITH_INSTRUMENTATION
+    anjay_instr_probe_t probe;
+    if (action_probe(request->action, &probe)) {
+        _anjay_instr_record(_anjay_from_server(connection.server), probe,
+                            start);
+    }
+#endif // ANJAY_WITH_INSTRUMENTATION
+    return result;
+}
+
 int _anjay_dm_foreach_object(anjay_unlocked_t *anjay,
                              anjay_dm_t *dm,
                              anjay_dm_foreach_object_handler_t *handler,
@@ -989,10 +1101,6 @@ struct anjay_unlocked_dm_resource_list_ctx_struct {
     int result;
 };
 
-static bool presence_valid(anjay_dm_resource_presence_t presence) {
-    return presence == ANJAY_DM_RES_ABSENT || presence == ANJAY_DM_RES_PRESENT;
-}
-
 void _anjay_dm_emit_res_unlocked(anjay_unlocked_dm_resource_list_ctx_t *ctx,
                                  anjay_rid_t rid,
                                  anjay_dm_resource_kind_t kind,
@@ -1067,6 +1175,32 @@ int _anjay_dm_foreach_resource(anjay_unlocked_t *anjay,
         return -1;
     }
 
+    size_t resources_count;
+    const anjay_dm_resource_def_t *resources =
+            _anjay_dm_installed_object_resources(obj, &resources_count);
+    if (resources) {
+        // validated in _anjay_dm_register_object()
+        for (size_t i = 0; i < resources_count; ++i) {
+            int result = handler(anjay, obj, iid, resources[i].rid,
+                                 resources[i].kind, resources[i].presence,
+                                 data);
+            if (result == ANJAY_FOREACH_BREAK) {
+                dm_log(TRACE, _("foreach_resource: break on ") "/%u/%u/%u",
+                       _anjay_dm_installed_object_oid(obj), iid,
+                       resources[i].rid);
+                return 0;
+            } else if (result) {
+                dm_log(DEBUG,
+                       _("foreach_resource_handler failed for ") "/%u/%u/%u" _(
+                               " (") "%d" _(")"),
+                       _anjay_dm_installed_object_oid(obj), iid,
+                       resources[i].rid, result);
+                return result;
+            }
+        }
+        return 0;
+    }
+
     anjay_unlocked_dm_resource_list_ctx_t ctx = {
         .anjay = anjay,
         .obj = obj,
@@ -1114,6 +1248,25 @@ static int kind_and_presence_clb(anjay_unlocked_t *anjay,
     return ANJAY_FOREACH_CONTINUE;
 }
 
+static const anjay_dm_resource_def_t *
+find_resource_def(const anjay_dm_resource_def_t *resources,
+                  size_t count,
+                  anjay_rid_t rid) {
+    size_t begin = 0;
+    size_t end = count;
+    while (begin < end) {
+        size_t mid = begin + (end - begin) / 2;
+        if (resources[mid].rid < rid) {
+            begin = mid + 1;
+        } else if (resources[mid].rid > rid) {
+            end = mid;
+        } else {
+            return &resources[mid];
+        }
+    }
+    return NULL;
+}
+
 int _anjay_dm_resource_kind_and_presence(
         anjay_unlocked_t *anjay,
         const anjay_dm_installed_object_t *obj_ptr,
@@ -1121,6 +1274,24 @@ int _anjay_dm_resource_kind_and_presence(
         anjay_rid_t rid,
         anjay_dm_resource_kind_t *out_kind,
         anjay_dm_resource_presence_t *out_presence) {
+    size_t resources_count;
+    const anjay_dm_resource_def_t *resources =
+            _anjay_dm_installed_object_resources(obj_ptr, &resources_count);
+    if (resources) {
+        const anjay_dm_resource_def_t *res =
+                find_resource_def(resources, resources_count, rid);
+        if (!res) {
+            return ANJAY_ERR_NOT_FOUND;
+        }
+        if (out_kind) {
+            *out_kind = res->kind;
+        }
+        if (out_presence) {
+            *out_presence = res->presence;
+        }
+        return 0;
+    }
+
     resource_present_args_t args = {
         .rid_to_find = rid,
         .kind = (anjay_dm_resource_kind_t) -1,
@@ -0,0 +1,203 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <string.h>
+
+#include <anjay/instrumentation.h>
+
+#include "anjay_core.h"
+#include "anjay_instrumentation.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#define instr_log(...) _anjay_log(anjay_instr, __VA_ARGS__)
+
+#ifdef ANJAY_WITH_INSTRUMENTATION
+
+static size_t bucket_index(uint64_t us) {
+    size_t index = 0;
+    while (us && index < ANJAY_INSTR_HISTOGRAM_BUCKETS - 1) {
+        us >>= 1;
+        ++index;
+    }
+    return index;
+}
+
+static void histogram_add_duration(anjay_instr_histogram_t *histogram,
+                                   avs_time_duration_t duration) {
+    int64_t elapsed_us;
+    if (avs_time_duration_to_scalar(&elapsed_us, AVS_TIME_US, duration)
+            || elapsed_us < 0) {
+        return;
+    }
+    ++histogram->count;
+    histogram->total_us += (uint64_t) elapsed_us;
+    if ((uint64_t) elapsed_us > histogram->max_us) {
+        histogram->max_us = (uint64_t) elapsed_us;
+    }
+    ++histogram->buckets[bucket_index((uint64_t) elapsed_us)];
+}
+
+static void histogram_add(anjay_instr_histogram_t *histogram,
+                          avs_time_monotonic_t start) {
+    histogram_add_duration(histogram, avs_time_monotonic_diff(
+                                              avs_time_monotonic_now(), start));
+}
+
+void _anjay_instr_record(anjay_unlocked_t *anjay,
+                         anjay_instr_probe_t probe,
+                         avs_time_monotonic_t start) {
+    assert(probe >= 0 && probe < ANJAY_INSTR_PROBE_LIMIT_);
+    histogram_add(&anjay->instr.probes[probe], start);
+}
+
+void _anjay_instr_record_duration(anjay_unlocked_t *anjay,
+                                  anjay_instr_probe_t probe,
+                                  avs_time_duration_t duration) {
+    assert(probe >= 0 && probe < ANJAY_INSTR_PROBE_LIMIT_);
+    histogram_add_duration(&anjay->instr.probes[probe], duration);
+}
+
+static AVS_LIST(anjay_instr_object_entry_t) *
+find_object_entry_ptr(anjay_instr_t *instr, anjay_oid_t oid) {
+    AVS_LIST(anjay_instr_object_entry_t) *entry_ptr;
+    AVS_LIST_FOREACH_PTR(entry_ptr, &instr->objects) {
+        if ((*entry_ptr)->oid >= oid) {
+            break;
+        }
+    }
+    return entry_ptr;
+}
+
+void _anjay_instr_record_object(anjay_unlocked_t *anjay,
+                                anjay_oid_t oid,
+                                avs_time_monotonic_t start) {
+    AVS_LIST(anjay_instr_object_entry_t) *entry_ptr =
+            find_object_entry_ptr(&anjay->instr, oid);
+    if (!*entry_ptr || (*entry_ptr)->oid != oid) {
+        AVS_LIST(anjay_instr_object_entry_t) entry =
+                AVS_LIST_NEW_ELEMENT(anjay_instr_object_entry_t);
+        if (!entry) {
+            // measurements are best-effort, don't fail the actual operation
+            return;
+        }
+        entry->oid = oid;
+        AVS_LIST_INSERT(entry_ptr, entry);
+    }
+    histogram_add(&(*entry_ptr)->histogram, start);
+}
+
+void _anjay_instr_cleanup(anjay_instr_t *instr) {
+    AVS_LIST_CLEAR(&instr->objects);
+}
+
+int anjay_instr_get_histogram(anjay_t *anjay_locked,
+                              anjay_instr_probe_t probe,
+                              anjay_instr_histogram_t *out_histogram) {
+    assert(anjay_locked);
+    assert(out_histogram);
+    if (probe < 0 || probe >= ANJAY_INSTR_PROBE_LIMIT_) {
+        instr_log(ERROR, _("invalid probe: ") "%d", (int) probe);
+        return -1;
+    }
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    *out_histogram = anjay->instr.probes[probe];
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return 0;
+}
+
+int anjay_instr_get_object_histogram(anjay_t *anjay_locked,
+                                     anjay_oid_t oid,
+                                     anjay_instr_histogram_t *out_histogram) {
+    assert(anjay_locked);
+    assert(out_histogram);
+    memset(out_histogram, 0, sizeof(*out_histogram));
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_instr_object_entry_t) entry =
+            *find_object_entry_ptr(&anjay->instr, oid);
+    if (entry && entry->oid == oid) {
+        *out_histogram = entry->histogram;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return 0;
+}
+
+int anjay_instr_get_queue_depths(anjay_t *anjay_locked,
+                                 anjay_instr_queue_depths_t *out_depths) {
+    assert(anjay_locked);
+    assert(out_depths);
+    memset(out_depths, 0, sizeof(*out_depths));
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+#    ifdef ANJAY_WITH_OBSERVE
+    _anjay_observe_count_queued(anjay, &out_depths->unsent_notifications,
+                                &out_depths->pending_exchanges);
+#    endif // ANJAY_WITH_OBSERVE
+#    ifdef ANJAY_WITH_SEND
+    _anjay_send_count_queued(anjay, &out_depths->deferred_sends,
+                             &out_depths->pending_exchanges);
+#    endif // ANJAY_WITH_SEND
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return 0;
+}
+
+void anjay_instr_reset(anjay_t *anjay_locked) {
+    assert(anjay_locked);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    memset(anjay->instr.probes, 0, sizeof(anjay->instr.probes));
+    _anjay_instr_cleanup(&anjay->instr);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/core/instrumentation.c"
+#    endif // ANJAY_TEST
+
+#else // ANJAY_WITH_INSTRUMENTATION
+
+int anjay_instr_get_histogram(anjay_t *anjay,
+                              anjay_instr_probe_t probe,
+                              anjay_instr_histogram_t *out_histogram) {
+    (void) anjay;
+    (void) probe;
+    (void) out_histogram;
+    instr_log(ERROR,
+              _("instrumentation disabled. Anjay was compiled without "
+                "ANJAY_WITH_INSTRUMENTATION option."));
+    return -1;
+}
+
+int anjay_instr_get_object_histogram(anjay_t *anjay,
+                                     anjay_oid_t oid,
+                                     anjay_instr_histogram_t *out_histogram) {
+    (void) anjay;
+    (void) oid;
+    (void) out_histogram;
+    instr_log(ERROR,
+              _("instrumentation disabled. Anjay was compiled without "
+                "ANJAY_WITH_INSTRUMENTATION option."));
+    return -1;
+}
+
+int anjay_instr_get_queue_depths(anjay_t *anjay,
+                                 anjay_instr_queue_depths_t *out_depths) {
+    (void) anjay;
+    (void) out_depths;
+    instr_log(ERROR,
+              _("instrumentation disabled. Anjay was compiled without "
+                "ANJAY_WITH_INSTRUMENTATION option."));
+    return -1;
+}
+
+void anjay_instr_reset(anjay_t *anjay) {
+    (void) anjay;
+}
+
+#endif // ANJAY_WITH_INSTRUMENTATION
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_INSTRUMENTATION_H
+#define ANJAY_INSTRUMENTATION_H
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_list.h>
+#include <avsystem/commons/avs_time.h>
+
+#include <anjay/instrumentation.h>
+
+#include <anjay_modules/anjay_utils_core.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#ifdef ANJAY_WITH_INSTRUMENTATION
+
+typedef struct {
+    anjay_oid_t oid;
+    anjay_instr_histogram_t histogram;
+} anjay_instr_object_entry_t;
+
+typedef struct {
+    anjay_instr_histogram_t probes[ANJAY_INSTR_PROBE_LIMIT_];
+    /** Histograms of data model handler calls, sorted by OID */
+    AVS_LIST(anjay_instr_object_entry_t) objects;
+} anjay_instr_t;
+
+/**
+ * Declares a variable holding the start time of a measurement. It is a no-op
+ * if instrumentation is disabled, so the variable shall only be used as an
+ * argument to the _anjay_instr_record*() functions.
+ */
+#    define ANJAY_INSTR_START(Var) \
+        const avs_time_monotonic_t Var = avs_time_monotonic_now()
+
+void _anjay_instr_record(anjay_unlocked_t *anjay,
+                         anjay_instr_probe_t probe,
+                         avs_time_monotonic_t start);
+
+/**
+ * Records a measurement of @p duration, for operations split into multiple
+ * steps with unrelated work in between.
+ */
+void _anjay_instr_record_duration(anjay_unlocked_t *anjay,
+                                  anjay_instr_probe_t probe,
+                                  avs_time_duration_t duration);
+
+void _anjay_instr_record_object(anjay_unlocked_t *anjay,
+                                anjay_oid_t oid,
+                                avs_time_monotonic_t start);
+
+void _anjay_instr_cleanup(anjay_instr_t *instr);
+
+#else // ANJAY_WITH_INSTRUMENTATION
+
+#    define ANJAY_INSTR_START(Var) ((void) 0)
+#    define _anjay_instr_record(...) ((void) 0)
+#    define _anjay_instr_record_duration(...) ((void) 0)
+#    define _anjay_instr_record_object(...) ((void) 0)
+
+#endif // ANJAY_WITH_INSTRUMENTATION
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_INSTRUMENTATION_H */
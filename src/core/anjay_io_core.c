@@ -161,6 +161,49 @@ int anjay_ret_bytes(anjay_output_ctx_t *ctx, const void *data, size_t length) {
     return result;
 }
 
+int _anjay_ret_bytes_borrowed_unlocked(anjay_unlocked_output_ctx_t *ctx,
+                                       const void *data,
+                                       size_t length,
+                                       anjay_ret_bytes_release_t *release,
+                                       void *release_arg) {
+    if (!ctx->vtable->bytes_borrowed) {
+        // contexts that serialize the value immediately don't need to keep
+        // the buffer, so it can be released right away
+        int result = _anjay_ret_bytes_unlocked(ctx, data, length);
+        if (release) {
+            release(release_arg);
+        }
+        return result;
+    }
+    int result = ctx->vtable->bytes_borrowed(ctx, data, length, release,
+                                             release_arg);
+    _anjay_update_ret(&ctx->error, result);
+    return result;
+}
+
+int anjay_ret_bytes_borrowed(anjay_output_ctx_t *ctx,
+                             const void *data,
+                             size_t length,
+                             anjay_ret_bytes_release_t *release,
+                             void *release_arg) {
+    int result = -1;
+#ifdef ANJAY_WITH_THREAD_SAFETY
+    bool buffer_passed = false;
+    ANJAY_MUTEX_LOCK(anjay, ctx->anjay_locked);
+    buffer_passed = true;
+#endif // ANJAY_WITH_THREAD_SAFETY
+    result = _anjay_ret_bytes_borrowed_unlocked(
+            _anjay_output_get_unlocked(ctx), data, length, release,
+            release_arg);
+#ifdef ANJAY_WITH_THREAD_SAFETY
+    ANJAY_MUTEX_UNLOCK(ctx->anjay_locked);
+    if (!buffer_passed && release) {
+        release(release_arg);
+    }
+#endif // ANJAY_WITH_THREAD_SAFETY
+    return result;
+}
+
 int _anjay_ret_string_unlocked(anjay_unlocked_output_ctx_t *ctx,
                                const char *value) {
     int result = ANJAY_OUTCTXERR_METHOD_NOT_IMPLEMENTED;
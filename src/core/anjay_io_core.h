@@ -52,6 +52,10 @@ uint16_t _anjay_translate_legacy_content_format(uint16_t format);
 /* returned from _anjay_output_ctx_destroy if no anjay_ret_* function was
  * called, making it impossible to determine actual resource format */
 #define ANJAY_OUTCTXERR_ANJAY_RET_NOT_CALLED (-0xCE2)
+/* returned by a TLV output context with precomputed lengths if the data
+ * differs from what has been measured, see
+ * @ref _anjay_output_tlv_precompute_lengths */
+#define ANJAY_OUTCTXERR_TLV_LENGTH_MISMATCH (-0xCE3)
 
 /** A value returned from @ref anjay_input_ctx_get_path_t to indicate end of the
  * path listing. */
@@ -189,6 +193,27 @@ anjay_unlocked_output_ctx_t *_anjay_output_cbor_create(avs_stream_t *stream);
 #ifndef ANJAY_WITHOUT_TLV
 anjay_unlocked_output_ctx_t *
 _anjay_output_tlv_create(avs_stream_t *stream, const anjay_uri_path_t *uri);
+
+/**
+ * Switches a freshly created TLV output context into a mode in which nested
+ * entities (Object Instances and Multiple Resources) are written directly to
+ * the underlying stream, instead of being buffered in memory until complete.
+ *
+ * To do so, @p feed is called on @p ctx in a dry run that does not write
+ * anything, but records the lengths of all nested entities. The caller is then
+ * expected to perform exactly the same sequence of calls on @p ctx again - any
+ * difference is reported as @ref ANJAY_OUTCTXERR_TLV_LENGTH_MISMATCH, both by
+ * the call during which it is detected (and thus in the sticky error of
+ * @p ctx ) and by @ref _anjay_output_ctx_destroy .
+ *
+ * If @p ctx is not a TLV output context, this function does nothing.
+ *
+ * @returns 0 on success, or the error returned by @p feed .
+ */
+int _anjay_output_tlv_precompute_lengths(
+        anjay_unlocked_output_ctx_t *ctx,
+        int (*feed)(anjay_unlocked_output_ctx_t *ctx, void *arg),
+        void *arg);
 #endif // ANJAY_WITHOUT_TLV
 
 #if defined(ANJAY_WITH_LWM2M_JSON) || defined(ANJAY_WITH_SENML_JSON) \
@@ -12,10 +12,15 @@
 #ifdef ANJAY_WITH_LWM2M11
 
 #    include <inttypes.h>
+#    include <string.h>
 
 #    include <avsystem/commons/avs_stream_membuf.h>
 #    include <avsystem/commons/avs_utils.h>
 
+#    ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
+#        include <avsystem/commons/avs_persistence.h>
+#    endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
+
 #    include <avsystem/coap/async_client.h>
 #    include <avsystem/coap/code.h>
 
@@ -77,6 +82,8 @@ typedef struct {
     anjay_unlocked_output_ctx_t *out_ctx;
     size_t expected_offset;
     avs_time_real_t serialization_time;
+    /** Entry which payload_batch is currently being serialized */
+    const anjay_send_entry_t *output_source;
     const anjay_batch_data_output_state_t *output_state;
 } exchange_status_t;
 
@@ -88,16 +95,25 @@ struct anjay_send_entry {
     bool deferrable;
     anjay_batch_t *payload_batch;
     exchange_status_t exchange_status;
+    /**
+     * Other Send requests to the same server, merged into this one; their
+     * payloads are sent after payload_batch, within the same exchange.
+     */
+    AVS_LIST(anjay_send_entry_t) coalesced;
 };
 
 static void clear_exchange_status(exchange_status_t *status) {
     assert(!avs_coap_exchange_id_valid(status->id));
     _anjay_output_ctx_destroy(&status->out_ctx);
     avs_stream_cleanup(&status->memstream);
+    status->output_source = NULL;
     status->output_state = NULL;
 }
 
 static void delete_send_entry(AVS_LIST(anjay_send_entry_t) *entry) {
+    AVS_LIST_CLEAR(&(*entry)->coalesced) {
+        _anjay_batch_release(&(*entry)->coalesced->payload_batch);
+    }
     _anjay_batch_release(&(*entry)->payload_batch);
     clear_exchange_status(&(*entry)->exchange_status);
     AVS_LIST_DELETE(entry);
@@ -121,6 +137,12 @@ static avs_error_t setup_send_options(avs_coap_options_t *options,
     return err;
 }
 
+static const anjay_send_entry_t *
+next_output_source(const anjay_send_entry_t *entry,
+                   const anjay_send_entry_t *source) {
+    return source == entry ? entry->coalesced : AVS_LIST_NEXT(source);
+}
+
 static int request_payload_writer(size_t payload_offset,
                                   void *payload_buf,
                                   size_t payload_buf_size,
@@ -154,11 +176,14 @@ static int request_payload_writer(size_t payload_offset,
             break;
         }
         int result = _anjay_batch_data_output_entry(
-                entry->anjay, entry->payload_batch, entry->target_ssid,
-                entry->exchange_status.serialization_time,
+                entry->anjay,
+                entry->exchange_status.output_source->payload_batch,
+                entry->target_ssid, entry->exchange_status.serialization_time,
                 &entry->exchange_status.output_state,
                 entry->exchange_status.out_ctx);
-        if (!result && !entry->exchange_status.output_state) {
+        if (!result && !entry->exchange_status.output_state
+                && !(entry->exchange_status.output_source = next_output_source(
+                             entry, entry->exchange_status.output_source))) {
             result = _anjay_output_ctx_destroy_and_process_result(
                     &entry->exchange_status.out_ctx, result);
         }
@@ -189,6 +214,27 @@ static void call_finished_handler(anjay_send_entry_t *entry, int result) {
     ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
 }
 
+static bool has_finished_handlers(const anjay_send_entry_t *entry) {
+    if (entry->finished_handler) {
+        return true;
+    }
+    AVS_LIST(const anjay_send_entry_t) it;
+    AVS_LIST_FOREACH(it, entry->coalesced) {
+        if (it->finished_handler) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void call_finished_handlers(anjay_send_entry_t *entry, int result) {
+    call_finished_handler(entry, result);
+    AVS_LIST(anjay_send_entry_t) it;
+    AVS_LIST_FOREACH(it, entry->coalesced) {
+        call_finished_handler(it, result);
+    }
+}
+
 static void response_handler(avs_coap_ctx_t *ctx,
                              avs_coap_exchange_id_t exchange_id,
                              avs_coap_client_request_state_t state,
@@ -208,7 +254,7 @@ static void response_handler(avs_coap_ctx_t *ctx,
             });
         }
     }
-    if (entry->finished_handler) {
+    if (has_finished_handlers(entry)) {
         static const int STATE_TO_RESULT[] = {
             [AVS_COAP_CLIENT_REQUEST_OK] = ANJAY_SEND_SUCCESS,
             [AVS_COAP_CLIENT_REQUEST_PARTIAL_CONTENT] = ANJAY_SEND_SUCCESS,
@@ -225,7 +271,7 @@ static void response_handler(avs_coap_ctx_t *ctx,
                          _("Unexpected payload received in response to Send"));
             }
         }
-        call_finished_handler(entry, result);
+        call_finished_handlers(entry, result);
     }
     if (state == AVS_COAP_CLIENT_REQUEST_PARTIAL_CONTENT) {
         // We don't want/need to read the rest of the content, so we cancel the
@@ -243,6 +289,12 @@ static void response_handler(avs_coap_ctx_t *ctx,
     }
 }
 
+static bool coalescing_enabled(const anjay_sender_t *sender) {
+    return avs_time_duration_valid(sender->coalescing_delay)
+           && avs_time_duration_less(AVS_TIME_DURATION_ZERO,
+                                     sender->coalescing_delay);
+}
+
 static AVS_LIST(anjay_send_entry_t) *
 create_exchange(anjay_unlocked_t *anjay,
                 anjay_ssid_t target_ssid,
@@ -269,8 +321,14 @@ create_exchange(anjay_unlocked_t *anjay,
     entry->deferrable = deferrable;
     entry->payload_batch = payload_batch;
 
+    // with coalescing enabled, requests to the same server are kept in the
+    // order they were made, so that they are coalesced in that order, too;
+    // otherwise, the newest request is inserted before the older ones
+    const bool keep_order = coalescing_enabled(&anjay->sender);
     AVS_LIST(anjay_send_entry_t) *insert_ptr = &anjay->sender.entries;
-    while (*insert_ptr && (*insert_ptr)->target_ssid < target_ssid) {
+    while (*insert_ptr
+           && ((*insert_ptr)->target_ssid < target_ssid
+               || (keep_order && (*insert_ptr)->target_ssid == target_ssid))) {
         AVS_LIST_ADVANCE_PTR(&insert_ptr);
     }
     AVS_LIST_INSERT(insert_ptr, entry);
@@ -325,8 +383,22 @@ static avs_error_t start_send_exchange(anjay_send_entry_t *entry,
     };
 
     anjay_uri_path_t base_path = MAKE_ROOT_PATH();
-    _anjay_batch_update_common_path_prefix(&(const anjay_uri_path_t *) { NULL },
-                                           &base_path, entry->payload_batch);
+    const anjay_uri_path_t *base_path_ptr = NULL;
+    bool item_count_known = true;
+    size_t item_count = 0;
+    for (const anjay_send_entry_t *source = entry; source;
+         source = next_output_source(entry, source)) {
+        _anjay_batch_update_common_path_prefix(&base_path_ptr, &base_path,
+                                               source->payload_batch);
+        size_t source_item_count = 0;
+        if (_anjay_batch_outputable_item_count(entry->anjay,
+                                               source->payload_batch,
+                                               entry->target_ssid,
+                                               &source_item_count)) {
+            item_count_known = false;
+        }
+        item_count += source_item_count;
+    }
 
     avs_error_t err;
     if (avs_is_err((err = avs_coap_options_dynamic_init(&request.options)))
@@ -336,24 +408,21 @@ static avs_error_t start_send_exchange(anjay_send_entry_t *entry,
         goto finish;
     }
 
-    size_t item_count;
     if (!(entry->exchange_status.memstream = avs_stream_membuf_create())
             || (_anjay_output_dynamic_send_construct(
                        &entry->exchange_status.out_ctx,
                        entry->exchange_status.memstream, &base_path,
                        content_format,
-                       _anjay_batch_outputable_item_count(
-                               entry->anjay, entry->payload_batch,
-                               entry->target_ssid, &item_count)
-                               ? NULL
-                               : &item_count))) {
+                       item_count_known ? &item_count : NULL))) {
         send_log(ERROR, _("could not create output context"));
         err = avs_errno(AVS_ENOMEM);
         goto finish;
     }
     entry->exchange_status.expected_offset = 0;
     entry->exchange_status.serialization_time = avs_time_real_now();
+    entry->exchange_status.output_source = entry;
 
+    _anjay_query_snapshot_mark_dirty(_anjay_from_server(connection.server));
     err = avs_coap_client_send_async_request(coap, &entry->exchange_status.id,
                                              &request, request_payload_writer,
                                              entry, response_handler, entry);
@@ -430,6 +499,8 @@ check_send_possibility(anjay_unlocked_t *anjay,
     return ANJAY_SEND_OK;
 }
 
+static void retry_deferred_job(avs_sched_t *sched, const void *ssid_);
+
 static anjay_send_result_t
 send_impl(anjay_unlocked_t *anjay,
           anjay_ssid_t ssid,
@@ -455,7 +526,23 @@ send_impl(anjay_unlocked_t *anjay,
 
     if (!should_defer) {
         assert(ref.server);
-        if (avs_is_err(start_send_exchange(*entry_ptr, ref))) {
+        if (coalescing_enabled(&anjay->sender)) {
+            // the entry stays in the list as if it was deferred, and will be
+            // started, possibly along with others, by retry_deferred_job
+            if (!anjay->sender.coalescing_job
+                    && AVS_SCHED_DELAYED(anjay->sched,
+                                         &anjay->sender.coalescing_job,
+                                         anjay->sender.coalescing_delay,
+                                         retry_deferred_job,
+                                         &(const anjay_ssid_t) {
+                                             ANJAY_SSID_ANY
+                                         },
+                                         sizeof(anjay_ssid_t))) {
+                send_log(ERROR, _("could not schedule coalesced Send"));
+                delete_send_entry(entry_ptr);
+                return ANJAY_SEND_ERR_INTERNAL;
+            }
+        } else if (avs_is_err(start_send_exchange(*entry_ptr, ref))) {
             delete_send_entry(entry_ptr);
             return ANJAY_SEND_ERR_INTERNAL;
         }
@@ -659,6 +746,20 @@ int anjay_send_batch_data_add_current(anjay_send_batch_builder_t *builder,
     return result;
 }
 
+anjay_send_batch_builder_mark_t
+_anjay_send_batch_builder_mark(anjay_send_batch_builder_t *builder) {
+    assert(builder);
+    return cast_to_builder(builder)->append_ptr;
+}
+
+void _anjay_send_batch_builder_rollback(anjay_send_batch_builder_t *builder,
+                                        anjay_send_batch_builder_mark_t mark) {
+    assert(builder);
+    anjay_batch_builder_t *batch_builder = cast_to_builder(builder);
+    batch_builder->append_ptr = (AVS_LIST(anjay_batch_entry_t) *) mark;
+    _anjay_batch_entry_list_cleanup(batch_builder->append_ptr);
+}
+
 int _anjay_send_batch_data_add_current_multiple_unlocked(
         anjay_send_batch_builder_t *builder,
         anjay_unlocked_t *anjay,
@@ -668,8 +769,8 @@ int _anjay_send_batch_data_add_current_multiple_unlocked(
     assert(builder);
     assert(anjay);
 
-    anjay_batch_builder_t *batch_builder = cast_to_builder(builder);
-    AVS_LIST(anjay_batch_entry_t) *append_ptr = batch_builder->append_ptr;
+    anjay_send_batch_builder_mark_t mark =
+            _anjay_send_batch_builder_mark(builder);
     avs_time_real_t timestamp = avs_time_real_now();
 
     for (size_t i = 0; i < paths_length; i++) {
@@ -681,8 +782,7 @@ int _anjay_send_batch_data_add_current_multiple_unlocked(
                      _("resource ") "/%u/%u/%u" _(" not found, ignoring"),
                      paths[i].oid, paths[i].iid, paths[i].rid);
         } else if (result) {
-            batch_builder->append_ptr = append_ptr;
-            _anjay_batch_entry_list_cleanup(batch_builder->append_ptr);
+            _anjay_send_batch_builder_rollback(builder, mark);
             return result;
         }
     }
@@ -737,7 +837,7 @@ void anjay_send_batch_release(anjay_send_batch_t **batch_ptr) {
 
 static void cancel_send_entry(AVS_LIST(anjay_send_entry_t) *entry_ptr,
                               int result) {
-    call_finished_handler(*entry_ptr, result);
+    call_finished_handlers(*entry_ptr, result);
     delete_send_entry(entry_ptr);
 }
 
@@ -787,11 +887,63 @@ void _anjay_send_interrupt(anjay_connection_ref_t ref) {
 }
 
 void _anjay_send_cleanup(anjay_sender_t *sender) {
+    avs_sched_del(&sender->coalescing_job);
     while (sender->entries) {
         cancel_send_entry(&sender->entries, ANJAY_SEND_ABORT);
     }
 }
 
+static size_t entry_record_count(anjay_unlocked_t *anjay,
+                                 const anjay_send_entry_t *entry) {
+    size_t count;
+    if (_anjay_batch_outputable_item_count(anjay, entry->payload_batch,
+                                           entry->target_ssid, &count)) {
+        return SIZE_MAX;
+    }
+    return count;
+}
+
+static size_t add_saturated(size_t a, size_t b) {
+    return a > SIZE_MAX - b ? SIZE_MAX : a + b;
+}
+
+/**
+ * Moves deferred entries directly following @p entry that target the same
+ * server into its list of coalesced entries, as long as the combined payload
+ * does not exceed the configured number of records.
+ */
+static void coalesce_following_entries(anjay_unlocked_t *anjay,
+                                       AVS_LIST(anjay_send_entry_t) entry) {
+    const size_t max_records = anjay->sender.coalescing_max_records;
+    size_t records = 0;
+    if (max_records) {
+        records = entry_record_count(anjay, entry);
+        AVS_LIST(anjay_send_entry_t) it;
+        AVS_LIST_FOREACH(it, entry->coalesced) {
+            records = add_saturated(records, entry_record_count(anjay, it));
+        }
+    }
+
+    AVS_LIST(anjay_send_entry_t) *append_ptr = &entry->coalesced;
+    while (*append_ptr) {
+        AVS_LIST_ADVANCE_PTR(&append_ptr);
+    }
+    AVS_LIST(anjay_send_entry_t) *next_ptr = AVS_LIST_NEXT_PTR(entry);
+    while (*next_ptr && (*next_ptr)->target_ssid == entry->target_ssid
+           && !(*next_ptr)->exchange_status.memstream) {
+        if (max_records) {
+            size_t new_records = add_saturated(
+                    records, entry_record_count(anjay, *next_ptr));
+            if (new_records > max_records) {
+                break;
+            }
+            records = new_records;
+        }
+        AVS_LIST_INSERT(append_ptr, AVS_LIST_DETACH(next_ptr));
+        AVS_LIST_ADVANCE_PTR(&append_ptr);
+    }
+}
+
 static void retry_deferred_job(avs_sched_t *sched, const void *ssid_) {
     anjay_t *anjay_locked = _anjay_get_from_sched(sched);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
@@ -803,16 +955,20 @@ static void retry_deferred_job(avs_sched_t *sched, const void *ssid_) {
         .server = NULL
     };
 
-    AVS_LIST(anjay_send_entry_t) *entry_ptr;
-    AVS_LIST(anjay_send_entry_t) helper;
-    AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, helper, &anjay->sender.entries) {
+    // NOTE: AVS_LIST_DELETABLE_FOREACH_PTR is not used, because
+    // coalesce_following_entries() may detach elements following the current
+    // one
+    AVS_LIST(anjay_send_entry_t) *entry_ptr = &anjay->sender.entries;
+    while (*entry_ptr) {
         if ((*entry_ptr)->exchange_status.memstream) {
             // Entry is not deferred
+            AVS_LIST_ADVANCE_PTR(&entry_ptr);
             continue;
         }
 
         if (ssid_or_any != ANJAY_SSID_ANY) {
             if ((*entry_ptr)->target_ssid < ssid_or_any) {
+                AVS_LIST_ADVANCE_PTR(&entry_ptr);
                 continue;
             } else if ((*entry_ptr)->target_ssid > ssid_or_any) {
                 break;
@@ -826,6 +982,11 @@ static void retry_deferred_job(avs_sched_t *sched, const void *ssid_) {
                                                     &connection);
         }
 
+        if (send_condition == ANJAY_SEND_OK
+                && coalescing_enabled(&anjay->sender)) {
+            coalesce_following_entries(anjay, *entry_ptr);
+        }
+
         if ((send_condition != ANJAY_SEND_OK
              && (!(*entry_ptr)->deferrable
                  || !is_deferrable_condition(send_condition)))
@@ -833,6 +994,8 @@ static void retry_deferred_job(avs_sched_t *sched, const void *ssid_) {
                     && avs_is_err(
                                start_send_exchange(*entry_ptr, connection)))) {
             cancel_send_entry(entry_ptr, ANJAY_SEND_DEFERRED_ERROR);
+        } else {
+            AVS_LIST_ADVANCE_PTR(&entry_ptr);
         }
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
@@ -856,6 +1019,22 @@ bool _anjay_send_has_deferred(anjay_unlocked_t *anjay, anjay_ssid_t ssid) {
 }
 #        endif // ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
 
+#        ifdef ANJAY_WITH_INSTRUMENTATION
+void _anjay_send_count_queued(anjay_unlocked_t *anjay,
+                              size_t *out_deferred,
+                              size_t *inout_in_progress) {
+    AVS_LIST(anjay_send_entry_t) it;
+    AVS_LIST_FOREACH(it, anjay->sender.entries) {
+        const size_t count = 1 + AVS_LIST_SIZE(it->coalesced);
+        if (it->exchange_status.memstream) {
+            *inout_in_progress += count;
+        } else {
+            *out_deferred += count;
+        }
+    }
+}
+#        endif // ANJAY_WITH_INSTRUMENTATION
+
 int _anjay_send_sched_retry_deferred(anjay_unlocked_t *anjay,
                                      anjay_ssid_t ssid) {
     int result = AVS_SCHED_NOW(anjay->sched, NULL, retry_deferred_job, &ssid,
@@ -869,6 +1048,300 @@ int _anjay_send_sched_retry_deferred(anjay_unlocked_t *anjay,
     return result;
 }
 
+#        ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
+
+/**
+ * NOTE: Magic header is followed by one byte which is supposed to be a version
+ * number, and then by the number of stored requests.
+ *
+ * Known versions are:
+ * - 0: initial version
+ */
+static const char *SEND_QUEUE_MAGIC = "ASQ";
+
+typedef enum {
+    SEND_QUEUE_PERSISTENCE_VERSION_0,
+    SEND_QUEUE_PERSISTENCE_VERSION_CURRENT = SEND_QUEUE_PERSISTENCE_VERSION_0
+} send_queue_persistence_version_t;
+
+static const uint8_t SEND_QUEUE_SUPPORTED_VERSIONS[] = {
+    SEND_QUEUE_PERSISTENCE_VERSION_0
+};
+
+typedef struct {
+    avs_time_real_t compilation_time;
+    size_t size;
+    void *data;
+} serialized_send_entry_t;
+
+static avs_error_t persistence_send_entry(avs_persistence_context_t *ctx,
+                                          anjay_ssid_t *ssid,
+                                          anjay_batch_t **batch) {
+    avs_error_t err;
+    (void) (avs_is_err((err = avs_persistence_u16(ctx, ssid)))
+            || avs_is_err((err = _anjay_batch_persistence(ctx, batch))));
+    if (avs_is_ok(err)
+            && (*ssid == ANJAY_SSID_ANY || *ssid == ANJAY_SSID_BOOTSTRAP)) {
+        err = avs_errno(AVS_EBADMSG);
+    }
+    return err;
+}
+
+static void
+serialized_send_entries_clear(AVS_LIST(serialized_send_entry_t) *list) {
+    AVS_LIST_CLEAR(list) {
+        avs_free((*list)->data);
+    }
+}
+
+static avs_error_t
+serialize_send_entry(const anjay_send_entry_t *entry,
+                     AVS_LIST(serialized_send_entry_t) **tail_ptr) {
+    AVS_LIST(serialized_send_entry_t) serialized =
+            AVS_LIST_NEW_ELEMENT(serialized_send_entry_t);
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    if (!serialized || !membuf) {
+        _anjay_log_oom();
+        AVS_LIST_DELETE(&serialized);
+        avs_stream_cleanup(&membuf);
+        return avs_errno(AVS_ENOMEM);
+    }
+    avs_persistence_context_t ctx =
+            avs_persistence_store_context_create(membuf);
+    anjay_ssid_t ssid = entry->target_ssid;
+    anjay_batch_t *batch = entry->payload_batch;
+    avs_error_t err;
+    if (avs_is_err((err = persistence_send_entry(&ctx, &ssid, &batch)))
+            || avs_is_err((err = avs_stream_membuf_take_ownership(
+                                   membuf, &serialized->data,
+                                   &serialized->size)))) {
+        AVS_LIST_DELETE(&serialized);
+    } else {
+        serialized->compilation_time =
+                _anjay_batch_get_compilation_time(entry->payload_batch);
+        AVS_LIST_INSERT(*tail_ptr, serialized);
+        AVS_LIST_ADVANCE_PTR(tail_ptr);
+    }
+    avs_stream_cleanup(&membuf);
+    return err;
+}
+
+static avs_error_t
+serialize_send_queue(anjay_unlocked_t *anjay,
+                     AVS_LIST(serialized_send_entry_t) *out) {
+    AVS_LIST(serialized_send_entry_t) *tail = out;
+    avs_error_t err = AVS_OK;
+    AVS_LIST(anjay_send_entry_t) entry;
+    AVS_LIST_FOREACH(entry, anjay->sender.entries) {
+        const anjay_send_entry_t *source = entry;
+        while (avs_is_ok(err) && source) {
+            if (source->deferrable) {
+                err = serialize_send_entry(source, &tail);
+            }
+            source = next_output_source(entry, source);
+        }
+        if (avs_is_err(err)) {
+            serialized_send_entries_clear(out);
+            break;
+        }
+    }
+    return err;
+}
+
+static void evict_oldest_send_entries(AVS_LIST(serialized_send_entry_t) *list,
+                                      size_t max_size) {
+    size_t total_size = 0;
+    AVS_LIST(serialized_send_entry_t) it;
+    AVS_LIST_FOREACH(it, *list) {
+        total_size += it->size;
+    }
+    size_t evicted = 0;
+    while (total_size > max_size) {
+        AVS_LIST(serialized_send_entry_t) *oldest_ptr = list;
+        AVS_LIST(serialized_send_entry_t) *it_ptr;
+        AVS_LIST_FOREACH_PTR(it_ptr, list) {
+            if (avs_time_real_before((*it_ptr)->compilation_time,
+                                     (*oldest_ptr)->compilation_time)) {
+                oldest_ptr = it_ptr;
+            }
+        }
+        total_size -= (*oldest_ptr)->size;
+        avs_free((*oldest_ptr)->data);
+        AVS_LIST_DELETE(oldest_ptr);
+        ++evicted;
+    }
+    if (evicted) {
+        send_log(WARNING,
+                 "%lu" _(" oldest Send requests do not fit in the persisted "
+                         "queue and were omitted"),
+                 (unsigned long) evicted);
+    }
+}
+
+static avs_error_t persist_send_queue(anjay_unlocked_t *anjay,
+                                      avs_stream_t *out_stream,
+                                      size_t max_size) {
+    const size_t header_size =
+            strlen(SEND_QUEUE_MAGIC) + sizeof(uint8_t) + sizeof(uint32_t);
+    if (max_size && max_size < header_size) {
+        send_log(ERROR, _("Send queue size limit too small"));
+        return avs_errno(AVS_EINVAL);
+    }
+
+    AVS_LIST(serialized_send_entry_t) serialized = NULL;
+    avs_error_t err = serialize_send_queue(anjay, &serialized);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    if (max_size) {
+        evict_oldest_send_entries(&serialized, max_size - header_size);
+    }
+    if (AVS_LIST_SIZE(serialized) > UINT32_MAX) {
+        serialized_send_entries_clear(&serialized);
+        return avs_errno(AVS_E2BIG);
+    }
+
+    avs_persistence_context_t ctx =
+            avs_persistence_store_context_create(out_stream);
+    uint8_t version = SEND_QUEUE_PERSISTENCE_VERSION_CURRENT;
+    uint32_t count = (uint32_t) AVS_LIST_SIZE(serialized);
+    (void) (avs_is_err((err = avs_persistence_magic_string(&ctx,
+                                                           SEND_QUEUE_MAGIC)))
+            || avs_is_err((err = avs_persistence_version(
+                                   &ctx, &version,
+                                   SEND_QUEUE_SUPPORTED_VERSIONS,
+                                   sizeof(SEND_QUEUE_SUPPORTED_VERSIONS))))
+            || avs_is_err((err = avs_persistence_u32(&ctx, &count))));
+    AVS_LIST(serialized_send_entry_t) it;
+    AVS_LIST_FOREACH(it, serialized) {
+        if (avs_is_err(err)) {
+            break;
+        }
+        err = avs_persistence_bytes(&ctx, it->data, it->size);
+    }
+    if (avs_is_ok(err)) {
+        send_log(INFO, "%" PRIu32 _(" Send requests persisted"), count);
+    }
+    serialized_send_entries_clear(&serialized);
+    return err;
+}
+
+static avs_error_t
+restore_send_queue(anjay_unlocked_t *anjay,
+                   avs_stream_t *in_stream,
+                   AVS_LIST(anjay_send_entry_t) *out_entries) {
+    avs_persistence_context_t ctx =
+            avs_persistence_restore_context_create(in_stream);
+    uint8_t version = 0;
+    uint32_t count = 0;
+    avs_error_t err;
+    if (avs_is_err((err = avs_persistence_magic_string(&ctx,
+                                                       SEND_QUEUE_MAGIC)))
+            || avs_is_err((err = avs_persistence_version(
+                                   &ctx, &version,
+                                   SEND_QUEUE_SUPPORTED_VERSIONS,
+                                   sizeof(SEND_QUEUE_SUPPORTED_VERSIONS))))
+            || avs_is_err((err = avs_persistence_u32(&ctx, &count)))) {
+        return err;
+    }
+
+    AVS_LIST(anjay_send_entry_t) *tail = out_entries;
+    anjay_ssid_t last_ssid = 0;
+    for (uint32_t i = 0; avs_is_ok(err) && i < count; ++i) {
+        anjay_ssid_t ssid = ANJAY_SSID_ANY;
+        anjay_batch_t *batch = NULL;
+        if (avs_is_err((err = persistence_send_entry(&ctx, &ssid, &batch)))) {
+            break;
+        }
+        // entries are stored in queue order, i.e. sorted by SSID
+        if (ssid < last_ssid) {
+            err = avs_errno(AVS_EBADMSG);
+        } else if (!(*tail = AVS_LIST_NEW_ELEMENT(anjay_send_entry_t))) {
+            _anjay_log_oom();
+            err = avs_errno(AVS_ENOMEM);
+        }
+        if (avs_is_err(err)) {
+            _anjay_batch_release(&batch);
+            break;
+        }
+        (*tail)->anjay = anjay;
+        (*tail)->target_ssid = ssid;
+        (*tail)->deferrable = true;
+        (*tail)->payload_batch = batch;
+        AVS_LIST_ADVANCE_PTR(&tail);
+        last_ssid = ssid;
+    }
+    if (avs_is_err(err)) {
+        while (*out_entries) {
+            delete_send_entry(out_entries);
+        }
+    }
+    return err;
+}
+
+avs_error_t anjay_send_queue_persist(anjay_t *anjay_locked,
+                                     avs_stream_t *out_stream,
+                                     size_t max_size) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    err = persist_send_queue(anjay, out_stream, max_size);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+avs_error_t anjay_send_queue_restore(anjay_t *anjay_locked,
+                                     avs_stream_t *in_stream) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_send_entry_t) restored = NULL;
+    if (avs_is_err((err = restore_send_queue(anjay, in_stream, &restored)))) {
+        send_log(WARNING, _("could not restore Send queue"));
+    } else {
+        const size_t count = AVS_LIST_SIZE(restored);
+        // restored requests were made before any of the queued ones, so they
+        // are inserted before those targeting the same server
+        AVS_LIST(anjay_send_entry_t) *insert_ptr = &anjay->sender.entries;
+        while (restored) {
+            while (*insert_ptr
+                   && (*insert_ptr)->target_ssid < restored->target_ssid) {
+                AVS_LIST_ADVANCE_PTR(&insert_ptr);
+            }
+            AVS_LIST_INSERT(insert_ptr, AVS_LIST_DETACH(&restored));
+            AVS_LIST_ADVANCE_PTR(&insert_ptr);
+        }
+        if (count) {
+            _anjay_send_sched_retry_deferred(anjay, ANJAY_SSID_ANY);
+        }
+        send_log(INFO, "%lu" _(" Send requests restored"),
+                 (unsigned long) count);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+#        else // AVS_COMMONS_WITH_AVS_PERSISTENCE
+
+avs_error_t anjay_send_queue_persist(anjay_t *anjay,
+                                     avs_stream_t *out_stream,
+                                     size_t max_size) {
+    (void) anjay;
+    (void) out_stream;
+    (void) max_size;
+    send_log(ERROR, _("Persistence not compiled in"));
+    return avs_errno(AVS_ENOTSUP);
+}
+
+avs_error_t anjay_send_queue_restore(anjay_t *anjay, avs_stream_t *in_stream) {
+    (void) anjay;
+    (void) in_stream;
+    send_log(ERROR, _("Persistence not compiled in"));
+    return avs_errno(AVS_ENOTSUP);
+}
+
+#        endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
+
 #    endif // ANJAY_WITH_SEND
 
 #endif // ANJAY_WITH_LWM2M11
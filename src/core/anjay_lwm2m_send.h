@@ -11,6 +11,8 @@
 #define ANJAY_LWM2M_SEND_H
 
 #include <avsystem/commons/avs_list.h>
+#include <avsystem/commons/avs_sched.h>
+#include <avsystem/commons/avs_time.h>
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
@@ -18,6 +20,14 @@ typedef struct anjay_send_entry anjay_send_entry_t;
 
 typedef struct {
     AVS_LIST(anjay_send_entry_t) entries;
+    /**
+     * Time for which Send requests are held so that they can be merged; see
+     * <c>send_coalescing_delay</c> in @ref anjay_configuration_t. Coalescing
+     * is disabled if zero.
+     */
+    avs_time_duration_t coalescing_delay;
+    size_t coalescing_max_records;
+    avs_sched_handle_t coalescing_job;
 } anjay_sender_t;
 
 bool _anjay_send_in_progress(anjay_connection_ref_t ref);
@@ -33,6 +43,16 @@ bool _anjay_send_has_deferred(anjay_unlocked_t *anjay, anjay_ssid_t ssid);
 int _anjay_send_sched_retry_deferred(anjay_unlocked_t *anjay,
                                      anjay_ssid_t ssid);
 
+#ifdef ANJAY_WITH_INSTRUMENTATION
+/**
+ * Increments @p out_deferred by the number of deferred Send requests and
+ * @p inout_in_progress by the number of Send exchanges currently in progress.
+ */
+void _anjay_send_count_queued(anjay_unlocked_t *anjay,
+                              size_t *out_deferred,
+                              size_t *inout_in_progress);
+#endif // ANJAY_WITH_INSTRUMENTATION
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* ANJAY_LWM2M_SEND_H */
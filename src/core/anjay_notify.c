@@ -16,7 +16,9 @@
 
 #include "anjay_access_utils_private.h"
 #include "anjay_core.h"
+#include "anjay_instrumentation.h"
 #include "anjay_servers_utils.h"
+#include "dm/anjay_discover.h"
 #include "observe/anjay_observe_core.h"
 
 VISIBILITY_SOURCE_BEGIN
@@ -125,6 +127,37 @@ static int server_modified_notify(anjay_unlocked_t *anjay,
     return ret;
 }
 
+#ifdef ANJAY_WITH_OBSERVE_ATTRS_CACHE
+static void attrs_cache_instance_set_changed(anjay_unlocked_t *anjay,
+                                             anjay_oid_t oid) {
+    if (oid == ANJAY_DM_OID_SERVER) {
+        // Default Minimum and Maximum Periods apply to paths in all Objects
+        _anjay_observe_attrs_cache_invalidate(anjay);
+    } else {
+        // presence of Instances determines which attributes are inherited
+        _anjay_observe_attrs_cache_invalidate_object(anjay, oid);
+    }
+}
+
+static void
+attrs_cache_handle_change(anjay_unlocked_t *anjay,
+                          const anjay_notify_queue_object_entry_t *entry) {
+    if (entry->instance_set_changes.instance_set_changed) {
+        attrs_cache_instance_set_changed(anjay, entry->oid);
+    } else if (entry->oid == ANJAY_DM_OID_SERVER) {
+        AVS_LIST(anjay_notify_queue_resource_entry_t) it;
+        AVS_LIST_FOREACH(it, entry->resources_changed) {
+            if (it->rid == ANJAY_DM_RID_SERVER_SSID
+                    || it->rid == ANJAY_DM_RID_SERVER_DEFAULT_PMIN
+                    || it->rid == ANJAY_DM_RID_SERVER_DEFAULT_PMAX) {
+                _anjay_observe_attrs_cache_invalidate(anjay);
+                return;
+            }
+        }
+    }
+}
+#endif // ANJAY_WITH_OBSERVE_ATTRS_CACHE
+
 static int anjay_notify_perform_impl(anjay_unlocked_t *anjay,
                                      anjay_ssid_t origin_ssid,
                                      anjay_notify_queue_t *queue_ptr,
@@ -141,6 +174,12 @@ static int anjay_notify_perform_impl(anjay_unlocked_t *anjay,
         if (it->instance_set_changes.instance_set_changed) {
             instances_modified = true;
         }
+#ifdef ANJAY_WITH_DISCOVER_CACHE
+        _anjay_discover_cache_invalidate(anjay, it->oid);
+#endif // ANJAY_WITH_DISCOVER_CACHE
+#ifdef ANJAY_WITH_OBSERVE_ATTRS_CACHE
+        attrs_cache_handle_change(anjay, it);
+#endif // ANJAY_WITH_OBSERVE_ATTRS_CACHE
         if (it->oid == ANJAY_DM_OID_SECURITY) {
             _anjay_update_ret(&ret, security_modified_notify(anjay, it));
         } else if (server_notify && it->oid == ANJAY_DM_OID_SERVER) {
@@ -176,8 +215,10 @@ int _anjay_notify_perform_without_servers(anjay_unlocked_t *anjay,
 int _anjay_notify_flush(anjay_unlocked_t *anjay,
                         anjay_ssid_t origin_ssid,
                         anjay_notify_queue_t *queue_ptr) {
+    ANJAY_INSTR_START(start);
     int result = _anjay_notify_perform(anjay, origin_ssid, queue_ptr);
     _anjay_notify_clear_queue(queue_ptr);
+    _anjay_instr_record(anjay, ANJAY_INSTR_PROBE_NOTIFY_FLUSH, start);
     return result;
 }
 
@@ -393,6 +434,11 @@ int anjay_notify_changed(anjay_t *anjay_locked,
 int _anjay_notify_instances_changed_unlocked(anjay_unlocked_t *anjay,
                                              anjay_oid_t oid) {
     int retval;
+#ifdef ANJAY_WITH_OBSERVE_ATTRS_CACHE
+    // Instances may already be gone, so notifications triggered before the
+    // queue is flushed shall not use attributes inherited from them
+    attrs_cache_instance_set_changed(anjay, oid);
+#endif // ANJAY_WITH_OBSERVE_ATTRS_CACHE
     (void) ((retval = _anjay_notify_queue_instance_set_unknown_change(
                      &anjay->scheduled_notify.queue, oid))
             || (retval = reschedule_notify(anjay)));
@@ -0,0 +1,443 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
+
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_stream_membuf.h>
+#    include <avsystem/commons/avs_utils.h>
+
+#    include <anjay_modules/anjay_persistence_journal.h>
+#    include <anjay_modules/anjay_utils_core.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+#    define journal_log(...) _anjay_log(journal, __VA_ARGS__)
+
+//// RECORD FRAMING ////////////////////////////////////////////////////////////
+
+avs_error_t _anjay_journal_write_record(avs_stream_t *out,
+                                        avs_stream_t *payload) {
+    void *data = NULL;
+    size_t size = 0;
+    avs_error_t err = avs_stream_membuf_take_ownership(payload, &data, &size);
+    if (avs_is_ok(err)) {
+        const uint32_t size_be32 = avs_convert_be32((uint32_t) size);
+        const uint32_t crc_be32 =
+                avs_convert_be32(_anjay_crc32(0, data, size));
+        (void) (avs_is_err((err = avs_stream_write(out, &size_be32,
+                                                   sizeof(size_be32))))
+                || avs_is_err((err = avs_stream_write(out, data, size)))
+                || avs_is_err((err = avs_stream_write(out, &crc_be32,
+                                                      sizeof(crc_be32)))));
+        avs_free(data);
+    }
+    return err;
+}
+
+static avs_error_t journal_read(avs_stream_t *in,
+                                void *buf,
+                                size_t size,
+                                size_t *out_bytes_read) {
+    bool finished = false;
+    avs_error_t err = AVS_OK;
+    *out_bytes_read = 0;
+    while (avs_is_ok(err) && !finished && *out_bytes_read < size) {
+        size_t bytes_read = 0;
+        err = avs_stream_read(in, &bytes_read, &finished,
+                              (char *) buf + *out_bytes_read,
+                              size - *out_bytes_read);
+        *out_bytes_read += bytes_read;
+    }
+    return err;
+}
+
+avs_error_t
+_anjay_journal_read_record(avs_stream_t *in,
+                           avs_stream_t *payload,
+                           anjay_journal_read_result_t *out_result) {
+    uint32_t field_be32;
+    size_t bytes_read;
+    avs_error_t err = journal_read(in, &field_be32, sizeof(field_be32),
+                                   &bytes_read);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    if (bytes_read < sizeof(field_be32)) {
+        *out_result = bytes_read ? ANJAY_JOURNAL_READ_INVALID
+                                 : ANJAY_JOURNAL_READ_END;
+        return AVS_OK;
+    }
+    // The payload is copied in chunks, so that a garbage size field does not
+    // cause allocating more memory than there is data in the stream
+    uint32_t remaining = avs_convert_be32(field_be32);
+    uint32_t crc = 0;
+    while (remaining) {
+        char chunk[64];
+        if (avs_is_err((err = journal_read(in, chunk,
+                                           AVS_MIN(sizeof(chunk), remaining),
+                                           &bytes_read)))) {
+            return err;
+        }
+        if (!bytes_read) {
+            *out_result = ANJAY_JOURNAL_READ_INVALID;
+            return AVS_OK;
+        }
+        crc = _anjay_crc32(crc, chunk, bytes_read);
+        if (avs_is_err((err = avs_stream_write(payload, chunk, bytes_read)))) {
+            return err;
+        }
+        remaining -= (uint32_t) bytes_read;
+    }
+    if (avs_is_err((err = journal_read(in, &field_be32, sizeof(field_be32),
+                                       &bytes_read)))) {
+        return err;
+    }
+    *out_result = (bytes_read == sizeof(field_be32)
+                   && avs_convert_be32(field_be32) == crc)
+                          ? ANJAY_JOURNAL_READ_OK
+                          : ANJAY_JOURNAL_READ_INVALID;
+    return AVS_OK;
+}
+
+//// INSTANCE LISTS ////////////////////////////////////////////////////////////
+
+/**
+ * Payload of each record consists of a version byte (passed to the
+ * handle_instance callback) and a 32-bit number of entries, each of which is
+ * a type byte followed by:
+ *
+ * - for JOURNAL_ENTRY_PURGE: nothing - all Instances are removed,
+ * - for JOURNAL_ENTRY_INSTANCE: Instance, as serialized by handle_instance -
+ *   it replaces the Instance with the same IID, if any,
+ * - for JOURNAL_ENTRY_REMOVED: IID of the removed Instance.
+ */
+typedef enum {
+    JOURNAL_ENTRY_PURGE = 'P',
+    JOURNAL_ENTRY_INSTANCE = 'I',
+    JOURNAL_ENTRY_REMOVED = 'R'
+} journal_entry_type_t;
+
+static anjay_iid_t element_iid(const anjay_journal_instances_def_t *def,
+                               const void *element) {
+    return *(const anjay_iid_t *) ((const char *) element + def->iid_offset);
+}
+
+static bool *element_modified_ptr(const anjay_journal_instances_def_t *def,
+                                  void *element) {
+    return (bool *) ((char *) element + def->modified_offset);
+}
+
+/**
+ * Replaces @p state with the IIDs of @p instances, and clears their modified
+ * flags. On failure, @p state is left untouched.
+ */
+static avs_error_t set_state(anjay_journal_state_t *state,
+                             const anjay_journal_instances_def_t *def,
+                             AVS_LIST(void) instances) {
+    AVS_LIST(anjay_iid_t) iids = NULL;
+    AVS_LIST(anjay_iid_t) *tail = &iids;
+    AVS_LIST(void) element;
+    AVS_LIST_FOREACH(element, instances) {
+        if (!(*tail = AVS_LIST_NEW_ELEMENT(anjay_iid_t))) {
+            _anjay_log_oom();
+            AVS_LIST_CLEAR(&iids);
+            return avs_errno(AVS_ENOMEM);
+        }
+        **tail = element_iid(def, element);
+        AVS_LIST_ADVANCE_PTR(&tail);
+    }
+    AVS_LIST_FOREACH(element, instances) {
+        *element_modified_ptr(def, element) = false;
+    }
+    _anjay_journal_state_cleanup(state);
+    state->iids = iids;
+    return AVS_OK;
+}
+
+void _anjay_journal_state_cleanup(anjay_journal_state_t *state) {
+    AVS_LIST_CLEAR(&state->iids);
+    state->reset_needed = false;
+}
+
+void _anjay_journal_state_update(anjay_journal_state_t *state,
+                                 const anjay_journal_instances_def_t *def,
+                                 AVS_LIST(void) instances) {
+    if (avs_is_err(set_state(state, def, instances))) {
+        _anjay_journal_state_cleanup(state);
+        state->reset_needed = true;
+    }
+}
+
+static avs_error_t write_removed_entry(avs_stream_t *entries,
+                                       anjay_iid_t iid) {
+    avs_persistence_context_t ctx =
+            avs_persistence_store_context_create(entries);
+    uint8_t type = JOURNAL_ENTRY_REMOVED;
+    avs_error_t err;
+    (void) (avs_is_err((err = avs_persistence_u8(&ctx, &type)))
+            || avs_is_err((err = avs_persistence_u16(&ctx, &iid))));
+    return err;
+}
+
+static avs_error_t
+write_instance_entry(const anjay_journal_instances_def_t *def,
+                     void *element,
+                     avs_stream_t *entries) {
+    const uint8_t type = JOURNAL_ENTRY_INSTANCE;
+    avs_error_t err = avs_stream_write(entries, &type, sizeof(type));
+    if (avs_is_ok(err)) {
+        avs_persistence_context_t ctx =
+                avs_persistence_store_context_create(entries);
+        err = def->handle_instance(&ctx, element, def->version);
+    }
+    return err;
+}
+
+/**
+ * Writes entries for all differences between @p instances and @p old_iids to
+ * @p entries. Only the Instances that are either not present in @p old_iids, or
+ * have their modified flag set, are serialized.
+ */
+static avs_error_t
+write_changed_entries(const anjay_journal_instances_def_t *def,
+                      AVS_LIST(void) instances,
+                      AVS_LIST(anjay_iid_t) old_iids,
+                      avs_stream_t *entries,
+                      uint32_t *inout_entry_count) {
+    avs_error_t err = AVS_OK;
+    AVS_LIST(void) element;
+    AVS_LIST_FOREACH(element, instances) {
+        const anjay_iid_t iid = element_iid(def, element);
+        while (avs_is_ok(err) && old_iids && *old_iids < iid) {
+            err = write_removed_entry(entries, *old_iids);
+            ++*inout_entry_count;
+            old_iids = AVS_LIST_NEXT(old_iids);
+        }
+        if (avs_is_err(err)) {
+            return err;
+        }
+        bool changed = true;
+        if (old_iids && *old_iids == iid) {
+            changed = *element_modified_ptr(def, element);
+            old_iids = AVS_LIST_NEXT(old_iids);
+        }
+        if (changed) {
+            if (avs_is_err((err = write_instance_entry(def, element,
+                                                       entries)))) {
+                return err;
+            }
+            ++*inout_entry_count;
+        }
+    }
+    while (avs_is_ok(err) && old_iids) {
+        err = write_removed_entry(entries, *old_iids);
+        ++*inout_entry_count;
+        old_iids = AVS_LIST_NEXT(old_iids);
+    }
+    return err;
+}
+
+static avs_error_t write_instances_record(uint8_t version,
+                                          uint32_t entry_count,
+                                          avs_stream_t *entries,
+                                          avs_stream_t *out) {
+    avs_stream_t *payload = avs_stream_membuf_create();
+    if (!payload) {
+        _anjay_log_oom();
+        return avs_errno(AVS_ENOMEM);
+    }
+    avs_persistence_context_t ctx =
+            avs_persistence_store_context_create(payload);
+    void *data = NULL;
+    size_t size = 0;
+    avs_error_t err;
+    (void) (avs_is_err((err = avs_persistence_u8(&ctx, &version)))
+            || avs_is_err((err = avs_persistence_u32(&ctx, &entry_count)))
+            || avs_is_err((err = avs_stream_membuf_take_ownership(
+                                   entries, &data, &size)))
+            || avs_is_err((err = avs_stream_write(payload, data, size)))
+            || avs_is_err((err = _anjay_journal_write_record(out, payload))));
+    avs_free(data);
+    avs_stream_cleanup(&payload);
+    return err;
+}
+
+avs_error_t
+_anjay_journal_append_instances(anjay_journal_state_t *state,
+                                const anjay_journal_instances_def_t *def,
+                                AVS_LIST(void) instances,
+                                avs_stream_t *out) {
+    avs_stream_t *entries = avs_stream_membuf_create();
+    if (!entries) {
+        _anjay_log_oom();
+        return avs_errno(AVS_ENOMEM);
+    }
+    uint32_t entry_count = 0;
+    avs_error_t err = AVS_OK;
+    if (state->reset_needed) {
+        const uint8_t type = JOURNAL_ENTRY_PURGE;
+        err = avs_stream_write(entries, &type, sizeof(type));
+        ++entry_count;
+    }
+    if (avs_is_ok(err)
+            && avs_is_ok((err = write_changed_entries(
+                                  def, instances,
+                                  state->reset_needed ? NULL : state->iids,
+                                  entries, &entry_count)))
+            && entry_count) {
+        err = write_instances_record(def->version, entry_count, entries, out);
+    }
+    avs_stream_cleanup(&entries);
+    if (avs_is_ok(err)) {
+        // If this fails, the record has already been written, so the next
+        // append will just repeat all Instances after a purge entry
+        _anjay_journal_state_update(state, def, instances);
+    }
+    return err;
+}
+
+static AVS_LIST(void) *find_instance_ptr(
+        const anjay_journal_instances_def_t *def,
+        AVS_LIST(void) *instances_ptr,
+        anjay_iid_t iid) {
+    while (*instances_ptr && element_iid(def, *instances_ptr) < iid) {
+        AVS_LIST_ADVANCE_PTR(&instances_ptr);
+    }
+    return instances_ptr;
+}
+
+static void remove_instance(const anjay_journal_instances_def_t *def,
+                            AVS_LIST(void) *instance_ptr) {
+    AVS_LIST(void) instance = AVS_LIST_DETACH(instance_ptr);
+    def->destroy_instance(&instance);
+}
+
+static avs_error_t apply_instance_entry(
+        const anjay_journal_instances_def_t *def,
+        AVS_LIST(void) *instances_ptr,
+        avs_persistence_context_t *ctx,
+        uint8_t version) {
+    AVS_LIST(void) instance = AVS_LIST_NEW_BUFFER(def->element_size);
+    if (!instance) {
+        _anjay_log_oom();
+        return avs_errno(AVS_ENOMEM);
+    }
+    avs_error_t err = def->handle_instance(ctx, instance, version);
+    if (avs_is_err(err)) {
+        def->destroy_instance(&instance);
+        return err;
+    }
+    const anjay_iid_t iid = element_iid(def, instance);
+    AVS_LIST(void) *instance_ptr = find_instance_ptr(def, instances_ptr, iid);
+    if (*instance_ptr && element_iid(def, *instance_ptr) == iid) {
+        remove_instance(def, instance_ptr);
+    }
+    AVS_LIST_INSERT(instance_ptr, instance);
+    return AVS_OK;
+}
+
+static avs_error_t apply_entry(const anjay_journal_instances_def_t *def,
+                               AVS_LIST(void) *instances_ptr,
+                               avs_persistence_context_t *ctx,
+                               uint8_t version) {
+    uint8_t type = 0;
+    avs_error_t err = avs_persistence_u8(ctx, &type);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    switch (type) {
+    case JOURNAL_ENTRY_PURGE:
+        while (*instances_ptr) {
+            remove_instance(def, instances_ptr);
+        }
+        return AVS_OK;
+    case JOURNAL_ENTRY_INSTANCE:
+        return apply_instance_entry(def, instances_ptr, ctx, version);
+    case JOURNAL_ENTRY_REMOVED: {
+        anjay_iid_t iid = ANJAY_ID_INVALID;
+        if (avs_is_ok((err = avs_persistence_u16(ctx, &iid)))) {
+            AVS_LIST(void) *instance_ptr =
+                    find_instance_ptr(def, instances_ptr, iid);
+            if (*instance_ptr && element_iid(def, *instance_ptr) == iid) {
+                remove_instance(def, instance_ptr);
+            }
+        }
+        return err;
+    }
+    default:
+        journal_log(WARNING, _("unknown journal entry type: ") "%d",
+                    (int) type);
+        return avs_errno(AVS_EBADMSG);
+    }
+}
+
+static avs_error_t apply_record(const anjay_journal_instances_def_t *def,
+                                AVS_LIST(void) *instances_ptr,
+                                avs_stream_t *payload) {
+    avs_persistence_context_t ctx =
+            avs_persistence_restore_context_create(payload);
+    uint8_t version = 0;
+    uint32_t entry_count = 0;
+    avs_error_t err;
+    if (avs_is_err((err = avs_persistence_u8(&ctx, &version)))
+            || avs_is_err((err = avs_persistence_u32(&ctx, &entry_count)))) {
+        return err;
+    }
+    if (version > def->version) {
+        journal_log(WARNING, _("unsupported journal record version: ") "%d",
+                    (int) version);
+        return avs_errno(AVS_EBADMSG);
+    }
+    while (entry_count--) {
+        if (avs_is_err((err = apply_entry(def, instances_ptr, &ctx,
+                                          version)))) {
+            break;
+        }
+    }
+    return err;
+}
+
+avs_error_t
+_anjay_journal_replay_instances(const anjay_journal_instances_def_t *def,
+                                AVS_LIST(void) *instances_ptr,
+                                avs_stream_t *journal) {
+    avs_stream_t *payload = avs_stream_membuf_create();
+    if (!payload) {
+        _anjay_log_oom();
+        return avs_errno(AVS_ENOMEM);
+    }
+    avs_error_t err;
+    unsigned records_applied = 0;
+    anjay_journal_read_result_t result = ANJAY_JOURNAL_READ_END;
+    while (avs_is_ok((err = avs_stream_reset(payload)))
+           && avs_is_ok((err = _anjay_journal_read_record(journal, payload,
+                                                          &result)))
+           && result == ANJAY_JOURNAL_READ_OK
+           && avs_is_ok((err = apply_record(def, instances_ptr, payload)))) {
+        ++records_applied;
+    }
+    if (avs_is_ok(err) && result == ANJAY_JOURNAL_READ_INVALID) {
+        journal_log(WARNING,
+                    _("journal record ") "%u" _(
+                            " is incomplete or corrupted, ignoring it and all "
+                            "data after it"),
+                    records_applied);
+    }
+    avs_stream_cleanup(&payload);
+    return err;
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/core/persistence_journal.c"
+#    endif // ANJAY_TEST
+
+#endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
@@ -85,6 +85,12 @@ _anjay_conn_session_tokens_equal(anjay_conn_session_token_t left,
     return left.value == right.value;
 }
 
+/**
+ * Session state of a single server connection, as persisted by
+ * anjay_session_state_persist(). Defined in servers/anjay_session_persistence.c.
+ */
+typedef struct anjay_server_session_state_struct anjay_server_session_state_t;
+
 // 6.2.2 Object Version format:
 // "The Object Version of an Object is composed of 2 digits separated by a dot"
 // However, we're a bit lenient to support proper numbers and not just digits.
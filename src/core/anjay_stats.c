@@ -61,6 +61,86 @@ static uint64_t get_socket_stats(avs_net_socket_t *socket,
     }
 }
 
+#    ifdef ANJAY_QUERY_SNAPSHOT_DEFINED
+typedef struct {
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    uint64_t outgoing_retransmissions;
+    uint64_t incoming_retransmissions;
+} all_stats_t;
+
+static int add_stats_of_server(anjay_unlocked_t *anjay,
+                               anjay_server_info_t *server,
+                               void *out_stats_) {
+    (void) anjay;
+    all_stats_t *out_stats = (all_stats_t *) out_stats_;
+    anjay_connection_type_t conn_type;
+    ANJAY_CONNECTION_TYPE_FOREACH(conn_type) {
+        const anjay_connection_ref_t conn_ref = {
+            .server = server,
+            .conn_type = conn_type
+        };
+        avs_net_socket_t *socket =
+                _anjay_connection_get_online_socket(conn_ref);
+        if (socket) {
+            out_stats->bytes_sent +=
+                    get_socket_stats(socket, NET_STATS_BYTES_SENT);
+            out_stats->bytes_received +=
+                    get_socket_stats(socket, NET_STATS_BYTES_RECEIVED);
+        }
+        avs_coap_ctx_t *coap_ctx = _anjay_connection_get_coap(conn_ref);
+        if (coap_ctx) {
+            const avs_coap_stats_t stats = avs_coap_get_stats(coap_ctx);
+            out_stats->outgoing_retransmissions +=
+                    stats.outgoing_retransmissions_count;
+            out_stats->incoming_retransmissions +=
+                    stats.incoming_retransmissions_count;
+        }
+    }
+    return 0;
+}
+
+void _anjay_net_stats_publish(anjay_unlocked_t *anjay,
+                              anjay_atomic_fields_t *fields) {
+    // All statistics are gathered in a single walk over the servers, as this
+    // may be done on every ANJAY_MUTEX_UNLOCK()
+    all_stats_t stats = {
+        .bytes_sent = anjay->closed_connections_stats.socket_stats.bytes_sent,
+        .bytes_received =
+                anjay->closed_connections_stats.socket_stats.bytes_received,
+        .outgoing_retransmissions =
+                anjay->closed_connections_stats.coap_stats
+                        .outgoing_retransmissions_count,
+        .incoming_retransmissions =
+                anjay->closed_connections_stats.coap_stats
+                        .incoming_retransmissions_count
+    };
+    _anjay_servers_foreach_active(anjay, add_stats_of_server, &stats);
+    atomic_store(&fields->tx_bytes, stats.bytes_sent);
+    atomic_store(&fields->rx_bytes, stats.bytes_received);
+    atomic_store(&fields->incoming_retransmissions,
+                 stats.incoming_retransmissions);
+    atomic_store(&fields->outgoing_retransmissions,
+                 stats.outgoing_retransmissions);
+}
+
+static uint64_t get_stats(anjay_t *anjay_locked, net_stats_type_t type) {
+    assert(anjay_locked);
+    const anjay_atomic_fields_t *fields = &anjay_locked->atomic_fields;
+    switch (type) {
+    case NET_STATS_BYTES_SENT:
+        return atomic_load(&fields->tx_bytes);
+    case NET_STATS_BYTES_RECEIVED:
+        return atomic_load(&fields->rx_bytes);
+    case NET_STATS_OUTGOING_RETRANSMISSIONS:
+        return atomic_load(&fields->outgoing_retransmissions);
+    case NET_STATS_INCOMING_RETRANSMISSIONS:
+        return atomic_load(&fields->incoming_retransmissions);
+    }
+    AVS_UNREACHABLE("invalid enum value");
+    return 0;
+}
+#    else  // ANJAY_QUERY_SNAPSHOT_DEFINED
 static uint64_t get_current_stats_of_connection(anjay_connection_ref_t conn_ref,
                                                 net_stats_type_t type) {
     avs_net_socket_t *socket;
@@ -137,38 +217,29 @@ static uint64_t get_stats_of_all_connections(anjay_unlocked_t *anjay,
            + get_stats_of_closed_connections(anjay, type);
 }
 
-uint64_t anjay_get_tx_bytes(anjay_t *anjay_locked) {
+static uint64_t get_stats(anjay_t *anjay_locked, net_stats_type_t type) {
     uint64_t result = 0;
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    result = get_stats_of_all_connections(anjay, NET_STATS_BYTES_SENT);
+    result = get_stats_of_all_connections(anjay, type);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return result;
 }
+#    endif // ANJAY_QUERY_SNAPSHOT_DEFINED
 
-uint64_t anjay_get_rx_bytes(anjay_t *anjay_locked) {
-    uint64_t result = 0;
-    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    result = get_stats_of_all_connections(anjay, NET_STATS_BYTES_RECEIVED);
-    ANJAY_MUTEX_UNLOCK(anjay_locked);
-    return result;
+uint64_t anjay_get_tx_bytes(anjay_t *anjay) {
+    return get_stats(anjay, NET_STATS_BYTES_SENT);
 }
 
-uint64_t anjay_get_num_incoming_retransmissions(anjay_t *anjay_locked) {
-    uint64_t result = 0;
-    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    result = get_stats_of_all_connections(anjay,
-                                          NET_STATS_INCOMING_RETRANSMISSIONS);
-    ANJAY_MUTEX_UNLOCK(anjay_locked);
-    return result;
+uint64_t anjay_get_rx_bytes(anjay_t *anjay) {
+    return get_stats(anjay, NET_STATS_BYTES_RECEIVED);
 }
 
-uint64_t anjay_get_num_outgoing_retransmissions(anjay_t *anjay_locked) {
-    uint64_t result = 0;
-    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    result = get_stats_of_all_connections(anjay,
-                                          NET_STATS_OUTGOING_RETRANSMISSIONS);
-    ANJAY_MUTEX_UNLOCK(anjay_locked);
-    return result;
+uint64_t anjay_get_num_incoming_retransmissions(anjay_t *anjay) {
+    return get_stats(anjay, NET_STATS_INCOMING_RETRANSMISSIONS);
+}
+
+uint64_t anjay_get_num_outgoing_retransmissions(anjay_t *anjay) {
+    return get_stats(anjay, NET_STATS_OUTGOING_RETRANSMISSIONS);
 }
 
 void _anjay_coap_ctx_cleanup(anjay_unlocked_t *anjay, avs_coap_ctx_t **ctx) {
@@ -229,6 +300,7 @@ avs_error_t _anjay_socket_cleanup(anjay_unlocked_t *anjay,
                                   avs_net_socket_t **socket) {
     assert(socket);
     if (*socket) {
+        _anjay_query_snapshot_mark_dirty(anjay);
         avs_net_socket_shutdown(*socket);
 #ifdef ANJAY_WITH_NET_STATS
         anjay->closed_connections_stats.socket_stats.bytes_sent +=
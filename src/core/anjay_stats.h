@@ -33,6 +33,11 @@ typedef struct {
     } socket_stats;
 } closed_connections_stats_t;
 
+#    ifdef ANJAY_QUERY_SNAPSHOT_DEFINED
+void _anjay_net_stats_publish(anjay_unlocked_t *anjay,
+                              anjay_atomic_fields_t *fields);
+#    endif // ANJAY_QUERY_SNAPSHOT_DEFINED
+
 #endif // ANJAY_WITH_NET_STATS
 
 void _anjay_coap_ctx_cleanup(anjay_unlocked_t *anjay, avs_coap_ctx_t **ctx);
@@ -827,6 +827,17 @@ void _anjay_log_oom(void) {
     anjay_log(ERROR, _("out of memory"));
 }
 
+uint32_t _anjay_crc32(uint32_t crc, const void *data, size_t size) {
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= ((const uint8_t *) data)[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1) ? UINT32_C(0xEDB88320) : 0);
+        }
+    }
+    return ~crc;
+}
+
 anjay_dm_t *_anjay_get_dm(anjay_unlocked_t *anjay) {
     return &anjay->dm;
 }
@@ -43,6 +43,7 @@ int _anjay_attr_storage_init(anjay_unlocked_t *anjay) {
 void _anjay_attr_storage_cleanup(anjay_attr_storage_t *as) {
     assert(as);
     _anjay_attr_storage_clear(as);
+    _anjay_attr_storage_journal_reset(as, false);
     avs_stream_cleanup(&as->saved_state.persist_data);
 }
 
@@ -58,6 +59,53 @@ void _anjay_attr_storage_clear(anjay_attr_storage_t *as) {
     while (as->objects) {
         remove_object_entry(as, &as->objects);
     }
+    // attributes are gone, so anything derived from them is stale now
+    ++as->modification_count;
+    _anjay_attr_storage_journal_reset(as, true);
+}
+
+void _anjay_attr_storage_journal_reset(anjay_attr_storage_t *as,
+                                       bool reset_needed) {
+    AVS_LIST_CLEAR(&as->journal_dirty);
+    as->journal_reset_needed = reset_needed;
+}
+
+void _anjay_attr_storage_journal_mark(anjay_attr_storage_t *as,
+                                      anjay_oid_t oid,
+                                      anjay_iid_t iid) {
+    if (as->journal_reset_needed) {
+        return;
+    }
+    AVS_LIST(as_journal_key_t) *key_ptr = &as->journal_dirty;
+    while (*key_ptr && (*key_ptr)->oid < oid) {
+        AVS_LIST_ADVANCE_PTR(&key_ptr);
+    }
+    AVS_LIST(as_journal_key_t) *insert_ptr = NULL;
+    while (*key_ptr && (*key_ptr)->oid == oid) {
+        if ((*key_ptr)->iid == iid || (*key_ptr)->iid == ANJAY_ID_INVALID) {
+            // already marked, possibly as part of the whole Object entry
+            return;
+        }
+        if (iid == ANJAY_ID_INVALID) {
+            // superseded by the whole Object entry
+            AVS_LIST_DELETE(key_ptr);
+            continue;
+        }
+        if (!insert_ptr && (*key_ptr)->iid > iid) {
+            insert_ptr = key_ptr;
+        }
+        AVS_LIST_ADVANCE_PTR(&key_ptr);
+    }
+    AVS_LIST(as_journal_key_t) key = AVS_LIST_NEW_ELEMENT(as_journal_key_t);
+    if (!key) {
+        _anjay_log_oom();
+        // the next append will rewrite everything instead
+        _anjay_attr_storage_journal_reset(as, true);
+        return;
+    }
+    key->oid = oid;
+    key->iid = iid;
+    AVS_LIST_INSERT(insert_ptr ? insert_ptr : key_ptr, key);
 }
 
 void anjay_attr_storage_purge(anjay_t *anjay_locked) {
@@ -160,12 +208,6 @@ find_or_create_resource_instance(as_resource_entry_t *parent, anjay_riid_t id) {
 }
 #    endif // ANJAY_WITH_LWM2M11
 
-static void remove_instance_if_empty(AVS_LIST(as_instance_entry_t) *entry_ptr) {
-    if (!(*entry_ptr)->default_attrs && !(*entry_ptr)->resources) {
-        AVS_LIST_DELETE(entry_ptr);
-    }
-}
-
 static void remove_resource_if_empty(AVS_LIST(as_resource_entry_t) *entry_ptr) {
     if (!(*entry_ptr)->attrs
 #    ifdef ANJAY_WITH_LWM2M11
@@ -248,6 +290,8 @@ static void remove_servers_not_on_ssid_list(anjay_attr_storage_t *as,
     AVS_LIST(as_object_entry_t) *object_ptr;
     AVS_LIST(as_object_entry_t) object_helper;
     AVS_LIST_DELETABLE_FOREACH_PTR(object_ptr, object_helper, &as->objects) {
+        const anjay_oid_t oid = (*object_ptr)->oid;
+        const uint32_t modification_count = as->modification_count;
         remove_attrs_for_servers_not_on_list(
                 as, (AVS_LIST(void) *) &(*object_ptr)->default_attrs,
                 ssid_list);
@@ -282,6 +326,9 @@ static void remove_servers_not_on_ssid_list(anjay_attr_storage_t *as,
             remove_instance_if_empty(instance_ptr);
         }
         remove_object_if_empty(object_ptr);
+        if (as->modification_count != modification_count) {
+            _anjay_attr_storage_journal_mark(as, oid, ANJAY_ID_INVALID);
+        }
     }
 }
 
@@ -487,9 +534,9 @@ static int write_object_attrs(anjay_unlocked_t *anjay,
                               anjay_ssid_t ssid,
                               const anjay_dm_installed_object_t *obj_ptr,
                               const anjay_dm_oi_attributes_t *attrs) {
+    const anjay_oid_t oid = _anjay_dm_installed_object_oid(obj_ptr);
     AVS_LIST(as_object_entry_t) *object_ptr =
-            find_or_create_object(&anjay->attr_storage,
-                                  _anjay_dm_installed_object_oid(obj_ptr));
+            find_or_create_object(&anjay->attr_storage, oid);
     if (!object_ptr) {
         return -1;
     }
@@ -497,6 +544,10 @@ static int write_object_attrs(anjay_unlocked_t *anjay,
             WRITE_ATTRS(&anjay->attr_storage, &(*object_ptr)->default_attrs,
                         default_attrs_empty, ssid, attrs);
     remove_object_if_empty(object_ptr);
+    if (!result) {
+        _anjay_attr_storage_journal_mark(&anjay->attr_storage, oid,
+                                         ANJAY_ID_INVALID);
+    }
     return result;
 }
 
@@ -523,6 +574,11 @@ static int write_instance_attrs(anjay_unlocked_t *anjay,
     if (object_ptr) {
         remove_object_if_empty(object_ptr);
     }
+    if (!result) {
+        _anjay_attr_storage_journal_mark(
+                &anjay->attr_storage, _anjay_dm_installed_object_oid(obj_ptr),
+                iid);
+    }
     return result;
 }
 
@@ -554,6 +610,11 @@ static int write_resource_attrs(anjay_unlocked_t *anjay,
     if (object_ptr) {
         remove_object_if_empty(object_ptr);
     }
+    if (!result) {
+        _anjay_attr_storage_journal_mark(
+                &anjay->attr_storage, _anjay_dm_installed_object_oid(obj_ptr),
+                iid);
+    }
     return result;
 }
 
@@ -596,6 +657,11 @@ write_resource_instance_attrs(anjay_unlocked_t *anjay,
     if (object_ptr) {
         remove_object_if_empty(object_ptr);
     }
+    if (!result) {
+        _anjay_attr_storage_journal_mark(
+                &anjay->attr_storage, _anjay_dm_installed_object_oid(obj_ptr),
+                iid);
+    }
     return result;
 }
 #    endif // ANJAY_WITH_LWM2M11
@@ -726,8 +792,12 @@ int _anjay_attr_storage_notify(anjay_unlocked_t *anjay,
                 _anjay_dm_find_object_by_oid(&anjay->dm, object_entry->oid);
         if (!def_ptr && object_ptr) {
             remove_object_entry(&anjay->attr_storage, object_ptr);
+            _anjay_attr_storage_journal_mark(
+                    &anjay->attr_storage, object_entry->oid, ANJAY_ID_INVALID);
             continue;
         }
+        const uint32_t modification_count =
+                anjay->attr_storage.modification_count;
         AVS_LIST(anjay_ssid_t) ssids = NULL;
         int partial_result =
                 remove_absent_instances_and_enumerate_ssids(anjay, def_ptr,
@@ -749,6 +819,12 @@ int _anjay_attr_storage_notify(anjay_unlocked_t *anjay,
             partial_result = remove_absent_resources_in_all_instances(
                     anjay, def_ptr, object_entry->resources_changed);
         }
+        if (anjay->attr_storage.modification_count != modification_count) {
+            // entries are pruned rarely enough not to bother tracking the
+            // individual Instances affected
+            _anjay_attr_storage_journal_mark(
+                    &anjay->attr_storage, object_entry->oid, ANJAY_ID_INVALID);
+        }
         _anjay_update_ret(&result, partial_result);
     }
     return result;
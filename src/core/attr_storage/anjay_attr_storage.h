@@ -24,9 +24,26 @@ typedef struct {
     bool modified_since_persist;
 } as_saved_state_t;
 
+/**
+ * Key of an entry modified since the journal was last brought up to date. IID
+ * equal to ANJAY_ID_INVALID denotes the whole Object entry, including its
+ * Object-level default attributes.
+ */
+typedef struct {
+    anjay_oid_t oid;
+    anjay_iid_t iid;
+} as_journal_key_t;
+
 typedef struct {
     AVS_LIST(as_object_entry_t) objects;
     bool modified_since_persist;
+    uint32_t modification_count;
+    /**
+     * Sorted by OID, then IID. Only meaningful if journal_reset_needed is
+     * false; otherwise, the next journal append rewrites all entries.
+     */
+    AVS_LIST(as_journal_key_t) journal_dirty;
+    bool journal_reset_needed;
     as_saved_state_t saved_state;
 } anjay_attr_storage_t;
 
@@ -17,9 +17,11 @@
 #    include "core/anjay_core.h"
 
 #    include <avsystem/commons/avs_persistence.h>
+#    include <avsystem/commons/avs_stream_membuf.h>
 
 #    include <anjay_modules/anjay_dm_utils.h>
 #    include <anjay_modules/anjay_io_utils.h>
+#    include <anjay_modules/anjay_persistence_journal.h>
 #    include <anjay_modules/anjay_raw_buffer.h>
 
 #    define ANJAY_ATTR_STORAGE_INTERNALS
@@ -365,6 +367,289 @@ static avs_error_t clear_nonexistent_entries(anjay_unlocked_t *anjay,
     return AVS_OK;
 }
 
+//// JOURNAL ///////////////////////////////////////////////////////////////////
+
+/**
+ * The journal is a sequence of records, framed as described in
+ * anjay_persistence_journal.h. Each record is written by a single call to
+ * anjay_attr_storage_journal_append(). Its payload consists of a version byte
+ * (with the same meaning as in the magic header of the full persistence
+ * format) and a 32-bit number of entries, each of which is a type byte
+ * followed by:
+ *
+ * - for AS_JOURNAL_ENTRY_PURGE: nothing - all entries are removed,
+ * - for AS_JOURNAL_ENTRY_OBJECT: Object entry, in the same format as in the
+ *   full persistence format - it replaces the entry with the same OID,
+ * - for AS_JOURNAL_ENTRY_INSTANCE: OID, followed by Instance entry in the
+ *   same format as in the full persistence format - it replaces the entry with
+ *   the same OID and IID.
+ *
+ * Removed entries are recorded as entries with no attributes.
+ */
+typedef enum {
+    AS_JOURNAL_ENTRY_PURGE = 'P',
+    AS_JOURNAL_ENTRY_OBJECT = 'O',
+    AS_JOURNAL_ENTRY_INSTANCE = 'I'
+} as_journal_entry_type_t;
+
+static AVS_LIST(void) *find_entry_slot(AVS_LIST(void) *list_ptr, uint16_t id) {
+    while (*list_ptr && *(uint16_t *) *list_ptr < id) {
+        AVS_LIST_ADVANCE_PTR(&list_ptr);
+    }
+    return list_ptr;
+}
+
+static inline AVS_LIST(as_object_entry_t) *
+find_object_slot(anjay_attr_storage_t *as, anjay_oid_t oid) {
+    return (AVS_LIST(as_object_entry_t) *) find_entry_slot(
+            (AVS_LIST(void) *) &as->objects, oid);
+}
+
+static inline AVS_LIST(as_instance_entry_t) *
+find_instance_slot(as_object_entry_t *object, anjay_iid_t iid) {
+    return (AVS_LIST(as_instance_entry_t) *) find_entry_slot(
+            (AVS_LIST(void) *) &object->instances, iid);
+}
+
+static avs_error_t journal_serialize_entry(avs_persistence_context_t *ctx,
+                                           anjay_attr_storage_t *as,
+                                           const as_journal_key_t *key) {
+    void *version_as_ptr = (void *) (intptr_t) AS_PERSISTENCE_VERSION_CURRENT;
+    AVS_LIST(as_object_entry_t) *object_ptr = find_object_slot(as, key->oid);
+    as_object_entry_t *object =
+            (*object_ptr && (*object_ptr)->oid == key->oid) ? *object_ptr
+                                                            : NULL;
+    avs_error_t err;
+    if (key->iid == ANJAY_ID_INVALID) {
+        uint8_t type = AS_JOURNAL_ENTRY_OBJECT;
+        as_object_entry_t removed_object = {
+            .oid = key->oid
+        };
+        (void) (avs_is_err((err = avs_persistence_u8(ctx, &type)))
+                || avs_is_err((err = handle_object(
+                                       ctx, object ? object : &removed_object,
+                                       version_as_ptr))));
+    } else {
+        uint8_t type = AS_JOURNAL_ENTRY_INSTANCE;
+        anjay_oid_t oid = key->oid;
+        AVS_LIST(as_instance_entry_t) *instance_ptr =
+                object ? find_instance_slot(object, key->iid) : NULL;
+        as_instance_entry_t removed_instance = {
+            .iid = key->iid
+        };
+        as_instance_entry_t *instance = &removed_instance;
+        if (instance_ptr && *instance_ptr && (*instance_ptr)->iid == key->iid) {
+            instance = *instance_ptr;
+        }
+        (void) (avs_is_err((err = avs_persistence_u8(ctx, &type)))
+                || avs_is_err((err = avs_persistence_u16(ctx, &oid)))
+                || avs_is_err((err = handle_instance_entry(ctx, instance,
+                                                           version_as_ptr))));
+    }
+    return err;
+}
+
+static avs_error_t journal_serialize_all(avs_persistence_context_t *ctx,
+                                         anjay_attr_storage_t *as) {
+    uint8_t type = AS_JOURNAL_ENTRY_PURGE;
+    avs_error_t err = avs_persistence_u8(ctx, &type);
+    AVS_LIST(as_object_entry_t) object;
+    AVS_LIST_FOREACH(object, as->objects) {
+        if (avs_is_err(err)) {
+            break;
+        }
+        const as_journal_key_t key = {
+            .oid = object->oid,
+            .iid = ANJAY_ID_INVALID
+        };
+        err = journal_serialize_entry(ctx, as, &key);
+    }
+    return err;
+}
+
+static avs_error_t journal_serialize_modified(avs_persistence_context_t *ctx,
+                                              anjay_attr_storage_t *as) {
+    avs_error_t err = AVS_OK;
+    AVS_LIST(as_journal_key_t) key;
+    AVS_LIST_FOREACH(key, as->journal_dirty) {
+        if (avs_is_err((err = journal_serialize_entry(ctx, as, key)))) {
+            break;
+        }
+    }
+    return err;
+}
+
+static avs_error_t journal_serialize(anjay_attr_storage_t *as,
+                                     avs_stream_t *payload,
+                                     uint32_t entry_count) {
+    avs_persistence_context_t ctx =
+            avs_persistence_store_context_create(payload);
+    uint8_t version = AS_PERSISTENCE_VERSION_CURRENT;
+    avs_error_t err;
+    (void) (avs_is_err((err = avs_persistence_version(
+                                &ctx, &version, SUPPORTED_VERSIONS_ARRAY,
+                                sizeof(SUPPORTED_VERSIONS_ARRAY))))
+            || avs_is_err((err = avs_persistence_u32(&ctx, &entry_count)))
+            || avs_is_err((err = (as->journal_reset_needed
+                                          ? journal_serialize_all(&ctx, as)
+                                          : journal_serialize_modified(&ctx,
+                                                                       as)))));
+    return err;
+}
+
+static void journal_replace_object(anjay_attr_storage_t *as,
+                                   AVS_LIST(as_object_entry_t) object) {
+    AVS_LIST(as_object_entry_t) *object_ptr = find_object_slot(as, object->oid);
+    if (*object_ptr && (*object_ptr)->oid == object->oid) {
+        remove_object_entry(as, object_ptr);
+    }
+    AVS_LIST_INSERT(object_ptr, object);
+    remove_object_if_empty(object_ptr);
+}
+
+static avs_error_t
+journal_replace_instance(anjay_attr_storage_t *as,
+                         anjay_oid_t oid,
+                         AVS_LIST(as_instance_entry_t) instance) {
+    AVS_LIST(as_object_entry_t) *object_ptr = find_object_slot(as, oid);
+    if (!*object_ptr || (*object_ptr)->oid != oid) {
+        AVS_LIST(as_object_entry_t) object =
+                AVS_LIST_NEW_ELEMENT(as_object_entry_t);
+        if (!object) {
+            _anjay_log_oom();
+            remove_instance_entry(as, &instance);
+            return avs_errno(AVS_ENOMEM);
+        }
+        object->oid = oid;
+        AVS_LIST_INSERT(object_ptr, object);
+    }
+    AVS_LIST(as_instance_entry_t) *instance_ptr =
+            find_instance_slot(*object_ptr, instance->iid);
+    if (*instance_ptr && (*instance_ptr)->iid == instance->iid) {
+        remove_instance_entry(as, instance_ptr);
+    }
+    AVS_LIST_INSERT(instance_ptr, instance);
+    remove_instance_if_empty(instance_ptr);
+    remove_object_if_empty(object_ptr);
+    return AVS_OK;
+}
+
+static avs_error_t journal_apply_object(anjay_attr_storage_t *as,
+                                        avs_persistence_context_t *ctx,
+                                        void *version_as_ptr) {
+    AVS_LIST(as_object_entry_t) object =
+            AVS_LIST_NEW_ELEMENT(as_object_entry_t);
+    if (!object) {
+        _anjay_log_oom();
+        return avs_errno(AVS_ENOMEM);
+    }
+    avs_error_t err;
+    if (avs_is_err((err = handle_object(ctx, object, version_as_ptr)))
+            || avs_is_err((err = (is_object_sane(object)
+                                          ? AVS_OK
+                                          : avs_errno(AVS_EBADMSG))))) {
+        remove_object_entry(as, &object);
+        return err;
+    }
+    journal_replace_object(as, object);
+    return AVS_OK;
+}
+
+static avs_error_t journal_apply_instance(anjay_attr_storage_t *as,
+                                          avs_persistence_context_t *ctx,
+                                          void *version_as_ptr) {
+    AVS_LIST(as_instance_entry_t) instance =
+            AVS_LIST_NEW_ELEMENT(as_instance_entry_t);
+    if (!instance) {
+        _anjay_log_oom();
+        return avs_errno(AVS_ENOMEM);
+    }
+    anjay_oid_t oid = 0;
+    avs_error_t err;
+    if (avs_is_err((err = avs_persistence_u16(ctx, &oid)))
+            || avs_is_err((err = handle_instance_entry(ctx, instance,
+                                                       version_as_ptr)))
+            || avs_is_err((err = (is_instances_list_sane(instance)
+                                          ? AVS_OK
+                                          : avs_errno(AVS_EBADMSG))))) {
+        remove_instance_entry(as, &instance);
+        return err;
+    }
+    return journal_replace_instance(as, oid, instance);
+}
+
+static avs_error_t journal_apply_entry(anjay_attr_storage_t *as,
+                                       avs_persistence_context_t *ctx,
+                                       void *version_as_ptr) {
+    uint8_t type = 0;
+    avs_error_t err = avs_persistence_u8(ctx, &type);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    switch (type) {
+    case AS_JOURNAL_ENTRY_PURGE:
+        _anjay_attr_storage_clear(as);
+        return AVS_OK;
+    case AS_JOURNAL_ENTRY_OBJECT:
+        return journal_apply_object(as, ctx, version_as_ptr);
+    case AS_JOURNAL_ENTRY_INSTANCE:
+        return journal_apply_instance(as, ctx, version_as_ptr);
+    default:
+        as_log(WARNING, _("unknown journal entry type: ") "%d", (int) type);
+        return avs_errno(AVS_EBADMSG);
+    }
+}
+
+static avs_error_t journal_apply_record(anjay_attr_storage_t *as,
+                                        avs_stream_t *payload) {
+    avs_persistence_context_t ctx =
+            avs_persistence_restore_context_create(payload);
+    uint8_t version = 0;
+    uint32_t entry_count = 0;
+    avs_error_t err;
+    if (avs_is_err((err = avs_persistence_version(
+                            &ctx, &version, SUPPORTED_VERSIONS_ARRAY,
+                            sizeof(SUPPORTED_VERSIONS_ARRAY))))
+            || avs_is_err((err = avs_persistence_u32(&ctx, &entry_count)))) {
+        return err;
+    }
+    while (entry_count--) {
+        if (avs_is_err((err = journal_apply_entry(
+                                as, &ctx, (void *) (intptr_t) version)))) {
+            break;
+        }
+    }
+    return err;
+}
+
+static avs_error_t journal_replay(anjay_attr_storage_t *as,
+                                  avs_stream_t *journal) {
+    avs_stream_t *payload = avs_stream_membuf_create();
+    if (!payload) {
+        _anjay_log_oom();
+        return avs_errno(AVS_ENOMEM);
+    }
+    avs_error_t err;
+    unsigned records_applied = 0;
+    anjay_journal_read_result_t result = ANJAY_JOURNAL_READ_END;
+    while (avs_is_ok((err = avs_stream_reset(payload)))
+           && avs_is_ok((err = _anjay_journal_read_record(journal, payload,
+                                                          &result)))
+           && result == ANJAY_JOURNAL_READ_OK
+           && avs_is_ok((err = journal_apply_record(as, payload)))) {
+        ++records_applied;
+    }
+    if (avs_is_ok(err) && result == ANJAY_JOURNAL_READ_INVALID) {
+        as_log(WARNING,
+               _("journal record ") "%u" _(
+                       " is incomplete or corrupted, ignoring it and all data "
+                       "after it"),
+               records_applied);
+    }
+    avs_stream_cleanup(&payload);
+    return err;
+}
+
 //// PUBLIC FUNCTIONS //////////////////////////////////////////////////////////
 
 avs_error_t
@@ -384,25 +669,30 @@ _anjay_attr_storage_persist_inner(anjay_attr_storage_t *attr_storage,
     return err;
 }
 
-avs_error_t _anjay_attr_storage_restore_inner(anjay_unlocked_t *anjay,
-                                              avs_stream_t *in) {
-    _anjay_attr_storage_clear(&anjay->attr_storage);
-
+static avs_error_t restore_snapshot(anjay_attr_storage_t *as,
+                                    avs_stream_t *in) {
     avs_persistence_context_t ctx = avs_persistence_restore_context_create(in);
     as_persistence_version_t version = (as_persistence_version_t) 0;
     avs_error_t err;
-
-    if (avs_is_err((err = avs_persistence_magic_string(&ctx, MAGIC)))
+    (void) (avs_is_err((err = avs_persistence_magic_string(&ctx, MAGIC)))
             || avs_is_err((err = avs_persistence_version(
                                    &ctx, (uint8_t *) &version,
                                    SUPPORTED_VERSIONS_ARRAY,
                                    sizeof(SUPPORTED_VERSIONS_ARRAY))))
-            || avs_is_err((err = HANDLE_LIST(object, &ctx,
-                                             &anjay->attr_storage.objects,
+            || avs_is_err((err = HANDLE_LIST(object, &ctx, &as->objects,
                                              (void *) version)))
-            || avs_is_err((err = (is_attr_storage_sane(&anjay->attr_storage)
+            || avs_is_err((err = (is_attr_storage_sane(as)
                                           ? AVS_OK
-                                          : avs_errno(AVS_EBADMSG))))
+                                          : avs_errno(AVS_EBADMSG)))));
+    return err;
+}
+
+avs_error_t _anjay_attr_storage_restore_inner(anjay_unlocked_t *anjay,
+                                              avs_stream_t *in) {
+    _anjay_attr_storage_clear(&anjay->attr_storage);
+
+    avs_error_t err;
+    if (avs_is_err((err = restore_snapshot(&anjay->attr_storage, in)))
             || avs_is_err((err = clear_nonexistent_entries(
                                    anjay, &anjay->attr_storage)))) {
         _anjay_attr_storage_clear(&anjay->attr_storage);
@@ -417,6 +707,7 @@ avs_error_t anjay_attr_storage_persist(anjay_t *anjay_locked,
     if (avs_is_ok((err = _anjay_attr_storage_persist_inner(&anjay->attr_storage,
                                                            out)))) {
         anjay->attr_storage.modified_since_persist = false;
+        _anjay_attr_storage_journal_reset(&anjay->attr_storage, false);
         as_log(INFO, _("Attribute Storage state persisted"));
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
@@ -431,6 +722,7 @@ avs_error_t anjay_attr_storage_restore(anjay_t *anjay_locked,
         if (avs_is_ok((err = _anjay_attr_storage_restore_inner(anjay, in)))) {
             _anjay_attr_storage_transaction_commit(anjay);
             anjay->attr_storage.modified_since_persist = false;
+            _anjay_attr_storage_journal_reset(&anjay->attr_storage, false);
 
             as_log(INFO, _("Attribute Storage state restored"));
         } else {
@@ -445,6 +737,66 @@ avs_error_t anjay_attr_storage_restore(anjay_t *anjay_locked,
     return err;
 }
 
+avs_error_t anjay_attr_storage_journal_append(anjay_t *anjay_locked,
+                                              avs_stream_t *out) {
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    anjay_attr_storage_t *as = &anjay->attr_storage;
+    const size_t entry_count =
+            as->journal_reset_needed ? 1 + AVS_LIST_SIZE(as->objects)
+                                     : AVS_LIST_SIZE(as->journal_dirty);
+    avs_stream_t *payload = NULL;
+    if (!entry_count) {
+        err = AVS_OK;
+    } else if (!(payload = avs_stream_membuf_create())) {
+        _anjay_log_oom();
+        err = avs_errno(AVS_ENOMEM);
+    } else {
+        (void) (avs_is_err((err = journal_serialize(as, payload,
+                                                    (uint32_t) entry_count)))
+                || avs_is_err(
+                           (err = _anjay_journal_write_record(out, payload))));
+        avs_stream_cleanup(&payload);
+    }
+    if (avs_is_ok(err)) {
+        as->modified_since_persist = false;
+        _anjay_attr_storage_journal_reset(as, false);
+        as_log(DEBUG, _("Attribute Storage journal appended"));
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+avs_error_t anjay_attr_storage_journal_restore(anjay_t *anjay_locked,
+                                               avs_stream_t *in,
+                                               avs_stream_t *journal) {
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    if (avs_is_ok((err = _anjay_attr_storage_transaction_begin(anjay)))) {
+        _anjay_attr_storage_clear(&anjay->attr_storage);
+        if ((in && avs_is_err((err = restore_snapshot(&anjay->attr_storage,
+                                                      in))))
+                || avs_is_err((err = journal_replay(&anjay->attr_storage,
+                                                    journal)))
+                || avs_is_err((err = clear_nonexistent_entries(
+                                       anjay, &anjay->attr_storage)))) {
+            avs_error_t rollback_err =
+                    _anjay_attr_storage_transaction_rollback(anjay);
+            if (avs_is_err(rollback_err)) {
+                err = rollback_err;
+            }
+        } else {
+            _anjay_attr_storage_transaction_commit(anjay);
+            anjay->attr_storage.modified_since_persist = false;
+            _anjay_attr_storage_journal_reset(&anjay->attr_storage, false);
+
+            as_log(INFO, _("Attribute Storage state restored from journal"));
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
 #    ifdef ANJAY_TEST
 #        include "tests/core/attr_storage/persistence.c"
 #    endif // ANJAY_TEST
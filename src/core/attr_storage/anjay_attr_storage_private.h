@@ -90,8 +90,25 @@ int _anjay_attr_storage_remove_absent_resource_instances(
 
 static inline void _anjay_attr_storage_mark_modified(anjay_attr_storage_t *as) {
     as->modified_since_persist = true;
+    ++as->modification_count;
 }
 
+/**
+ * Records that the entry identified by @p oid and @p iid (or the whole Object
+ * entry, if @p iid is ANJAY_ID_INVALID) needs to be written to the journal on
+ * the next call to anjay_attr_storage_journal_append().
+ */
+void _anjay_attr_storage_journal_mark(anjay_attr_storage_t *as,
+                                      anjay_oid_t oid,
+                                      anjay_iid_t iid);
+
+/**
+ * Forgets all journal bookkeeping. If @p reset_needed is true, the next
+ * journal append will rewrite the whole Attribute Storage state.
+ */
+void _anjay_attr_storage_journal_reset(anjay_attr_storage_t *as,
+                                       bool reset_needed);
+
 #ifdef ANJAY_WITH_LWM2M11
 static void remove_resource_instance_entry(
         anjay_attr_storage_t *as,
@@ -134,6 +151,12 @@ static void remove_object_entry(anjay_attr_storage_t *as,
     _anjay_attr_storage_mark_modified(as);
 }
 
+static void remove_instance_if_empty(AVS_LIST(as_instance_entry_t) *entry_ptr) {
+    if (!(*entry_ptr)->default_attrs && !(*entry_ptr)->resources) {
+        AVS_LIST_DELETE(entry_ptr);
+    }
+}
+
 static void remove_object_if_empty(AVS_LIST(as_object_entry_t) *entry_ptr) {
     if (!(*entry_ptr)->default_attrs && !(*entry_ptr)->instances) {
         AVS_LIST_DELETE(entry_ptr);
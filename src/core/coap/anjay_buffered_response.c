@@ -0,0 +1,115 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#ifdef ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES
+
+#    include <assert.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_stream_membuf.h>
+#    include <avsystem/commons/avs_utils.h>
+
+#    include <anjay/core.h>
+
+#    include "anjay_buffered_response.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+typedef struct {
+    void *data;
+    size_t size;
+} response_payload_t;
+
+static int payload_writer(size_t payload_offset,
+                          void *payload_buf,
+                          size_t payload_buf_size,
+                          size_t *out_payload_chunk_size,
+                          void *payload_) {
+    const response_payload_t *payload = (const response_payload_t *) payload_;
+    assert(payload_offset <= payload->size);
+    *out_payload_chunk_size =
+            AVS_MIN(payload_buf_size, payload->size - payload_offset);
+    if (*out_payload_chunk_size) {
+        memcpy(payload_buf, (const char *) payload->data + payload_offset,
+               *out_payload_chunk_size);
+    }
+    return 0;
+}
+
+static void payload_cleanup(void *payload_) {
+    response_payload_t *payload = (response_payload_t *) payload_;
+    avs_free(payload->data);
+    avs_free(payload);
+}
+
+avs_stream_t *_anjay_coap_setup_buffered_response(
+        avs_coap_streaming_request_ctx_t *request_ctx,
+        const anjay_msg_details_t *details) {
+    (void) request_ctx;
+    (void) details;
+    avs_stream_t *stream = avs_stream_membuf_create();
+    if (!stream) {
+        _anjay_log_oom();
+    }
+    return stream;
+}
+
+static int send_payload(avs_coap_streaming_request_ctx_t *request_ctx,
+                        const anjay_msg_details_t *details,
+                        response_payload_t *payload) {
+    avs_coap_response_header_t response;
+    if (avs_is_err(_anjay_coap_fill_response_header(&response, details))) {
+        payload_cleanup(payload);
+        return ANJAY_ERR_INTERNAL;
+    }
+    int result = 0;
+    if (avs_is_err(avs_coap_streaming_setup_async_response(
+                request_ctx, &response, payload_writer, payload,
+                payload_cleanup))) {
+        // fall back to sending the payload in the usual, blocking way
+        avs_stream_t *stream =
+                avs_coap_streaming_setup_response(request_ctx, &response);
+        if (!stream
+                || avs_is_err(avs_stream_write(stream, payload->data,
+                                               payload->size))) {
+            result = ANJAY_ERR_INTERNAL;
+        }
+        payload_cleanup(payload);
+    }
+    avs_coap_options_cleanup(&response.options);
+    return result;
+}
+
+int _anjay_coap_finish_buffered_response(
+        avs_coap_streaming_request_ctx_t *request_ctx,
+        const anjay_msg_details_t *details,
+        avs_stream_t **stream_ptr,
+        int result) {
+    response_payload_t *payload = NULL;
+    if (!result) {
+        if (!(payload = (response_payload_t *) avs_calloc(1, sizeof(*payload)))
+                || avs_is_err(avs_stream_membuf_take_ownership(
+                           *stream_ptr, &payload->data, &payload->size))) {
+            _anjay_log_oom();
+            avs_free(payload);
+            payload = NULL;
+            result = ANJAY_ERR_INTERNAL;
+        }
+    }
+    avs_stream_cleanup(stream_ptr);
+    if (result) {
+        return result;
+    }
+    return send_payload(request_ctx, details, payload);
+}
+
+#endif // ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_COAP_BUFFERED_RESPONSE_H
+#define ANJAY_COAP_BUFFERED_RESPONSE_H
+
+#include "anjay_msg_details.h"
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#ifdef ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES
+/**
+ * Returns a stream into which the whole response payload shall be written,
+ * before passing it to @ref _anjay_coap_finish_buffered_response. Nothing is
+ * sent until then, so that the remaining BLOCK2 chunks may be served from the
+ * event loop, without blocking the request handler.
+ */
+avs_stream_t *_anjay_coap_setup_buffered_response(
+        avs_coap_streaming_request_ctx_t *request_ctx,
+        const anjay_msg_details_t *details);
+
+/**
+ * Sets up the response with the payload previously written into
+ * <c>*stream_ptr</c>, if @p result is 0, and releases the stream.
+ *
+ * @returns @p result, or an error code if the response could not be set up.
+ */
+int _anjay_coap_finish_buffered_response(
+        avs_coap_streaming_request_ctx_t *request_ctx,
+        const anjay_msg_details_t *details,
+        avs_stream_t **stream_ptr,
+        int result);
+#else // ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES
+static inline avs_stream_t *_anjay_coap_setup_buffered_response(
+        avs_coap_streaming_request_ctx_t *request_ctx,
+        const anjay_msg_details_t *details) {
+    return _anjay_coap_setup_response_stream(request_ctx, details);
+}
+
+static inline int _anjay_coap_finish_buffered_response(
+        avs_coap_streaming_request_ctx_t *request_ctx,
+        const anjay_msg_details_t *details,
+        avs_stream_t **stream_ptr,
+        int result) {
+    (void) request_ctx;
+    (void) details;
+    // the stream is owned by the CoAP context
+    *stream_ptr = NULL;
+    return result;
+}
+#endif // ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif // ANJAY_COAP_BUFFERED_RESPONSE_H
@@ -13,6 +13,10 @@
 
 #    include <inttypes.h>
 
+#    ifdef ANJAY_WITH_DISCOVER_CACHE
+#        include <avsystem/commons/avs_stream_membuf.h>
+#    endif // ANJAY_WITH_DISCOVER_CACHE
+
 #    include <anjay_modules/anjay_time_defs.h>
 
 #    include "anjay_discover.h"
@@ -423,6 +427,235 @@ static int discover_object(anjay_unlocked_t *anjay,
     return result;
 }
 
+typedef struct {
+    anjay_uri_path_t uri;
+    uint8_t depth;
+    anjay_ssid_t ssid;
+    anjay_lwm2m_version_t lwm2m_version;
+    bool bootstrap;
+    // only meaningful for Resource paths; not a part of the cache key, as it
+    // is determined by the path itself
+    anjay_dm_resource_kind_t kind;
+} discover_target_t;
+
+typedef int discover_impl_t(anjay_unlocked_t *anjay,
+                            avs_stream_t *stream,
+                            const anjay_dm_installed_object_t *obj,
+                            const discover_target_t *target);
+
+#    ifdef ANJAY_WITH_DISCOVER_CACHE
+// Discover is usually repeated on a small set of paths after each
+// registration, so there is no need to keep more entries
+#        define DISCOVER_CACHE_MAX_ENTRIES 16
+
+struct anjay_discover_cache_entry_struct {
+    discover_target_t target;
+#        ifdef ANJAY_WITH_ATTR_STORAGE
+    uint32_t attr_storage_modification_count;
+#        endif // ANJAY_WITH_ATTR_STORAGE
+    void *payload;
+    size_t payload_size;
+};
+
+static bool target_equal(const discover_target_t *left,
+                         const discover_target_t *right) {
+    return left->bootstrap == right->bootstrap && left->ssid == right->ssid
+           && left->depth == right->depth
+           && left->lwm2m_version == right->lwm2m_version
+           && _anjay_uri_path_equal(&left->uri, &right->uri);
+}
+
+static bool queue_affects_object(anjay_notify_queue_t queue, anjay_oid_t oid) {
+    if (oid == ANJAY_ID_INVALID) {
+        return !!queue;
+    }
+    AVS_LIST(anjay_notify_queue_object_entry_t) it;
+    AVS_LIST_FOREACH(it, queue) {
+        if (it->oid >= oid) {
+            return it->oid == oid;
+        }
+    }
+    return false;
+}
+
+static bool cache_entry_valid(anjay_unlocked_t *anjay,
+                              const anjay_discover_cache_entry_t *entry) {
+#        ifdef ANJAY_WITH_ATTR_STORAGE
+    if (entry->attr_storage_modification_count
+            != anjay->attr_storage.modification_count) {
+        return false;
+    }
+#        endif // ANJAY_WITH_ATTR_STORAGE
+    // changes that are already queued, but not yet flushed, make the entry
+    // stale as well
+    const anjay_oid_t oid = entry->target.uri.ids[ANJAY_ID_OID];
+    if (queue_affects_object(anjay->scheduled_notify.queue, oid)) {
+        return false;
+    }
+#        ifdef ANJAY_WITH_BOOTSTRAP
+    if (queue_affects_object(anjay->bootstrap.notification_queue, oid)) {
+        return false;
+    }
+#        endif // ANJAY_WITH_BOOTSTRAP
+    return true;
+}
+
+static void
+cache_entry_delete(AVS_LIST(anjay_discover_cache_entry_t) *entry_ptr) {
+    avs_free((*entry_ptr)->payload);
+    AVS_LIST_DELETE(entry_ptr);
+}
+
+static AVS_LIST(anjay_discover_cache_entry_t)
+cache_find(anjay_unlocked_t *anjay, const discover_target_t *target) {
+    AVS_LIST(anjay_discover_cache_entry_t) *entry_ptr;
+    AVS_LIST_FOREACH_PTR(entry_ptr, &anjay->discover_cache.entries) {
+        if (target_equal(&(*entry_ptr)->target, target)) {
+            if (!cache_entry_valid(anjay, *entry_ptr)) {
+                cache_entry_delete(entry_ptr);
+                return NULL;
+            }
+            // move to front, so that the least recently used entries are
+            // evicted first
+            AVS_LIST(anjay_discover_cache_entry_t) entry =
+                    AVS_LIST_DETACH(entry_ptr);
+            AVS_LIST_INSERT(&anjay->discover_cache.entries, entry);
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static void cache_insert(anjay_unlocked_t *anjay,
+                         const discover_target_t *target,
+                         void *payload,
+                         size_t payload_size) {
+    AVS_LIST(anjay_discover_cache_entry_t) entry =
+            AVS_LIST_NEW_ELEMENT(anjay_discover_cache_entry_t);
+    if (!entry) {
+        avs_free(payload);
+        return;
+    }
+    entry->target = *target;
+#        ifdef ANJAY_WITH_ATTR_STORAGE
+    entry->attr_storage_modification_count =
+            anjay->attr_storage.modification_count;
+#        endif // ANJAY_WITH_ATTR_STORAGE
+    entry->payload = payload;
+    entry->payload_size = payload_size;
+    AVS_LIST_INSERT(&anjay->discover_cache.entries, entry);
+
+    size_t count = 0;
+    AVS_LIST(anjay_discover_cache_entry_t) *entry_ptr =
+            &anjay->discover_cache.entries;
+    while (*entry_ptr) {
+        if (++count > DISCOVER_CACHE_MAX_ENTRIES) {
+            cache_entry_delete(entry_ptr);
+        } else {
+            AVS_LIST_ADVANCE_PTR(&entry_ptr);
+        }
+    }
+}
+
+static int perform_discover(anjay_unlocked_t *anjay,
+                            avs_stream_t *stream,
+                            const anjay_dm_installed_object_t *obj,
+                            const discover_target_t *target,
+                            discover_impl_t *impl) {
+    const anjay_discover_cache_entry_t *entry = cache_find(anjay, target);
+    if (entry) {
+        return avs_is_ok(avs_stream_write(stream, entry->payload,
+                                          entry->payload_size))
+                       ? 0
+                       : -1;
+    }
+
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    if (!membuf) {
+        _anjay_log_oom();
+        return impl(anjay, stream, obj, target);
+    }
+    void *payload = NULL;
+    size_t payload_size = 0;
+    int result = impl(anjay, membuf, obj, target);
+    if (!result
+            && (avs_is_err(avs_stream_membuf_take_ownership(membuf, &payload,
+                                                            &payload_size))
+                || avs_is_err(avs_stream_write(stream, payload,
+                                               payload_size)))) {
+        result = -1;
+    }
+    avs_stream_cleanup(&membuf);
+    if (result) {
+        avs_free(payload);
+    } else {
+        cache_insert(anjay, target, payload, payload_size);
+    }
+    return result;
+}
+
+void _anjay_discover_cache_invalidate(anjay_unlocked_t *anjay,
+                                      anjay_oid_t oid) {
+    AVS_LIST(anjay_discover_cache_entry_t) *entry_ptr =
+            &anjay->discover_cache.entries;
+    while (*entry_ptr) {
+        const anjay_oid_t entry_oid =
+                (*entry_ptr)->target.uri.ids[ANJAY_ID_OID];
+        // root path entries (Bootstrap-Discover on /) cover all Objects
+        if (oid == ANJAY_ID_INVALID || entry_oid == ANJAY_ID_INVALID
+                || entry_oid == oid) {
+            cache_entry_delete(entry_ptr);
+        } else {
+            AVS_LIST_ADVANCE_PTR(&entry_ptr);
+        }
+    }
+}
+
+void _anjay_discover_cache_cleanup(anjay_discover_cache_t *cache) {
+    while (cache->entries) {
+        cache_entry_delete(&cache->entries);
+    }
+}
+#    else  // ANJAY_WITH_DISCOVER_CACHE
+static int perform_discover(anjay_unlocked_t *anjay,
+                            avs_stream_t *stream,
+                            const anjay_dm_installed_object_t *obj,
+                            const discover_target_t *target,
+                            discover_impl_t *impl) {
+    return impl(anjay, stream, obj, target);
+}
+#    endif // ANJAY_WITH_DISCOVER_CACHE
+
+static int discover_path(anjay_unlocked_t *anjay,
+                         avs_stream_t *stream,
+                         const anjay_dm_installed_object_t *obj,
+                         const discover_target_t *target) {
+    const anjay_id_type_t root_path_type =
+            (anjay_id_type_t) (_anjay_uri_path_length(&target->uri) - 1);
+    const anjay_id_type_t leaf_path_type = (anjay_id_type_t) AVS_MIN(
+            root_path_type + target->depth, ANJAY_ID_RIID);
+    switch (root_path_type) {
+    case ANJAY_ID_OID:
+        return discover_object(anjay, stream, obj, target->ssid,
+                               target->lwm2m_version, root_path_type,
+                               leaf_path_type);
+    case ANJAY_ID_IID:
+        return discover_instance(anjay, stream, obj,
+                                 target->uri.ids[ANJAY_ID_IID], target->ssid,
+                                 target->lwm2m_version, root_path_type,
+                                 leaf_path_type);
+    case ANJAY_ID_RID:
+        return discover_resource(anjay, stream, obj,
+                                 target->uri.ids[ANJAY_ID_IID],
+                                 target->uri.ids[ANJAY_ID_RID], target->ssid,
+                                 target->lwm2m_version, target->kind,
+                                 root_path_type, leaf_path_type);
+    default:
+        AVS_UNREACHABLE("invalid Discover path");
+        return -1;
+    }
+}
+
 int _anjay_discover(anjay_unlocked_t *anjay,
                     avs_stream_t *stream,
                     const anjay_dm_installed_object_t *obj,
@@ -433,10 +666,15 @@ int _anjay_discover(anjay_unlocked_t *anjay,
                     anjay_lwm2m_version_t lwm2m_version) {
     assert(obj);
 
+    const anjay_oid_t oid = _anjay_dm_installed_object_oid(obj);
+    discover_target_t target = {
+        .uri = MAKE_OBJECT_PATH(oid),
+        .depth = depth,
+        .ssid = ssid,
+        .lwm2m_version = lwm2m_version
+    };
     if (iid == ANJAY_ID_INVALID) {
-        return discover_object(
-                anjay, stream, obj, ssid, lwm2m_version, ANJAY_ID_OID,
-                (anjay_id_type_t) AVS_MIN(ANJAY_ID_OID + depth, ANJAY_ID_RIID));
+        return perform_discover(anjay, stream, obj, &target, discover_path);
     }
 
     int result = _anjay_dm_verify_instance_present(anjay, obj, iid);
@@ -445,7 +683,7 @@ int _anjay_discover(anjay_unlocked_t *anjay,
     }
 
     const anjay_action_info_t info = {
-        .oid = _anjay_dm_installed_object_oid(obj),
+        .oid = oid,
         .iid = iid,
         .ssid = ssid,
         .action = ANJAY_ACTION_DISCOVER
@@ -455,21 +693,17 @@ int _anjay_discover(anjay_unlocked_t *anjay,
     }
 
     if (rid == ANJAY_ID_INVALID) {
-        return discover_instance(
-                anjay, stream, obj, iid, ssid, lwm2m_version, ANJAY_ID_IID,
-                (anjay_id_type_t) AVS_MIN(ANJAY_ID_IID + depth, ANJAY_ID_RIID));
+        target.uri = MAKE_INSTANCE_PATH(oid, iid);
+        return perform_discover(anjay, stream, obj, &target, discover_path);
     }
 
-    anjay_dm_resource_kind_t kind;
     if ((result = _anjay_dm_verify_resource_present(anjay, obj, iid, rid,
-                                                    &kind))) {
+                                                    &target.kind))) {
         return result;
     }
 
-    return discover_resource(anjay, stream, obj, iid, rid, ssid, lwm2m_version,
-                             kind, ANJAY_ID_RID,
-                             (anjay_id_type_t) AVS_MIN(ANJAY_ID_RID + depth,
-                                                       ANJAY_ID_RIID));
+    target.uri = MAKE_RESOURCE_PATH(oid, iid, rid);
+    return perform_discover(anjay, stream, obj, &target, discover_path);
 }
 
 #    ifdef ANJAY_WITH_BOOTSTRAP
@@ -589,24 +823,17 @@ static int bootstrap_discover_object(anjay_unlocked_t *anjay,
     return result;
 }
 
-int _anjay_bootstrap_discover(anjay_unlocked_t *anjay,
-                              avs_stream_t *stream,
-                              anjay_oid_t oid,
-                              anjay_lwm2m_version_t lwm2m_version) {
-    const anjay_dm_installed_object_t *obj = NULL;
-    if (oid != ANJAY_ID_INVALID) {
-        obj = _anjay_dm_find_object_by_oid(&anjay->dm, oid);
-        if (!obj) {
-            return ANJAY_ERR_NOT_FOUND;
-        }
-    }
-    int result = print_enabler_version(stream, lwm2m_version);
+static int bootstrap_discover_path(anjay_unlocked_t *anjay,
+                                   avs_stream_t *stream,
+                                   const anjay_dm_installed_object_t *obj,
+                                   const discover_target_t *target) {
+    int result = print_enabler_version(stream, target->lwm2m_version);
     if (result) {
         return result;
     }
     bootstrap_discover_object_args_t args = {
         .stream = stream,
-        .lwm2m_version = lwm2m_version
+        .lwm2m_version = target->lwm2m_version
     };
     if (obj) {
         return bootstrap_discover_object(anjay, obj, &args);
@@ -615,6 +842,27 @@ int _anjay_bootstrap_discover(anjay_unlocked_t *anjay,
                                         bootstrap_discover_object, &args);
     }
 }
+
+int _anjay_bootstrap_discover(anjay_unlocked_t *anjay,
+                              avs_stream_t *stream,
+                              anjay_oid_t oid,
+                              anjay_lwm2m_version_t lwm2m_version) {
+    const anjay_dm_installed_object_t *obj = NULL;
+    if (oid != ANJAY_ID_INVALID) {
+        obj = _anjay_dm_find_object_by_oid(&anjay->dm, oid);
+        if (!obj) {
+            return ANJAY_ERR_NOT_FOUND;
+        }
+    }
+    const discover_target_t target = {
+        .uri = obj ? MAKE_OBJECT_PATH(oid) : MAKE_ROOT_PATH(),
+        .ssid = ANJAY_SSID_BOOTSTRAP,
+        .lwm2m_version = lwm2m_version,
+        .bootstrap = true
+    };
+    return perform_discover(anjay, stream, obj, &target,
+                            bootstrap_discover_path);
+}
 #    endif
 
 #endif // ANJAY_WITH_DISCOVER
@@ -70,6 +70,26 @@ int _anjay_bootstrap_discover(anjay_unlocked_t *anjay,
                               anjay_lwm2m_version_t lwm2m_version);
 #    endif // ANJAY_WITH_BOOTSTRAP
 
+#    ifdef ANJAY_WITH_DISCOVER_CACHE
+typedef struct anjay_discover_cache_entry_struct anjay_discover_cache_entry_t;
+
+/**
+ * Payloads of recently performed Discover and Bootstrap-Discover operations,
+ * most recently used first.
+ */
+typedef struct {
+    AVS_LIST(anjay_discover_cache_entry_t) entries;
+} anjay_discover_cache_t;
+
+/**
+ * Drops cached payloads that may include data from the Object @p oid, or all of
+ * them if @p oid is ANJAY_ID_INVALID.
+ */
+void _anjay_discover_cache_invalidate(anjay_unlocked_t *anjay, anjay_oid_t oid);
+
+void _anjay_discover_cache_cleanup(anjay_discover_cache_t *cache);
+#    endif // ANJAY_WITH_DISCOVER_CACHE
+
 #endif // ANJAY_WITH_DISCOVER
 
 VISIBILITY_PRIVATE_HEADER_END
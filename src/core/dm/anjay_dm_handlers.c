@@ -670,8 +670,12 @@ bool _anjay_dm_handler_implemented(const anjay_dm_installed_object_t *obj_ptr,
         const anjay_unlocked_dm_handlers_t *handler =                         \
                 get_handler((ObjPtr), ANJAY_DM_HANDLER_##HandlerName);        \
         if (handler) {                                                        \
+            ANJAY_INSTR_START(AVS_CONCAT(start, __LINE__));                   \
             int AVS_CONCAT(result, __LINE__) =                                \
                     handler->HandlerName(__VA_ARGS__);                        \
+            _anjay_instr_record_object(                                       \
+                    anjay, _anjay_dm_installed_object_oid(ObjPtr),            \
+                    AVS_CONCAT(start, __LINE__));                             \
             if (AVS_CONCAT(result, __LINE__)) {                               \
                 dm_log(DEBUG, #HandlerName _(" failed with code ") "%d (%s)", \
                        AVS_CONCAT(result, __LINE__),                          \
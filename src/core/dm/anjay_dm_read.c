@@ -16,6 +16,8 @@
 #include "anjay_dm_read.h"
 
 #include "../anjay_access_utils_private.h"
+#include "../anjay_instrumentation.h"
+#include "../coap/anjay_buffered_response.h"
 #include "../coap/anjay_content_format.h"
 #include "../io/anjay_vtable.h"
 
@@ -324,6 +326,77 @@ int _anjay_dm_read_and_destroy_ctx(anjay_unlocked_t *anjay,
                                         *out_ctx_ptr));
 }
 
+#ifdef ANJAY_WITH_TLV_TWO_PASS_READ
+typedef struct {
+    anjay_unlocked_t *anjay;
+    const anjay_dm_installed_object_t *obj;
+    const anjay_dm_path_info_t *path_info;
+    anjay_ssid_t requesting_ssid;
+} read_feed_args_t;
+
+static int read_feed(anjay_unlocked_output_ctx_t *out_ctx, void *args_) {
+    const read_feed_args_t *args = (const read_feed_args_t *) args_;
+    return _anjay_dm_read(args->anjay, args->obj, args->path_info,
+                          args->requesting_ssid, out_ctx);
+}
+
+/**
+ * Performs a Read with TLV lengths computed in a separate pass over the data
+ * model, so that Object Instances do not need to be buffered in memory. This
+ * requires the read handlers to return the same data in both passes. If they
+ * do not, the Read is repeated using the buffering encoder - which is possible,
+ * because ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES guarantees that nothing is sent
+ * before the whole response is generated.
+ */
+static int read_precomputed_and_destroy_ctx(
+        anjay_unlocked_t *anjay,
+        const anjay_dm_installed_object_t *obj,
+        const anjay_dm_path_info_t *path_info,
+        anjay_ssid_t requesting_ssid,
+        avs_stream_t *response_stream,
+        const anjay_request_t *request,
+        uint16_t format,
+        anjay_unlocked_output_ctx_t **out_ctx_ptr) {
+    read_feed_args_t args = {
+        .anjay = anjay,
+        .obj = obj,
+        .path_info = path_info,
+        .requesting_ssid = requesting_ssid
+    };
+    int result =
+            _anjay_output_tlv_precompute_lengths(*out_ctx_ptr, read_feed,
+                                                 &args);
+    if (result) {
+        _anjay_output_ctx_destroy(out_ctx_ptr);
+        return result;
+    }
+    dm_log(LAZY_DEBUG, _("Read ") "%s", ANJAY_DEBUG_MAKE_PATH(&path_info->uri));
+    if ((result = _anjay_dm_read(anjay, obj, path_info, requesting_ssid,
+                                 *out_ctx_ptr))
+            && (*out_ctx_ptr)->error != ANJAY_OUTCTXERR_TLV_LENGTH_MISMATCH) {
+        // the handler failed on its own; the structure left incomplete by it
+        // is not a mismatch worth retrying
+        _anjay_output_ctx_destroy(out_ctx_ptr);
+        return result;
+    }
+    if ((result = _anjay_output_ctx_destroy_and_process_result(out_ctx_ptr,
+                                                               result))
+                    != ANJAY_OUTCTXERR_TLV_LENGTH_MISMATCH
+            || avs_is_err(avs_stream_reset(response_stream))) {
+        return result;
+    }
+    dm_log(DEBUG, _("data changed between TLV Read passes, retrying with "
+                    "buffering"));
+    if (!(result = _anjay_output_dynamic_construct(
+                  out_ctx_ptr, response_stream, &request->uri, format, NULL,
+                  ANJAY_ACTION_READ))) {
+        result = _anjay_dm_read_and_destroy_ctx(anjay, obj, path_info,
+                                                requesting_ssid, out_ctx_ptr);
+    }
+    return result;
+}
+#endif // ANJAY_WITH_TLV_TWO_PASS_READ
+
 anjay_msg_details_t
 _anjay_dm_response_details_for_read(anjay_unlocked_t *anjay,
                                     const anjay_request_t *request,
@@ -375,20 +448,29 @@ int _anjay_dm_read_or_observe(anjay_connection_ref_t connection,
             _anjay_server_registration_info(connection.server)->lwm2m_version);
 
     avs_stream_t *response_stream =
-            _anjay_coap_setup_response_stream(request->ctx, &details);
+            _anjay_coap_setup_buffered_response(request->ctx, &details);
     if (!response_stream) {
         return ANJAY_ERR_INTERNAL;
     }
 
+    ANJAY_INSTR_START(start);
     anjay_unlocked_output_ctx_t *out_ctx = NULL;
-    if ((result = _anjay_output_dynamic_construct(&out_ctx, response_stream,
-                                                  &request->uri, details.format,
-                                                  NULL, ANJAY_ACTION_READ))) {
-        return result;
-    }
-    return _anjay_dm_read_and_destroy_ctx(anjay, obj, &path_info,
-                                          _anjay_server_ssid(connection.server),
-                                          &out_ctx);
+    if (!(result = _anjay_output_dynamic_construct(
+                  &out_ctx, response_stream, &request->uri, details.format,
+                  NULL, ANJAY_ACTION_READ))) {
+#ifdef ANJAY_WITH_TLV_TWO_PASS_READ
+        result = read_precomputed_and_destroy_ctx(
+                anjay, obj, &path_info, _anjay_server_ssid(connection.server),
+                response_stream, request, details.format, &out_ctx);
+#else  // ANJAY_WITH_TLV_TWO_PASS_READ
+        result = _anjay_dm_read_and_destroy_ctx(
+                anjay, obj, &path_info, _anjay_server_ssid(connection.server),
+                &out_ctx);
+#endif // ANJAY_WITH_TLV_TWO_PASS_READ
+    }
+    _anjay_instr_record(anjay, ANJAY_INSTR_PROBE_SERIALIZATION, start);
+    return _anjay_coap_finish_buffered_response(request->ctx, &details,
+                                                &response_stream, result);
 }
 
 int _anjay_dm_read_resource_into_ctx(anjay_unlocked_t *anjay,
@@ -584,8 +666,9 @@ int _anjay_dm_read_or_observe_composite(anjay_connection_ref_t connection,
                 _anjay_server_registration_info(connection.server)
                         ->lwm2m_version);
         avs_stream_t *response_stream =
-                _anjay_coap_setup_response_stream(request->ctx, &details);
+                _anjay_coap_setup_buffered_response(request->ctx, &details);
         if (!response_stream) {
+            AVS_LIST_CLEAR(&cached_paths);
             return ANJAY_ERR_INTERNAL;
         }
 
@@ -636,6 +719,8 @@ int _anjay_dm_read_or_observe_composite(anjay_connection_ref_t connection,
             }
         }
         result = _anjay_output_ctx_destroy_and_process_result(&out_ctx, result);
+        result = _anjay_coap_finish_buffered_response(
+                request->ctx, &details, &response_stream, result);
     }
     AVS_LIST_CLEAR(&cached_paths);
     return result;
@@ -244,6 +244,12 @@ int _anjay_dm_write_attributes(anjay_unlocked_t *anjay,
         result = dm_write_object_attrs(anjay, obj, ssid, &request->attributes);
     }
 #ifdef ANJAY_WITH_OBSERVE
+#    ifdef ANJAY_WITH_OBSERVE_ATTRS_CACHE
+    // some of the attributes might have been written even if it failed;
+    // attributes are only inherited within the same Object
+    _anjay_observe_attrs_cache_invalidate_object(anjay,
+                                                 request->uri.ids[ANJAY_ID_OID]);
+#    endif // ANJAY_WITH_OBSERVE_ATTRS_CACHE
     if (!result) {
         // verify that new attributes are "seen" by the observe code
         result = _anjay_observe_notify(anjay, &request->uri, ssid, false);
@@ -51,6 +51,11 @@ typedef struct {
         struct {
             const void *data;
             size_t length;
+            // called when the entry is cleaned up; avs_free for data
+            // allocated by the batch builder itself, or the user-provided
+            // function for buffers passed to anjay_ret_bytes_borrowed()
+            anjay_ret_bytes_release_t *release;
+            void *release_arg;
         } bytes;
         const char *string;
         int64_t int_value;
@@ -130,8 +135,9 @@ static int make_data_with_duplicated_string(anjay_batch_data_t *batch_data,
 static void batch_data_cleanup(anjay_batch_data_t *data) {
     if (data->type == ANJAY_BATCH_DATA_STRING) {
         avs_free((void *) (intptr_t) data->value.string);
-    } else if (data->type == ANJAY_BATCH_DATA_BYTES) {
-        avs_free((void *) (intptr_t) data->value.bytes.data);
+    } else if (data->type == ANJAY_BATCH_DATA_BYTES
+               && data->value.bytes.release) {
+        data->value.bytes.release(data->value.bytes.release_arg);
     }
 }
 
@@ -247,7 +253,9 @@ static int make_data_with_duplicated_bytes(anjay_batch_data_t *batch_data,
         .value = {
             .bytes = {
                 .data = new_data,
-                .length = length
+                .length = length,
+                .release = avs_free,
+                .release_arg = new_data
             }
         }
     };
@@ -446,12 +454,14 @@ static int bytes_begin(anjay_unlocked_output_ctx_t *ctx_,
         .type = ANJAY_BATCH_DATA_BYTES,
         .value.bytes = {
             .data = buf,
-            .length = length
+            .length = length,
+            .release = avs_free,
+            .release_arg = buf
         }
     };
 
+    // buf is freed by batch_data_add() on failure
     if (batch_data_add(ctx->builder, &ctx->path, ctx->timestamp, data)) {
-        avs_free(buf);
         return -1;
     }
 
@@ -464,6 +474,39 @@ static int bytes_begin(anjay_unlocked_output_ctx_t *ctx_,
     return 0;
 }
 
+static int bytes_borrowed(anjay_unlocked_output_ctx_t *ctx_,
+                          const void *data,
+                          size_t length,
+                          anjay_ret_bytes_release_t *release,
+                          void *release_arg) {
+    builder_out_ctx_t *ctx = (builder_out_ctx_t *) ctx_;
+    if (ctx->bytes.remaining_bytes) {
+        batch_log(ERROR, _("bytes already being returned"));
+    } else if (_anjay_uri_path_has(&ctx->path, ANJAY_ID_RID)
+               && (data || !length)) {
+        anjay_batch_data_t batch_data = {
+            .type = ANJAY_BATCH_DATA_BYTES,
+            .value.bytes = {
+                .data = data,
+                .length = length,
+                .release = release,
+                .release_arg = release_arg
+            }
+        };
+        // batch_data_add() takes over the reference, even if it fails
+        if (batch_data_add(ctx->builder, &ctx->path, ctx->timestamp,
+                           batch_data)) {
+            return -1;
+        }
+        value_returned(ctx);
+        return 0;
+    }
+    if (release) {
+        release(release_arg);
+    }
+    return -1;
+}
+
 static int ret_string(anjay_unlocked_output_ctx_t *ctx_, const char *str) {
     builder_out_ctx_t *ctx = (builder_out_ctx_t *) ctx_;
     int result = -1;
@@ -593,6 +636,7 @@ static int output_close(anjay_unlocked_output_ctx_t *ctx_) {
 
 static const anjay_output_ctx_vtable_t BUILDER_OUT_VTABLE = {
     .bytes_begin = bytes_begin,
+    .bytes_borrowed = bytes_borrowed,
     .string = ret_string,
     .integer = ret_integer,
 #    ifdef ANJAY_WITH_LWM2M11
@@ -927,6 +971,158 @@ avs_time_real_t _anjay_batch_get_compilation_time(const anjay_batch_t *batch) {
     return batch->compilation_time;
 }
 
+#    if defined(ANJAY_WITH_SEND) && defined(AVS_COMMONS_WITH_AVS_PERSISTENCE)
+static avs_error_t persistence_time(avs_persistence_context_t *ctx,
+                                    avs_time_real_t *time) {
+    avs_error_t err;
+    (void) (avs_is_err((err = avs_persistence_i64(
+                                ctx, &time->since_real_epoch.seconds)))
+            || avs_is_err((err = avs_persistence_i32(
+                                   ctx, &time->since_real_epoch.nanoseconds))));
+    return err;
+}
+
+static avs_error_t persistence_path(avs_persistence_context_t *ctx,
+                                    anjay_uri_path_t *path) {
+    avs_error_t err = AVS_OK;
+    for (size_t i = 0; avs_is_ok(err) && i < AVS_ARRAY_SIZE(path->ids); ++i) {
+        err = avs_persistence_u16(ctx, &path->ids[i]);
+    }
+    return err;
+}
+
+static bool is_path_valid(const anjay_uri_path_t *path) {
+    size_t length = _anjay_uri_path_length(path);
+    for (size_t i = length; i < AVS_ARRAY_SIZE(path->ids); ++i) {
+        if (path->ids[i] != ANJAY_ID_INVALID) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static avs_error_t persistence_batch_data(avs_persistence_context_t *ctx,
+                                          anjay_batch_data_t *data) {
+    uint8_t type = (uint8_t) data->type;
+    avs_error_t err = avs_persistence_u8(ctx, &type);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    data->type = (anjay_batch_data_type_t) type;
+
+    switch (data->type) {
+    case ANJAY_BATCH_DATA_BYTES: {
+        void *bytes = (void *) (intptr_t) data->value.bytes.data;
+        size_t length = data->value.bytes.length;
+        if (avs_is_ok((err = avs_persistence_sized_buffer(ctx, &bytes,
+                                                          &length)))
+                && avs_persistence_direction(ctx)
+                               == AVS_PERSISTENCE_RESTORE) {
+            data->value.bytes.data = bytes;
+            data->value.bytes.length = length;
+            data->value.bytes.release = avs_free;
+            data->value.bytes.release_arg = bytes;
+        }
+        return err;
+    }
+    case ANJAY_BATCH_DATA_STRING: {
+        char *string = (char *) (intptr_t) data->value.string;
+        err = avs_persistence_string(ctx, &string);
+        data->value.string = string;
+        if (avs_is_ok(err) && !string) {
+            err = avs_errno(AVS_EBADMSG);
+        }
+        return err;
+    }
+    case ANJAY_BATCH_DATA_INT:
+        return avs_persistence_i64(ctx, &data->value.int_value);
+#        ifdef ANJAY_WITH_LWM2M11
+    case ANJAY_BATCH_DATA_UINT:
+        return avs_persistence_u64(ctx, &data->value.uint_value);
+#        endif // ANJAY_WITH_LWM2M11
+    case ANJAY_BATCH_DATA_DOUBLE:
+        return avs_persistence_double(ctx, &data->value.double_value);
+    case ANJAY_BATCH_DATA_BOOL:
+        return avs_persistence_bool(ctx, &data->value.bool_value);
+    case ANJAY_BATCH_DATA_OBJLNK:
+        (void) (avs_is_err((err = avs_persistence_u16(
+                                    ctx, &data->value.objlnk.oid)))
+                || avs_is_err((err = avs_persistence_u16(
+                                       ctx, &data->value.objlnk.iid))));
+        return err;
+    case ANJAY_BATCH_DATA_START_AGGREGATE:
+        return AVS_OK;
+    }
+    batch_log(WARNING, _("invalid persisted batch data type: ") "%u",
+              (unsigned) type);
+    // make sure that batch_data_cleanup() does not touch the value
+    data->type = ANJAY_BATCH_DATA_START_AGGREGATE;
+    return avs_errno(AVS_EBADMSG);
+}
+
+static avs_error_t persistence_batch_entry(avs_persistence_context_t *ctx,
+                                           void *entry_,
+                                           void *user_data) {
+    (void) user_data;
+    anjay_batch_entry_t *entry = (anjay_batch_entry_t *) entry_;
+    avs_error_t err;
+    (void) (avs_is_err((err = persistence_path(ctx, &entry->path)))
+            || avs_is_err((err = persistence_time(ctx, &entry->timestamp)))
+            || avs_is_err((err = persistence_batch_data(ctx, &entry->data))));
+    if (avs_is_ok(err)
+            && (!is_path_valid(&entry->path)
+                || (entry->data.type != ANJAY_BATCH_DATA_START_AGGREGATE
+                    && !_anjay_uri_path_has(&entry->path, ANJAY_ID_RID)))) {
+        err = avs_errno(AVS_EBADMSG);
+    }
+    return err;
+}
+
+avs_error_t _anjay_batch_persistence(avs_persistence_context_t *ctx,
+                                     anjay_batch_t **batch_ptr) {
+    assert(batch_ptr);
+    if (avs_persistence_direction(ctx) != AVS_PERSISTENCE_RESTORE) {
+        assert(*batch_ptr);
+        avs_error_t err;
+        (void) (avs_is_err((err = persistence_time(
+                                    ctx, &(*batch_ptr)->compilation_time)))
+                || avs_is_err((err = avs_persistence_list(
+                                       ctx,
+                                       (AVS_LIST(void) *) &(*batch_ptr)->list,
+                                       sizeof(anjay_batch_entry_t),
+                                       persistence_batch_entry, NULL,
+                                       batch_entry_cleanup))));
+        return err;
+    }
+
+    assert(!*batch_ptr);
+    avs_time_real_t compilation_time;
+    anjay_batch_builder_t *builder = _anjay_batch_builder_new();
+    if (!builder) {
+        _anjay_log_oom();
+        return avs_errno(AVS_ENOMEM);
+    }
+    avs_error_t err;
+    (void) (avs_is_err((err = persistence_time(ctx, &compilation_time)))
+            || avs_is_err((err = avs_persistence_list(
+                                   ctx, (AVS_LIST(void) *) &builder->list,
+                                   sizeof(anjay_batch_entry_t),
+                                   persistence_batch_entry, NULL,
+                                   batch_entry_cleanup))));
+    if (avs_is_ok(err)) {
+        if ((*batch_ptr = _anjay_batch_builder_compile(&builder))) {
+            (*batch_ptr)->compilation_time = compilation_time;
+        } else {
+            _anjay_log_oom();
+            err = avs_errno(AVS_ENOMEM);
+        }
+    }
+    _anjay_batch_builder_cleanup(&builder);
+    return err;
+}
+#    endif // defined(ANJAY_WITH_SEND) &&
+           // defined(AVS_COMMONS_WITH_AVS_PERSISTENCE)
+
 #    ifdef ANJAY_TEST
 #        include "tests/core/io/batch_builder.c"
 #        ifdef ANJAY_WITH_LWM2M11
@@ -12,6 +12,11 @@
 
 #include <anjay/anjay.h>
 
+#if defined(ANJAY_WITH_SEND) && defined(AVS_COMMONS_WITH_AVS_PERSISTENCE)
+#    include <avsystem/commons/avs_persistence.h>
+#endif // defined(ANJAY_WITH_SEND) &&
+       // defined(AVS_COMMONS_WITH_AVS_PERSISTENCE)
+
 #include "../anjay_dm_core.h"
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
@@ -293,6 +298,20 @@ int _anjay_batch_data_boolean_value(const anjay_batch_t *batch,
  */
 avs_time_real_t _anjay_batch_get_compilation_time(const anjay_batch_t *batch);
 
+#if defined(ANJAY_WITH_SEND) && defined(AVS_COMMONS_WITH_AVS_PERSISTENCE)
+/**
+ * Stores or restores contents of a batch, depending on the direction of
+ * @p ctx.
+ *
+ * When storing, @p *batch_ptr is the batch to store. When restoring,
+ * @p *batch_ptr must be NULL, and is set to a newly compiled batch (with
+ * refcount 1) on success.
+ */
+avs_error_t _anjay_batch_persistence(avs_persistence_context_t *ctx,
+                                     anjay_batch_t **batch_ptr);
+#endif // defined(ANJAY_WITH_SEND) &&
+       // defined(AVS_COMMONS_WITH_AVS_PERSISTENCE)
+
 #ifdef ANJAY_WITH_LWM2M11
 void _anjay_batch_update_common_path_prefix(const anjay_uri_path_t **prefix_ptr,
                                             anjay_uri_path_t *prefix_buf,
@@ -57,6 +57,12 @@ typedef struct {
     uint16_t next_id;
 
     tlv_bytes_t bytes_ctx;
+
+    // TLV_OUT_MODE_MEASURE: number of bytes serialized on this level so far.
+    // TLV_OUT_MODE_PRECOMPUTED: number of bytes still expected on this level.
+    size_t length;
+    // TLV_OUT_MODE_MEASURE: where to store the final length of this level.
+    size_t *length_slot;
 } tlv_out_level_t;
 
 typedef enum {
@@ -66,12 +72,30 @@ typedef enum {
     _TLV_OUT_LEVEL_LIMIT
 } tlv_out_level_id_t;
 
+typedef enum {
+    // Entries of nested levels are buffered in memory until each level is
+    // finished, as the TLV header needs to contain the length of its content.
+    TLV_OUT_MODE_BUFFERED,
+    // Nothing is written; lengths of nested levels are recorded instead.
+    TLV_OUT_MODE_MEASURE,
+    // Everything is written directly to the stream, using lengths of nested
+    // levels recorded in TLV_OUT_MODE_MEASURE.
+    TLV_OUT_MODE_PRECOMPUTED
+} tlv_out_mode_t;
+
 typedef struct tlv_out_struct {
     anjay_unlocked_output_ctx_t base;
     avs_stream_t *stream;
     anjay_uri_path_t root_path;
     tlv_out_level_t levels[_TLV_OUT_LEVEL_LIMIT];
     tlv_out_level_id_t level;
+
+    tlv_out_mode_t mode;
+    // Lengths of nested levels, in the order in which they are started
+    AVS_LIST(size_t) lengths;
+    AVS_LIST(size_t) *lengths_append_ptr;
+    // Set if the data differs from the measurement pass
+    bool length_mismatch;
 } tlv_out_t;
 
 static inline uint8_t u32_length(uint32_t value) {
@@ -172,6 +196,38 @@ static int get_current_level_value_type(tlv_out_t *ctx, tlv_id_type_t *out) {
     }
 }
 
+static int length_mismatch(tlv_out_t *ctx) {
+    ctx->length_mismatch = true;
+    return ANJAY_OUTCTXERR_TLV_LENGTH_MISMATCH;
+}
+
+/**
+ * Updates the length of the current nested level with @p size bytes of entries
+ * serialized on it. Does nothing at the root level, whose length is never
+ * written.
+ */
+static int account_nested_bytes(tlv_out_t *ctx, size_t size) {
+    tlv_out_level_id_t root_level;
+    if (get_root_level(&ctx->root_path, &root_level)) {
+        return -1;
+    }
+    if (ctx->level <= root_level) {
+        return 0;
+    }
+    tlv_out_level_t *level = current_level(ctx);
+    if (ctx->mode == TLV_OUT_MODE_MEASURE) {
+        level->length += size;
+    } else {
+        assert(ctx->mode == TLV_OUT_MODE_PRECOMPUTED);
+        if (size > level->length) {
+            // more data than during the measurement pass
+            return length_mismatch(ctx);
+        }
+        level->length -= size;
+    }
+    return 0;
+}
+
 static int write_entry(avs_stream_t *stream,
                        const tlv_id_t *id,
                        const void *buf,
@@ -251,6 +307,27 @@ static int buffered_bytes_append(anjay_unlocked_ret_bytes_ctx_t *ctx_,
     return retval;
 }
 
+static int measured_bytes_append(anjay_unlocked_ret_bytes_ctx_t *ctx_,
+                                 const void *data,
+                                 size_t length);
+
+static const anjay_ret_bytes_ctx_vtable_t MEASURED_BYTES_VTABLE = {
+    .append = measured_bytes_append
+};
+
+static int measured_bytes_append(anjay_unlocked_ret_bytes_ctx_t *ctx_,
+                                 const void *data,
+                                 size_t length) {
+    (void) data;
+    tlv_bytes_t *ctx = (tlv_bytes_t *) ctx_;
+    assert(ctx->vtable == &MEASURED_BYTES_VTABLE);
+    if (length > ctx->bytes_left) {
+        return -1;
+    }
+    ctx->bytes_left -= length;
+    return 0;
+}
+
 static anjay_unlocked_ret_bytes_ctx_t *
 add_entry(tlv_out_t *ctx, tlv_id_type_t type, size_t length) {
     tlv_out_level_t *out_level = current_level(ctx);
@@ -259,16 +336,33 @@ add_entry(tlv_out_t *ctx, tlv_id_type_t type, size_t length) {
             || get_root_level(&ctx->root_path, &root_level)) {
         return NULL;
     }
-    if (ctx->level > root_level) {
+    if (ctx->mode == TLV_OUT_MODE_BUFFERED && ctx->level > root_level) {
         if ((out_level->bytes_ctx.output.buffer_ptr =
                      add_buffered_entry(ctx, type, length))) {
             out_level->bytes_ctx.vtable = &BUFFERED_BYTES_VTABLE;
             out_level->bytes_ctx.bytes_left = length;
             return (anjay_unlocked_ret_bytes_ctx_t *) &out_level->bytes_ctx;
         }
+    } else if (ctx->mode == TLV_OUT_MODE_MEASURE) {
+        int retval = (out_level->next_id == ANJAY_ID_INVALID)
+                             ? -1
+                             : account_nested_bytes(
+                                       ctx,
+                                       header_size(out_level->next_id, length)
+                                               + length);
+        out_level->next_id = ANJAY_ID_INVALID;
+        if (!retval) {
+            out_level->bytes_ctx.vtable = &MEASURED_BYTES_VTABLE;
+            out_level->bytes_ctx.bytes_left = length;
+            return (anjay_unlocked_ret_bytes_ctx_t *) &out_level->bytes_ctx;
+        }
     } else {
-        int retval =
-                write_header(ctx->stream, type, out_level->next_id, length);
+        int retval = account_nested_bytes(
+                ctx, header_size(out_level->next_id, length) + length);
+        if (!retval) {
+            retval = write_header(ctx->stream, type, out_level->next_id,
+                                  length);
+        }
         out_level->next_id = ANJAY_ID_INVALID;
         if (!retval) {
             out_level->bytes_ctx.vtable = &STREAMED_BYTES_VTABLE;
@@ -289,7 +383,8 @@ static int tlv_ret_bytes(anjay_unlocked_output_ctx_t *ctx_,
     if (!result) {
         *out_bytes_ctx = add_entry(ctx, current_level_value_type, length);
         if (!*out_bytes_ctx) {
-            result = -1;
+            result = ctx->length_mismatch ? ANJAY_OUTCTXERR_TLV_LENGTH_MISMATCH
+                                          : -1;
         }
     }
     return result;
@@ -367,15 +462,9 @@ static int tlv_ret_objlnk(anjay_unlocked_output_ctx_t *ctx,
     return _anjay_ret_bytes_unlocked(ctx, &portable, sizeof(portable));
 }
 
-static void tlv_slave_start(tlv_out_t *ctx);
+static int tlv_slave_start(tlv_out_t *ctx);
 
-static int tlv_slave_finish(tlv_out_t *ctx) {
-    tlv_out_level_id_t root_level;
-    if (get_root_level(&ctx->root_path, &root_level)
-            || ctx->level <= root_level) {
-        AVS_UNREACHABLE("Already at root level of TLV structure");
-        return -1;
-    }
+static int finish_buffered_level(tlv_out_t *ctx) {
     size_t data_size = 0;
     {
         tlv_entry_t *entry = NULL;
@@ -417,6 +506,48 @@ static int tlv_slave_finish(tlv_out_t *ctx) {
     return retval;
 }
 
+static int finish_streamed_level(tlv_out_t *ctx) {
+    tlv_out_level_t *level = current_level(ctx);
+    const size_t length = level->length;
+    int retval = 0;
+    if (ctx->mode == TLV_OUT_MODE_MEASURE) {
+        if (length > TLV_MAX_LENGTH) {
+            retval = -1;
+        } else {
+            *level->length_slot = length;
+        }
+    } else if (length) {
+        // less data than during the measurement pass
+        retval = length_mismatch(ctx);
+    }
+    level->length = 0;
+    level->length_slot = NULL;
+
+    ctx->level = (tlv_out_level_id_t) (ctx->level - 1);
+    uint16_t *next_id = &current_level(ctx)->next_id;
+    if (!retval && ctx->mode == TLV_OUT_MODE_MEASURE) {
+        // in TLV_OUT_MODE_PRECOMPUTED, this has been done in tlv_slave_start()
+        retval = account_nested_bytes(ctx,
+                                      header_size(*next_id, length) + length);
+    }
+    *next_id = ANJAY_ID_INVALID;
+    return retval;
+}
+
+static int tlv_slave_finish(tlv_out_t *ctx) {
+    tlv_out_level_id_t root_level;
+    if (get_root_level(&ctx->root_path, &root_level)
+            || ctx->level <= root_level) {
+        AVS_UNREACHABLE("Already at root level of TLV structure");
+        return -1;
+    }
+    if (ctx->mode == TLV_OUT_MODE_BUFFERED) {
+        return finish_buffered_level(ctx);
+    } else {
+        return finish_streamed_level(ctx);
+    }
+}
+
 static int tlv_start_aggregate(anjay_unlocked_output_ctx_t *ctx_) {
     tlv_out_t *ctx = (tlv_out_t *) ctx_;
     if (ctx->level == TLV_OUT_LEVEL_RID) {
@@ -428,7 +559,7 @@ static int tlv_start_aggregate(anjay_unlocked_output_ctx_t *ctx_) {
             // Resource Instances - so we're starting the slave context that
             // will expect Resource Instance entries, or serialize to an empty
             // array if no Resource Instances will follow.
-            tlv_slave_start(ctx);
+            return tlv_slave_start(ctx);
         } else {
             AVS_ASSERT(_anjay_uri_path_leaf_is(&ctx->root_path, ANJAY_ID_IID),
                        "Called tlv_start_aggregate in inappropriate state");
@@ -452,7 +583,7 @@ static int tlv_start_aggregate(anjay_unlocked_output_ctx_t *ctx_) {
         // starting aggregate on the Instance level, i.e. an array of Resources
         // - so we're starting the slave context that will expect Resource
         // entries, or serialize to an empty array if no Resources will follow.
-        tlv_slave_start(ctx);
+        return tlv_slave_start(ctx);
     } else {
         AVS_UNREACHABLE("tlv_start_aggregate called in invalid state");
         return -1;
@@ -546,10 +677,10 @@ static int tlv_set_path(anjay_unlocked_output_ctx_t *ctx_,
     }
     for (int i = ctx->level; i < (int) new_level; ++i) {
         if ((result = get_id_from_path(path, (tlv_out_level_id_t) i,
-                                       &ctx->levels[i].next_id))) {
+                                       &ctx->levels[i].next_id))
+                || (result = tlv_slave_start(ctx))) {
             return result;
         }
-        tlv_slave_start(ctx);
     }
     assert(ctx->level == AVS_MAX(new_level, lowest_level));
     if (new_level >= lowest_level) {
@@ -584,9 +715,17 @@ static int tlv_output_close(anjay_unlocked_output_ctx_t *ctx_) {
             _anjay_update_ret(&result, tlv_slave_finish(ctx));
         }
     }
+    if (ctx->mode == TLV_OUT_MODE_PRECOMPUTED && ctx->lengths) {
+        // less nested levels than during the measurement pass
+        length_mismatch(ctx);
+    }
+    if (ctx->length_mismatch) {
+        result = ANJAY_OUTCTXERR_TLV_LENGTH_MISMATCH;
+    }
     for (uint8_t i = 0; i < AVS_ARRAY_SIZE(ctx->levels); ++i) {
         AVS_LIST_CLEAR(&ctx->levels[i].entries);
     }
+    AVS_LIST_CLEAR(&ctx->lengths);
     return result;
 }
 
@@ -606,12 +745,93 @@ static const anjay_output_ctx_vtable_t TLV_OUT_VTABLE = {
     .close = tlv_output_close
 };
 
-static void tlv_slave_start(tlv_out_t *ctx) {
+static int tlv_slave_start(tlv_out_t *ctx) {
     assert((size_t) (ctx->level + 1) <= AVS_ARRAY_SIZE(ctx->levels));
+    size_t length = 0;
+    size_t *length_slot = NULL;
+    if (ctx->mode == TLV_OUT_MODE_MEASURE) {
+        AVS_LIST(size_t) slot = AVS_LIST_NEW_ELEMENT(size_t);
+        if (!slot) {
+            return -1;
+        }
+        AVS_LIST_INSERT(ctx->lengths_append_ptr, slot);
+        AVS_LIST_ADVANCE_PTR(&ctx->lengths_append_ptr);
+        length_slot = slot;
+    } else if (ctx->mode == TLV_OUT_MODE_PRECOMPUTED) {
+        tlv_id_type_t type;
+        switch (ctx->level) {
+        case TLV_OUT_LEVEL_RID:
+            type = TLV_ID_RID_ARRAY;
+            break;
+        case TLV_OUT_LEVEL_IID:
+            type = TLV_ID_IID;
+            break;
+        default:
+            return -1;
+        }
+        if (!ctx->lengths) {
+            // more nested levels than during the measurement pass
+            return length_mismatch(ctx);
+        }
+        length = *ctx->lengths;
+        AVS_LIST_DELETE(&ctx->lengths);
+        const uint16_t id = current_level(ctx)->next_id;
+        int retval;
+        (void) ((retval = account_nested_bytes(
+                         ctx, header_size(id, length) + length))
+                || (retval = write_header(ctx->stream, type, id, length)));
+        if (retval) {
+            return retval;
+        }
+    }
     ctx->level = (tlv_out_level_id_t) (ctx->level + 1);
     assert(!current_level(ctx)->entries);
     current_level(ctx)->next_entry_ptr = &current_level(ctx)->entries;
     current_level(ctx)->next_id = ANJAY_ID_INVALID;
+    current_level(ctx)->length = length;
+    current_level(ctx)->length_slot = length_slot;
+    return 0;
+}
+
+int _anjay_output_tlv_precompute_lengths(
+        anjay_unlocked_output_ctx_t *ctx_,
+        int (*feed)(anjay_unlocked_output_ctx_t *ctx, void *arg),
+        void *arg) {
+    if (ctx_->vtable != &TLV_OUT_VTABLE) {
+        return 0;
+    }
+    tlv_out_t *ctx = (tlv_out_t *) ctx_;
+    tlv_out_level_id_t root_level;
+    if (get_root_level(&ctx->root_path, &root_level)
+            || ctx->mode != TLV_OUT_MODE_BUFFERED || ctx->level != root_level
+            || current_level(ctx)->next_id != ANJAY_ID_INVALID
+            || ctx->base.error) {
+        AVS_UNREACHABLE("TLV lengths may only be precomputed before the "
+                        "output context is used");
+        return -1;
+    }
+
+    ctx->mode = TLV_OUT_MODE_MEASURE;
+    ctx->lengths_append_ptr = &ctx->lengths;
+    int result = feed(ctx_, arg);
+    if (!result) {
+        result = ctx->base.error;
+    }
+    if (!result && current_level(ctx)->next_id != ANJAY_ID_INVALID) {
+        result = ANJAY_OUTCTXERR_ANJAY_RET_NOT_CALLED;
+    }
+    while (ctx->level > root_level) {
+        _anjay_update_ret(&result, tlv_slave_finish(ctx));
+    }
+    current_level(ctx)->next_id = ANJAY_ID_INVALID;
+    ctx->lengths_append_ptr = NULL;
+    if (result) {
+        AVS_LIST_CLEAR(&ctx->lengths);
+        ctx->mode = TLV_OUT_MODE_BUFFERED;
+        return result;
+    }
+    ctx->mode = TLV_OUT_MODE_PRECOMPUTED;
+    return 0;
 }
 
 anjay_unlocked_output_ctx_t *
@@ -27,6 +27,15 @@ typedef int (*anjay_output_ctx_bytes_begin_t)(
         anjay_unlocked_output_ctx_t *,
         size_t,
         anjay_unlocked_ret_bytes_ctx_t **);
+/**
+ * Takes over the reference to the buffer - the release function shall be
+ * called exactly once, even in case of an error.
+ */
+typedef int (*anjay_output_ctx_bytes_borrowed_t)(anjay_unlocked_output_ctx_t *,
+                                                 const void *,
+                                                 size_t,
+                                                 anjay_ret_bytes_release_t *,
+                                                 void *);
 typedef int (*anjay_output_ctx_string_t)(anjay_unlocked_output_ctx_t *,
                                          const char *);
 typedef int (*anjay_output_ctx_integer_t)(anjay_unlocked_output_ctx_t *,
@@ -57,6 +66,7 @@ typedef int (*anjay_output_ctx_close_t)(anjay_unlocked_output_ctx_t *);
 
 struct anjay_output_ctx_vtable_struct {
     anjay_output_ctx_bytes_begin_t bytes_begin;
+    anjay_output_ctx_bytes_borrowed_t bytes_borrowed;
     anjay_output_ctx_string_t string;
     anjay_output_ctx_integer_t integer;
 #ifdef ANJAY_WITH_LWM2M11
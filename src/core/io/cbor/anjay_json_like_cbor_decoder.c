@@ -24,6 +24,8 @@
 #    include <avsystem/commons/avs_stream_membuf.h>
 #    include <avsystem/commons/avs_utils.h>
 
+#    include <avsystem/coap/streaming.h>
+
 #    include <anjay_modules/anjay_io_utils.h>
 #    include <anjay_modules/anjay_utils_core.h>
 
@@ -51,6 +53,14 @@ static bool is_indefinite(cbor_nested_state_t *state) {
 typedef struct {
     const anjay_json_like_decoder_vtable_t *vtable;
     avs_stream_t *stream;
+    /**
+     * If the whole payload is available in a contiguous buffer, has_view is
+     * true, view_data points to the part of it that has not been consumed yet
+     * and stream is not used at all.
+     */
+    bool has_view;
+    const uint8_t *view_data;
+    size_t view_size;
     anjay_json_like_decoder_state_t state;
     /**
      * This structure contains information about currently processed value. The
@@ -89,6 +99,34 @@ typedef struct {
 
 typedef enum { CBOR_DECODER_TAG_DECIMAL_FRACTION = 4 } cbor_decoder_tag_t;
 
+static avs_error_t read_byte(anjay_cbor_decoder_t *ctx, uint8_t *out_byte) {
+    if (!ctx->has_view) {
+        return avs_stream_getch(ctx->stream, (char *) out_byte, NULL);
+    }
+    if (!ctx->view_size) {
+        return AVS_EOF;
+    }
+    *out_byte = *ctx->view_data++;
+    --ctx->view_size;
+    return AVS_OK;
+}
+
+static avs_error_t
+read_reliably(anjay_cbor_decoder_t *ctx, void *out_buf, size_t size) {
+    if (!ctx->has_view) {
+        return avs_stream_read_reliably(ctx->stream, out_buf, size);
+    }
+    if (size > ctx->view_size) {
+        return AVS_EOF;
+    }
+    if (size) {
+        memcpy(out_buf, ctx->view_data, size);
+        ctx->view_data += size;
+        ctx->view_size -= size;
+    }
+    return AVS_OK;
+}
+
 static int parse_major_type(const uint8_t initial_byte) {
     return initial_byte >> 5;
 }
@@ -179,8 +217,7 @@ static void ignore_tag(anjay_cbor_decoder_t *ctx) {
     uint64_t ignored;
     if (is_length_extended(ctx)) {
         if (parse_ext_length_size(ctx, &ext_len_size)
-                || avs_is_err(avs_stream_read_reliably(
-                           ctx->stream, &ignored, ext_len_size))) {
+                || avs_is_err(read_reliably(ctx, &ignored, ext_len_size))) {
             ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_ERROR;
         }
     }
@@ -204,7 +241,7 @@ static void preprocess_next_value(anjay_cbor_decoder_t *ctx) {
 
     while (ctx->state == ANJAY_JSON_LIKE_DECODER_STATE_OK) {
         uint8_t byte;
-        avs_error_t err = avs_stream_getch(ctx->stream, (char *) &byte, NULL);
+        avs_error_t err = read_byte(ctx, &byte);
         if (avs_is_eof(err)) {
             if (data_must_follow) {
                 ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_ERROR;
@@ -361,28 +398,25 @@ static int parse_uint(anjay_cbor_decoder_t *ctx, uint64_t *out_value) {
     }
     if (ext_len_size == 1) {
         uint8_t u8;
-        if (avs_is_ok(avs_stream_read_reliably(ctx->stream, &u8, sizeof(u8)))) {
+        if (avs_is_ok(read_reliably(ctx, &u8, sizeof(u8)))) {
             *out_value = u8;
             retval = 0;
         }
     } else if (ext_len_size == 2) {
         uint16_t u16;
-        if (avs_is_ok(
-                    avs_stream_read_reliably(ctx->stream, &u16, sizeof(u16)))) {
+        if (avs_is_ok(read_reliably(ctx, &u16, sizeof(u16)))) {
             *out_value = avs_convert_be16(u16);
             retval = 0;
         }
     } else if (ext_len_size == 4) {
         uint32_t u32;
-        if (avs_is_ok(
-                    avs_stream_read_reliably(ctx->stream, &u32, sizeof(u32)))) {
+        if (avs_is_ok(read_reliably(ctx, &u32, sizeof(u32)))) {
             *out_value = avs_convert_be32(u32);
             retval = 0;
         }
     } else if (ext_len_size == 8) {
         uint64_t u64;
-        if (avs_is_ok(
-                    avs_stream_read_reliably(ctx->stream, &u64, sizeof(u64)))) {
+        if (avs_is_ok(read_reliably(ctx, &u64, sizeof(u64)))) {
             *out_value = avs_convert_be64(u64);
             retval = 0;
         }
@@ -545,16 +579,14 @@ static int decode_float(anjay_cbor_decoder_t *ctx, float *out_value) {
     int result = -1;
     if (ctx->current_item.additional_info == CBOR_VALUE_FLOAT_16) {
         uint16_t value;
-        if (avs_is_ok(avs_stream_read_reliably(
-                    ctx->stream, &value, sizeof(value)))) {
+        if (avs_is_ok(read_reliably(ctx, &value, sizeof(value)))) {
             *out_value = decode_half_float(avs_convert_be16(value));
             result = 0;
         }
     } else {
         assert(ctx->current_item.additional_info == CBOR_VALUE_FLOAT_32);
         uint32_t value;
-        if (avs_is_ok(avs_stream_read_reliably(
-                    ctx->stream, &value, sizeof(value)))) {
+        if (avs_is_ok(read_reliably(ctx, &value, sizeof(value)))) {
             *out_value = avs_ntohf(value);
             result = 0;
         }
@@ -635,8 +667,7 @@ static int decode_double(anjay_cbor_decoder_t *ctx, double *out_value) {
         result = decode_decimal_fraction(ctx, out_value);
     } else {
         uint64_t value;
-        if (avs_is_ok(avs_stream_read_reliably(
-                    ctx->stream, &value, sizeof(value)))) {
+        if (avs_is_ok(read_reliably(ctx, &value, sizeof(value)))) {
             *out_value = avs_ntohd(value);
             result = 0;
         }
@@ -693,6 +724,22 @@ static int cbor_decoder_bytes(anjay_json_like_decoder_t *ctx_,
     }
 
     bool message_finished = false;
+    if (ctx->has_view) {
+        while (!message_finished) {
+            const void *data;
+            size_t size;
+            if (_anjay_io_cbor_get_bytes_slice(ctx_, &bytes_ctx, &data, &size,
+                                               &message_finished)
+                    || (size
+                        && avs_is_err(avs_stream_write(target_stream, data,
+                                                       size)))) {
+                ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_ERROR;
+                return -1;
+            }
+        }
+        return 0;
+    }
+
     while (!message_finished) {
         // ignore errors here - target_stream might not even be a membuf
         avs_stream_membuf_ensure_free_bytes(target_stream,
@@ -789,17 +836,45 @@ static const anjay_json_like_decoder_vtable_t VTABLE = {
     .cleanup = cbor_decoder_cleanup
 };
 
-anjay_json_like_decoder_t *_anjay_cbor_decoder_new(avs_stream_t *stream,
-                                                   size_t max_nesting_depth) {
+static anjay_cbor_decoder_t *cbor_decoder_alloc(size_t max_nesting_depth) {
     anjay_cbor_decoder_t *ctx = (anjay_cbor_decoder_t *) avs_calloc(
             1,
             sizeof(anjay_cbor_decoder_t)
                     + max_nesting_depth * sizeof(cbor_nested_state_t));
     if (ctx) {
         ctx->vtable = &VTABLE;
-        ctx->stream = stream;
         ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_OK;
         ctx->max_nest_stack_size = max_nesting_depth;
+    }
+    return ctx;
+}
+
+anjay_json_like_decoder_t *_anjay_cbor_decoder_new(avs_stream_t *stream,
+                                                   size_t max_nesting_depth) {
+    const void *data;
+    size_t size;
+    if (avs_is_ok(avs_coap_streaming_get_request_payload(stream, &data,
+                                                         &size))) {
+        return _anjay_cbor_decoder_new_from_buffer(data, size,
+                                                   max_nesting_depth);
+    }
+    anjay_cbor_decoder_t *ctx = cbor_decoder_alloc(max_nesting_depth);
+    if (ctx) {
+        ctx->stream = stream;
+        preprocess_next_value(ctx);
+    }
+    return (anjay_json_like_decoder_t *) ctx;
+}
+
+anjay_json_like_decoder_t *
+_anjay_cbor_decoder_new_from_buffer(const void *data,
+                                    size_t size,
+                                    size_t max_nesting_depth) {
+    anjay_cbor_decoder_t *ctx = cbor_decoder_alloc(max_nesting_depth);
+    if (ctx) {
+        ctx->has_view = true;
+        ctx->view_data = (const uint8_t *) data;
+        ctx->view_size = size;
         preprocess_next_value(ctx);
     }
     return (anjay_json_like_decoder_t *) ctx;
@@ -888,8 +963,7 @@ int _anjay_io_cbor_get_some_bytes(anjay_json_like_decoder_t *ctx_,
            && (buf_size != 0 || bytes_ctx->bytes_available == 0)) {
         // This may be equal to 0 and this is intentional.
         size_t bytes_to_read = AVS_MIN(buf_size, bytes_ctx->bytes_available);
-        if (avs_is_err(avs_stream_read_reliably(
-                    ctx->stream, out_buf, bytes_to_read))) {
+        if (avs_is_err(read_reliably(ctx, out_buf, bytes_to_read))) {
             ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_ERROR;
             return -1;
         }
@@ -909,6 +983,43 @@ int _anjay_io_cbor_get_some_bytes(anjay_json_like_decoder_t *ctx_,
     return 0;
 }
 
+bool _anjay_io_cbor_has_payload_view(anjay_json_like_decoder_t *ctx_) {
+    anjay_cbor_decoder_t *ctx = (anjay_cbor_decoder_t *) ctx_;
+    assert(ctx->vtable == &VTABLE);
+    return ctx->has_view;
+}
+
+int _anjay_io_cbor_get_bytes_slice(anjay_json_like_decoder_t *ctx_,
+                                   anjay_io_cbor_bytes_ctx_t *bytes_ctx,
+                                   const void **out_data,
+                                   size_t *out_size,
+                                   bool *out_message_finished) {
+    anjay_cbor_decoder_t *ctx = (anjay_cbor_decoder_t *) ctx_;
+    assert(ctx->vtable == &VTABLE);
+    assert(ctx->has_view);
+
+    *out_data = NULL;
+    *out_size = 0;
+    if (bytes_ctx->empty) {
+        *out_message_finished = true;
+        return 0;
+    }
+    if (bytes_ctx->bytes_available > ctx->view_size) {
+        ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_ERROR;
+        return -1;
+    }
+
+    *out_message_finished = false;
+    *out_data = ctx->view_data;
+    *out_size = bytes_ctx->bytes_available;
+    ctx->view_data += bytes_ctx->bytes_available;
+    ctx->view_size -= bytes_ctx->bytes_available;
+    bytes_ctx->bytes_available = 0;
+    // The view is never modified, so the slice remains valid even though this
+    // may already advance to the next value.
+    return handle_end_of_bytes(ctx, bytes_ctx, out_message_finished);
+}
+
 #    ifdef ANJAY_TEST
 #        include "tests/core/io/cbor/cbor_decoder.c"
 #    endif
@@ -53,9 +53,26 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
  */
 #define MAX_LWM2M_CBOR_NEST_STACK_SIZE 5
 
+/**
+ * Creates a CBOR decoder reading from @p stream. If @p stream is a CoAP request
+ * payload stream and the whole payload has already been received, the decoder
+ * works directly on the CoAP input buffer instead (see
+ * @ref _anjay_cbor_decoder_new_from_buffer). Note that in that case, the
+ * payload is not consumed from @p stream.
+ */
 anjay_json_like_decoder_t *_anjay_cbor_decoder_new(avs_stream_t *stream,
                                                    size_t max_nesting_depth);
 
+/**
+ * Creates a CBOR decoder working on a contiguous buffer containing the whole
+ * payload. The buffer is not copied, so it must remain valid and unmodified for
+ * the whole lifetime of the decoder.
+ */
+anjay_json_like_decoder_t *
+_anjay_cbor_decoder_new_from_buffer(const void *data,
+                                    size_t size,
+                                    size_t max_nesting_depth);
+
 typedef struct {
     bool indefinite;
     // Indefinite length struct may be completely empty.
@@ -76,6 +93,26 @@ int _anjay_io_cbor_get_some_bytes(anjay_json_like_decoder_t *ctx_,
                                   size_t *out_bytes_read,
                                   bool *out_message_finished);
 
+/**
+ * Checks whether the decoder works on a contiguous payload buffer, in which
+ * case @ref _anjay_io_cbor_get_bytes_slice may be used.
+ */
+bool _anjay_io_cbor_has_payload_view(anjay_json_like_decoder_t *ctx);
+
+/**
+ * Works like @ref _anjay_io_cbor_get_some_bytes with an unlimited buffer, but
+ * instead of copying the data, returns a pointer to it, borrowed from the
+ * payload buffer. For indefinite length strings, each call returns at most one
+ * chunk.
+ *
+ * MUST only be called if @ref _anjay_io_cbor_has_payload_view returns true.
+ */
+int _anjay_io_cbor_get_bytes_slice(anjay_json_like_decoder_t *ctx,
+                                   anjay_io_cbor_bytes_ctx_t *bytes_ctx,
+                                   const void **out_data,
+                                   size_t *out_size,
+                                   bool *out_message_finished);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif // ANJAY_IO_JSON_LIKE_CBOR_DECODER_H
@@ -18,6 +18,7 @@
 #    include <avsystem/commons/avs_memory.h>
 #    include <avsystem/commons/avs_stream.h>
 #    include <avsystem/commons/avs_stream_membuf.h>
+#    include <avsystem/commons/avs_stream_outbuf.h>
 #    include <avsystem/commons/avs_utils.h>
 
 #    include "../anjay_common.h"
@@ -38,6 +39,14 @@ VISIBILITY_SOURCE_BEGIN
  */
 #    define MAX_NEST_STACK_SIZE 4
 
+/**
+ * Worst-case size of a CBOR array header: initial byte followed by a 64-bit
+ * item count. This much space is reserved at the beginning of the cache stream
+ * of every array of unknown length, so that the header can be patched in place
+ * once the number of items is known.
+ */
+#    define MAX_ARRAY_HEADER_SIZE 9
+
 typedef enum {
     CBOR_CONTEXT_TYPE_ROOT = 0,
     CBOR_CONTEXT_TYPE_UNKNOWN_LENGTH_ARRAY,
@@ -241,27 +250,49 @@ static int cbor_unknown_length_definite_array_begin(cbor_encoder_t *ctx) {
     assert(top_ctx->context_type != CBOR_CONTEXT_TYPE_BYTES);
     (void) top_ctx;
 
+    static const char HEADER_PLACEHOLDER[MAX_ARRAY_HEADER_SIZE] = "";
     avs_stream_t *stream = avs_stream_membuf_create();
     if (!stream) {
         return -1;
     }
+    if (avs_is_err(avs_stream_write(stream, HEADER_PLACEHOLDER,
+                                    sizeof(HEADER_PLACEHOLDER)))) {
+        avs_stream_cleanup(&stream);
+        return -1;
+    }
 
     nested_context_push(ctx, stream, CBOR_CONTEXT_TYPE_UNKNOWN_LENGTH_ARRAY);
     return 0;
 }
 
-static int copy_stream(avs_stream_t *dst, avs_stream_t *src) {
-    char buffer[128];
-    bool msg_finished;
-    do {
-        size_t bytes_read;
-        if (avs_is_err(avs_stream_read(src, &bytes_read, &msg_finished, buffer,
-                                       sizeof(buffer)))
-                || avs_is_err(avs_stream_write(dst, buffer, bytes_read))) {
-            return -1;
-        }
-    } while (!msg_finished);
-    return 0;
+static int
+write_cached_array(avs_stream_t *dst, avs_stream_t *cache, size_t entries) {
+    char header[MAX_ARRAY_HEADER_SIZE];
+    avs_stream_outbuf_t header_stream = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+    avs_stream_outbuf_set_buffer(&header_stream, header, sizeof(header));
+    if (_anjay_cbor_ll_definite_array_begin((avs_stream_t *) &header_stream,
+                                            entries)) {
+        return -1;
+    }
+    size_t header_size = avs_stream_outbuf_offset(&header_stream);
+
+    void *data = NULL;
+    size_t size;
+    if (avs_is_err(avs_stream_membuf_take_ownership(cache, &data, &size))) {
+        return -1;
+    }
+    assert(data);
+    assert(size >= MAX_ARRAY_HEADER_SIZE);
+    // the actual header is placed right before the first item, so that the
+    // whole array can be passed to the target stream with a single write
+    char *array = (char *) data + MAX_ARRAY_HEADER_SIZE - header_size;
+    memcpy(array, header, header_size);
+    int retval = avs_is_ok(avs_stream_write(
+                         dst, array, size - MAX_ARRAY_HEADER_SIZE + header_size))
+                         ? 0
+                         : -1;
+    avs_free(data);
+    return retval;
 }
 
 static int cbor_definite_array_end(cbor_encoder_t *ctx) {
@@ -284,9 +315,7 @@ static int cbor_definite_array_end(cbor_encoder_t *ctx) {
 
     int retval = 0;
     if (context_type == CBOR_CONTEXT_TYPE_UNKNOWN_LENGTH_ARRAY) {
-        (void) ((retval = _anjay_cbor_ll_definite_array_begin(top_ctx->stream,
-                                                              entries))
-                || (retval = copy_stream(top_ctx->stream, array_stream)));
+        retval = write_cached_array(top_ctx->stream, array_stream, entries);
         avs_stream_cleanup(&array_stream);
     }
     top_ctx->size++;
@@ -27,6 +27,8 @@ VISIBILITY_SOURCE_BEGIN
 
 #    define MAX_NEST_STACK_SIZE 2
 
+#    define READ_AHEAD_BUFFER_SIZE 256
+
 typedef enum {
     JSON_NESTED_NONE,
     JSON_NESTED_ARRAY_ELEMENT,
@@ -40,8 +42,64 @@ typedef struct {
     anjay_json_like_decoder_state_t state;
     anjay_json_like_value_type_t current_item_type;
     json_nested_type_t nested_types[MAX_NEST_STACK_SIZE];
+    // The input stream is consumed in whole chunks instead of byte-by-byte;
+    // bytes between buffer_pos and buffer_end have not been parsed yet.
+    char buffer[READ_AHEAD_BUFFER_SIZE];
+    size_t buffer_pos;
+    size_t buffer_end;
+    bool stream_finished;
 } anjay_json_decoder_t;
 
+static avs_error_t fill_buffer(anjay_json_decoder_t *ctx) {
+    while (ctx->buffer_pos >= ctx->buffer_end) {
+        if (ctx->stream_finished) {
+            return AVS_EOF;
+        }
+        size_t bytes_read;
+        avs_error_t err =
+                avs_stream_read(ctx->stream, &bytes_read, &ctx->stream_finished,
+                                ctx->buffer, sizeof(ctx->buffer));
+        if (avs_is_err(err)) {
+            return err;
+        }
+        ctx->buffer_pos = 0;
+        ctx->buffer_end = bytes_read;
+    }
+    return AVS_OK;
+}
+
+static avs_error_t peek_char(anjay_json_decoder_t *ctx, unsigned char *out) {
+    avs_error_t err = fill_buffer(ctx);
+    if (avs_is_ok(err)) {
+        *out = (unsigned char) ctx->buffer[ctx->buffer_pos];
+    }
+    return err;
+}
+
+static avs_error_t get_char(anjay_json_decoder_t *ctx, unsigned char *out) {
+    avs_error_t err = peek_char(ctx, out);
+    if (avs_is_ok(err)) {
+        ++ctx->buffer_pos;
+    }
+    return err;
+}
+
+static avs_error_t
+read_reliably(anjay_json_decoder_t *ctx, char *out, size_t size) {
+    while (size) {
+        avs_error_t err = fill_buffer(ctx);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        size_t chunk_size = AVS_MIN(size, ctx->buffer_end - ctx->buffer_pos);
+        memcpy(out, &ctx->buffer[ctx->buffer_pos], chunk_size);
+        ctx->buffer_pos += chunk_size;
+        out += chunk_size;
+        size -= chunk_size;
+    }
+    return AVS_OK;
+}
+
 static anjay_json_like_decoder_state_t
 json_decoder_state(const anjay_json_like_decoder_t *ctx) {
     return ((const anjay_json_decoder_t *) ctx)->state;
@@ -86,7 +144,7 @@ static int preprocess_possible_value(anjay_json_decoder_t *ctx) {
     json_nested_type_t *nested_type = top_level_nesting_ptr(ctx);
     while (true) {
         unsigned char value;
-        avs_error_t err = avs_stream_peek(ctx->stream, 0, (char *) &value);
+        avs_error_t err = peek_char(ctx, &value);
         if (avs_is_eof(err)) {
             ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_FINISHED;
             return value;
@@ -99,10 +157,7 @@ static int preprocess_possible_value(anjay_json_decoder_t *ctx) {
         }
 
         if (is_json_whitespace(value)) {
-            err = avs_stream_getch(ctx->stream, (char *) &value, NULL);
-            assert(avs_is_ok(err));
-            assert(is_json_whitespace(value));
-            (void) err;
+            ++ctx->buffer_pos;
             continue;
         }
 
@@ -182,12 +237,8 @@ static void preprocess_first_nested_value(anjay_json_decoder_t *ctx) {
         ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_ERROR;
     } else if ((*nested_type == JSON_NESTED_ARRAY_ELEMENT && value == ']')
                || (*nested_type == JSON_NESTED_MAP_KEY && value == '}')) {
-        unsigned char ch;
-        avs_error_t err = avs_stream_getch(ctx->stream, (char *) &ch, NULL);
-        assert(avs_is_ok(err));
-        assert(ch == value);
-        (void) ch;
-        (void) err;
+        assert(ctx->buffer[ctx->buffer_pos] == value);
+        ++ctx->buffer_pos;
         *nested_type = JSON_NESTED_NONE;
         preprocess_next_value(ctx);
     } else if (value > 0) {
@@ -203,7 +254,7 @@ static void preprocess_next_value(anjay_json_decoder_t *ctx) {
         unsigned char ch;
         avs_error_t err;
         do {
-            err = avs_stream_getch(ctx->stream, (char *) &ch, NULL);
+            err = get_char(ctx, &ch);
         } while (avs_is_ok(err) && is_json_whitespace(ch));
 
         if (avs_is_eof(err) && !nested_type) {
@@ -248,14 +299,14 @@ static int json_decoder_bool(anjay_json_like_decoder_t *ctx_, bool *out_value) {
         return -1;
     }
     char buf[4];
-    if (avs_is_err(avs_stream_read_reliably(ctx->stream, buf, sizeof(buf)))) {
+    if (avs_is_err(read_reliably(ctx, buf, sizeof(buf)))) {
         goto error;
     }
     if (memcmp(buf, "true", 4) == 0) {
         *out_value = true;
     } else if (memcmp(buf, "fals", 4) == 0) {
-        char ch;
-        if (avs_is_err(avs_stream_getch(ctx->stream, &ch, NULL)) || ch != 'e') {
+        unsigned char ch;
+        if (avs_is_err(get_char(ctx, &ch)) || ch != 'e') {
             goto error;
         }
         *out_value = false;
@@ -304,7 +355,7 @@ static int json_decoder_number(anjay_json_like_decoder_t *ctx_,
     char buf[ANJAY_MAX_DOUBLE_STRING_SIZE];
     while (true) {
         unsigned char ch;
-        avs_error_t err = avs_stream_peek(ctx->stream, 0, (char *) &ch);
+        avs_error_t err = peek_char(ctx, &ch);
         if (avs_is_err(err) && !avs_is_eof(err)) {
             goto error;
         } else if (avs_is_eof(err) || !is_valid_json_number_character(ch)) {
@@ -312,11 +363,11 @@ static int json_decoder_number(anjay_json_like_decoder_t *ctx_,
             break;
         }
 
-        if (avs_is_err(avs_stream_read_reliably(ctx->stream, buf + length, 1))
-                || ++length >= sizeof(buf)) {
+        ++ctx->buffer_pos;
+        buf[length] = (char) ch;
+        if (++length >= sizeof(buf)) {
             goto error;
         }
-        assert(((const unsigned char *) buf)[length - 1] == ch);
     }
     if (validate_number(buf)
             || _anjay_safe_strtod(buf, &out_value->value.f64)) {
@@ -333,7 +384,7 @@ error:
 static int handle_unicode_escape(anjay_json_decoder_t *ctx,
                                  avs_stream_t *target_stream) {
     char hex[5] = "";
-    if (avs_is_err(avs_stream_read_reliably(ctx->stream, &hex, sizeof(hex) - 1))
+    if (avs_is_err(read_reliably(ctx, hex, sizeof(hex) - 1))
             || !hex[0] || isspace((unsigned char) hex[0])) {
         return -1;
     }
@@ -376,7 +427,7 @@ static int handle_unicode_escape(anjay_json_decoder_t *ctx,
 static int handle_string_escape(anjay_json_decoder_t *ctx,
                                 avs_stream_t *target_stream) {
     unsigned char ch;
-    if (avs_is_err(avs_stream_getch(ctx->stream, (char *) &ch, NULL))) {
+    if (avs_is_err(get_char(ctx, &ch))) {
         return -1;
     }
     switch (ch) {
@@ -408,6 +459,53 @@ static int handle_string_escape(anjay_json_decoder_t *ctx,
     return avs_is_ok(avs_stream_write(target_stream, &ch, 1)) ? 0 : -1;
 }
 
+static bool is_plain_string_char(unsigned char ch) {
+    AVS_STATIC_ASSERT(' ' == 0x20, ascii);
+    return ch >= ' ' && ch != '"' && ch != '\\';
+}
+
+#    define SWAR_ONES UINT64_C(0x0101010101010101)
+#    define SWAR_HIGH_BITS UINT64_C(0x8080808080808080)
+
+/**
+ * Checks whether any of the 8 bytes packed in @p word is a control character,
+ * a quotation mark or a backslash. May only report false positives for words
+ * that also contain such a byte at a lower address, which is fine, as the
+ * caller falls back to checking byte-by-byte in that case anyway.
+ *
+ * Note that the ~word mask is valid for all three checks, as XORing with an
+ * ASCII character does not change the most significant bit of any byte.
+ */
+static bool word_has_special_chars(uint64_t word) {
+    uint64_t quotes = word ^ (SWAR_ONES * (uint8_t) '"');
+    uint64_t backslashes = word ^ (SWAR_ONES * (uint8_t) '\\');
+    return (((word - SWAR_ONES * (uint8_t) ' ') | (quotes - SWAR_ONES)
+             | (backslashes - SWAR_ONES))
+            & ~word & SWAR_HIGH_BITS)
+           != 0;
+}
+
+/**
+ * Returns the number of leading bytes in @p data that can be copied to the
+ * output verbatim. The bulk of string data is scanned 8 bytes at a time.
+ */
+static size_t plain_string_run_length(const char *data, size_t size) {
+    size_t length = 0;
+    while (size - length >= sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, &data[length], sizeof(word));
+        if (word_has_special_chars(word)) {
+            break;
+        }
+        length += sizeof(word);
+    }
+    while (length < size
+           && is_plain_string_char(((const unsigned char *) data)[length])) {
+        ++length;
+    }
+    return length;
+}
+
 static int json_decoder_bytes(anjay_json_like_decoder_t *ctx_,
                               avs_stream_t *target_stream) {
     anjay_json_decoder_t *ctx = (anjay_json_decoder_t *) ctx_;
@@ -415,28 +513,28 @@ static int json_decoder_bytes(anjay_json_like_decoder_t *ctx_,
             || ctx->current_item_type != ANJAY_JSON_LIKE_VALUE_TEXT_STRING) {
         return -1;
     }
-    unsigned char ch;
-    avs_error_t err = avs_stream_getch(ctx->stream, (char *) &ch, NULL);
-    assert(avs_is_ok(err));
-    assert(ch == '"'); // previously checked using peek in preprocess_next_value
-    (void) err;
-    while (avs_is_ok(avs_stream_getch(ctx->stream, (char *) &ch, NULL))) {
-        AVS_STATIC_ASSERT(' ' == 0x20, ascii);
+    // previously checked using peek in preprocess_next_value
+    assert(ctx->buffer[ctx->buffer_pos] == '"');
+    ++ctx->buffer_pos;
+    while (avs_is_ok(fill_buffer(ctx))) {
+        size_t run_length =
+                plain_string_run_length(&ctx->buffer[ctx->buffer_pos],
+                                        ctx->buffer_end - ctx->buffer_pos);
+        if (run_length) {
+            if (avs_is_err(avs_stream_write(target_stream,
+                                            &ctx->buffer[ctx->buffer_pos],
+                                            run_length))) {
+                break;
+            }
+            ctx->buffer_pos += run_length;
+            continue;
+        }
+        unsigned char ch = (unsigned char) ctx->buffer[ctx->buffer_pos++];
         if (ch == '"') {
             preprocess_next_value(ctx);
             return 0;
-        } else if (ch < ' ') {
-            // Note: includes EOF and other negative values
-            break;
-        } else if (ch == '\\') {
-            if (handle_string_escape(ctx, target_stream)) {
-                break;
-            }
-        } else if (avs_is_err(avs_stream_write(target_stream,
-                                               &(unsigned char) {
-                                                       (unsigned char) ch },
-                                               1))) {
-            // Note: the "ch < ' '" case includes EOF and other negative values
+        } else if (ch != '\\' || handle_string_escape(ctx, target_stream)) {
+            // control characters are not allowed in JSON strings
             break;
         }
     }
@@ -451,12 +549,9 @@ static int json_decoder_enter_array(anjay_json_like_decoder_t *ctx_) {
             || push_nested_type(ctx, JSON_NESTED_ARRAY_ELEMENT)) {
         return -1;
     }
-    unsigned char ch;
-    avs_error_t err = avs_stream_getch(ctx->stream, (char *) &ch, NULL);
-    assert(avs_is_ok(err));
-    assert(ch == '['); // previously checked using peek in preprocess_next_value
-    (void) err;
-    (void) ch;
+    // previously checked using peek in preprocess_next_value
+    assert(ctx->buffer[ctx->buffer_pos] == '[');
+    ++ctx->buffer_pos;
     preprocess_first_nested_value(ctx);
     return 0;
 }
@@ -468,12 +563,9 @@ static int json_decoder_enter_map(anjay_json_like_decoder_t *ctx_) {
             || push_nested_type(ctx, JSON_NESTED_MAP_KEY)) {
         return -1;
     }
-    unsigned char ch;
-    avs_error_t err = avs_stream_getch(ctx->stream, (char *) &ch, NULL);
-    assert(avs_is_ok(err));
-    assert(ch == '{'); // previously checked using peek in preprocess_next_value
-    (void) err;
-    (void) ch;
+    // previously checked using peek in preprocess_next_value
+    assert(ctx->buffer[ctx->buffer_pos] == '{');
+    ++ctx->buffer_pos;
     preprocess_first_nested_value(ctx);
     return 0;
 }
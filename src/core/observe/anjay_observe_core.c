@@ -21,6 +21,7 @@
 #    include <anjay_modules/anjay_time_defs.h>
 
 #    include "../anjay_core.h"
+#    include "../anjay_instrumentation.h"
 #    include "../anjay_io_core.h"
 #    include "../anjay_servers_utils.h"
 #    include "../coap/anjay_content_format.h"
@@ -80,6 +81,9 @@ void _anjay_observe_init(anjay_observe_state_t *observe,
         observe->notify_queue_limit = stored_notification_limit;
         observe->notify_queue_limit_mode = NOTIFY_QUEUE_DROP_OLDEST;
     }
+#    ifdef ANJAY_WITH_OBSERVE_ATTRS_CACHE
+    observe->attrs_cache_generation = 1;
+#    endif // ANJAY_WITH_OBSERVE_ATTRS_CACHE
 }
 
 static inline bool is_error_value(const anjay_observation_value_t *value) {
@@ -200,6 +204,7 @@ static void remove_from_observed_paths(
 static void clear_observation(anjay_observe_connection_entry_t *connection,
                               anjay_observation_t *observation) {
     anjay_unlocked_t *anjay = _anjay_from_server(connection->conn_ref.server);
+    _anjay_query_snapshot_mark_dirty(anjay);
     avs_sched_del(&observation->notify_task);
     while (observation->last_sent) {
         delete_value(anjay, &observation->last_sent);
@@ -247,6 +252,7 @@ static void cleanup_connection_without_observations_set(
         anjay_observe_connection_entry_t *conn) {
     if (conn->conn_ref.server) {
         anjay_unlocked_t *anjay = _anjay_from_server(conn->conn_ref.server);
+        _anjay_query_snapshot_mark_dirty(anjay);
         while (conn->unsent) {
             delete_value(anjay, &conn->unsent);
         }
@@ -376,6 +382,8 @@ static int schedule_trigger(anjay_observe_connection_entry_t *conn_state,
         trigger_instant_real = real_now;
     }
 
+    _anjay_query_snapshot_mark_dirty(
+            _anjay_from_server(conn_state->conn_ref.server));
     if (!avs_time_real_before(conn_state->next_trigger, trigger_instant_real)) {
         conn_state->next_trigger = trigger_instant_real;
     }
@@ -505,6 +513,8 @@ find_oldest_queued_notification(anjay_observe_state_t *observe) {
 static anjay_observation_value_t *
 detach_first_unsent_value(anjay_observe_connection_entry_t *conn_state) {
     assert(conn_state->unsent);
+    _anjay_query_snapshot_mark_dirty(
+            _anjay_from_server(conn_state->conn_ref.server));
     anjay_observation_t *observation = conn_state->unsent->ref;
     if (observation->last_unsent == conn_state->unsent) {
         observation->last_unsent = NULL;
@@ -557,6 +567,7 @@ static int insert_new_value(anjay_observe_connection_entry_t *conn_state,
         return -1;
     }
 
+    _anjay_query_snapshot_mark_dirty(anjay);
     AVS_LIST_APPEND(&conn_state->unsent_last, res_value);
     conn_state->unsent_last = res_value;
     if (!conn_state->unsent) {
@@ -625,6 +636,98 @@ static int get_effective_attrs(anjay_unlocked_t *anjay,
     return _anjay_dm_effective_attrs(anjay, &details, out_attrs);
 }
 
+#    ifdef ANJAY_WITH_OBSERVE_ATTRS_CACHE
+void _anjay_observe_attrs_cache_invalidate(anjay_unlocked_t *anjay) {
+    if (!++anjay->observe.attrs_cache_generation) {
+        // 0 is reserved for observations that have never been resolved
+        ++anjay->observe.attrs_cache_generation;
+    }
+}
+
+static bool observation_within_object(const anjay_observation_t *observation,
+                                      anjay_oid_t oid) {
+    for (size_t i = 0; i < observation->paths_count; ++i) {
+        if (!_anjay_uri_path_has(&observation->paths[i], ANJAY_ID_OID)
+                || observation->paths[i].ids[ANJAY_ID_OID] == oid) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void _anjay_observe_attrs_cache_invalidate_object(anjay_unlocked_t *anjay,
+                                                  anjay_oid_t oid) {
+    ++anjay->observe.attrs_cache_object_invalidations;
+    AVS_LIST(anjay_observe_connection_entry_t) conn;
+    AVS_LIST_FOREACH(conn, anjay->observe.connection_entries) {
+        AVS_SORTED_SET_ELEM(anjay_observation_t) observation;
+        AVS_SORTED_SET_FOREACH(observation, conn->observations) {
+            if (observation_within_object(observation, oid)) {
+                observation->cached_attrs_generation = 0;
+            }
+        }
+    }
+}
+
+static bool cached_attrs_valid(anjay_unlocked_t *anjay,
+                               const anjay_observation_t *observation) {
+    return observation->cached_attrs_generation
+                   == anjay->observe.attrs_cache_generation
+#        ifdef ANJAY_WITH_ATTR_STORAGE
+           && observation->cached_attrs_attr_storage_modification_count
+                      == anjay->attr_storage.modification_count
+#        endif // ANJAY_WITH_ATTR_STORAGE
+            ;
+}
+#    endif // ANJAY_WITH_OBSERVE_ATTRS_CACHE
+
+/**
+ * Gets effective attributes of the @p path_index -th path of @p observation,
+ * resolving attributes of all its paths if they are not cached.
+ */
+static int get_observation_attrs(anjay_unlocked_t *anjay,
+                                 anjay_dm_r_attributes_t *out_attrs,
+                                 anjay_observation_t *observation,
+                                 size_t path_index,
+                                 anjay_ssid_t ssid) {
+    assert(path_index < observation->paths_count);
+#    ifdef ANJAY_WITH_OBSERVE_ATTRS_CACHE
+    if (!cached_attrs_valid(anjay, observation)) {
+        // data model handlers called below might invalidate the cache again,
+        // in which case the resolved attributes may already be stale
+        const uint32_t generation = anjay->observe.attrs_cache_generation;
+        const uint32_t object_invalidations =
+                anjay->observe.attrs_cache_object_invalidations;
+#        ifdef ANJAY_WITH_ATTR_STORAGE
+        const uint32_t attr_storage_modification_count =
+                anjay->attr_storage.modification_count;
+#        endif // ANJAY_WITH_ATTR_STORAGE
+        observation->cached_attrs_generation = 0;
+        for (size_t i = 0; i < observation->paths_count; ++i) {
+            int result = get_effective_attrs(anjay,
+                                             &observation->cached_attrs[i],
+                                             &observation->paths[i], ssid);
+            if (result) {
+                return result;
+            }
+        }
+        if (object_invalidations
+                == anjay->observe.attrs_cache_object_invalidations) {
+            observation->cached_attrs_generation = generation;
+        }
+#        ifdef ANJAY_WITH_ATTR_STORAGE
+        observation->cached_attrs_attr_storage_modification_count =
+                attr_storage_modification_count;
+#        endif // ANJAY_WITH_ATTR_STORAGE
+    }
+    *out_attrs = observation->cached_attrs[path_index];
+    return 0;
+#    else  // ANJAY_WITH_OBSERVE_ATTRS_CACHE
+    return get_effective_attrs(anjay, out_attrs,
+                               &observation->paths[path_index], ssid);
+#    endif // ANJAY_WITH_OBSERVE_ATTRS_CACHE
+}
+
 static inline bool is_pmax_valid(anjay_dm_oi_attributes_t attr) {
     if (attr.max_period < 0) {
         return false;
@@ -657,9 +760,9 @@ int _anjay_observe_schedule_pmax_trigger(
 
     for (size_t i = 0; i < observation->paths_count; ++i) {
         anjay_dm_r_attributes_t attrs;
-        int result = get_effective_attrs(
+        int result = get_observation_attrs(
                 _anjay_from_server(conn_state->conn_ref.server), &attrs,
-                &observation->paths[i],
+                observation, i,
                 _anjay_server_ssid(conn_state->conn_ref.server));
         if (result) {
             anjay_log(DEBUG,
@@ -713,15 +816,28 @@ static AVS_SORTED_SET_ELEM(anjay_observation_t)
 create_detached_observation(const avs_coap_token_t *token,
                             const anjay_request_t *request,
                             const paths_arg_t *paths) {
+    size_t size = offsetof(anjay_observation_t, paths)
+                  + paths->count * sizeof(const anjay_uri_path_t);
+#    ifdef ANJAY_WITH_OBSERVE_ATTRS_CACHE
+    const size_t cached_attrs_align = AVS_ALIGNOF(anjay_dm_r_attributes_t);
+    const size_t cached_attrs_offset =
+            (size + cached_attrs_align - 1) / cached_attrs_align
+            * cached_attrs_align;
+    size = cached_attrs_offset
+           + paths->count * sizeof(anjay_dm_r_attributes_t);
+#    endif // ANJAY_WITH_OBSERVE_ATTRS_CACHE
     AVS_SORTED_SET_ELEM(anjay_observation_t) new_observation =
             (AVS_SORTED_SET_ELEM(anjay_observation_t))
-                    AVS_SORTED_SET_ELEM_NEW_BUFFER(
-                            offsetof(anjay_observation_t, paths)
-                            + paths->count * sizeof(const anjay_uri_path_t));
+                    AVS_SORTED_SET_ELEM_NEW_BUFFER(size);
     if (!new_observation) {
         _anjay_log_oom();
         return NULL;
     }
+#    ifdef ANJAY_WITH_OBSERVE_ATTRS_CACHE
+    new_observation->cached_attrs =
+            (anjay_dm_r_attributes_t *) ((char *) new_observation
+                                         + cached_attrs_offset);
+#    endif // ANJAY_WITH_OBSERVE_ATTRS_CACHE
     memcpy((void *) (intptr_t) (const void *) &new_observation->token, token,
            sizeof(*token));
     memcpy((void *) (intptr_t) (const void *) &new_observation->action,
@@ -788,6 +904,7 @@ find_or_create_connection_state(anjay_connection_ref_t ref) {
                sizeof(ref));
         (*conn_ptr)->next_trigger = AVS_TIME_REAL_INVALID;
         (*conn_ptr)->next_pmax_trigger = AVS_TIME_REAL_INVALID;
+        _anjay_query_snapshot_mark_dirty(_anjay_from_server(ref.server));
     }
     return conn_ptr;
 }
@@ -864,6 +981,7 @@ static void
 recalculate_conn_trigger_times(anjay_observe_connection_entry_t *conn) {
     avs_time_monotonic_t monotonic_now = avs_time_monotonic_now();
     avs_time_real_t real_now = avs_time_real_now();
+    _anjay_query_snapshot_mark_dirty(_anjay_from_server(conn->conn_ref.server));
     conn->next_trigger = AVS_TIME_REAL_INVALID;
     conn->next_pmax_trigger = AVS_TIME_REAL_INVALID;
     AVS_SORTED_SET_ELEM(anjay_observation_t) observation;
@@ -1027,6 +1145,18 @@ static anjay_uri_path_t get_response_path(anjay_observation_value_t *value) {
     return observation->paths[0];
 }
 
+#    ifdef ANJAY_WITH_INSTRUMENTATION
+static void
+add_serialization_time(anjay_observation_serialization_state_t *state,
+                       avs_time_monotonic_t start) {
+    state->serialization_duration = avs_time_duration_add(
+            state->serialization_duration,
+            avs_time_monotonic_diff(avs_time_monotonic_now(), start));
+}
+#    else // ANJAY_WITH_INSTRUMENTATION
+#        define add_serialization_time(...) ((void) 0)
+#    endif // ANJAY_WITH_INSTRUMENTATION
+
 static int write_notify_payload(size_t payload_offset,
                                 void *payload_buf,
                                 size_t payload_buf_size,
@@ -1043,6 +1173,7 @@ static int write_notify_payload(size_t payload_offset,
         return -1;
     }
 
+    ANJAY_INSTR_START(start);
     anjay_unlocked_t *anjay = _anjay_from_server(conn->conn_ref.server);
     anjay_observation_value_t *value = conn->unsent;
     anjay_observation_t *observation = value->ref;
@@ -1075,12 +1206,19 @@ static int write_notify_payload(size_t payload_offset,
                     >= observation->paths_count) {
                 result = _anjay_output_ctx_destroy_and_process_result(
                         &conn->serialization_state.out_ctx, result);
+                add_serialization_time(&conn->serialization_state, start);
+                _anjay_instr_record_duration(
+                        anjay, ANJAY_INSTR_PROBE_SERIALIZATION,
+                        conn->serialization_state.serialization_duration);
             }
         }
         if (result) {
             return result;
         }
     }
+    if (conn->serialization_state.out_ctx) {
+        add_serialization_time(&conn->serialization_state, start);
+    }
     *out_payload_chunk_size = (size_t) (write_ptr - (char *) payload_buf);
     conn->serialization_state.expected_offset += *out_payload_chunk_size;
     return 0;
@@ -1127,6 +1265,44 @@ static int multiple_batches_item_count(anjay_unlocked_t *anjay,
     return 0;
 }
 
+typedef struct {
+    anjay_unlocked_t *anjay;
+    size_t values_count;
+    const anjay_batch_t *const *values;
+} batch_array_output_args_t;
+
+static int output_batch_array(anjay_unlocked_output_ctx_t *out_ctx,
+                              void *args_) {
+    const batch_array_output_args_t *args =
+            (const batch_array_output_args_t *) args_;
+    int result = 0;
+    for (size_t i = 0; !result && i < args->values_count; ++i) {
+        // NOTE: Access Control permissions have been checked during the
+        // read_as_batch() stage, so we're "spoofing" ANJAY_SSID_BOOTSTRAP
+        // as the permissions are checked now
+        result = _anjay_batch_data_output(args->anjay, args->values[i],
+                                          ANJAY_SSID_BOOTSTRAP, out_ctx);
+    }
+    return result;
+}
+
+/**
+ * Batches are immutable, so they can be serialized twice - this allows the TLV
+ * encoder to compute lengths of nested entities up front and stream them
+ * directly, instead of buffering whole Object Instances in memory.
+ */
+static int precompute_tlv_lengths(anjay_unlocked_output_ctx_t *out_ctx,
+                                  batch_array_output_args_t *args) {
+#    ifndef ANJAY_WITHOUT_TLV
+    return _anjay_output_tlv_precompute_lengths(out_ctx, output_batch_array,
+                                                args);
+#    else  // ANJAY_WITHOUT_TLV
+    (void) out_ctx;
+    (void) args;
+    return 0;
+#    endif // ANJAY_WITHOUT_TLV
+}
+
 static int send_initial_response(anjay_unlocked_t *anjay,
                                  const anjay_msg_details_t *details,
                                  const anjay_request_t *request,
@@ -1149,6 +1325,7 @@ static int send_initial_response(anjay_unlocked_t *anjay,
            // !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
 
     size_t item_count;
+    ANJAY_INSTR_START(start);
     anjay_unlocked_output_ctx_t *out_ctx = NULL;
     int result = _anjay_output_dynamic_construct(
             &out_ctx, notify_stream, &root_path, details->format,
@@ -1157,14 +1334,20 @@ static int send_initial_response(anjay_unlocked_t *anjay,
                     ? NULL
                     : &item_count,
             request->action);
-    for (size_t i = 0; !result && i < values_count; ++i) {
-        // NOTE: Access Control permissions have been checked during the
-        // read_as_batch() stage, so we're "spoofing" ANJAY_SSID_BOOTSTRAP
-        // as the permissions are checked now
-        result = _anjay_batch_data_output(anjay, values[i],
-                                          ANJAY_SSID_BOOTSTRAP, out_ctx);
+    batch_array_output_args_t args = {
+        .anjay = anjay,
+        .values_count = values_count,
+        .values = values
+    };
+    if (!result) {
+        result = precompute_tlv_lengths(out_ctx, &args);
+    }
+    if (!result) {
+        result = output_batch_array(out_ctx, &args);
     }
-    return _anjay_output_ctx_destroy_and_process_result(&out_ctx, result);
+    result = _anjay_output_ctx_destroy_and_process_result(&out_ctx, result);
+    _anjay_instr_record(anjay, ANJAY_INSTR_PROBE_SERIALIZATION, start);
+    return result;
 }
 
 #    ifdef ANJAY_TEST
@@ -1558,26 +1741,34 @@ initialize_serialization_state(anjay_observe_connection_entry_t *conn) {
     assert(!conn->serialization_state.out_ctx);
     memset(&conn->serialization_state, 0, sizeof(conn->serialization_state));
 
+    ANJAY_INSTR_START(start);
     anjay_observation_value_t *value = conn->unsent;
     const anjay_uri_path_t root_path = get_response_path(value);
 
+    anjay_unlocked_t *anjay = _anjay_from_server(conn->conn_ref.server);
+    batch_array_output_args_t args = {
+        .anjay = anjay,
+        .values_count = value->ref->paths_count,
+        .values = cast_to_const_batch_array(value->values)
+    };
     size_t item_count;
     if (!(conn->serialization_state.membuf_stream = avs_stream_membuf_create())
             || _anjay_output_dynamic_construct(
                        &conn->serialization_state.out_ctx,
                        conn->serialization_state.membuf_stream, &root_path,
                        value->details.format,
-                       multiple_batches_item_count(
-                               _anjay_from_server(conn->conn_ref.server),
-                               value->ref->paths_count,
-                               cast_to_const_batch_array(value->values),
-                               &item_count)
+                       multiple_batches_item_count(anjay, args.values_count,
+                                                   args.values, &item_count)
                                ? NULL
                                : &item_count,
-                       value->ref->action)) {
+                       value->ref->action)
+            || precompute_tlv_lengths(conn->serialization_state.out_ctx,
+                                      &args)) {
+        cleanup_serialization_state(&conn->serialization_state);
         return -1;
     }
     conn->serialization_state.serialization_time = avs_time_real_now();
+    add_serialization_time(&conn->serialization_state, start);
     return 0;
 }
 
@@ -1605,6 +1796,7 @@ handle_notify_delivery(avs_coap_ctx_t *coap, avs_error_t err, void *conn_) {
 
 static void flush_next_unsent(anjay_observe_connection_entry_t *conn) {
     assert(conn->unsent);
+    ANJAY_INSTR_START(start);
     anjay_observation_t *observation = conn->unsent->ref;
     anjay_msg_details_t details = conn->unsent->details;
 
@@ -1647,6 +1839,7 @@ static void flush_next_unsent(anjay_observe_connection_entry_t *conn) {
             // may be called by avs_coap_notify_async(), which may invalidate
             // conn. That's also why we need this intermediate exchange_id
             avs_coap_exchange_id_t exchange_id = AVS_COAP_EXCHANGE_ID_INVALID;
+            _anjay_query_snapshot_mark_dirty(anjay);
             err = avs_coap_notify_async(coap, &exchange_id,
                                         (avs_coap_observe_id_t) {
                                             .token = observation->token
@@ -1683,6 +1876,7 @@ static void flush_next_unsent(anjay_observe_connection_entry_t *conn) {
         _anjay_server_set_last_communication_time(conn_ref.server);
     }
 #    endif // ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
+    _anjay_instr_record(anjay, ANJAY_INSTR_PROBE_NOTIFICATION, start);
 }
 
 void _anjay_observe_interrupt(anjay_connection_ref_t ref) {
@@ -1743,6 +1937,20 @@ int _anjay_observe_sched_flush(anjay_connection_ref_t ref) {
     return sched_flush(*conn_ptr);
 }
 
+#    ifdef ANJAY_WITH_INSTRUMENTATION
+void _anjay_observe_count_queued(anjay_unlocked_t *anjay,
+                                 size_t *out_unsent,
+                                 size_t *inout_in_delivery) {
+    *out_unsent += count_queued_notifications(&anjay->observe);
+    AVS_LIST(anjay_observe_connection_entry_t) conn;
+    AVS_LIST_FOREACH(conn, anjay->observe.connection_entries) {
+        if (avs_coap_exchange_id_valid(conn->notify_exchange_id)) {
+            ++*inout_in_delivery;
+        }
+    }
+}
+#    endif // ANJAY_WITH_INSTRUMENTATION
+
 static int
 update_notification_value(anjay_observe_connection_entry_t *conn_state,
                           anjay_observation_t *observation) {
@@ -1769,8 +1977,8 @@ update_notification_value(anjay_observe_connection_entry_t *conn_state,
     int result = 0;
     for (size_t i = 0; i < observation->paths_count; ++i) {
         anjay_dm_r_attributes_t attrs;
-        if ((result = get_effective_attrs(anjay, &attrs, &observation->paths[i],
-                                          ssid))) {
+        if ((result = get_observation_attrs(anjay, &attrs, observation, i,
+                                            ssid))) {
             anjay_log(ERROR, _("Could not get attributes of path ") "%s",
                       ANJAY_DEBUG_MAKE_PATH(&observation->paths[i]));
             goto finish;
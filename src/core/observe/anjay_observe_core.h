@@ -34,6 +34,22 @@ typedef struct {
 
     notify_queue_limit_mode_t notify_queue_limit_mode;
     size_t notify_queue_limit;
+
+#ifdef ANJAY_WITH_OBSERVE_ATTRS_CACHE
+    /**
+     * Incremented whenever effective attributes of any path might have
+     * changed. Attributes cached in observations are only valid if they were
+     * resolved at the current generation. Never 0, so that zero-initialized
+     * observations start with an invalid cache.
+     */
+    uint32_t attrs_cache_generation;
+    /**
+     * Incremented whenever attributes cached in some of the observations are
+     * dropped by @ref _anjay_observe_attrs_cache_invalidate_object. Used to
+     * detect such invalidation while attributes are being resolved.
+     */
+    uint32_t attrs_cache_object_invalidations;
+#endif // ANJAY_WITH_OBSERVE_ATTRS_CACHE
 } anjay_observe_state_t;
 
 typedef struct {
@@ -75,6 +91,24 @@ void _anjay_observe_interrupt(anjay_connection_ref_t ref);
 
 void _anjay_observe_invalidate(anjay_connection_ref_t ref);
 
+#    ifdef ANJAY_WITH_OBSERVE_ATTRS_CACHE
+/**
+ * Drops effective attributes cached in all observations. Shall be called
+ * whenever attributes of any path might have changed other than through
+ * Attribute Storage, which is tracked separately.
+ */
+void _anjay_observe_attrs_cache_invalidate(anjay_unlocked_t *anjay);
+
+/**
+ * Drops effective attributes cached in observations of paths that lie within
+ * Object @p oid (or contain it). Attributes of paths in other Objects do not
+ * depend on it, unless @p oid is the Server Object, in which case
+ * @ref _anjay_observe_attrs_cache_invalidate shall be used instead.
+ */
+void _anjay_observe_attrs_cache_invalidate_object(anjay_unlocked_t *anjay,
+                                                  anjay_oid_t oid);
+#    endif // ANJAY_WITH_OBSERVE_ATTRS_CACHE
+
 bool _anjay_observe_confirmable_in_delivery(anjay_connection_ref_t ref);
 
 #    ifndef ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
@@ -83,6 +117,16 @@ bool _anjay_observe_needs_flushing(anjay_connection_ref_t ref);
 
 int _anjay_observe_sched_flush(anjay_connection_ref_t ref);
 
+#    ifdef ANJAY_WITH_INSTRUMENTATION
+/**
+ * Increments @p out_unsent by the number of queued notifications and
+ * @p inout_in_delivery by the number of notifications currently in delivery.
+ */
+void _anjay_observe_count_queued(anjay_unlocked_t *anjay,
+                                 size_t *out_unsent,
+                                 size_t *inout_in_delivery);
+#    endif // ANJAY_WITH_INSTRUMENTATION
+
 int _anjay_observe_notify(anjay_unlocked_t *anjay,
                           const anjay_uri_path_t *path,
                           anjay_ssid_t ssid,
@@ -96,6 +140,11 @@ _anjay_observe_status(anjay_unlocked_t *anjay,
                       anjay_rid_t rid);
 #    endif // ANJAY_WITH_OBSERVATION_STATUS
 
+#    ifdef ANJAY_QUERY_SNAPSHOT_DEFINED
+void _anjay_observe_publish_planned_triggers(anjay_unlocked_t *anjay,
+                                             anjay_atomic_fields_t *fields);
+#    endif // ANJAY_QUERY_SNAPSHOT_DEFINED
+
 #else // ANJAY_WITH_OBSERVE
 
 #    define _anjay_observe_init(...) ((void) 0)
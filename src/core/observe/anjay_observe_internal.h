@@ -39,6 +39,20 @@ struct anjay_observation_struct {
     // to this resource+format or not)
     AVS_LIST(anjay_observation_value_t) last_unsent;
 
+#ifdef ANJAY_WITH_OBSERVE_ATTRS_CACHE
+    // effective attributes of each of the paths; points to an array of
+    // paths_count elements allocated together with the observation, after
+    // the paths array
+    anjay_dm_r_attributes_t *cached_attrs;
+    // cached_attrs are only valid if these are equal to
+    // anjay_observe_state_t::attrs_cache_generation and
+    // anjay_attr_storage_t::modification_count, respectively
+    uint32_t cached_attrs_generation;
+#    ifdef ANJAY_WITH_ATTR_STORAGE
+    uint32_t cached_attrs_attr_storage_modification_count;
+#    endif // ANJAY_WITH_ATTR_STORAGE
+#endif     // ANJAY_WITH_OBSERVE_ATTRS_CACHE
+
     const size_t paths_count;
     const anjay_uri_path_t paths[];
 };
@@ -58,6 +72,11 @@ typedef struct {
     avs_time_real_t serialization_time;
     size_t curr_value_idx;
     const anjay_batch_data_output_state_t *output_state;
+#ifdef ANJAY_WITH_INSTRUMENTATION
+    // Time spent serializing the payload so far, not including the time spent
+    // waiting for the network between blocks.
+    avs_time_duration_t serialization_duration;
+#endif // ANJAY_WITH_INSTRUMENTATION
 } anjay_observation_serialization_state_t;
 
 struct anjay_observe_connection_entry_struct {
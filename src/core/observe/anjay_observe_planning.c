@@ -15,6 +15,10 @@
 
 VISIBILITY_SOURCE_BEGIN
 
+#if defined(ANJAY_WITH_OBSERVE) && defined(ANJAY_QUERY_SNAPSHOT_DEFINED)
+#    define PUBLISHED_TRIGGERS_DEFINED
+#endif // defined(ANJAY_WITH_OBSERVE) && defined(ANJAY_QUERY_SNAPSHOT_DEFINED)
+
 #ifdef ANJAY_WITH_OBSERVE
 typedef int foreach_relevant_connection_cb_t(
         AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr, void *data);
@@ -112,24 +116,63 @@ next_planned_trigger_cb(AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr,
 }
 #endif // ANJAY_WITH_OBSERVE
 
-static avs_time_real_t next_planned_trigger(anjay_t *anjay_locked,
-                                            anjay_ssid_t ssid,
-                                            unsigned conn_type_mask,
-                                            anjay_transport_set_t transport_set,
-                                            size_t trigger_field_offset) {
+static avs_time_real_t
+next_planned_trigger_unlocked(anjay_unlocked_t *anjay,
+                              anjay_ssid_t ssid,
+                              unsigned conn_type_mask,
+                              anjay_transport_set_t transport_set,
+                              size_t trigger_field_offset) {
     next_planned_trigger_cb_arg_t arg = {
         .trigger_field_offset = trigger_field_offset,
         .result = AVS_TIME_REAL_INVALID
     };
-    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     foreach_relevant_connection(anjay, ssid, conn_type_mask, transport_set,
                                 next_planned_trigger_cb, &arg);
-    ANJAY_MUTEX_UNLOCK(anjay_locked);
     return arg.result;
 }
 
+static avs_time_real_t next_planned_trigger(anjay_t *anjay_locked,
+                                            anjay_ssid_t ssid,
+                                            unsigned conn_type_mask,
+                                            anjay_transport_set_t transport_set,
+                                            size_t trigger_field_offset) {
+    avs_time_real_t result = AVS_TIME_REAL_INVALID;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    result = next_planned_trigger_unlocked(anjay, ssid, conn_type_mask,
+                                           transport_set, trigger_field_offset);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+#ifdef PUBLISHED_TRIGGERS_DEFINED
+static void publish_trigger_time(volatile atomic_int_least64_t *out,
+                                 avs_time_real_t value) {
+    int64_t value_ns;
+    if (!avs_time_real_valid(value)
+            || avs_time_real_to_scalar(&value_ns, AVS_TIME_NS, value)) {
+        value_ns = INT64_MIN;
+    }
+    atomic_store(out, value_ns);
+}
+
+static avs_time_real_t
+published_trigger_time(const volatile atomic_int_least64_t *value) {
+    int64_t value_ns = atomic_load(value);
+    if (value_ns == INT64_MIN) {
+        return AVS_TIME_REAL_INVALID;
+    }
+    return avs_time_real_from_scalar(value_ns, AVS_TIME_NS);
+}
+#endif // PUBLISHED_TRIGGERS_DEFINED
+
 avs_time_real_t anjay_next_planned_notify_trigger(anjay_t *anjay,
                                                   anjay_ssid_t ssid) {
+#ifdef PUBLISHED_TRIGGERS_DEFINED
+    if (ssid == ANJAY_SSID_ANY) {
+        return published_trigger_time(
+                &anjay->atomic_fields.next_notify_trigger_ns);
+    }
+#endif // PUBLISHED_TRIGGERS_DEFINED
     return next_planned_trigger(
             anjay, ssid, 1 << ANJAY_CONNECTION_PRIMARY, ANJAY_TRANSPORT_SET_ALL,
             offsetof(anjay_observe_connection_entry_t, next_trigger));
@@ -137,6 +180,12 @@ avs_time_real_t anjay_next_planned_notify_trigger(anjay_t *anjay,
 
 avs_time_real_t anjay_next_planned_pmax_notify_trigger(anjay_t *anjay,
                                                        anjay_ssid_t ssid) {
+#ifdef PUBLISHED_TRIGGERS_DEFINED
+    if (ssid == ANJAY_SSID_ANY) {
+        return published_trigger_time(
+                &anjay->atomic_fields.next_pmax_notify_trigger_ns);
+    }
+#endif // PUBLISHED_TRIGGERS_DEFINED
     return next_planned_trigger(
             anjay, ssid, 1 << ANJAY_CONNECTION_PRIMARY, ANJAY_TRANSPORT_SET_ALL,
             offsetof(anjay_observe_connection_entry_t, next_pmax_trigger));
@@ -173,6 +222,12 @@ static int has_unsent_notifications_cb(
 
 bool anjay_has_unsent_notifications(anjay_t *anjay_locked, anjay_ssid_t ssid) {
     bool result = false;
+#ifdef PUBLISHED_TRIGGERS_DEFINED
+    if (ssid == ANJAY_SSID_ANY) {
+        return atomic_load(
+                &anjay_locked->atomic_fields.has_unsent_notifications);
+    }
+#endif // PUBLISHED_TRIGGERS_DEFINED
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     foreach_relevant_connection(anjay, ssid, 1 << ANJAY_CONNECTION_PRIMARY,
                                 ANJAY_TRANSPORT_SET_ALL,
@@ -192,3 +247,51 @@ bool anjay_transport_has_unsent_notifications(
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return result;
 }
+
+#ifdef PUBLISHED_TRIGGERS_DEFINED
+typedef struct {
+    next_planned_trigger_cb_arg_t next_trigger;
+    next_planned_trigger_cb_arg_t next_pmax_trigger;
+    bool has_unsent;
+} planned_triggers_t;
+
+static int
+planned_triggers_cb(AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr,
+                    void *out_triggers_) {
+    planned_triggers_t *out_triggers = (planned_triggers_t *) out_triggers_;
+    next_planned_trigger_cb(conn_ptr, &out_triggers->next_trigger);
+    next_planned_trigger_cb(conn_ptr, &out_triggers->next_pmax_trigger);
+    if (!out_triggers->has_unsent) {
+        has_unsent_notifications_cb(conn_ptr, &out_triggers->has_unsent);
+    }
+    return 0;
+}
+
+void _anjay_observe_publish_planned_triggers(anjay_unlocked_t *anjay,
+                                             anjay_atomic_fields_t *fields) {
+    // All values are gathered in a single walk over the connections, as this
+    // may be done on every ANJAY_MUTEX_UNLOCK()
+    planned_triggers_t triggers = {
+        .next_trigger = {
+            .trigger_field_offset =
+                    offsetof(anjay_observe_connection_entry_t, next_trigger),
+            .result = AVS_TIME_REAL_INVALID
+        },
+        .next_pmax_trigger = {
+            .trigger_field_offset = offsetof(anjay_observe_connection_entry_t,
+                                             next_pmax_trigger),
+            .result = AVS_TIME_REAL_INVALID
+        },
+        .has_unsent = false
+    };
+    foreach_relevant_connection(anjay, ANJAY_SSID_ANY,
+                                1 << ANJAY_CONNECTION_PRIMARY,
+                                ANJAY_TRANSPORT_SET_ALL, planned_triggers_cb,
+                                &triggers);
+    publish_trigger_time(&fields->next_notify_trigger_ns,
+                         triggers.next_trigger.result);
+    publish_trigger_time(&fields->next_pmax_notify_trigger_ns,
+                         triggers.next_pmax_trigger.result);
+    atomic_store(&fields->has_unsent_notifications, triggers.has_unsent);
+}
+#endif // PUBLISHED_TRIGGERS_DEFINED
@@ -25,6 +25,7 @@
 #include "anjay_register.h"
 #include "anjay_server_connections.h"
 #include "anjay_servers_internal.h"
+#include "anjay_session_persistence.h"
 
 VISIBILITY_SOURCE_BEGIN
 
@@ -645,6 +646,7 @@ _anjay_servers_create_inactive(anjay_unlocked_t *anjay, anjay_ssid_t ssid) {
             AVS_TIME_REAL_INVALID;
     new_server->last_communication_time = AVS_TIME_REAL_INVALID;
 #endif // ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
+    _anjay_server_apply_pending_session_state(new_server);
     return new_server;
 }
 
@@ -621,6 +621,7 @@ void _anjay_server_connections_refresh(anjay_server_info_t *server,
         .ssid = server->ssid,
         .security_iid = security_iid,
     };
+    _anjay_query_snapshot_mark_dirty(server->anjay);
     if (*move_uri) {
         server_info.uri = *move_uri;
         server_info.transport_info = _anjay_transport_info_by_uri_scheme(
@@ -704,6 +704,7 @@ static void send_register(anjay_server_info_t *server,
 #ifdef ANJAY_WITH_LWM2M11
     server->registration_exchange_state.lwm2m11_queue_mode = lwm2m11_queue_mode;
 #endif // ANJAY_WITH_LWM2M11
+    _anjay_query_snapshot_mark_dirty(server->anjay);
     if (avs_is_err(
                 (err = avs_coap_client_send_async_request(
                          coap, &server->registration_exchange_state.exchange_id,
@@ -994,6 +995,7 @@ static void send_update(anjay_server_info_t *server,
             (old_info->queue_mode
              && old_info->lwm2m_version >= ANJAY_LWM2M_VERSION_1_1);
 #endif // ANJAY_WITH_LWM2M11
+    _anjay_query_snapshot_mark_dirty(server->anjay);
     if (avs_is_err((
                 err = avs_coap_client_send_async_request(
                         coap, &server->registration_exchange_state.exchange_id,
@@ -1165,6 +1167,7 @@ static avs_error_t deregister(anjay_server_info_t *server) {
         goto end;
     }
 
+    _anjay_query_snapshot_mark_dirty(server->anjay);
     if (avs_is_err((err = avs_coap_streaming_send_request(
                             coap, &request, NULL, NULL, &response, NULL)))) {
         anjay_log(ERROR, _("Could not perform De-registration"));
@@ -27,6 +27,7 @@
 #include "anjay_register.h"
 #include "anjay_server_connections.h"
 #include "anjay_servers_internal.h"
+#include "anjay_session_persistence.h"
 
 VISIBILITY_SOURCE_BEGIN
 
@@ -74,6 +75,7 @@ void _anjay_servers_deregister(anjay_unlocked_t *anjay) {
 
 void _anjay_servers_cleanup(anjay_unlocked_t *anjay) {
     _anjay_servers_internal_cleanup(&anjay->servers);
+    _anjay_servers_clear_pending_session_states(anjay);
     AVS_LIST_CLEAR(&anjay->cached_public_sockets);
 }
 
@@ -328,6 +330,8 @@ static void server_next_action_job(avs_sched_t *sched, const void *server_ptr) {
     anjay_t *anjay_locked = _anjay_get_from_sched(sched);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     anjay_server_info_t *server = *(anjay_server_info_t *const *) server_ptr;
+    // All of the actions below may change the set of active servers
+    _anjay_query_snapshot_mark_dirty(anjay);
     switch (server->next_action) {
     case ANJAY_SERVER_NEXT_ACTION_COMMUNICATION_ERROR:
         _anjay_server_on_failure(server, "not reachable");
@@ -384,6 +388,7 @@ int _anjay_server_reschedule_next_action(
     }
     if (!result) {
         server->next_action = next_action;
+        _anjay_query_snapshot_mark_dirty(server->anjay);
     }
     return result;
 }
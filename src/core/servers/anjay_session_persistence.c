@@ -0,0 +1,272 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <inttypes.h>
+#include <string.h>
+
+#ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
+#    include <avsystem/commons/avs_persistence.h>
+#endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
+
+#define ANJAY_SERVERS_INTERNALS
+
+#include "../anjay_core.h"
+
+#include "anjay_connections.h"
+#include "anjay_servers_internal.h"
+#include "anjay_session_persistence.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+struct anjay_server_session_state_struct {
+    anjay_ssid_t ssid;
+    anjay_connection_type_t conn_type;
+    anjay_server_connection_nontransient_state_t state;
+};
+
+void _anjay_server_apply_pending_session_state(anjay_server_info_t *server) {
+    AVS_LIST(anjay_server_session_state_t) *entry_ptr;
+    AVS_LIST(anjay_server_session_state_t) helper;
+    AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, helper,
+                                   &server->anjay->pending_session_states) {
+        if ((*entry_ptr)->ssid != server->ssid) {
+            continue;
+        }
+        anjay_server_connection_t *connection =
+                _anjay_connection_get(&server->connections,
+                                      (*entry_ptr)->conn_type);
+        if (!_anjay_connection_internal_get_socket(connection)) {
+            connection->nontransient_state = (*entry_ptr)->state;
+            anjay_log(DEBUG,
+                      _("restored session state for SSID ") "%" PRIu16
+                              _(", connection type ") "%d",
+                      server->ssid, (int) (*entry_ptr)->conn_type);
+        }
+        AVS_LIST_DELETE(entry_ptr);
+    }
+}
+
+void _anjay_servers_clear_pending_session_states(anjay_unlocked_t *anjay) {
+    AVS_LIST_CLEAR(&anjay->pending_session_states);
+}
+
+#ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
+
+/**
+ * NOTE: Magic header is followed by one byte which is supposed to be a version
+ * number.
+ *
+ * Known versions are:
+ * - 0: initial version
+ */
+static const char *MAGIC = "ACS";
+
+typedef enum {
+    SESSION_PERSISTENCE_VERSION_0,
+    SESSION_PERSISTENCE_VERSION_CURRENT = SESSION_PERSISTENCE_VERSION_0
+} session_persistence_version_t;
+
+static const uint8_t SUPPORTED_VERSIONS[] = { SESSION_PERSISTENCE_VERSION_0 };
+
+static bool is_zeroed(const void *buf, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        if (((const uint8_t *) buf)[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool is_state_worth_persisting(
+        const anjay_server_connection_nontransient_state_t *state) {
+    return *state->last_local_port
+           || !is_zeroed(state->dtls_session_buffer,
+                         sizeof(state->dtls_session_buffer));
+}
+
+/**
+ * Sizes of the buffers below depend on compile-time configuration, so they are
+ * stored along with the data. State persisted by a differently configured
+ * build is rejected instead of being misinterpreted.
+ */
+static avs_error_t handle_fixed_size_buffer(avs_persistence_context_t *ctx,
+                                            void *buffer,
+                                            size_t buffer_size) {
+    uint32_t size = (uint32_t) buffer_size;
+    avs_error_t err = avs_persistence_u32(ctx, &size);
+    if (avs_is_ok(err) && size != buffer_size) {
+        anjay_log(WARNING,
+                  _("persisted session state buffer size mismatch: ") "%" PRIu32
+                          _(" != ") "%lu",
+                  size, (unsigned long) buffer_size);
+        err = avs_errno(AVS_EBADMSG);
+    }
+    if (avs_is_ok(err)) {
+        err = avs_persistence_bytes(ctx, buffer, buffer_size);
+    }
+    return err;
+}
+
+static avs_error_t handle_session_state(avs_persistence_context_t *ctx,
+                                        void *element_,
+                                        void *user_data) {
+    (void) user_data;
+    anjay_server_session_state_t *element =
+            (anjay_server_session_state_t *) element_;
+    anjay_server_connection_nontransient_state_t *state = &element->state;
+    uint8_t conn_type = (uint8_t) element->conn_type;
+
+    avs_error_t err;
+    (void) (avs_is_err((err = avs_persistence_u16(ctx, &element->ssid)))
+            || avs_is_err((err = avs_persistence_u8(ctx, &conn_type)))
+#    ifndef ANJAY_WITHOUT_IP_STICKINESS
+            || avs_is_err((err = handle_fixed_size_buffer(
+                                   ctx, &state->preferred_endpoint,
+                                   sizeof(state->preferred_endpoint))))
+#    endif // ANJAY_WITHOUT_IP_STICKINESS
+            || avs_is_err((err = handle_fixed_size_buffer(
+                                   ctx, state->dtls_session_buffer,
+                                   sizeof(state->dtls_session_buffer))))
+            || avs_is_err((err = handle_fixed_size_buffer(
+                                   ctx, state->last_local_port,
+                                   sizeof(state->last_local_port)))));
+    if (avs_is_ok(err)
+            && (conn_type >= ANJAY_CONNECTION_LIMIT_
+                || !memchr(state->last_local_port, '\0',
+                           sizeof(state->last_local_port)))) {
+        err = avs_errno(AVS_EBADMSG);
+    }
+    element->conn_type = (anjay_connection_type_t) conn_type;
+    return err;
+}
+
+static int collect_session_states(anjay_unlocked_t *anjay,
+                                  AVS_LIST(anjay_server_session_state_t) *out) {
+    AVS_LIST(anjay_server_session_state_t) *tail = out;
+    AVS_LIST(anjay_server_info_t) server;
+    AVS_LIST_FOREACH(server, anjay->servers) {
+        anjay_connection_type_t conn_type;
+        ANJAY_CONNECTION_TYPE_FOREACH(conn_type) {
+            const anjay_server_connection_t *connection =
+                    _anjay_connection_get(&server->connections, conn_type);
+            if (!is_state_worth_persisting(&connection->nontransient_state)) {
+                continue;
+            }
+            if (!(*tail = AVS_LIST_NEW_ELEMENT(anjay_server_session_state_t))) {
+                goto fail;
+            }
+            (*tail)->ssid = server->ssid;
+            (*tail)->conn_type = conn_type;
+            (*tail)->state = connection->nontransient_state;
+            AVS_LIST_ADVANCE_PTR(&tail);
+        }
+    }
+    // State restored, but not consumed yet, is still worth keeping
+    AVS_LIST(anjay_server_session_state_t) pending;
+    AVS_LIST_FOREACH(pending, anjay->pending_session_states) {
+        if (!(*tail = AVS_LIST_NEW_ELEMENT(anjay_server_session_state_t))) {
+            goto fail;
+        }
+        **tail = *pending;
+        AVS_LIST_ADVANCE_PTR(&tail);
+    }
+    return 0;
+fail:
+    _anjay_log_oom();
+    AVS_LIST_CLEAR(out);
+    return -1;
+}
+
+avs_error_t anjay_session_state_persist(anjay_t *anjay_locked,
+                                        avs_stream_t *out_stream) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_server_session_state_t) states = NULL;
+    if (collect_session_states(anjay, &states)) {
+        err = avs_errno(AVS_ENOMEM);
+    } else {
+        avs_persistence_context_t ctx =
+                avs_persistence_store_context_create(out_stream);
+        uint8_t version = SESSION_PERSISTENCE_VERSION_CURRENT;
+        (void) (avs_is_err((err = avs_persistence_magic_string(&ctx, MAGIC)))
+                || avs_is_err((err = avs_persistence_version(
+                                       &ctx, &version, SUPPORTED_VERSIONS,
+                                       sizeof(SUPPORTED_VERSIONS))))
+                || avs_is_err((err = avs_persistence_list(
+                                       &ctx, (AVS_LIST(void) *) &states,
+                                       sizeof(anjay_server_session_state_t),
+                                       handle_session_state, NULL, NULL))));
+        if (avs_is_ok(err)) {
+            anjay_log(INFO, _("session state persisted"));
+        }
+        AVS_LIST_CLEAR(&states);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+avs_error_t anjay_session_state_restore(anjay_t *anjay_locked,
+                                        avs_stream_t *in_stream) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_server_session_state_t) states = NULL;
+    avs_persistence_context_t ctx =
+            avs_persistence_restore_context_create(in_stream);
+    uint8_t version = 0;
+    if (avs_is_err((err = avs_persistence_magic_string(&ctx, MAGIC)))
+            || avs_is_err((err = avs_persistence_version(
+                                   &ctx, &version, SUPPORTED_VERSIONS,
+                                   sizeof(SUPPORTED_VERSIONS))))
+            || avs_is_err((err = avs_persistence_list(
+                                   &ctx, (AVS_LIST(void) *) &states,
+                                   sizeof(anjay_server_session_state_t),
+                                   handle_session_state, NULL, NULL)))) {
+        anjay_log(WARNING, _("could not restore session state"));
+        AVS_LIST_CLEAR(&states);
+    } else {
+        _anjay_servers_clear_pending_session_states(anjay);
+        anjay->pending_session_states = states;
+
+        AVS_LIST(anjay_server_info_t) server;
+        AVS_LIST_FOREACH(server, anjay->servers) {
+            _anjay_server_apply_pending_session_state(server);
+        }
+        anjay_log(INFO, _("session state restored"));
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/core/servers/session_persistence.c"
+#    endif // ANJAY_TEST
+
+#else // AVS_COMMONS_WITH_AVS_PERSISTENCE
+
+avs_error_t anjay_session_state_persist(anjay_t *anjay,
+                                        avs_stream_t *out_stream) {
+    (void) anjay;
+    (void) out_stream;
+    _anjay_log(anjay, ERROR, _("Persistence not compiled in"));
+    return avs_errno(AVS_ENOTSUP);
+}
+
+avs_error_t anjay_session_state_restore(anjay_t *anjay,
+                                        avs_stream_t *in_stream) {
+    (void) anjay;
+    (void) in_stream;
+    _anjay_log(anjay, ERROR, _("Persistence not compiled in"));
+    return avs_errno(AVS_ENOTSUP);
+}
+
+#endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
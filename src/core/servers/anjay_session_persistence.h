@@ -0,0 +1,37 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_SERVERS_SESSION_PERSISTENCE_H
+#define ANJAY_SERVERS_SESSION_PERSISTENCE_H
+
+#include "../anjay_core.h"
+
+#if !defined(ANJAY_SERVERS_INTERNALS) && !defined(ANJAY_TEST)
+#    error "Headers from servers/ are not meant to be included from outside"
+#endif
+
+#include "anjay_servers_internal.h"
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Applies any session state restored by anjay_session_state_restore() that
+ * matches the SSID of @p server to its connections, and removes it from the
+ * pending list. Connections that already have a socket are left untouched.
+ */
+void _anjay_server_apply_pending_session_state(anjay_server_info_t *server);
+
+/**
+ * Discards all restored session state that has not been applied to any server.
+ */
+void _anjay_servers_clear_pending_session_states(anjay_unlocked_t *anjay);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif // ANJAY_SERVERS_SESSION_PERSISTENCE_H
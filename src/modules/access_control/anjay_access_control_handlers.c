@@ -69,7 +69,7 @@ ac_instance_reset(anjay_unlocked_t *anjay, obj_ptr_t obj_ptr, anjay_iid_t iid) {
     inst->has_acl = false;
     inst->owner = 0;
     access_control->needs_validation = true;
-    _anjay_access_control_mark_modified(access_control);
+    _anjay_access_control_mark_instance_modified(access_control, inst);
     return 0;
 }
 
@@ -249,7 +249,7 @@ static int ac_resource_write(anjay_unlocked_t *anjay,
         }
         inst->target.oid = (anjay_oid_t) oid;
         access_control->needs_validation = true;
-        _anjay_access_control_mark_modified(access_control);
+        _anjay_access_control_mark_instance_modified(access_control, inst);
         return 0;
     }
     case ANJAY_DM_RID_ACCESS_CONTROL_OIID: {
@@ -263,7 +263,7 @@ static int ac_resource_write(anjay_unlocked_t *anjay,
         }
         inst->target.iid = (anjay_iid_t) oiid;
         access_control->needs_validation = true;
-        _anjay_access_control_mark_modified(access_control);
+        _anjay_access_control_mark_instance_modified(access_control, inst);
         return 0;
     }
     case ANJAY_DM_RID_ACCESS_CONTROL_ACL: {
@@ -271,7 +271,7 @@ static int ac_resource_write(anjay_unlocked_t *anjay,
         if (!retval) {
             inst->has_acl = true;
             access_control->needs_validation = true;
-            _anjay_access_control_mark_modified(access_control);
+            _anjay_access_control_mark_instance_modified(access_control, inst);
         }
         return retval;
     }
@@ -286,7 +286,7 @@ static int ac_resource_write(anjay_unlocked_t *anjay,
         }
         inst->owner = (anjay_ssid_t) ssid;
         access_control->needs_validation = true;
-        _anjay_access_control_mark_modified(access_control);
+        _anjay_access_control_mark_instance_modified(access_control, inst);
         return 0;
     }
     default:
@@ -312,7 +312,7 @@ static int ac_resource_reset(anjay_unlocked_t *anjay,
     AVS_LIST_CLEAR(&inst->acl);
     inst->has_acl = true;
     access_control->needs_validation = true;
-    _anjay_access_control_mark_modified(access_control);
+    _anjay_access_control_mark_instance_modified(access_control, inst);
     return 0;
 }
 
@@ -471,6 +471,9 @@ static void ac_delete(void *access_control_) {
     access_control_t *access_control = (access_control_t *) access_control_;
     _anjay_access_control_clear_state(&access_control->current);
     _anjay_access_control_clear_state(&access_control->saved_state);
+#    ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
+    _anjay_journal_state_cleanup(&access_control->journal);
+#    endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
     // NOTE: access_control itself will be freed when cleaning the objects list
 }
 
@@ -19,6 +19,7 @@
 
 #    include "anjay_mod_access_control.h"
 
+#    include <stddef.h>
 #    include <string.h>
 
 VISIBILITY_SOURCE_BEGIN
@@ -130,12 +131,97 @@ restore_instances(anjay_unlocked_t *anjay,
     return AVS_OK;
 }
 
+static avs_error_t handle_journal_instance(avs_persistence_context_t *ctx,
+                                           void *element_,
+                                           uint8_t version) {
+    (void) version;
+    if (avs_persistence_direction(ctx) == AVS_PERSISTENCE_STORE) {
+        return persist_instance(ctx, element_, NULL);
+    }
+    access_control_instance_t *element = (access_control_instance_t *) element_;
+    avs_error_t err = avs_persistence_u16(ctx, &element->target.oid);
+    if (avs_is_ok(err)) {
+        err = restore_instance(element, ctx);
+    }
+    return err;
+}
+
+static void destroy_journal_instance(AVS_LIST(void) *element_ptr) {
+    AVS_LIST(access_control_instance_t) *instance_ptr =
+            (AVS_LIST(access_control_instance_t) *) element_ptr;
+    AVS_LIST_CLEAR(instance_ptr) {
+        AVS_LIST_CLEAR(&(*instance_ptr)->acl);
+    }
+}
+
+static const anjay_journal_instances_def_t JOURNAL_DEF = {
+    .element_size = sizeof(access_control_instance_t),
+    .iid_offset = offsetof(access_control_instance_t, iid),
+    .modified_offset =
+            offsetof(access_control_instance_t, modified_since_persist),
+    .version = 1,
+    .handle_instance = handle_journal_instance,
+    .destroy_instance = destroy_journal_instance
+};
+
+static AVS_LIST(access_control_instance_t) *
+persisted_instances_ptr(access_control_t *ac) {
+    return ac->in_transaction ? &ac->saved_state.instances
+                              : &ac->current.instances;
+}
+
+static void remove_unregistered_targets(
+        anjay_unlocked_t *anjay,
+        AVS_LIST(access_control_instance_t) *instances_ptr) {
+    while (*instances_ptr) {
+        if (is_object_registered(anjay, (*instances_ptr)->target.oid)) {
+            AVS_LIST_ADVANCE_PTR(&instances_ptr);
+        } else {
+            AVS_LIST(access_control_instance_t) instance =
+                    AVS_LIST_DETACH(instances_ptr);
+            destroy_journal_instance((AVS_LIST(void) *) &instance);
+        }
+    }
+}
+
+static const char MAGIC[] = { 'A', 'C', 'O', '\1' };
+
 static avs_error_t
-restore(anjay_unlocked_t *anjay, access_control_t *ac, avs_stream_t *in) {
+restore_snapshot(anjay_unlocked_t *anjay,
+                 AVS_LIST(access_control_instance_t) *instances_ptr,
+                 avs_stream_t *in) {
+    char magic_header[sizeof(MAGIC)];
+    avs_error_t err =
+            avs_stream_read_reliably(in, magic_header, sizeof(magic_header));
+    if (avs_is_err(err)) {
+        ac_log(WARNING, _("magic constant not found"));
+        return err;
+    }
+    if (memcmp(magic_header, MAGIC, sizeof(MAGIC))) {
+        ac_log(WARNING, _("header magic constant mismatch"));
+        return avs_errno(AVS_EBADMSG);
+    }
     avs_persistence_context_t restore_ctx =
             avs_persistence_restore_context_create(in);
+    return restore_instances(anjay, instances_ptr, &restore_ctx);
+}
+
+static avs_error_t restore(anjay_unlocked_t *anjay,
+                           access_control_t *ac,
+                           avs_stream_t *in,
+                           avs_stream_t *journal) {
     access_control_state_t state = { NULL, false };
-    avs_error_t err = restore_instances(anjay, &state.instances, &restore_ctx);
+    avs_error_t err = AVS_OK;
+    if (in) {
+        err = restore_snapshot(anjay, &state.instances, in);
+    }
+    if (avs_is_ok(err) && journal
+            && avs_is_ok((err = _anjay_journal_replay_instances(
+                                  &JOURNAL_DEF,
+                                  (AVS_LIST(void) *) &state.instances,
+                                  journal)))) {
+        remove_unregistered_targets(anjay, &state.instances);
+    }
     if (avs_is_err(err)) {
         _anjay_access_control_clear_state(&state);
         return err;
@@ -143,11 +229,11 @@ restore(anjay_unlocked_t *anjay, access_control_t *ac, avs_stream_t *in) {
     _anjay_access_control_clear_state(&ac->current);
     ac->current = state;
     ac->last_accessed_instance = NULL;
+    _anjay_journal_state_update(&ac->journal, &JOURNAL_DEF,
+                                ac->current.instances);
     return AVS_OK;
 }
 
-static const char MAGIC[] = { 'A', 'C', 'O', '\1' };
-
 avs_error_t anjay_access_control_persist(anjay_t *anjay_locked,
                                          avs_stream_t *out) {
     avs_error_t err = avs_errno(AVS_EINVAL);
@@ -160,14 +246,14 @@ avs_error_t anjay_access_control_persist(anjay_t *anjay_locked,
         avs_persistence_context_t ctx =
                 avs_persistence_store_context_create(out);
         AVS_LIST(access_control_instance_t) *list_ptr =
-                ac->in_transaction ? &ac->saved_state.instances
-                                   : &ac->current.instances;
+                persisted_instances_ptr(ac);
         err = avs_persistence_list(&ctx, (AVS_LIST(void) *) list_ptr,
                                    sizeof(**list_ptr), persist_instance, NULL,
                                    NULL);
         if (avs_is_ok(err)) {
             ac_log(INFO, _("Access Control state persisted"));
             _anjay_access_control_clear_modified(ac);
+            _anjay_journal_state_update(&ac->journal, &JOURNAL_DEF, *list_ptr);
         }
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
@@ -179,20 +265,13 @@ avs_error_t anjay_access_control_restore(anjay_t *anjay_locked,
     avs_error_t err = avs_errno(AVS_EINVAL);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     err = avs_errno(AVS_EBADF);
-    char magic_header[sizeof(MAGIC)];
     access_control_t *ac = _anjay_access_control_get(anjay);
     if (!ac) {
         ac_log(ERROR, _("Access Control not installed in this Anjay object"));
     } else if (ac->in_transaction) {
         ac_log(ERROR, _("Cannot restore Access Control state while the object "
                         "is in transaction"));
-    } else if (avs_is_err((err = avs_stream_read_reliably(
-                                   in, magic_header, sizeof(magic_header))))) {
-        ac_log(WARNING, _("magic constant not found"));
-    } else if (memcmp(magic_header, MAGIC, sizeof(MAGIC))) {
-        ac_log(WARNING, _("header magic constant mismatch"));
-        err = avs_errno(AVS_EBADMSG);
-    } else if (avs_is_ok((err = restore(anjay, ac, in)))) {
+    } else if (avs_is_ok((err = restore(anjay, ac, in, NULL)))) {
         _anjay_access_control_clear_modified(ac);
         ac_log(INFO, _("Access Control state restored"));
     }
@@ -200,6 +279,46 @@ avs_error_t anjay_access_control_restore(anjay_t *anjay_locked,
     return err;
 }
 
+avs_error_t anjay_access_control_journal_append(anjay_t *anjay_locked,
+                                                avs_stream_t *journal_stream) {
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    access_control_t *ac = _anjay_access_control_get(anjay);
+    if (!ac) {
+        ac_log(ERROR, _("Access Control not installed in this Anjay object"));
+        err = avs_errno(AVS_EBADF);
+    } else if (avs_is_ok((err = _anjay_journal_append_instances(
+                                  &ac->journal, &JOURNAL_DEF,
+                                  *persisted_instances_ptr(ac),
+                                  journal_stream)))) {
+        _anjay_access_control_clear_modified(ac);
+        ac_log(DEBUG, _("Access Control journal appended"));
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+avs_error_t anjay_access_control_journal_restore(anjay_t *anjay_locked,
+                                                 avs_stream_t *in_stream,
+                                                 avs_stream_t *journal_stream) {
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    err = avs_errno(AVS_EBADF);
+    access_control_t *ac = _anjay_access_control_get(anjay);
+    if (!ac) {
+        ac_log(ERROR, _("Access Control not installed in this Anjay object"));
+    } else if (ac->in_transaction) {
+        ac_log(ERROR, _("Cannot restore Access Control state while the object "
+                        "is in transaction"));
+    } else if (avs_is_ok((err = restore(anjay, ac, in_stream,
+                                        journal_stream)))) {
+        _anjay_access_control_clear_modified(ac);
+        ac_log(INFO, _("Access Control state restored from journal"));
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
 #        ifdef ANJAY_TEST
 #            include "tests/modules/access_control/persistence.c"
 #        endif // ANJAY_TEST
@@ -220,6 +339,24 @@ avs_error_t anjay_access_control_restore(anjay_t *anjay, avs_stream_t *in) {
     return avs_errno(AVS_ENOTSUP);
 }
 
+avs_error_t anjay_access_control_journal_append(anjay_t *anjay,
+                                                avs_stream_t *journal_stream) {
+    (void) anjay;
+    (void) journal_stream;
+    ac_log(ERROR, _("Persistence not compiled in"));
+    return avs_errno(AVS_ENOTSUP);
+}
+
+avs_error_t anjay_access_control_journal_restore(anjay_t *anjay,
+                                                 avs_stream_t *in_stream,
+                                                 avs_stream_t *journal_stream) {
+    (void) anjay;
+    (void) in_stream;
+    (void) journal_stream;
+    ac_log(ERROR, _("Persistence not compiled in"));
+    return avs_errno(AVS_ENOTSUP);
+}
+
 #    endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
 
 #endif // ANJAY_WITH_MODULE_ACCESS_CONTROL
@@ -108,6 +108,7 @@ int _anjay_access_control_add_instance(
         AVS_LIST(access_control_instance_t) instance,
         anjay_notify_queue_t *out_dm_changes) {
     assert(!AVS_LIST_NEXT(instance));
+    instance->modified_since_persist = true;
     if (instance->iid == ANJAY_ID_INVALID) {
         return add_instances_without_iids(access_control, &instance,
                                           out_dm_changes);
@@ -287,7 +288,7 @@ static int set_acl(anjay_unlocked_t *anjay,
     int result = set_acl_in_instance(anjay, ac_instance, ssid, access_mask);
     if (!ac_instance_needs_inserting) {
         if (!result) {
-            _anjay_access_control_mark_modified(ac);
+            _anjay_access_control_mark_instance_modified(ac, ac_instance);
             _anjay_notify_changed_unlocked(anjay, ANJAY_DM_OID_ACCESS_CONTROL,
                                            ac_instance->iid,
                                            ANJAY_DM_RID_ACCESS_CONTROL_ACL);
@@ -388,7 +389,7 @@ static int ac_set_owner_unlocked(anjay_unlocked_t *anjay,
     }
     int result = 0;
     if (!ac_instance_needs_inserting) {
-        _anjay_access_control_mark_modified(ac);
+        _anjay_access_control_mark_instance_modified(ac, ac_instance);
         _anjay_notify_changed_unlocked(anjay, ANJAY_DM_OID_ACCESS_CONTROL,
                                        ac_instance->iid,
                                        ANJAY_DM_RID_ACCESS_CONTROL_OWNER);
@@ -18,6 +18,7 @@
 
 #include <anjay_modules/anjay_dm_utils.h>
 #include <anjay_modules/anjay_notify.h>
+#include <anjay_modules/anjay_persistence_journal.h>
 #include <anjay_modules/anjay_utils_core.h>
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
@@ -40,6 +41,11 @@ typedef struct {
     anjay_ssid_t owner;
     bool has_acl;
     AVS_LIST(acl_entry_t) acl;
+    /**
+     * Set whenever the Instance is modified; used to find the Instances that
+     * need to be written by anjay_access_control_journal_append().
+     */
+    bool modified_since_persist;
 } access_control_instance_t;
 
 typedef struct {
@@ -56,12 +62,22 @@ typedef struct {
     access_control_instance_t *last_accessed_instance;
     bool needs_validation;
     bool sync_in_progress;
+#ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
+    anjay_journal_state_t journal;
+#endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
 } access_control_t;
 
 static inline void _anjay_access_control_mark_modified(access_control_t *repr) {
     repr->current.modified_since_persist = true;
 }
 
+static inline void
+_anjay_access_control_mark_instance_modified(access_control_t *repr,
+                                             access_control_instance_t *inst) {
+    inst->modified_since_persist = true;
+    _anjay_access_control_mark_modified(repr);
+}
+
 static inline void
 _anjay_access_control_clear_modified(access_control_t *repr) {
     repr->current.modified_since_persist = false;
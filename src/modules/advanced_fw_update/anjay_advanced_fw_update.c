@@ -30,6 +30,7 @@
 #    endif // ANJAY_WITH_SEND
 
 #    include <anjay/advanced_fw_update.h>
+#    include <anjay_modules/anjay_deferred_writer.h>
 #    include <anjay_modules/anjay_io_utils.h>
 #    include <anjay_modules/anjay_sched.h>
 #    include <anjay_modules/anjay_utils_core.h>
@@ -92,10 +93,13 @@ typedef struct {
     size_t conflicting_instances_count;
 } advanced_fw_instance_t;
 
+#    ifdef ANJAY_WITH_DOWNLOADER
 typedef struct {
     anjay_iid_t iid;
     anjay_download_handle_t download_handle;
-} current_download_t;
+    anjay_deferred_writer_t *deferred_writer;
+} active_download_t;
+#    endif // ANJAY_WITH_DOWNLOADER
 
 typedef struct {
     anjay_dm_installed_object_t def_ptr;
@@ -103,6 +107,8 @@ typedef struct {
 
 #    ifdef ANJAY_WITH_DOWNLOADER
     bool prefer_same_socket_downloads;
+    size_t deferred_write_queue_size;
+    size_t max_concurrent_downloads;
 #    endif // ANJAY_WITH_DOWNLOADER
 #    ifdef ANJAY_WITH_SEND
     bool use_lwm2m_send;
@@ -112,7 +118,7 @@ typedef struct {
     size_t supplemental_iid_cache_count;
 
 #    ifdef ANJAY_WITH_DOWNLOADER
-    current_download_t current_download;
+    AVS_LIST(active_download_t) active_downloads;
     bool downloads_suspended;
     AVS_LIST(anjay_download_config_t) download_queue;
 #    endif // ANJAY_WITH_DOWNLOADER
@@ -748,6 +754,74 @@ static void set_update_deadline(advanced_fw_instance_t *inst) {
 
 #    ifdef ANJAY_WITH_DOWNLOADER
 
+static int deferred_stream_write(anjay_unlocked_t *anjay,
+                                 const void *data,
+                                 size_t length,
+                                 void *inst_) {
+    return user_state_stream_write(anjay, (advanced_fw_instance_t *) inst_,
+                                   data, length);
+}
+
+static AVS_LIST(active_download_t) *
+find_active_download_ptr(advanced_fw_repr_t *fw, anjay_iid_t iid) {
+    AVS_LIST(active_download_t) *download_ptr;
+    AVS_LIST_FOREACH_PTR(download_ptr, &fw->active_downloads) {
+        if ((*download_ptr)->iid == iid) {
+            return download_ptr;
+        }
+    }
+    return NULL;
+}
+
+static active_download_t *find_active_download(advanced_fw_repr_t *fw,
+                                               anjay_iid_t iid) {
+    AVS_LIST(active_download_t) *download_ptr =
+            find_active_download_ptr(fw, iid);
+    return download_ptr ? *download_ptr : NULL;
+}
+
+static void
+deferred_stream_write_failed(anjay_unlocked_t *anjay, int result, void *inst_) {
+    const anjay_dm_installed_object_t *obj =
+            _anjay_dm_find_object_by_oid(_anjay_get_dm(anjay),
+                                         ANJAY_ADVANCED_FW_UPDATE_OID);
+    if (!obj) {
+        fw_log(WARNING, _("Advanced Firmware Update object not installed"));
+        return;
+    }
+    advanced_fw_repr_t *fw = get_fw(*obj);
+    advanced_fw_instance_t *inst = (advanced_fw_instance_t *) inst_;
+    fw_log(ERROR, _("could not write firmware"));
+    handle_err_result(anjay, fw, inst, ANJAY_ADVANCED_FW_UPDATE_STATE_IDLE,
+                      result,
+                      ANJAY_ADVANCED_FW_UPDATE_RESULT_NOT_ENOUGH_SPACE);
+    active_download_t *download = find_active_download(fw, inst->iid);
+    if (download) {
+        // download_finished() will be called, resetting the user state and
+        // deleting the deferred writer
+        _anjay_download_abort_unlocked(anjay, download->download_handle);
+    }
+}
+
+static int write_block(anjay_unlocked_t *anjay,
+                       advanced_fw_repr_t *fw,
+                       advanced_fw_instance_t *inst,
+                       const uint8_t *data,
+                       size_t data_size) {
+    active_download_t *download = find_active_download(fw, inst->iid);
+    assert(download);
+    if (fw->deferred_write_queue_size && !download->deferred_writer) {
+        download->deferred_writer = _anjay_deferred_writer_new(
+                anjay, fw->deferred_write_queue_size, deferred_stream_write,
+                deferred_stream_write_failed, inst);
+    }
+    if (download->deferred_writer) {
+        return _anjay_deferred_writer_write(download->deferred_writer, data,
+                                            data_size);
+    }
+    return user_state_stream_write(anjay, inst, data, data_size);
+}
+
 static avs_error_t download_write_block(anjay_t *anjay_locked,
                                         const uint8_t *data,
                                         size_t data_size,
@@ -766,7 +840,7 @@ static avs_error_t download_write_block(anjay_t *anjay_locked,
         advanced_fw_instance_t *inst = (advanced_fw_instance_t *) inst_;
         result = user_state_ensure_stream_open(anjay, inst);
         if (!result && data_size > 0) {
-            result = user_state_stream_write(anjay, inst, data, data_size);
+            result = write_block(anjay, fw, inst, data, data_size);
         }
         if (result) {
             fw_log(ERROR, _("could not write firmware"));
@@ -799,10 +873,22 @@ static int schedule_download_now(anjay_unlocked_t *anjay,
             return -1;
         }
     }
+    AVS_LIST(active_download_t) download =
+            AVS_LIST_NEW_ELEMENT(active_download_t);
+    if (!download) {
+        _anjay_log_oom();
+        reset_user_state(anjay, inst);
+        set_update_result(anjay, inst,
+                          ANJAY_ADVANCED_FW_UPDATE_RESULT_OUT_OF_MEMORY);
+#        ifdef ANJAY_WITH_SEND
+        send_state_and_update_result(anjay, fw, inst->iid, false);
+#        endif // ANJAY_WITH_SEND
+        return -1;
+    }
     avs_error_t err =
-            _anjay_download_unlocked(anjay, cfg,
-                                     &fw->current_download.download_handle);
+            _anjay_download_unlocked(anjay, cfg, &download->download_handle);
     if (avs_is_err(err)) {
+        AVS_LIST_DELETE(&download);
         anjay_advanced_fw_update_result_t update_result =
                 ANJAY_ADVANCED_FW_UPDATE_RESULT_CONNECTION_LOST;
         if (err.category == AVS_ERRNO_CATEGORY) {
@@ -827,10 +913,10 @@ static int schedule_download_now(anjay_unlocked_t *anjay,
 #        endif // ANJAY_WITH_SEND
         return -1;
     }
-    fw->current_download.iid = inst->iid;
+    download->iid = inst->iid;
+    AVS_LIST_APPEND(&fw->active_downloads, download);
     if (fw->downloads_suspended) {
-        _anjay_download_suspend_unlocked(anjay,
-                                         fw->current_download.download_handle);
+        _anjay_download_suspend_unlocked(anjay, download->download_handle);
     }
     inst->retry_download_on_expired = (false);
     update_state_and_update_result(anjay, fw, inst,
@@ -841,18 +927,72 @@ static int schedule_download_now(anjay_unlocked_t *anjay,
     return 0;
 }
 
+static bool can_start_download(advanced_fw_repr_t *fw) {
+    return AVS_LIST_SIZE(fw->active_downloads)
+           < AVS_MAX(fw->max_concurrent_downloads, 1);
+}
+
+static bool iid_list_contains(const anjay_iid_t *iids,
+                              size_t iids_count,
+                              anjay_iid_t iid) {
+    for (size_t i = 0; i < iids_count; ++i) {
+        if (iids[i] == iid) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_linked_to_active_download(advanced_fw_repr_t *fw,
+                                         advanced_fw_instance_t *inst) {
+    active_download_t *download;
+    AVS_LIST_FOREACH(download, fw->active_downloads) {
+        advanced_fw_instance_t *active_inst =
+                get_fw_instance(fw, download->iid);
+        if (iid_list_contains(inst->linked_instances,
+                              inst->linked_instances_count, download->iid)
+                || (active_inst
+                    && iid_list_contains(active_inst->linked_instances,
+                                         active_inst->linked_instances_count,
+                                         inst->iid))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Returns the queued download to start next. Instances linked with ones that
+ * are already being downloaded go first, so that a batch of linked components
+ * becomes ready for the upgrade as soon as possible; otherwise the queue is
+ * processed in order.
+ */
+static AVS_LIST(anjay_download_config_t) *
+next_queued_download_ptr(advanced_fw_repr_t *fw) {
+    AVS_LIST(anjay_download_config_t) *queued_cfg;
+    AVS_LIST_FOREACH_PTR(queued_cfg, &fw->download_queue) {
+        if (is_linked_to_active_download(
+                    fw, (advanced_fw_instance_t *) (*queued_cfg)->user_data)) {
+            return queued_cfg;
+        }
+    }
+    return &fw->download_queue;
+}
+
 static void start_next_download_if_waiting(anjay_unlocked_t *anjay,
                                            advanced_fw_repr_t *fw) {
-    if (fw->download_queue != NULL) {
+    while (fw->download_queue != NULL && can_start_download(fw)) {
+        AVS_LIST(anjay_download_config_t) *queued_cfg =
+                next_queued_download_ptr(fw);
         advanced_fw_instance_t *inst =
-                (advanced_fw_instance_t *) fw->download_queue->user_data;
-        if (schedule_download_now(anjay, fw, inst, fw->download_queue)) {
+                (advanced_fw_instance_t *) (*queued_cfg)->user_data;
+        if (schedule_download_now(anjay, fw, inst, *queued_cfg)) {
             fw_log(WARNING, _("Scheduling next waiting download failed"));
         }
         fw_log(TRACE, _("Scheduled download for instance %") PRIu16, inst->iid);
-        avs_free((void *) (intptr_t) fw->download_queue->url);
-        avs_free((void *) fw->download_queue->coap_tx_params);
-        AVS_LIST_DELETE(&fw->download_queue);
+        avs_free((void *) (intptr_t) (*queued_cfg)->url);
+        avs_free((void *) (*queued_cfg)->coap_tx_params);
+        AVS_LIST_DELETE(queued_cfg);
     }
 }
 
@@ -868,12 +1008,30 @@ static void download_finished(anjay_t *anjay_locked,
     } else {
         advanced_fw_repr_t *fw = get_fw(*obj);
         advanced_fw_instance_t *inst = (advanced_fw_instance_t *) inst_;
-        fw->current_download.download_handle = NULL;
-        fw->current_download.iid = ANJAY_ID_INVALID;
+        AVS_LIST(active_download_t) *download_ptr =
+                find_active_download_ptr(fw, inst->iid);
+        int write_result = 0;
+        if (download_ptr) {
+            if ((*download_ptr)->deferred_writer
+                    && inst->state == ANJAY_ADVANCED_FW_UPDATE_STATE_DOWNLOADING
+                    && status.result == ANJAY_DOWNLOAD_FINISHED) {
+                write_result = _anjay_deferred_writer_flush(
+                        (*download_ptr)->deferred_writer);
+            }
+            _anjay_deferred_writer_delete(&(*download_ptr)->deferred_writer);
+            AVS_LIST_DELETE(download_ptr);
+        }
         if (inst->state != ANJAY_ADVANCED_FW_UPDATE_STATE_DOWNLOADING) {
             // something already failed in download_write_block()
             reset_user_state(anjay, inst);
             start_next_download_if_waiting(anjay, fw);
+        } else if (write_result) {
+            fw_log(ERROR, _("could not write firmware"));
+            reset_user_state(anjay, inst);
+            handle_err_result(anjay, fw, inst,
+                              ANJAY_ADVANCED_FW_UPDATE_STATE_IDLE, write_result,
+                              ANJAY_ADVANCED_FW_UPDATE_RESULT_NOT_ENOUGH_SPACE);
+            start_next_download_if_waiting(anjay, fw);
         } else if (status.result != ANJAY_DOWNLOAD_FINISHED) {
             anjay_advanced_fw_update_result_t update_result =
                     ANJAY_ADVANCED_FW_UPDATE_RESULT_CONNECTION_LOST;
@@ -943,7 +1101,7 @@ static void download_finished(anjay_t *anjay_locked,
 }
 
 static bool is_any_download_in_progress(advanced_fw_repr_t *fw) {
-    return fw->current_download.download_handle || fw->download_queue;
+    return fw->active_downloads || fw->download_queue;
 }
 
 static int enqueue_download(anjay_unlocked_t *anjay,
@@ -1011,7 +1169,7 @@ static int schedule_download(anjay_unlocked_t *anjay,
         cfg.coap_tx_params = &tx_params;
     }
     cfg.tcp_request_timeout = get_tcp_request_timeout(anjay, inst);
-    if (is_any_download_in_progress(fw)) {
+    if (fw->download_queue || !can_start_download(fw)) {
         return enqueue_download(anjay, fw, inst, &cfg);
     }
     return schedule_download_now(anjay, fw, inst, &cfg);
@@ -1137,12 +1295,10 @@ cancel_existing_download_if_in_progress(anjay_unlocked_t *anjay,
                                         advanced_fw_repr_t *fw,
                                         advanced_fw_instance_t *inst) {
     if (inst->state == ANJAY_ADVANCED_FW_UPDATE_STATE_DOWNLOADING) {
-        if (fw->current_download.download_handle
-                && fw->current_download.iid == inst->iid) {
-            _anjay_download_abort_unlocked(
-                    anjay, fw->current_download.download_handle);
-            assert(!fw->current_download.download_handle);
-            fw->current_download.iid = ANJAY_ID_INVALID;
+        active_download_t *download = find_active_download(fw, inst->iid);
+        if (download) {
+            _anjay_download_abort_unlocked(anjay, download->download_handle);
+            assert(!find_active_download(fw, inst->iid));
             fw_log(TRACE,
                    _("Aborted ongoing download for instance ") "%" PRIu16,
                    inst->iid);
@@ -1780,6 +1936,9 @@ static void fw_delete(void *fw_) {
         avs_free((void *) (intptr_t) inst->package_uri);
     }
 #    ifdef ANJAY_WITH_DOWNLOADER
+    AVS_LIST_CLEAR(&fw->active_downloads) {
+        _anjay_deferred_writer_delete(&fw->active_downloads->deferred_writer);
+    }
     AVS_LIST_CLEAR(&fw->download_queue) {
         download_queue_entry_cleanup(fw->download_queue);
     }
@@ -1799,11 +1958,12 @@ int anjay_advanced_fw_update_install(
         _anjay_log_oom();
     } else {
         repr->def = &FIRMWARE_UPDATE;
-        repr->current_download.iid = ANJAY_ID_INVALID;
         if (config) {
 #    ifdef ANJAY_WITH_DOWNLOADER
             repr->prefer_same_socket_downloads =
                     config->prefer_same_socket_downloads;
+            repr->deferred_write_queue_size = config->deferred_write_queue_size;
+            repr->max_concurrent_downloads = config->max_concurrent_downloads;
 #    endif // ANJAY_WITH_DOWNLOADER
 #    ifdef ANJAY_WITH_SEND
             repr->use_lwm2m_send = config->use_lwm2m_send;
@@ -2336,9 +2496,9 @@ void anjay_advanced_fw_update_pull_suspend(anjay_t *anjay_locked) {
     } else {
         advanced_fw_repr_t *fw = get_fw(*obj);
         assert(fw);
-        if (fw->current_download.download_handle) {
-            _anjay_download_suspend_unlocked(
-                    anjay, fw->current_download.download_handle);
+        active_download_t *download;
+        AVS_LIST_FOREACH(download, fw->active_downloads) {
+            _anjay_download_suspend_unlocked(anjay, download->download_handle);
         }
         fw->downloads_suspended = true;
     }
@@ -2358,11 +2518,14 @@ int anjay_advanced_fw_update_pull_reconnect(anjay_t *anjay_locked) {
         advanced_fw_repr_t *fw = get_fw(*obj);
         assert(fw);
         fw->downloads_suspended = false;
-        if (fw->current_download.download_handle) {
-            result = _anjay_download_reconnect_unlocked(
-                    anjay, fw->current_download.download_handle);
-        } else {
-            result = 0;
+        result = 0;
+        active_download_t *download;
+        AVS_LIST_FOREACH(download, fw->active_downloads) {
+            int partial_result = _anjay_download_reconnect_unlocked(
+                    anjay, download->download_handle);
+            if (!result) {
+                result = partial_result;
+            }
         }
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
@@ -29,6 +29,7 @@
 #        include <anjay/lwm2m_send.h>
 #    endif // ANJAY_WITH_SEND
 
+#    include <anjay_modules/anjay_deferred_writer.h>
 #    include <anjay_modules/anjay_dm_utils.h>
 #    include <anjay_modules/anjay_io_utils.h>
 #    include <anjay_modules/anjay_sched.h>
@@ -41,6 +42,8 @@
 #    include <avsystem/commons/avs_url.h>
 #    include <avsystem/commons/avs_utils.h>
 
+#    include "anjay_fw_update_delta.h"
+
 VISIBILITY_SOURCE_BEGIN
 
 #    define fw_log(level, ...) _anjay_log(fw_update, level, __VA_ARGS__)
@@ -68,6 +71,9 @@ typedef struct {
     const anjay_fw_update_handlers_t *handlers;
     void *arg;
     fw_update_state_t state;
+#    ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+    anjay_fw_update_delta_t delta;
+#    endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
 } fw_user_state_t;
 
 typedef struct fw_repr {
@@ -84,9 +90,24 @@ typedef struct fw_repr {
     bool retry_download_on_expired;
     anjay_download_handle_t download_handle;
     bool prefer_same_socket_downloads;
+    size_t deferred_write_queue_size;
+    anjay_deferred_writer_t *deferred_writer;
     bool downloads_suspended;
     avs_sched_handle_t resume_download_job;
     avs_time_monotonic_t resume_download_deadline;
+#        ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+    /**
+     * Offset at which an interrupted download would be resumed. Set while the
+     * download is restarted from the beginning instead, to check whether the
+     * package is a delta package, which cannot be resumed.
+     */
+    size_t resume_probe_offset;
+    /**
+     * Set once the package turned out not to be a delta package. The download
+     * is then aborted and resumed at resume_probe_offset with this ETag.
+     */
+    anjay_etag_t *resume_probe_etag;
+#        endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
 #    endif // ANJAY_WITH_DOWNLOADER
 #    ifdef ANJAY_WITH_SEND
     bool use_lwm2m_send;
@@ -223,9 +244,41 @@ update_state_and_update_result(anjay_unlocked_t *anjay,
 static void set_user_state(fw_user_state_t *user, fw_update_state_t new_state) {
     fw_log(DEBUG, _("user->state change: ") "%d" _(" -> ") "%d",
            (int) user->state, (int) new_state);
+#    ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+    if (user->state == UPDATE_STATE_DOWNLOADING
+            || new_state == UPDATE_STATE_DOWNLOADING) {
+        _anjay_fw_update_delta_reset(&user->delta);
+    }
+#    endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
     user->state = new_state;
 }
 
+// NOTE: the two functions below shall be called with the mutex unlocked
+static int
+call_stream_write(fw_user_state_t *user, const void *data, size_t length) {
+#    ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+    if (user->handlers->read_current) {
+        return _anjay_fw_update_delta_write(&user->delta, user->handlers,
+                                            user->arg, data, length);
+    }
+#    endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+    return user->handlers->stream_write(user->arg, data, length);
+}
+
+static int call_stream_finish(fw_user_state_t *user) {
+#    ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+    int result;
+    if (user->handlers->read_current
+            && (result = _anjay_fw_update_delta_finish(
+                        &user->delta, user->handlers, user->arg))) {
+        // stream_finish will not be called, so clean up the stream here
+        user->handlers->reset(user->arg);
+        return result;
+    }
+#    endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+    return user->handlers->stream_finish(user->arg);
+}
+
 static int
 user_state_ensure_stream_open(anjay_unlocked_t *anjay,
                               fw_user_state_t *user,
@@ -252,7 +305,7 @@ static int user_state_stream_write(anjay_unlocked_t *anjay,
     assert(user->state == UPDATE_STATE_DOWNLOADING);
     int result = -1;
     ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
-    result = user->handlers->stream_write(user->arg, data, length);
+    result = call_stream_write(user, data, length);
     ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
     return result;
 }
@@ -310,7 +363,7 @@ static int finish_user_stream(anjay_unlocked_t *anjay, fw_repr_t *fw) {
     assert(fw->user_state.state == UPDATE_STATE_DOWNLOADING);
     int result = -1;
     ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
-    result = fw->user_state.handlers->stream_finish(fw->user_state.arg);
+    result = call_stream_finish(&fw->user_state);
     ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
     if (result) {
         set_user_state(&fw->user_state, UPDATE_STATE_IDLE);
@@ -571,6 +624,72 @@ static anjay_transport_security_t transport_security_from_uri(const char *uri) {
 #    endif // ANJAY_WITH_COAP_DOWNLOAD || ANJAY_WITH_HTTP_DOWNLOAD
 
 #    ifdef ANJAY_WITH_DOWNLOADER
+static int deferred_stream_write(anjay_unlocked_t *anjay,
+                                 const void *data,
+                                 size_t length,
+                                 void *fw_) {
+    fw_repr_t *fw = (fw_repr_t *) fw_;
+    return user_state_stream_write(anjay, &fw->user_state, data, length);
+}
+
+static void
+deferred_stream_write_failed(anjay_unlocked_t *anjay, int result, void *fw_) {
+    fw_repr_t *fw = (fw_repr_t *) fw_;
+    fw_log(ERROR, _("could not write firmware"));
+    handle_err_result(anjay, fw, UPDATE_STATE_IDLE, result,
+                      ANJAY_FW_UPDATE_RESULT_NOT_ENOUGH_SPACE);
+    if (fw->download_handle) {
+        // download_finished() will be called, resetting the user state and
+        // deleting the deferred writer
+        _anjay_download_abort_unlocked(anjay, fw->download_handle);
+    }
+}
+
+static int write_block(anjay_unlocked_t *anjay,
+                       fw_repr_t *fw,
+                       const uint8_t *data,
+                       size_t data_size) {
+    if (fw->deferred_write_queue_size && !fw->deferred_writer) {
+        fw->deferred_writer = _anjay_deferred_writer_new(
+                anjay, fw->deferred_write_queue_size, deferred_stream_write,
+                deferred_stream_write_failed, fw);
+    }
+    if (fw->deferred_writer) {
+        return _anjay_deferred_writer_write(fw->deferred_writer, data,
+                                            data_size);
+    }
+    return user_state_stream_write(anjay, &fw->user_state, data, data_size);
+}
+
+#        ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+/**
+ * Inspects the first block of a download restarted in place of resuming it.
+ * Returns true if the package is not a delta package, and the download is to
+ * be aborted and resumed by download_finished() instead. Otherwise, the data
+ * written so far is discarded and the download continues from the beginning.
+ */
+static bool probe_resumed_download(anjay_unlocked_t *anjay,
+                                   fw_repr_t *fw,
+                                   const uint8_t *data,
+                                   size_t data_size,
+                                   const anjay_etag_t *etag) {
+    if (!fw->resume_probe_offset || fw->resume_probe_etag || !data_size) {
+        return false;
+    }
+    if (!_anjay_fw_update_delta_magic_matches(data, data_size) && etag
+            && (fw->resume_probe_etag = anjay_etag_clone(etag))) {
+        fw_log(INFO,
+               _("not a delta package, resuming download at offset ") "%lu",
+               (unsigned long) fw->resume_probe_offset);
+        return true;
+    }
+    fw_log(INFO, _("cannot resume download, starting from the beginning"));
+    fw->resume_probe_offset = 0;
+    reset_user_state(anjay, fw);
+    return false;
+}
+#        endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+
 static avs_error_t download_write_block(anjay_t *anjay_locked,
                                         const uint8_t *data,
                                         size_t data_size,
@@ -580,11 +699,16 @@ static avs_error_t download_write_block(anjay_t *anjay_locked,
     int result = -1;
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     fw_repr_t *fw = (fw_repr_t *) fw_;
+#        ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+    if (probe_resumed_download(anjay, fw, data, data_size, etag)) {
+        ANJAY_MUTEX_UNLOCK(anjay_locked);
+        return avs_errno(AVS_ECANCELED);
+    }
+#        endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
     result = user_state_ensure_stream_open(anjay, &fw->user_state,
                                            fw->package_uri, etag);
     if (!result && data_size > 0) {
-        result = user_state_stream_write(anjay, &fw->user_state, data,
-                                         data_size);
+        result = write_block(anjay, fw, data, data_size);
     }
     if (result) {
         fw_log(ERROR, _("could not write firmware"));
@@ -606,6 +730,37 @@ static void download_finished(anjay_t *anjay_locked,
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     fw_repr_t *fw = (fw_repr_t *) fw_;
     fw->download_handle = NULL;
+    int write_result = 0;
+    if (fw->deferred_writer) {
+        if (fw->state == UPDATE_STATE_DOWNLOADING
+                && status.result == ANJAY_DOWNLOAD_FINISHED) {
+            write_result = _anjay_deferred_writer_flush(fw->deferred_writer);
+        }
+        _anjay_deferred_writer_delete(&fw->deferred_writer);
+    }
+#        ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+    size_t resume_offset = fw->resume_probe_offset;
+    anjay_etag_t *resume_etag = fw->resume_probe_etag;
+    fw->resume_probe_offset = 0;
+    fw->resume_probe_etag = NULL;
+    if (resume_etag && fw->state == UPDATE_STATE_DOWNLOADING) {
+        // aborted by probe_resumed_download(); the data written before the
+        // interruption is neither a delta package nor its header
+        _anjay_fw_update_delta_set_passthrough(&fw->user_state.delta);
+        if (schedule_background_anjay_download(anjay, fw, resume_offset,
+                                               resume_etag)) {
+            fw_log(WARNING, _("Could not resume firmware download"));
+            set_state(anjay, fw, UPDATE_STATE_IDLE);
+#            ifdef ANJAY_WITH_SEND
+            send_state_and_update_result(anjay, fw);
+#            endif // ANJAY_WITH_SEND
+        }
+        avs_free(resume_etag);
+        ANJAY_MUTEX_UNLOCK(anjay_locked);
+        return;
+    }
+    avs_free(resume_etag);
+#        endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
     if (fw->state != UPDATE_STATE_DOWNLOADING) {
         // something already failed in download_write_block()
         reset_user_state(anjay, fw);
@@ -650,6 +805,11 @@ static void download_finished(anjay_t *anjay_locked,
             update_state_and_update_result(anjay, fw, UPDATE_STATE_IDLE,
                                            update_result);
         }
+    } else if (write_result) {
+        fw_log(ERROR, _("could not write firmware"));
+        reset_user_state(anjay, fw);
+        handle_err_result(anjay, fw, UPDATE_STATE_IDLE, write_result,
+                          ANJAY_FW_UPDATE_RESULT_NOT_ENOUGH_SPACE);
     } else {
         int result;
         if ((result = user_state_ensure_stream_open(anjay, &fw->user_state,
@@ -1174,7 +1334,14 @@ static void fw_delete(void *fw_) {
     avs_sched_del(&fw->update_job);
 #    ifdef ANJAY_WITH_DOWNLOADER
     avs_sched_del(&fw->resume_download_job);
+    _anjay_deferred_writer_delete(&fw->deferred_writer);
+#        ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+    avs_free(fw->resume_probe_etag);
+#        endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
 #    endif // ANJAY_WITH_DOWNLOADER
+#    ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+    _anjay_fw_update_delta_reset(&fw->user_state.delta);
+#    endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
     avs_free((void *) (intptr_t) fw->package_uri);
     // NOTE: fw itself will be freed when cleaning the objects list
 }
@@ -1189,6 +1356,7 @@ initialize_fw_repr(anjay_unlocked_t *anjay,
 #    ifdef ANJAY_WITH_DOWNLOADER
     repr->prefer_same_socket_downloads =
             initial_state->prefer_same_socket_downloads;
+    repr->deferred_write_queue_size = initial_state->deferred_write_queue_size;
 #    endif // ANJAY_WITH_DOWNLOADER
 #    ifdef ANJAY_WITH_SEND
     repr->use_lwm2m_send = initial_state->use_lwm2m_send;
@@ -1214,6 +1382,16 @@ initialize_fw_repr(anjay_unlocked_t *anjay,
             reset_user_state(anjay, repr);
             resume_offset = 0;
         }
+#        ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+        if (resume_offset > 0 && repr->user_state.handlers->read_current) {
+            // Delta packages cannot be resumed, as the decoder state is not
+            // persisted. Download the first block again to find out whether
+            // this is one.
+            fw_log(INFO, _("checking whether the download can be resumed"));
+            repr->resume_probe_offset = resume_offset;
+            resume_offset = 0;
+        }
+#        endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
         if (!initial_state->persisted_uri
                 || !(repr->package_uri =
                              avs_strdup(initial_state->persisted_uri))) {
@@ -0,0 +1,333 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#if defined(ANJAY_WITH_MODULE_FW_UPDATE) \
+        && defined(ANJAY_WITH_MODULE_FW_UPDATE_DELTA)
+
+#    include <assert.h>
+#    include <inttypes.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_utils.h>
+
+#    include <anjay_modules/anjay_utils_core.h>
+
+#    include "anjay_fw_update_delta.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#    define delta_log(level, ...) _anjay_log(fw_update, level, __VA_ARGS__)
+
+void _anjay_fw_update_delta_reset(anjay_fw_update_delta_t *delta) {
+    avs_free(delta->buffer);
+    memset(delta, 0, sizeof(*delta));
+}
+
+bool _anjay_fw_update_delta_magic_matches(const void *data, size_t length) {
+    return !memcmp(data, ANJAY_FW_UPDATE_DELTA_MAGIC,
+                   AVS_MIN(length, ANJAY_FW_UPDATE_DELTA_MAGIC_SIZE));
+}
+
+void _anjay_fw_update_delta_set_passthrough(anjay_fw_update_delta_t *delta) {
+    _anjay_fw_update_delta_reset(delta);
+    delta->state = FW_DELTA_STATE_PASSTHROUGH;
+}
+
+static uint32_t extract_u32(const uint8_t *data) {
+    return ((uint32_t) data[0] << 24) | ((uint32_t) data[1] << 16)
+           | ((uint32_t) data[2] << 8) | (uint32_t) data[3];
+}
+
+static int fail(anjay_fw_update_delta_t *delta, const char *msg) {
+    delta_log(ERROR, _("malformed delta package: ") "%s", msg);
+    delta->state = FW_DELTA_STATE_ERROR;
+    return ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE;
+}
+
+static int emit(anjay_fw_update_delta_t *delta,
+                const anjay_fw_update_handlers_t *handlers,
+                void *user_ptr,
+                const void *data,
+                size_t length) {
+    delta->target_offset += (uint32_t) length;
+    delta->crc = _anjay_crc32(delta->crc, data, length);
+    return handlers->stream_write(user_ptr, data, length);
+}
+
+static int copy_source(anjay_fw_update_delta_t *delta,
+                       const anjay_fw_update_handlers_t *handlers,
+                       void *user_ptr,
+                       uint32_t source_offset,
+                       uint32_t length) {
+    while (length) {
+        size_t chunk = AVS_MIN(length, ANJAY_FW_UPDATE_DELTA_BUFFER_SIZE);
+        int result = handlers->read_current(user_ptr, source_offset,
+                                            delta->buffer, chunk);
+        if (result) {
+            delta_log(ERROR,
+                      _("could not read current image at offset ") "%" PRIu32,
+                      source_offset);
+            return result;
+        }
+        if ((result = emit(delta, handlers, user_ptr, delta->buffer, chunk))) {
+            return result;
+        }
+        source_offset += (uint32_t) chunk;
+        length -= (uint32_t) chunk;
+    }
+    return 0;
+}
+
+/**
+ * Checks that the package has been generated against the currently installed
+ * image, before anything is written. Exactly source_size bytes are read, so
+ * this also fails if the installed image is shorter than declared.
+ */
+static int verify_source(anjay_fw_update_delta_t *delta,
+                         const anjay_fw_update_handlers_t *handlers,
+                         void *user_ptr,
+                         uint32_t source_crc) {
+    uint32_t crc = 0;
+    uint32_t offset = 0;
+    while (offset < delta->source_size) {
+        size_t chunk = AVS_MIN(delta->source_size - offset,
+                               ANJAY_FW_UPDATE_DELTA_BUFFER_SIZE);
+        int result =
+                handlers->read_current(user_ptr, offset, delta->buffer, chunk);
+        if (result) {
+            delta_log(ERROR,
+                      _("could not read current image at offset ") "%" PRIu32,
+                      offset);
+            return result;
+        }
+        crc = _anjay_crc32(crc, delta->buffer, chunk);
+        offset += (uint32_t) chunk;
+    }
+    if (crc != source_crc) {
+        delta_log(ERROR,
+                  _("delta package does not apply to the current image"));
+        delta->state = FW_DELTA_STATE_ERROR;
+        return ANJAY_FW_UPDATE_ERR_UNSUPPORTED_PACKAGE_TYPE;
+    }
+    return 0;
+}
+
+static int parse_header(anjay_fw_update_delta_t *delta,
+                        const anjay_fw_update_handlers_t *handlers,
+                        void *user_ptr) {
+    const uint8_t *fields = &delta->header[ANJAY_FW_UPDATE_DELTA_MAGIC_SIZE];
+    delta->source_size = extract_u32(&fields[0]);
+    const uint32_t source_crc = extract_u32(&fields[4]);
+    delta->target_size = extract_u32(&fields[8]);
+    delta->target_crc = extract_u32(&fields[12]);
+    if (!(delta->buffer =
+                  (uint8_t *) avs_malloc(ANJAY_FW_UPDATE_DELTA_BUFFER_SIZE))) {
+        _anjay_log_oom();
+        return ANJAY_FW_UPDATE_ERR_OUT_OF_MEMORY;
+    }
+    delta_log(INFO,
+              _("applying delta package: ") "%" PRIu32 _(" -> ") "%" PRIu32 _(
+                      " bytes"),
+              delta->source_size, delta->target_size);
+    int result = verify_source(delta, handlers, user_ptr, source_crc);
+    if (result) {
+        return result;
+    }
+    delta->state = FW_DELTA_STATE_COMMAND;
+    delta->header_size = 0;
+    return 0;
+}
+
+static size_t command_size(uint8_t opcode) {
+    switch (opcode) {
+    case ANJAY_FW_UPDATE_DELTA_OP_COPY:
+        return 9;
+    case ANJAY_FW_UPDATE_DELTA_OP_INSERT:
+        return 5;
+    default:
+        return 0;
+    }
+}
+
+static int execute_command(anjay_fw_update_delta_t *delta,
+                           const anjay_fw_update_handlers_t *handlers,
+                           void *user_ptr) {
+    delta->header_size = 0;
+    if (delta->header[0] == ANJAY_FW_UPDATE_DELTA_OP_INSERT) {
+        uint32_t length = extract_u32(&delta->header[1]);
+        if (length > delta->target_size - delta->target_offset) {
+            return fail(delta, "target size exceeded");
+        }
+        if ((delta->remaining = length)) {
+            delta->state = FW_DELTA_STATE_INSERT;
+        }
+        return 0;
+    }
+
+    assert(delta->header[0] == ANJAY_FW_UPDATE_DELTA_OP_COPY);
+    uint32_t source_offset = extract_u32(&delta->header[1]);
+    uint32_t length = extract_u32(&delta->header[5]);
+    if (source_offset > delta->source_size
+            || length > delta->source_size - source_offset) {
+        return fail(delta, "source range out of bounds");
+    }
+    if (length > delta->target_size - delta->target_offset) {
+        return fail(delta, "target size exceeded");
+    }
+    return copy_source(delta, handlers, user_ptr, source_offset, length);
+}
+
+/**
+ * Appends up to @p length bytes of @p data to the header buffer, so that it
+ * contains @p expected_size bytes.
+ *
+ * @returns Number of bytes consumed.
+ */
+static size_t accumulate_header(anjay_fw_update_delta_t *delta,
+                                const uint8_t *data,
+                                size_t length,
+                                size_t expected_size) {
+    assert(delta->header_size < expected_size);
+    assert(expected_size <= sizeof(delta->header));
+    size_t chunk = AVS_MIN(length, expected_size - delta->header_size);
+    memcpy(&delta->header[delta->header_size], data, chunk);
+    delta->header_size += chunk;
+    return chunk;
+}
+
+static int detect(anjay_fw_update_delta_t *delta,
+                  const anjay_fw_update_handlers_t *handlers,
+                  void *user_ptr,
+                  const uint8_t **data_ptr,
+                  size_t *length_ptr) {
+    const size_t offset = delta->header_size;
+    const size_t chunk =
+            accumulate_header(delta, *data_ptr, *length_ptr,
+                              ANJAY_FW_UPDATE_DELTA_MAGIC_SIZE);
+    if (memcmp(&delta->header[offset], &ANJAY_FW_UPDATE_DELTA_MAGIC[offset],
+               chunk)) {
+        // not a delta package - pass everything through, including any
+        // previously withheld bytes
+        delta->state = FW_DELTA_STATE_PASSTHROUGH;
+        delta->header_size = 0;
+        if (offset) {
+            return handlers->stream_write(user_ptr, delta->header, offset);
+        }
+        return 0;
+    }
+    *data_ptr += chunk;
+    *length_ptr -= chunk;
+    if (delta->header_size == ANJAY_FW_UPDATE_DELTA_MAGIC_SIZE) {
+        delta->state = FW_DELTA_STATE_HEADER;
+    }
+    return 0;
+}
+
+int _anjay_fw_update_delta_write(anjay_fw_update_delta_t *delta,
+                                 const anjay_fw_update_handlers_t *handlers,
+                                 void *user_ptr,
+                                 const void *data_,
+                                 size_t length) {
+    const uint8_t *data = (const uint8_t *) data_;
+    int result = 0;
+    while (!result && length) {
+        switch (delta->state) {
+        case FW_DELTA_STATE_DETECT:
+            result = detect(delta, handlers, user_ptr, &data, &length);
+            break;
+
+        case FW_DELTA_STATE_PASSTHROUGH:
+            return handlers->stream_write(user_ptr, data, length);
+
+        case FW_DELTA_STATE_HEADER: {
+            size_t chunk = accumulate_header(delta, data, length,
+                                             ANJAY_FW_UPDATE_DELTA_HEADER_SIZE);
+            data += chunk;
+            length -= chunk;
+            if (delta->header_size == ANJAY_FW_UPDATE_DELTA_HEADER_SIZE) {
+                result = parse_header(delta, handlers, user_ptr);
+            }
+            break;
+        }
+
+        case FW_DELTA_STATE_COMMAND: {
+            if (delta->target_offset == delta->target_size) {
+                return fail(delta, "trailing data after the last command");
+            }
+            const size_t expected_size = command_size(
+                    delta->header_size ? delta->header[0] : data[0]);
+            if (!expected_size) {
+                return fail(delta, "unknown command");
+            }
+            size_t chunk =
+                    accumulate_header(delta, data, length, expected_size);
+            data += chunk;
+            length -= chunk;
+            if (delta->header_size == expected_size) {
+                result = execute_command(delta, handlers, user_ptr);
+            }
+            break;
+        }
+
+        case FW_DELTA_STATE_INSERT: {
+            size_t chunk = AVS_MIN(length, delta->remaining);
+            result = emit(delta, handlers, user_ptr, data, chunk);
+            data += chunk;
+            length -= chunk;
+            if (!(delta->remaining -= (uint32_t) chunk)) {
+                delta->state = FW_DELTA_STATE_COMMAND;
+            }
+            break;
+        }
+
+        case FW_DELTA_STATE_ERROR:
+            return ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE;
+        }
+    }
+    return result;
+}
+
+int _anjay_fw_update_delta_finish(anjay_fw_update_delta_t *delta,
+                                  const anjay_fw_update_handlers_t *handlers,
+                                  void *user_ptr) {
+    switch (delta->state) {
+    case FW_DELTA_STATE_DETECT:
+        // package shorter than the magic, but matching its beginning
+        if (delta->header_size) {
+            return handlers->stream_write(user_ptr, delta->header,
+                                          delta->header_size);
+        }
+        return 0;
+    case FW_DELTA_STATE_PASSTHROUGH:
+        return 0;
+    case FW_DELTA_STATE_COMMAND:
+        if (delta->header_size
+                || delta->target_offset != delta->target_size) {
+            return fail(delta, "truncated");
+        }
+        if (delta->crc != delta->target_crc) {
+            return fail(delta, "target image checksum mismatch");
+        }
+        return 0;
+    case FW_DELTA_STATE_ERROR:
+        return ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE;
+    default:
+        return fail(delta, "truncated");
+    }
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/modules/fw_update/delta.c"
+#    endif // ANJAY_TEST
+
+#endif // defined(ANJAY_WITH_MODULE_FW_UPDATE) &&
+       // defined(ANJAY_WITH_MODULE_FW_UPDATE_DELTA)
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_FW_UPDATE_DELTA_H
+#define ANJAY_FW_UPDATE_DELTA_H
+#include <anjay_init.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <anjay/fw_update.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#ifdef ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+
+/**
+ * Delta package format, as generated by tools/fw_delta.py:
+ *
+ * - header: <c>"ANJDELTA"</c> magic, followed by the size and CRC-32 of the
+ *   source (currently installed) image, and the size and CRC-32 of the target
+ *   image, all as 32-bit big endian integers,
+ * - a sequence of commands, each starting with a single opcode byte; all
+ *   integer arguments are 32-bit big endian:
+ *   - <c>COPY source_offset length</c> - copy <c>length</c> bytes of the source
+ *     image starting at <c>source_offset</c>,
+ *   - <c>INSERT length</c>, followed by <c>length</c> literal bytes.
+ *
+ * The package is complete once exactly <c>target_size</c> bytes have been
+ * produced. The source image checksum is verified before anything is written,
+ * and the target image checksum once the whole package has been applied.
+ */
+#    define ANJAY_FW_UPDATE_DELTA_MAGIC "ANJDELTA"
+#    define ANJAY_FW_UPDATE_DELTA_MAGIC_SIZE \
+        (sizeof(ANJAY_FW_UPDATE_DELTA_MAGIC) - 1)
+#    define ANJAY_FW_UPDATE_DELTA_HEADER_SIZE \
+        (ANJAY_FW_UPDATE_DELTA_MAGIC_SIZE + 4 * sizeof(uint32_t))
+
+#    define ANJAY_FW_UPDATE_DELTA_OP_COPY 0x01
+#    define ANJAY_FW_UPDATE_DELTA_OP_INSERT 0x02
+
+/**
+ * Size of the buffer used to read the source image. It is only allocated while
+ * a delta package is being applied, and is the only memory used in addition to
+ * @ref anjay_fw_update_delta_t itself.
+ */
+#    define ANJAY_FW_UPDATE_DELTA_BUFFER_SIZE 512
+
+typedef enum {
+    // NOTE: zero-initialized structure is in the DETECT state
+    FW_DELTA_STATE_DETECT = 0,
+    FW_DELTA_STATE_PASSTHROUGH,
+    FW_DELTA_STATE_HEADER,
+    FW_DELTA_STATE_COMMAND,
+    FW_DELTA_STATE_INSERT,
+    FW_DELTA_STATE_ERROR
+} anjay_fw_update_delta_state_t;
+
+typedef struct {
+    anjay_fw_update_delta_state_t state;
+    // accumulates the package header or the current command
+    uint8_t header[ANJAY_FW_UPDATE_DELTA_HEADER_SIZE];
+    size_t header_size;
+
+    uint32_t source_size;
+    uint32_t target_size;
+    uint32_t target_crc;
+    uint32_t target_offset;
+    // CRC-32 of the first target_offset bytes of the target image
+    uint32_t crc;
+
+    // bytes left in the INSERT command being processed
+    uint32_t remaining;
+
+    uint8_t *buffer;
+} anjay_fw_update_delta_t;
+
+/**
+ * Resets the decoder into the initial state, in which the package type is not
+ * yet known, and frees all resources.
+ */
+void _anjay_fw_update_delta_reset(anjay_fw_update_delta_t *delta);
+
+/**
+ * Checks whether a package starting with @p length bytes of @p data may be a
+ * delta package, i.e. whether they match the beginning of the delta magic.
+ */
+bool _anjay_fw_update_delta_magic_matches(const void *data, size_t length);
+
+/**
+ * Makes the decoder pass all data to <c>stream_write</c> unchanged. To be used
+ * when resuming the download of a package that is known not to be a delta
+ * package, as the magic can only be detected at the beginning of a package.
+ */
+void _anjay_fw_update_delta_set_passthrough(anjay_fw_update_delta_t *delta);
+
+/**
+ * Consumes a chunk of the downloaded package. If the package starts with the
+ * delta magic, the patch is applied against the image returned by the
+ * <c>read_current</c> handler, and the reconstructed image is passed to the
+ * <c>stream_write</c> handler. Otherwise, the data is passed to
+ * <c>stream_write</c> unchanged.
+ *
+ * Shall be called with the Anjay mutex unlocked, as it calls user handlers.
+ *
+ * @returns 0 on success, error code returned by one of the handlers,
+ *          @ref ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE if the delta package is
+ *          malformed, or @ref ANJAY_FW_UPDATE_ERR_UNSUPPORTED_PACKAGE_TYPE if
+ *          it has been generated against a different source image.
+ */
+int _anjay_fw_update_delta_write(anjay_fw_update_delta_t *delta,
+                                 const anjay_fw_update_handlers_t *handlers,
+                                 void *user_ptr,
+                                 const void *data,
+                                 size_t length);
+
+/**
+ * Shall be called after the whole package has been passed to
+ * @ref _anjay_fw_update_delta_write, before calling <c>stream_finish</c>.
+ *
+ * @returns 0 on success, error code returned by <c>stream_write</c>, or
+ *          @ref ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE if the delta package is
+ *          truncated or the checksum of the target image does not match.
+ */
+int _anjay_fw_update_delta_finish(anjay_fw_update_delta_t *delta,
+                                  const anjay_fw_update_handlers_t *handlers,
+                                  void *user_ptr);
+
+#endif // ANJAY_WITH_MODULE_FW_UPDATE_DELTA
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif // ANJAY_FW_UPDATE_DELTA_H
@@ -25,6 +25,8 @@
 #    include <avsystem/commons/avs_log.h>
 #    include <avsystem/commons/avs_memory.h>
 
+#    include "anjay_ipso_v2_history.h"
+
 VISIBILITY_SOURCE_BEGIN
 
 /**
@@ -84,6 +86,7 @@ typedef struct {
     double curr_value;
     double min_value;
     double max_value;
+    AVS_LIST(anjay_ipso_v2_history_t) history;
 } instance_t;
 
 typedef struct {
@@ -363,6 +366,13 @@ static int sensor_instance_add_unlocked(anjay_unlocked_t *anjay,
         return -1;
     }
 
+    if (meta->history_depth
+            && !(inst->history = _anjay_ipso_v2_history_create(
+                         anjay, meta->history_depth, meta->history_decimation,
+                         1))) {
+        return -1;
+    }
+
     inst->initialized = true;
     inst->meta = *meta;
     inst->curr_value = initial_value;
@@ -405,6 +415,7 @@ static int sensor_instance_remove_unlocked(anjay_unlocked_t *anjay,
         return -1;
     }
 
+    _anjay_ipso_v2_history_delete(anjay, &obj->instances[iid].history);
     obj->instances[iid].initialized = false;
     _anjay_notify_instances_changed_unlocked(anjay, oid);
 
@@ -424,29 +435,29 @@ int anjay_ipso_v2_basic_sensor_instance_remove(anjay_t *anjay_locked,
     return res;
 }
 
-static int sensor_value_update_unlocked(anjay_unlocked_t *anjay,
-                                        anjay_oid_t oid,
-                                        anjay_iid_t iid,
-                                        double value) {
-    object_t *obj = obj_from_oid(anjay, oid);
-    if (!obj) {
-        log_invalid_parameters(_("Object") " %d" _(" not installed"), oid);
-        return -1;
-    }
-
-    instance_t *inst;
-    if (iid > obj->instance_count
-            || !(inst = &obj->instances[iid])->initialized) {
+static instance_t *
+find_instance(object_t *obj, anjay_oid_t oid, anjay_iid_t iid) {
+    if (iid >= obj->instance_count || !obj->instances[iid].initialized) {
         log_invalid_parameters(_("Object") " %d" _(" has no instance") " %d",
                                oid, iid);
-        return -1;
+        return NULL;
     }
+    return &obj->instances[iid];
+}
 
+static int validate_value(anjay_oid_t oid, anjay_iid_t iid, double value) {
     if (!isfinite(value)) {
         log_invalid_parameters(_("Update of") " /%d/%d" _(" failed"), oid, iid);
         return -1;
     }
+    return 0;
+}
 
+static void apply_value(anjay_unlocked_t *anjay,
+                        anjay_oid_t oid,
+                        anjay_iid_t iid,
+                        instance_t *inst,
+                        double value) {
     if (value != inst->curr_value) {
         inst->curr_value = value;
         (void) _anjay_notify_changed_unlocked(anjay, oid, iid,
@@ -464,6 +475,55 @@ static int sensor_value_update_unlocked(anjay_unlocked_t *anjay,
                                                   RID_MAX_MEASURED_VALUE);
         }
     }
+    if (inst->history) {
+        _anjay_ipso_v2_history_record(inst->history, &value);
+    }
+}
+
+static int sensor_value_update_unlocked(anjay_unlocked_t *anjay,
+                                        anjay_oid_t oid,
+                                        anjay_iid_t iid,
+                                        double value) {
+    object_t *obj = obj_from_oid(anjay, oid);
+    if (!obj) {
+        log_invalid_parameters(_("Object") " %d" _(" not installed"), oid);
+        return -1;
+    }
+
+    instance_t *inst = find_instance(obj, oid, iid);
+    if (!inst || validate_value(oid, iid, value)) {
+        return -1;
+    }
+
+    apply_value(anjay, oid, iid, inst, value);
+    return 0;
+}
+
+static int sensor_values_update_unlocked(
+        anjay_unlocked_t *anjay,
+        anjay_oid_t oid,
+        const anjay_ipso_v2_basic_sensor_value_entry_t *entries,
+        size_t entry_count) {
+    object_t *obj = obj_from_oid(anjay, oid);
+    if (!obj) {
+        log_invalid_parameters(_("Object") " %d" _(" not installed"), oid);
+        return -1;
+    }
+
+    // validate everything first, so that the update is all-or-nothing
+    for (size_t i = 0; i < entry_count; ++i) {
+        if (!find_instance(obj, oid, entries[i].iid)
+                || validate_value(oid, entries[i].iid, entries[i].value)) {
+            return -1;
+        }
+    }
+
+    // all changes end up in the same notification queue, flushed by a single
+    // scheduler job after the lock is released
+    for (size_t i = 0; i < entry_count; ++i) {
+        apply_value(anjay, oid, entries[i].iid,
+                    &obj->instances[entries[i].iid], entries[i].value);
+    }
 
     return 0;
 }
@@ -482,4 +542,73 @@ int anjay_ipso_v2_basic_sensor_value_update(anjay_t *anjay_locked,
     return res;
 }
 
+int anjay_ipso_v2_basic_sensor_values_update(
+        anjay_t *anjay_locked,
+        anjay_oid_t oid,
+        const anjay_ipso_v2_basic_sensor_value_entry_t *entries,
+        size_t entry_count) {
+    assert(anjay_locked);
+    assert(entries || !entry_count);
+
+    int res = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    res = sensor_values_update_unlocked(anjay, oid, entries, entry_count);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+
+    return res;
+}
+
+#    ifdef ANJAY_WITH_SEND
+static int sensor_history_drain_unlocked(anjay_unlocked_t *anjay,
+                                         anjay_oid_t oid,
+                                         anjay_send_batch_builder_t *builder) {
+    object_t *obj = obj_from_oid(anjay, oid);
+    if (!obj) {
+        log_invalid_parameters(_("Object") " %d" _(" not installed"), oid);
+        return -1;
+    }
+
+    static const anjay_rid_t rid = RID_SENSOR_VALUE;
+    const anjay_send_batch_builder_mark_t mark =
+            _anjay_send_batch_builder_mark(builder);
+    for (size_t iid = 0; iid < obj->instance_count; ++iid) {
+        instance_t *inst = &obj->instances[iid];
+        if (inst->initialized && inst->history
+                && _anjay_ipso_v2_history_add_to_batch(
+                           inst->history, builder, oid, (anjay_iid_t) iid,
+                           &rid)) {
+            _anjay_send_batch_builder_rollback(builder, mark);
+            return -1;
+        }
+    }
+    for (size_t iid = 0; iid < obj->instance_count; ++iid) {
+        instance_t *inst = &obj->instances[iid];
+        if (inst->initialized && inst->history) {
+            _anjay_ipso_v2_history_clear(inst->history);
+        }
+    }
+
+    return 0;
+}
+
+int anjay_ipso_v2_basic_sensor_history_drain(
+        anjay_t *anjay_locked,
+        anjay_oid_t oid,
+        anjay_send_batch_builder_t *builder) {
+    assert(anjay_locked);
+    assert(builder);
+
+    int res = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    res = sensor_history_drain_unlocked(anjay, oid, builder);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+
+    return res;
+}
+#    endif // ANJAY_WITH_SEND
+
+#    ifdef ANJAY_TEST
+#        include "tests/modules/ipso_v2/basic_sensor.c"
+#    endif // ANJAY_TEST
+
 #endif // ANJAY_WITH_MODULE_IPSO_OBJECTS_V2
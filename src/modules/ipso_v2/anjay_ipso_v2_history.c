@@ -0,0 +1,158 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#ifdef ANJAY_WITH_MODULE_IPSO_OBJECTS_V2
+
+#    include <assert.h>
+#    include <stdint.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_memory.h>
+
+#    include <anjay_modules/anjay_dm_utils.h>
+#    include <anjay_modules/anjay_utils_core.h>
+
+#    include "anjay_ipso_v2_history.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+typedef struct {
+    AVS_LIST(anjay_ipso_v2_history_t) buffers;
+} history_module_t;
+
+static void history_module_delete(void *module_) {
+    history_module_t *module = (history_module_t *) module_;
+    AVS_LIST_CLEAR(&module->buffers);
+    avs_free(module);
+}
+
+static history_module_t *get_or_install_module(anjay_unlocked_t *anjay) {
+    history_module_t *module = (history_module_t *) _anjay_dm_module_get_arg(
+            anjay, history_module_delete);
+    if (module) {
+        return module;
+    }
+    if (!(module = (history_module_t *) avs_calloc(1, sizeof(*module)))) {
+        _anjay_log_oom();
+        return NULL;
+    }
+    if (_anjay_dm_module_install(anjay, history_module_delete, module)) {
+        avs_free(module);
+        return NULL;
+    }
+    return module;
+}
+
+AVS_LIST(anjay_ipso_v2_history_t)
+_anjay_ipso_v2_history_create(anjay_unlocked_t *anjay,
+                              size_t depth,
+                              size_t decimation,
+                              size_t axis_count) {
+    assert(depth);
+    assert(axis_count && axis_count <= ANJAY_IPSO_V2_HISTORY_MAX_AXES);
+    const size_t sample_size =
+            sizeof(avs_time_real_t) + axis_count * sizeof(double);
+    if (depth > (SIZE_MAX - sizeof(anjay_ipso_v2_history_t)) / sample_size) {
+        _anjay_log(ipso, ERROR, _("History depth too large"));
+        return NULL;
+    }
+
+    history_module_t *module = get_or_install_module(anjay);
+    if (!module) {
+        return NULL;
+    }
+    AVS_LIST(anjay_ipso_v2_history_t) history =
+            (AVS_LIST(anjay_ipso_v2_history_t)) AVS_LIST_NEW_BUFFER(
+                    sizeof(anjay_ipso_v2_history_t) + depth * sample_size);
+    if (!history) {
+        _anjay_log_oom();
+        return NULL;
+    }
+    history->depth = depth;
+    history->decimation = decimation ? decimation : 1;
+    history->axis_count = axis_count;
+    history->timestamps =
+            (avs_time_real_t *) &history->values[depth * axis_count];
+    AVS_LIST_INSERT(&module->buffers, history);
+    return history;
+}
+
+void _anjay_ipso_v2_history_delete(
+        anjay_unlocked_t *anjay, AVS_LIST(anjay_ipso_v2_history_t) *history) {
+    if (!*history) {
+        return;
+    }
+    history_module_t *module = (history_module_t *) _anjay_dm_module_get_arg(
+            anjay, history_module_delete);
+    assert(module);
+    AVS_LIST(anjay_ipso_v2_history_t) *history_ptr =
+            (AVS_LIST(anjay_ipso_v2_history_t) *) AVS_LIST_FIND_PTR(
+                    &module->buffers, *history);
+    assert(history_ptr);
+    AVS_LIST_DELETE(history_ptr);
+    *history = NULL;
+}
+
+void _anjay_ipso_v2_history_record(anjay_ipso_v2_history_t *history,
+                                   const double *values) {
+    if (history->skipped + 1 < history->decimation) {
+        ++history->skipped;
+        return;
+    }
+    history->skipped = 0;
+
+    size_t index;
+    if (history->count < history->depth) {
+        index = (history->first + history->count++) % history->depth;
+    } else {
+        index = history->first;
+        history->first = (history->first + 1) % history->depth;
+    }
+    history->timestamps[index] = avs_time_real_now();
+    memcpy(&history->values[index * history->axis_count], values,
+           history->axis_count * sizeof(double));
+}
+
+void _anjay_ipso_v2_history_clear(anjay_ipso_v2_history_t *history) {
+    history->first = 0;
+    history->count = 0;
+}
+
+#    ifdef ANJAY_WITH_SEND
+int _anjay_ipso_v2_history_add_to_batch(
+        const anjay_ipso_v2_history_t *history,
+        anjay_send_batch_builder_t *builder,
+        anjay_oid_t oid,
+        anjay_iid_t iid,
+        const anjay_rid_t *rids) {
+    const anjay_send_batch_builder_mark_t mark =
+            _anjay_send_batch_builder_mark(builder);
+    for (size_t i = 0; i < history->count; ++i) {
+        const size_t index = (history->first + i) % history->depth;
+        for (size_t axis = 0; axis < history->axis_count; ++axis) {
+            if (anjay_send_batch_add_double(
+                        builder, oid, iid, rids[axis], ANJAY_ID_INVALID,
+                        history->timestamps[index],
+                        history->values[index * history->axis_count + axis])) {
+                _anjay_send_batch_builder_rollback(builder, mark);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+#    endif // ANJAY_WITH_SEND
+
+#    ifdef ANJAY_TEST
+#        include "tests/modules/ipso_v2/history.c"
+#    endif // ANJAY_TEST
+
+#endif // ANJAY_WITH_MODULE_IPSO_OBJECTS_V2
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_IPSO_V2_HISTORY_H
+#define ANJAY_IPSO_V2_HISTORY_H
+#include <anjay_init.h>
+
+#include <stddef.h>
+
+#include <avsystem/commons/avs_list.h>
+#include <avsystem/commons/avs_time.h>
+
+#include <anjay/lwm2m_send.h>
+
+#include <anjay_modules/anjay_dm_utils.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#define ANJAY_IPSO_V2_HISTORY_MAX_AXES 3
+
+/**
+ * Ring buffer of timestamped samples of a single sensor Object Instance.
+ *
+ * Buffers are allocated as elements of a list owned by a DM module, so that
+ * they are freed together with the Anjay object even if the sensor Instances
+ * are never removed.
+ */
+typedef struct {
+    size_t depth;
+    size_t decimation;
+    size_t axis_count;
+    /** Number of updates ignored since the last recorded sample */
+    size_t skipped;
+    /** Index of the oldest recorded sample */
+    size_t first;
+    size_t count;
+    /** @c timestamps array of @c depth elements follows @c values */
+    avs_time_real_t *timestamps;
+    /** @c depth samples, @c axis_count values each */
+    double values[];
+} anjay_ipso_v2_history_t;
+
+/**
+ * Allocates a history buffer for @p depth samples of @p axis_count values.
+ * Only every @p decimation -th sample is recorded; 0 is treated as 1.
+ */
+AVS_LIST(anjay_ipso_v2_history_t)
+_anjay_ipso_v2_history_create(anjay_unlocked_t *anjay,
+                              size_t depth,
+                              size_t decimation,
+                              size_t axis_count);
+
+void _anjay_ipso_v2_history_delete(anjay_unlocked_t *anjay,
+                                   AVS_LIST(anjay_ipso_v2_history_t) *history);
+
+/**
+ * Records @p values (@c axis_count elements) with the current real time,
+ * overwriting the oldest sample if the buffer is full.
+ */
+void _anjay_ipso_v2_history_record(anjay_ipso_v2_history_t *history,
+                                   const double *values);
+
+/**
+ * Discards all recorded samples.
+ */
+void _anjay_ipso_v2_history_clear(anjay_ipso_v2_history_t *history);
+
+#ifdef ANJAY_WITH_SEND
+/**
+ * Adds recorded samples to @p builder, oldest first. Value of the i-th axis is
+ * added as Resource <c>/oid/iid/rids[i]</c>. The buffer itself is not
+ * modified, so that the samples can be cleared with
+ * @ref _anjay_ipso_v2_history_clear once all buffers of an Object are added.
+ *
+ * If adding a sample fails, all entries added by this call are removed from
+ * @p builder.
+ */
+int _anjay_ipso_v2_history_add_to_batch(
+        const anjay_ipso_v2_history_t *history,
+        anjay_send_batch_builder_t *builder,
+        anjay_oid_t oid,
+        anjay_iid_t iid,
+        const anjay_rid_t *rids);
+#endif // ANJAY_WITH_SEND
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif // ANJAY_IPSO_V2_HISTORY_H
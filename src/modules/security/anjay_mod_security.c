@@ -101,6 +101,7 @@ static void init_instance(sec_instance_t *instance, anjay_iid_t iid) {
     instance->certificate_usage = -1;
 #    endif // ANJAY_WITH_LWM2M11
     _anjay_sec_instance_update_resource_presence(instance);
+    instance->modified_since_persist = true;
 }
 
 static int add_instance(sec_repr_t *repr,
@@ -285,7 +286,7 @@ static int add_instance(sec_repr_t *repr,
                      *inout_iid, instance->ssid, instance->server_uri);
     }
 
-    _anjay_sec_mark_modified(repr);
+    _anjay_sec_mark_instance_modified(repr, new_instance);
     return 0;
 
 error:
@@ -505,7 +506,7 @@ static int sec_write(anjay_unlocked_t *anjay,
     int retval;
     assert(inst);
 
-    _anjay_sec_mark_modified(repr);
+    _anjay_sec_mark_instance_modified(repr, inst);
 
     switch ((security_rid_t) rid) {
     case SEC_RES_LWM2M_SERVER_URI:
@@ -609,10 +610,12 @@ static int sec_resource_reset(anjay_unlocked_t *anjay,
     assert(rid == SEC_RES_DTLS_TLS_CIPHERSUITE);
     (void) rid;
 
-    const sec_instance_t *inst = find_instance(_anjay_sec_get(obj_ptr), iid);
+    sec_repr_t *repr = _anjay_sec_get(obj_ptr);
+    sec_instance_t *inst = find_instance(repr, iid);
     assert(inst);
 
     AVS_LIST_CLEAR(&inst->enabled_ciphersuites);
+    _anjay_sec_mark_instance_modified(repr, inst);
     return 0;
 }
 
@@ -692,11 +695,13 @@ static int sec_instance_reset(anjay_unlocked_t *anjay,
                               const anjay_dm_installed_object_t obj_ptr,
                               anjay_iid_t iid) {
     (void) anjay;
-    sec_instance_t *inst = find_instance(_anjay_sec_get(obj_ptr), iid);
+    sec_repr_t *repr = _anjay_sec_get(obj_ptr);
+    sec_instance_t *inst = find_instance(repr, iid);
     assert(inst);
 
     _anjay_sec_destroy_instance_fields(inst, true);
     init_instance(inst, iid);
+    _anjay_sec_mark_modified(repr);
     return 0;
 }
 
@@ -776,6 +781,9 @@ static void security_delete(void *repr_) {
         _anjay_sec_destroy_instances(&repr->instances,
                                      repr->modified_since_persist);
     }
+#ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
+    _anjay_journal_state_cleanup(&repr->journal);
+#endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
     // NOTE: repr itself will be freed when cleaning the objects list
 }
 
@@ -13,6 +13,7 @@
 
 #include <anjay/security.h>
 
+#include <anjay_modules/anjay_persistence_journal.h>
 #include <anjay_modules/anjay_raw_buffer.h>
 #include <anjay_modules/dm/anjay_modules.h>
 
@@ -111,6 +112,11 @@ typedef struct {
 #endif // ANJAY_WITH_LWM2M11
 
     bool present_resources[_SEC_RES_COUNT];
+    /**
+     * Set whenever the Instance is modified; used to find the Instances that
+     * need to be written by anjay_security_object_journal_append().
+     */
+    bool modified_since_persist;
 } sec_instance_t;
 
 typedef struct {
@@ -121,12 +127,21 @@ typedef struct {
     bool modified_since_persist;
     bool saved_modified_since_persist;
     bool in_transaction;
+#ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
+    anjay_journal_state_t journal;
+#endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
 } sec_repr_t;
 
 static inline void _anjay_sec_mark_modified(sec_repr_t *repr) {
     repr->modified_since_persist = true;
 }
 
+static inline void _anjay_sec_mark_instance_modified(sec_repr_t *repr,
+                                                    sec_instance_t *inst) {
+    inst->modified_since_persist = true;
+    _anjay_sec_mark_modified(repr);
+}
+
 static inline void _anjay_sec_clear_modified(sec_repr_t *repr) {
     repr->modified_since_persist = false;
 }
@@ -18,6 +18,7 @@
 #    include <anjay_modules/anjay_dm_utils.h>
 
 #    include <inttypes.h>
+#    include <stddef.h>
 #    include <string.h>
 
 #    include "anjay_security_transaction.h"
@@ -473,15 +474,43 @@ static avs_error_t handle_instance(avs_persistence_context_t *ctx,
     return err;
 }
 
+static avs_error_t handle_journal_instance(avs_persistence_context_t *ctx,
+                                           void *element,
+                                           uint8_t version) {
+    return handle_instance(ctx, element, (void *) (intptr_t) version);
+}
+
+static void destroy_journal_instance(AVS_LIST(void) *element_ptr) {
+    _anjay_sec_destroy_instances((AVS_LIST(sec_instance_t) *) element_ptr,
+                                 true);
+}
+
+static const anjay_journal_instances_def_t JOURNAL_DEF = {
+    .element_size = sizeof(sec_instance_t),
+    .iid_offset = offsetof(sec_instance_t, iid),
+    .modified_offset = offsetof(sec_instance_t, modified_since_persist),
+    .version = 5,
+    .handle_instance = handle_journal_instance,
+    .destroy_instance = destroy_journal_instance
+};
+
+static AVS_LIST(sec_instance_t) *persisted_instances_ptr(sec_repr_t *repr) {
+    return repr->in_transaction ? &repr->saved_instances : &repr->instances;
+}
+
+static sec_repr_t *get_repr(anjay_unlocked_t *anjay) {
+    const anjay_dm_installed_object_t *sec_obj =
+            _anjay_dm_find_object_by_oid(_anjay_get_dm(anjay),
+                                         ANJAY_DM_OID_SECURITY);
+    return sec_obj ? _anjay_sec_get(*sec_obj) : NULL;
+}
+
 avs_error_t anjay_security_object_persist(anjay_t *anjay_locked,
                                           avs_stream_t *out_stream) {
     assert(anjay_locked);
     avs_error_t err = avs_errno(AVS_EINVAL);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    const anjay_dm_installed_object_t *sec_obj =
-            _anjay_dm_find_object_by_oid(_anjay_get_dm(anjay),
-                                         ANJAY_DM_OID_SECURITY);
-    sec_repr_t *repr = sec_obj ? _anjay_sec_get(*sec_obj) : NULL;
+    sec_repr_t *repr = get_repr(anjay);
     if (!repr) {
         err = avs_errno(AVS_EBADF);
     } else if (avs_is_ok((err = avs_stream_write(out_stream, MAGIC_V5,
@@ -489,14 +518,13 @@ avs_error_t anjay_security_object_persist(anjay_t *anjay_locked,
         avs_persistence_context_t ctx =
                 avs_persistence_store_context_create(out_stream);
         err = avs_persistence_list(
-                &ctx,
-                (AVS_LIST(void) *) (repr->in_transaction
-                                            ? &repr->saved_instances
-                                            : &repr->instances),
+                &ctx, (AVS_LIST(void) *) persisted_instances_ptr(repr),
                 sizeof(sec_instance_t), handle_instance, (void *) (intptr_t) 5,
                 NULL);
         if (avs_is_ok(err)) {
             _anjay_sec_clear_modified(repr);
+            _anjay_journal_state_update(&repr->journal, &JOURNAL_DEF,
+                                        *persisted_instances_ptr(repr));
             persistence_log(INFO, _("Security Object state persisted"));
         }
     }
@@ -504,75 +532,125 @@ avs_error_t anjay_security_object_persist(anjay_t *anjay_locked,
     return err;
 }
 
+static avs_error_t restore_snapshot(avs_stream_t *in_stream,
+                                    AVS_LIST(sec_instance_t) *out_instances) {
+    AVS_STATIC_ASSERT(sizeof(MAGIC_V0) == sizeof(MAGIC_V1), magic_size_v0_v1);
+    AVS_STATIC_ASSERT(sizeof(MAGIC_V1) == sizeof(MAGIC_V2), magic_size_v1_v2);
+    AVS_STATIC_ASSERT(sizeof(MAGIC_V2) == sizeof(MAGIC_V3), magic_size_v2_v3);
+    AVS_STATIC_ASSERT(sizeof(MAGIC_V3) == sizeof(MAGIC_V4), magic_size_v3_v4);
+    AVS_STATIC_ASSERT(sizeof(MAGIC_V4) == sizeof(MAGIC_V5), magic_size_v4_v5);
+    char magic_header[sizeof(MAGIC_V0)];
+    int version = -1;
+    avs_error_t err;
+    if (avs_is_err((err = avs_stream_read_reliably(in_stream, magic_header,
+                                                   sizeof(magic_header))))) {
+        persistence_log(WARNING, _("Could not read Security Object header"));
+    } else if (!memcmp(magic_header, MAGIC_V0, sizeof(MAGIC_V0))) {
+        version = 0;
+    } else if (!memcmp(magic_header, MAGIC_V1, sizeof(MAGIC_V1))) {
+        version = 1;
+    } else if (!memcmp(magic_header, MAGIC_V2, sizeof(MAGIC_V2))) {
+        version = 2;
+    } else if (!memcmp(magic_header, MAGIC_V3, sizeof(MAGIC_V3))) {
+        version = 3;
+    } else if (!memcmp(magic_header, MAGIC_V4, sizeof(MAGIC_V4))) {
+        version = 4;
+    } else if (!memcmp(magic_header, MAGIC_V5, sizeof(MAGIC_V5))) {
+        version = 5;
+    } else {
+        persistence_log(WARNING, _("Header magic constant mismatch"));
+        err = avs_errno(AVS_EBADMSG);
+    }
+    if (avs_is_ok(err)) {
+        avs_persistence_context_t restore_ctx =
+                avs_persistence_restore_context_create(in_stream);
+        err = avs_persistence_list(&restore_ctx,
+                                   (AVS_LIST(void) *) out_instances,
+                                   sizeof(sec_instance_t), handle_instance,
+                                   (void *) (intptr_t) version, NULL);
+    }
+    return err;
+}
+
+static avs_error_t restore(anjay_unlocked_t *anjay,
+                           sec_repr_t *repr,
+                           avs_stream_t *in_stream,
+                           avs_stream_t *journal_stream) {
+    AVS_LIST(sec_instance_t) backup = repr->instances;
+    repr->instances = NULL;
+    avs_error_t err = AVS_OK;
+    if (in_stream) {
+        err = restore_snapshot(in_stream, &repr->instances);
+    }
+    if (avs_is_ok(err) && journal_stream) {
+        err = _anjay_journal_replay_instances(
+                &JOURNAL_DEF, (AVS_LIST(void) *) &repr->instances,
+                journal_stream);
+    }
+    if (avs_is_ok(err)
+            && _anjay_sec_object_validate_and_process_keys(anjay, repr)) {
+        err = avs_errno(AVS_EPROTO);
+    }
+    if (avs_is_err(err)) {
+        _anjay_sec_destroy_instances(&repr->instances, true);
+        repr->instances = backup;
+    } else {
+        _anjay_sec_destroy_instances(&backup, true);
+        _anjay_sec_clear_modified(repr);
+        _anjay_journal_state_update(&repr->journal, &JOURNAL_DEF,
+                                    repr->instances);
+    }
+    return err;
+}
+
 avs_error_t anjay_security_object_restore(anjay_t *anjay_locked,
                                           avs_stream_t *in_stream) {
     assert(anjay_locked);
     avs_error_t err = avs_errno(AVS_EINVAL);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    const anjay_dm_installed_object_t *sec_obj =
-            _anjay_dm_find_object_by_oid(_anjay_get_dm(anjay),
-                                         ANJAY_DM_OID_SECURITY);
-    sec_repr_t *repr = sec_obj ? _anjay_sec_get(*sec_obj) : NULL;
+    sec_repr_t *repr = get_repr(anjay);
     if (!repr || repr->in_transaction) {
         err = avs_errno(AVS_EBADF);
-    } else {
-        sec_repr_t backup = *repr;
-
-        AVS_STATIC_ASSERT(sizeof(MAGIC_V0) == sizeof(MAGIC_V1),
-                          magic_size_v0_v1);
-        AVS_STATIC_ASSERT(sizeof(MAGIC_V1) == sizeof(MAGIC_V2),
-                          magic_size_v1_v2);
-        AVS_STATIC_ASSERT(sizeof(MAGIC_V2) == sizeof(MAGIC_V3),
-                          magic_size_v2_v3);
-        AVS_STATIC_ASSERT(sizeof(MAGIC_V3) == sizeof(MAGIC_V4),
-                          magic_size_v3_v4);
-        AVS_STATIC_ASSERT(sizeof(MAGIC_V4) == sizeof(MAGIC_V5),
-                          magic_size_v4_v5);
-        char magic_header[sizeof(MAGIC_V0)];
-        int version = -1;
-        if (avs_is_err(
-                    (err = avs_stream_read_reliably(in_stream, magic_header,
-                                                    sizeof(magic_header))))) {
-            persistence_log(WARNING,
-                            _("Could not read Security Object header"));
-        } else if (!memcmp(magic_header, MAGIC_V0, sizeof(MAGIC_V0))) {
-            version = 0;
-        } else if (!memcmp(magic_header, MAGIC_V1, sizeof(MAGIC_V1))) {
-            version = 1;
-        } else if (!memcmp(magic_header, MAGIC_V2, sizeof(MAGIC_V2))) {
-            version = 2;
-        } else if (!memcmp(magic_header, MAGIC_V3, sizeof(MAGIC_V3))) {
-            version = 3;
-        } else if (!memcmp(magic_header, MAGIC_V4, sizeof(MAGIC_V4))) {
-            version = 4;
-        } else if (!memcmp(magic_header, MAGIC_V5, sizeof(MAGIC_V5))) {
-            version = 5;
-        } else {
-            persistence_log(WARNING, _("Header magic constant mismatch"));
-            err = avs_errno(AVS_EBADMSG);
-        }
-        if (avs_is_ok(err)) {
-            avs_persistence_context_t restore_ctx =
-                    avs_persistence_restore_context_create(in_stream);
-            repr->instances = NULL;
-            err = avs_persistence_list(&restore_ctx,
-                                       (AVS_LIST(void) *) &repr->instances,
-                                       sizeof(sec_instance_t), handle_instance,
-                                       (void *) (intptr_t) version, NULL);
-            if (avs_is_ok(err)
-                    && _anjay_sec_object_validate_and_process_keys(anjay,
-                                                                   repr)) {
-                err = avs_errno(AVS_EPROTO);
-            }
-            if (avs_is_err(err)) {
-                _anjay_sec_destroy_instances(&repr->instances, true);
-                repr->instances = backup.instances;
-            } else {
-                _anjay_sec_destroy_instances(&backup.instances, true);
-                _anjay_sec_clear_modified(repr);
-                persistence_log(INFO, _("Security Object state restored"));
-            }
-        }
+    } else if (avs_is_ok((err = restore(anjay, repr, in_stream, NULL)))) {
+        persistence_log(INFO, _("Security Object state restored"));
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+avs_error_t anjay_security_object_journal_append(anjay_t *anjay_locked,
+                                                 avs_stream_t *journal_stream) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    sec_repr_t *repr = get_repr(anjay);
+    if (!repr) {
+        err = avs_errno(AVS_EBADF);
+    } else if (avs_is_ok((err = _anjay_journal_append_instances(
+                                  &repr->journal, &JOURNAL_DEF,
+                                  *persisted_instances_ptr(repr),
+                                  journal_stream)))) {
+        _anjay_sec_clear_modified(repr);
+        persistence_log(DEBUG, _("Security Object journal appended"));
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+avs_error_t
+anjay_security_object_journal_restore(anjay_t *anjay_locked,
+                                      avs_stream_t *in_stream,
+                                      avs_stream_t *journal_stream) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    sec_repr_t *repr = get_repr(anjay);
+    if (!repr || repr->in_transaction) {
+        err = avs_errno(AVS_EBADF);
+    } else if (avs_is_ok((err = restore(anjay, repr, in_stream,
+                                        journal_stream)))) {
+        persistence_log(INFO,
+                        _("Security Object state restored from journal"));
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return err;
@@ -600,6 +678,25 @@ avs_error_t anjay_security_object_restore(anjay_t *anjay,
     return avs_errno(AVS_ENOTSUP);
 }
 
+avs_error_t anjay_security_object_journal_append(anjay_t *anjay,
+                                                 avs_stream_t *journal_stream) {
+    (void) anjay;
+    (void) journal_stream;
+    persistence_log(ERROR, _("Persistence not compiled in"));
+    return avs_errno(AVS_ENOTSUP);
+}
+
+avs_error_t
+anjay_security_object_journal_restore(anjay_t *anjay,
+                                      avs_stream_t *in_stream,
+                                      avs_stream_t *journal_stream) {
+    (void) anjay;
+    (void) in_stream;
+    (void) journal_stream;
+    persistence_log(ERROR, _("Persistence not compiled in"));
+    return avs_errno(AVS_ENOTSUP);
+}
+
 #    endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
 
 #endif // ANJAY_WITH_MODULE_SECURITY
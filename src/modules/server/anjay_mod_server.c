@@ -159,7 +159,7 @@ static void insert_created_instance(server_repr_t *repr,
             break;
         }
     }
-    _anjay_serv_mark_modified(repr);
+    _anjay_serv_mark_instance_modified(repr, new_instance);
     AVS_LIST_INSERT(ptr, new_instance);
 }
 
@@ -329,13 +329,15 @@ static int serv_instance_reset(anjay_unlocked_t *anjay,
                                const anjay_dm_installed_object_t obj_ptr,
                                anjay_iid_t iid) {
     (void) anjay;
-    server_instance_t *inst = find_instance(_anjay_serv_get(obj_ptr), iid);
+    server_repr_t *repr = _anjay_serv_get(obj_ptr);
+    server_instance_t *inst = find_instance(repr, iid);
     assert(inst);
 
     anjay_ssid_t ssid = inst->ssid;
     _anjay_serv_reset_instance(inst);
     inst->present_resources[SERV_RES_SSID] = true;
     inst->ssid = ssid;
+    _anjay_serv_mark_instance_modified(repr, inst);
     return 0;
 }
 
@@ -445,7 +447,7 @@ static int serv_write(anjay_unlocked_t *anjay,
     assert(inst);
     int retval;
 
-    _anjay_serv_mark_modified(repr);
+    _anjay_serv_mark_instance_modified(repr, inst);
 
     switch ((server_rid_t) rid) {
     case SERV_RES_SSID:
@@ -679,6 +681,9 @@ static void server_purge(server_repr_t *repr) {
 
 static void server_delete(void *repr) {
     server_purge((server_repr_t *) repr);
+#ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
+    _anjay_journal_state_cleanup(&((server_repr_t *) repr)->journal);
+#endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
     // NOTE: repr itself will be freed when cleaning the objects list
 }
 
@@ -804,7 +809,7 @@ int anjay_server_object_set_lifetime(anjay_t *anjay_locked,
                                                ANJAY_DM_RID_SERVER_LIFETIME)) {
                 server_log(WARNING, _("could not notify lifetime change"));
             }
-            repr->modified_since_persist = true;
+            _anjay_serv_mark_instance_modified(repr, it);
             it->lifetime = lifetime;
             result = 0;
         }
@@ -11,6 +11,7 @@
 #define SERVER_MOD_SERVER_H
 #include <anjay_init.h>
 
+#include <anjay_modules/anjay_persistence_journal.h>
 #include <anjay_modules/anjay_utils_core.h>
 #include <anjay_modules/dm/anjay_modules.h>
 
@@ -74,6 +75,11 @@ typedef struct {
 #endif     // ANJAY_WITH_LWM2M11
 
     bool present_resources[_SERV_RES_COUNT];
+    /**
+     * Set whenever the Instance is modified; used to find the Instances that
+     * need to be written by anjay_server_object_journal_append().
+     */
+    bool modified_since_persist;
 } server_instance_t;
 
 typedef struct {
@@ -84,12 +90,22 @@ typedef struct {
     bool modified_since_persist;
     bool saved_modified_since_persist;
     bool in_transaction;
+#ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
+    anjay_journal_state_t journal;
+#endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
 } server_repr_t;
 
 static inline void _anjay_serv_mark_modified(server_repr_t *repr) {
     repr->modified_since_persist = true;
 }
 
+static inline void
+_anjay_serv_mark_instance_modified(server_repr_t *repr,
+                                   server_instance_t *inst) {
+    inst->modified_since_persist = true;
+    _anjay_serv_mark_modified(repr);
+}
+
 static inline void _anjay_serv_clear_modified(server_repr_t *repr) {
     repr->modified_since_persist = false;
 }
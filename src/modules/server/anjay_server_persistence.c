@@ -21,6 +21,7 @@
 #    include <anjay_modules/anjay_dm_utils.h>
 
 #    include <inttypes.h>
+#    include <stddef.h>
 #    include <string.h>
 
 #    include "anjay_server_transaction.h"
@@ -409,15 +410,46 @@ static avs_error_t server_instance_persistence_handler(
     return err;
 }
 
+static avs_error_t handle_journal_instance(avs_persistence_context_t *ctx,
+                                           void *element,
+                                           uint8_t version) {
+    server_persistence_version_t persistence_version =
+            (server_persistence_version_t) version;
+    return server_instance_persistence_handler(ctx, element,
+                                               &persistence_version);
+}
+
+static void destroy_journal_instance(AVS_LIST(void) *element_ptr) {
+    _anjay_serv_destroy_instances((AVS_LIST(server_instance_t) *) element_ptr);
+}
+
+static const anjay_journal_instances_def_t JOURNAL_DEF = {
+    .element_size = sizeof(server_instance_t),
+    .iid_offset = offsetof(server_instance_t, iid),
+    .modified_offset = offsetof(server_instance_t, modified_since_persist),
+    .version = PERSISTENCE_VERSION_3,
+    .handle_instance = handle_journal_instance,
+    .destroy_instance = destroy_journal_instance
+};
+
+static AVS_LIST(server_instance_t) *
+persisted_instances_ptr(server_repr_t *repr) {
+    return repr->in_transaction ? &repr->saved_instances : &repr->instances;
+}
+
+static server_repr_t *get_repr(anjay_unlocked_t *anjay) {
+    const anjay_dm_installed_object_t *server_obj =
+            _anjay_dm_find_object_by_oid(_anjay_get_dm(anjay),
+                                         ANJAY_DM_OID_SERVER);
+    return server_obj ? _anjay_serv_get(*server_obj) : NULL;
+}
+
 avs_error_t anjay_server_object_persist(anjay_t *anjay_locked,
                                         avs_stream_t *out_stream) {
     assert(anjay_locked);
     avs_error_t err = avs_errno(AVS_EINVAL);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    const anjay_dm_installed_object_t *server_obj =
-            _anjay_dm_find_object_by_oid(_anjay_get_dm(anjay),
-                                         ANJAY_DM_OID_SERVER);
-    server_repr_t *repr = server_obj ? _anjay_serv_get(*server_obj) : NULL;
+    server_repr_t *repr = get_repr(anjay);
     if (!repr) {
         err = avs_errno(AVS_EBADF);
     } else {
@@ -430,14 +462,14 @@ avs_error_t anjay_server_object_persist(anjay_t *anjay_locked,
                     PERSISTENCE_VERSION_3;
             err = avs_persistence_list(
                     &persist_ctx,
-                    (AVS_LIST(void) *) (repr->in_transaction
-                                                ? &repr->saved_instances
-                                                : &repr->instances),
+                    (AVS_LIST(void) *) persisted_instances_ptr(repr),
                     sizeof(server_instance_t),
                     server_instance_persistence_handler, &persistence_version,
                     NULL);
             if (avs_is_ok(err)) {
                 _anjay_serv_clear_modified(repr);
+                _anjay_journal_state_update(&repr->journal, &JOURNAL_DEF,
+                                            *persisted_instances_ptr(repr));
                 persistence_log(INFO, _("Server Object state persisted"));
             }
         }
@@ -467,51 +499,104 @@ static int check_magic_header(magic_t magic_header,
     return -1;
 }
 
+static avs_error_t
+restore_snapshot(avs_stream_t *in_stream,
+                 AVS_LIST(server_instance_t) *out_instances) {
+    avs_persistence_context_t restore_ctx =
+            avs_persistence_restore_context_create(in_stream);
+    magic_t magic_header;
+    server_persistence_version_t persistence_version;
+    avs_error_t err;
+    if (avs_is_err((err = avs_persistence_bytes(&restore_ctx, magic_header,
+                                                sizeof(magic_header))))) {
+        persistence_log(WARNING, _("Could not read Server Object header"));
+    } else if (check_magic_header(magic_header, &persistence_version)) {
+        persistence_log(WARNING, _("Header magic constant mismatch"));
+        err = avs_errno(AVS_EBADMSG);
+    } else {
+        err = avs_persistence_list(&restore_ctx,
+                                   (AVS_LIST(void) *) out_instances,
+                                   sizeof(server_instance_t),
+                                   server_instance_persistence_handler,
+                                   &persistence_version, NULL);
+    }
+    return err;
+}
+
+static avs_error_t restore(server_repr_t *repr,
+                           avs_stream_t *in_stream,
+                           avs_stream_t *journal_stream) {
+    AVS_LIST(server_instance_t) backup = repr->instances;
+    repr->instances = NULL;
+    avs_error_t err = AVS_OK;
+    if (in_stream) {
+        err = restore_snapshot(in_stream, &repr->instances);
+    }
+    if (avs_is_ok(err) && journal_stream) {
+        err = _anjay_journal_replay_instances(
+                &JOURNAL_DEF, (AVS_LIST(void) *) &repr->instances,
+                journal_stream);
+    }
+    if (avs_is_ok(err) && _anjay_serv_object_validate(repr)) {
+        err = avs_errno(AVS_EBADMSG);
+    }
+    if (avs_is_err(err)) {
+        _anjay_serv_destroy_instances(&repr->instances);
+        repr->instances = backup;
+    } else {
+        _anjay_serv_destroy_instances(&backup);
+        _anjay_serv_clear_modified(repr);
+        _anjay_journal_state_update(&repr->journal, &JOURNAL_DEF,
+                                    repr->instances);
+    }
+    return err;
+}
+
 avs_error_t anjay_server_object_restore(anjay_t *anjay_locked,
                                         avs_stream_t *in_stream) {
     assert(anjay_locked);
     avs_error_t err = avs_errno(AVS_EINVAL);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    const anjay_dm_installed_object_t *server_obj =
-            _anjay_dm_find_object_by_oid(_anjay_get_dm(anjay),
-                                         ANJAY_DM_OID_SERVER);
-    server_repr_t *repr = server_obj ? _anjay_serv_get(*server_obj) : NULL;
+    server_repr_t *repr = get_repr(anjay);
     if (!repr || repr->in_transaction) {
         err = avs_errno(AVS_EBADF);
-    } else {
-        server_repr_t backup = *repr;
-        avs_persistence_context_t restore_ctx =
-                avs_persistence_restore_context_create(in_stream);
-
-        magic_t magic_header;
-        if (avs_is_err((err = avs_persistence_bytes(&restore_ctx, magic_header,
-                                                    sizeof(magic_header))))) {
-            persistence_log(WARNING, _("Could not read Server Object header"));
-        } else {
-            server_persistence_version_t persistence_version;
-            if (check_magic_header(magic_header, &persistence_version)) {
-                persistence_log(WARNING, _("Header magic constant mismatch"));
-                err = avs_errno(AVS_EBADMSG);
-            } else {
-                repr->instances = NULL;
-                err = avs_persistence_list(&restore_ctx,
-                                           (AVS_LIST(void) *) &repr->instances,
-                                           sizeof(server_instance_t),
-                                           server_instance_persistence_handler,
-                                           &persistence_version, NULL);
-                if (avs_is_ok(err) && _anjay_serv_object_validate(repr)) {
-                    err = avs_errno(AVS_EBADMSG);
-                }
-                if (avs_is_err(err)) {
-                    _anjay_serv_destroy_instances(&repr->instances);
-                    repr->instances = backup.instances;
-                } else {
-                    _anjay_serv_destroy_instances(&backup.instances);
-                    _anjay_serv_clear_modified(repr);
-                    persistence_log(INFO, _("Server Object state restored"));
-                }
-            }
-        }
+    } else if (avs_is_ok((err = restore(repr, in_stream, NULL)))) {
+        persistence_log(INFO, _("Server Object state restored"));
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+avs_error_t anjay_server_object_journal_append(anjay_t *anjay_locked,
+                                               avs_stream_t *journal_stream) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    server_repr_t *repr = get_repr(anjay);
+    if (!repr) {
+        err = avs_errno(AVS_EBADF);
+    } else if (avs_is_ok((err = _anjay_journal_append_instances(
+                                  &repr->journal, &JOURNAL_DEF,
+                                  *persisted_instances_ptr(repr),
+                                  journal_stream)))) {
+        _anjay_serv_clear_modified(repr);
+        persistence_log(DEBUG, _("Server Object journal appended"));
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+avs_error_t anjay_server_object_journal_restore(anjay_t *anjay_locked,
+                                                avs_stream_t *in_stream,
+                                                avs_stream_t *journal_stream) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    server_repr_t *repr = get_repr(anjay);
+    if (!repr || repr->in_transaction) {
+        err = avs_errno(AVS_EBADF);
+    } else if (avs_is_ok((err = restore(repr, in_stream, journal_stream)))) {
+        persistence_log(INFO, _("Server Object state restored from journal"));
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return err;
@@ -539,6 +624,24 @@ avs_error_t anjay_server_object_restore(anjay_t *anjay,
     return avs_errno(AVS_ENOTSUP);
 }
 
+avs_error_t anjay_server_object_journal_append(anjay_t *anjay,
+                                               avs_stream_t *journal_stream) {
+    (void) anjay;
+    (void) journal_stream;
+    persistence_log(ERROR, _("Persistence not compiled in"));
+    return avs_errno(AVS_ENOTSUP);
+}
+
+avs_error_t anjay_server_object_journal_restore(anjay_t *anjay,
+                                                avs_stream_t *in_stream,
+                                                avs_stream_t *journal_stream) {
+    (void) anjay;
+    (void) in_stream;
+    (void) journal_stream;
+    persistence_log(ERROR, _("Persistence not compiled in"));
+    return avs_errno(AVS_ENOTSUP);
+}
+
 #    endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
 
 #endif // ANJAY_WITH_MODULE_SERVER
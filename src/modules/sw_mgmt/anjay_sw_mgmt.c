@@ -24,6 +24,8 @@
 #    ifdef ANJAY_WITH_DOWNLOADER
 #        include <anjay/download.h>
 
+#        include <anjay_modules/anjay_deferred_writer.h>
+
 #        include <avsystem/coap/code.h>
 
 #        include <avsystem/commons/avs_errno.h>
@@ -94,9 +96,16 @@ typedef struct sw_mgmt_instance_struct {
 
     bool cannot_delete;
 
+    // incremental integrity verification, see anjay_sw_mgmt_integrity_init_t
+    bool integrity_in_progress;
+    void *integrity_ctx;
+    bool integrity_verified;
+    int integrity_result;
+
 #    ifdef ANJAY_WITH_DOWNLOADER
     anjay_download_handle_t pull_download_handle;
     bool pull_download_stream_opened;
+    anjay_deferred_writer_t *pull_download_writer;
 #    endif // ANJAY_WITH_DOWNLOADER
 } sw_mgmt_instance_t;
 
@@ -111,6 +120,7 @@ typedef struct sw_mgmt_object_struct {
 
 #    if defined(ANJAY_WITH_DOWNLOADER)
     bool prefer_same_socket_downloads;
+    size_t deferred_write_queue_size;
     bool downloads_suspended;
 #    endif // defined(ANJAY_WITH_DOWNLOADER)
 } sw_mgmt_object_t;
@@ -288,14 +298,90 @@ static sw_mgmt_instance_t *find_instance(const sw_mgmt_object_t *obj,
     return NULL;
 }
 
+static int call_integrity_init(anjay_unlocked_t *anjay,
+                               sw_mgmt_object_t *obj,
+                               sw_mgmt_instance_t *inst) {
+    assert(!inst->integrity_in_progress);
+    inst->integrity_verified = false;
+    if (!obj->handlers->integrity_init) {
+        return 0;
+    }
+    int result = -1;
+    inst->integrity_ctx = NULL;
+    UNLOCK_FOR_SW_MGMT_CALLBACK(anjay_locked, anjay, inst);
+    result = obj->handlers->integrity_init(
+            obj->obj_ctx, inst->iid, inst->inst_ctx, &inst->integrity_ctx);
+    LOCK_AFTER_SW_MGMT_CALLBACK(anjay_locked, inst);
+    if (result) {
+        sw_mgmt_log_inst(ERROR, inst->iid,
+                         _("integrity_init() failed: ") "%d", result);
+    } else {
+        inst->integrity_in_progress = true;
+    }
+    return result;
+}
+
+static int call_integrity_update(anjay_unlocked_t *anjay,
+                                 sw_mgmt_object_t *obj,
+                                 sw_mgmt_instance_t *inst,
+                                 const void *data,
+                                 size_t length) {
+    if (!inst->integrity_in_progress) {
+        return 0;
+    }
+    int result = -1;
+    UNLOCK_FOR_SW_MGMT_CALLBACK(anjay_locked, anjay, inst);
+    result = obj->handlers->integrity_update(obj->obj_ctx, inst->iid,
+                                             inst->inst_ctx,
+                                             inst->integrity_ctx, data, length);
+    LOCK_AFTER_SW_MGMT_CALLBACK(anjay_locked, inst);
+    if (result) {
+        sw_mgmt_log_inst(ERROR, inst->iid,
+                         _("integrity_update() failed: ") "%d", result);
+    }
+    return result;
+}
+
+/**
+ * Releases the integrity verification context, if any. If the download has not
+ * been @p aborted, the verification result is stored, to be reported by
+ * check_integrity_job() instead of calling the check_integrity handler.
+ */
+static void call_integrity_finish(anjay_unlocked_t *anjay,
+                                  sw_mgmt_object_t *obj,
+                                  sw_mgmt_instance_t *inst,
+                                  bool aborted) {
+    if (!inst->integrity_in_progress) {
+        return;
+    }
+    inst->integrity_in_progress = false;
+    int result = -1;
+    UNLOCK_FOR_SW_MGMT_CALLBACK(anjay_locked, anjay, inst);
+    result = obj->handlers->integrity_finish(obj->obj_ctx, inst->iid,
+                                             inst->inst_ctx,
+                                             inst->integrity_ctx, aborted);
+    LOCK_AFTER_SW_MGMT_CALLBACK(anjay_locked, inst);
+    inst->integrity_ctx = NULL;
+    if (!aborted) {
+        inst->integrity_verified = true;
+        inst->integrity_result = result;
+    }
+}
+
 static inline int call_stream_open(anjay_unlocked_t *anjay,
                                    sw_mgmt_object_t *obj,
                                    sw_mgmt_instance_t *inst) {
-    int result = -1;
+    int result = call_integrity_init(anjay, obj, inst);
+    if (result) {
+        return result;
+    }
     UNLOCK_FOR_SW_MGMT_CALLBACK(anjay_locked, anjay, inst);
     result =
             obj->handlers->stream_open(obj->obj_ctx, inst->iid, inst->inst_ctx);
     LOCK_AFTER_SW_MGMT_CALLBACK(anjay_locked, inst);
+    if (result) {
+        call_integrity_finish(anjay, obj, inst, true);
+    }
     return result;
 }
 
@@ -326,6 +412,8 @@ static inline int call_stream_finish(anjay_unlocked_t *anjay,
 static inline void call_reset(anjay_unlocked_t *anjay,
                               sw_mgmt_object_t *obj,
                               sw_mgmt_instance_t *inst) {
+    call_integrity_finish(anjay, obj, inst, true);
+    inst->integrity_verified = false;
     UNLOCK_FOR_SW_MGMT_CALLBACK(anjay_locked, anjay, inst);
     obj->handlers->reset(obj->obj_ctx, inst->iid, inst->inst_ctx);
     LOCK_AFTER_SW_MGMT_CALLBACK(anjay_locked, inst);
@@ -370,10 +458,16 @@ static void check_integrity_job(avs_sched_t *sched, const void *inst_ptr) {
                                                           sw_mgmt_delete);
 
     int result = -1;
-    UNLOCK_FOR_SW_MGMT_CALLBACK(anjay_relocked, anjay, inst);
-    result = obj->handlers->check_integrity(obj->obj_ctx, inst->iid,
-                                            inst->inst_ctx);
-    LOCK_AFTER_SW_MGMT_CALLBACK(anjay_relocked, inst);
+    if (inst->integrity_verified) {
+        result = inst->integrity_result;
+        inst->integrity_verified = false;
+    } else {
+        assert(obj->handlers->check_integrity);
+        UNLOCK_FOR_SW_MGMT_CALLBACK(anjay_relocked, anjay, inst);
+        result = obj->handlers->check_integrity(obj->obj_ctx, inst->iid,
+                                                inst->inst_ctx);
+        LOCK_AFTER_SW_MGMT_CALLBACK(anjay_relocked, inst);
+    }
 
     if (result) {
         sw_mgmt_log_inst(WARNING, inst->iid,
@@ -446,7 +540,7 @@ static inline void possibly_schedule_integrity_check(anjay_unlocked_t *anjay,
                                                      sw_mgmt_instance_t *inst) {
     assert(inst->internal_state == SW_MGMT_INTERNAL_STATE_DOWNLOADING);
 
-    if (obj->handlers->check_integrity) {
+    if (obj->handlers->check_integrity || inst->integrity_verified) {
         change_internal_state_and_update_result(
                 anjay, inst, SW_MGMT_INTERNAL_STATE_DOWNLOADED,
                 ANJAY_SW_MGMT_UPDATE_RESULT_INITIAL);
@@ -492,6 +586,10 @@ static int package_push_download(anjay_unlocked_t *anjay,
         }
 
         if (bytes_read > 0) {
+            result = call_integrity_update(anjay, obj, inst, buffer,
+                                           bytes_read);
+        }
+        if (!result && bytes_read > 0) {
             result = call_stream_write(anjay, obj, inst, buffer, bytes_read);
         }
         if (result) {
@@ -518,6 +616,7 @@ static int package_push_download(anjay_unlocked_t *anjay,
                              " B written"),
                      written);
 
+    call_integrity_finish(anjay, obj, inst, false);
     possibly_schedule_integrity_check(anjay, obj, inst);
     return 0;
 }
@@ -646,6 +745,54 @@ static inline int pull_download_ensure_stream_opened(anjay_unlocked_t *anjay,
     return 0;
 }
 
+static int pull_download_deferred_write(anjay_unlocked_t *anjay,
+                                        const void *data,
+                                        size_t length,
+                                        void *inst_) {
+    sw_mgmt_object_t *obj =
+            (sw_mgmt_object_t *) _anjay_dm_module_get_arg(anjay,
+                                                          sw_mgmt_delete);
+    return call_stream_write(anjay, obj, (sw_mgmt_instance_t *) inst_, data,
+                             length);
+}
+
+static void pull_download_deferred_write_failed(anjay_unlocked_t *anjay,
+                                                int result,
+                                                void *inst_) {
+    sw_mgmt_instance_t *inst = (sw_mgmt_instance_t *) inst_;
+    sw_mgmt_log_inst(ERROR, inst->iid, _("could not write package"));
+    change_internal_state_and_update_result(anjay, inst,
+                                            SW_MGMT_INTERNAL_STATE_IDLE,
+                                            retval_to_update_result(result));
+    if (inst->pull_download_handle) {
+        // pull_download_on_download_finished() will be called, resetting the
+        // user state and deleting the deferred writer
+        _anjay_download_abort_unlocked(anjay, inst->pull_download_handle);
+    }
+}
+
+static int pull_download_write(anjay_unlocked_t *anjay,
+                               sw_mgmt_object_t *obj,
+                               sw_mgmt_instance_t *inst,
+                               const uint8_t *data,
+                               size_t data_size) {
+    int result = call_integrity_update(anjay, obj, inst, data, data_size);
+    if (result) {
+        return result;
+    }
+    if (obj->deferred_write_queue_size && !inst->pull_download_writer) {
+        inst->pull_download_writer = _anjay_deferred_writer_new(
+                anjay, obj->deferred_write_queue_size,
+                pull_download_deferred_write,
+                pull_download_deferred_write_failed, inst);
+    }
+    if (inst->pull_download_writer) {
+        return _anjay_deferred_writer_write(inst->pull_download_writer, data,
+                                            data_size);
+    }
+    return call_stream_write(anjay, obj, inst, data, data_size);
+}
+
 static avs_error_t pull_download_on_next_block(anjay_t *anjay_locked,
                                                const uint8_t *data,
                                                size_t data_size,
@@ -664,7 +811,7 @@ static avs_error_t pull_download_on_next_block(anjay_t *anjay_locked,
 
     if (!pull_download_ensure_stream_opened(anjay, obj, inst)) {
         if (data_size > 0) {
-            result = call_stream_write(anjay, obj, inst, data, data_size);
+            result = pull_download_write(anjay, obj, inst, data, data_size);
         }
 
         if (result) {
@@ -744,9 +891,25 @@ static void pull_download_on_download_finished(anjay_t *anjay_locked,
 
     inst->pull_download_handle = NULL;
 
+    int write_result = 0;
+    if (inst->pull_download_writer) {
+        if (inst->internal_state == SW_MGMT_INTERNAL_STATE_DOWNLOADING
+                && status.result == ANJAY_DOWNLOAD_FINISHED) {
+            write_result =
+                    _anjay_deferred_writer_flush(inst->pull_download_writer);
+        }
+        _anjay_deferred_writer_delete(&inst->pull_download_writer);
+    }
+
     if (inst->internal_state != SW_MGMT_INTERNAL_STATE_DOWNLOADING) {
         // pull_download_on_next_block() already failed
         call_reset(anjay, obj, inst);
+    } else if (write_result) {
+        sw_mgmt_log_inst(ERROR, inst->iid, _("could not write package"));
+        call_reset(anjay, obj, inst);
+        change_internal_state_and_update_result(
+                anjay, inst, SW_MGMT_INTERNAL_STATE_IDLE,
+                retval_to_update_result(write_result));
     } else if (status.result != ANJAY_DOWNLOAD_FINISHED) {
         call_reset(anjay, obj, inst);
         change_internal_state_and_update_result(
@@ -757,10 +920,12 @@ static void pull_download_on_download_finished(anjay_t *anjay_locked,
         // stream_open should be called anyways
         if (pull_download_ensure_stream_opened(anjay, obj, inst)
                 || call_stream_finish(anjay, obj, inst)) {
+            call_integrity_finish(anjay, obj, inst, true);
             change_internal_state_and_update_result(
                     anjay, inst, SW_MGMT_INTERNAL_STATE_IDLE,
                     ANJAY_SW_MGMT_UPDATE_RESULT_UPDATE_ERROR);
         } else {
+            call_integrity_finish(anjay, obj, inst, false);
             possibly_schedule_integrity_check(anjay, obj, inst);
         }
     }
@@ -910,6 +1075,7 @@ static void clean_up_instance(anjay_unlocked_t *anjay,
     if (anjay) {
         _anjay_download_abort_unlocked(anjay, inst->pull_download_handle);
     }
+    _anjay_deferred_writer_delete(&inst->pull_download_writer);
 #    endif // ANJAY_WITH_DOWNLOADER
 }
 
@@ -1422,6 +1588,10 @@ int anjay_sw_mgmt_install(anjay_t *anjay_locked,
     assert(settings->handlers->pkg_install);
 
     assert(!!settings->handlers->activate == !!settings->handlers->deactivate);
+    assert(!!settings->handlers->integrity_init
+                   == !!settings->handlers->integrity_update
+           && !!settings->handlers->integrity_update
+                      == !!settings->handlers->integrity_finish);
 
     int result = -1;
 
@@ -1438,6 +1608,7 @@ int anjay_sw_mgmt_install(anjay_t *anjay_locked,
 #    if defined(ANJAY_WITH_DOWNLOADER)
         obj->prefer_same_socket_downloads =
                 settings->prefer_same_socket_downloads;
+        obj->deferred_write_queue_size = settings->deferred_write_queue_size;
 #    endif // defined(ANJAY_WITH_DOWNLOADER)
 
         if (!_anjay_dm_module_install(anjay, sw_mgmt_delete, obj)) {
@@ -1641,4 +1812,8 @@ int anjay_sw_mgmt_remove_instance(anjay_t *anjay_locked, anjay_iid_t iid) {
     return result;
 }
 
+#    ifdef ANJAY_TEST
+#        include "tests/modules/sw_mgmt/integrity.c"
+#    endif // ANJAY_TEST
+
 #endif // ANJAY_WITH_MODULE_SW_MGMT
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_stream_inbuf.h>
+#include <avsystem/commons/avs_stream_outbuf.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "src/core/io/anjay_senml_like_encoder.h"
+#include "src/core/io/cbor/anjay_json_like_cbor_decoder.h"
+
+#include "tests/benchmarks/utils.h"
+
+#ifdef ANJAY_WITH_CBOR
+
+#    define CBOR_ENTRY_COUNT 100
+#    define CBOR_ITERATIONS 2000
+#    define CBOR_ENCODE_ITERATIONS 200
+
+static size_t put_header(uint8_t *out, uint8_t major_type, size_t value) {
+    if (value < 24) {
+        out[0] = (uint8_t) ((major_type << 5) | value);
+        return 1;
+    }
+    assert(value <= UINT16_MAX);
+    out[0] = (uint8_t) ((major_type << 5) | 25);
+    out[1] = (uint8_t) (value >> 8);
+    out[2] = (uint8_t) value;
+    return 3;
+}
+
+static size_t put_string(uint8_t *out, const char *str) {
+    size_t len = strlen(str);
+    size_t offset = put_header(out, 3, len);
+    memcpy(out + offset, str, len);
+    return offset + len;
+}
+
+/**
+ * Shaped after a SenML CBOR Write-Composite payload: an array of maps, each
+ * containing a name, a numeric value and a string value.
+ */
+static size_t build_payload(uint8_t *out) {
+    size_t offset = put_header(out, 4, CBOR_ENTRY_COUNT);
+    for (size_t i = 0; i < CBOR_ENTRY_COUNT; ++i) {
+        char name[32];
+        snprintf(name, sizeof(name), "/%d/%u/1", BENCH_OID, (unsigned) i);
+        offset += put_header(out + offset, 5, 3);
+        offset += put_header(out + offset, 0, 0);
+        offset += put_string(out + offset, name);
+        offset += put_header(out + offset, 0, 2);
+        offset += put_header(out + offset, 0, 1000 + i);
+        offset += put_header(out + offset, 0, 3);
+        offset += put_string(out + offset,
+                             "Lorem ipsum dolor sit amet, consectetur");
+    }
+    return offset;
+}
+
+static void decode_value(anjay_json_like_decoder_t *decoder) {
+    anjay_json_like_value_type_t type;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_json_like_decoder_current_value_type(decoder, &type));
+    switch (type) {
+    case ANJAY_JSON_LIKE_VALUE_UINT: {
+        anjay_json_like_number_t number;
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_json_like_decoder_number(decoder, &number));
+        break;
+    }
+    case ANJAY_JSON_LIKE_VALUE_TEXT_STRING: {
+        char buf[64];
+        avs_stream_outbuf_t stream = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+        avs_stream_outbuf_set_buffer(&stream, buf, sizeof(buf));
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_json_like_decoder_bytes(
+                decoder, (avs_stream_t *) &stream));
+        break;
+    }
+    case ANJAY_JSON_LIKE_VALUE_MAP:
+    case ANJAY_JSON_LIKE_VALUE_ARRAY: {
+        size_t level = _anjay_json_like_decoder_nesting_level(decoder);
+        AVS_UNIT_ASSERT_SUCCESS(
+                type == ANJAY_JSON_LIKE_VALUE_MAP
+                        ? _anjay_json_like_decoder_enter_map(decoder)
+                        : _anjay_json_like_decoder_enter_array(decoder));
+        while (_anjay_json_like_decoder_nesting_level(decoder) > level) {
+            decode_value(decoder);
+        }
+        break;
+    }
+    default:
+        AVS_UNIT_ASSERT_TRUE(false);
+    }
+}
+
+static void decode_payload(bool use_buffer) {
+    static uint8_t payload[16384];
+    const size_t payload_size = build_payload(payload);
+    AVS_UNIT_ASSERT_TRUE(payload_size <= sizeof(payload));
+
+    const int64_t start_ns = _anjay_bench_now_ns();
+    for (size_t i = 0; i < CBOR_ITERATIONS; ++i) {
+        avs_stream_inbuf_t stream = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+        anjay_json_like_decoder_t *decoder;
+        if (use_buffer) {
+            decoder = _anjay_cbor_decoder_new_from_buffer(
+                    payload, payload_size, MAX_SENML_CBOR_NEST_STACK_SIZE);
+        } else {
+            avs_stream_inbuf_set_buffer(&stream, payload, payload_size);
+            decoder = _anjay_cbor_decoder_new((avs_stream_t *) &stream,
+                                              MAX_SENML_CBOR_NEST_STACK_SIZE);
+        }
+        AVS_UNIT_ASSERT_NOT_NULL(decoder);
+        decode_value(decoder);
+        AVS_UNIT_ASSERT_EQUAL(_anjay_json_like_decoder_state(decoder),
+                              ANJAY_JSON_LIKE_DECODER_STATE_FINISHED);
+        _anjay_json_like_decoder_delete(&decoder);
+    }
+    const int64_t elapsed_ns = _anjay_bench_now_ns() - start_ns;
+
+    _anjay_bench_report("cbor_decode", use_buffer ? "buffer" : "stream",
+                        CBOR_ITERATIONS, elapsed_ns,
+                        (uint64_t) CBOR_ITERATIONS * payload_size);
+}
+
+AVS_UNIT_TEST(benchmarks, cbor_decode_throughput) {
+    decode_payload(false);
+    decode_payload(true);
+}
+
+/**
+ * Encodes a SenML CBOR payload shaped after a Read-Composite response. If the
+ * number of entries is not passed up front, the encoder caches the whole array
+ * before writing it, which is what dominates its memory usage.
+ */
+static void encode_payload(size_t entry_count, bool known_length) {
+    static char buf[256 * 1024];
+
+    size_t peak_heap = 0;
+    size_t payload_size = 0;
+    const int64_t start_ns = _anjay_bench_now_ns();
+    for (size_t i = 0; i < CBOR_ENCODE_ITERATIONS; ++i) {
+        avs_stream_outbuf_t stream = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+        avs_stream_outbuf_set_buffer(&stream, buf, sizeof(buf));
+        _anjay_bench_heap_reset_peak();
+        anjay_senml_like_encoder_t *encoder = _anjay_senml_cbor_encoder_new(
+                (avs_stream_t *) &stream, known_length ? &entry_count : NULL);
+        AVS_UNIT_ASSERT_NOT_NULL(encoder);
+        for (size_t j = 0; j < entry_count; ++j) {
+            char name[32];
+            snprintf(name, sizeof(name), "/%d/%u/1", BENCH_OID, (unsigned) j);
+            AVS_UNIT_ASSERT_SUCCESS(
+                    _anjay_senml_like_element_begin(encoder, NULL, name, NAN));
+            AVS_UNIT_ASSERT_SUCCESS(_anjay_senml_like_encode_string(
+                    encoder, "Lorem ipsum dolor sit amet, consectetur"));
+            AVS_UNIT_ASSERT_SUCCESS(_anjay_senml_like_element_end(encoder));
+        }
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_senml_like_encoder_cleanup(&encoder));
+        peak_heap = AVS_MAX(peak_heap, _anjay_bench_heap_peak());
+        payload_size = avs_stream_outbuf_offset(&stream);
+    }
+    const int64_t elapsed_ns = _anjay_bench_now_ns() - start_ns;
+
+    char variant[32];
+    snprintf(variant, sizeof(variant), "%s_%u",
+             known_length ? "known_length" : "unknown_length",
+             (unsigned) entry_count);
+    _anjay_bench_report("cbor_encode", variant, CBOR_ENCODE_ITERATIONS,
+                        elapsed_ns,
+                        (uint64_t) CBOR_ENCODE_ITERATIONS * payload_size);
+    _anjay_bench_report_heap("cbor_encode", variant, peak_heap);
+}
+
+AVS_UNIT_TEST(benchmarks, cbor_encode_memory) {
+    static const size_t ENTRY_COUNTS[] = { 10, 100, 1000 };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(ENTRY_COUNTS); ++i) {
+        encode_payload(ENTRY_COUNTS[i], true);
+        encode_payload(ENTRY_COUNTS[i], false);
+    }
+}
+
+#endif // ANJAY_WITH_CBOR
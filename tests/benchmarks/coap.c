@@ -0,0 +1,435 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_prng.h>
+#include <avsystem/commons/avs_sched.h>
+#include <avsystem/commons/avs_shared_buffer.h>
+#include <avsystem/commons/avs_unit_test.h>
+#include <avsystem/commons/avs_utils.h>
+
+#include <avsystem/coap/async.h>
+#include <avsystem/coap/code.h>
+#include <avsystem/coap/udp.h>
+
+#include "tests/benchmarks/utils.h"
+
+#define COAP_BUFFER_SIZE 4096
+/** Large enough to always require more than two BLOCK2 responses. */
+#define COAP_RESPONSE_PAYLOAD_SIZE 4096
+
+static const size_t EXCHANGE_COUNTS[] = { 64, 256, 1024 };
+
+typedef struct {
+    avs_sched_t *sched;
+    avs_crypto_prng_ctx_t *prng;
+    avs_shared_buffer_t *in_buffer;
+    avs_shared_buffer_t *out_buffer;
+    avs_net_socket_t *socket;
+    avs_coap_ctx_t *ctx;
+    size_t responses_received;
+    size_t requests_accepted;
+    void *user_data;
+} coap_bench_t;
+
+/**
+ * Creates a bare CoAP/UDP context (without Anjay) on top of the in-memory
+ * socket. @p nstart is set high enough for all exchanges to be in flight
+ * simultaneously.
+ */
+static void coap_bench_init(coap_bench_t *bench, size_t nstart) {
+    memset(bench, 0, sizeof(*bench));
+    AVS_UNIT_ASSERT_NOT_NULL((bench->sched = avs_sched_new("coap", NULL)));
+    AVS_UNIT_ASSERT_NOT_NULL(
+            (bench->prng = avs_crypto_prng_new(NULL, NULL)));
+    AVS_UNIT_ASSERT_NOT_NULL(
+            (bench->in_buffer = avs_shared_buffer_new(COAP_BUFFER_SIZE)));
+    AVS_UNIT_ASSERT_NOT_NULL(
+            (bench->out_buffer = avs_shared_buffer_new(COAP_BUFFER_SIZE)));
+
+    bench->socket = _anjay_bench_socket_create();
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_connect(bench->socket, "127.0.0.1", "5683"));
+
+    avs_coap_udp_tx_params_t tx_params = AVS_COAP_DEFAULT_UDP_TX_PARAMS;
+    tx_params.nstart = nstart;
+    AVS_UNIT_ASSERT_NOT_NULL(
+            (bench->ctx = avs_coap_udp_ctx_create(
+                     bench->sched, &tx_params, bench->in_buffer,
+                     bench->out_buffer, NULL, bench->prng)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_coap_ctx_set_socket(bench->ctx, bench->socket));
+}
+
+static void coap_bench_finish(coap_bench_t *bench) {
+    avs_coap_ctx_cleanup(&bench->ctx);
+    avs_net_socket_cleanup(&bench->socket);
+    avs_free(bench->in_buffer);
+    avs_free(bench->out_buffer);
+    avs_crypto_prng_free(&bench->prng);
+    avs_sched_cleanup(&bench->sched);
+}
+
+static void coap_bench_handle_packets(
+        coap_bench_t *bench,
+        size_t count,
+        avs_coap_server_new_async_request_handler_t *handler) {
+    for (size_t i = 0; i < count; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(
+                avs_coap_async_handle_incoming_packet(bench->ctx, handler,
+                                                      bench));
+    }
+}
+
+static void report_dispatch(const char *variant,
+                            size_t exchange_count,
+                            int64_t elapsed_ns) {
+    char full_variant[64];
+    snprintf(full_variant, sizeof(full_variant), "%s_%u", variant,
+             (unsigned) exchange_count);
+    _anjay_bench_report("coap_response_dispatch", full_variant,
+                        exchange_count, elapsed_ns, 0);
+}
+
+/***************************************************************************
+ * Client side: responses to many concurrent outgoing requests
+ ***************************************************************************/
+
+static void client_response_handler(
+        avs_coap_ctx_t *ctx,
+        avs_coap_exchange_id_t exchange_id,
+        avs_coap_client_request_state_t result,
+        const avs_coap_client_async_response_t *response,
+        avs_error_t err,
+        void *bench) {
+    (void) ctx;
+    (void) exchange_id;
+    (void) response;
+    (void) err;
+    if (result == AVS_COAP_CLIENT_REQUEST_OK) {
+        ++((coap_bench_t *) bench)->responses_received;
+    }
+}
+
+static void client_dispatch(size_t exchange_count) {
+    coap_bench_t bench;
+    coap_bench_init(&bench, exchange_count);
+
+    uint64_t *tokens = (uint64_t *) avs_calloc(exchange_count, sizeof(*tokens));
+    AVS_UNIT_ASSERT_NOT_NULL(tokens);
+    for (size_t i = 0; i < exchange_count; ++i) {
+        const avs_coap_request_header_t request = {
+            .code = AVS_COAP_CODE_GET
+        };
+        avs_coap_exchange_id_t exchange_id;
+        AVS_UNIT_ASSERT_SUCCESS(avs_coap_client_send_async_request(
+                bench.ctx, &exchange_id, &request, NULL, NULL,
+                client_response_handler, &bench));
+        avs_sched_run(bench.sched);
+
+        anjay_bench_coap_msg_t sent;
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_bench_socket_last_sent(bench.socket, &sent));
+        AVS_UNIT_ASSERT_EQUAL(sent.code, AVS_COAP_CODE_GET);
+        tokens[i] = sent.token;
+    }
+    AVS_UNIT_ASSERT_EQUAL(_anjay_bench_socket_packets_sent(bench.socket),
+                          exchange_count);
+
+    // The socket acknowledged every request with an Empty ACK - these are
+    // matched by message ID
+    int64_t start_ns = _anjay_bench_now_ns();
+    coap_bench_handle_packets(&bench, exchange_count, NULL);
+    report_dispatch("udp_separate_ack", exchange_count,
+                    _anjay_bench_now_ns() - start_ns);
+
+    // Separate responses, matched by token; the most recently sent request is
+    // answered first, which is the worst case for a linear search
+    for (size_t i = exchange_count; i-- > 0;) {
+        anjay_bench_coap_msg_t response = ANJAY_BENCH_COAP_MSG_EMPTY;
+        response.type = 1; // NON
+        response.code = AVS_COAP_CODE_CONTENT;
+        response.msg_id = (uint16_t) (0x8000 + i);
+        response.token = tokens[i];
+        _anjay_bench_socket_push(bench.socket, &response);
+    }
+    start_ns = _anjay_bench_now_ns();
+    coap_bench_handle_packets(&bench, exchange_count, NULL);
+    report_dispatch("udp_separate_response", exchange_count,
+                    _anjay_bench_now_ns() - start_ns);
+    AVS_UNIT_ASSERT_EQUAL(bench.responses_received, exchange_count);
+
+    avs_free(tokens);
+    coap_bench_finish(&bench);
+}
+
+AVS_UNIT_TEST(benchmarks, coap_client_response_dispatch) {
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(EXCHANGE_COUNTS); ++i) {
+        client_dispatch(EXCHANGE_COUNTS[i]);
+    }
+}
+
+/***************************************************************************
+ * Server side: continuations of many concurrent BLOCK2 responses
+ ***************************************************************************/
+
+static int server_payload_writer(size_t payload_offset,
+                                 void *payload_buf,
+                                 size_t payload_buf_size,
+                                 size_t *out_payload_chunk_size,
+                                 void *arg) {
+    (void) arg;
+    *out_payload_chunk_size = AVS_MIN(
+            payload_buf_size, COAP_RESPONSE_PAYLOAD_SIZE - payload_offset);
+    memset(payload_buf, 0, *out_payload_chunk_size);
+    return 0;
+}
+
+static int
+server_request_handler(avs_coap_request_ctx_t *ctx,
+                       avs_coap_exchange_id_t request_id,
+                       avs_coap_server_request_state_t state,
+                       const avs_coap_server_async_request_t *request,
+                       const avs_coap_observe_id_t *observe_id,
+                       void *arg) {
+    (void) request_id;
+    (void) request;
+    (void) observe_id;
+    (void) arg;
+    if (state != AVS_COAP_SERVER_REQUEST_RECEIVED) {
+        return 0;
+    }
+    const avs_coap_response_header_t response = {
+        .code = AVS_COAP_CODE_CONTENT
+    };
+    AVS_UNIT_ASSERT_SUCCESS(avs_coap_server_setup_async_response(
+            ctx, &response, server_payload_writer, NULL));
+    return 0;
+}
+
+static int server_new_request_handler(avs_coap_server_ctx_t *ctx,
+                                      const avs_coap_request_header_t *request,
+                                      void *bench) {
+    (void) request;
+    ++((coap_bench_t *) bench)->requests_accepted;
+    return avs_coap_exchange_id_valid(avs_coap_server_accept_async_request(
+                   ctx, server_request_handler, NULL))
+                   ? 0
+                   : AVS_COAP_CODE_INTERNAL_SERVER_ERROR;
+}
+
+static anjay_bench_coap_msg_t
+server_request(size_t index, char *path_buf, size_t path_buf_size) {
+    anjay_bench_coap_msg_t request = ANJAY_BENCH_COAP_MSG_EMPTY;
+    snprintf(path_buf, path_buf_size, "bench/%u", (unsigned) index);
+    request.type = 1; // NON
+    request.code = AVS_COAP_CODE_GET;
+    request.uri_path = path_buf;
+    return request;
+}
+
+static void server_dispatch(size_t exchange_count) {
+    coap_bench_t bench;
+    coap_bench_init(&bench, 1);
+
+    int64_t *block2 = (int64_t *) avs_calloc(exchange_count, sizeof(*block2));
+    AVS_UNIT_ASSERT_NOT_NULL(block2);
+    for (size_t i = 0; i < exchange_count; ++i) {
+        char path[32];
+        anjay_bench_coap_msg_t request = server_request(i, path, sizeof(path));
+        request.msg_id = (uint16_t) i;
+        request.token = i + 1;
+        _anjay_bench_socket_push(bench.socket, &request);
+        coap_bench_handle_packets(&bench, 1, server_new_request_handler);
+
+        anjay_bench_coap_msg_t sent;
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_bench_socket_last_sent(bench.socket, &sent));
+        AVS_UNIT_ASSERT_EQUAL(sent.code, AVS_COAP_CODE_CONTENT);
+        AVS_UNIT_ASSERT_TRUE(sent.block2 >= 0);
+        AVS_UNIT_ASSERT_TRUE(ANJAY_BENCH_BLOCK_MORE(sent.block2));
+        block2[i] = sent.block2;
+    }
+
+    // Request the second block of every response, in reverse order; each of
+    // these has to be matched to an existing exchange
+    for (size_t i = exchange_count; i-- > 0;) {
+        char path[32];
+        anjay_bench_coap_msg_t request = server_request(i, path, sizeof(path));
+        request.msg_id = (uint16_t) (exchange_count + i);
+        request.token = exchange_count + i + 1;
+        request.block2 = (int64_t) ((ANJAY_BENCH_BLOCK_NUM(block2[i]) + 1) << 4
+                                    | (block2[i] & 0x07));
+        _anjay_bench_socket_push(bench.socket, &request);
+    }
+    int64_t start_ns = _anjay_bench_now_ns();
+    coap_bench_handle_packets(&bench, exchange_count,
+                              server_new_request_handler);
+    report_dispatch("udp_block2_continuation", exchange_count,
+                    _anjay_bench_now_ns() - start_ns);
+    // no continuation was treated as a new request
+    AVS_UNIT_ASSERT_EQUAL(bench.requests_accepted, exchange_count);
+
+    avs_free(block2);
+    coap_bench_finish(&bench);
+}
+
+AVS_UNIT_TEST(benchmarks, coap_server_response_dispatch) {
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(EXCHANGE_COUNTS); ++i) {
+        server_dispatch(EXCHANGE_COUNTS[i]);
+    }
+}
+
+/***************************************************************************
+ * Option lookups in incoming requests
+ ***************************************************************************/
+
+#define OPTION_LOOKUP_REQUESTS 10000
+/** Number of times each request is inspected, as different layers do. */
+#define OPTION_LOOKUP_REPEATS 8
+
+typedef struct {
+    int64_t lookup_ns;
+    size_t lookups;
+} option_lookup_state_t;
+
+static void lookup_request_options(const avs_coap_options_t *options) {
+    uint16_t u16;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_coap_options_get_content_format(options, &u16));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_coap_options_get_u16(options, AVS_COAP_OPTION_ACCEPT, &u16));
+#ifdef WITH_AVS_COAP_OBSERVE
+    uint32_t observe;
+    AVS_UNIT_ASSERT_SUCCESS(avs_coap_options_get_observe(options, &observe));
+#endif // WITH_AVS_COAP_OBSERVE
+#ifdef WITH_AVS_COAP_BLOCK
+    avs_coap_option_block_t block;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_coap_options_get_block(options, AVS_COAP_BLOCK2, &block));
+    AVS_UNIT_ASSERT_EQUAL(
+            avs_coap_options_get_block(options, AVS_COAP_BLOCK1, &block),
+            AVS_COAP_OPTION_MISSING);
+#endif // WITH_AVS_COAP_BLOCK
+
+    avs_coap_option_iterator_t it = AVS_COAP_OPTION_ITERATOR_EMPTY;
+    char segment[16];
+    size_t segment_size;
+    size_t segments = 0;
+    while (!avs_coap_options_get_string_it(options, AVS_COAP_OPTION_URI_PATH,
+                                           &it, &segment_size, segment,
+                                           sizeof(segment))) {
+        ++segments;
+    }
+    AVS_UNIT_ASSERT_EQUAL(segments, 4);
+}
+
+static void time_option_lookups(option_lookup_state_t *state,
+                                const avs_coap_options_t *options) {
+    const int64_t start_ns = _anjay_bench_now_ns();
+    for (size_t i = 0; i < OPTION_LOOKUP_REPEATS; ++i) {
+        lookup_request_options(options);
+    }
+    state->lookup_ns += _anjay_bench_now_ns() - start_ns;
+    state->lookups += OPTION_LOOKUP_REPEATS;
+}
+
+static int option_lookup_request_handler(
+        avs_coap_server_ctx_t *ctx,
+        const avs_coap_request_header_t *request,
+        void *bench) {
+    (void) ctx;
+    time_option_lookups(
+            (option_lookup_state_t *) ((coap_bench_t *) bench)->user_data,
+            &request->options);
+    // not creating an exchange keeps the request path short
+    return AVS_COAP_CODE_NOT_FOUND;
+}
+
+static anjay_bench_coap_msg_t option_lookup_request(void) {
+    anjay_bench_coap_msg_t request = ANJAY_BENCH_COAP_MSG_EMPTY;
+    request.type = 1; // NON
+    request.code = AVS_COAP_CODE_GET;
+    request.uri_path = "42/7/3/1";
+    request.observe = 0;
+    request.content_format = 11543; // LwM2M JSON
+    request.accept = 11543;
+    request.block2 = ANJAY_BENCH_BLOCK_VALUE(0, false);
+    return request;
+}
+
+/**
+ * The same options as in option_lookup_request(), but constructed locally,
+ * i.e. without the lookup index built while parsing a message.
+ */
+static avs_coap_options_t built_request_options(void *buffer, size_t size) {
+    avs_coap_options_t options = avs_coap_options_create_empty(buffer, size);
+#ifdef WITH_AVS_COAP_OBSERVE
+    AVS_UNIT_ASSERT_SUCCESS(avs_coap_options_add_observe(&options, 0));
+#endif // WITH_AVS_COAP_OBSERVE
+    static const char *const SEGMENTS[] = { "42", "7", "3", "1" };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(SEGMENTS); ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(avs_coap_options_add_string(
+                &options, AVS_COAP_OPTION_URI_PATH, SEGMENTS[i]));
+    }
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_coap_options_set_content_format(&options, 11543));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_coap_options_add_u16(&options, AVS_COAP_OPTION_ACCEPT, 11543));
+#ifdef WITH_AVS_COAP_BLOCK
+    const avs_coap_option_block_t block2 = {
+        .type = AVS_COAP_BLOCK2,
+        .seq_num = 0,
+        .has_more = false,
+        .size = 1024
+    };
+    AVS_UNIT_ASSERT_SUCCESS(avs_coap_options_add_block(&options, &block2));
+#endif // WITH_AVS_COAP_BLOCK
+    return options;
+}
+
+AVS_UNIT_TEST(benchmarks, coap_option_lookup) {
+    coap_bench_t bench;
+    coap_bench_init(&bench, 1);
+    option_lookup_state_t state = { 0 };
+    bench.user_data = &state;
+
+    const anjay_bench_coap_msg_t request = option_lookup_request();
+    int64_t handle_ns = 0;
+    for (size_t i = 0; i < OPTION_LOOKUP_REQUESTS; ++i) {
+        anjay_bench_coap_msg_t msg = request;
+        msg.msg_id = (uint16_t) i;
+        msg.token = i + 1;
+        _anjay_bench_socket_push(bench.socket, &msg);
+        const int64_t start_ns = _anjay_bench_now_ns();
+        coap_bench_handle_packets(&bench, 1, option_lookup_request_handler);
+        handle_ns += _anjay_bench_now_ns() - start_ns;
+    }
+    _anjay_bench_report("coap_option_lookup", "parsed", state.lookups,
+                        state.lookup_ns, 0);
+    _anjay_bench_report("coap_option_lookup", "parsed_request_total",
+                        OPTION_LOOKUP_REQUESTS, handle_ns, 0);
+
+    char buffer[128];
+    const avs_coap_options_t options =
+            built_request_options(buffer, sizeof(buffer));
+    state = (option_lookup_state_t) { 0 };
+    for (size_t i = 0; i < OPTION_LOOKUP_REQUESTS; ++i) {
+        time_option_lookups(&state, &options);
+    }
+    _anjay_bench_report("coap_option_lookup", "unindexed", state.lookups,
+                        state.lookup_ns, 0);
+
+    coap_bench_finish(&bench);
+}
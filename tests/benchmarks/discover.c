@@ -0,0 +1,75 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include <avsystem/coap/code.h>
+#include <avsystem/coap/option.h>
+
+#include <anjay/core.h>
+
+#include "tests/benchmarks/utils.h"
+
+#ifdef ANJAY_WITH_DISCOVER
+
+#    define DISCOVER_INSTANCE_COUNT 1250
+#    define DISCOVER_ITERATIONS 20
+
+static void discover_object(bool invalidate) {
+    anjay_bench_t bench;
+    _anjay_bench_init(&bench, DISCOVER_INSTANCE_COUNT, 0);
+
+    char path[8];
+    snprintf(path, sizeof(path), "%d", BENCH_OID);
+    anjay_bench_coap_msg_t msg = ANJAY_BENCH_COAP_MSG_EMPTY;
+    msg.code = AVS_COAP_CODE_GET;
+    msg.uri_path = path;
+    msg.accept = AVS_COAP_FORMAT_LINK_FORMAT;
+
+    uint64_t bytes = 0;
+    int64_t elapsed_ns = 0;
+    for (size_t i = 0; i < DISCOVER_ITERATIONS; ++i) {
+        if (invalidate) {
+            AVS_UNIT_ASSERT_SUCCESS(
+                    anjay_notify_instances_changed(bench.anjay, BENCH_OID));
+            _anjay_bench_run_until_idle(&bench);
+        }
+        size_t payload_size;
+        const int64_t start_ns = _anjay_bench_now_ns();
+        AVS_UNIT_ASSERT_EQUAL(_anjay_bench_request(&bench, &msg, &payload_size),
+                              AVS_COAP_CODE_CONTENT);
+        elapsed_ns += _anjay_bench_now_ns() - start_ns;
+        bytes += payload_size;
+    }
+
+    const char *variant = "invalidated";
+    if (!invalidate) {
+#    ifdef ANJAY_WITH_DISCOVER_CACHE
+        variant = "cached";
+#    else  // ANJAY_WITH_DISCOVER_CACHE
+        variant = "uncached";
+#    endif // ANJAY_WITH_DISCOVER_CACHE
+    }
+    _anjay_bench_report("discover_object", variant, DISCOVER_ITERATIONS,
+                        elapsed_ns, bytes);
+
+    _anjay_bench_finish(&bench);
+}
+
+AVS_UNIT_TEST(benchmarks, discover_large_object) {
+    discover_object(false);
+    discover_object(true);
+}
+
+#endif // ANJAY_WITH_DISCOVER
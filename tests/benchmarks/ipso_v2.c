@@ -0,0 +1,127 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include <avsystem/coap/code.h>
+
+#include <anjay/ipso_objects_v2.h>
+
+#include "tests/benchmarks/utils.h"
+
+#if defined(ANJAY_WITH_MODULE_IPSO_OBJECTS_V2) && defined(ANJAY_WITH_OBSERVE)
+
+#    define SENSOR_OID 3303
+#    define SENSOR_VALUE_RID 5700
+#    define SENSOR_COUNT 1000
+#    define ROUND_COUNT 100
+
+static void install_sensors(anjay_bench_t *bench) {
+    const anjay_ipso_v2_basic_sensor_meta_t meta = {
+        .unit = "Cel",
+        .min_max_measured_value_present = true,
+        .min_range_value = NAN,
+        .max_range_value = NAN
+    };
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_install(
+            bench->anjay, SENSOR_OID, NULL, SENSOR_COUNT));
+    for (anjay_iid_t iid = 0; iid < SENSOR_COUNT; ++iid) {
+        AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+                bench->anjay, SENSOR_OID, iid, 0.0, &meta));
+    }
+
+    for (anjay_iid_t iid = 0; iid < SENSOR_COUNT; ++iid) {
+        char path[32];
+        snprintf(path, sizeof(path), "%d/%" PRIu16 "/%d", SENSOR_OID, iid,
+                 SENSOR_VALUE_RID);
+        anjay_bench_coap_msg_t msg = ANJAY_BENCH_COAP_MSG_EMPTY;
+        msg.code = AVS_COAP_CODE_GET;
+        msg.uri_path = path;
+        msg.observe = 0;
+        AVS_UNIT_ASSERT_EQUAL(_anjay_bench_request(bench, &msg, NULL),
+                              AVS_COAP_CODE_CONTENT);
+    }
+}
+
+static double round_value(size_t round, anjay_iid_t iid) {
+    return (double) (round * SENSOR_COUNT + iid);
+}
+
+static void report_rounds(anjay_bench_t *bench,
+                          const char *variant,
+                          int64_t update_ns,
+                          int64_t total_ns,
+                          size_t packets_before) {
+    const size_t notifications =
+            _anjay_bench_socket_packets_sent(bench->socket) - packets_before;
+    AVS_UNIT_ASSERT_EQUAL(notifications, (size_t) SENSOR_COUNT * ROUND_COUNT);
+
+    char update_variant[64];
+    snprintf(update_variant, sizeof(update_variant), "%s_update", variant);
+    _anjay_bench_report("ipso_v2_sensor_update", update_variant,
+                        (size_t) SENSOR_COUNT * ROUND_COUNT, update_ns, 0);
+    _anjay_bench_report("ipso_v2_sensor_update", variant,
+                        (size_t) SENSOR_COUNT * ROUND_COUNT, total_ns, 0);
+}
+
+AVS_UNIT_TEST(benchmarks, ipso_v2_sensor_update) {
+    anjay_bench_t bench;
+    _anjay_bench_init(&bench, 0, 0);
+    install_sensors(&bench);
+
+    size_t packets_before = _anjay_bench_socket_packets_sent(bench.socket);
+    int64_t update_ns = 0;
+    int64_t start_ns = _anjay_bench_now_ns();
+    for (size_t round = 1; round <= ROUND_COUNT; ++round) {
+        int64_t update_start_ns = _anjay_bench_now_ns();
+        for (anjay_iid_t iid = 0; iid < SENSOR_COUNT; ++iid) {
+            AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_value_update(
+                    bench.anjay, SENSOR_OID, iid, round_value(round, iid)));
+        }
+        update_ns += _anjay_bench_now_ns() - update_start_ns;
+        _anjay_bench_run_until_idle(&bench);
+    }
+    report_rounds(&bench, "per_instance", update_ns,
+                  _anjay_bench_now_ns() - start_ns, packets_before);
+
+    anjay_ipso_v2_basic_sensor_value_entry_t *entries =
+            (anjay_ipso_v2_basic_sensor_value_entry_t *) avs_calloc(
+                    SENSOR_COUNT, sizeof(*entries));
+    AVS_UNIT_ASSERT_NOT_NULL(entries);
+
+    packets_before = _anjay_bench_socket_packets_sent(bench.socket);
+    update_ns = 0;
+    start_ns = _anjay_bench_now_ns();
+    for (size_t round = ROUND_COUNT + 1; round <= 2 * ROUND_COUNT; ++round) {
+        int64_t update_start_ns = _anjay_bench_now_ns();
+        for (anjay_iid_t iid = 0; iid < SENSOR_COUNT; ++iid) {
+            entries[iid].iid = iid;
+            entries[iid].value = round_value(round, iid);
+        }
+        AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_values_update(
+                bench.anjay, SENSOR_OID, entries, SENSOR_COUNT));
+        update_ns += _anjay_bench_now_ns() - update_start_ns;
+        _anjay_bench_run_until_idle(&bench);
+    }
+    report_rounds(&bench, "batch", update_ns, _anjay_bench_now_ns() - start_ns,
+                  packets_before);
+
+    avs_free(entries);
+    _anjay_bench_finish(&bench);
+}
+
+#endif // defined(ANJAY_WITH_MODULE_IPSO_OBJECTS_V2) &&
+       // defined(ANJAY_WITH_OBSERVE)
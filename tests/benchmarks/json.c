@@ -0,0 +1,114 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_stream_inbuf.h>
+#include <avsystem/commons/avs_stream_outbuf.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "src/core/io/json/anjay_json_decoder.h"
+
+#include "tests/benchmarks/utils.h"
+
+#ifdef ANJAY_WITH_SENML_JSON
+
+#    define JSON_ENTRY_COUNT 100
+#    define JSON_ITERATIONS 2000
+
+/**
+ * Shaped after a SenML JSON Write-Composite payload: an array of maps, each
+ * containing a name, a numeric value and a string value.
+ */
+static size_t build_payload(char *out, size_t out_size, const char *vs) {
+    size_t offset = 0;
+    for (size_t i = 0; i < JSON_ENTRY_COUNT; ++i) {
+        int result = snprintf(out + offset, out_size - offset,
+                              "%s{\"n\":\"/%d/%u/1\",\"v\":%u,\"vs\":\"%s\"}",
+                              i ? "," : "[", BENCH_OID, (unsigned) i,
+                              (unsigned) (1000 + i), vs);
+        AVS_UNIT_ASSERT_TRUE(result > 0
+                             && (size_t) result < out_size - offset);
+        offset += (size_t) result;
+    }
+    AVS_UNIT_ASSERT_TRUE(offset + 1 < out_size);
+    out[offset++] = ']';
+    return offset;
+}
+
+static void decode_value(anjay_json_like_decoder_t *decoder) {
+    anjay_json_like_value_type_t type;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_json_like_decoder_current_value_type(decoder, &type));
+    switch (type) {
+    case ANJAY_JSON_LIKE_VALUE_DOUBLE: {
+        anjay_json_like_number_t number;
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_json_like_decoder_number(decoder, &number));
+        break;
+    }
+    case ANJAY_JSON_LIKE_VALUE_TEXT_STRING: {
+        char buf[128];
+        avs_stream_outbuf_t stream = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+        avs_stream_outbuf_set_buffer(&stream, buf, sizeof(buf));
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_json_like_decoder_bytes(
+                decoder, (avs_stream_t *) &stream));
+        break;
+    }
+    case ANJAY_JSON_LIKE_VALUE_MAP:
+    case ANJAY_JSON_LIKE_VALUE_ARRAY: {
+        size_t level = _anjay_json_like_decoder_nesting_level(decoder);
+        AVS_UNIT_ASSERT_SUCCESS(
+                type == ANJAY_JSON_LIKE_VALUE_MAP
+                        ? _anjay_json_like_decoder_enter_map(decoder)
+                        : _anjay_json_like_decoder_enter_array(decoder));
+        while (_anjay_json_like_decoder_nesting_level(decoder) > level) {
+            decode_value(decoder);
+        }
+        break;
+    }
+    default:
+        AVS_UNIT_ASSERT_TRUE(false);
+    }
+}
+
+static void decode_payload(const char *variant, const char *vs) {
+    static char payload[16384];
+    const size_t payload_size = build_payload(payload, sizeof(payload), vs);
+
+    const int64_t start_ns = _anjay_bench_now_ns();
+    for (size_t i = 0; i < JSON_ITERATIONS; ++i) {
+        avs_stream_inbuf_t stream = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+        avs_stream_inbuf_set_buffer(&stream, payload, payload_size);
+        anjay_json_like_decoder_t *decoder =
+                _anjay_json_decoder_new((avs_stream_t *) &stream);
+        AVS_UNIT_ASSERT_NOT_NULL(decoder);
+        decode_value(decoder);
+        AVS_UNIT_ASSERT_EQUAL(_anjay_json_like_decoder_state(decoder),
+                              ANJAY_JSON_LIKE_DECODER_STATE_FINISHED);
+        _anjay_json_like_decoder_delete(&decoder);
+    }
+    const int64_t elapsed_ns = _anjay_bench_now_ns() - start_ns;
+
+    _anjay_bench_report("json_decode", variant, JSON_ITERATIONS, elapsed_ns,
+                        (uint64_t) JSON_ITERATIONS * payload_size);
+}
+
+AVS_UNIT_TEST(benchmarks, json_decode_throughput) {
+    decode_payload("plain_strings",
+                   "Lorem ipsum dolor sit amet, consectetur adipiscing elit");
+    decode_payload("escaped_strings",
+                   "Lorem \\\"ipsum\\\" dolor\\tsit amet,\\nconsectetur "
+                   "adipiscing \\u00e9lit");
+}
+
+#endif // ANJAY_WITH_SENML_JSON
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include <anjay/deferred_log.h>
+
+#include <anjay_modules/anjay_utils_core.h>
+
+#include "tests/benchmarks/utils.h"
+
+#if defined(AVS_COMMONS_WITH_AVS_LOG) && defined(ANJAY_WITH_LOGS)
+
+#    define LOG_MESSAGE_COUNT 100000
+
+static void discarding_log_handler(avs_log_level_t level,
+                                   const char *module,
+                                   const char *message) {
+    (void) level;
+    if (strcmp(module, "bench_log") != 0) {
+        fprintf(stderr, "%s\n", message);
+    }
+}
+
+// shaped after the typical DEBUG messages logged for each notification
+static void log_message(uint32_t i) {
+    _anjay_log(bench_log, DEBUG,
+               _("notify ") "%s" _(" for SSID ") "%u" _(", path /") "%u/%u/%u"
+               _(", value ") "%" PRId64 _(", seq ") "%" PRIu32,
+               (i % 2) ? "confirmable" : "non-confirmable", 1u,
+               (unsigned) BENCH_OID, (unsigned) (i % 1000), 0u,
+               (int64_t) i * 7, i);
+}
+
+#    ifdef ANJAY_WITH_DEFERRED_LOGS
+#        define LOG_BATCH_SIZE ANJAY_DEFERRED_LOG_BUFFER_ENTRIES
+#    else // ANJAY_WITH_DEFERRED_LOGS
+#        define LOG_BATCH_SIZE 128
+#    endif // ANJAY_WITH_DEFERRED_LOGS
+
+AVS_UNIT_TEST(benchmarks, log_debug_throughput) {
+    avs_log_set_handler(discarding_log_handler);
+    avs_log_set_level(bench_log, AVS_LOG_DEBUG);
+    anjay_deferred_log_flush();
+
+    int64_t call_site_ns = 0;
+    int64_t flush_ns = 0;
+    size_t flushed = 0;
+    for (uint32_t i = 0; i < LOG_MESSAGE_COUNT; i += LOG_BATCH_SIZE) {
+        int64_t start_ns = _anjay_bench_now_ns();
+        for (uint32_t j = i; j < i + LOG_BATCH_SIZE && j < LOG_MESSAGE_COUNT;
+             ++j) {
+            log_message(j);
+        }
+        int64_t flush_start_ns = _anjay_bench_now_ns();
+        flushed += anjay_deferred_log_flush();
+        int64_t end_ns = _anjay_bench_now_ns();
+        call_site_ns += flush_start_ns - start_ns;
+        flush_ns += end_ns - flush_start_ns;
+    }
+
+#    ifdef ANJAY_WITH_DEFERRED_LOGS
+    AVS_UNIT_ASSERT_EQUAL(flushed, LOG_MESSAGE_COUNT);
+    _anjay_bench_report("log_debug_throughput", "deferred_call_site",
+                        LOG_MESSAGE_COUNT, call_site_ns, 0);
+    _anjay_bench_report("log_debug_throughput", "deferred_flush",
+                        LOG_MESSAGE_COUNT, flush_ns, 0);
+#    else  // ANJAY_WITH_DEFERRED_LOGS
+    AVS_UNIT_ASSERT_EQUAL(flushed, 0);
+    _anjay_bench_report("log_debug_throughput", "synchronous",
+                        LOG_MESSAGE_COUNT, call_site_ns + flush_ns, 0);
+#    endif // ANJAY_WITH_DEFERRED_LOGS
+
+    avs_log_set_level(bench_log, AVS_LOG_QUIET);
+}
+
+#endif // defined(AVS_COMMONS_WITH_AVS_LOG) && defined(ANJAY_WITH_LOGS)
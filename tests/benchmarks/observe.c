@@ -0,0 +1,179 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#ifdef ANJAY_WITH_THREAD_SAFETY
+#    include <pthread.h>
+#endif // ANJAY_WITH_THREAD_SAFETY
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include <avsystem/coap/code.h>
+
+#include <anjay/core.h>
+#include <anjay/stats.h>
+
+#include "tests/benchmarks/utils.h"
+
+#ifdef ANJAY_WITH_OBSERVE
+
+#    define OBSERVATION_COUNT 10000
+#    define STORM_COUNT 10
+
+static void observe_all(anjay_bench_t *bench, anjay_iid_t count) {
+    for (anjay_iid_t iid = 0; iid < count; ++iid) {
+        char path[32];
+        snprintf(path, sizeof(path), "%d/%" PRIu16 "/0", BENCH_OID, iid);
+        anjay_bench_coap_msg_t msg = ANJAY_BENCH_COAP_MSG_EMPTY;
+        msg.code = AVS_COAP_CODE_GET;
+        msg.uri_path = path;
+        msg.observe = 0;
+        AVS_UNIT_ASSERT_EQUAL(_anjay_bench_request(bench, &msg, NULL),
+                              AVS_COAP_CODE_CONTENT);
+    }
+}
+
+static void notify_storm(anjay_bench_t *bench, anjay_iid_t count) {
+    _anjay_bench_touch_values();
+    for (anjay_iid_t iid = 0; iid < count; ++iid) {
+        AVS_UNIT_ASSERT_SUCCESS(
+                anjay_notify_changed(bench->anjay, BENCH_OID, iid, 0));
+    }
+    _anjay_bench_run_until_idle(bench);
+}
+
+AVS_UNIT_TEST(benchmarks, observe_notify_storm) {
+    anjay_bench_t bench;
+    _anjay_bench_init(&bench, OBSERVATION_COUNT, 0);
+
+    int64_t start_ns = _anjay_bench_now_ns();
+    observe_all(&bench, OBSERVATION_COUNT);
+    _anjay_bench_report("observe", "register", OBSERVATION_COUNT,
+                        _anjay_bench_now_ns() - start_ns, 0);
+
+    const size_t packets_before =
+            _anjay_bench_socket_packets_sent(bench.socket);
+    start_ns = _anjay_bench_now_ns();
+    for (size_t i = 0; i < STORM_COUNT; ++i) {
+        notify_storm(&bench, OBSERVATION_COUNT);
+    }
+    const int64_t elapsed_ns = _anjay_bench_now_ns() - start_ns;
+    const size_t notifications =
+            _anjay_bench_socket_packets_sent(bench.socket) - packets_before;
+    AVS_UNIT_ASSERT_EQUAL(notifications,
+                          (size_t) OBSERVATION_COUNT * STORM_COUNT);
+    _anjay_bench_report("observe", "notify_storm", notifications, elapsed_ns,
+                        0);
+
+    _anjay_bench_finish(&bench);
+}
+
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+#        define UNLOCK_ITERATIONS 100000
+
+#        ifdef ANJAY_WITH_LOCK_FREE_QUERIES
+static const char QUERY_VARIANT[] = "lock_free";
+#        else  // ANJAY_WITH_LOCK_FREE_QUERIES
+static const char QUERY_VARIANT[] = "locked";
+#        endif // ANJAY_WITH_LOCK_FREE_QUERIES
+
+/**
+ * Measures the cost of a single mutex lock/unlock cycle. Per-SSID queries
+ * always lock the mutex, but as they do not change any state, the query
+ * snapshot is not gathered again when lock-free queries are enabled.
+ */
+AVS_UNIT_TEST(benchmarks, mutex_unlock_overhead) {
+    anjay_bench_t bench;
+    _anjay_bench_init(&bench, OBSERVATION_COUNT, 0);
+    observe_all(&bench, OBSERVATION_COUNT);
+
+    const int64_t start_ns = _anjay_bench_now_ns();
+    for (size_t i = 0; i < UNLOCK_ITERATIONS; ++i) {
+        (void) anjay_has_unsent_notifications(bench.anjay, 1);
+    }
+    _anjay_bench_report("mutex_unlock", QUERY_VARIANT, UNLOCK_ITERATIONS,
+                        _anjay_bench_now_ns() - start_ns, 0);
+
+    _anjay_bench_finish(&bench);
+}
+
+typedef struct {
+    anjay_t *anjay;
+    pthread_mutex_t mutex;
+    bool finished;
+    size_t queries;
+    int64_t total_ns;
+    int64_t max_ns;
+} query_thread_state_t;
+
+// NOTE: AVS_UNIT_ASSERT_* may only be used in the main thread
+static bool query_thread_finished(query_thread_state_t *state) {
+    pthread_mutex_lock(&state->mutex);
+    bool result = state->finished;
+    pthread_mutex_unlock(&state->mutex);
+    return result;
+}
+
+static void *query_thread(void *state_) {
+    query_thread_state_t *state = (query_thread_state_t *) state_;
+    while (!query_thread_finished(state)) {
+        const int64_t start_ns = _anjay_bench_now_ns();
+        (void) anjay_has_unsent_notifications(state->anjay, ANJAY_SSID_ANY);
+#        ifdef ANJAY_WITH_NET_STATS
+        (void) anjay_get_tx_bytes(state->anjay);
+#        endif // ANJAY_WITH_NET_STATS
+        const int64_t elapsed_ns = _anjay_bench_now_ns() - start_ns;
+        ++state->queries;
+        state->total_ns += elapsed_ns;
+        if (elapsed_ns > state->max_ns) {
+            state->max_ns = elapsed_ns;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Measures latency of read-only queries performed from another thread while
+ * the main thread is busy sending notifications.
+ */
+AVS_UNIT_TEST(benchmarks, query_latency_during_notify_storm) {
+    anjay_bench_t bench;
+    _anjay_bench_init(&bench, OBSERVATION_COUNT, 0);
+    observe_all(&bench, OBSERVATION_COUNT);
+
+    query_thread_state_t state = {
+        .anjay = bench.anjay
+    };
+    AVS_UNIT_ASSERT_SUCCESS(pthread_mutex_init(&state.mutex, NULL));
+    pthread_t thread;
+    AVS_UNIT_ASSERT_SUCCESS(
+            pthread_create(&thread, NULL, query_thread, &state));
+    for (size_t i = 0; i < STORM_COUNT; ++i) {
+        notify_storm(&bench, OBSERVATION_COUNT);
+    }
+    AVS_UNIT_ASSERT_SUCCESS(pthread_mutex_lock(&state.mutex));
+    state.finished = true;
+    AVS_UNIT_ASSERT_SUCCESS(pthread_mutex_unlock(&state.mutex));
+    AVS_UNIT_ASSERT_SUCCESS(pthread_join(thread, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(pthread_mutex_destroy(&state.mutex));
+
+    _anjay_bench_report("query_latency", QUERY_VARIANT, state.queries,
+                        state.total_ns, 0);
+    _anjay_bench_report("query_latency_max", QUERY_VARIANT, 1, state.max_ns,
+                        0);
+
+    _anjay_bench_finish(&bench);
+}
+#    endif // ANJAY_WITH_THREAD_SAFETY
+
+#endif // ANJAY_WITH_OBSERVE
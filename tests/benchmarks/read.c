@@ -0,0 +1,134 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include <avsystem/coap/code.h>
+#include <avsystem/coap/option.h>
+
+#include "tests/benchmarks/utils.h"
+
+#define READ_INSTANCE_COUNT 1000
+#define READ_ITERATIONS 20
+#define BLOB_SIZE (64 * 1024)
+#define BLOB_ITERATIONS 50
+
+typedef struct {
+    const char *name;
+    uint16_t format;
+} content_format_t;
+
+static const content_format_t HIERARCHICAL_FORMATS[] = {
+#ifndef ANJAY_WITHOUT_TLV
+    { "tlv", AVS_COAP_FORMAT_OMA_LWM2M_TLV },
+#endif // ANJAY_WITHOUT_TLV
+#ifdef ANJAY_WITH_LWM2M_JSON
+    { "lwm2m_json", AVS_COAP_FORMAT_OMA_LWM2M_JSON },
+#endif // ANJAY_WITH_LWM2M_JSON
+#ifdef ANJAY_WITH_SENML_JSON
+    { "senml_json", AVS_COAP_FORMAT_SENML_JSON },
+#endif // ANJAY_WITH_SENML_JSON
+#ifdef ANJAY_WITH_CBOR
+    { "senml_cbor", AVS_COAP_FORMAT_SENML_CBOR },
+#endif // ANJAY_WITH_CBOR
+};
+
+static void read_object(const char *benchmark, anjay_oid_t oid) {
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(HIERARCHICAL_FORMATS); ++i) {
+        anjay_bench_t bench;
+        _anjay_bench_init(&bench, READ_INSTANCE_COUNT, 0);
+
+        char path[8];
+        snprintf(path, sizeof(path), "%" PRIu16, oid);
+        anjay_bench_coap_msg_t msg = ANJAY_BENCH_COAP_MSG_EMPTY;
+        msg.code = AVS_COAP_CODE_GET;
+        msg.uri_path = path;
+        msg.accept = HIERARCHICAL_FORMATS[i].format;
+
+        uint64_t bytes = 0;
+        _anjay_bench_heap_reset_peak();
+        const int64_t start_ns = _anjay_bench_now_ns();
+        for (size_t j = 0; j < READ_ITERATIONS; ++j) {
+            size_t payload_size;
+            AVS_UNIT_ASSERT_EQUAL(_anjay_bench_request(&bench, &msg,
+                                                       &payload_size),
+                                  AVS_COAP_CODE_CONTENT);
+            bytes += payload_size;
+        }
+        _anjay_bench_report(benchmark, HIERARCHICAL_FORMATS[i].name,
+                            READ_ITERATIONS, _anjay_bench_now_ns() - start_ns,
+                            bytes);
+        _anjay_bench_report_heap(benchmark, HIERARCHICAL_FORMATS[i].name,
+                                 _anjay_bench_heap_peak());
+
+        _anjay_bench_finish(&bench);
+    }
+}
+
+AVS_UNIT_TEST(benchmarks, read_large_object) {
+    read_object("read_object", BENCH_OID);
+}
+
+AVS_UNIT_TEST(benchmarks, read_large_object_static_resources) {
+    read_object("read_object_static_resources", BENCH_TABLE_OID);
+}
+
+/**
+ * Reads the blob Resource @p rid. The Observe variants go through the batch
+ * builder, which stores the values for later notifications.
+ */
+static void read_blob(const char *benchmark,
+                      const char *variant,
+                      anjay_rid_t rid,
+                      bool observe) {
+    anjay_bench_t bench;
+    _anjay_bench_init(&bench, 0, BLOB_SIZE);
+
+    char path[16];
+    snprintf(path, sizeof(path), "%d/0/%" PRIu16, BENCH_BLOB_OID, rid);
+    anjay_bench_coap_msg_t msg = ANJAY_BENCH_COAP_MSG_EMPTY;
+    msg.code = AVS_COAP_CODE_GET;
+    msg.uri_path = path;
+    msg.accept = AVS_COAP_FORMAT_OCTET_STREAM;
+    if (observe) {
+        msg.observe = 0;
+    }
+
+    uint64_t bytes = 0;
+    const int64_t start_ns = _anjay_bench_now_ns();
+    for (size_t i = 0; i < BLOB_ITERATIONS; ++i) {
+        size_t payload_size;
+        AVS_UNIT_ASSERT_EQUAL(_anjay_bench_request(&bench, &msg, &payload_size),
+                              AVS_COAP_CODE_CONTENT);
+        AVS_UNIT_ASSERT_EQUAL(payload_size, BLOB_SIZE);
+        bytes += payload_size;
+    }
+    _anjay_bench_report(benchmark, variant, BLOB_ITERATIONS,
+                        _anjay_bench_now_ns() - start_ns, bytes);
+
+    _anjay_bench_finish(&bench);
+}
+
+AVS_UNIT_TEST(benchmarks, read_blockwise_opaque) {
+    read_blob("read_blockwise", "opaque", 0, false);
+    read_blob("read_blockwise", "opaque_borrowed", 1, false);
+}
+
+#ifdef ANJAY_WITH_OBSERVE
+AVS_UNIT_TEST(benchmarks, observe_blockwise_opaque) {
+    read_blob("observe_blockwise", "opaque", 0, true);
+    read_blob("observe_blockwise", "opaque_borrowed", 1, true);
+}
+#endif // ANJAY_WITH_OBSERVE
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <stdio.h>
+
+#include <avsystem/commons/avs_stream_outbuf.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "src/core/anjay_io_core.h"
+
+#include "tests/benchmarks/utils.h"
+
+#ifndef ANJAY_WITHOUT_TLV
+
+#    define TLV_ITERATIONS 50
+#    define TLV_RESOURCE_INSTANCE_COUNT 8
+
+static const char TLV_STRING_VALUE[] =
+        "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+
+/**
+ * Shaped after a Read on a large Object: each Instance contains an integer
+ * Resource, a string Resource and a Multiple-Instance integer Resource.
+ */
+static int feed_object(anjay_unlocked_output_ctx_t *out,
+                       void *instance_count_) {
+    const anjay_iid_t instance_count = *(const anjay_iid_t *) instance_count_;
+    int result = 0;
+    for (anjay_iid_t iid = 0; !result && iid < instance_count; ++iid) {
+        (void) ((result = _anjay_output_set_path(
+                         out, &MAKE_INSTANCE_PATH(BENCH_OID, iid)))
+                || (result = _anjay_output_start_aggregate(out))
+                || (result = _anjay_output_set_path(
+                            out, &MAKE_RESOURCE_PATH(BENCH_OID, iid, 0)))
+                || (result = _anjay_ret_i64_unlocked(out, 1000 + iid))
+                || (result = _anjay_output_set_path(
+                            out, &MAKE_RESOURCE_PATH(BENCH_OID, iid, 1)))
+                || (result = _anjay_ret_string_unlocked(out,
+                                                        TLV_STRING_VALUE)));
+        for (anjay_riid_t riid = 0;
+             !result && riid < TLV_RESOURCE_INSTANCE_COUNT;
+             ++riid) {
+            (void) ((result = _anjay_output_set_path(
+                             out, &MAKE_RESOURCE_INSTANCE_PATH(BENCH_OID, iid,
+                                                               2, riid)))
+                    || (result = _anjay_ret_i64_unlocked(out, riid)));
+        }
+    }
+    return result;
+}
+
+static void encode_object(anjay_iid_t instance_count, bool precompute) {
+    static char buf[1024 * 1024];
+
+    size_t peak_heap = 0;
+    size_t payload_size = 0;
+    const int64_t start_ns = _anjay_bench_now_ns();
+    for (size_t i = 0; i < TLV_ITERATIONS; ++i) {
+        avs_stream_outbuf_t stream = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+        avs_stream_outbuf_set_buffer(&stream, buf, sizeof(buf));
+        _anjay_bench_heap_reset_peak();
+        anjay_unlocked_output_ctx_t *out =
+                _anjay_output_tlv_create((avs_stream_t *) &stream,
+                                         &MAKE_OBJECT_PATH(BENCH_OID));
+        AVS_UNIT_ASSERT_NOT_NULL(out);
+        if (precompute) {
+            AVS_UNIT_ASSERT_SUCCESS(_anjay_output_tlv_precompute_lengths(
+                    out, feed_object, &instance_count));
+        }
+        AVS_UNIT_ASSERT_SUCCESS(feed_object(out, &instance_count));
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+        peak_heap = AVS_MAX(peak_heap, _anjay_bench_heap_peak());
+        payload_size = avs_stream_outbuf_offset(&stream);
+    }
+    const int64_t elapsed_ns = _anjay_bench_now_ns() - start_ns;
+
+    char variant[32];
+    snprintf(variant, sizeof(variant), "%s_%u",
+             precompute ? "precomputed" : "buffered",
+             (unsigned) instance_count);
+    _anjay_bench_report("tlv_encode_object", variant, TLV_ITERATIONS,
+                        elapsed_ns, (uint64_t) TLV_ITERATIONS * payload_size);
+    _anjay_bench_report_heap("tlv_encode_object", variant, peak_heap);
+}
+
+AVS_UNIT_TEST(benchmarks, tlv_encode_object) {
+    static const anjay_iid_t INSTANCE_COUNTS[] = { 1, 100, 1000 };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(INSTANCE_COUNTS); ++i) {
+        encode_object(INSTANCE_COUNTS[i], false);
+        encode_object(INSTANCE_COUNTS[i], true);
+    }
+}
+
+#endif // ANJAY_WITHOUT_TLV
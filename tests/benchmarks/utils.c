@@ -0,0 +1,959 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#define _GNU_SOURCE // for RTLD_NEXT
+#include <anjay_init.h>
+
+#include <assert.h>
+#include <dlfcn.h>
+#include <inttypes.h>
+#include <limits.h>
+#ifdef __GLIBC__
+#    include <malloc.h>
+#endif // __GLIBC__
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <avsystem/commons/avs_list.h>
+#include <avsystem/commons/avs_log.h>
+#include <avsystem/commons/avs_socket_v_table.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include <avsystem/coap/ctx.h>
+#include <avsystem/coap/udp.h>
+
+#include <anjay/server.h>
+
+#include "src/core/anjay_core.h"
+#include "tests/benchmarks/utils.h"
+#include "tests/utils/mock_clock.h"
+
+// HACK to enable _anjay_server_cleanup
+#define ANJAY_SERVERS_INTERNALS
+#include "src/core/servers/anjay_server_connections.h"
+#include "src/core/servers/anjay_servers_internal.h"
+#undef ANJAY_SERVERS_INTERNALS
+
+#define COAP_OPTION_OBSERVE 6
+#define COAP_OPTION_URI_PATH 11
+#define COAP_OPTION_CONTENT_FORMAT 12
+#define COAP_OPTION_ACCEPT 17
+#define COAP_OPTION_BLOCK2 23
+#define COAP_OPTION_BLOCK1 27
+
+#define COAP_TYPE_CON 0
+#define COAP_TYPE_ACK 2
+
+#define BENCH_MAX_PACKET_SIZE 1280
+
+typedef int (*clock_gettime_t)(clockid_t, struct timespec *);
+
+// clock_gettime() is overridden by mock_clock.c
+static clock_gettime_t real_clock_gettime;
+
+AVS_UNIT_GLOBAL_INIT(verbose) {
+    real_clock_gettime =
+            (clock_gettime_t) (intptr_t) dlsym(RTLD_NEXT, "clock_gettime");
+#if defined(AVS_COMMONS_WITH_AVS_LOG) && defined(ANJAY_WITH_LOGS)
+    if (!verbose) {
+        avs_log_set_default_level(AVS_LOG_QUIET);
+    }
+#else  // defined(AVS_COMMONS_WITH_AVS_LOG) && defined(ANJAY_WITH_LOGS)
+    (void) verbose;
+#endif // defined(AVS_COMMONS_WITH_AVS_LOG) && defined(ANJAY_WITH_LOGS)
+}
+
+/***************************************************************************
+ * Minimal CoAP/UDP codec
+ ***************************************************************************/
+
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t offset;
+    uint16_t last_option;
+} coap_writer_t;
+
+static void write_bytes(coap_writer_t *writer, const void *data, size_t size) {
+    AVS_UNIT_ASSERT_TRUE(writer->offset + size <= writer->size);
+    memcpy(writer->buf + writer->offset, data, size);
+    writer->offset += size;
+}
+
+static void write_byte(coap_writer_t *writer, uint8_t value) {
+    write_bytes(writer, &value, 1);
+}
+
+static uint8_t option_nibble(size_t value) {
+    return (uint8_t) (value < 13 ? value : value < 269 ? 13 : 14);
+}
+
+static void write_option_ext(coap_writer_t *writer, size_t value) {
+    if (value >= 269) {
+        write_byte(writer, (uint8_t) ((value - 269) >> 8));
+        write_byte(writer, (uint8_t) (value - 269));
+    } else if (value >= 13) {
+        write_byte(writer, (uint8_t) (value - 13));
+    }
+}
+
+static void write_option(coap_writer_t *writer,
+                         uint16_t number,
+                         const void *value,
+                         size_t size) {
+    AVS_UNIT_ASSERT_TRUE(number >= writer->last_option);
+    size_t delta = (size_t) (number - writer->last_option);
+    write_byte(writer,
+               (uint8_t) (option_nibble(delta) << 4 | option_nibble(size)));
+    write_option_ext(writer, delta);
+    write_option_ext(writer, size);
+    write_bytes(writer, value, size);
+    writer->last_option = number;
+}
+
+static void
+write_uint_option(coap_writer_t *writer, uint16_t number, int64_t value) {
+    if (value < 0) {
+        return;
+    }
+    uint8_t bytes[sizeof(uint32_t)];
+    size_t size = 0;
+    for (uint64_t v = (uint64_t) value; v; v >>= 8) {
+        ++size;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = (uint8_t) ((uint64_t) value >> (8 * (size - i - 1)));
+    }
+    write_option(writer, number, bytes, size);
+}
+
+size_t _anjay_bench_coap_encode(uint8_t *buf,
+                                size_t buf_size,
+                                const anjay_bench_coap_msg_t *msg) {
+    coap_writer_t writer = {
+        .buf = buf,
+        .size = buf_size
+    };
+    // Empty messages must not contain a token
+    const uint8_t token_length = msg->code ? sizeof(msg->token) : 0;
+    write_byte(&writer, (uint8_t) (0x40 | (msg->type << 4) | token_length));
+    write_byte(&writer, msg->code);
+    write_byte(&writer, (uint8_t) (msg->msg_id >> 8));
+    write_byte(&writer, (uint8_t) msg->msg_id);
+    for (size_t i = 0; i < token_length; ++i) {
+        write_byte(&writer, (uint8_t) (msg->token >> (8 * (7 - i))));
+    }
+
+    write_uint_option(&writer, COAP_OPTION_OBSERVE, msg->observe);
+    for (const char *segment = msg->uri_path; segment && *segment;) {
+        const char *end = strchr(segment, '/');
+        size_t length = end ? (size_t) (end - segment) : strlen(segment);
+        write_option(&writer, COAP_OPTION_URI_PATH, segment, length);
+        segment += length + (end ? 1 : 0);
+    }
+    write_uint_option(&writer, COAP_OPTION_CONTENT_FORMAT,
+                      msg->content_format);
+    write_uint_option(&writer, COAP_OPTION_ACCEPT, msg->accept);
+    write_uint_option(&writer, COAP_OPTION_BLOCK2, msg->block2);
+    write_uint_option(&writer, COAP_OPTION_BLOCK1, msg->block1);
+
+    if (msg->payload_size) {
+        write_byte(&writer, 0xFF);
+        write_bytes(&writer, msg->payload, msg->payload_size);
+    }
+    return writer.offset;
+}
+
+static int read_option_ext(const uint8_t **ptr,
+                           const uint8_t *end,
+                           uint8_t nibble,
+                           size_t *out_value) {
+    if (nibble < 13) {
+        *out_value = nibble;
+    } else if (nibble == 13 && end - *ptr >= 1) {
+        *out_value = 13 + (size_t) (*ptr)[0];
+        *ptr += 1;
+    } else if (nibble == 14 && end - *ptr >= 2) {
+        *out_value = 269 + (size_t) ((*ptr)[0] << 8 | (*ptr)[1]);
+        *ptr += 2;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static int64_t read_uint(const uint8_t *value, size_t size) {
+    uint64_t result = 0;
+    for (size_t i = 0; i < size; ++i) {
+        result = result << 8 | value[i];
+    }
+    return (int64_t) result;
+}
+
+int _anjay_bench_coap_decode(const uint8_t *buf,
+                             size_t buf_size,
+                             anjay_bench_coap_msg_t *out_msg) {
+    *out_msg = ANJAY_BENCH_COAP_MSG_EMPTY;
+    if (buf_size < 4 || (buf[0] >> 6) != 1) {
+        return -1;
+    }
+    const uint8_t token_length = buf[0] & 0x0F;
+    if (token_length > sizeof(out_msg->token)
+            || buf_size < 4 + (size_t) token_length) {
+        return -1;
+    }
+    out_msg->type = (buf[0] >> 4) & 0x03;
+    out_msg->code = buf[1];
+    out_msg->msg_id = (uint16_t) (buf[2] << 8 | buf[3]);
+    out_msg->token = (uint64_t) read_uint(buf + 4, token_length);
+
+    const uint8_t *ptr = buf + 4 + token_length;
+    const uint8_t *const end = buf + buf_size;
+    size_t number = 0;
+    while (ptr < end && *ptr != 0xFF) {
+        const uint8_t header = *ptr++;
+        size_t delta;
+        size_t size;
+        if (read_option_ext(&ptr, end, (uint8_t) (header >> 4), &delta)
+                || read_option_ext(&ptr, end, header & 0x0F, &size)
+                || (size_t) (end - ptr) < size) {
+            return -1;
+        }
+        number += delta;
+        switch (number) {
+        case COAP_OPTION_OBSERVE:
+            out_msg->observe = (int32_t) read_uint(ptr, size);
+            break;
+        case COAP_OPTION_CONTENT_FORMAT:
+            out_msg->content_format = (int32_t) read_uint(ptr, size);
+            break;
+        case COAP_OPTION_ACCEPT:
+            out_msg->accept = (int32_t) read_uint(ptr, size);
+            break;
+        case COAP_OPTION_BLOCK2:
+            out_msg->block2 = read_uint(ptr, size);
+            break;
+        case COAP_OPTION_BLOCK1:
+            out_msg->block1 = read_uint(ptr, size);
+            break;
+        default:
+            break;
+        }
+        ptr += size;
+    }
+    if (ptr < end) {
+        // skip the payload marker
+        if (++ptr == end) {
+            return -1;
+        }
+        out_msg->payload = ptr;
+        out_msg->payload_size = (size_t) (end - ptr);
+    }
+    return 0;
+}
+
+/***************************************************************************
+ * In-memory socket
+ ***************************************************************************/
+
+typedef struct {
+    size_t size;
+    uint8_t data[BENCH_MAX_PACKET_SIZE];
+} bench_packet_t;
+
+typedef struct {
+    const avs_net_socket_v_table_t *operations;
+    AVS_LIST(bench_packet_t) inbox;
+    bench_packet_t last_sent;
+    size_t packets_sent;
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    avs_time_duration_t recv_timeout;
+    avs_net_socket_state_t state;
+} bench_socket_t;
+
+static void push_packet(bench_socket_t *socket,
+                        const anjay_bench_coap_msg_t *msg) {
+    AVS_LIST(bench_packet_t) packet = AVS_LIST_NEW_ELEMENT(bench_packet_t);
+    AVS_UNIT_ASSERT_NOT_NULL(packet);
+    packet->size = _anjay_bench_coap_encode(packet->data, sizeof(packet->data),
+                                            msg);
+    AVS_LIST_APPEND(&socket->inbox, packet);
+}
+
+static avs_error_t
+bench_socket_connect(avs_net_socket_t *socket_, const char *host,
+                     const char *port) {
+    (void) host;
+    (void) port;
+    ((bench_socket_t *) socket_)->state = AVS_NET_SOCKET_STATE_CONNECTED;
+    return AVS_OK;
+}
+
+static avs_error_t bench_socket_send(avs_net_socket_t *socket_,
+                                     const void *buffer,
+                                     size_t buffer_length) {
+    bench_socket_t *socket = (bench_socket_t *) socket_;
+    AVS_UNIT_ASSERT_TRUE(buffer_length <= sizeof(socket->last_sent.data));
+    memcpy(socket->last_sent.data, buffer, buffer_length);
+    socket->last_sent.size = buffer_length;
+    ++socket->packets_sent;
+    socket->bytes_sent += buffer_length;
+
+    anjay_bench_coap_msg_t msg;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_bench_coap_decode(buffer, buffer_length, &msg));
+    if (msg.type == COAP_TYPE_CON && msg.code) {
+        anjay_bench_coap_msg_t ack = ANJAY_BENCH_COAP_MSG_EMPTY;
+        ack.type = COAP_TYPE_ACK;
+        ack.msg_id = msg.msg_id;
+        push_packet(socket, &ack);
+    }
+    return AVS_OK;
+}
+
+static avs_error_t bench_socket_receive(avs_net_socket_t *socket_,
+                                        size_t *out_bytes_received,
+                                        void *buffer,
+                                        size_t buffer_length) {
+    bench_socket_t *socket = (bench_socket_t *) socket_;
+    *out_bytes_received = 0;
+    if (!socket->inbox) {
+        return avs_errno(AVS_ETIMEDOUT);
+    }
+    const size_t size = socket->inbox->size;
+    *out_bytes_received = AVS_MIN(size, buffer_length);
+    memcpy(buffer, socket->inbox->data, *out_bytes_received);
+    socket->bytes_received += size;
+    AVS_LIST_DELETE(&socket->inbox);
+    return size > buffer_length ? avs_errno(AVS_EMSGSIZE) : AVS_OK;
+}
+
+static avs_error_t bench_socket_close(avs_net_socket_t *socket) {
+    ((bench_socket_t *) socket)->state = AVS_NET_SOCKET_STATE_CLOSED;
+    return AVS_OK;
+}
+
+static avs_error_t bench_socket_shutdown(avs_net_socket_t *socket) {
+    ((bench_socket_t *) socket)->state = AVS_NET_SOCKET_STATE_SHUTDOWN;
+    return AVS_OK;
+}
+
+static avs_error_t bench_socket_cleanup(avs_net_socket_t **socket_ptr) {
+    bench_socket_t *socket = (bench_socket_t *) *socket_ptr;
+    AVS_LIST_CLEAR(&socket->inbox);
+    avs_free(socket);
+    *socket_ptr = NULL;
+    return AVS_OK;
+}
+
+static const void *bench_socket_get_system(avs_net_socket_t *socket) {
+    (void) socket;
+    return NULL;
+}
+
+static avs_error_t bench_socket_get_opt(avs_net_socket_t *socket_,
+                                        avs_net_socket_opt_key_t option_key,
+                                        avs_net_socket_opt_value_t *out) {
+    bench_socket_t *socket = (bench_socket_t *) socket_;
+    switch (option_key) {
+    case AVS_NET_SOCKET_OPT_RECV_TIMEOUT:
+        out->recv_timeout = socket->recv_timeout;
+        return AVS_OK;
+    case AVS_NET_SOCKET_OPT_STATE:
+        out->state = socket->state;
+        return AVS_OK;
+    case AVS_NET_SOCKET_OPT_INNER_MTU:
+        out->mtu = 1252;
+        return AVS_OK;
+    case AVS_NET_SOCKET_HAS_BUFFERED_DATA:
+        out->flag = false;
+        return AVS_OK;
+    case AVS_NET_SOCKET_OPT_BYTES_SENT:
+        out->bytes_sent = socket->bytes_sent;
+        return AVS_OK;
+    case AVS_NET_SOCKET_OPT_BYTES_RECEIVED:
+        out->bytes_received = socket->bytes_received;
+        return AVS_OK;
+    default:
+        return avs_errno(AVS_ENOTSUP);
+    }
+}
+
+static avs_error_t bench_socket_set_opt(avs_net_socket_t *socket_,
+                                        avs_net_socket_opt_key_t option_key,
+                                        avs_net_socket_opt_value_t value) {
+    bench_socket_t *socket = (bench_socket_t *) socket_;
+    if (option_key == AVS_NET_SOCKET_OPT_RECV_TIMEOUT) {
+        socket->recv_timeout = value.recv_timeout;
+        return AVS_OK;
+    }
+    return avs_errno(AVS_ENOTSUP);
+}
+
+static const avs_net_socket_v_table_t BENCH_SOCKET_VTABLE = {
+    .connect = bench_socket_connect,
+    .send = bench_socket_send,
+    .receive = bench_socket_receive,
+    .close = bench_socket_close,
+    .shutdown = bench_socket_shutdown,
+    .cleanup = bench_socket_cleanup,
+    .get_system_socket = bench_socket_get_system,
+    .get_opt = bench_socket_get_opt,
+    .set_opt = bench_socket_set_opt
+};
+
+avs_net_socket_t *_anjay_bench_socket_create(void) {
+    bench_socket_t *socket =
+            (bench_socket_t *) avs_calloc(1, sizeof(bench_socket_t));
+    AVS_UNIT_ASSERT_NOT_NULL(socket);
+    socket->operations = &BENCH_SOCKET_VTABLE;
+    socket->recv_timeout = avs_time_duration_from_scalar(1, AVS_TIME_S);
+    socket->state = AVS_NET_SOCKET_STATE_CLOSED;
+    return (avs_net_socket_t *) socket;
+}
+
+void _anjay_bench_socket_push(avs_net_socket_t *socket,
+                              const anjay_bench_coap_msg_t *msg) {
+    push_packet((bench_socket_t *) socket, msg);
+}
+
+size_t _anjay_bench_socket_packets_sent(avs_net_socket_t *socket) {
+    return ((bench_socket_t *) socket)->packets_sent;
+}
+
+int _anjay_bench_socket_last_sent(avs_net_socket_t *socket_,
+                                  anjay_bench_coap_msg_t *out_msg) {
+    bench_socket_t *socket = (bench_socket_t *) socket_;
+    return _anjay_bench_coap_decode(socket->last_sent.data,
+                                    socket->last_sent.size, out_msg);
+}
+
+/***************************************************************************
+ * Benchmark Objects
+ ***************************************************************************/
+
+static struct {
+    anjay_iid_t instance_count;
+    int64_t generation;
+    uint8_t *blob;
+    size_t blob_size;
+    // Sum of all written values, so that writes cannot be optimized out
+    int64_t written_sum;
+} BENCH_DATA;
+
+static int bench_list_instances(anjay_t *anjay,
+                                const anjay_dm_object_def_t *const *obj_ptr,
+                                anjay_dm_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    for (anjay_iid_t iid = 0; iid < BENCH_DATA.instance_count; ++iid) {
+        anjay_dm_emit(ctx, iid);
+    }
+    return 0;
+}
+
+static int bench_list_resources(anjay_t *anjay,
+                                const anjay_dm_object_def_t *const *obj_ptr,
+                                anjay_iid_t iid,
+                                anjay_dm_resource_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+    anjay_dm_emit_res(ctx, 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, 3, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT);
+    return 0;
+}
+
+static int bench_resource_read(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid,
+                               anjay_riid_t riid,
+                               anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) riid;
+    switch (rid) {
+    case 0:
+        return anjay_ret_i64(ctx, iid + BENCH_DATA.generation);
+    case 1: {
+        char value[32];
+        snprintf(value, sizeof(value), "Benchmark instance %" PRIu16, iid);
+        return anjay_ret_string(ctx, value);
+    }
+    case 2:
+        return anjay_ret_double(ctx, iid * 0.5 + BENCH_DATA.generation);
+    case 3:
+        return anjay_ret_bool(ctx, (iid + BENCH_DATA.generation) % 2);
+    default:
+        return ANJAY_ERR_NOT_FOUND;
+    }
+}
+
+static int bench_resource_write(anjay_t *anjay,
+                                const anjay_dm_object_def_t *const *obj_ptr,
+                                anjay_iid_t iid,
+                                anjay_rid_t rid,
+                                anjay_riid_t riid,
+                                anjay_input_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+    (void) riid;
+    int result;
+    switch (rid) {
+    case 0: {
+        int64_t value;
+        if (!(result = anjay_get_i64(ctx, &value))) {
+            BENCH_DATA.written_sum += value;
+        }
+        return result;
+    }
+    case 1: {
+        char value[64];
+        if (!(result = anjay_get_string(ctx, value, sizeof(value)))) {
+            BENCH_DATA.written_sum += (int64_t) strlen(value);
+        }
+        return result;
+    }
+    case 2: {
+        double value;
+        if (!(result = anjay_get_double(ctx, &value))) {
+            BENCH_DATA.written_sum += (int64_t) value;
+        }
+        return result;
+    }
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static const anjay_dm_object_def_t BENCH_OBJ_DEF = {
+    .oid = BENCH_OID,
+    .handlers = {
+        .list_instances = bench_list_instances,
+        .list_resources = bench_list_resources,
+        .resource_read = bench_resource_read,
+        .resource_write = bench_resource_write,
+        .transaction_begin = anjay_dm_transaction_NOOP,
+        .transaction_validate = anjay_dm_transaction_NOOP,
+        .transaction_commit = anjay_dm_transaction_NOOP,
+        .transaction_rollback = anjay_dm_transaction_NOOP
+    }
+};
+static const anjay_dm_object_def_t *const BENCH_OBJ = &BENCH_OBJ_DEF;
+
+static const anjay_dm_resource_def_t BENCH_RESOURCES[] = {
+    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+    { 3, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT }
+};
+
+static const anjay_dm_object_def_t BENCH_TABLE_OBJ_DEF = {
+    .oid = BENCH_TABLE_OID,
+    .resources = BENCH_RESOURCES,
+    .resources_count = AVS_ARRAY_SIZE(BENCH_RESOURCES),
+    .handlers = {
+        .list_instances = bench_list_instances,
+        .resource_read = bench_resource_read,
+        .resource_write = bench_resource_write,
+        .transaction_begin = anjay_dm_transaction_NOOP,
+        .transaction_validate = anjay_dm_transaction_NOOP,
+        .transaction_commit = anjay_dm_transaction_NOOP,
+        .transaction_rollback = anjay_dm_transaction_NOOP
+    }
+};
+static const anjay_dm_object_def_t *const BENCH_TABLE_OBJ =
+        &BENCH_TABLE_OBJ_DEF;
+
+static int blob_list_instances(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj_ptr,
+                               anjay_dm_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    anjay_dm_emit(ctx, 0);
+    return 0;
+}
+
+static int blob_list_resources(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_dm_resource_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+    anjay_dm_emit_res(ctx, 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, 1, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT);
+    return 0;
+}
+
+static int blob_resource_read(anjay_t *anjay,
+                              const anjay_dm_object_def_t *const *obj_ptr,
+                              anjay_iid_t iid,
+                              anjay_rid_t rid,
+                              anjay_riid_t riid,
+                              anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+    (void) riid;
+    if (rid == 1) {
+        // the blob outlives the Anjay instance, so there is nothing to release
+        return anjay_ret_bytes_borrowed(ctx, BENCH_DATA.blob,
+                                        BENCH_DATA.blob_size, NULL, NULL);
+    }
+    return anjay_ret_bytes(ctx, BENCH_DATA.blob, BENCH_DATA.blob_size);
+}
+
+static int blob_resource_write(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid,
+                               anjay_riid_t riid,
+                               anjay_input_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+    (void) rid;
+    (void) riid;
+    bool finished = false;
+    while (!finished) {
+        uint8_t chunk[512];
+        size_t bytes_read;
+        int result = anjay_get_bytes(ctx, &bytes_read, &finished, chunk,
+                                     sizeof(chunk));
+        if (result) {
+            return result;
+        }
+        BENCH_DATA.written_sum += (int64_t) bytes_read;
+    }
+    return 0;
+}
+
+static const anjay_dm_object_def_t BENCH_BLOB_OBJ_DEF = {
+    .oid = BENCH_BLOB_OID,
+    .handlers = {
+        .list_instances = blob_list_instances,
+        .list_resources = blob_list_resources,
+        .resource_read = blob_resource_read,
+        .resource_write = blob_resource_write,
+        .transaction_begin = anjay_dm_transaction_NOOP,
+        .transaction_validate = anjay_dm_transaction_NOOP,
+        .transaction_commit = anjay_dm_transaction_NOOP,
+        .transaction_rollback = anjay_dm_transaction_NOOP
+    }
+};
+static const anjay_dm_object_def_t *const BENCH_BLOB_OBJ = &BENCH_BLOB_OBJ_DEF;
+
+void _anjay_bench_touch_values(void) {
+    ++BENCH_DATA.generation;
+}
+
+/***************************************************************************
+ * Fixture
+ ***************************************************************************/
+
+static void install_socket(anjay_bench_t *bench) {
+    bench->socket = _anjay_bench_socket_create();
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_connect(bench->socket, "", ""));
+    ANJAY_MUTEX_LOCK(anjay, bench->anjay);
+    _anjay_notify_clear_queue(&anjay->scheduled_notify.queue);
+    avs_sched_del(&anjay->scheduled_notify.handle);
+    avs_sched_del(&anjay->reload_servers_sched_job_handle);
+    AVS_UNIT_ASSERT_NOT_NULL(
+            AVS_LIST_INSERT_NEW(anjay_server_info_t, &anjay->servers));
+    anjay->servers->anjay = anjay;
+    anjay->servers->ssid = 1;
+    anjay->servers->registration_info.expire_time.since_real_epoch.seconds =
+            INT64_MAX;
+    anjay_server_connection_t *connection =
+            _anjay_get_server_connection((const anjay_connection_ref_t) {
+                .server = anjay->servers,
+                .conn_type = ANJAY_CONNECTION_PRIMARY
+            });
+    AVS_UNIT_ASSERT_NOT_NULL(connection);
+    connection->conn_socket_ = bench->socket;
+    connection->coap_ctx = avs_coap_udp_ctx_create(
+            _anjay_get_coap_sched(anjay), &AVS_COAP_DEFAULT_UDP_TX_PARAMS,
+            anjay->in_shared_buffer, anjay->out_shared_buffer,
+            anjay->udp_response_cache, anjay->prng_ctx.ctx);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_coap_ctx_set_socket(connection->coap_ctx, bench->socket));
+    ANJAY_MUTEX_UNLOCK(bench->anjay);
+}
+
+void _anjay_bench_init(anjay_bench_t *bench,
+                       anjay_iid_t instance_count,
+                       size_t blob_size) {
+    memset(bench, 0, sizeof(*bench));
+    bench->next_msg_id = 1;
+    bench->next_token = 1;
+
+    BENCH_DATA.instance_count = instance_count;
+    BENCH_DATA.generation = 0;
+    BENCH_DATA.blob_size = blob_size;
+    AVS_UNIT_ASSERT_NOT_NULL(
+            (BENCH_DATA.blob = (uint8_t *) avs_malloc(blob_size + 1)));
+    for (size_t i = 0; i < blob_size; ++i) {
+        BENCH_DATA.blob[i] = (uint8_t) i;
+    }
+
+    _anjay_mock_clock_start(avs_time_monotonic_from_scalar(1000, AVS_TIME_S));
+    bench->anjay = anjay_new(&(const anjay_configuration_t) {
+        .endpoint_name = "urn:dev:os:anjay-benchmark",
+        .in_buffer_size = 4096,
+        .out_buffer_size = 4096
+    });
+    AVS_UNIT_ASSERT_NOT_NULL(bench->anjay);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_install(bench->anjay));
+    anjay_iid_t server_iid = ANJAY_ID_INVALID;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_add_instance(
+            bench->anjay,
+            &(const anjay_server_instance_t) {
+                .ssid = 1,
+                .lifetime = 86400,
+                .default_min_period = -1,
+                .default_max_period = -1,
+                .disable_timeout = -1,
+                .binding = "U"
+            },
+            &server_iid));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_register_object(bench->anjay, &BENCH_OBJ));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_register_object(bench->anjay, &BENCH_TABLE_OBJ));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_register_object(bench->anjay, &BENCH_BLOB_OBJ));
+    install_socket(bench);
+}
+
+void _anjay_bench_finish(anjay_bench_t *bench) {
+    ANJAY_MUTEX_LOCK(anjay, bench->anjay);
+    AVS_LIST_CLEAR(&anjay->servers) {
+        _anjay_server_cleanup(anjay->servers);
+    }
+    ANJAY_MUTEX_UNLOCK(bench->anjay);
+    anjay_delete(bench->anjay);
+    _anjay_mock_clock_finish();
+    avs_free(BENCH_DATA.blob);
+    memset(&BENCH_DATA, 0, sizeof(BENCH_DATA));
+    memset(bench, 0, sizeof(*bench));
+}
+
+/***************************************************************************
+ * Driver
+ ***************************************************************************/
+
+static bool socket_has_pending_input(avs_net_socket_t *socket) {
+    return ((bench_socket_t *) socket)->inbox != NULL;
+}
+
+void _anjay_bench_run_until_idle(anjay_bench_t *bench) {
+    // Guards against jobs that keep rescheduling themselves without any delay
+    static const size_t MAX_ROUNDS = 10000000;
+    size_t rounds = 0;
+    bool progress = true;
+    while (progress) {
+        AVS_UNIT_ASSERT_TRUE(++rounds < MAX_ROUNDS);
+        progress = false;
+        while (socket_has_pending_input(bench->socket)) {
+            AVS_UNIT_ASSERT_SUCCESS(anjay_serve(bench->anjay, bench->socket));
+            progress = true;
+        }
+        if (!anjay_sched_calculate_wait_time_ms(bench->anjay, INT_MAX)) {
+            anjay_sched_run(bench->anjay);
+            progress = true;
+        }
+    }
+}
+
+static uint16_t next_msg_id(anjay_bench_t *bench) {
+    return bench->next_msg_id++;
+}
+
+static void exchange(anjay_bench_t *bench,
+                     const anjay_bench_coap_msg_t *request,
+                     anjay_bench_coap_msg_t *out_response) {
+    _anjay_bench_socket_push(bench->socket, request);
+    _anjay_bench_run_until_idle(bench);
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_bench_socket_last_sent(bench->socket, out_response));
+    AVS_UNIT_ASSERT_EQUAL(out_response->type, COAP_TYPE_ACK);
+    AVS_UNIT_ASSERT_EQUAL(out_response->msg_id, request->msg_id);
+}
+
+uint8_t _anjay_bench_request(anjay_bench_t *bench,
+                             const anjay_bench_coap_msg_t *msg,
+                             size_t *out_payload_size) {
+    anjay_bench_coap_msg_t request = *msg;
+    anjay_bench_coap_msg_t response;
+    request.type = COAP_TYPE_CON;
+    request.token = bench->next_token++;
+
+    size_t offset = 0;
+    uint32_t block_num = 0;
+    do {
+        request.msg_id = next_msg_id(bench);
+        if (msg->payload_size > BENCH_BLOCK_SIZE) {
+            const size_t chunk =
+                    AVS_MIN(msg->payload_size - offset, BENCH_BLOCK_SIZE);
+            request.payload = msg->payload + offset;
+            request.payload_size = chunk;
+            offset += chunk;
+            request.block1 = ANJAY_BENCH_BLOCK_VALUE(
+                    block_num++, offset < msg->payload_size);
+        } else {
+            offset = msg->payload_size;
+        }
+        exchange(bench, &request, &response);
+    } while (offset < msg->payload_size
+             && response.code == AVS_COAP_CODE_CONTINUE);
+
+    size_t payload_size = response.payload_size;
+    while (response.block2 >= 0 && ANJAY_BENCH_BLOCK_MORE(response.block2)) {
+        request = *msg;
+        request.type = COAP_TYPE_CON;
+        request.msg_id = next_msg_id(bench);
+        request.token = bench->next_token++;
+        request.observe = -1;
+        request.block1 = -1;
+        // keep the block size chosen by the client
+        request.block2 = (int64_t) (((ANJAY_BENCH_BLOCK_NUM(response.block2)
+                                      + 1)
+                                     << 4)
+                                    | (response.block2 & 0x07));
+        exchange(bench, &request, &response);
+        payload_size += response.payload_size;
+    }
+    if (out_payload_size) {
+        *out_payload_size = payload_size;
+    }
+    return response.code;
+}
+
+/***************************************************************************
+ * Timing and reporting
+ ***************************************************************************/
+
+int64_t _anjay_bench_now_ns(void) {
+    // may be called from other threads, so AVS_UNIT_ASSERT_* is not used
+    assert(real_clock_gettime);
+    struct timespec now;
+    real_clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t) now.tv_sec * 1000000000 + (int64_t) now.tv_nsec;
+}
+
+/***************************************************************************
+ * Heap usage tracking
+ ***************************************************************************/
+
+#ifdef __GLIBC__
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+// Signed, as memory allocated through functions that are not overridden below
+// (e.g. posix_memalign()) may still be released using free()
+static int64_t heap_current;
+static int64_t heap_peak;
+
+static void heap_account(void *ptr, int sign) {
+    if (!ptr) {
+        return;
+    }
+    const int64_t size = sign * (int64_t) malloc_usable_size(ptr);
+    const int64_t current =
+            __atomic_add_fetch(&heap_current, size, __ATOMIC_RELAXED);
+    int64_t peak = __atomic_load_n(&heap_peak, __ATOMIC_RELAXED);
+    while (current > peak
+           && !__atomic_compare_exchange_n(&heap_peak, &peak, current, true,
+                                           __ATOMIC_RELAXED,
+                                           __ATOMIC_RELAXED)) {
+    }
+}
+
+void *malloc(size_t size) {
+    void *result = __libc_malloc(size);
+    heap_account(result, 1);
+    return result;
+}
+
+void *calloc(size_t nmemb, size_t size) {
+    void *result = __libc_calloc(nmemb, size);
+    heap_account(result, 1);
+    return result;
+}
+
+void *realloc(void *ptr, size_t size) {
+    const int64_t old_size = ptr ? (int64_t) malloc_usable_size(ptr) : 0;
+    void *result = __libc_realloc(ptr, size);
+    if (result || !size) {
+        __atomic_sub_fetch(&heap_current, old_size, __ATOMIC_RELAXED);
+        heap_account(result, 1);
+    }
+    return result;
+}
+
+void free(void *ptr) {
+    heap_account(ptr, -1);
+    __libc_free(ptr);
+}
+
+void _anjay_bench_heap_reset_peak(void) {
+    __atomic_store_n(&heap_peak,
+                     __atomic_load_n(&heap_current, __ATOMIC_RELAXED),
+                     __ATOMIC_RELAXED);
+}
+
+size_t _anjay_bench_heap_peak(void) {
+    const int64_t peak = __atomic_load_n(&heap_peak, __ATOMIC_RELAXED);
+    return peak > 0 ? (size_t) peak : 0;
+}
+#else  // __GLIBC__
+void _anjay_bench_heap_reset_peak(void) {}
+
+size_t _anjay_bench_heap_peak(void) {
+    return 0;
+}
+#endif // __GLIBC__
+
+void _anjay_bench_report(const char *benchmark,
+                         const char *variant,
+                         size_t iterations,
+                         int64_t elapsed_ns,
+                         uint64_t bytes) {
+    static FILE *output;
+    if (!output) {
+        const char *path = getenv("ANJAY_BENCHMARK_OUTPUT");
+        output = path ? fopen(path, "a") : stdout;
+        AVS_UNIT_ASSERT_NOT_NULL(output);
+    }
+    fprintf(output,
+            "{\"benchmark\":\"%s\",\"variant\":\"%s\",\"iterations\":%lu,"
+            "\"total_ns\":%" PRId64 ",\"ns_per_iteration\":%" PRId64
+            ",\"bytes\":%" PRIu64 "}\n",
+            benchmark, variant, (unsigned long) iterations, elapsed_ns,
+            iterations ? elapsed_ns / (int64_t) iterations : 0, bytes);
+    fflush(output);
+}
+
+void _anjay_bench_report_heap(const char *benchmark,
+                              const char *variant,
+                              size_t peak_bytes) {
+    char heap_variant[128];
+    snprintf(heap_variant, sizeof(heap_variant), "%s_peak_heap", variant);
+    _anjay_bench_report(benchmark, heap_variant, 0, 0, peak_bytes);
+}
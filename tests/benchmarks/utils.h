@@ -0,0 +1,170 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_BENCHMARKS_UTILS_H
+#define ANJAY_BENCHMARKS_UTILS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <avsystem/commons/avs_socket.h>
+
+#include <anjay/core.h>
+#include <anjay/dm.h>
+
+/**
+ * Object with a configurable number of Instances, each containing Resources:
+ * 0 (integer), 1 (string), 2 (double) and 3 (boolean, read-only). Resources
+ * are listed using the list_resources handler.
+ */
+#define BENCH_OID 42
+/** Same as BENCH_OID, but with a static Resource table. */
+#define BENCH_TABLE_OID 44
+/**
+ * Single Instance with opaque Resources of a configurable size: 0, returned
+ * using anjay_ret_bytes(), and 1 (read-only), returned using
+ * anjay_ret_bytes_borrowed().
+ */
+#define BENCH_BLOB_OID 43
+
+/** Size of payload blocks used by the simulated LwM2M Server. */
+#define BENCH_BLOCK_SIZE 1024
+
+typedef struct {
+    /** Message type: 0 - CON, 1 - NON, 2 - ACK, 3 - RST */
+    uint8_t type;
+    uint8_t code;
+    uint16_t msg_id;
+    uint64_t token;
+    /** Slash-separated path without the leading slash; encoding only */
+    const char *uri_path;
+    /* Option values below are negative if not present */
+    int32_t observe;
+    int32_t content_format;
+    int32_t accept;
+    int64_t block1;
+    int64_t block2;
+    const uint8_t *payload;
+    size_t payload_size;
+} anjay_bench_coap_msg_t;
+
+#define ANJAY_BENCH_COAP_MSG_EMPTY  \
+    ((anjay_bench_coap_msg_t) {     \
+        .observe = -1,              \
+        .content_format = -1,       \
+        .accept = -1,               \
+        .block1 = -1,               \
+        .block2 = -1                \
+    })
+
+#define ANJAY_BENCH_BLOCK_VALUE(Num, More) \
+    ((int64_t) (((uint32_t) (Num) << 4) | ((More) ? 0x08 : 0x00) | 6))
+#define ANJAY_BENCH_BLOCK_NUM(Value) ((uint32_t) ((Value) >> 4))
+#define ANJAY_BENCH_BLOCK_MORE(Value) (!!((Value) & 0x08))
+
+size_t _anjay_bench_coap_encode(uint8_t *buf,
+                                size_t buf_size,
+                                const anjay_bench_coap_msg_t *msg);
+
+int _anjay_bench_coap_decode(const uint8_t *buf,
+                             size_t buf_size,
+                             anjay_bench_coap_msg_t *out_msg);
+
+/**
+ * In-memory datagram socket. Incoming packets are queued by the benchmark and
+ * returned from receive() one by one; outgoing packets are counted, and the
+ * last one is kept so that it can be inspected. Confirmable messages sent by
+ * the client are automatically acknowledged.
+ */
+avs_net_socket_t *_anjay_bench_socket_create(void);
+
+void _anjay_bench_socket_push(avs_net_socket_t *socket,
+                              const anjay_bench_coap_msg_t *msg);
+
+/** Returns the number of packets sent through the socket so far. */
+size_t _anjay_bench_socket_packets_sent(avs_net_socket_t *socket);
+
+int _anjay_bench_socket_last_sent(avs_net_socket_t *socket,
+                                  anjay_bench_coap_msg_t *out_msg);
+
+typedef struct {
+    anjay_t *anjay;
+    avs_net_socket_t *socket;
+    uint16_t next_msg_id;
+    uint64_t next_token;
+} anjay_bench_t;
+
+/**
+ * Creates an Anjay instance with the Server object, the benchmark objects
+ * (with @p instance_count Instances and a @p blob_size byte opaque Resource)
+ * and a single LwM2M Server with SSID 1 connected through the in-memory
+ * socket.
+ */
+void _anjay_bench_init(anjay_bench_t *bench,
+                       anjay_iid_t instance_count,
+                       size_t blob_size);
+
+void _anjay_bench_finish(anjay_bench_t *bench);
+
+/** Changes the values returned by all integer and double Resources. */
+void _anjay_bench_touch_values(void);
+
+/**
+ * Serves incoming packets and runs the scheduler until there is nothing left
+ * to do at the current (mocked) time.
+ */
+void _anjay_bench_run_until_idle(anjay_bench_t *bench);
+
+/**
+ * Performs a request as the LwM2M Server would, including a block-wise
+ * transfer of @p msg payload longer than BENCH_BLOCK_SIZE, and fetching all
+ * further blocks of the response. Returns the response code, and the total
+ * size of the response payload in @p out_payload_size (if not NULL).
+ */
+uint8_t _anjay_bench_request(anjay_bench_t *bench,
+                             const anjay_bench_coap_msg_t *msg,
+                             size_t *out_payload_size);
+
+/** Real (not mocked) monotonic clock, in nanoseconds. */
+int64_t _anjay_bench_now_ns(void);
+
+/**
+ * Reports a single result as one line of JSON, either to the file pointed to
+ * by the ANJAY_BENCHMARK_OUTPUT environment variable, or to stdout.
+ * @p bytes is the amount of payload processed in total; 0 if not applicable.
+ */
+void _anjay_bench_report(const char *benchmark,
+                         const char *variant,
+                         size_t iterations,
+                         int64_t elapsed_ns,
+                         uint64_t bytes);
+
+/**
+ * Makes the current heap usage the baseline for _anjay_bench_heap_peak().
+ * Heap usage is tracked by overriding malloc() and friends; this is only
+ * supported with glibc.
+ */
+void _anjay_bench_heap_reset_peak(void);
+
+/**
+ * Returns the highest heap usage, in bytes, observed since the last call to
+ * _anjay_bench_heap_reset_peak(). Always returns 0 if heap usage is not
+ * tracked.
+ */
+size_t _anjay_bench_heap_peak(void);
+
+/**
+ * Reports @p peak_bytes (as returned by _anjay_bench_heap_peak()) as the
+ * "bytes" field of a result with "_peak_heap" appended to @p variant.
+ */
+void _anjay_bench_report_heap(const char *benchmark,
+                              const char *variant,
+                              size_t peak_bytes);
+
+#endif /* ANJAY_BENCHMARKS_UTILS_H */
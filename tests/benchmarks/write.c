@@ -0,0 +1,202 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include <avsystem/coap/code.h>
+#include <avsystem/coap/option.h>
+
+#include "tests/benchmarks/utils.h"
+
+#define BLOB_SIZE (64 * 1024)
+#define BLOB_ITERATIONS 50
+
+static void write_blockwise(anjay_bench_t *bench,
+                            const char *benchmark,
+                            const char *variant,
+                            const anjay_bench_coap_msg_t *msg,
+                            size_t iterations) {
+    const int64_t start_ns = _anjay_bench_now_ns();
+    for (size_t i = 0; i < iterations; ++i) {
+        AVS_UNIT_ASSERT_EQUAL(_anjay_bench_request(bench, msg, NULL),
+                              AVS_COAP_CODE_CHANGED);
+    }
+    _anjay_bench_report(benchmark, variant, iterations,
+                        _anjay_bench_now_ns() - start_ns,
+                        (uint64_t) (msg->payload_size * iterations));
+}
+
+AVS_UNIT_TEST(benchmarks, write_blockwise_opaque) {
+    anjay_bench_t bench;
+    _anjay_bench_init(&bench, 0, 0);
+
+    uint8_t *payload = (uint8_t *) avs_malloc(BLOB_SIZE);
+    AVS_UNIT_ASSERT_NOT_NULL(payload);
+    for (size_t i = 0; i < BLOB_SIZE; ++i) {
+        payload[i] = (uint8_t) (i * 7);
+    }
+
+    char path[16];
+    snprintf(path, sizeof(path), "%d/0/0", BENCH_BLOB_OID);
+    anjay_bench_coap_msg_t msg = ANJAY_BENCH_COAP_MSG_EMPTY;
+    msg.code = AVS_COAP_CODE_PUT;
+    msg.uri_path = path;
+    msg.content_format = AVS_COAP_FORMAT_OCTET_STREAM;
+    msg.payload = payload;
+    msg.payload_size = BLOB_SIZE;
+    write_blockwise(&bench, "write_blockwise", "opaque", &msg,
+                    BLOB_ITERATIONS);
+
+    avs_free(payload);
+    _anjay_bench_finish(&bench);
+}
+
+#if defined(ANJAY_WITH_LWM2M11) && !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
+
+#    define COMPOSITE_INSTANCE_COUNT 200
+#    define COMPOSITE_ITERATIONS 20
+
+static void write_composite(const char *variant,
+                            uint16_t format,
+                            const uint8_t *payload,
+                            size_t payload_size) {
+    anjay_bench_t bench;
+    _anjay_bench_init(&bench, COMPOSITE_INSTANCE_COUNT, 0);
+
+    anjay_bench_coap_msg_t msg = ANJAY_BENCH_COAP_MSG_EMPTY;
+    msg.code = AVS_COAP_CODE_IPATCH;
+    msg.content_format = format;
+    msg.payload = payload;
+    msg.payload_size = payload_size;
+    write_blockwise(&bench, "write_composite", variant, &msg,
+                    COMPOSITE_ITERATIONS);
+
+    _anjay_bench_finish(&bench);
+}
+
+#    ifdef ANJAY_WITH_SENML_JSON
+AVS_UNIT_TEST(benchmarks, write_composite_senml_json) {
+    const size_t buf_size = COMPOSITE_INSTANCE_COUNT * 128;
+    char *payload = (char *) avs_malloc(buf_size);
+    AVS_UNIT_ASSERT_NOT_NULL(payload);
+    size_t offset = 0;
+    payload[offset++] = '[';
+    for (anjay_iid_t iid = 0; iid < COMPOSITE_INSTANCE_COUNT; ++iid) {
+        int result = snprintf(
+                payload + offset, buf_size - offset,
+                "%s{\"n\":\"/%d/%" PRIu16 "/0\",\"v\":%" PRIu16 "},"
+                "{\"n\":\"/%d/%" PRIu16 "/1\",\"vs\":\"value %" PRIu16 "\"},"
+                "{\"n\":\"/%d/%" PRIu16 "/2\",\"v\":%" PRIu16 ".5}",
+                iid ? "," : "", BENCH_OID, iid, iid, BENCH_OID, iid, iid,
+                BENCH_OID, iid, iid);
+        AVS_UNIT_ASSERT_TRUE(result > 0
+                             && (size_t) result < buf_size - offset - 1);
+        offset += (size_t) result;
+    }
+    payload[offset++] = ']';
+
+    write_composite("senml_json", AVS_COAP_FORMAT_SENML_JSON,
+                    (const uint8_t *) payload, offset);
+    avs_free(payload);
+}
+#    endif // ANJAY_WITH_SENML_JSON
+
+#    ifdef ANJAY_WITH_CBOR
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t offset;
+} cbor_writer_t;
+
+static void
+cbor_write_header(cbor_writer_t *writer, uint8_t major_type, uint32_t value) {
+    AVS_UNIT_ASSERT_TRUE(writer->offset + 5 <= writer->size);
+    uint8_t *ptr = writer->buf + writer->offset;
+    if (value < 24) {
+        *ptr = (uint8_t) (major_type << 5 | value);
+        writer->offset += 1;
+    } else if (value <= UINT8_MAX) {
+        ptr[0] = (uint8_t) (major_type << 5 | 24);
+        ptr[1] = (uint8_t) value;
+        writer->offset += 2;
+    } else if (value <= UINT16_MAX) {
+        ptr[0] = (uint8_t) (major_type << 5 | 25);
+        ptr[1] = (uint8_t) (value >> 8);
+        ptr[2] = (uint8_t) value;
+        writer->offset += 3;
+    } else {
+        ptr[0] = (uint8_t) (major_type << 5 | 26);
+        ptr[1] = (uint8_t) (value >> 24);
+        ptr[2] = (uint8_t) (value >> 16);
+        ptr[3] = (uint8_t) (value >> 8);
+        ptr[4] = (uint8_t) value;
+        writer->offset += 5;
+    }
+}
+
+static void cbor_write_string(cbor_writer_t *writer, const char *value) {
+    const size_t length = strlen(value);
+    cbor_write_header(writer, 3, (uint32_t) length);
+    AVS_UNIT_ASSERT_TRUE(writer->offset + length <= writer->size);
+    memcpy(writer->buf + writer->offset, value, length);
+    writer->offset += length;
+}
+
+// SenML CBOR labels, see RFC 8428, Table 6
+#        define SENML_LABEL_NAME 0
+#        define SENML_LABEL_VALUE 2
+#        define SENML_LABEL_STRING_VALUE 3
+
+static void cbor_write_record(cbor_writer_t *writer,
+                              anjay_iid_t iid,
+                              anjay_rid_t rid) {
+    char buf[32];
+    cbor_write_header(writer, 5, 2);
+    cbor_write_header(writer, 0, SENML_LABEL_NAME);
+    snprintf(buf, sizeof(buf), "/%d/%" PRIu16 "/%" PRIu16, BENCH_OID, iid,
+             rid);
+    cbor_write_string(writer, buf);
+    if (rid == 1) {
+        cbor_write_header(writer, 0, SENML_LABEL_STRING_VALUE);
+        snprintf(buf, sizeof(buf), "value %" PRIu16, iid);
+        cbor_write_string(writer, buf);
+    } else {
+        cbor_write_header(writer, 0, SENML_LABEL_VALUE);
+        cbor_write_header(writer, 0, iid);
+    }
+}
+
+AVS_UNIT_TEST(benchmarks, write_composite_senml_cbor) {
+    cbor_writer_t writer = {
+        .size = COMPOSITE_INSTANCE_COUNT * 96
+    };
+    AVS_UNIT_ASSERT_NOT_NULL(
+            (writer.buf = (uint8_t *) avs_malloc(writer.size)));
+    cbor_write_header(&writer, 4, 3 * COMPOSITE_INSTANCE_COUNT);
+    for (anjay_iid_t iid = 0; iid < COMPOSITE_INSTANCE_COUNT; ++iid) {
+        for (anjay_rid_t rid = 0; rid < 3; ++rid) {
+            cbor_write_record(&writer, iid, rid);
+        }
+    }
+
+    write_composite("senml_cbor", AVS_COAP_FORMAT_SENML_CBOR, writer.buf,
+                    writer.offset);
+    avs_free(writer.buf);
+}
+#    endif // ANJAY_WITH_CBOR
+
+#endif // defined(ANJAY_WITH_LWM2M11) &&
+       // !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
@@ -11,6 +11,7 @@
 
 #include <avsystem/commons/avs_stream.h>
 #include <avsystem/commons/avs_stream_inbuf.h>
+#include <avsystem/commons/avs_stream_membuf.h>
 #include <avsystem/commons/avs_stream_outbuf.h>
 #include <avsystem/commons/avs_unit_test.h>
 
@@ -1013,3 +1014,197 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_duplicate_oid) {
 }
 
 // TODO: Actually test removing nonexistent IIDs and RIDs
+
+static void write_journal_test_attrs(anjay_unlocked_t *anjay,
+                                     anjay_oid_t oid,
+                                     anjay_iid_t iid,
+                                     int32_t min_period) {
+    anjay_dm_oi_attributes_t attrs = ANJAY_DM_OI_ATTRIBUTES_EMPTY;
+    attrs.min_period = min_period;
+    write_inst_attrs(anjay, oid, iid, 2, &attrs);
+}
+
+static as_object_entry_t *journal_test_object_entry(anjay_oid_t oid,
+                                                    anjay_iid_t iid,
+                                                    int32_t min_period) {
+    return test_object_entry(
+            oid, NULL,
+            test_instance_entry(
+                    iid,
+                    test_default_attrs(2, min_period, ANJAY_ATTRIB_INTEGER_NONE,
+                                       ANJAY_ATTRIB_INTEGER_NONE,
+                                       ANJAY_ATTRIB_INTEGER_NONE,
+                                       ANJAY_DM_CON_ATTR_NONE),
+                    NULL),
+            NULL);
+}
+
+static void journal_test_append(avs_stream_t *snapshot,
+                                avs_stream_t *journal) {
+    anjay_t *anjay = _anjay_test_dm_init(DM_TEST_CONFIGURATION());
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    INSTALL_FAKE_OBJECT(42);
+    INSTALL_FAKE_OBJECT(43);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    write_journal_test_attrs(anjay_unlocked, 42, 1, 10);
+    write_journal_test_attrs(anjay_unlocked, 43, 1, 20);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_attr_storage_persist(anjay, snapshot));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.journal_dirty);
+    write_journal_test_attrs(anjay_unlocked, 42, 1, 11);
+    AVS_UNIT_ASSERT_EQUAL(
+            AVS_LIST_SIZE(anjay_unlocked->attr_storage.journal_dirty), 1);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.journal_dirty->oid, 42);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->attr_storage.journal_dirty->iid, 1);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_attr_storage_journal_append(anjay, journal));
+    AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
+    PERSISTENCE_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(attr_storage_persistence, journal_append_and_restore) {
+    avs_stream_t *snapshot = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(snapshot);
+    char journal_buf[256];
+    avs_stream_outbuf_t journal_outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+    avs_stream_outbuf_set_buffer(&journal_outbuf, journal_buf,
+                                 sizeof(journal_buf));
+    journal_test_append(snapshot, (avs_stream_t *) &journal_outbuf);
+
+    // only /42/1 is recorded in the journal
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(&journal_buf[4],
+                                      "\x05"             // version
+                                      "\x00\x00\x00\x01" // 1 entry
+                                      "I"                // Instance entry
+                                      "\x00\x2A"         // OID 42
+                                      "\x00\x01",        // IID 1
+                                      10);
+    avs_stream_inbuf_t journal = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&journal, journal_buf,
+                                avs_stream_outbuf_offset(&journal_outbuf));
+
+    anjay_t *anjay = _anjay_test_dm_init(DM_TEST_CONFIGURATION());
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    INSTALL_FAKE_OBJECT(42);
+    INSTALL_FAKE_OBJECT(43);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ42, 0, (const anjay_iid_t[]) { 1, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(anjay, &OBJ42, 1, 0,
+                                         (const anjay_mock_dm_res_entry_t[]) {
+                                                 ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ43, 0, (const anjay_iid_t[]) { 1, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(anjay, &OBJ43, 1, 0,
+                                         (const anjay_mock_dm_res_entry_t[]) {
+                                                 ANJAY_MOCK_DM_RES_END });
+    AVS_UNIT_ASSERT_SUCCESS(anjay_attr_storage_journal_restore(
+            anjay, snapshot, (avs_stream_t *) &journal));
+    AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+                          2);
+    assert_object_equal(anjay_unlocked->attr_storage.objects,
+                        journal_test_object_entry(42, 1, 11));
+    assert_object_equal(AVS_LIST_NEXT(anjay_unlocked->attr_storage.objects),
+                        journal_test_object_entry(43, 1, 20));
+    ANJAY_MUTEX_UNLOCK(anjay);
+    PERSISTENCE_TEST_FINISH;
+
+    avs_stream_cleanup(&snapshot);
+}
+
+static void journal_restore_and_check(const char *journal_data,
+                                      size_t journal_size,
+                                      anjay_iid_t expected_iid,
+                                      int32_t expected_min_period) {
+    avs_stream_inbuf_t journal = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&journal, journal_data, journal_size);
+    anjay_t *anjay = _anjay_test_dm_init(DM_TEST_CONFIGURATION());
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    INSTALL_FAKE_OBJECT(42);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ42, 0, (const anjay_iid_t[]) { 1, 2, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(anjay, &OBJ42, expected_iid, 0,
+                                         (const anjay_mock_dm_res_entry_t[]) {
+                                                 ANJAY_MOCK_DM_RES_END });
+    AVS_UNIT_ASSERT_SUCCESS(anjay_attr_storage_journal_restore(
+            anjay, NULL, (avs_stream_t *) &journal));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+                          1);
+    assert_object_equal(anjay_unlocked->attr_storage.objects,
+                        journal_test_object_entry(42, expected_iid,
+                                                  expected_min_period));
+    ANJAY_MUTEX_UNLOCK(anjay);
+    PERSISTENCE_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(attr_storage_persistence, journal_incomplete_record_ignored) {
+    PERSIST_TEST_INIT(256);
+    INSTALL_FAKE_OBJECT(42);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    write_journal_test_attrs(anjay_unlocked, 42, 1, 10);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_attr_storage_journal_append(anjay, (avs_stream_t *) &outbuf));
+    const size_t first_append_size = avs_stream_outbuf_offset(&outbuf);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    write_inst_attrs(anjay_unlocked, 42, 1, 2, &ANJAY_DM_OI_ATTRIBUTES_EMPTY);
+    write_journal_test_attrs(anjay_unlocked, 42, 2, 30);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_attr_storage_journal_append(anjay, (avs_stream_t *) &outbuf));
+    const size_t journal_size = avs_stream_outbuf_offset(&outbuf);
+    PERSISTENCE_TEST_FINISH;
+
+    journal_restore_and_check(buf, journal_size, 2, 30);
+    // power loss at any point while appending the second record
+    for (size_t size = first_append_size; size < journal_size; ++size) {
+        journal_restore_and_check(buf, size, 1, 10);
+    }
+    // corrupted last record
+    buf[journal_size - 5] ^= 0x01;
+    journal_restore_and_check(buf, journal_size, 1, 10);
+}
+
+AVS_UNIT_TEST(attr_storage_persistence, journal_purge) {
+    avs_stream_t *snapshot = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(snapshot);
+    PERSIST_TEST_INIT(256);
+    INSTALL_FAKE_OBJECT(42);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    write_journal_test_attrs(anjay_unlocked, 42, 1, 10);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_attr_storage_persist(anjay, snapshot));
+    anjay_attr_storage_purge(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_attr_storage_journal_append(anjay, (avs_stream_t *) &outbuf));
+    // there is nothing left after the purge entry
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&outbuf), 14);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf,
+                                      "\x00\x00\x00\x06" // payload size
+                                      "\x05"             // version
+                                      "\x00\x00\x00\x01" // 1 entry
+                                      "P",               // purge
+                                      10);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    write_journal_test_attrs(anjay_unlocked, 42, 1, 11);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    avs_stream_inbuf_t journal = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&journal, buf,
+                                avs_stream_outbuf_offset(&outbuf));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_attr_storage_journal_restore(
+            anjay, snapshot, (avs_stream_t *) &journal));
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    PERSISTENCE_TEST_FINISH;
+    avs_stream_cleanup(&snapshot);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <inttypes.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+static int store_test_args(deferred_log_entry_t *entry,
+                           const char *format,
+                           ...) {
+    memset(entry, 0, sizeof(*entry));
+    entry->format = format;
+    va_list ap;
+    va_start(ap, format);
+    int result = store_args(entry, format, &ap);
+    va_end(ap);
+    return result;
+}
+
+#define ASSERT_DEFERRED_FORMAT(Expected, ...)                                 \
+    do {                                                                      \
+        deferred_log_entry_t entry;                                           \
+        char message[AVS_COMMONS_LOG_MAX_LINE_LENGTH];                        \
+        AVS_UNIT_ASSERT_SUCCESS(store_test_args(&entry, __VA_ARGS__));        \
+        format_entry(&entry, message, sizeof(message));                       \
+        AVS_UNIT_ASSERT_EQUAL_STRING(message, (Expected));                    \
+    } while (0)
+
+AVS_UNIT_TEST(deferred_log, format) {
+    ASSERT_DEFERRED_FORMAT("no arguments", "no arguments");
+    ASSERT_DEFERRED_FORMAT("/3/0/1 = -5, 100%",
+                           "/%u/%u/%" PRIu16 " = %d, %d%%", 3u, 0u,
+                           (uint16_t) 1, -5, 100);
+    ASSERT_DEFERRED_FORMAT("18446744073709551615 -3 99 ff",
+                           "%" PRIu64 " %ld %zu %x", UINT64_MAX, -3L,
+                           (size_t) 99, 255u);
+    ASSERT_DEFERRED_FORMAT("000000012|3    |+3.142", "%09ld|%-5d|%+.3f", 12L,
+                           3, 3.14159);
+    ASSERT_DEFERRED_FORMAT("abc|    42|x", "%.*s|%*d|%c", 3, "abcdef", 6, 42,
+                           'x');
+    ASSERT_DEFERRED_FORMAT("(null)", "%s", (const char *) NULL);
+    ASSERT_DEFERRED_FORMAT("44 4464", "%hhu %hd", 300, 70000);
+}
+
+AVS_UNIT_TEST(deferred_log, format_unsupported) {
+    deferred_log_entry_t entry;
+    int count;
+    AVS_UNIT_ASSERT_FAILED(store_test_args(&entry, "%n", &count));
+
+    char long_string[DEFERRED_LOG_ARGS_SIZE + 1];
+    memset(long_string, 'x', sizeof(long_string) - 1);
+    long_string[sizeof(long_string) - 1] = '\0';
+    AVS_UNIT_ASSERT_FAILED(store_test_args(&entry, "%s", long_string));
+}
+
+AVS_UNIT_TEST(deferred_log, flush) {
+    anjay_deferred_log_flush();
+    // filters are applied both when logging and when flushing; the latter
+    // keeps the test output clean
+    avs_log_set_level(deferred_log_test, AVS_LOG_ERROR);
+
+    for (size_t i = 0; i < ANJAY_DEFERRED_LOG_BUFFER_ENTRIES + 2; ++i) {
+        _anjay_deferred_log(AVS_LOG_ERROR, "deferred_log_test", __FILE__,
+                            __LINE__, "message %u", (unsigned) i);
+    }
+    AVS_UNIT_ASSERT_EQUAL(atomic_load(&g_deferred_log.dropped), 2);
+    avs_log_set_level(deferred_log_test, AVS_LOG_QUIET);
+    AVS_UNIT_ASSERT_EQUAL(anjay_deferred_log_flush(),
+                          ANJAY_DEFERRED_LOG_BUFFER_ENTRIES);
+    AVS_UNIT_ASSERT_EQUAL(atomic_load(&g_deferred_log.dropped), 0);
+
+    // messages that cannot be deferred are formatted at the call site
+    char long_string[DEFERRED_LOG_ARGS_SIZE + 1];
+    memset(long_string, 'x', sizeof(long_string) - 1);
+    long_string[sizeof(long_string) - 1] = '\0';
+    avs_log_set_level(deferred_log_test, AVS_LOG_ERROR);
+    _anjay_deferred_log(AVS_LOG_ERROR, "deferred_log_test", __FILE__, __LINE__,
+                        "%s", long_string);
+    avs_log_set_level(deferred_log_test, AVS_LOG_QUIET);
+    AVS_UNIT_ASSERT_EQUAL(anjay_deferred_log_flush(), 1);
+    AVS_UNIT_ASSERT_EQUAL(anjay_deferred_log_flush(), 0);
+}
+
+static unsigned g_lazy_evaluations;
+
+static unsigned lazy_argument(void) {
+    return ++g_lazy_evaluations;
+}
+
+AVS_UNIT_TEST(deferred_log, lazy_levels) {
+    anjay_deferred_log_flush();
+    g_lazy_evaluations = 0;
+
+    // arguments of filtered out messages are not evaluated
+    avs_log_set_level(deferred_log_test, AVS_LOG_INFO);
+    _anjay_log(deferred_log_test, LAZY_TRACE, "lazy %u", lazy_argument());
+    _anjay_log(deferred_log_test, LAZY_DEBUG, "lazy %u", lazy_argument());
+    AVS_UNIT_ASSERT_EQUAL(g_lazy_evaluations, 0);
+    AVS_UNIT_ASSERT_EQUAL(anjay_deferred_log_flush(), 0);
+
+    avs_log_set_level(deferred_log_test, AVS_LOG_DEBUG);
+    _anjay_log(deferred_log_test, LAZY_DEBUG, "lazy %u", lazy_argument());
+    _anjay_log(deferred_log_test, LAZY_INFO, "lazy %u", lazy_argument());
+    _anjay_log(deferred_log_test, LAZY_WARNING, "lazy %u", lazy_argument());
+    _anjay_log(deferred_log_test, LAZY_ERROR, "lazy %u", lazy_argument());
+    AVS_UNIT_ASSERT_EQUAL(g_lazy_evaluations, 4);
+    avs_log_set_level(deferred_log_test, AVS_LOG_QUIET);
+    AVS_UNIT_ASSERT_EQUAL(anjay_deferred_log_flush(), 4);
+}
@@ -0,0 +1,293 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <limits.h>
+
+#ifdef ANJAY_WITH_THREAD_SAFETY
+#    include <pthread.h>
+#endif // ANJAY_WITH_THREAD_SAFETY
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include <anjay/core.h>
+
+typedef struct {
+    char written[64];
+    size_t written_size;
+    size_t write_calls;
+    int fail_after;
+    int failure_result;
+    size_t failure_calls;
+} test_sink_t;
+
+static int test_write(anjay_unlocked_t *anjay,
+                      const void *data,
+                      size_t length,
+                      void *sink_) {
+    (void) anjay;
+    test_sink_t *sink = (test_sink_t *) sink_;
+    if (sink->fail_after >= 0
+            && (int) sink->write_calls++ >= sink->fail_after) {
+        return -42;
+    }
+    AVS_UNIT_ASSERT_TRUE(sink->written_size + length <= sizeof(sink->written));
+    memcpy(sink->written + sink->written_size, data, length);
+    sink->written_size += length;
+    return 0;
+}
+
+static void test_failed(anjay_unlocked_t *anjay, int result, void *sink_) {
+    (void) anjay;
+    test_sink_t *sink = (test_sink_t *) sink_;
+    sink->failure_result = result;
+    ++sink->failure_calls;
+}
+
+#define SCOPED_WRITER_TEST_ENV(MaxQueuedBytes)                    \
+    const anjay_configuration_t configuration = {                 \
+        .endpoint_name = "test"                                   \
+    };                                                            \
+    anjay_t *anjay = anjay_new(&configuration);                   \
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);                              \
+    test_sink_t sink = {                                          \
+        .fail_after = -1                                          \
+    };                                                            \
+    anjay_deferred_writer_t *writer = NULL;                       \
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);                      \
+    writer = _anjay_deferred_writer_new(anjay_unlocked,           \
+                                        (MaxQueuedBytes),         \
+                                        test_write, test_failed,  \
+                                        &sink);                   \
+    ANJAY_MUTEX_UNLOCK(anjay);                                    \
+    AVS_UNIT_ASSERT_NOT_NULL(writer)
+
+#define WRITER_TEST_FINISH                        \
+    do {                                          \
+        ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);  \
+        _anjay_deferred_writer_delete(&writer);   \
+        ANJAY_MUTEX_UNLOCK(anjay);                \
+        anjay_delete(anjay);                      \
+    } while (0)
+
+static int locked_write(anjay_t *anjay,
+                        anjay_deferred_writer_t *writer,
+                        const char *data) {
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    result = _anjay_deferred_writer_write(writer, data, strlen(data));
+    ANJAY_MUTEX_UNLOCK(anjay);
+    return result;
+}
+
+static int locked_flush(anjay_t *anjay, anjay_deferred_writer_t *writer) {
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    result = _anjay_deferred_writer_flush(writer);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    return result;
+}
+
+static void run_scheduler(anjay_t *anjay) {
+    while (!anjay_sched_calculate_wait_time_ms(anjay, INT_MAX)) {
+        anjay_sched_run(anjay);
+    }
+}
+
+AVS_UNIT_TEST(deferred_writer, written_from_scheduler) {
+    SCOPED_WRITER_TEST_ENV(16);
+    AVS_UNIT_ASSERT_SUCCESS(locked_write(anjay, writer, "abc"));
+    AVS_UNIT_ASSERT_SUCCESS(locked_write(anjay, writer, "def"));
+    AVS_UNIT_ASSERT_EQUAL(sink.written_size, 0);
+
+    run_scheduler(anjay);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(sink.written, "abcdef", 6);
+    AVS_UNIT_ASSERT_EQUAL(sink.written_size, 6);
+    AVS_UNIT_ASSERT_EQUAL(sink.failure_calls, 0);
+    WRITER_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(deferred_writer, full_queue_is_drained_synchronously) {
+    SCOPED_WRITER_TEST_ENV(8);
+    AVS_UNIT_ASSERT_SUCCESS(locked_write(anjay, writer, "abcd"));
+    AVS_UNIT_ASSERT_SUCCESS(locked_write(anjay, writer, "efgh"));
+    AVS_UNIT_ASSERT_EQUAL(sink.written_size, 0);
+
+    // does not fit - the oldest block has to be written first
+    AVS_UNIT_ASSERT_SUCCESS(locked_write(anjay, writer, "ij"));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(sink.written, "abcd", 4);
+    AVS_UNIT_ASSERT_EQUAL(sink.written_size, 4);
+
+    // larger than the whole queue - written synchronously, in order
+    AVS_UNIT_ASSERT_SUCCESS(locked_write(anjay, writer, "klmnopqrstu"));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(sink.written, "abcdefghijklmnopqrstu",
+                                      21);
+    AVS_UNIT_ASSERT_EQUAL(sink.written_size, 21);
+    WRITER_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(deferred_writer, flush) {
+    SCOPED_WRITER_TEST_ENV(16);
+    AVS_UNIT_ASSERT_SUCCESS(locked_write(anjay, writer, "abc"));
+    AVS_UNIT_ASSERT_SUCCESS(locked_write(anjay, writer, "def"));
+    AVS_UNIT_ASSERT_SUCCESS(locked_flush(anjay, writer));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(sink.written, "abcdef", 6);
+
+    // nothing left for the scheduler
+    run_scheduler(anjay);
+    AVS_UNIT_ASSERT_EQUAL(sink.written_size, 6);
+    WRITER_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(deferred_writer, deferred_failure) {
+    SCOPED_WRITER_TEST_ENV(16);
+    sink.fail_after = 1;
+    AVS_UNIT_ASSERT_SUCCESS(locked_write(anjay, writer, "abc"));
+    AVS_UNIT_ASSERT_SUCCESS(locked_write(anjay, writer, "def"));
+    AVS_UNIT_ASSERT_SUCCESS(locked_write(anjay, writer, "ghi"));
+
+    run_scheduler(anjay);
+    AVS_UNIT_ASSERT_EQUAL(sink.failure_calls, 1);
+    AVS_UNIT_ASSERT_EQUAL(sink.failure_result, -42);
+    AVS_UNIT_ASSERT_EQUAL(sink.written_size, 3);
+
+    // remaining blocks are discarded and the error is sticky
+    AVS_UNIT_ASSERT_EQUAL(locked_write(anjay, writer, "jkl"), -42);
+    AVS_UNIT_ASSERT_EQUAL(locked_flush(anjay, writer), -42);
+    run_scheduler(anjay);
+    AVS_UNIT_ASSERT_EQUAL(sink.failure_calls, 1);
+    AVS_UNIT_ASSERT_EQUAL(sink.written_size, 3);
+    WRITER_TEST_FINISH;
+}
+
+#ifdef ANJAY_WITH_THREAD_SAFETY
+typedef struct {
+    // first member, so that test_failed() can be used
+    test_sink_t sink;
+    anjay_t *anjay;
+    anjay_deferred_writer_t *writer;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool write_started;
+    bool write_released;
+    bool flush_started;
+    int flush_result;
+} threaded_test_t;
+
+static void threaded_test_set(threaded_test_t *test, bool *flag) {
+    pthread_mutex_lock(&test->mutex);
+    *flag = true;
+    pthread_cond_broadcast(&test->cond);
+    pthread_mutex_unlock(&test->mutex);
+}
+
+static void threaded_test_wait(threaded_test_t *test, const bool *flag) {
+    pthread_mutex_lock(&test->mutex);
+    while (!*flag) {
+        pthread_cond_wait(&test->cond, &test->mutex);
+    }
+    pthread_mutex_unlock(&test->mutex);
+}
+
+// NOTE: AVS_UNIT_ASSERT_* may only be used in the main thread
+static int gated_write(anjay_unlocked_t *anjay,
+                       const void *data,
+                       size_t length,
+                       void *test_) {
+    threaded_test_t *test = (threaded_test_t *) test_;
+    int result = 0;
+    // releases the mutex, just like user_state_stream_write() in the firmware
+    // update module
+    ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
+    if (!test->sink.write_calls++) {
+        threaded_test_set(test, &test->write_started);
+        threaded_test_wait(test, &test->write_released);
+    }
+    if (test->sink.written_size + length > sizeof(test->sink.written)) {
+        result = -1;
+    } else {
+        memcpy(test->sink.written + test->sink.written_size, data, length);
+        test->sink.written_size += length;
+    }
+    ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
+    return result;
+}
+
+static void *download_write_block_thread(void *test_) {
+    threaded_test_t *test = (threaded_test_t *) test_;
+    // too large to be queued, so everything is written synchronously
+    (void) locked_write(test->anjay, test->writer, "defgh");
+    return NULL;
+}
+
+static void *download_finished_thread(void *test_) {
+    threaded_test_t *test = (threaded_test_t *) test_;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, test->anjay);
+    // set with the Anjay mutex locked, so that once the main thread locks it,
+    // this thread is known to be waiting for the write to finish
+    threaded_test_set(test, &test->flush_started);
+    test->flush_result = _anjay_deferred_writer_flush(test->writer);
+    _anjay_deferred_writer_delete(&test->writer);
+    ANJAY_MUTEX_UNLOCK(test->anjay);
+    return NULL;
+}
+
+AVS_UNIT_TEST(deferred_writer, flush_and_delete_wait_for_write_in_progress) {
+    const anjay_configuration_t configuration = {
+        .endpoint_name = "test"
+    };
+    threaded_test_t test = {
+        .sink = {
+            .fail_after = -1
+        },
+        .anjay = anjay_new(&configuration),
+        .flush_result = -1
+    };
+    AVS_UNIT_ASSERT_NOT_NULL(test.anjay);
+    AVS_UNIT_ASSERT_SUCCESS(pthread_mutex_init(&test.mutex, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(pthread_cond_init(&test.cond, NULL));
+    ANJAY_MUTEX_LOCK(anjay_unlocked, test.anjay);
+    test.writer = _anjay_deferred_writer_new(anjay_unlocked, 4, gated_write,
+                                             test_failed, &test);
+    ANJAY_MUTEX_UNLOCK(test.anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(test.writer);
+
+    AVS_UNIT_ASSERT_SUCCESS(locked_write(test.anjay, test.writer, "abc"));
+    pthread_t write_thread;
+    AVS_UNIT_ASSERT_SUCCESS(pthread_create(&write_thread, NULL,
+                                           download_write_block_thread, &test));
+    threaded_test_wait(&test, &test.write_started);
+
+    // "abc" is being written with the Anjay mutex released
+    pthread_t finished_thread;
+    AVS_UNIT_ASSERT_SUCCESS(pthread_create(&finished_thread, NULL,
+                                           download_finished_thread, &test));
+    threaded_test_wait(&test, &test.flush_started);
+    bool writer_deleted = true;
+    size_t written_size = SIZE_MAX;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, test.anjay);
+    writer_deleted = !test.writer;
+    written_size = test.sink.written_size;
+    ANJAY_MUTEX_UNLOCK(test.anjay);
+    AVS_UNIT_ASSERT_FALSE(writer_deleted);
+    AVS_UNIT_ASSERT_EQUAL(written_size, 0);
+
+    threaded_test_set(&test, &test.write_released);
+    AVS_UNIT_ASSERT_SUCCESS(pthread_join(write_thread, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(pthread_join(finished_thread, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(test.flush_result);
+    AVS_UNIT_ASSERT_NULL(test.writer);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(test.sink.written, "abcdefgh", 8);
+    AVS_UNIT_ASSERT_EQUAL(test.sink.written_size, 8);
+    AVS_UNIT_ASSERT_EQUAL(test.sink.failure_calls, 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(pthread_cond_destroy(&test.cond));
+    AVS_UNIT_ASSERT_SUCCESS(pthread_mutex_destroy(&test.mutex));
+    anjay_delete(test.anjay);
+}
+#endif // ANJAY_WITH_THREAD_SAFETY
@@ -158,6 +158,63 @@ AVS_UNIT_TEST(dm_read, resource) {
     DM_TEST_FINISH;
 }
 
+#ifdef ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES
+static void expect_read_res_69_4(anjay_t *anjay,
+                                 const anjay_mock_dm_data_t *data) {
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0,
+            (const anjay_iid_t[]) { 14, 42, 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 69, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    { 5, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        data);
+}
+
+AVS_UNIT_TEST(dm_read, blockwise_does_not_block_other_servers) {
+#    define LONG_STRING "Lorem ipsum dolor sit amet, consectetur"
+    DM_TEST_INIT_WITH_SSIDS(1, 2);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42", "69", "4"),
+                    BLOCK2(0, 16, ""));
+    expect_read_res_69_4(anjay, ANJAY_MOCK_DM_STRING(0, LONG_STRING));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3E),
+                            CONTENT_FORMAT(PLAINTEXT),
+                            BLOCK2(0, 16, LONG_STRING));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    // the other server is served while the first transfer is still ongoing
+    DM_TEST_REQUEST(mocksocks[1], CON, GET, ID(0xFA3F), PATH("42", "69", "4"),
+                    NO_PAYLOAD);
+    expect_read_res_69_4(anjay, ANJAY_MOCK_DM_INT(0, 514));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[1], ACK, CONTENT, ID(0xFA3F),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[1], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[1]));
+
+    // further blocks are served without calling the data model again
+    for (uint16_t seq = 1; seq < 3; ++seq) {
+        DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3F + seq),
+                        PATH("42", "69", "4"), BLOCK2(seq, 16, ""));
+        DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3F + seq),
+                                CONTENT_FORMAT(PLAINTEXT),
+                                BLOCK2(seq, 16, LONG_STRING));
+        expect_has_buffered_data_check(mocksocks[0], false);
+        AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    }
+    DM_TEST_FINISH;
+#    undef LONG_STRING
+}
+#endif // ANJAY_WITH_ASYNC_BLOCKWISE_RESPONSES
+
 AVS_UNIT_TEST(dm_read, resource_read_err_concrete) {
     DM_TEST_INIT;
     DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42", "69", "4"),
@@ -238,6 +295,109 @@ AVS_UNIT_TEST(dm_read, resource_not_found_because_not_present) {
     DM_TEST_FINISH;
 }
 
+static const anjay_dm_resource_def_t RESOURCE_TABLE[] = {
+    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+    { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT }
+};
+
+// no list_resources handler - any attempt to call it would fail the tests
+static const anjay_dm_object_def_t *const OBJ_WITH_RESOURCE_TABLE =
+        &(const anjay_dm_object_def_t) {
+            .oid = 77,
+            .handlers = {
+                .list_instances = _anjay_mock_dm_list_instances,
+                .resource_read = _anjay_mock_dm_resource_read
+            },
+            .resources = RESOURCE_TABLE,
+            .resources_count = AVS_ARRAY_SIZE(RESOURCE_TABLE)
+        };
+
+AVS_UNIT_TEST(dm_read, resource_from_resource_table) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ_WITH_RESOURCE_TABLE, &FAKE_SECURITY,
+                              &FAKE_SERVER);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("77", "69", "4"),
+                    NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ_WITH_RESOURCE_TABLE, 0,
+            (const anjay_iid_t[]) { 14, 42, 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ_WITH_RESOURCE_TABLE, 69, 4,
+                                        ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 514));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3E),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_read, resource_absent_in_resource_table) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ_WITH_RESOURCE_TABLE, &FAKE_SECURITY,
+                              &FAKE_SERVER);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("77", "69", "0"),
+                    NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ_WITH_RESOURCE_TABLE, 0,
+            (const anjay_iid_t[]) { 14, 42, 69, ANJAY_ID_INVALID });
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, NOT_FOUND, ID(0xFA3E),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_read, resource_not_in_resource_table) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ_WITH_RESOURCE_TABLE, &FAKE_SECURITY,
+                              &FAKE_SERVER);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("77", "69", "5"),
+                    NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ_WITH_RESOURCE_TABLE, 0,
+            (const anjay_iid_t[]) { 14, 42, 69, ANJAY_ID_INVALID });
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, NOT_FOUND, ID(0xFA3E),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_read, instance_from_resource_table) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ_WITH_RESOURCE_TABLE, &FAKE_SECURITY,
+                              &FAKE_SERVER);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("77", "69"),
+                    NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ_WITH_RESOURCE_TABLE, 0,
+            (const anjay_iid_t[]) { 14, 42, 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ_WITH_RESOURCE_TABLE, 69, 4,
+                                        ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 514));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3E),
+                            CONTENT_FORMAT(OMA_LWM2M_TLV),
+                            PAYLOAD("\xc2\x04\x02\x02"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_register, invalid_resource_table) {
+    DM_TEST_INIT;
+    static const anjay_dm_resource_def_t UNSORTED_TABLE[] = {
+        { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+        { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT }
+    };
+    const anjay_dm_object_def_t *const obj = &(const anjay_dm_object_def_t) {
+        .oid = 77,
+        .handlers = {
+            .list_instances = _anjay_mock_dm_list_instances
+        },
+        .resources = UNSORTED_TABLE,
+        .resources_count = AVS_ARRAY_SIZE(UNSORTED_TABLE)
+    };
+    AVS_UNIT_ASSERT_FAILED(anjay_register_object(anjay, &obj));
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(dm_read, instance_empty) {
     DM_TEST_INIT;
     DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42", "13"),
@@ -2451,7 +2611,9 @@ AVS_UNIT_TEST(dm_discover, instance_multiple_servers) {
     DM_TEST_FINISH;
 }
 
-static void test_discover_object(anjay_t *anjay, avs_net_socket_t *mocksock) {
+static void test_discover_object(anjay_t *anjay,
+                                 avs_net_socket_t *mocksock,
+                                 uint16_t msg_id) {
     _anjay_mock_dm_expect_object_read_default_attrs(
             anjay, &OBJ, 2, 0,
             &(const anjay_dm_oi_attributes_t) {
@@ -2497,7 +2659,7 @@ static void test_discover_object(anjay_t *anjay, avs_net_socket_t *mocksock) {
                                              resources[iid]);
     }
 
-    DM_TEST_EXPECT_RESPONSE(mocksock, ACK, CONTENT, ID(0xfa3e),
+    DM_TEST_EXPECT_RESPONSE(mocksock, ACK, CONTENT, ID(msg_id),
                             CONTENT_FORMAT(LINK_FORMAT),
                             PAYLOAD("</42>;pmax=514,</42/0>,</42/0/0>,"
                                     "</42/0/3>,</42/0/4>,</42/0/6>,</42/1>,"
@@ -2510,9 +2672,35 @@ AVS_UNIT_TEST(dm_discover, object) {
     DM_TEST_INIT_WITH_SSIDS(2);
     DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42"),
                     ACCEPT(0x28), NO_PAYLOAD);
-    test_discover_object(anjay, mocksocks[0]);
+    test_discover_object(anjay, mocksocks[0], 0xFA3E);
+    DM_TEST_FINISH;
+}
+
+#ifdef ANJAY_WITH_DISCOVER_CACHE
+AVS_UNIT_TEST(dm_discover, object_cached) {
+    DM_TEST_INIT_WITH_SSIDS(2);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42"),
+                    ACCEPT(0x28), NO_PAYLOAD);
+    test_discover_object(anjay, mocksocks[0], 0xFA3E);
+
+    // no handlers are called when the data model did not change
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3F), PATH("42"),
+                    ACCEPT(0x28), NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xfa3f),
+                            CONTENT_FORMAT(LINK_FORMAT),
+                            PAYLOAD("</42>;pmax=514,</42/0>,</42/0/0>,"
+                                    "</42/0/3>,</42/0/4>,</42/0/6>,</42/1>,"
+                                    "</42/1/4>,</42/1/5>,</42/1/6>"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_instances_changed(anjay, 42));
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA40), PATH("42"),
+                    ACCEPT(0x28), NO_PAYLOAD);
+    test_discover_object(anjay, mocksocks[0], 0xFA40);
     DM_TEST_FINISH;
 }
+#endif // ANJAY_WITH_DISCOVER_CACHE
 
 AVS_UNIT_TEST(dm_discover, object_multiple_servers) {
     DM_TEST_INIT_WITH_SSIDS(2, 3);
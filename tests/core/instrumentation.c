@@ -0,0 +1,85 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "tests/utils/dm.h"
+
+AVS_UNIT_TEST(instrumentation, bucket_index) {
+    AVS_UNIT_ASSERT_EQUAL(bucket_index(0), 0);
+    AVS_UNIT_ASSERT_EQUAL(bucket_index(1), 1);
+    AVS_UNIT_ASSERT_EQUAL(bucket_index(2), 2);
+    AVS_UNIT_ASSERT_EQUAL(bucket_index(3), 2);
+    AVS_UNIT_ASSERT_EQUAL(bucket_index(4), 3);
+    AVS_UNIT_ASSERT_EQUAL(bucket_index(1000), 10);
+    AVS_UNIT_ASSERT_EQUAL(bucket_index(UINT64_MAX),
+                          ANJAY_INSTR_HISTOGRAM_BUCKETS - 1);
+}
+
+AVS_UNIT_TEST(instrumentation, record) {
+    anjay_t *anjay = _anjay_test_dm_init(DM_TEST_CONFIGURATION());
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    ANJAY_INSTR_START(start);
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(3, AVS_TIME_MS));
+    _anjay_instr_record(anjay_unlocked, ANJAY_INSTR_PROBE_READ, start);
+    _anjay_instr_record(anjay_unlocked, ANJAY_INSTR_PROBE_READ,
+                        avs_time_monotonic_now());
+    _anjay_instr_record_duration(
+            anjay_unlocked, ANJAY_INSTR_PROBE_SERIALIZATION,
+            avs_time_duration_from_scalar(1500, AVS_TIME_US));
+    _anjay_instr_record_object(anjay_unlocked, 42, start);
+    _anjay_instr_record_object(anjay_unlocked, 7, start);
+    _anjay_instr_record_object(anjay_unlocked, 42, start);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->instr.objects), 2);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->instr.objects->oid, 7);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    anjay_instr_histogram_t histogram;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_instr_get_histogram(anjay, ANJAY_INSTR_PROBE_READ,
+                                      &histogram));
+    AVS_UNIT_ASSERT_EQUAL(histogram.count, 2);
+    AVS_UNIT_ASSERT_EQUAL(histogram.total_us, 3000);
+    AVS_UNIT_ASSERT_EQUAL(histogram.max_us, 3000);
+    AVS_UNIT_ASSERT_EQUAL(histogram.buckets[0], 1);
+    AVS_UNIT_ASSERT_EQUAL(histogram.buckets[bucket_index(3000)], 1);
+    AVS_UNIT_ASSERT_FAILED(anjay_instr_get_histogram(
+            anjay, ANJAY_INSTR_PROBE_LIMIT_, &histogram));
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_instr_get_histogram(
+            anjay, ANJAY_INSTR_PROBE_SERIALIZATION, &histogram));
+    AVS_UNIT_ASSERT_EQUAL(histogram.count, 1);
+    AVS_UNIT_ASSERT_EQUAL(histogram.total_us, 1500);
+    AVS_UNIT_ASSERT_EQUAL(histogram.buckets[bucket_index(1500)], 1);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_instr_get_object_histogram(anjay, 42, &histogram));
+    AVS_UNIT_ASSERT_EQUAL(histogram.count, 2);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_instr_get_object_histogram(anjay, 43, &histogram));
+    AVS_UNIT_ASSERT_EQUAL(histogram.count, 0);
+
+    anjay_instr_reset(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_instr_get_histogram(anjay, ANJAY_INSTR_PROBE_READ,
+                                      &histogram));
+    AVS_UNIT_ASSERT_EQUAL(histogram.count, 0);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_instr_get_object_histogram(anjay, 42, &histogram));
+    AVS_UNIT_ASSERT_EQUAL(histogram.count, 0);
+
+    anjay_instr_queue_depths_t depths;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_instr_get_queue_depths(anjay, &depths));
+    AVS_UNIT_ASSERT_EQUAL(depths.unsent_notifications, 0);
+    AVS_UNIT_ASSERT_EQUAL(depths.deferred_sends, 0);
+    AVS_UNIT_ASSERT_EQUAL(depths.pending_exchanges, 0);
+
+    _anjay_test_dm_finish(anjay);
+}
@@ -133,6 +133,44 @@ AVS_UNIT_TEST(batch_builder, empty_bytes) {
 }
 #endif // ANJAY_WITH_LWM2M11
 
+static void count_release(void *counter) {
+    ++*(int *) counter;
+}
+
+AVS_UNIT_TEST(batch_builder, bytes_borrowed) {
+    anjay_batch_builder_t *builder = builder_setup();
+    static const char DATA[] = "\x01\x02\x03\x04\x05";
+    int release_count = 0;
+
+    builder_out_ctx_t ctx =
+            builder_out_ctx_new(builder, &MAKE_RESOURCE_PATH(0, 0, 0), NULL);
+    anjay_unlocked_output_ctx_t *out = (anjay_unlocked_output_ctx_t *) &ctx;
+
+    // no path set, the buffer is released immediately
+    AVS_UNIT_ASSERT_FAILED(_anjay_ret_bytes_borrowed_unlocked(
+            out, DATA, sizeof(DATA), count_release, &release_count));
+    AVS_UNIT_ASSERT_EQUAL(release_count, 1);
+    AVS_UNIT_ASSERT_NULL(builder->list);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_output_set_path(out, &MAKE_RESOURCE_PATH(0, 0, 0)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_bytes_borrowed_unlocked(
+            out, DATA, sizeof(DATA), count_release, &release_count));
+    AVS_UNIT_ASSERT_SUCCESS(output_close(out));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
+    AVS_UNIT_ASSERT_TRUE(builder->list->data.value.bytes.data == DATA);
+    AVS_UNIT_ASSERT_EQUAL(builder->list->data.value.bytes.length,
+                          sizeof(DATA));
+
+    anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
+    AVS_UNIT_ASSERT_NOT_NULL(batch);
+    anjay_batch_t *acquired = _anjay_batch_acquire(batch);
+    _anjay_batch_release(&batch);
+    AVS_UNIT_ASSERT_EQUAL(release_count, 1);
+    _anjay_batch_release(&acquired);
+    AVS_UNIT_ASSERT_EQUAL(release_count, 2);
+}
+
 AVS_UNIT_TEST(batch_builder, compile) {
     anjay_batch_builder_t *builder = builder_setup();
 
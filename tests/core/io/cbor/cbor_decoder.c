@@ -749,3 +749,90 @@ AVS_UNIT_TEST(cbor_decoder, indefinite_map_that_is_empty) {
     ASSERT_OK(_anjay_json_like_decoder_enter_map(DECODER));
     ASSERT_EQ(_anjay_json_like_decoder_nesting_level(DECODER), 0);
 }
+
+#define SCOPED_BUFFER_TEST_ENV(Data, Size)                                 \
+    SCOPED_PTR(anjay_json_like_decoder_t, _anjay_json_like_decoder_delete) \
+    DECODER = _anjay_cbor_decoder_new_from_buffer(                         \
+            (Data), (Size), MAX_SENML_CBOR_NEST_STACK_SIZE);               \
+    ASSERT_NOT_NULL(DECODER);                                              \
+    ASSERT_TRUE(_anjay_io_cbor_has_payload_view(DECODER));
+
+AVS_UNIT_TEST(cbor_decoder, buffer_indefinite_map) {
+    static const char data[] = "\xBF\x63"
+                               "Fun"
+                               "\xF5\x65"
+                               "Stuff"
+                               "\x21\xFF";
+    SCOPED_BUFFER_TEST_ENV(data, sizeof(data) - 1);
+    ASSERT_OK(_anjay_json_like_decoder_enter_map(DECODER));
+    ASSERT_EQ_BYTES_SIZED(read_short_string(DECODER), "Fun", sizeof("Fun"));
+    bool value;
+    ASSERT_OK(_anjay_json_like_decoder_bool(DECODER, &value));
+    ASSERT_EQ(value, true);
+
+    ASSERT_EQ_BYTES_SIZED(read_short_string(DECODER), "Stuff", sizeof("Stuff"));
+    anjay_json_like_number_t number;
+    ASSERT_OK(_anjay_json_like_decoder_number(DECODER, &number));
+    ASSERT_EQ(number.type, ANJAY_JSON_LIKE_VALUE_NEGATIVE_INT);
+    ASSERT_EQ(number.value.i64, -2);
+
+    ASSERT_EQ(_anjay_json_like_decoder_state(DECODER),
+              ANJAY_JSON_LIKE_DECODER_STATE_FINISHED);
+}
+
+AVS_UNIT_TEST(cbor_decoder, buffer_bytes_slices_are_borrowed) {
+    // [(_ h'AABBCCDD', h'EEFF99'), 42]
+    static const uint8_t input_bytes[] = { 0x82, 0x5F, 0x44, 0xAA, 0xBB,
+                                           0xCC, 0xDD, 0x43, 0xEE, 0xFF,
+                                           0x99, 0xFF, 0x18, 0x2A };
+    SCOPED_BUFFER_TEST_ENV(input_bytes, sizeof(input_bytes));
+    ASSERT_OK(_anjay_json_like_decoder_enter_array(DECODER));
+
+    anjay_io_cbor_bytes_ctx_t bytes_ctx;
+    ASSERT_OK(_anjay_io_cbor_get_bytes_ctx(DECODER, &bytes_ctx));
+    const void *data;
+    size_t size;
+    bool finished;
+    ASSERT_OK(_anjay_io_cbor_get_bytes_slice(DECODER, &bytes_ctx, &data, &size,
+                                             &finished));
+    ASSERT_TRUE(data == &input_bytes[3]);
+    ASSERT_EQ(size, 4);
+    ASSERT_FALSE(finished);
+    ASSERT_OK(_anjay_io_cbor_get_bytes_slice(DECODER, &bytes_ctx, &data, &size,
+                                             &finished));
+    ASSERT_TRUE(data == &input_bytes[8]);
+    ASSERT_EQ(size, 3);
+    ASSERT_TRUE(finished);
+
+    anjay_json_like_number_t number;
+    ASSERT_OK(_anjay_json_like_decoder_number(DECODER, &number));
+    ASSERT_EQ(number.type, ANJAY_JSON_LIKE_VALUE_UINT);
+    ASSERT_EQ(number.value.u64, 42);
+    ASSERT_EQ(_anjay_json_like_decoder_state(DECODER),
+              ANJAY_JSON_LIKE_DECODER_STATE_FINISHED);
+}
+
+AVS_UNIT_TEST(cbor_decoder, buffer_truncated_bytes) {
+    // h'AABBCCDD', with the last byte missing
+    static const uint8_t input_bytes[] = { 0x44, 0xAA, 0xBB, 0xCC };
+    SCOPED_BUFFER_TEST_ENV(input_bytes, sizeof(input_bytes));
+
+    anjay_io_cbor_bytes_ctx_t bytes_ctx;
+    ASSERT_OK(_anjay_io_cbor_get_bytes_ctx(DECODER, &bytes_ctx));
+    const void *data;
+    size_t size;
+    bool finished;
+    ASSERT_FAIL(_anjay_io_cbor_get_bytes_slice(DECODER, &bytes_ctx, &data,
+                                               &size, &finished));
+    ASSERT_EQ(_anjay_json_like_decoder_state(DECODER),
+              ANJAY_JSON_LIKE_DECODER_STATE_ERROR);
+}
+
+AVS_UNIT_TEST(cbor_decoder, buffer_truncated_uint) {
+    static const uint8_t input_bytes[] = { 0x19, 0x01 };
+    SCOPED_BUFFER_TEST_ENV(input_bytes, sizeof(input_bytes));
+    anjay_json_like_number_t number;
+    ASSERT_FAIL(_anjay_json_like_decoder_number(DECODER, &number));
+    ASSERT_EQ(_anjay_json_like_decoder_state(DECODER),
+              ANJAY_JSON_LIKE_DECODER_STATE_ERROR);
+}
@@ -458,6 +458,32 @@ AVS_UNIT_TEST(cbor_encoder, cached_empty_definite_array) {
     avs_free(env.buf);
 }
 
+// [0, 1, 2, ..., 299]
+AVS_UNIT_TEST(cbor_encoder, cached_definite_array_with_long_header) {
+    cbor_test_env_t env;
+    cbor_test_setup(&env, 1024);
+    cbor_encoder_t *encoder = env.encoder;
+
+    AVS_UNIT_ASSERT_SUCCESS(cbor_unknown_length_definite_array_begin(encoder));
+    for (int i = 0; i < 300; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(cbor_encode_int(encoder, i));
+    }
+    AVS_UNIT_ASSERT_SUCCESS(cbor_definite_array_end(encoder));
+    AVS_UNIT_ASSERT_EQUAL(nested_context_top(encoder)->size, 1);
+    AVS_UNIT_ASSERT_SUCCESS(cbor_encoder_delete(&encoder));
+
+    // 3 bytes of header, 24 one-byte items, 232 two-byte items,
+    // 44 three-byte items
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&env.outbuf),
+                          3 + 24 + 2 * 232 + 3 * 44);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.buf, "\x99\x01\x2C\x00\x01", 5);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+            &env.buf[avs_stream_outbuf_offset(&env.outbuf) - 3], "\x19\x01\x2B",
+            3);
+
+    avs_free(env.buf);
+}
+
 // [1, [2]]
 AVS_UNIT_TEST(cbor_encoder, nested_definite_arrays1) {
     cbor_test_env_t env;
@@ -225,6 +225,57 @@ AVS_UNIT_TEST(json_decoder, string_space_unicode_escape) {
               ANJAY_JSON_LIKE_DECODER_STATE_ERROR);
 }
 
+AVS_UNIT_TEST(json_decoder, string_longer_than_read_ahead_buffer) {
+    char data[3 * READ_AHEAD_BUFFER_SIZE + 2];
+    char expected[sizeof(data) + 1];
+    size_t expected_length = 0;
+    data[0] = '"';
+    for (size_t i = 1; i < sizeof(data) - 1; ++i) {
+        // place escape sequences so that some of them are split between
+        // consecutive chunks of the input stream
+        if ((i % 37 == 0 || i % READ_AHEAD_BUFFER_SIZE == 0)
+                && i + 2 < sizeof(data)) {
+            data[i] = '\\';
+            data[++i] = 'n';
+            expected[expected_length++] = '\n';
+        } else {
+            data[i] = (char) ('a' + i % 26);
+            expected[expected_length++] = data[i];
+        }
+    }
+    data[sizeof(data) - 1] = '"';
+    expected[expected_length] = '\0';
+
+    SCOPED_TEST_ENV(data, sizeof(data));
+    char output[sizeof(expected)];
+    avs_stream_outbuf_t stream = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+    avs_stream_outbuf_set_buffer(&stream, output, sizeof(output) - 1);
+    ASSERT_OK(_anjay_json_like_decoder_bytes(DECODER, (avs_stream_t *) &stream));
+    ASSERT_EQ(avs_stream_outbuf_offset(&stream), expected_length);
+    output[expected_length] = '\0';
+    ASSERT_EQ_STR(output, expected);
+    ASSERT_EQ(_anjay_json_like_decoder_state(DECODER),
+              ANJAY_JSON_LIKE_DECODER_STATE_FINISHED);
+}
+
+AVS_UNIT_TEST(json_decoder, string_special_characters_in_word) {
+    // every special character in a different position of an 8-byte word
+    static const char data[] = "\"0123456\\\"01234\\\\6701\\t34567\"";
+    SCOPED_TEST_ENV(data, strlen(data));
+    ASSERT_EQ_STR(read_short_string(DECODER), "0123456\"01234\\6701\t34567");
+    ASSERT_EQ(_anjay_json_like_decoder_state(DECODER),
+              ANJAY_JSON_LIKE_DECODER_STATE_FINISHED);
+}
+
+AVS_UNIT_TEST(json_decoder, string_control_character_after_long_run) {
+    static const char data[] =
+            "\"0123456789abcdef0123456789abcdef\x7f\x80\x1f\"";
+    SCOPED_TEST_ENV(data, strlen(data));
+    ASSERT_NULL(read_short_string(DECODER));
+    ASSERT_EQ(_anjay_json_like_decoder_state(DECODER),
+              ANJAY_JSON_LIKE_DECODER_STATE_ERROR);
+}
+
 AVS_UNIT_TEST(json_decoder, boolean_true) {
     static const char data[] = "true";
     SCOPED_TEST_ENV(data, strlen(data));
@@ -409,3 +409,112 @@ AVS_UNIT_TEST(tlv_out, set_path) {
                  "\x40\x06" // resource instance /0/4/5/6
     );
 }
+
+//////////////////////////////////////////////// ENCODING // PRECOMPUTED LENGTHS
+
+static int feed_nested_object(anjay_unlocked_output_ctx_t *out, void *arg) {
+    const char *value = (const char *) arg;
+    int result;
+    (void) ((result = _anjay_output_set_path(out, &MAKE_INSTANCE_PATH(0, 1)))
+            || (result = _anjay_output_start_aggregate(out))
+            || (result = _anjay_output_set_path(
+                        out, &MAKE_RESOURCE_INSTANCE_PATH(0, 1, 2, 3)))
+            || (result = _anjay_ret_i64_unlocked(out, 42))
+            || (result = _anjay_output_set_path(
+                        out, &MAKE_RESOURCE_INSTANCE_PATH(0, 1, 2, 4)))
+            || (result = _anjay_ret_string_unlocked(out, value))
+            || (result = _anjay_output_set_path(out,
+                                                &MAKE_RESOURCE_PATH(0, 1, 5)))
+            || (result = _anjay_ret_bool_unlocked(out, true))
+            || (result = _anjay_output_set_path(out, &MAKE_INSTANCE_PATH(0, 6)))
+            || (result = _anjay_output_start_aggregate(out))
+            || (result = _anjay_output_set_path(out,
+                                                &MAKE_RESOURCE_PATH(0, 6, 7)))
+            || (result = _anjay_output_start_aggregate(out)));
+    return result;
+}
+
+#define NESTED_OBJECT_TLV                           \
+    "\x08\x01\x10" /* instance /0/1 */              \
+    "\x88\x02\x0A" /* multiple resource /0/1/2 */   \
+    "\x41\x03\x2A" /* resource instance /0/1/2/3 */ \
+    "\x45\x04"                                      \
+    "hello"        /* resource instance /0/1/2/4 */ \
+    "\xC1\x05\x01" /* resource /0/1/5 */            \
+    "\x02\x06"     /* instance /0/6 */              \
+    "\x80\x07"     /* multiple resource /0/6/7 */
+
+AVS_UNIT_TEST(tlv_out_precomputed, buffered_reference) {
+    TEST_ENV(64, &MAKE_OBJECT_PATH(0));
+    AVS_UNIT_ASSERT_SUCCESS(feed_nested_object(out, (void *) "hello"));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    VERIFY_BYTES(NESTED_OBJECT_TLV);
+}
+
+AVS_UNIT_TEST(tlv_out_precomputed, streamed) {
+    TEST_ENV(64, &MAKE_OBJECT_PATH(0));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_tlv_precompute_lengths(
+            out, feed_nested_object, (void *) "hello"));
+    // nothing is written during the measurement pass
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&outbuf), 0);
+    AVS_UNIT_ASSERT_EQUAL(((tlv_out_t *) out)->level, TLV_OUT_LEVEL_IID);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_output_set_path(out, &MAKE_INSTANCE_PATH(0, 1)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_start_aggregate(out));
+    // headers of nested levels are written as soon as they are started
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&outbuf), 3);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_path(
+            out, &MAKE_RESOURCE_INSTANCE_PATH(0, 1, 2, 3)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_i64_unlocked(out, 42));
+    // ...and so are the values
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&outbuf), 9);
+    AVS_UNIT_ASSERT_NULL(
+            ((tlv_out_t *) out)->levels[TLV_OUT_LEVEL_RIID].entries);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_path(
+            out, &MAKE_RESOURCE_INSTANCE_PATH(0, 1, 2, 4)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_string_unlocked(out, "hello"));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_output_set_path(out, &MAKE_RESOURCE_PATH(0, 1, 5)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_bool_unlocked(out, true));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_output_set_path(out, &MAKE_INSTANCE_PATH(0, 6)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_start_aggregate(out));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_output_set_path(out, &MAKE_RESOURCE_PATH(0, 6, 7)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_start_aggregate(out));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    VERIFY_BYTES(NESTED_OBJECT_TLV);
+}
+
+AVS_UNIT_TEST(tlv_out_precomputed, longer_data_in_second_pass) {
+    TEST_ENV(64, &MAKE_OBJECT_PATH(0));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_tlv_precompute_lengths(
+            out, feed_nested_object, (void *) "hello"));
+    AVS_UNIT_ASSERT_EQUAL(feed_nested_object(out, (void *) "hello world"),
+                          ANJAY_OUTCTXERR_TLV_LENGTH_MISMATCH);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_output_ctx_destroy(&out),
+                          ANJAY_OUTCTXERR_TLV_LENGTH_MISMATCH);
+}
+
+AVS_UNIT_TEST(tlv_out_precomputed, shorter_data_in_second_pass) {
+    TEST_ENV(64, &MAKE_OBJECT_PATH(0));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_tlv_precompute_lengths(
+            out, feed_nested_object, (void *) "hello"));
+    AVS_UNIT_ASSERT_EQUAL(feed_nested_object(out, (void *) "hi"),
+                          ANJAY_OUTCTXERR_TLV_LENGTH_MISMATCH);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_output_ctx_destroy(&out),
+                          ANJAY_OUTCTXERR_TLV_LENGTH_MISMATCH);
+}
+
+AVS_UNIT_TEST(tlv_out_precomputed, missing_levels_in_second_pass) {
+    TEST_ENV(64, &MAKE_OBJECT_PATH(0));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_tlv_precompute_lengths(
+            out, feed_nested_object, (void *) "hello"));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_output_set_path(out, &MAKE_INSTANCE_PATH(0, 1)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_start_aggregate(out));
+    AVS_UNIT_ASSERT_EQUAL(_anjay_output_ctx_destroy(&out),
+                          ANJAY_OUTCTXERR_TLV_LENGTH_MISMATCH);
+}
@@ -11,6 +11,7 @@
 
 #include <anjay/lwm2m_send.h>
 
+#include <avsystem/commons/avs_stream_membuf.h>
 #include <avsystem/commons/avs_unit_mocksock.h>
 #include <avsystem/commons/avs_unit_test.h>
 #include <avsystem/commons/avs_utils.h>
@@ -386,6 +387,136 @@ AVS_UNIT_TEST(anjay_send, partial_success) {
     DM_TEST_FINISH;
 }
 
+/**
+ * Returns the payload of two coalesced requests, each containing a single
+ * value of URI_PATH. The base name is only present in the first record.
+ */
+static expected_payload_t
+get_expected_payload_for_coalesced_int_values(uint16_t first_value,
+                                              uint16_t second_value) {
+    expected_payload_t payload =
+            get_expected_payload_for_batch_with_int_value(URI_PATH, first_value,
+                                                          NAN);
+    payload.payload[0] = (char) 0x82;
+    const uint16_t converted_second_value = avs_convert_be16(second_value);
+    memcpy(payload.payload + payload.payload_size, "\xA1\x02\x19", 3);
+    memcpy(payload.payload + payload.payload_size + 3, &converted_second_value,
+           sizeof(converted_second_value));
+    payload.payload_size += 3 + sizeof(converted_second_value);
+    return payload;
+}
+
+AVS_UNIT_TEST(anjay_send, coalescing) {
+    DM_TEST_INIT;
+
+    static const uint16_t OTHER_VALUE = 0xBEEF;
+    const avs_time_duration_t coalescing_delay =
+            avs_time_duration_from_scalar(1, AVS_TIME_S);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_unlocked->sender.coalescing_delay = coalescing_delay;
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    // both requests are held until the coalescing delay passes
+    anjay_send_batch_t *batch = get_new_batch_with_int_value(URI_PATH, VALUE);
+    test_call_anjay_send(anjay, SSID, batch,
+                         send_finished_handler_result_validator,
+                         (void *) (intptr_t) ANJAY_SEND_SUCCESS);
+    anjay_send_batch_release(&batch);
+    batch = get_new_batch_with_int_value(URI_PATH, OTHER_VALUE);
+    test_call_anjay_send(anjay, SSID, batch,
+                         send_finished_handler_result_validator,
+                         (void *) (intptr_t) ANJAY_SEND_SUCCESS);
+    anjay_send_batch_release(&batch);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(HANDLER_WRAPPER_ARGS), 2);
+
+    // ...and then sent as a single SenML array with two records
+    assert_there_is_server_with_ssid(SSID, anjay);
+    assert_mute_send_resource_equals(false, anjay, SSID);
+    test_expect_scheduled_lwm2m_send_request(
+            mocksocks[0], MSG_ID, nth_token(0),
+            get_expected_payload_for_coalesced_int_values(VALUE, OTHER_VALUE));
+    _anjay_mock_clock_advance(coalescing_delay);
+    anjay_sched_run(anjay);
+
+    // the result is passed to both finished handlers
+    const coap_test_msg_t *response =
+            COAP_MSG(ACK, CHANGED, ID_TOKEN_RAW(MSG_ID, nth_token(0)),
+                     NO_PAYLOAD);
+    avs_unit_mocksock_input(mocksocks[0], response->content, response->length);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    avs_coap_async_handle_incoming_packet(
+            _anjay_connection_get(&anjay_unlocked->servers->connections,
+                                  ANJAY_CONNECTION_PRIMARY)
+                    ->coap_ctx,
+            NULL, NULL);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_NULL(HANDLER_WRAPPER_ARGS);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(anjay_send, coalescing_max_records) {
+    DM_TEST_INIT;
+
+    static const uint16_t VALUES[] = { VALUE, 0xBEEF, 0xCAFE };
+    const avs_time_duration_t coalescing_delay =
+            avs_time_duration_from_scalar(1, AVS_TIME_S);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_unlocked->sender.coalescing_delay = coalescing_delay;
+    anjay_unlocked->sender.coalescing_max_records = 2;
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(VALUES); ++i) {
+        anjay_send_batch_t *batch =
+                get_new_batch_with_int_value(URI_PATH, VALUES[i]);
+        test_call_anjay_send(anjay, SSID, batch,
+                             send_finished_handler_result_validator,
+                             (void *) (intptr_t) ANJAY_SEND_SUCCESS);
+        anjay_send_batch_release(&batch);
+    }
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(HANDLER_WRAPPER_ARGS), 3);
+
+    // merging the third request would exceed the limit of two records, so it
+    // is sent in a separate exchange, held until the first one finishes
+    assert_there_is_server_with_ssid(SSID, anjay);
+    assert_mute_send_resource_equals(false, anjay, SSID);
+    test_expect_scheduled_lwm2m_send_request(
+            mocksocks[0], MSG_ID, nth_token(0),
+            get_expected_payload_for_coalesced_int_values(VALUES[0],
+                                                          VALUES[1]));
+    _anjay_mock_clock_advance(coalescing_delay);
+    anjay_sched_run(anjay);
+
+    const coap_test_msg_t *response =
+            COAP_MSG(ACK, CHANGED, ID_TOKEN_RAW(MSG_ID, nth_token(0)),
+                     NO_PAYLOAD);
+    avs_unit_mocksock_input(mocksocks[0], response->content, response->length);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    avs_coap_async_handle_incoming_packet(
+            _anjay_connection_get(&anjay_unlocked->servers->connections,
+                                  ANJAY_CONNECTION_PRIMARY)
+                    ->coap_ctx,
+            NULL, NULL);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(HANDLER_WRAPPER_ARGS), 1);
+
+    test_expect_scheduled_lwm2m_send_request(
+            mocksocks[0], (uint16_t) (MSG_ID + 1), nth_token(1),
+            get_expected_payload_for_batch_with_int_value(URI_PATH, VALUES[2],
+                                                          NAN));
+    anjay_sched_run(anjay);
+    test_handle_lwm2m_send_response(
+            anjay, mocksocks[0],
+            COAP_MSG(ACK, CHANGED,
+                     ID_TOKEN_RAW((uint16_t) (MSG_ID + 1), nth_token(1)),
+                     NO_PAYLOAD));
+    AVS_UNIT_ASSERT_NULL(HANDLER_WRAPPER_ARGS);
+
+    DM_TEST_FINISH;
+}
+
 static void test_expect_scheduled_lwm2m_send_retransmissions(
         anjay_t *anjay,
         avs_net_socket_t *mocksock,
@@ -581,6 +712,103 @@ AVS_UNIT_TEST(anjay_send, offline_mode) {
     DM_TEST_FINISH;
 }
 
+#ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
+static void test_persist_send_queue(anjay_t *anjay,
+                                    size_t max_size,
+                                    void **out_data,
+                                    size_t *out_size) {
+    avs_stream_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_queue_persist(anjay, stream, max_size));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_membuf_take_ownership(stream, out_data, out_size));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+static void
+test_restore_send_queue(anjay_t *anjay, const void *data, size_t size) {
+    avs_stream_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, data, size));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_queue_restore(anjay, stream));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+static size_t send_queue_length(anjay_t *anjay) {
+    size_t length;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    length = AVS_LIST_SIZE(anjay_unlocked->sender.entries);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    return length;
+}
+
+static void clear_send_queue(anjay_t *anjay) {
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    _anjay_send_cleanup(&anjay_unlocked->sender);
+    ANJAY_MUTEX_UNLOCK(anjay);
+}
+
+AVS_UNIT_TEST(anjay_send, queue_persistence) {
+    DM_TEST_INIT_WITHOUT_SERVER;
+
+    static const uint16_t VALUES[] = { VALUE, 0xBEEF };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(VALUES); ++i) {
+        anjay_send_batch_t *batch =
+                get_new_batch_with_int_value(URI_PATH, VALUES[i]);
+        assert_there_is_server_with_ssid(SSID, anjay);
+        assert_mute_send_resource_equals(false, anjay, SSID);
+        AVS_UNIT_ASSERT_EQUAL(
+                anjay_send_deferrable(anjay, SSID, batch, NULL, NULL),
+                ANJAY_SEND_OK);
+        anjay_send_batch_release(&batch);
+        // batches compiled later are considered newer
+        _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+    }
+    AVS_UNIT_ASSERT_EQUAL(send_queue_length(anjay), 2);
+
+    void *full_data = NULL;
+    size_t full_size = 0;
+    test_persist_send_queue(anjay, 0, &full_data, &full_size);
+
+    // restored queue is persisted exactly the same way
+    clear_send_queue(anjay);
+    test_restore_send_queue(anjay, full_data, full_size);
+    AVS_UNIT_ASSERT_EQUAL(send_queue_length(anjay), 2);
+
+    void *data = NULL;
+    size_t size = 0;
+    test_persist_send_queue(anjay, 0, &data, &size);
+    AVS_UNIT_ASSERT_EQUAL(size, full_size);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, full_data, full_size);
+    avs_free(data);
+
+    // if the queue does not fit, the oldest request is omitted
+    test_persist_send_queue(anjay, full_size - 1, &data, &size);
+    AVS_UNIT_ASSERT_TRUE(size < full_size);
+    // magic, version and request count
+    const size_t header_size = 8;
+    // without coalescing, newer requests precede older ones to the same server
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED((const char *) data + header_size,
+                                      (const char *) full_data + header_size,
+                                      size - header_size);
+
+    clear_send_queue(anjay);
+    test_restore_send_queue(anjay, data, size);
+    AVS_UNIT_ASSERT_EQUAL(send_queue_length(anjay), 1);
+    avs_free(data);
+
+    // the limit must leave room for the header
+    avs_stream_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_send_queue_persist(anjay, stream, header_size - 1));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+
+    avs_free(full_data);
+    DM_TEST_FINISH;
+}
+#endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
+
 AVS_UNIT_TEST(anjay_send, ssid_any) {
     DM_TEST_INIT;
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
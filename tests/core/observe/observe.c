@@ -863,6 +863,94 @@ AVS_UNIT_TEST(notify, max_period) {
     notify_max_period_test("\x70\x00\x00\x01", 4, 0); // Reset
 }
 
+#ifdef ANJAY_WITH_OBSERVE_ATTRS_CACHE
+AVS_UNIT_TEST(notify, attrs_cached) {
+    static const anjay_dm_r_attributes_t ATTRS = {
+        .common = {
+            .min_period = 0,
+            .max_period = 10,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+    static const anjay_dm_r_attributes_t NEW_ATTRS = {
+        .common = {
+            .min_period = 0,
+            .max_period = 20,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+
+    ////// INITIALIZATION //////
+    DM_TEST_INIT_WITH_SSIDS(14);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 514.0));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    ////// ATTRIBUTES NOT READ AGAIN //////
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(10, AVS_TIME_S));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_STRING(0, "Hello"));
+    const coap_test_msg_t *notify_response1 =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Hello"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response1->content,
+                                    notify_response1->length);
+    anjay_sched_run(anjay);
+
+    ////// ATTRIBUTES KEPT AFTER CHANGE IN ANOTHER OBJECT //////
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_instances_changed(anjay, 25));
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(10, AVS_TIME_S));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_STRING(0, "Hey"));
+    const coap_test_msg_t *notify_response2 =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 1, "Res4"),
+                     OBSERVE(2), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Hey"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response2->content,
+                                    notify_response2->length);
+    anjay_sched_run(anjay);
+
+    ////// ATTRIBUTES RE-READ AFTER CHANGE IN THE OBSERVED OBJECT //////
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_instances_changed(anjay, 42));
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(10, AVS_TIME_S));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &NEW_ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_STRING(0, "Hi!"));
+    const coap_test_msg_t *notify_response3 =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 2, "Res4"),
+                     OBSERVE(3), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Hi!"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response3->content,
+                                    notify_response3->length);
+    anjay_sched_run(anjay);
+
+    ////// NEW PMAX IN EFFECT //////
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(10, AVS_TIME_S));
+    anjay_sched_run(anjay);
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(10, AVS_TIME_S));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_STRING(0, "Howdy!"));
+    const coap_test_msg_t *notify_response4 =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 3, "Res4"),
+                     OBSERVE(4), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Howdy!"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response4->content,
+                                    notify_response4->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_OBSERVE_ATTRS_CACHE
+
 AVS_UNIT_TEST(notify, min_period) {
     static const anjay_dm_r_attributes_t ATTRS = {
         .common = {
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_stream_inbuf.h>
+#include <avsystem/commons/avs_stream_outbuf.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include <stddef.h>
+#include <string.h>
+
+typedef struct {
+    anjay_iid_t iid;
+    uint32_t value;
+    bool modified;
+} test_instance_t;
+
+static size_t handle_test_instance_calls;
+
+static avs_error_t handle_test_instance(avs_persistence_context_t *ctx,
+                                        void *element_,
+                                        uint8_t version) {
+    (void) version;
+    ++handle_test_instance_calls;
+    test_instance_t *element = (test_instance_t *) element_;
+    avs_error_t err;
+    (void) (avs_is_err((err = avs_persistence_u16(ctx, &element->iid)))
+            || avs_is_err((err = avs_persistence_u32(ctx, &element->value))));
+    return err;
+}
+
+static void destroy_test_instance(AVS_LIST(void) *element_ptr) {
+    AVS_LIST_CLEAR(element_ptr);
+}
+
+static const anjay_journal_instances_def_t TEST_DEF = {
+    .element_size = sizeof(test_instance_t),
+    .iid_offset = offsetof(test_instance_t, iid),
+    .modified_offset = offsetof(test_instance_t, modified),
+    .version = 1,
+    .handle_instance = handle_test_instance,
+    .destroy_instance = destroy_test_instance
+};
+
+static void add_test_instance(AVS_LIST(test_instance_t) *instances,
+                              anjay_iid_t iid,
+                              uint32_t value) {
+    AVS_LIST(test_instance_t) *insert_ptr = instances;
+    while (*insert_ptr && (*insert_ptr)->iid < iid) {
+        AVS_LIST_ADVANCE_PTR(&insert_ptr);
+    }
+    AVS_LIST(test_instance_t) instance = AVS_LIST_NEW_ELEMENT(test_instance_t);
+    AVS_UNIT_ASSERT_NOT_NULL(instance);
+    instance->iid = iid;
+    instance->value = value;
+    instance->modified = true;
+    AVS_LIST_INSERT(insert_ptr, instance);
+}
+
+static void set_test_value(test_instance_t *instance, uint32_t value) {
+    instance->value = value;
+    instance->modified = true;
+}
+
+static void assert_instances_equal(AVS_LIST(test_instance_t) a,
+                                   AVS_LIST(test_instance_t) b) {
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(a), AVS_LIST_SIZE(b));
+    for (; a && b; a = AVS_LIST_NEXT(a), b = AVS_LIST_NEXT(b)) {
+        AVS_UNIT_ASSERT_EQUAL(a->iid, b->iid);
+        AVS_UNIT_ASSERT_EQUAL(a->value, b->value);
+    }
+}
+
+typedef struct {
+    char data[256];
+    avs_stream_outbuf_t out;
+    avs_stream_inbuf_t in;
+} test_journal_t;
+
+static avs_stream_t *journal_init(test_journal_t *journal) {
+    memcpy(&journal->out, &AVS_STREAM_OUTBUF_STATIC_INITIALIZER,
+           sizeof(journal->out));
+    avs_stream_outbuf_set_buffer(&journal->out, journal->data,
+                                 sizeof(journal->data));
+    return (avs_stream_t *) &journal->out;
+}
+
+static size_t journal_size(test_journal_t *journal) {
+    return avs_stream_outbuf_offset(&journal->out);
+}
+
+/**
+ * Returns a stream for reading the first @p size bytes written to the journal,
+ * so that a record interrupted halfway through can be simulated.
+ */
+static avs_stream_t *journal_read(test_journal_t *journal, size_t size) {
+    memcpy(&journal->in, &AVS_STREAM_INBUF_STATIC_INITIALIZER,
+           sizeof(journal->in));
+    avs_stream_inbuf_set_buffer(&journal->in, journal->data, size);
+    return (avs_stream_t *) &journal->in;
+}
+
+AVS_UNIT_TEST(persistence_journal, append_replay) {
+    AVS_LIST(test_instance_t) instances = NULL;
+    AVS_LIST(test_instance_t) restored = NULL;
+    anjay_journal_state_t state = { NULL, false };
+    test_journal_t journal;
+    avs_stream_t *out = journal_init(&journal);
+
+    add_test_instance(&instances, 1, 10);
+    add_test_instance(&instances, 3, 30);
+    _anjay_journal_state_update(&state, &TEST_DEF, instances);
+
+    // nothing changed, so nothing is written
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_journal_append_instances(&state, &TEST_DEF, instances, out));
+    AVS_UNIT_ASSERT_EQUAL(journal_size(&journal), 0);
+
+    add_test_instance(&instances, 2, 20);
+    set_test_value(instances, 11);
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_journal_append_instances(&state, &TEST_DEF, instances, out));
+    AVS_UNIT_ASSERT_NOT_EQUAL(journal_size(&journal), 0);
+
+    AVS_LIST_DELETE(AVS_LIST_NTH_PTR(&instances, 2));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_journal_append_instances(&state, &TEST_DEF, instances, out));
+
+    add_test_instance(&restored, 1, 10);
+    add_test_instance(&restored, 3, 30);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_journal_replay_instances(
+            &TEST_DEF, (AVS_LIST(void) *) &restored,
+            journal_read(&journal, journal_size(&journal))));
+    assert_instances_equal(instances, restored);
+
+    AVS_LIST_CLEAR(&instances);
+    AVS_LIST_CLEAR(&restored);
+    _anjay_journal_state_cleanup(&state);
+}
+
+AVS_UNIT_TEST(persistence_journal, reset_needed_purges) {
+    AVS_LIST(test_instance_t) instances = NULL;
+    AVS_LIST(test_instance_t) restored = NULL;
+    anjay_journal_state_t state = { NULL, true };
+    test_journal_t journal;
+    avs_stream_t *out = journal_init(&journal);
+
+    add_test_instance(&instances, 5, 50);
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_journal_append_instances(&state, &TEST_DEF, instances, out));
+    AVS_UNIT_ASSERT_FALSE(state.reset_needed);
+
+    add_test_instance(&restored, 1, 10);
+    add_test_instance(&restored, 5, 55);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_journal_replay_instances(
+            &TEST_DEF, (AVS_LIST(void) *) &restored,
+            journal_read(&journal, journal_size(&journal))));
+    assert_instances_equal(instances, restored);
+
+    AVS_LIST_CLEAR(&instances);
+    AVS_LIST_CLEAR(&restored);
+    _anjay_journal_state_cleanup(&state);
+}
+
+AVS_UNIT_TEST(persistence_journal, damaged_record_ignored) {
+    AVS_LIST(test_instance_t) instances = NULL;
+    AVS_LIST(test_instance_t) restored = NULL;
+    anjay_journal_state_t state = { NULL, false };
+    test_journal_t journal;
+    avs_stream_t *out = journal_init(&journal);
+
+    add_test_instance(&instances, 1, 10);
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_journal_append_instances(&state, &TEST_DEF, instances, out));
+    const size_t first_record_size = journal_size(&journal);
+    set_test_value(instances, 11);
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_journal_append_instances(&state, &TEST_DEF, instances, out));
+    const size_t size = journal_size(&journal);
+
+    // power lost while appending the second record
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_journal_replay_instances(
+            &TEST_DEF, (AVS_LIST(void) *) &restored,
+            journal_read(&journal, size - 1)));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(restored), 1);
+    AVS_UNIT_ASSERT_EQUAL(restored->value, 10);
+    AVS_LIST_CLEAR(&restored);
+
+    // checksum mismatch in the second record
+    journal.data[size - 1] ^= 0xFF;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_journal_replay_instances(
+            &TEST_DEF, (AVS_LIST(void) *) &restored,
+            journal_read(&journal, size)));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(restored), 1);
+    AVS_UNIT_ASSERT_EQUAL(restored->value, 10);
+    AVS_LIST_CLEAR(&restored);
+
+    // power lost while appending the first record
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_journal_replay_instances(
+            &TEST_DEF, (AVS_LIST(void) *) &restored,
+            journal_read(&journal, first_record_size - 1)));
+    AVS_UNIT_ASSERT_NULL(restored);
+
+    AVS_LIST_CLEAR(&instances);
+    _anjay_journal_state_cleanup(&state);
+}
+
+AVS_UNIT_TEST(persistence_journal, newer_version_rejected) {
+    AVS_LIST(test_instance_t) instances = NULL;
+    AVS_LIST(test_instance_t) restored = NULL;
+    anjay_journal_state_t state = { NULL, false };
+    test_journal_t journal;
+    avs_stream_t *out = journal_init(&journal);
+
+    anjay_journal_instances_def_t newer_def = TEST_DEF;
+    newer_def.version = 2;
+    add_test_instance(&instances, 1, 10);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_journal_append_instances(
+            &state, &newer_def, instances, out));
+    AVS_UNIT_ASSERT_FAILED(_anjay_journal_replay_instances(
+            &TEST_DEF, (AVS_LIST(void) *) &restored,
+            journal_read(&journal, journal_size(&journal))));
+
+    AVS_LIST_CLEAR(&instances);
+    AVS_LIST_CLEAR(&restored);
+    _anjay_journal_state_cleanup(&state);
+}
+
+AVS_UNIT_TEST(persistence_journal, only_modified_instances_serialized) {
+    AVS_LIST(test_instance_t) instances = NULL;
+    AVS_LIST(test_instance_t) restored = NULL;
+    anjay_journal_state_t state = { NULL, false };
+    test_journal_t journal;
+    avs_stream_t *out = journal_init(&journal);
+
+    for (anjay_iid_t iid = 0; iid < 8; ++iid) {
+        add_test_instance(&instances, iid, iid);
+    }
+    _anjay_journal_state_update(&state, &TEST_DEF, instances);
+    test_instance_t *instance;
+    AVS_LIST_FOREACH(instance, instances) {
+        AVS_UNIT_ASSERT_FALSE(instance->modified);
+    }
+
+    // Instances are compared using the modified flag only; unflagged ones are
+    // not even serialized
+    set_test_value(AVS_LIST_NTH(instances, 5), 55);
+    handle_test_instance_calls = 0;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_journal_append_instances(&state, &TEST_DEF, instances, out));
+    AVS_UNIT_ASSERT_EQUAL(handle_test_instance_calls, 1);
+    AVS_UNIT_ASSERT_FALSE(AVS_LIST_NTH(instances, 5)->modified);
+
+    for (anjay_iid_t iid = 0; iid < 8; ++iid) {
+        add_test_instance(&restored, iid, iid);
+    }
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_journal_replay_instances(
+            &TEST_DEF, (AVS_LIST(void) *) &restored,
+            journal_read(&journal, journal_size(&journal))));
+    assert_instances_equal(instances, restored);
+
+    AVS_LIST_CLEAR(&instances);
+    AVS_LIST_CLEAR(&restored);
+    _anjay_journal_state_cleanup(&state);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <string.h>
+
+#include <avsystem/commons/avs_stream.h>
+#include <avsystem/commons/avs_stream_inbuf.h>
+#include <avsystem/commons/avs_stream_membuf.h>
+#include <avsystem/commons/avs_stream_outbuf.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "src/core/servers/anjay_activate.h"
+#include "tests/utils/dm.h"
+
+static anjay_server_connection_t *add_server(anjay_unlocked_t *anjay,
+                                             anjay_ssid_t ssid) {
+    AVS_LIST(anjay_server_info_t) server =
+            _anjay_servers_create_inactive(anjay, ssid);
+    AVS_UNIT_ASSERT_NOT_NULL(server);
+    _anjay_servers_add(&anjay->servers, server);
+    return _anjay_connection_get(&server->connections,
+                                 ANJAY_CONNECTION_PRIMARY);
+}
+
+AVS_UNIT_TEST(session_persistence, persist_empty) {
+    char buf[16];
+    avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+    avs_stream_outbuf_set_buffer(&outbuf, buf, sizeof(buf));
+    anjay_t *anjay = _anjay_test_dm_init(DM_TEST_CONFIGURATION());
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_session_state_persist(anjay, (avs_stream_t *) &outbuf));
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&outbuf), 8);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "ACS\0\0\0\0\0", 8);
+
+    _anjay_test_dm_finish(anjay);
+}
+
+AVS_UNIT_TEST(session_persistence, restore_before_server_is_created) {
+    avs_stream_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+
+    anjay_t *anjay = _anjay_test_dm_init(DM_TEST_CONFIGURATION());
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_server_connection_t *connection = add_server(anjay_unlocked, 14);
+    memset(connection->nontransient_state.dtls_session_buffer, 0x5A,
+           sizeof(connection->nontransient_state.dtls_session_buffer));
+    strcpy(connection->nontransient_state.last_local_port, "45683");
+    // not worth persisting - no session and no local port
+    add_server(anjay_unlocked, 15);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_session_state_persist(anjay, stream));
+    _anjay_test_dm_finish(anjay);
+
+    anjay = _anjay_test_dm_init(DM_TEST_CONFIGURATION());
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_session_state_restore(anjay, stream));
+    ANJAY_MUTEX_LOCK(anjay_unlocked2, anjay);
+    AVS_UNIT_ASSERT_EQUAL(
+            AVS_LIST_SIZE(anjay_unlocked2->pending_session_states), 1);
+    anjay_server_connection_t *other_connection =
+            add_server(anjay_unlocked2, 15);
+    AVS_UNIT_ASSERT_EQUAL(
+            other_connection->nontransient_state.last_local_port[0], '\0');
+    AVS_UNIT_ASSERT_EQUAL(
+            AVS_LIST_SIZE(anjay_unlocked2->pending_session_states), 1);
+    anjay_server_connection_t *restored_connection =
+            add_server(anjay_unlocked2, 14);
+    AVS_UNIT_ASSERT_NULL(anjay_unlocked2->pending_session_states);
+    const anjay_server_connection_nontransient_state_t *state =
+            &restored_connection->nontransient_state;
+    for (size_t i = 0; i < sizeof(state->dtls_session_buffer); ++i) {
+        AVS_UNIT_ASSERT_EQUAL(state->dtls_session_buffer[i], 0x5A);
+    }
+    AVS_UNIT_ASSERT_EQUAL_STRING(state->last_local_port, "45683");
+    ANJAY_MUTEX_UNLOCK(anjay);
+    _anjay_test_dm_finish(anjay);
+
+    avs_stream_cleanup(&stream);
+}
+
+AVS_UNIT_TEST(session_persistence, restore_invalid) {
+    static const char DATA[] = "ACS\1\0\0\0\0";
+    avs_stream_inbuf_t inbuf = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&inbuf, DATA, sizeof(DATA) - 1);
+    anjay_t *anjay = _anjay_test_dm_init(DM_TEST_CONFIGURATION());
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_session_state_restore(anjay, (avs_stream_t *) &inbuf));
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NULL(anjay_unlocked->pending_session_states);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    _anjay_test_dm_finish(anjay);
+}
@@ -336,3 +336,10 @@ AVS_UNIT_TEST(snprintf, no_space_for_terminating_nullbyte) {
 AVS_UNIT_TEST(binding_mode_valid, unsupported_binding_mode) {
     AVS_UNIT_ASSERT_FALSE(anjay_binding_mode_valid("☃"));
 }
+
+AVS_UNIT_TEST(crc32, check_value) {
+    AVS_UNIT_ASSERT_EQUAL(_anjay_crc32(0, "123456789", 9),
+                          UINT32_C(0xCBF43926));
+    AVS_UNIT_ASSERT_EQUAL(_anjay_crc32(_anjay_crc32(0, "1234", 4), "56789", 5),
+                          UINT32_C(0xCBF43926));
+}
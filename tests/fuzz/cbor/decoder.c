@@ -10,8 +10,9 @@
 #include <anjay_init.h>
 
 #include <avsystem/commons/avs_defs.h>
-#include <avsystem/commons/avs_stream_file.h>
+#include <avsystem/commons/avs_stream_inbuf.h>
 
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -38,10 +39,22 @@ static int decode_string(anjay_json_like_decoder_t *decoder) {
     if (_anjay_io_cbor_get_bytes_ctx(decoder, &bytes)) {
         return -1;
     }
-    size_t remaining = bytes.bytes_available;
+    bool finished = false;
+    if (_anjay_io_cbor_has_payload_view(decoder)) {
+        while (!finished) {
+            const void *data;
+            size_t size;
+            if (_anjay_io_cbor_get_bytes_slice(decoder, &bytes, &data, &size,
+                                               &finished)) {
+                return -1;
+            }
+            assert(data || !size);
+        }
+        return 0;
+    }
 
+    size_t remaining = bytes.bytes_available;
     uint8_t buffer[1024];
-    bool finished = false;
     while (!finished) {
         size_t expected_bytes_count = AVS_MIN(sizeof(buffer), remaining);
         size_t bytes_read;
@@ -111,30 +124,42 @@ static int decode_value(anjay_json_like_decoder_t *decoder) {
     return 0;
 }
 
-static int decode_all(anjay_json_like_decoder_t *decoder) {
+static anjay_json_like_decoder_state_t
+decode_all(anjay_json_like_decoder_t *decoder) {
     int result = 0;
     while (!result) {
         result = decode_value(decoder);
     }
-    return result;
+    return _anjay_json_like_decoder_state(decoder);
 }
 
+static uint8_t INPUT[65536];
+
 int main(int argc, char **argv) {
     (void) argc;
     (void) argv;
 
-    avs_stream_t *fp =
-            avs_stream_file_create("/dev/stdin", AVS_STREAM_FILE_READ);
-    if (!fp) {
+    size_t input_size = fread(INPUT, 1, sizeof(INPUT), stdin);
+
+    // decode the same input through the stream and through the contiguous
+    // buffer fast path - both must come to the same conclusion
+    avs_stream_inbuf_t stream = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&stream, INPUT, input_size);
+    anjay_json_like_decoder_t *stream_decoder =
+            _anjay_cbor_decoder_new((avs_stream_t *) &stream,
+                                    MAX_LWM2M_CBOR_NEST_STACK_SIZE);
+    anjay_json_like_decoder_t *buffer_decoder =
+            _anjay_cbor_decoder_new_from_buffer(INPUT, input_size,
+                                                MAX_LWM2M_CBOR_NEST_STACK_SIZE);
+    if (!stream_decoder || !buffer_decoder) {
+        _anjay_json_like_decoder_delete(&stream_decoder);
+        _anjay_json_like_decoder_delete(&buffer_decoder);
         return -1;
     }
-    anjay_json_like_decoder_t *decoder = _anjay_cbor_decoder_new(fp);
-    if (!decoder) {
-        avs_stream_cleanup(&fp);
-        return -1;
+    if (decode_all(stream_decoder) != decode_all(buffer_decoder)) {
+        abort();
     }
-    int result = decode_all(decoder);
-    _anjay_json_like_decoder_delete(&decoder);
-    avs_stream_cleanup(&fp);
-    return result;
+    _anjay_json_like_decoder_delete(&stream_decoder);
+    _anjay_json_like_decoder_delete(&buffer_decoder);
+    return 0;
 }
@@ -3209,6 +3209,55 @@ class AdvancedFirmwareUpdateUriTestFourNotLinkedImagesAPPFirst(
         self.execute_update_and_check_success(Instances.MODEM)
 
 
+class AdvancedFirmwareUpdateCoapConcurrentDownloadsTest(
+    AdvancedFirmwareUpdate.TestWithCoapServer):
+    COMPONENTS = [(Instances.TEE, b'AJAY_TEE'),
+                  (Instances.BOOT, b'AJAYBOOT'),
+                  (Instances.MODEM, b'AJAYMODE')]
+
+    def setUp(self):
+        class MultiClientServer(coap.Server):
+            def send(self, *args, **kwargs):
+                result = super().send(*args, **kwargs)
+                self.reset()  # allow requests from other ports
+                return result
+
+        super().setUp(coap_server=MultiClientServer(),
+                      extra_cmdline_args=['--afu-max-concurrent-downloads',
+                                          str(len(self.COMPONENTS))])
+
+    def runTest(self):
+        with self.file_server as file_server:
+            for inst, magic in self.COMPONENTS:
+                path = '/firmware%d' % (inst,)
+                file_server.set_resource(path,
+                                         make_firmware_package(DUMMY_FILE,
+                                                               magic=magic,
+                                                               version=2))
+
+                # Write /33629/inst/1 (Package URI)
+                req = Lwm2mWrite(
+                    ResPath.AdvancedFirmwareUpdate[inst].PackageURI,
+                    file_server.get_resource_uri(path))
+                self.serv.send(req)
+                self.assertMsgEqual(Lwm2mChanged.matching(req)(),
+                                    self.serv.recv())
+
+            # While the file server is blocked, all downloads shall be started,
+            # each one using its own socket
+            self.wait_until_socket_count(expected=1 + len(self.COMPONENTS),
+                                         timeout_s=5)
+            for inst, _ in self.COMPONENTS:
+                self.assertEqual(UpdateState.DOWNLOADING,
+                                 self.read_state(inst))
+
+        for inst, _ in self.COMPONENTS:
+            self.wait_until_state_is(inst, UpdateState.DOWNLOADED,
+                                     timeout_s=20)
+            self.assertEqual(UpdateResult.INITIAL,
+                             self.read_update_result(inst))
+
+
 class AdvancedFirmwareUpdateTestLinkedTeeToApp(
     AdvancedFirmwareUpdate.TestWithHttpServer):
     def setUp(self):
@@ -0,0 +1,61 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+# AVSystem Anjay LwM2M SDK
+# All rights reserved.
+#
+# Licensed under the AVSystem-5-clause License.
+# See the attached LICENSE file for details.
+
+import tempfile
+
+from framework.lwm2m_test import *
+
+
+class SessionStatePersistence:
+    class Test(test_suite.Lwm2mDtlsSingleServerTest):
+        def _start_demo(self, cmdline_args, *args, **kwargs):
+            self.cmdline_args = cmdline_args
+            return super()._start_demo(cmdline_args, *args, **kwargs)
+
+        def setUp(self, extra_cmdline_args=[], *args, **kwargs):
+            self._session_state_file = tempfile.NamedTemporaryFile()
+            super().setUp(extra_cmdline_args=['--session-state-persistence-file',
+                                              self._session_state_file.name]
+                                             + extra_cmdline_args,
+                          *args, **kwargs)
+
+        def tearDown(self):
+            try:
+                super().tearDown()
+            finally:
+                self._session_state_file.close()
+
+        def restart_demo(self, discard_session_state=False):
+            self.request_demo_shutdown()
+            self.assertDemoDeregisters()
+            self._terminate_demo()
+            if discard_session_state:
+                self._session_state_file.truncate(0)
+                self._session_state_file.flush()
+            self._start_demo(self.cmdline_args)
+
+
+class SessionResumedAfterRestart(SessionStatePersistence.Test):
+    def runTest(self):
+        self.restart_demo()
+
+        # demo resumes the DTLS session persisted before the restart
+        self.serv.listen()
+        self.read_log_until_match(b'statefully resumed connection', timeout_s=5)
+        self.assertDemoRegisters()
+
+
+class SessionNotResumedWithoutPersistedState(SessionStatePersistence.Test):
+    def runTest(self):
+        self.restart_demo(discard_session_state=True)
+
+        # restoring fails gracefully and a full handshake is performed
+        self.serv.listen()
+        self.read_log_until_match(b'Cannot restore session state', timeout_s=5)
+        self.assertDemoRegisters()
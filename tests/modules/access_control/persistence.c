@@ -246,3 +246,100 @@ AVS_UNIT_TEST(access_control_persistence, normal_usage) {
     avs_free((anjay_dm_object_def_t *) (intptr_t) mock_obj1);
     avs_free((anjay_dm_object_def_t *) (intptr_t) mock_obj2);
 }
+
+AVS_UNIT_TEST(access_control_persistence, journal) {
+    anjay_t *anjay1 = ac_test_create_fake_anjay();
+    anjay_t *anjay2 = ac_test_create_fake_anjay();
+
+    storage_ctx_t snapshot = {
+        .buffer = { 0 }
+    };
+    init_context(&snapshot);
+    storage_ctx_t journal = {
+        .buffer = { 0 }
+    };
+    init_context(&journal);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_access_control_install(anjay1));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_access_control_install(anjay2));
+
+    access_control_t *ac1;
+    ANJAY_MUTEX_LOCK(anjay1_unlocked, anjay1);
+    ac1 = _anjay_access_control_get(anjay1_unlocked);
+    ANJAY_MUTEX_UNLOCK(anjay1);
+
+    access_control_t *ac2;
+    ANJAY_MUTEX_LOCK(anjay2_unlocked, anjay2);
+    ac2 = _anjay_access_control_get(anjay2_unlocked);
+    ANJAY_MUTEX_UNLOCK(anjay2);
+
+    const anjay_dm_object_def_t *mock_obj1 = make_mock_object(32);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_register_object(anjay1, &mock_obj1));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_register_object(anjay2, &mock_obj1));
+    // registered only in anjay1, so its instances are not restored in anjay2
+    const anjay_dm_object_def_t *mock_obj2 = make_mock_object(64);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_register_object(anjay1, &mock_obj2));
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_access_control_add_instance(
+            ac1,
+            _anjay_access_control_create_missing_ac_instance(
+                    &(const acl_target_t) {
+                        .oid = mock_obj1->oid,
+                        .iid = 1
+                    }),
+            NULL));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_access_control_persist(
+            anjay1, (avs_stream_t *) &snapshot.out));
+
+    // no changes yet, so the journal stays empty
+    AVS_UNIT_ASSERT_SUCCESS(anjay_access_control_journal_append(
+            anjay1, (avs_stream_t *) &journal.out));
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&journal.out), 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_access_control_add_instance(
+            ac1,
+            _anjay_access_control_create_missing_ac_instance(
+                    &(const acl_target_t) {
+                        .oid = mock_obj1->oid,
+                        .iid = 2
+                    }),
+            NULL));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_access_control_add_instance(
+            ac1,
+            _anjay_access_control_create_missing_ac_instance(
+                    &(const acl_target_t) {
+                        .oid = mock_obj2->oid,
+                        .iid = 1
+                    }),
+            NULL));
+    _anjay_access_control_mark_modified(ac1);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_access_control_journal_append(
+            anjay1, (avs_stream_t *) &journal.out));
+    AVS_UNIT_ASSERT_FALSE(anjay_access_control_is_modified(anjay1));
+
+    ac1->current.instances->owner = 42;
+    _anjay_access_control_mark_instance_modified(ac1, ac1->current.instances);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_access_control_journal_append(
+            anjay1, (avs_stream_t *) &journal.out));
+
+    snapshot.in.buffer_size = avs_stream_outbuf_offset(&snapshot.out);
+    journal.in.buffer_size = avs_stream_outbuf_offset(&journal.out);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_access_control_journal_restore(
+            anjay2, (avs_stream_t *) &snapshot.in,
+            (avs_stream_t *) &journal.in));
+
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(ac1->current.instances), 3);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(ac2->current.instances), 2);
+    AVS_UNIT_ASSERT_TRUE(instances_equal(ac1->current.instances,
+                                         ac2->current.instances));
+    AVS_UNIT_ASSERT_EQUAL(ac2->current.instances->owner, 42);
+    AVS_UNIT_ASSERT_TRUE(
+            instances_equal(AVS_LIST_NEXT(ac1->current.instances),
+                            AVS_LIST_NEXT(ac2->current.instances)));
+
+    anjay_delete(anjay1);
+    anjay_delete(anjay2);
+
+    avs_free((anjay_dm_object_def_t *) (intptr_t) mock_obj1);
+    avs_free((anjay_dm_object_def_t *) (intptr_t) mock_obj2);
+}
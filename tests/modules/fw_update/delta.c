@@ -0,0 +1,196 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_test.h>
+
+static const char SOURCE[] = "The quick brown fox jumps over the lazy dog";
+
+typedef struct {
+    char output[128];
+    size_t output_size;
+} test_env_t;
+
+static int test_stream_write(void *env_, const void *data, size_t length) {
+    test_env_t *env = (test_env_t *) env_;
+    AVS_UNIT_ASSERT_TRUE(env->output_size + length <= sizeof(env->output));
+    memcpy(env->output + env->output_size, data, length);
+    env->output_size += length;
+    return 0;
+}
+
+static int test_read_current(void *env,
+                             size_t offset,
+                             void *buffer,
+                             size_t length) {
+    (void) env;
+    if (offset + length > sizeof(SOURCE) - 1) {
+        return -1;
+    }
+    memcpy(buffer, SOURCE + offset, length);
+    return 0;
+}
+
+static const anjay_fw_update_handlers_t HANDLERS = {
+    .stream_write = test_stream_write,
+    .read_current = test_read_current
+};
+
+// CRC-32 of SOURCE
+#define SOURCE_CRC "\x41\x4f\xa3\x39"
+#define HEADER(SourceSize, SourceCrc, TargetSize, TargetCrc)             \
+    "ANJDELTA\x00\x00\x00" SourceSize SourceCrc "\x00\x00\x00" TargetSize \
+            TargetCrc
+#define COPY(Offset, Length) "\x01\x00\x00\x00" Offset "\x00\x00\x00" Length
+#define INSERT(Length) "\x02\x00\x00\x00" Length
+
+// "The quick red fox jumps over the lazy dog"
+#define TARGET_CRC "\xe1\xad\x7b\x5e"
+static const char DELTA[] =
+        HEADER("\x2b", SOURCE_CRC, "\x29", TARGET_CRC) COPY("\x00", "\x0a")
+                INSERT("\x03") "red" COPY("\x0f", "\x1c");
+
+static int apply(test_env_t *env,
+                 const void *package,
+                 size_t package_size,
+                 size_t chunk_size) {
+    anjay_fw_update_delta_t delta;
+    memset(&delta, 0, sizeof(delta));
+    const char *data = (const char *) package;
+    int result = 0;
+    for (size_t offset = 0; !result && offset < package_size;
+         offset += chunk_size) {
+        result = _anjay_fw_update_delta_write(
+                &delta, &HANDLERS, env, data + offset,
+                AVS_MIN(chunk_size, package_size - offset));
+    }
+    if (!result) {
+        result = _anjay_fw_update_delta_finish(&delta, &HANDLERS, env);
+    }
+    _anjay_fw_update_delta_reset(&delta);
+    return result;
+}
+
+AVS_UNIT_TEST(fw_update_delta, apply) {
+    static const char EXPECTED[] = "The quick red fox jumps over the lazy dog";
+    for (size_t chunk_size = 1; chunk_size <= sizeof(DELTA); ++chunk_size) {
+        test_env_t env = { 0 };
+        AVS_UNIT_ASSERT_SUCCESS(
+                apply(&env, DELTA, sizeof(DELTA) - 1, chunk_size));
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.output, EXPECTED,
+                                          sizeof(EXPECTED) - 1);
+        AVS_UNIT_ASSERT_EQUAL(env.output_size, sizeof(EXPECTED) - 1);
+    }
+}
+
+AVS_UNIT_TEST(fw_update_delta, generated_by_tool) {
+    // tools/fw_delta.py diff, for the same source and target as DELTA; checked
+    // against the script by tools/fw_delta.py selftest
+    static const char PACKAGE[] =
+            HEADER("\x2b", SOURCE_CRC, "\x29", TARGET_CRC) INSERT("\x0d")
+                    "The quick red" COPY("\x0f", "\x1c");
+    static const char EXPECTED[] = "The quick red fox jumps over the lazy dog";
+    test_env_t env = { 0 };
+    AVS_UNIT_ASSERT_SUCCESS(apply(&env, PACKAGE, sizeof(PACKAGE) - 1, 16));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.output, EXPECTED,
+                                      sizeof(EXPECTED) - 1);
+    AVS_UNIT_ASSERT_EQUAL(env.output_size, sizeof(EXPECTED) - 1);
+}
+
+AVS_UNIT_TEST(fw_update_delta, source_checksum_mismatch) {
+    static const char PACKAGE[] =
+            HEADER("\x2b", "\x41\x4f\xa3\x38", "\x03", "\x00\x00\x00\x00")
+                    COPY("\x00", "\x03");
+    test_env_t env = { 0 };
+    AVS_UNIT_ASSERT_EQUAL(apply(&env, PACKAGE, sizeof(PACKAGE) - 1, 64),
+                          ANJAY_FW_UPDATE_ERR_UNSUPPORTED_PACKAGE_TYPE);
+    AVS_UNIT_ASSERT_EQUAL(env.output_size, 0);
+}
+
+AVS_UNIT_TEST(fw_update_delta, source_larger_than_current_image) {
+    // the installed image only has 0x2b bytes
+    static const char PACKAGE[] =
+            HEADER("\x2c", SOURCE_CRC, "\x03", "\x00\x00\x00\x00")
+                    COPY("\x00", "\x03");
+    test_env_t env = { 0 };
+    AVS_UNIT_ASSERT_FAILED(apply(&env, PACKAGE, sizeof(PACKAGE) - 1, 64));
+    AVS_UNIT_ASSERT_EQUAL(env.output_size, 0);
+}
+
+AVS_UNIT_TEST(fw_update_delta, target_checksum_mismatch) {
+    static const char PACKAGE[] =
+            HEADER("\x2b", SOURCE_CRC, "\x29", "\xe1\xad\x7b\x5f")
+                    COPY("\x00", "\x0a") INSERT("\x03") "red"
+                            COPY("\x0f", "\x1c");
+    test_env_t env = { 0 };
+    AVS_UNIT_ASSERT_EQUAL(apply(&env, PACKAGE, sizeof(PACKAGE) - 1, 64),
+                          ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE);
+}
+
+AVS_UNIT_TEST(fw_update_delta, passthrough) {
+    static const char FULL_IMAGE[] = "ANJDELTB is not a delta package";
+    for (size_t chunk_size = 1; chunk_size <= sizeof(FULL_IMAGE);
+         ++chunk_size) {
+        test_env_t env = { 0 };
+        AVS_UNIT_ASSERT_SUCCESS(
+                apply(&env, FULL_IMAGE, sizeof(FULL_IMAGE) - 1, chunk_size));
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.output, FULL_IMAGE,
+                                          sizeof(FULL_IMAGE) - 1);
+        AVS_UNIT_ASSERT_EQUAL(env.output_size, sizeof(FULL_IMAGE) - 1);
+    }
+}
+
+AVS_UNIT_TEST(fw_update_delta, passthrough_shorter_than_magic) {
+    test_env_t env = { 0 };
+    AVS_UNIT_ASSERT_SUCCESS(apply(&env, "ANJ", 3, 1));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.output, "ANJ", 3);
+    AVS_UNIT_ASSERT_EQUAL(env.output_size, 3);
+}
+
+AVS_UNIT_TEST(fw_update_delta, truncated) {
+    test_env_t env = { 0 };
+    AVS_UNIT_ASSERT_EQUAL(apply(&env, DELTA, sizeof(DELTA) - 2, 7),
+                          ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE);
+}
+
+AVS_UNIT_TEST(fw_update_delta, trailing_data) {
+    static const char PACKAGE[] =
+            HEADER("\x2b", SOURCE_CRC, "\x03", "\x00\x00\x00\x00")
+                    COPY("\x00", "\x03") INSERT("\x00");
+    test_env_t env = { 0 };
+    AVS_UNIT_ASSERT_EQUAL(apply(&env, PACKAGE, sizeof(PACKAGE) - 1, 64),
+                          ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE);
+}
+
+AVS_UNIT_TEST(fw_update_delta, copy_out_of_bounds) {
+    static const char PACKAGE[] =
+            HEADER("\x2b", SOURCE_CRC, "\x10", "\x00\x00\x00\x00")
+                    COPY("\x20", "\x10");
+    test_env_t env = { 0 };
+    AVS_UNIT_ASSERT_EQUAL(apply(&env, PACKAGE, sizeof(PACKAGE) - 1, 64),
+                          ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE);
+    AVS_UNIT_ASSERT_EQUAL(env.output_size, 0);
+}
+
+AVS_UNIT_TEST(fw_update_delta, target_size_exceeded) {
+    static const char PACKAGE[] =
+            HEADER("\x2b", SOURCE_CRC, "\x02", "\x00\x00\x00\x00")
+                    INSERT("\x03") "red";
+    test_env_t env = { 0 };
+    AVS_UNIT_ASSERT_EQUAL(apply(&env, PACKAGE, sizeof(PACKAGE) - 1, 64),
+                          ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE);
+    AVS_UNIT_ASSERT_EQUAL(env.output_size, 0);
+}
+
+AVS_UNIT_TEST(fw_update_delta, unknown_command) {
+    static const char PACKAGE[] =
+            HEADER("\x2b", SOURCE_CRC, "\x02", "\x00\x00\x00\x00") "\x07";
+    test_env_t env = { 0 };
+    AVS_UNIT_ASSERT_EQUAL(apply(&env, PACKAGE, sizeof(PACKAGE) - 1, 64),
+                          ANJAY_FW_UPDATE_ERR_INTEGRITY_FAILURE);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "tests/utils/utils.h"
+
+#define TEST_OID 3313
+#define TEST_INSTANCE_COUNT 2
+
+static const anjay_configuration_t CONFIG = {
+    .endpoint_name = "test"
+};
+
+static const anjay_ipso_v2_3d_sensor_meta_t TEST_META = {
+    .unit = "g",
+    .y_axis_present = true,
+    .min_max_measured_value_present = true,
+    .min_range_value = NAN,
+    .max_range_value = NAN
+};
+
+static void anjay_delete_ptr(anjay_t **anjay) {
+    anjay_delete(*anjay);
+}
+
+#define SCOPED_TEST_ANJAY(Name) \
+    SCOPED_PTR(anjay_t, anjay_delete_ptr) Name = create_anjay()
+
+static anjay_t *create_anjay(void) {
+    anjay_t *anjay = anjay_new(&CONFIG);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_3d_sensor_install(
+            anjay, TEST_OID, NULL, TEST_INSTANCE_COUNT));
+    for (anjay_iid_t iid = 0; iid < TEST_INSTANCE_COUNT; ++iid) {
+        AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_3d_sensor_instance_add(
+                anjay, TEST_OID, iid,
+                &(const sensor_value_t) {
+                    .x = 1.0,
+                    .y = 2.0
+                },
+                &TEST_META));
+    }
+    return anjay;
+}
+
+static const instance_t *get_instance(anjay_t *anjay_locked, anjay_iid_t iid) {
+    const instance_t *inst = NULL;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    object_t *obj = obj_from_oid(anjay, TEST_OID);
+    AVS_UNIT_ASSERT_NOT_NULL(obj);
+    inst = &obj->instances[iid];
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return inst;
+}
+
+static void assert_untouched(anjay_t *anjay) {
+    for (anjay_iid_t iid = 0; iid < TEST_INSTANCE_COUNT; ++iid) {
+        const instance_t *inst = get_instance(anjay, iid);
+        AVS_UNIT_ASSERT_EQUAL(inst->curr_value.x, 1.0);
+        AVS_UNIT_ASSERT_EQUAL(inst->curr_value.y, 2.0);
+        AVS_UNIT_ASSERT_EQUAL(inst->max_value.x, 1.0);
+        AVS_UNIT_ASSERT_EQUAL(inst->max_value.y, 2.0);
+    }
+}
+
+AVS_UNIT_TEST(ipso_v2_3d_sensor, values_update) {
+    SCOPED_TEST_ANJAY(anjay);
+    const anjay_ipso_v2_3d_sensor_value_entry_t entries[] = {
+        { 1, { 3.0, 4.0, NAN } },
+        { 0, { -1.0, 5.0, NAN } }
+    };
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_3d_sensor_values_update(
+            anjay, TEST_OID, entries, AVS_ARRAY_SIZE(entries)));
+
+    const instance_t *inst = get_instance(anjay, 0);
+    AVS_UNIT_ASSERT_EQUAL(inst->curr_value.x, -1.0);
+    AVS_UNIT_ASSERT_EQUAL(inst->curr_value.y, 5.0);
+    AVS_UNIT_ASSERT_EQUAL(inst->min_value.x, -1.0);
+    AVS_UNIT_ASSERT_EQUAL(inst->max_value.y, 5.0);
+    inst = get_instance(anjay, 1);
+    AVS_UNIT_ASSERT_EQUAL(inst->curr_value.x, 3.0);
+    AVS_UNIT_ASSERT_EQUAL(inst->curr_value.y, 4.0);
+    AVS_UNIT_ASSERT_EQUAL(inst->max_value.x, 3.0);
+}
+
+AVS_UNIT_TEST(ipso_v2_3d_sensor, values_update_invalid_value) {
+    SCOPED_TEST_ANJAY(anjay);
+    // Y axis is present, so it must be a valid number
+    const anjay_ipso_v2_3d_sensor_value_entry_t entries[] = {
+        { 0, { 3.0, 4.0, NAN } },
+        { 1, { 3.0, NAN, NAN } }
+    };
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_3d_sensor_values_update(
+            anjay, TEST_OID, entries, AVS_ARRAY_SIZE(entries)));
+    assert_untouched(anjay);
+}
+
+AVS_UNIT_TEST(ipso_v2_3d_sensor, values_update_iid_out_of_range) {
+    SCOPED_TEST_ANJAY(anjay);
+    const anjay_ipso_v2_3d_sensor_value_entry_t entries[] = {
+        { 0, { 3.0, 4.0, NAN } },
+        { TEST_INSTANCE_COUNT, { 3.0, 4.0, NAN } }
+    };
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_3d_sensor_values_update(
+            anjay, TEST_OID, entries, AVS_ARRAY_SIZE(entries)));
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_3d_sensor_value_update(
+            anjay, TEST_OID, TEST_INSTANCE_COUNT, &entries[0].value));
+    assert_untouched(anjay);
+}
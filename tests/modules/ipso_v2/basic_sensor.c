@@ -0,0 +1,138 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "tests/utils/utils.h"
+
+#define TEST_OID 3303
+#define TEST_INSTANCE_COUNT 3
+
+static const anjay_configuration_t CONFIG = {
+    .endpoint_name = "test"
+};
+
+static const anjay_ipso_v2_basic_sensor_meta_t TEST_META = {
+    .unit = "Cel",
+    .min_max_measured_value_present = true,
+    .min_range_value = NAN,
+    .max_range_value = NAN
+};
+
+static void anjay_delete_ptr(anjay_t **anjay) {
+    anjay_delete(*anjay);
+}
+
+#define SCOPED_TEST_ANJAY(Name) \
+    SCOPED_PTR(anjay_t, anjay_delete_ptr) Name = create_anjay()
+
+static anjay_t *create_anjay(void) {
+    anjay_t *anjay = anjay_new(&CONFIG);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_install(
+            anjay, TEST_OID, NULL, TEST_INSTANCE_COUNT));
+    // instance 1 is left uninitialized
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_OID, 0, 10.0, &TEST_META));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_OID, 2, 20.0, &TEST_META));
+    return anjay;
+}
+
+static const instance_t *get_instance(anjay_t *anjay_locked, anjay_iid_t iid) {
+    const instance_t *inst = NULL;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    object_t *obj = obj_from_oid(anjay, TEST_OID);
+    AVS_UNIT_ASSERT_NOT_NULL(obj);
+    inst = &obj->instances[iid];
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return inst;
+}
+
+static void assert_untouched(anjay_t *anjay) {
+    const instance_t *inst = get_instance(anjay, 0);
+    AVS_UNIT_ASSERT_EQUAL(inst->curr_value, 10.0);
+    AVS_UNIT_ASSERT_EQUAL(inst->min_value, 10.0);
+    AVS_UNIT_ASSERT_EQUAL(inst->max_value, 10.0);
+    inst = get_instance(anjay, 2);
+    AVS_UNIT_ASSERT_EQUAL(inst->curr_value, 20.0);
+    AVS_UNIT_ASSERT_EQUAL(inst->min_value, 20.0);
+    AVS_UNIT_ASSERT_EQUAL(inst->max_value, 20.0);
+}
+
+AVS_UNIT_TEST(ipso_v2_basic_sensor, values_update) {
+    SCOPED_TEST_ANJAY(anjay);
+    const anjay_ipso_v2_basic_sensor_value_entry_t entries[] = {
+        { 0, 5.0 },
+        { 2, 25.0 },
+        { 0, 15.0 }
+    };
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_values_update(
+            anjay, TEST_OID, entries, AVS_ARRAY_SIZE(entries)));
+
+    // same as updating each entry in order
+    const instance_t *inst = get_instance(anjay, 0);
+    AVS_UNIT_ASSERT_EQUAL(inst->curr_value, 15.0);
+    AVS_UNIT_ASSERT_EQUAL(inst->min_value, 5.0);
+    AVS_UNIT_ASSERT_EQUAL(inst->max_value, 15.0);
+    inst = get_instance(anjay, 2);
+    AVS_UNIT_ASSERT_EQUAL(inst->curr_value, 25.0);
+    AVS_UNIT_ASSERT_EQUAL(inst->min_value, 20.0);
+    AVS_UNIT_ASSERT_EQUAL(inst->max_value, 25.0);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_ipso_v2_basic_sensor_values_update(anjay, TEST_OID, NULL, 0));
+}
+
+AVS_UNIT_TEST(ipso_v2_basic_sensor, values_update_invalid_value) {
+    SCOPED_TEST_ANJAY(anjay);
+    const anjay_ipso_v2_basic_sensor_value_entry_t entries[] = {
+        { 0, 5.0 },
+        { 2, 25.0 },
+        { 0, NAN }
+    };
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_basic_sensor_values_update(
+            anjay, TEST_OID, entries, AVS_ARRAY_SIZE(entries)));
+    assert_untouched(anjay);
+}
+
+AVS_UNIT_TEST(ipso_v2_basic_sensor, values_update_uninitialized_instance) {
+    SCOPED_TEST_ANJAY(anjay);
+    const anjay_ipso_v2_basic_sensor_value_entry_t entries[] = {
+        { 0, 5.0 },
+        { 1, 15.0 },
+        { 2, 25.0 }
+    };
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_basic_sensor_values_update(
+            anjay, TEST_OID, entries, AVS_ARRAY_SIZE(entries)));
+    assert_untouched(anjay);
+}
+
+AVS_UNIT_TEST(ipso_v2_basic_sensor, values_update_iid_out_of_range) {
+    SCOPED_TEST_ANJAY(anjay);
+    const anjay_ipso_v2_basic_sensor_value_entry_t entries[] = {
+        { 0, 5.0 },
+        { TEST_INSTANCE_COUNT, 15.0 }
+    };
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_basic_sensor_values_update(
+            anjay, TEST_OID, entries, AVS_ARRAY_SIZE(entries)));
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_basic_sensor_value_update(
+            anjay, TEST_OID, TEST_INSTANCE_COUNT, 15.0));
+    assert_untouched(anjay);
+}
+
+AVS_UNIT_TEST(ipso_v2_basic_sensor, values_update_not_installed) {
+    SCOPED_TEST_ANJAY(anjay);
+    const anjay_ipso_v2_basic_sensor_value_entry_t entries[] = {
+        { 0, 5.0 }
+    };
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_basic_sensor_values_update(
+            anjay, TEST_OID + 1, entries, AVS_ARRAY_SIZE(entries)));
+    assert_untouched(anjay);
+}
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <math.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include <anjay/ipso_objects_v2.h>
+
+#ifdef ANJAY_WITH_SEND
+#    include "src/core/io/anjay_batch_builder.h"
+#endif // ANJAY_WITH_SEND
+
+#include "tests/utils/utils.h"
+
+static const anjay_configuration_t CONFIG = {
+    .endpoint_name = "test"
+};
+
+static void anjay_delete_ptr(anjay_t **anjay) {
+    anjay_delete(*anjay);
+}
+
+#define SCOPED_TEST_ANJAY(Name) \
+    SCOPED_PTR(anjay_t, anjay_delete_ptr) Name = anjay_new(&CONFIG)
+
+static anjay_ipso_v2_history_t *
+create_history(anjay_t *anjay_locked, size_t depth, size_t decimation) {
+    anjay_ipso_v2_history_t *history = NULL;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    history = _anjay_ipso_v2_history_create(anjay, depth, decimation, 1);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    AVS_UNIT_ASSERT_NOT_NULL(history);
+    return history;
+}
+
+static void record(anjay_ipso_v2_history_t *history, double value) {
+    _anjay_ipso_v2_history_record(history, &value);
+}
+
+static void assert_samples(const anjay_ipso_v2_history_t *history,
+                           const double *expected,
+                           size_t expected_count) {
+    AVS_UNIT_ASSERT_EQUAL(history->count, expected_count);
+    for (size_t i = 0; i < expected_count; ++i) {
+        AVS_UNIT_ASSERT_EQUAL(
+                history->values[(history->first + i) % history->depth],
+                expected[i]);
+    }
+}
+
+AVS_UNIT_TEST(ipso_v2_history, record) {
+    SCOPED_TEST_ANJAY(anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    anjay_ipso_v2_history_t *history = create_history(anjay, 3, 0);
+
+    record(history, 1.0);
+    record(history, 2.0);
+    assert_samples(history, (const double[]) { 1.0, 2.0 }, 2);
+}
+
+AVS_UNIT_TEST(ipso_v2_history, wrap_around) {
+    SCOPED_TEST_ANJAY(anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    anjay_ipso_v2_history_t *history = create_history(anjay, 3, 1);
+
+    for (int i = 1; i <= 5; ++i) {
+        record(history, (double) i);
+    }
+    // the oldest samples are overwritten
+    assert_samples(history, (const double[]) { 3.0, 4.0, 5.0 }, 3);
+
+    _anjay_ipso_v2_history_clear(history);
+    assert_samples(history, NULL, 0);
+    record(history, 6.0);
+    assert_samples(history, (const double[]) { 6.0 }, 1);
+}
+
+AVS_UNIT_TEST(ipso_v2_history, decimation) {
+    SCOPED_TEST_ANJAY(anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    anjay_ipso_v2_history_t *history = create_history(anjay, 3, 3);
+
+    for (int i = 1; i <= 7; ++i) {
+        record(history, (double) i);
+    }
+    assert_samples(history, (const double[]) { 3.0, 6.0 }, 2);
+    AVS_UNIT_ASSERT_EQUAL(history->skipped, 1);
+}
+
+AVS_UNIT_TEST(ipso_v2_history, delete_buffer) {
+    SCOPED_TEST_ANJAY(anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    anjay_ipso_v2_history_t *first = create_history(anjay, 3, 1);
+    anjay_ipso_v2_history_t *second = create_history(anjay, 3, 1);
+    record(second, 1.0);
+
+    history_module_t *module = NULL;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    _anjay_ipso_v2_history_delete(anjay_unlocked, &first);
+    // deleting an already deleted buffer is a no-op
+    _anjay_ipso_v2_history_delete(anjay_unlocked, &first);
+    module = (history_module_t *) _anjay_dm_module_get_arg(
+            anjay_unlocked, history_module_delete);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    AVS_UNIT_ASSERT_NULL(first);
+    AVS_UNIT_ASSERT_NOT_NULL(module);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(module->buffers), 1);
+    AVS_UNIT_ASSERT_TRUE(module->buffers == second);
+    assert_samples(second, (const double[]) { 1.0 }, 1);
+}
+
+#ifdef ANJAY_WITH_SEND
+static size_t builder_size(anjay_send_batch_builder_t *builder) {
+    return AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list);
+}
+
+AVS_UNIT_TEST(ipso_v2_history, add_to_batch) {
+    SCOPED_TEST_ANJAY(anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    anjay_ipso_v2_history_t *history = create_history(anjay, 3, 1);
+    anjay_send_batch_builder_t *builder = anjay_send_batch_builder_new();
+    AVS_UNIT_ASSERT_NOT_NULL(builder);
+
+    for (int i = 1; i <= 4; ++i) {
+        record(history, (double) i);
+    }
+    static const anjay_rid_t rid = 5700;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_ipso_v2_history_add_to_batch(history, builder, 3303, 0,
+                                                &rid));
+    AVS_UNIT_ASSERT_EQUAL(builder_size(builder), 3);
+    // the buffer is only cleared explicitly
+    assert_samples(history, (const double[]) { 2.0, 3.0, 4.0 }, 3);
+
+    anjay_send_batch_builder_cleanup(&builder);
+}
+
+AVS_UNIT_TEST(ipso_v2_history, add_to_batch_failure) {
+    SCOPED_TEST_ANJAY(anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    anjay_ipso_v2_history_t *history = NULL;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    history = _anjay_ipso_v2_history_create(anjay_unlocked, 3, 1, 2);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(history);
+    anjay_send_batch_builder_t *builder = anjay_send_batch_builder_new();
+    AVS_UNIT_ASSERT_NOT_NULL(builder);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_add_int(
+            builder, 3303, 0, 5701, ANJAY_ID_INVALID, avs_time_real_now(), 42));
+    _anjay_ipso_v2_history_record(history, (const double[]) { 1.0, 2.0 });
+    _anjay_ipso_v2_history_record(history, (const double[]) { 3.0, 4.0 });
+
+    // the first axis of the first sample is added before the failure
+    static const anjay_rid_t invalid_rids[] = { 5702, ANJAY_ID_INVALID };
+    AVS_UNIT_ASSERT_FAILED(_anjay_ipso_v2_history_add_to_batch(
+            history, builder, 3313, 0, invalid_rids));
+    AVS_UNIT_ASSERT_EQUAL(builder_size(builder), 1);
+    AVS_UNIT_ASSERT_EQUAL(history->count, 2);
+
+    static const anjay_rid_t rids[] = { 5702, 5703 };
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ipso_v2_history_add_to_batch(
+            history, builder, 3313, 0, rids));
+    AVS_UNIT_ASSERT_EQUAL(builder_size(builder), 5);
+
+    anjay_send_batch_builder_cleanup(&builder);
+}
+
+#    define TEST_SENSOR_OID 3303
+
+static const anjay_ipso_v2_basic_sensor_meta_t TEST_SENSOR_META = {
+    .min_range_value = NAN,
+    .max_range_value = NAN,
+    .history_depth = 2
+};
+
+AVS_UNIT_TEST(ipso_v2_history, sensor_drain) {
+    SCOPED_TEST_ANJAY(anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_install(
+            anjay, TEST_SENSOR_OID, NULL, 2));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_SENSOR_OID, 0, 1.0, &TEST_SENSOR_META));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_SENSOR_OID, 1, 1.0, &TEST_SENSOR_META));
+    for (int i = 2; i <= 4; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_value_update(
+                anjay, TEST_SENSOR_OID, 0, (double) i));
+    }
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_value_update(
+            anjay, TEST_SENSOR_OID, 1, 2.0));
+
+    anjay_send_batch_builder_t *builder = anjay_send_batch_builder_new();
+    AVS_UNIT_ASSERT_NOT_NULL(builder);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_history_drain(
+            anjay, TEST_SENSOR_OID, builder));
+    // depth of 2 for instance 0, and a single update of instance 1
+    AVS_UNIT_ASSERT_EQUAL(builder_size(builder), 3);
+
+    // buffers are empty after a successful drain
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_history_drain(
+            anjay, TEST_SENSOR_OID, builder));
+    AVS_UNIT_ASSERT_EQUAL(builder_size(builder), 3);
+
+    anjay_send_batch_builder_cleanup(&builder);
+}
+
+AVS_UNIT_TEST(ipso_v2_history, sensor_drain_after_instance_remove) {
+    SCOPED_TEST_ANJAY(anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_install(
+            anjay, TEST_SENSOR_OID, NULL, 2));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_SENSOR_OID, 0, 1.0, &TEST_SENSOR_META));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_SENSOR_OID, 1, 1.0, &TEST_SENSOR_META));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_value_update(
+            anjay, TEST_SENSOR_OID, 0, 2.0));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_value_update(
+            anjay, TEST_SENSOR_OID, 1, 2.0));
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_ipso_v2_basic_sensor_instance_remove(anjay, TEST_SENSOR_OID,
+                                                       0));
+
+    history_module_t *module = NULL;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    module = (history_module_t *) _anjay_dm_module_get_arg(
+            anjay_unlocked, history_module_delete);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(module);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(module->buffers), 1);
+
+    anjay_send_batch_builder_t *builder = anjay_send_batch_builder_new();
+    AVS_UNIT_ASSERT_NOT_NULL(builder);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_history_drain(
+            anjay, TEST_SENSOR_OID, builder));
+    AVS_UNIT_ASSERT_EQUAL(builder_size(builder), 2);
+
+    anjay_send_batch_builder_cleanup(&builder);
+}
+#endif // ANJAY_WITH_SEND
@@ -311,3 +311,62 @@ AVS_UNIT_TEST(security_persistence, modification_flag_purge) {
     anjay_security_object_purge(env->anjay_stored);
     AVS_UNIT_ASSERT_TRUE(anjay_security_object_is_modified(env->anjay_stored));
 }
+
+static const anjay_security_instance_t SERVER_INSTANCE = {
+    .ssid = 1,
+    .server_uri = "coap://pet.friendly/",
+    .security_mode = ANJAY_SECURITY_NOSEC,
+    .client_holdoff_s = -1,
+    .bootstrap_timeout_s = -1
+};
+
+AVS_UNIT_TEST(security_persistence, journal_store_restore) {
+    SCOPED_SECURITY_PERSISTENCE_TEST_ENV(env);
+    avs_stream_t *journal = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(journal);
+    anjay_iid_t iid = ANJAY_ID_INVALID;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_security_object_add_instance(
+            env->anjay_stored, &BOOTSTRAP_INSTANCE, &iid));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_security_object_persist(env->anjay_stored, env->stream));
+
+    iid = ANJAY_ID_INVALID;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_security_object_add_instance(
+            env->anjay_stored, &SERVER_INSTANCE, &iid));
+    AVS_UNIT_ASSERT_TRUE(anjay_security_object_is_modified(env->anjay_stored));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_security_object_journal_append(env->anjay_stored, journal));
+    AVS_UNIT_ASSERT_FALSE(anjay_security_object_is_modified(env->anjay_stored));
+
+    /* Incomplete record, as if power was lost while appending it */
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(journal, "\x00\x00\x01", 3));
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_security_object_journal_restore(
+            env->anjay_restored, env->stream, journal));
+    AVS_UNIT_ASSERT_FALSE(
+            anjay_security_object_is_modified(env->anjay_restored));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(env->restored_repr->instances), 2);
+    assert_objects_equal(_anjay_sec_get(env->stored),
+                         _anjay_sec_get(env->restored));
+    avs_stream_cleanup(&journal);
+}
+
+AVS_UNIT_TEST(security_persistence, journal_purge) {
+    SCOPED_SECURITY_PERSISTENCE_TEST_ENV(env);
+    avs_stream_t *journal = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(journal);
+    anjay_iid_t iid = ANJAY_ID_INVALID;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_security_object_add_instance(
+            env->anjay_stored, &BOOTSTRAP_INSTANCE, &iid));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_security_object_persist(env->anjay_stored, env->stream));
+
+    anjay_security_object_purge(env->anjay_stored);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_security_object_journal_append(env->anjay_stored, journal));
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_security_object_journal_restore(
+            env->anjay_restored, env->stream, journal));
+    AVS_UNIT_ASSERT_NULL(env->restored_repr->instances);
+    avs_stream_cleanup(&journal);
+}
@@ -303,3 +303,85 @@ AVS_UNIT_TEST(server_persistence, modification_flag_purge) {
     anjay_server_object_purge(env->anjay_stored);
     AVS_UNIT_ASSERT_TRUE(anjay_server_object_is_modified(env->anjay_stored));
 }
+
+AVS_UNIT_TEST(server_persistence, journal_store_restore) {
+    SCOPED_SERVER_PERSISTENCE_TEST_ENV(env);
+    avs_stream_t *journal = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(journal);
+    anjay_server_instance_t instance = {
+        .ssid = 42,
+        .lifetime = 9001,
+        .default_min_period = -1,
+        .default_max_period = -1,
+        .disable_timeout = -1,
+        .binding = "U",
+        .notification_storing = true
+    };
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_add_instance(
+            env->anjay_stored, &instance, &iid));
+    /* Journal may also be replayed onto an empty Object */
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_journal_append(env->anjay_stored, journal));
+    AVS_UNIT_ASSERT_FALSE(anjay_server_object_is_modified(env->anjay_stored));
+
+    /* No changes - nothing written */
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_journal_append(env->anjay_stored, journal));
+
+    instance.ssid = 43;
+    instance.lifetime = 3600;
+    iid = 2;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_add_instance(
+            env->anjay_stored, &instance, &iid));
+    env->stored_repr->instances->lifetime = 86400;
+    _anjay_serv_mark_instance_modified(env->stored_repr,
+                                       env->stored_repr->instances);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_journal_append(env->anjay_stored, journal));
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_journal_restore(
+            env->anjay_restored, NULL, journal));
+    AVS_UNIT_ASSERT_EQUAL(2, AVS_LIST_SIZE(env->restored_repr->instances));
+    AVS_UNIT_ASSERT_EQUAL(env->restored_repr->instances->lifetime, 86400);
+    assert_instances_equal(env->stored_repr->instances,
+                           env->restored_repr->instances);
+    assert_instances_equal(AVS_LIST_NEXT(env->stored_repr->instances),
+                           AVS_LIST_NEXT(env->restored_repr->instances));
+    avs_stream_cleanup(&journal);
+}
+
+AVS_UNIT_TEST(server_persistence, journal_invalid_state_not_restored) {
+    SCOPED_SERVER_PERSISTENCE_TEST_ENV(env);
+    avs_stream_t *journal = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(journal);
+    const anjay_server_instance_t instance = {
+        .ssid = 42,
+        .lifetime = 9001,
+        .default_min_period = -1,
+        .default_max_period = -1,
+        .disable_timeout = -1,
+        .binding = "U",
+        .notification_storing = true
+    };
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_add_instance(
+            env->anjay_stored, &instance, &iid));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_persist(env->anjay_stored, env->stream));
+    /* Duplicate SSID, which does not pass validation */
+    AVS_LIST(server_instance_t) clone =
+            AVS_LIST_APPEND_NEW(server_instance_t,
+                                &env->stored_repr->instances);
+    AVS_UNIT_ASSERT_NOT_NULL(clone);
+    *clone = *env->stored_repr->instances;
+    clone->iid = 2;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_journal_append(env->anjay_stored, journal));
+    AVS_LIST_DELETE(AVS_LIST_NEXT_PTR(&env->stored_repr->instances));
+
+    AVS_UNIT_ASSERT_FAILED(anjay_server_object_journal_restore(
+            env->anjay_restored, env->stream, journal));
+    AVS_UNIT_ASSERT_NULL(env->restored_repr->instances);
+    avs_stream_cleanup(&journal);
+}
@@ -0,0 +1,453 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <string.h>
+
+#include <avsystem/commons/avs_stream_inbuf.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "tests/utils/utils.h"
+
+static const anjay_configuration_t CONFIG = {
+    .endpoint_name = "test"
+};
+
+typedef struct {
+    anjay_t *anjay;
+    // address passed as the integrity context
+    char integrity_ctx;
+
+    size_t written;
+    int stream_write_result;
+    int reset_calls;
+
+    int integrity_init_calls;
+    size_t integrity_bytes;
+    int integrity_update_result;
+    int integrity_finish_calls;
+    bool integrity_finish_aborted;
+    int integrity_finish_result;
+
+    int check_integrity_calls;
+} sw_mgmt_test_env_t;
+
+#define SCOPED_SW_MGMT_TEST_ENV(Name, Handlers)              \
+    SCOPED_PTR(sw_mgmt_test_env_t, sw_mgmt_test_env_destroy) \
+    Name = sw_mgmt_test_env_create(Handlers)
+
+static int test_stream_open(void *obj_ctx, anjay_iid_t iid, void *inst_ctx) {
+    (void) obj_ctx;
+    (void) iid;
+    (void) inst_ctx;
+    return 0;
+}
+
+static int test_stream_write(void *obj_ctx,
+                             anjay_iid_t iid,
+                             void *inst_ctx,
+                             const void *data,
+                             size_t length) {
+    (void) iid;
+    (void) inst_ctx;
+    (void) data;
+    sw_mgmt_test_env_t *env = (sw_mgmt_test_env_t *) obj_ctx;
+    env->written += length;
+    return env->stream_write_result;
+}
+
+static int test_stream_finish(void *obj_ctx, anjay_iid_t iid, void *inst_ctx) {
+    (void) obj_ctx;
+    (void) iid;
+    (void) inst_ctx;
+    return 0;
+}
+
+static int test_check_integrity(void *obj_ctx,
+                                anjay_iid_t iid,
+                                void *inst_ctx) {
+    (void) iid;
+    (void) inst_ctx;
+    ++((sw_mgmt_test_env_t *) obj_ctx)->check_integrity_calls;
+    return 0;
+}
+
+static int test_integrity_init(void *obj_ctx,
+                               anjay_iid_t iid,
+                               void *inst_ctx,
+                               void **out_integrity_ctx) {
+    (void) iid;
+    (void) inst_ctx;
+    sw_mgmt_test_env_t *env = (sw_mgmt_test_env_t *) obj_ctx;
+    AVS_UNIT_ASSERT_NULL(*out_integrity_ctx);
+    ++env->integrity_init_calls;
+    *out_integrity_ctx = &env->integrity_ctx;
+    return 0;
+}
+
+static int test_integrity_update(void *obj_ctx,
+                                 anjay_iid_t iid,
+                                 void *inst_ctx,
+                                 void *integrity_ctx,
+                                 const void *data,
+                                 size_t length) {
+    (void) iid;
+    (void) inst_ctx;
+    (void) data;
+    sw_mgmt_test_env_t *env = (sw_mgmt_test_env_t *) obj_ctx;
+    AVS_UNIT_ASSERT_TRUE(integrity_ctx == &env->integrity_ctx);
+    // the package is verified before it is written
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_bytes, env->written);
+    env->integrity_bytes += length;
+    return env->integrity_update_result;
+}
+
+static int test_integrity_finish(void *obj_ctx,
+                                 anjay_iid_t iid,
+                                 void *inst_ctx,
+                                 void *integrity_ctx,
+                                 bool aborted) {
+    (void) iid;
+    (void) inst_ctx;
+    sw_mgmt_test_env_t *env = (sw_mgmt_test_env_t *) obj_ctx;
+    AVS_UNIT_ASSERT_TRUE(integrity_ctx == &env->integrity_ctx);
+    ++env->integrity_finish_calls;
+    env->integrity_finish_aborted = aborted;
+    return env->integrity_finish_result;
+}
+
+static void test_reset(void *obj_ctx, anjay_iid_t iid, void *inst_ctx) {
+    (void) iid;
+    (void) inst_ctx;
+    ++((sw_mgmt_test_env_t *) obj_ctx)->reset_calls;
+}
+
+static const char *
+test_get_name(void *obj_ctx, anjay_iid_t iid, void *inst_ctx) {
+    (void) obj_ctx;
+    (void) iid;
+    (void) inst_ctx;
+    return "test";
+}
+
+static int test_pkg_install(void *obj_ctx, anjay_iid_t iid, void *inst_ctx) {
+    (void) obj_ctx;
+    (void) iid;
+    (void) inst_ctx;
+    return 0;
+}
+
+static const anjay_sw_mgmt_handlers_t INCREMENTAL_HANDLERS = {
+    .stream_open = test_stream_open,
+    .stream_write = test_stream_write,
+    .stream_finish = test_stream_finish,
+    .integrity_init = test_integrity_init,
+    .integrity_update = test_integrity_update,
+    .integrity_finish = test_integrity_finish,
+    .reset = test_reset,
+    .get_name = test_get_name,
+    .get_version = test_get_name,
+    .pkg_install = test_pkg_install
+};
+
+static const anjay_sw_mgmt_handlers_t BOTH_HANDLERS = {
+    .stream_open = test_stream_open,
+    .stream_write = test_stream_write,
+    .stream_finish = test_stream_finish,
+    .check_integrity = test_check_integrity,
+    .integrity_init = test_integrity_init,
+    .integrity_update = test_integrity_update,
+    .integrity_finish = test_integrity_finish,
+    .reset = test_reset,
+    .get_name = test_get_name,
+    .get_version = test_get_name,
+    .pkg_install = test_pkg_install
+};
+
+static const anjay_sw_mgmt_handlers_t CHECK_ONLY_HANDLERS = {
+    .stream_open = test_stream_open,
+    .stream_write = test_stream_write,
+    .stream_finish = test_stream_finish,
+    .check_integrity = test_check_integrity,
+    .reset = test_reset,
+    .get_name = test_get_name,
+    .get_version = test_get_name,
+    .pkg_install = test_pkg_install
+};
+
+static sw_mgmt_test_env_t *
+sw_mgmt_test_env_create(const anjay_sw_mgmt_handlers_t *handlers) {
+    sw_mgmt_test_env_t *env = (__typeof__(env)) avs_calloc(1, sizeof(*env));
+    AVS_UNIT_ASSERT_NOT_NULL(env);
+    env->anjay = anjay_new(&CONFIG);
+    AVS_UNIT_ASSERT_NOT_NULL(env->anjay);
+    const anjay_sw_mgmt_settings_t settings = {
+        .handlers = handlers,
+        .obj_ctx = env
+    };
+    AVS_UNIT_ASSERT_SUCCESS(anjay_sw_mgmt_install(env->anjay, &settings));
+    const anjay_sw_mgmt_instance_initializer_t instance = {
+        .initial_state = ANJAY_SW_MGMT_INITIAL_STATE_IDLE,
+        .iid = 0
+    };
+    AVS_UNIT_ASSERT_SUCCESS(anjay_sw_mgmt_add_instance(env->anjay, &instance));
+    return env;
+}
+
+static void sw_mgmt_test_env_destroy(sw_mgmt_test_env_t **env) {
+    anjay_delete((*env)->anjay);
+    avs_free(*env);
+}
+
+static sw_mgmt_instance_t *get_test_instance(sw_mgmt_test_env_t *env) {
+    sw_mgmt_instance_t *inst = NULL;
+    ANJAY_MUTEX_LOCK(anjay, env->anjay);
+    sw_mgmt_object_t *obj =
+            (sw_mgmt_object_t *) _anjay_dm_module_get_arg(anjay,
+                                                          sw_mgmt_delete);
+    AVS_UNIT_ASSERT_NOT_NULL(obj);
+    inst = find_instance(obj, 0);
+    ANJAY_MUTEX_UNLOCK(env->anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(inst);
+    return inst;
+}
+
+static void run_jobs(sw_mgmt_test_env_t *env) {
+    // check_integrity_job is scheduled by another job
+    for (int i = 0; i < 4; ++i) {
+        anjay_sched_run(env->anjay);
+    }
+}
+
+// larger than the buffer used by package_push_download()
+static char PACKAGE[2500];
+
+static int push_package(sw_mgmt_test_env_t *env) {
+    int result = -1;
+    avs_stream_inbuf_t stream = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&stream, PACKAGE, sizeof(PACKAGE));
+    anjay_unlocked_input_ctx_t *in = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_input_opaque_create(
+            &in, (avs_stream_t *) &stream,
+            &MAKE_RESOURCE_PATH(OID, 0, RID_PACKAGE)));
+    ANJAY_MUTEX_LOCK(anjay, env->anjay);
+    sw_mgmt_object_t *obj =
+            (sw_mgmt_object_t *) _anjay_dm_module_get_arg(anjay,
+                                                          sw_mgmt_delete);
+    result = package_push_download(anjay, obj, find_instance(obj, 0), in);
+    ANJAY_MUTEX_UNLOCK(env->anjay);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_input_ctx_destroy(&in));
+    return result;
+}
+
+AVS_UNIT_TEST(sw_mgmt_integrity, push) {
+    SCOPED_SW_MGMT_TEST_ENV(env, &INCREMENTAL_HANDLERS);
+    AVS_UNIT_ASSERT_SUCCESS(push_package(env));
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_init_calls, 1);
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_bytes, sizeof(PACKAGE));
+    AVS_UNIT_ASSERT_EQUAL(env->written, sizeof(PACKAGE));
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_finish_calls, 1);
+    AVS_UNIT_ASSERT_FALSE(env->integrity_finish_aborted);
+
+    sw_mgmt_instance_t *inst = get_test_instance(env);
+    AVS_UNIT_ASSERT_EQUAL(inst->internal_state,
+                          SW_MGMT_INTERNAL_STATE_DOWNLOADED);
+    run_jobs(env);
+    AVS_UNIT_ASSERT_EQUAL(inst->internal_state,
+                          SW_MGMT_INTERNAL_STATE_DELIVERED);
+    AVS_UNIT_ASSERT_EQUAL(env->reset_calls, 0);
+}
+
+AVS_UNIT_TEST(sw_mgmt_integrity, push_verification_failed) {
+    SCOPED_SW_MGMT_TEST_ENV(env, &BOTH_HANDLERS);
+    env->integrity_finish_result = ANJAY_SW_MGMT_ERR_INTEGRITY_FAILURE;
+    AVS_UNIT_ASSERT_SUCCESS(push_package(env));
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_finish_calls, 1);
+    AVS_UNIT_ASSERT_FALSE(env->integrity_finish_aborted);
+
+    sw_mgmt_instance_t *inst = get_test_instance(env);
+    run_jobs(env);
+    // the stored result is used instead of calling check_integrity
+    AVS_UNIT_ASSERT_EQUAL(env->check_integrity_calls, 0);
+    AVS_UNIT_ASSERT_EQUAL(inst->internal_state, SW_MGMT_INTERNAL_STATE_IDLE);
+    AVS_UNIT_ASSERT_EQUAL(inst->update_result,
+                          ANJAY_SW_MGMT_UPDATE_RESULT_INTEGRITY_FAILURE);
+    AVS_UNIT_ASSERT_EQUAL(env->reset_calls, 1);
+    // the context has already been released
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_finish_calls, 1);
+}
+
+AVS_UNIT_TEST(sw_mgmt_integrity, push_update_failed) {
+    SCOPED_SW_MGMT_TEST_ENV(env, &INCREMENTAL_HANDLERS);
+    env->integrity_update_result = ANJAY_SW_MGMT_ERR_INTEGRITY_FAILURE;
+    AVS_UNIT_ASSERT_FAILED(push_package(env));
+    // nothing is written after the verification failed
+    AVS_UNIT_ASSERT_EQUAL(env->written, 0);
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_finish_calls, 1);
+    AVS_UNIT_ASSERT_TRUE(env->integrity_finish_aborted);
+    AVS_UNIT_ASSERT_EQUAL(env->reset_calls, 1);
+
+    sw_mgmt_instance_t *inst = get_test_instance(env);
+    AVS_UNIT_ASSERT_EQUAL(inst->internal_state, SW_MGMT_INTERNAL_STATE_IDLE);
+    AVS_UNIT_ASSERT_EQUAL(inst->update_result,
+                          ANJAY_SW_MGMT_UPDATE_RESULT_INTEGRITY_FAILURE);
+    AVS_UNIT_ASSERT_FALSE(inst->integrity_verified);
+}
+
+AVS_UNIT_TEST(sw_mgmt_integrity, push_write_failed_midway) {
+    SCOPED_SW_MGMT_TEST_ENV(env, &INCREMENTAL_HANDLERS);
+    env->stream_write_result = ANJAY_SW_MGMT_ERR_NOT_ENOUGH_SPACE;
+    AVS_UNIT_ASSERT_FAILED(push_package(env));
+    AVS_UNIT_ASSERT_TRUE(env->integrity_bytes < sizeof(PACKAGE));
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_finish_calls, 1);
+    AVS_UNIT_ASSERT_TRUE(env->integrity_finish_aborted);
+    AVS_UNIT_ASSERT_EQUAL(env->reset_calls, 1);
+
+    sw_mgmt_instance_t *inst = get_test_instance(env);
+    AVS_UNIT_ASSERT_EQUAL(inst->internal_state, SW_MGMT_INTERNAL_STATE_IDLE);
+    AVS_UNIT_ASSERT_EQUAL(inst->update_result,
+                          ANJAY_SW_MGMT_UPDATE_RESULT_NOT_ENOUGH_SPACE);
+}
+
+AVS_UNIT_TEST(sw_mgmt_integrity, reset_discards_result) {
+    SCOPED_SW_MGMT_TEST_ENV(env, &BOTH_HANDLERS);
+    AVS_UNIT_ASSERT_SUCCESS(push_package(env));
+    sw_mgmt_instance_t *inst = get_test_instance(env);
+    AVS_UNIT_ASSERT_TRUE(inst->integrity_verified);
+
+    ANJAY_MUTEX_LOCK(anjay, env->anjay);
+    sw_mgmt_object_t *obj =
+            (sw_mgmt_object_t *) _anjay_dm_module_get_arg(anjay,
+                                                          sw_mgmt_delete);
+    call_reset(anjay, obj, inst);
+    ANJAY_MUTEX_UNLOCK(env->anjay);
+    AVS_UNIT_ASSERT_FALSE(inst->integrity_verified);
+    AVS_UNIT_ASSERT_EQUAL(env->reset_calls, 1);
+    // the context has been released when the download finished
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_finish_calls, 1);
+    AVS_UNIT_ASSERT_FALSE(env->integrity_finish_aborted);
+}
+
+AVS_UNIT_TEST(sw_mgmt_integrity, check_integrity_fallback) {
+    SCOPED_SW_MGMT_TEST_ENV(env, &CHECK_ONLY_HANDLERS);
+    AVS_UNIT_ASSERT_SUCCESS(push_package(env));
+    AVS_UNIT_ASSERT_EQUAL(env->written, sizeof(PACKAGE));
+
+    sw_mgmt_instance_t *inst = get_test_instance(env);
+    AVS_UNIT_ASSERT_FALSE(inst->integrity_verified);
+    run_jobs(env);
+    AVS_UNIT_ASSERT_EQUAL(env->check_integrity_calls, 1);
+    AVS_UNIT_ASSERT_EQUAL(inst->internal_state,
+                          SW_MGMT_INTERNAL_STATE_DELIVERED);
+}
+
+AVS_UNIT_TEST(sw_mgmt_integrity, check_integrity_after_reboot) {
+    SCOPED_SW_MGMT_TEST_ENV(env, &BOTH_HANDLERS);
+    // package downloaded before a reboot, so it could not be verified on the
+    // fly
+    const anjay_sw_mgmt_instance_initializer_t instance = {
+        .initial_state = ANJAY_SW_MGMT_INITIAL_STATE_DOWNLOADED,
+        .iid = 1
+    };
+    AVS_UNIT_ASSERT_SUCCESS(anjay_sw_mgmt_add_instance(env->anjay, &instance));
+    run_jobs(env);
+    AVS_UNIT_ASSERT_EQUAL(env->check_integrity_calls, 1);
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_init_calls, 0);
+}
+
+#ifdef ANJAY_WITH_DOWNLOADER
+static void pull_package(sw_mgmt_test_env_t *env, size_t chunk_size) {
+    sw_mgmt_instance_t *inst = get_test_instance(env);
+    inst->internal_state = SW_MGMT_INTERNAL_STATE_DOWNLOADING;
+    for (size_t offset = 0; offset < sizeof(PACKAGE); offset += chunk_size) {
+        AVS_UNIT_ASSERT_SUCCESS(pull_download_on_next_block(
+                env->anjay, (const uint8_t *) PACKAGE + offset,
+                AVS_MIN(chunk_size, sizeof(PACKAGE) - offset), NULL, inst));
+    }
+}
+
+AVS_UNIT_TEST(sw_mgmt_integrity, pull) {
+    SCOPED_SW_MGMT_TEST_ENV(env, &INCREMENTAL_HANDLERS);
+    pull_package(env, 1024);
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_init_calls, 1);
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_bytes, sizeof(PACKAGE));
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_finish_calls, 0);
+
+    sw_mgmt_instance_t *inst = get_test_instance(env);
+    pull_download_on_download_finished(
+            env->anjay,
+            (anjay_download_status_t) {
+                .result = ANJAY_DOWNLOAD_FINISHED
+            },
+            inst);
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_finish_calls, 1);
+    AVS_UNIT_ASSERT_FALSE(env->integrity_finish_aborted);
+    run_jobs(env);
+    AVS_UNIT_ASSERT_EQUAL(inst->internal_state,
+                          SW_MGMT_INTERNAL_STATE_DELIVERED);
+}
+
+AVS_UNIT_TEST(sw_mgmt_integrity, pull_connection_lost) {
+    SCOPED_SW_MGMT_TEST_ENV(env, &INCREMENTAL_HANDLERS);
+    pull_package(env, 1024);
+
+    sw_mgmt_instance_t *inst = get_test_instance(env);
+    pull_download_on_download_finished(
+            env->anjay,
+            (anjay_download_status_t) {
+                .result = ANJAY_DOWNLOAD_ERR_FAILED,
+                .details.error = avs_errno(AVS_ECONNABORTED)
+            },
+            inst);
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_finish_calls, 1);
+    AVS_UNIT_ASSERT_TRUE(env->integrity_finish_aborted);
+    AVS_UNIT_ASSERT_EQUAL(env->reset_calls, 1);
+    AVS_UNIT_ASSERT_EQUAL(inst->internal_state, SW_MGMT_INTERNAL_STATE_IDLE);
+    AVS_UNIT_ASSERT_EQUAL(inst->update_result,
+                          ANJAY_SW_MGMT_UPDATE_RESULT_CONNECTION_LOST);
+    AVS_UNIT_ASSERT_FALSE(inst->integrity_verified);
+
+    // a new download starts a new verification
+    pull_package(env, 1024);
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_init_calls, 2);
+    pull_download_on_download_finished(
+            env->anjay,
+            (anjay_download_status_t) {
+                .result = ANJAY_DOWNLOAD_FINISHED
+            },
+            inst);
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_finish_calls, 2);
+    AVS_UNIT_ASSERT_FALSE(env->integrity_finish_aborted);
+}
+
+AVS_UNIT_TEST(sw_mgmt_integrity, pull_update_failed) {
+    SCOPED_SW_MGMT_TEST_ENV(env, &INCREMENTAL_HANDLERS);
+    env->integrity_update_result = ANJAY_SW_MGMT_ERR_INTEGRITY_FAILURE;
+    sw_mgmt_instance_t *inst = get_test_instance(env);
+    inst->internal_state = SW_MGMT_INTERNAL_STATE_DOWNLOADING;
+    AVS_UNIT_ASSERT_FAILED(pull_download_on_next_block(
+            env->anjay, (const uint8_t *) PACKAGE, 1024, NULL, inst));
+    AVS_UNIT_ASSERT_EQUAL(env->written, 0);
+    AVS_UNIT_ASSERT_EQUAL(inst->internal_state, SW_MGMT_INTERNAL_STATE_IDLE);
+    AVS_UNIT_ASSERT_EQUAL(inst->update_result,
+                          ANJAY_SW_MGMT_UPDATE_RESULT_INTEGRITY_FAILURE);
+
+    // the downloader reports the failure afterwards
+    pull_download_on_download_finished(
+            env->anjay,
+            (anjay_download_status_t) {
+                .result = ANJAY_DOWNLOAD_ERR_ABORTED
+            },
+            inst);
+    AVS_UNIT_ASSERT_EQUAL(env->integrity_finish_calls, 1);
+    AVS_UNIT_ASSERT_TRUE(env->integrity_finish_aborted);
+    AVS_UNIT_ASSERT_EQUAL(env->reset_calls, 1);
+    AVS_UNIT_ASSERT_EQUAL(inst->update_result,
+                          ANJAY_SW_MGMT_UPDATE_RESULT_INTEGRITY_FAILURE);
+}
+#endif // ANJAY_WITH_DOWNLOADER
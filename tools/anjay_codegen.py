@@ -196,6 +196,15 @@ static int instance_reset(anjay_t *anjay,
 }
 
 {% endif %}
+{% if obj.resources %}
+// TODO: if the presence of any Resource depends on the state of the Object
+// Instance, remove this table and implement the list_resources handler instead
+static const anjay_dm_resource_def_t RESOURCES[] = {
+{% for res in obj.resources %}
+    { {{ res.name_upper }}, {{ res.kind_enum }}, ANJAY_DM_RES_PRESENT }{{ "" if loop.last else "," }}
+{% endfor %}
+};
+{% else %}
 static int list_resources(anjay_t *anjay,
                           const anjay_dm_object_def_t *const *obj_ptr,
                           anjay_iid_t iid,
@@ -210,6 +219,7 @@ static int list_resources(anjay_t *anjay,
 {% endfor %}
     return 0;
 }
+{% endif %}
 
 {% if obj.has_any_readable_resources %}
 static int resource_read(anjay_t *anjay,
@@ -390,7 +400,11 @@ static const anjay_dm_object_def_t OBJ_DEF = {
         {{ '.%s = %s' % handler }}{{ "" if loop.last else "," }}
 {% endif %}
 {% endfor %}
-    }
+    }{{ "," if obj.resources else "" }}
+{% if obj.resources %}
+    .resources = RESOURCES,
+    .resources_count = AVS_ARRAY_SIZE(RESOURCES)
+{% endif %}
 };
 
 const anjay_dm_object_def_t **{{ obj_name_snake }}_object_create(void) {
@@ -508,6 +522,15 @@ static int instance_reset(anjay_t *anjay,
 }
 
 {% endif %}
+{% if obj.resources %}
+// TODO: if the presence of any Resource depends on the state of the Object
+// Instance, remove this table and implement the list_resources handler instead
+static const anjay_dm_resource_def_t RESOURCES[] = {
+{% for res in obj.resources %}
+    { {{ res.name_upper }}, {{ res.kind_enum }}, ANJAY_DM_RES_PRESENT }{{ "" if loop.last else "," }}
+{% endfor %}
+};
+{% else %}
 static int list_resources(anjay_t *anjay,
                           const anjay_dm_object_def_t *const *obj_ptr,
                           anjay_iid_t iid,
@@ -522,6 +545,7 @@ static int list_resources(anjay_t *anjay,
 {% endfor %}
     return 0;
 }
+{% endif %}
 
 {% if obj.has_any_readable_resources %}
 static int resource_read(anjay_t *anjay,
@@ -702,7 +726,11 @@ static const anjay_dm_object_def_t OBJ_DEF = {
         {{ '.%s = %s' % handler }}{{ "" if loop.last else "," }}
 {% endif %}
 {% endfor %}
-    }
+    }{{ "," if obj.resources else "" }}
+{% if obj.resources %}
+    .resources = RESOURCES,
+    .resources_count = AVS_ARRAY_SIZE(RESOURCES)
+{% endif %}
 };
 
 const anjay_dm_object_def_t **{{ obj_name_snake }}_object_create(void) {
@@ -885,6 +913,15 @@ int instance_reset(anjay_t *,
 }
 
 {% endif %}
+{% if obj.resources %}
+// TODO: if the presence of any Resource depends on the state of the Object
+// Instance, remove this table and implement the list_resources handler instead
+const anjay_dm_resource_def_t RESOURCES[] = {
+{% for res in obj.resources %}
+    { {{ res.name_upper }}, {{ res.kind_enum }}, ANJAY_DM_RES_PRESENT }{{ "" if loop.last else "," }}
+{% endfor %}
+};
+{% else %}
 int list_resources(anjay_t *,
                    const anjay_dm_object_def_t *const *,
                    anjay_iid_t,
@@ -895,6 +932,7 @@ int list_resources(anjay_t *,
 {% endfor %}
     return 0;
 }
+{% endif %}
 
 {% if obj.has_any_readable_resources %}
 int resource_read(anjay_t *,
@@ -1070,6 +1108,11 @@ struct ObjDef : public anjay_dm_object_def_t {
         {{ 'handlers.%s = %s;' % handler }}
 {% endif %}
 {% endfor %}
+{% if obj.resources %}
+
+        resources = RESOURCES;
+        resources_count = AVS_ARRAY_SIZE(RESOURCES);
+{% endif %}
     }
 } const OBJ_DEF;
 
@@ -1195,6 +1238,15 @@ int instance_reset(anjay_t *,
 }
 
 {% endif %}
+{% if obj.resources %}
+// TODO: if the presence of any Resource depends on the state of the Object
+// Instance, remove this table and implement the list_resources handler instead
+const anjay_dm_resource_def_t RESOURCES[] = {
+{% for res in obj.resources %}
+    { {{ res.name_upper }}, {{ res.kind_enum }}, ANJAY_DM_RES_PRESENT }{{ "" if loop.last else "," }}
+{% endfor %}
+};
+{% else %}
 int list_resources(anjay_t *,
                    const anjay_dm_object_def_t *const *,
                    anjay_iid_t,
@@ -1205,6 +1257,7 @@ int list_resources(anjay_t *,
 {% endfor %}
     return 0;
 }
+{% endif %}
 
 {% if obj.has_any_readable_resources %}
 int resource_read(anjay_t *,
@@ -1380,6 +1433,11 @@ struct ObjDef : public anjay_dm_object_def_t {
         {{ 'handlers.%s = %s;' % handler }}
 {% endif %}
 {% endfor %}
+{% if obj.resources %}
+
+        resources = RESOURCES;
+        resources_count = AVS_ARRAY_SIZE(RESOURCES);
+{% endif %}
     }
 } const OBJ_DEF;
 
@@ -1643,7 +1701,9 @@ def generate_object_boilerplate(obj_tree: ElementTree, cxx: bool, instances_numb
         handlers.append(('instance_reset', 'instance_reset'))
 
     handlers.append('')
-    handlers.append(('list_resources', 'list_resources'))
+    if not obj.resources:
+        # objects with any Resources use the static RESOURCES table instead
+        handlers.append(('list_resources', 'list_resources'))
     if obj.has_any_readable_resources:
         handlers.append(('resource_read', 'resource_read'))
     if obj.has_any_writable_resources:
@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+# AVSystem Anjay LwM2M SDK
+# All rights reserved.
+#
+# Licensed under the AVSystem-5-clause License.
+# See the attached LICENSE file for details.
+
+"""
+Reference generator of delta packages for the fw_update module.
+
+Delta packages are applied on the device if the library is compiled with
+ANJAY_WITH_MODULE_FW_UPDATE_DELTA and the read_current handler is implemented.
+See src/modules/fw_update/anjay_fw_update_delta.h for the format description.
+"""
+
+import argparse
+import random
+import struct
+import sys
+import zlib
+
+MAGIC = b'ANJDELTA'
+HEADER_FORMAT = '>IIII'
+OP_COPY = 0x01
+OP_INSERT = 0x02
+
+# Length of blocks used to look up matches in the source image. Shorter
+# matches are not worth a COPY command, which is 9 bytes long.
+BLOCK_SIZE = 16
+
+
+def index_source(source):
+    index = {}
+    for offset in range(len(source) - BLOCK_SIZE + 1):
+        index.setdefault(source[offset:offset + BLOCK_SIZE], offset)
+    return index
+
+
+def match_length(source, source_offset, target, target_offset):
+    length = 0
+    while (source_offset + length < len(source)
+           and target_offset + length < len(target)
+           and source[source_offset + length] == target[target_offset + length]):
+        length += 1
+    return length
+
+
+def find_match(index, source, target, target_offset, last_source_end):
+    # prefer continuing the previous match, which is the usual case for
+    # consecutive firmware versions
+    if target[target_offset:target_offset + BLOCK_SIZE] \
+            == source[last_source_end:last_source_end + BLOCK_SIZE]:
+        candidate = last_source_end
+    else:
+        candidate = index.get(target[target_offset:target_offset + BLOCK_SIZE])
+    if candidate is None:
+        return None, 0
+    return candidate, match_length(source, candidate, target, target_offset)
+
+
+def generate_commands(source, target):
+    index = index_source(source)
+    target_offset = 0
+    literal_start = 0
+    last_source_end = 0
+    while target_offset < len(target):
+        source_offset, length = find_match(index, source, target,
+                                           target_offset, last_source_end)
+        if length < BLOCK_SIZE:
+            target_offset += 1
+            continue
+        if literal_start < target_offset:
+            yield OP_INSERT, target[literal_start:target_offset]
+        yield OP_COPY, (source_offset, length)
+        target_offset += length
+        literal_start = target_offset
+        last_source_end = source_offset + length
+    if literal_start < len(target):
+        yield OP_INSERT, target[literal_start:]
+
+
+def crc32(data):
+    return zlib.crc32(data) & 0xffffffff
+
+
+def make_delta(source, target):
+    chunks = [MAGIC, struct.pack(HEADER_FORMAT, len(source), crc32(source),
+                                 len(target), crc32(target))]
+    for op, arg in generate_commands(source, target):
+        if op == OP_COPY:
+            chunks.append(struct.pack('>BII', OP_COPY, *arg))
+        else:
+            chunks.append(struct.pack('>BI', OP_INSERT, len(arg)))
+            chunks.append(arg)
+    return b''.join(chunks)
+
+
+def apply_delta(source, delta):
+    if delta[:len(MAGIC)] != MAGIC:
+        raise ValueError('not a delta package')
+    source_size, source_crc, target_size, target_crc = struct.unpack_from(
+        HEADER_FORMAT, delta, len(MAGIC))
+    if source_size != len(source):
+        raise ValueError('source image size mismatch: expected %d, got %d'
+                         % (source_size, len(source)))
+    if source_crc != crc32(source):
+        raise ValueError('source image checksum mismatch')
+    offset = len(MAGIC) + struct.calcsize(HEADER_FORMAT)
+    target = bytearray()
+    while offset < len(delta):
+        op = delta[offset]
+        if op == OP_COPY:
+            source_offset, length = struct.unpack_from('>II', delta, offset + 1)
+            if source_offset + length > len(source):
+                raise ValueError('source range out of bounds')
+            target += source[source_offset:source_offset + length]
+            offset += 9
+        elif op == OP_INSERT:
+            (length,) = struct.unpack_from('>I', delta, offset + 1)
+            offset += 5
+            if offset + length > len(delta):
+                raise ValueError('truncated INSERT command')
+            target += delta[offset:offset + length]
+            offset += length
+        else:
+            raise ValueError('unknown command 0x%02x' % op)
+    if len(target) != target_size:
+        raise ValueError('target size mismatch')
+    if crc32(target) != target_crc:
+        raise ValueError('target image checksum mismatch')
+    return bytes(target)
+
+
+# Same as the package used in tests/modules/fw_update/delta.c, so that the
+# format used by this script and by the library cannot diverge unnoticed.
+REFERENCE_SOURCE = b'The quick brown fox jumps over the lazy dog'
+REFERENCE_TARGET = b'The quick red fox jumps over the lazy dog'
+REFERENCE_DELTA = bytes.fromhex(
+    '414e4a44454c5441' '0000002b' '414fa339' '00000029' 'e1ad7b5e'
+    '020000000d') + b'The quick red' + bytes.fromhex('010000000f0000001c')
+
+
+def _expect_failure(source, delta):
+    try:
+        apply_delta(source, delta)
+    except (ValueError, struct.error):
+        return
+    raise AssertionError('invalid delta package has been applied')
+
+
+def selftest():
+    if make_delta(REFERENCE_SOURCE, REFERENCE_TARGET) != REFERENCE_DELTA:
+        raise AssertionError('reference delta package mismatch')
+
+    rng = random.Random(0)
+    for _ in range(50):
+        source = bytes(rng.getrandbits(8)
+                       for _ in range(rng.randrange(0, 4096)))
+        # typical firmware update: most of the image is unchanged, with some
+        # fragments modified, inserted or removed
+        target = bytearray(source)
+        for _ in range(rng.randrange(0, 8)):
+            start = rng.randrange(0, len(target) + 1)
+            end = min(len(target), start + rng.randrange(0, 64))
+            target[start:end] = bytes(rng.getrandbits(8)
+                                      for _ in range(rng.randrange(0, 64)))
+        target = bytes(target)
+
+        delta = make_delta(source, target)
+        if apply_delta(source, delta) != target:
+            raise AssertionError('delta package does not reproduce target')
+
+        _expect_failure(source + b'\0', delta)
+        if source:
+            _expect_failure(bytes([source[0] ^ 1]) + source[1:], delta)
+        damaged = bytearray(delta)
+        damaged[-1] ^= 1
+        _expect_failure(source, bytes(damaged))
+    print('fw_delta selftest passed', file=sys.stderr)
+
+
+def _main():
+    parser = argparse.ArgumentParser(
+        description='Generate or apply fw_update delta packages.')
+    subparsers = parser.add_subparsers(dest='command', required=True)
+
+    diff_parser = subparsers.add_parser(
+        'diff', help='generate a delta package transforming SOURCE into TARGET')
+    diff_parser.add_argument('source', type=argparse.FileType('rb'))
+    diff_parser.add_argument('target', type=argparse.FileType('rb'))
+    diff_parser.add_argument('output', type=argparse.FileType('wb'))
+
+    apply_parser = subparsers.add_parser(
+        'apply', help='apply DELTA to SOURCE, as the device would')
+    apply_parser.add_argument('source', type=argparse.FileType('rb'))
+    apply_parser.add_argument('delta', type=argparse.FileType('rb'))
+    apply_parser.add_argument('output', type=argparse.FileType('wb'))
+
+    subparsers.add_parser(
+        'selftest', help='check that generated packages can be applied')
+
+    args = parser.parse_args()
+    if args.command == 'selftest':
+        selftest()
+        return
+    source = args.source.read()
+    if args.command == 'diff':
+        target = args.target.read()
+        delta = make_delta(source, target)
+        if apply_delta(source, delta) != target:
+            raise AssertionError('generated delta does not reproduce target')
+        args.output.write(delta)
+        print('%d -> %d bytes, delta: %d bytes (%.1f%%)'
+              % (len(source), len(target), len(delta),
+                 100.0 * len(delta) / max(len(target), 1)),
+              file=sys.stderr)
+    else:
+        args.output.write(apply_delta(source, args.delta.read()))
+
+
+if __name__ == '__main__':
+    _main()